@@ -69,6 +69,7 @@ LOCAL_SRC_FILES := \
 	bluez/src/shared/gatt-db.c \
 	bluez/src/shared/io-glib.c \
 	bluez/src/shared/timeout-glib.c \
+	bluez/src/shared/aes.c \
 	bluez/src/shared/crypto.c \
 	bluez/src/shared/uhid.c \
 	bluez/src/shared/att.c \
@@ -353,6 +354,7 @@ LOCAL_SRC_FILES := \
 	bluez/monitor/analyze.c \
 	bluez/src/shared/util.c \
 	bluez/src/shared/queue.c \
+	bluez/src/shared/aes.c \
 	bluez/src/shared/crypto.c \
 	bluez/src/shared/btsnoop.c \
 	bluez/src/shared/mainloop.c \
@@ -0,0 +1,1125 @@
+extern "C" {
+  #include "bluetooth.h"
+  #include "hci.h"
+  #include "mainloop.h"
+  #include "util.h"
+  #include "uuid.h"
+  #include "gatt-db.h"
+  #include "gatt-server.h"
+  #include "emulator/bthost.h"
+
+  //emulator/btdev.h typedefs btdev_callback over its own struct tag, which
+  //C++ rejects, so only the parts used here are declared
+  enum btdev_type {
+    BTDEV_TYPE_BREDRLE,
+    BTDEV_TYPE_BREDR,
+    BTDEV_TYPE_LE,
+    BTDEV_TYPE_AMP,
+    BTDEV_TYPE_BREDR20,
+  };
+
+  struct btdev;
+  typedef void (*btdev_send_func)(const struct iovec* iov, int iovlen, void* user_data);
+
+  struct btdev* btdev_create(enum btdev_type type, uint16_t id);
+  void btdev_destroy(struct btdev* btdev);
+  const uint8_t* btdev_get_bdaddr(struct btdev* btdev);
+  void btdev_set_send_handler(struct btdev* btdev, btdev_send_func handler, void* user_data);
+  void btdev_receive_h4(struct btdev* btdev, const void* data, uint16_t len);
+}
+
+#include "GattClient.h"
+#include "GattService.h"
+#include "GattCharacteristic.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+using namespace std;
+using namespace bluez::native;
+
+//Runs GattClient against a peripheral emulated in the same process. The
+//kernel sees a virtual LE controller on /dev/vhci, which btdev links to a
+//second controller driven by bthost. ATT traffic bthost receives is handed to
+//a bt_gatt_server through a socketpair, so the peripheral serves a real GATT
+//database without any radio. Needs root for /dev/vhci and works best with no
+//other LE controller up, as GattClient binds to any local adapter.
+
+namespace {
+typedef chrono::steady_clock Clock;
+
+const uint16_t ATT_CID = 0x0004;
+const unsigned int WaitSeconds = 30;
+
+enum class Operation {
+  Read,
+  Write,
+  WriteWithoutResponse,
+  Notify
+};
+
+struct Options {
+  vector<uint16_t> mtus;
+  vector<Operation> operations;
+  unsigned int count;
+  unsigned int window;
+  unsigned int services;
+  unsigned int characteristics;
+  bool json;
+};
+
+const char* operationName(Operation operation) {
+  switch (operation) {
+  case Operation::Read:
+    return "read";
+  case Operation::Write:
+    return "write";
+  case Operation::WriteWithoutResponse:
+    return "write-cmd";
+  case Operation::Notify:
+    return "notify";
+  }
+
+  return "unknown";
+}
+
+//Queues fn to run on the mainloop thread, which owns all bt_att, bthost and
+//btdev state.
+struct MainLoopCall {
+  function<void()> fn;
+};
+
+void _runMainLoopCall(int id, void* obj) {
+  static_cast<MainLoopCall*>(obj)->fn();
+  mainloop_remove_timeout(id);
+}
+
+void _destroyMainLoopCall(void* obj) {
+  delete static_cast<MainLoopCall*>(obj);
+}
+
+bool runOnMainLoop(function<void()> fn) {
+  MainLoopCall* call = new MainLoopCall;
+  call->fn = fn;
+
+  if (mainloop_add_timeout(1, _runMainLoopCall, call, _destroyMainLoopCall) < 0) {
+    delete call;
+    return false;
+  }
+
+  return true;
+}
+
+//MainLoop starts its thread on first use, nothing can be queued until the
+//thread has created the epoll instance
+bool waitForMainLoop() {
+  for (int i = 0; i < 1000; i++) {
+    if (runOnMainLoop([]() {})) {
+      return true;
+    }
+
+    usleep(1000);
+  }
+
+  return false;
+}
+
+//Signalled from the mainloop thread, waited on by the main thread
+class Event {
+public:
+  Event() : m_set(false) {}
+
+  void set() {
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_set = true;
+    m_condition.notify_all();
+  }
+
+  void reset() {
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_set = false;
+  }
+
+  bool wait(unsigned int seconds = WaitSeconds) {
+    boost::mutex::scoped_lock lock(m_mutex);
+    boost::system_time deadline = boost::get_system_time() + boost::posix_time::seconds(seconds);
+
+    while (!m_set) {
+      if (!m_condition.timed_wait(lock, deadline)) {
+        return m_set;
+      }
+    }
+
+    return true;
+  }
+
+private:
+  boost::mutex m_mutex;
+  boost::condition_variable m_condition;
+  bool m_set;
+};
+
+//Send times and latencies of one measured run. Values carry the sequence
+//number of the operation in their first four octets so one way latencies can
+//be matched up on the receiving side.
+class Run {
+public:
+  Run(Operation operation, unsigned int count, unsigned int window, size_t payload) :
+    m_operation(operation),
+    m_count(count),
+    m_window(window),
+    m_payload(payload),
+    m_issued(0),
+    m_completed(0),
+    m_failed(false),
+    m_sendTimes(count) {
+    m_latencies.reserve(count);
+  }
+
+  Operation operation() const { return m_operation; }
+  unsigned int count() const { return m_count; }
+  unsigned int window() const { return m_window; }
+  size_t payload() const { return m_payload; }
+  bool failed() const { return m_failed; }
+  const vector<double>& latencies() const { return m_latencies; }
+
+  bool pending() const { return m_issued < m_count; }
+  bool done() const { return m_completed >= m_count; }
+
+  //Returns the next sequence number and stamps its send time
+  uint32_t issue(string& value) {
+    uint32_t seq = m_issued++;
+
+    value.assign(m_payload, (char) 0xa5);
+    put_le32(seq, &value[0]);
+    m_sendTimes[seq] = Clock::now();
+
+    return seq;
+  }
+
+  void complete(uint32_t seq) {
+    if (seq >= m_issued) {
+      return;
+    }
+
+    m_latencies.push_back(chrono::duration<double, micro>(Clock::now() - m_sendTimes[seq]).count());
+    m_completed++;
+
+    if (done()) {
+      m_finished.set();
+    }
+  }
+
+  void complete(const uint8_t* value, size_t length) {
+    if (length >= 4) {
+      complete(get_le32(value));
+    }
+  }
+
+  void fail() {
+    m_failed = true;
+    m_finished.set();
+  }
+
+  bool wait() { return m_finished.wait(); }
+
+private:
+  Operation m_operation;
+  unsigned int m_count;
+  unsigned int m_window;
+  size_t m_payload;
+  uint32_t m_issued;
+  uint32_t m_completed;
+  bool m_failed;
+  vector<Clock::time_point> m_sendTimes;
+  vector<double> m_latencies;
+  Event m_finished;
+};
+
+class EmulatedPeripheral;
+
+//One ATT bearer of the peripheral, bridged between bthost and bt_gatt_server
+struct AttBridge {
+  EmulatedPeripheral* peripheral;
+  uint16_t handle;
+  int fd;
+  bt_att* att;
+  bt_gatt_server* server;
+};
+
+class EmulatedPeripheral {
+public:
+  EmulatedPeripheral(const Options& options) :
+    m_options(options),
+    m_vhciFd(-1),
+    m_index(-1),
+    m_masterDev(NULL),
+    m_clientDev(NULL),
+    m_host(NULL),
+    m_db(NULL),
+    m_valueHandle(0),
+    m_bridge(NULL),
+    m_run(NULL),
+    m_onWriteCommand(),
+    m_notifyEnabled(false) {
+  }
+
+  ~EmulatedPeripheral() {
+    Event destroyed;
+
+    runOnMainLoop([this, &destroyed]() {
+      for (auto i = m_bridges.begin(); i != m_bridges.end(); ++i) {
+        mainloop_remove_fd(i->second->fd);
+        close(i->second->fd);
+        bt_gatt_server_unref(i->second->server);
+        bt_att_unref(i->second->att);
+        delete i->second;
+      }
+
+      m_bridges.clear();
+
+      for (auto i = m_fds.begin(); i != m_fds.end(); ++i) {
+        mainloop_remove_fd(*i);
+        close(*i);
+      }
+
+      if (m_host) {
+        bthost_destroy(m_host);
+      }
+
+      if (m_clientDev) {
+        btdev_destroy(m_clientDev);
+      }
+
+      if (m_masterDev) {
+        btdev_destroy(m_masterDev);
+      }
+
+      gatt_db_unref(m_db);
+      destroyed.set();
+    });
+
+    destroyed.wait();
+  }
+
+  bool start() {
+    if (!createDatabase() || !createVhci() || !createHost()) {
+      return false;
+    }
+
+    if (!runOnMainLoop([this]() {
+      bthost_notify_ready(m_host, &EmulatedPeripheral::_onHostReady);
+      bthost_start(m_host);
+    })) {
+      return false;
+    }
+
+    if (!s_hostReady.wait()) {
+      cerr << "Emulated peripheral did not come up" << endl;
+      return false;
+    }
+
+    runOnMainLoop([this]() {
+      bthost_set_connect_cb(m_host, &EmulatedPeripheral::_onConnect, this);
+      bthost_set_adv_enable(m_host, 0x01);
+    });
+
+    return powerOn();
+  }
+
+  string address() {
+    char str[18];
+
+    ba2str(reinterpret_cast<const bdaddr_t*>(btdev_get_bdaddr(m_clientDev)), str);
+    return str;
+  }
+
+  uint16_t valueHandle() { return m_valueHandle; }
+  bool notifyEnabled() { return m_notifyEnabled; }
+
+  //Called on the mainloop thread only. onWriteCommand lets the central keep
+  //its window of write commands full, as those are only seen here.
+  void setRun(Run* run, function<void()> onWriteCommand = function<void()>()) {
+    m_run = run;
+    m_onWriteCommand = onWriteCommand;
+  }
+
+  void sendNotification() {
+    string value;
+
+    if (!m_bridge || !m_run || !m_run->pending()) {
+      return;
+    }
+
+    m_run->issue(value);
+
+    if (!bt_gatt_server_send_notification(m_bridge->server, m_valueHandle,
+        reinterpret_cast<const uint8_t*>(value.data()), value.length())) {
+      m_run->fail();
+    }
+  }
+
+private:
+  bool createDatabase() {
+    bt_uuid_t uuid;
+
+    m_db = gatt_db_new();
+    if (!m_db) {
+      return false;
+    }
+
+    //Each characteristic takes a declaration, a value and a CCC descriptor
+    for (unsigned int s = 0; s < m_options.services; s++) {
+      bt_uuid16_create(&uuid, 0xff00 + s);
+      gatt_db_attribute* service = gatt_db_add_service(m_db, &uuid, true, 1 + 3 * m_options.characteristics);
+      if (!service) {
+        return false;
+      }
+
+      for (unsigned int c = 0; c < m_options.characteristics; c++) {
+        bt_uuid16_create(&uuid, 0xfe00 + c);
+        gatt_db_attribute* attrib = gatt_db_service_add_characteristic(service, &uuid,
+          BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
+          BT_GATT_CHRC_PROP_READ | BT_GATT_CHRC_PROP_WRITE | BT_GATT_CHRC_PROP_WRITE_WITHOUT_RESP |
+          BT_GATT_CHRC_PROP_NOTIFY,
+          &EmulatedPeripheral::_onRead, &EmulatedPeripheral::_onWrite, this);
+
+        bt_uuid16_create(&uuid, GATT_CLIENT_CHARAC_CFG_UUID);
+        gatt_db_attribute* ccc = gatt_db_service_add_descriptor(attrib, &uuid,
+          BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
+          &EmulatedPeripheral::_onCccRead, &EmulatedPeripheral::_onCccWrite, this);
+
+        if (!attrib || !ccc) {
+          return false;
+        }
+
+        //The first characteristic is the one being measured
+        if (!m_valueHandle) {
+          m_valueHandle = gatt_db_attribute_get_handle(attrib);
+        }
+      }
+
+      gatt_db_service_set_active(service, true);
+    }
+
+    return true;
+  }
+
+  bool createVhci() {
+    uint8_t request[2] = { HCI_VENDOR_PKT, HCI_BREDR };
+    uint8_t response[4];
+
+    m_vhciFd = open("/dev/vhci", O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (m_vhciFd < 0) {
+      perror("open(/dev/vhci)");
+      return false;
+    }
+
+    if (write(m_vhciFd, request, sizeof(request)) != sizeof(request)) {
+      perror("write(/dev/vhci)");
+      close(m_vhciFd);
+      return false;
+    }
+
+    //The kernel answers with the index of the new controller
+    pollfd pfd = { m_vhciFd, POLLIN, 0 };
+    if (poll(&pfd, 1, 1000) != 1 || read(m_vhciFd, response, sizeof(response)) != sizeof(response) ||
+        response[0] != HCI_VENDOR_PKT) {
+      cerr << "No response from /dev/vhci" << endl;
+      close(m_vhciFd);
+      return false;
+    }
+
+    m_index = get_le16(&response[2]);
+
+    m_masterDev = btdev_create(BTDEV_TYPE_LE, 0x00);
+    if (!m_masterDev) {
+      close(m_vhciFd);
+      return false;
+    }
+
+    btdev_set_send_handler(m_masterDev, &EmulatedPeripheral::_writev, reinterpret_cast<void*>(m_vhciFd));
+
+    return addFd(m_vhciFd, &EmulatedPeripheral::_onDevData, m_masterDev);
+  }
+
+  bool createHost() {
+    int sv[2];
+
+    m_clientDev = btdev_create(BTDEV_TYPE_LE, 0x00);
+    m_host = bthost_create();
+    if (!m_clientDev || !m_host) {
+      return false;
+    }
+
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, sv) < 0) {
+      perror("socketpair()");
+      return false;
+    }
+
+    btdev_set_send_handler(m_clientDev, &EmulatedPeripheral::_writev, reinterpret_cast<void*>(sv[0]));
+    bthost_set_send_handler(m_host, &EmulatedPeripheral::_writev, reinterpret_cast<void*>(sv[1]));
+
+    return addFd(sv[0], &EmulatedPeripheral::_onDevData, m_clientDev) &&
+      addFd(sv[1], &EmulatedPeripheral::_onHostData, m_host);
+  }
+
+  bool addFd(int fd, mainloop_event_func callback, void* userData) {
+    if (mainloop_add_fd(fd, EPOLLIN, callback, userData, NULL) < 0) {
+      close(fd);
+      return false;
+    }
+
+    m_fds.push_back(fd);
+    return true;
+  }
+
+  bool powerOn() {
+    int ctl = socket(AF_BLUETOOTH, SOCK_RAW | SOCK_CLOEXEC, BTPROTO_HCI);
+    if (ctl < 0) {
+      perror("socket(BTPROTO_HCI)");
+      return false;
+    }
+
+    //bluetoothd may have beaten us to it
+    if (ioctl(ctl, HCIDEVUP, m_index) < 0 && errno != EALREADY) {
+      perror("ioctl(HCIDEVUP)");
+      close(ctl);
+      return false;
+    }
+
+    close(ctl);
+    return true;
+  }
+
+  static void _writev(const iovec* iov, int iovlen, void* userData) {
+    int fd = (int) reinterpret_cast<intptr_t>(userData);
+
+    if (writev(fd, iov, iovlen) < 0) {
+      perror("writev()");
+    }
+  }
+
+  static void _onDevData(int fd, uint32_t events, void* userData) {
+    uint8_t buf[4096];
+
+    if (events & (EPOLLERR | EPOLLHUP)) {
+      return;
+    }
+
+    ssize_t len = read(fd, buf, sizeof(buf));
+    if (len < 1) {
+      return;
+    }
+
+    switch (buf[0]) {
+    case HCI_COMMAND_PKT:
+    case HCI_ACLDATA_PKT:
+    case HCI_SCODATA_PKT:
+      btdev_receive_h4(static_cast<btdev*>(userData), buf, len);
+      break;
+    }
+  }
+
+  static void _onHostData(int fd, uint32_t events, void* userData) {
+    uint8_t buf[4096];
+
+    if (events & (EPOLLERR | EPOLLHUP)) {
+      return;
+    }
+
+    ssize_t len = read(fd, buf, sizeof(buf));
+    if (len > 0) {
+      bthost_receive_h4(static_cast<bthost*>(userData), buf, len);
+    }
+  }
+
+  static Event s_hostReady;
+
+  static void _onHostReady() {
+    s_hostReady.set();
+  }
+
+  static void _onConnect(uint16_t handle, void* obj) {
+    static_cast<EmulatedPeripheral*>(obj)->onConnect(handle);
+  }
+
+  void onConnect(uint16_t handle) {
+    if (m_bridges.count(handle)) {
+      return;
+    }
+
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, sv) < 0) {
+      perror("socketpair()");
+      return;
+    }
+
+    AttBridge* bridge = new AttBridge;
+    bridge->peripheral = this;
+    bridge->handle = handle;
+    bridge->fd = sv[0];
+    bridge->att = bt_att_new(sv[1], false);
+    bridge->server = NULL;
+
+    if (bridge->att) {
+      bt_att_set_close_on_unref(bridge->att, true);
+      bridge->server = bt_gatt_server_new(m_db, bridge->att, BT_ATT_MAX_LE_MTU);
+    } else {
+      close(sv[1]);
+    }
+
+    if (!bridge->server || mainloop_add_fd(sv[0], EPOLLIN, &EmulatedPeripheral::_onBridgeData, bridge, NULL) < 0) {
+      bt_gatt_server_unref(bridge->server);
+      bt_att_unref(bridge->att);
+      close(sv[0]);
+      delete bridge;
+      return;
+    }
+
+    bthost_add_cid_hook(m_host, handle, ATT_CID, &EmulatedPeripheral::_onAttData, bridge);
+
+    m_bridges[handle] = bridge;
+    m_bridge = bridge;
+  }
+
+  //ATT PDUs from the central go to the server end of the socketpair
+  static void _onAttData(const void* data, uint16_t len, void* userData) {
+    AttBridge* bridge = static_cast<AttBridge*>(userData);
+
+    if (write(bridge->fd, data, len) < 0) {
+      perror("write(ATT)");
+    }
+  }
+
+  //and whatever the server sends goes back out over the link
+  static void _onBridgeData(int fd, uint32_t events, void* userData) {
+    AttBridge* bridge = static_cast<AttBridge*>(userData);
+    uint8_t buf[BT_ATT_MAX_LE_MTU];
+
+    if (events & (EPOLLERR | EPOLLHUP)) {
+      return;
+    }
+
+    ssize_t len = read(fd, buf, sizeof(buf));
+    if (len > 0) {
+      bthost_send_cid(bridge->peripheral->m_host, bridge->handle, ATT_CID, buf, len);
+    }
+  }
+
+  static void _onRead(gatt_db_attribute* attrib, unsigned int id, uint16_t offset, uint8_t opcode, bt_att* att,
+    void* obj) {
+    EmulatedPeripheral* peripheral = static_cast<EmulatedPeripheral*>(obj);
+    size_t length = peripheral->m_run ? peripheral->m_run->payload() : 0;
+    vector<uint8_t> value(max(length, (size_t) 1), 0x5a);
+
+    gatt_db_attribute_read_result(attrib, id, 0, value.data() + min((size_t) offset, length),
+      length - min((size_t) offset, length));
+  }
+
+  static void _onWrite(gatt_db_attribute* attrib, unsigned int id, uint16_t offset, const uint8_t* value,
+    size_t length, uint8_t opcode, bt_att* att, void* obj) {
+    EmulatedPeripheral* peripheral = static_cast<EmulatedPeripheral*>(obj);
+
+    gatt_db_attribute_write_result(attrib, id, 0);
+
+    //Write commands complete when they get here, requests when the client
+    //sees the response
+    if (opcode == BT_ATT_OP_WRITE_CMD && peripheral->m_run) {
+      peripheral->m_run->complete(value, length);
+
+      if (peripheral->m_onWriteCommand) {
+        peripheral->m_onWriteCommand();
+      }
+    }
+  }
+
+  static void _onCccRead(gatt_db_attribute* attrib, unsigned int id, uint16_t offset, uint8_t opcode, bt_att* att,
+    void* obj) {
+    EmulatedPeripheral* peripheral = static_cast<EmulatedPeripheral*>(obj);
+    uint8_t value[2];
+
+    put_le16(peripheral->m_notifyEnabled ? 0x0001 : 0x0000, value);
+    gatt_db_attribute_read_result(attrib, id, 0, value, sizeof(value));
+  }
+
+  static void _onCccWrite(gatt_db_attribute* attrib, unsigned int id, uint16_t offset, const uint8_t* value,
+    size_t length, uint8_t opcode, bt_att* att, void* obj) {
+    EmulatedPeripheral* peripheral = static_cast<EmulatedPeripheral*>(obj);
+
+    if (length == 2 && !offset) {
+      peripheral->m_notifyEnabled = get_le16(value) & 0x0001;
+    }
+
+    gatt_db_attribute_write_result(attrib, id, 0);
+  }
+
+  const Options& m_options;
+  int m_vhciFd;
+  int m_index;
+  btdev* m_masterDev;
+  btdev* m_clientDev;
+  bthost* m_host;
+  gatt_db* m_db;
+  uint16_t m_valueHandle;
+  vector<int> m_fds;
+  map<uint16_t, AttBridge*> m_bridges;
+  AttBridge* m_bridge;
+  Run* m_run;
+  function<void()> m_onWriteCommand;
+  bool m_notifyEnabled;
+};
+
+Event EmulatedPeripheral::s_hostReady;
+
+class BenchmarkClient : public GattClient, public IGattCharacteristicCallback {
+public:
+  BenchmarkClient(uint16_t mtu, EmulatedPeripheral& peripheral) :
+    GattClient(mtu),
+    m_peripheral(peripheral),
+    m_characteristic(NULL),
+    m_run(NULL),
+    m_discoverySuccess(false),
+    m_registrationStatus(0) {
+  }
+
+  bool discover(const string& address) {
+    if (!connect(address)) {
+      return false;
+    }
+
+    if (!m_discovered.wait() || !m_discoverySuccess) {
+      cerr << "Service discovery failed" << endl;
+      return false;
+    }
+
+    for (auto s = ServiceCollectionBegin(); s != ServiceCollectionEnd() && !m_characteristic; ++s) {
+      for (auto c = (*s)->CharacteristicCollectionBegin(); c != (*s)->CharacteristicCollectionEnd(); ++c) {
+        if ((*c)->getValueHandle() == m_peripheral.valueHandle()) {
+          m_characteristic = *c;
+          break;
+        }
+      }
+    }
+
+    if (!m_characteristic) {
+      cerr << "Benchmark characteristic not found" << endl;
+      return false;
+    }
+
+    m_characteristic->bind(this);
+    return true;
+  }
+
+  bool subscribe() {
+    if (m_peripheral.notifyEnabled()) {
+      return true;
+    }
+
+    m_registered.reset();
+    runOnMainLoop([this]() {
+      if (!m_characteristic->registerNotify()) {
+        m_registrationStatus = 0xffff;
+        m_registered.set();
+      }
+    });
+
+    return m_registered.wait() && !m_registrationStatus;
+  }
+
+  //Issues the first operations of run on the mainloop thread, later ones are
+  //issued as earlier ones complete
+  void start(Run* run) {
+    runOnMainLoop([this, run]() {
+      m_run = run;
+      m_peripheral.setRun(run, [this]() { issue(); });
+
+      unsigned int depth = (run->operation() == Operation::Read || run->operation() == Operation::Write) ?
+        1 : run->window();
+
+      for (unsigned int i = 0; i < depth && run->pending(); i++) {
+        issue();
+      }
+    });
+  }
+
+  void stop() {
+    Event stopped;
+
+    runOnMainLoop([this, &stopped]() {
+      m_run = NULL;
+      m_peripheral.setRun(NULL);
+      stopped.set();
+    });
+
+    stopped.wait();
+  }
+
+  virtual void onServicesDiscovered(bool success, uint8_t attErrorCode) {
+    m_discoverySuccess = success;
+    m_discovered.set();
+  }
+
+  virtual void onReadResponse(bool success, uint8_t attErrorCode, std::string value) {
+    //Read values can't carry a sequence number, only one is in flight
+    if (!m_run) {
+      return;
+    }
+
+    if (!success) {
+      m_run->fail();
+      return;
+    }
+
+    m_run->complete(m_readSeq);
+    issue();
+  }
+
+  virtual void onWriteResponse(bool success, uint8_t attErrorCode) {
+    if (!m_run) {
+      return;
+    }
+
+    if (!success) {
+      m_run->fail();
+      return;
+    }
+
+    m_run->complete(m_writeSeq);
+    issue();
+  }
+
+  virtual void onRegistration(uint16_t attErrorCode) {
+    m_registrationStatus = attErrorCode;
+    m_registered.set();
+  }
+
+  virtual void onNotification(std::string value) {
+    if (!m_run) {
+      return;
+    }
+
+    m_run->complete(reinterpret_cast<const uint8_t*>(value.data()), value.length());
+    m_peripheral.sendNotification();
+  }
+
+private:
+  void issue() {
+    string value;
+
+    if (!m_run || !m_run->pending()) {
+      return;
+    }
+
+    switch (m_run->operation()) {
+    case Operation::Read:
+      m_readSeq = m_run->issue(value);
+      if (!m_characteristic->read()) {
+        m_run->fail();
+      }
+      break;
+    case Operation::Write:
+      m_writeSeq = m_run->issue(value);
+      if (!m_characteristic->write(value, true)) {
+        m_run->fail();
+      }
+      break;
+    case Operation::WriteWithoutResponse:
+      m_run->issue(value);
+      if (!m_characteristic->write(value, false)) {
+        m_run->fail();
+      }
+      break;
+    case Operation::Notify:
+      m_peripheral.sendNotification();
+      break;
+    }
+  }
+
+  EmulatedPeripheral& m_peripheral;
+  GattCharacteristic* m_characteristic;
+  Run* m_run;
+  uint32_t m_readSeq;
+  uint32_t m_writeSeq;
+  bool m_discoverySuccess;
+  uint16_t m_registrationStatus;
+  Event m_discovered;
+  Event m_registered;
+};
+
+struct Result {
+  string name;
+  uint16_t mtu;
+  size_t payload;
+  unsigned int count;
+  double opsPerSecond;
+  double p50;
+  double p99;
+  double cpuPerOp;
+};
+
+double cpuMicroseconds() {
+  rusage usage;
+
+  getrusage(RUSAGE_SELF, &usage);
+  return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e6 + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+double percentile(const vector<double>& sorted, double p) {
+  if (sorted.empty()) {
+    return 0;
+  }
+
+  size_t index = (size_t) (p * (sorted.size() - 1) + 0.5);
+  return sorted[min(index, sorted.size() - 1)];
+}
+
+bool measure(BenchmarkClient& client, EmulatedPeripheral& peripheral, Operation operation, uint16_t mtu,
+  const Options& options, Result& result) {
+  //Every value fills a single PDU: opcode and handle take 3 octets
+  size_t payload = mtu - 3;
+
+  if (operation == Operation::Notify && !client.subscribe()) {
+    cerr << "Enabling notifications failed" << endl;
+    return false;
+  }
+
+  //A short warm up so caches and the link are settled before timing
+  Run warmup(operation, min(options.count, 64u), options.window, payload);
+  client.start(&warmup);
+  bool ok = warmup.wait() && !warmup.failed();
+  client.stop();
+
+  if (!ok) {
+    return false;
+  }
+
+  Run run(operation, options.count, options.window, payload);
+  double cpu = cpuMicroseconds();
+  Clock::time_point start = Clock::now();
+
+  client.start(&run);
+  ok = run.wait() && !run.failed();
+  client.stop();
+
+  double seconds = chrono::duration<double>(Clock::now() - start).count();
+  cpu = cpuMicroseconds() - cpu;
+
+  if (!ok) {
+    return false;
+  }
+
+  vector<double> latencies = run.latencies();
+  sort(latencies.begin(), latencies.end());
+
+  result.name = operationName(operation);
+  result.mtu = mtu;
+  result.payload = payload;
+  result.count = options.count;
+  result.opsPerSecond = options.count / seconds;
+  result.p50 = percentile(latencies, 0.50);
+  result.p99 = percentile(latencies, 0.99);
+  result.cpuPerOp = cpu / options.count;
+  return true;
+}
+
+void printText(const vector<Result>& results) {
+  for (auto i = results.begin(); i != results.end(); ++i) {
+    cout << i->name << "/mtu" << i->mtu << ": " << i->opsPerSecond << " ops/s, p50 " << i->p50 << " us, p99 "
+         << i->p99 << " us, " << i->cpuPerOp << " cpu us/op (" << i->payload << " byte values)" << endl;
+  }
+}
+
+void printJson(const vector<Result>& results) {
+  cout << "[" << endl;
+
+  for (auto i = results.begin(); i != results.end(); ++i) {
+    cout << "  {\"name\": \"" << i->name << "\", \"mtu\": " << i->mtu << ", \"payload\": " << i->payload
+         << ", \"count\": " << i->count << ", \"ops_per_sec\": " << i->opsPerSecond
+         << ", \"p50_us\": " << i->p50 << ", \"p99_us\": " << i->p99
+         << ", \"cpu_us_per_op\": " << i->cpuPerOp << "}"
+         << (i + 1 != results.end() ? "," : "") << endl;
+  }
+
+  cout << "]" << endl;
+}
+
+bool parseList(const string& arg, vector<string>& values) {
+  stringstream stream(arg);
+  string value;
+
+  values.clear();
+  while (getline(stream, value, ',')) {
+    if (value.empty()) {
+      return false;
+    }
+
+    values.push_back(value);
+  }
+
+  return !values.empty();
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+  vector<string> values;
+
+  options.mtus = { BT_ATT_DEFAULT_LE_MTU, 185, 247, BT_ATT_MAX_LE_MTU };
+  options.operations = { Operation::Read, Operation::Write, Operation::WriteWithoutResponse, Operation::Notify };
+  options.count = 2000;
+  options.window = 16;
+  options.services = 4;
+  options.characteristics = 4;
+  options.json = false;
+
+  for (int i = 1; i < argc; i++) {
+    string arg = argv[i];
+    string value = i + 1 < argc ? argv[i + 1] : "";
+
+    if (arg == "--json") {
+      options.json = true;
+      continue;
+    }
+
+    if (value.empty()) {
+      return false;
+    }
+
+    i++;
+
+    if (arg == "--mtu") {
+      if (!parseList(value, values)) {
+        return false;
+      }
+
+      options.mtus.clear();
+      for (auto v = values.begin(); v != values.end(); ++v) {
+        unsigned long mtu = strtoul(v->c_str(), NULL, 0);
+        if (mtu < BT_ATT_DEFAULT_LE_MTU || mtu > BT_ATT_MAX_LE_MTU) {
+          return false;
+        }
+
+        options.mtus.push_back(mtu);
+      }
+    } else if (arg == "--ops") {
+      if (!parseList(value, values)) {
+        return false;
+      }
+
+      options.operations.clear();
+      for (auto v = values.begin(); v != values.end(); ++v) {
+        if (*v == "read") {
+          options.operations.push_back(Operation::Read);
+        } else if (*v == "write") {
+          options.operations.push_back(Operation::Write);
+        } else if (*v == "write-cmd") {
+          options.operations.push_back(Operation::WriteWithoutResponse);
+        } else if (*v == "notify") {
+          options.operations.push_back(Operation::Notify);
+        } else {
+          return false;
+        }
+      }
+    } else if (arg == "--count") {
+      options.count = strtoul(value.c_str(), NULL, 0);
+    } else if (arg == "--window") {
+      options.window = strtoul(value.c_str(), NULL, 0);
+    } else if (arg == "--services") {
+      options.services = strtoul(value.c_str(), NULL, 0);
+    } else if (arg == "--characteristics") {
+      options.characteristics = strtoul(value.c_str(), NULL, 0);
+    } else {
+      return false;
+    }
+  }
+
+  //Handles are 16 bits and each characteristic takes three
+  return options.count && options.window && options.services && options.characteristics &&
+    options.services * (1 + 3 * options.characteristics) < 0xffff;
+}
+} //namespace
+
+int main(int argc, char* argv[]) {
+  Options options;
+
+  if (!parseOptions(argc, argv, options)) {
+    cerr << "Usage: " << argv[0] << " [--json] [--mtu 23,185,247,517] [--ops read,write,write-cmd,notify]" << endl
+         << "  [--count 2000] [--window 16] [--services 4] [--characteristics 4]" << endl;
+    return 1;
+  }
+
+  MainLoop& mainLoop = MainLoop::getInstance();
+  mainLoop.ref();
+
+  if (!waitForMainLoop()) {
+    cerr << "Main loop did not start" << endl;
+    mainLoop.unref();
+    return 1;
+  }
+
+  vector<Result> results;
+  int status = 0;
+
+  {
+    EmulatedPeripheral peripheral(options);
+
+    if (!peripheral.start()) {
+      mainLoop.unref();
+      return 1;
+    }
+
+    //Each MTU needs its own connection since it is only exchanged once
+    for (auto mtu = options.mtus.begin(); mtu != options.mtus.end() && !status; ++mtu) {
+      BenchmarkClient client(*mtu, peripheral);
+
+      if (!client.discover(peripheral.address())) {
+        status = 1;
+        break;
+      }
+
+      for (auto operation = options.operations.begin(); operation != options.operations.end(); ++operation) {
+        Result result;
+
+        if (!measure(client, peripheral, *operation, *mtu, options, result)) {
+          cerr << operationName(*operation) << "/mtu" << *mtu << " failed" << endl;
+          status = 1;
+          break;
+        }
+
+        results.push_back(result);
+      }
+
+      client.disconnect();
+    }
+  }
+
+  if (options.json) {
+    printJson(results);
+  } else {
+    printText(results);
+  }
+
+  mainLoop.unref();
+  return status;
+}
@@ -0,0 +1,492 @@
+extern "C" {
+  #include "bluetooth.h"
+  #include "hci.h"
+  #include "uuid.h"
+  #include "queue.h"
+  #include "crypto.h"
+  #include "ecc.h"
+  #include "att-types.h"
+  #include "gatt-db.h"
+}
+
+#include "BleAdvertisement.h"
+#include "RpaResolver.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace bluez::native;
+
+//Every allocation in the process goes through here, including the ones made
+//by operator new, so each benchmark can report how many it costs per call.
+extern "C" {
+  void* __libc_malloc(size_t size);
+  void* __libc_calloc(size_t nmemb, size_t size);
+  void* __libc_realloc(void* ptr, size_t size);
+}
+
+namespace {
+uint64_t allocations = 0;
+}
+
+extern "C" void* malloc(size_t size) __THROW {
+  allocations++;
+  return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t nmemb, size_t size) __THROW {
+  allocations++;
+  return __libc_calloc(nmemb, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size) __THROW {
+  allocations++;
+  return __libc_realloc(ptr, size);
+}
+
+namespace {
+typedef chrono::steady_clock Clock;
+
+const double MinNanoseconds = 200e6;
+
+struct Result {
+  string name;
+  double nsPerOp;
+  double allocsPerOp;
+  uint64_t iterations;
+};
+
+vector<Result> results;
+string filter;
+
+//Keeps the compiler from discarding results that are otherwise unused
+volatile uint64_t sink;
+
+//Runs body(i) for growing iteration counts until one batch takes at least
+//MinNanoseconds, then records that batch.
+template<class F>
+void bench(const string& name, F body) {
+  if (name.find(filter) == string::npos) {
+    return;
+  }
+
+  uint64_t iterations = 1;
+
+  for (;;) {
+    uint64_t allocs = allocations;
+    Clock::time_point start = Clock::now();
+
+    for (uint64_t i = 0; i < iterations; i++) {
+      body(i);
+    }
+
+    double ns = chrono::duration<double, nano>(Clock::now() - start).count();
+    allocs = allocations - allocs;
+
+    if (ns >= MinNanoseconds || iterations >= (1ull << 32)) {
+      Result result = { name, ns / iterations, (double) allocs / iterations, iterations };
+      results.push_back(result);
+      return;
+    }
+
+    //Aim a little past the target so the final batch rarely falls short
+    uint64_t next = ns > 0 ? (uint64_t) (iterations * MinNanoseconds * 1.2 / ns) : 0;
+    iterations = max(iterations * 2, min(next, iterations * 100));
+  }
+}
+
+void printText() {
+  for (auto i = results.begin(); i != results.end(); ++i) {
+    cout << i->name << ": " << i->nsPerOp << " ns/op, "
+         << i->allocsPerOp << " allocs/op" << endl;
+  }
+}
+
+void printJson() {
+  cout << "[" << endl;
+
+  for (auto i = results.begin(); i != results.end(); ++i) {
+    cout << "  {\"name\": \"" << i->name << "\", \"ns_per_op\": " << i->nsPerOp
+         << ", \"allocs_per_op\": " << i->allocsPerOp
+         << ", \"iterations\": " << i->iterations << "}"
+         << (i + 1 != results.end() ? "," : "") << endl;
+  }
+
+  cout << "]" << endl;
+}
+
+void fill(uint8_t* buf, size_t len, uint8_t seed) {
+  for (size_t i = 0; i < len; i++) {
+    buf[i] = (uint8_t) (seed + i * 37);
+  }
+}
+
+void benchCrypto(const string& suffix, bt_crypto* crypto) {
+  uint8_t k[16], r[16], r2[16], out[16];
+  uint8_t u[32], v[32], w[32];
+  uint8_t a1[7], a2[7], ioCap[3], pres[7], preq[7];
+  uint8_t msg[64], signature[12], mackey[16], ltk[16];
+  uint32_t val;
+
+  fill(k, sizeof(k), 1);
+  fill(r, sizeof(r), 2);
+  fill(r2, sizeof(r2), 3);
+  fill(u, sizeof(u), 4);
+  fill(v, sizeof(v), 5);
+  fill(w, sizeof(w), 6);
+  fill(a1, sizeof(a1), 7);
+  fill(a2, sizeof(a2), 8);
+  fill(ioCap, sizeof(ioCap), 9);
+  fill(pres, sizeof(pres), 10);
+  fill(preq, sizeof(preq), 11);
+  fill(msg, sizeof(msg), 12);
+
+  bench("bt_crypto_e" + suffix, [&](uint64_t i) {
+    r[0] = i;
+    bt_crypto_e(crypto, k, r, out);
+    sink += out[0];
+  });
+
+  bench("bt_crypto_ah" + suffix, [&](uint64_t i) {
+    r[0] = i;
+    bt_crypto_ah(crypto, k, r, out);
+    sink += out[0];
+  });
+
+  bench("bt_crypto_c1" + suffix, [&](uint64_t i) {
+    r[0] = i;
+    bt_crypto_c1(crypto, k, r, pres, preq, 0, a1, 1, a2, out);
+    sink += out[0];
+  });
+
+  bench("bt_crypto_s1" + suffix, [&](uint64_t i) {
+    r[0] = i;
+    bt_crypto_s1(crypto, k, r, r2, out);
+    sink += out[0];
+  });
+
+  bench("bt_crypto_f4" + suffix, [&](uint64_t i) {
+    u[0] = i;
+    bt_crypto_f4(crypto, u, v, k, 0, out);
+    sink += out[0];
+  });
+
+  bench("bt_crypto_f5" + suffix, [&](uint64_t i) {
+    w[0] = i;
+    bt_crypto_f5(crypto, w, r, r2, a1, a2, mackey, ltk);
+    sink += ltk[0];
+  });
+
+  bench("bt_crypto_f6" + suffix, [&](uint64_t i) {
+    r[0] = i;
+    bt_crypto_f6(crypto, k, r, r2, r2, ioCap, a1, a2, out);
+    sink += out[0];
+  });
+
+  bench("bt_crypto_g2" + suffix, [&](uint64_t i) {
+    u[0] = i;
+    bt_crypto_g2(crypto, u, v, r, r2, &val);
+    sink += val;
+  });
+
+  bench("bt_crypto_sign_att/64" + suffix, [&](uint64_t i) {
+    bt_crypto_sign_att(crypto, k, msg, sizeof(msg), i, signature);
+    sink += signature[0];
+  });
+
+  //Roughly a database of 8 services with 4 characteristics each
+  uint8_t records[64][21];
+  iovec iov[64];
+
+  for (size_t j = 0; j < 64; j++) {
+    fill(records[j], sizeof(records[j]), j);
+    iov[j].iov_base = records[j];
+    iov[j].iov_len = (j % 4) ? 7 : sizeof(records[j]);
+  }
+
+  bench("bt_crypto_gatt_hash/64" + suffix, [&](uint64_t i) {
+    records[0][0] = i;
+    bt_crypto_gatt_hash(crypto, iov, 64, out);
+    sink += out[0];
+  });
+}
+
+void benchEcc() {
+  uint8_t publicKey[64], privateKey[32], peerKey[64], peerPrivate[32], secret[32];
+
+  if (!ecc_make_key(peerKey, peerPrivate) || !ecc_make_key(publicKey, privateKey)) {
+    cerr << "ecc_make_key failed" << endl;
+    return;
+  }
+
+  bench("ecc_make_key", [&](uint64_t i) {
+    ecc_make_key(publicKey, privateKey);
+    sink += publicKey[0];
+  });
+
+  bench("ecdh_shared_secret", [&](uint64_t i) {
+    ecdh_shared_secret(peerKey, privateKey, secret);
+    sink += secret[0];
+  });
+}
+
+void benchUuid() {
+  bt_uuid_t a16, b16, a128, b128;
+  uint128_t value;
+  char str[MAX_LEN_UUID_STR];
+
+  bt_uuid16_create(&a16, 0x2a00);
+  bt_uuid16_create(&b16, 0x2a01);
+  bt_string_to_uuid(&a128, "0000180d-0000-1000-8000-00805f9b34fb");
+  fill(value.data, sizeof(value.data), 13);
+  bt_uuid128_create(&b128, value);
+
+  bench("bt_uuid_cmp/16-16", [&](uint64_t i) {
+    sink += bt_uuid_cmp(&a16, &b16);
+  });
+
+  bench("bt_uuid_cmp/16-128", [&](uint64_t i) {
+    sink += bt_uuid_cmp(&a16, &a128);
+  });
+
+  bench("bt_uuid_cmp/128-128", [&](uint64_t i) {
+    sink += bt_uuid_cmp(&a128, &b128);
+  });
+
+  bench("bt_uuid_to_string/16", [&](uint64_t i) {
+    bt_uuid_to_string(&a16, str, sizeof(str));
+    sink += str[0];
+  });
+
+  bench("bt_uuid_to_string/128", [&](uint64_t i) {
+    bt_uuid_to_string(&b128, str, sizeof(str));
+    sink += str[0];
+  });
+}
+
+void* toPtr(uintptr_t value) {
+  return reinterpret_cast<void*>(value);
+}
+
+unsigned int keyOf(const void* data) {
+  return static_cast<unsigned int>(reinterpret_cast<uintptr_t>(data));
+}
+
+bool matchValue(const void* data, const void* matchData) {
+  return data == matchData;
+}
+
+void countEntry(void* data, void* userData) {
+  (*static_cast<uint64_t*>(userData))++;
+}
+
+void benchQueue() {
+  queue* q = queue_new();
+
+  bench("queue_push_tail+pop_head", [&](uint64_t i) {
+    queue_push_tail(q, toPtr(i + 1));
+    sink += reinterpret_cast<uintptr_t>(queue_pop_head(q));
+  });
+
+  for (unsigned int i = 1; i <= 64; i++) {
+    queue_push_tail(q, toPtr(i));
+  }
+
+  bench("queue_find/64", [&](uint64_t i) {
+    sink += reinterpret_cast<uintptr_t>(queue_find(q, matchValue, toPtr(i % 64 + 1)));
+  });
+
+  bench("queue_foreach/64", [&](uint64_t i) {
+    uint64_t count = 0;
+    queue_foreach(q, countEntry, &count);
+    sink += count;
+  });
+
+  bench("queue_remove+push_tail/64", [&](uint64_t i) {
+    queue_remove(q, toPtr(i % 64 + 1));
+    queue_push_tail(q, toPtr(i % 64 + 1));
+  });
+
+  queue_destroy(q, NULL);
+
+  q = queue_new_ring(0);
+
+  bench("queue_push_tail+pop_head/ring", [&](uint64_t i) {
+    queue_push_tail(q, toPtr(i + 1));
+    sink += reinterpret_cast<uintptr_t>(queue_pop_head(q));
+  });
+
+  queue_destroy(q, NULL);
+
+  q = queue_new_keyed(keyOf);
+
+  for (unsigned int i = 1; i <= 64; i++) {
+    queue_push_tail(q, toPtr(i));
+  }
+
+  bench("queue_find_by_key/64", [&](uint64_t i) {
+    sink += reinterpret_cast<uintptr_t>(queue_find_by_key(q, i % 64 + 1));
+  });
+
+  bench("queue_remove_by_key+push_tail/64", [&](uint64_t i) {
+    queue_push_tail(q, queue_remove_by_key(q, i % 64 + 1));
+  });
+
+  queue_destroy(q, NULL);
+}
+
+void countAttribute(gatt_db_attribute* attrib, void* userData) {
+  (*static_cast<uint64_t*>(userData))++;
+}
+
+void benchGattDb() {
+  gatt_db* db = gatt_db_new();
+  bt_uuid_t uuid, primary, characteristic;
+  uint16_t handles = 0;
+
+  //32 services of 8 characteristics, each with a client configuration
+  //descriptor: 1 + 8 * 3 handles per service
+  for (uint16_t s = 0; s < 32; s++) {
+    bt_uuid16_create(&uuid, 0x1800 + s);
+    gatt_db_attribute* service = gatt_db_add_service(db, &uuid, true, 25);
+
+    for (uint16_t c = 0; c < 8; c++) {
+      bt_uuid16_create(&uuid, 0x2a00 + s * 8 + c);
+      gatt_db_attribute* attrib = gatt_db_service_add_characteristic(service, &uuid,
+        BT_ATT_PERM_READ | BT_ATT_PERM_WRITE, BT_GATT_CHRC_PROP_READ | BT_GATT_CHRC_PROP_NOTIFY,
+        NULL, NULL, NULL);
+
+      bt_uuid16_create(&uuid, GATT_CLIENT_CHARAC_CFG_UUID);
+      gatt_db_service_add_descriptor(attrib, &uuid, BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
+        NULL, NULL, NULL);
+    }
+
+    gatt_db_service_set_active(service, true);
+    handles += 25;
+  }
+
+  bt_uuid16_create(&primary, GATT_PRIM_SVC_UUID);
+  bt_uuid16_create(&characteristic, GATT_CHARAC_UUID);
+
+  bench("gatt_db_get_attribute/800", [&](uint64_t i) {
+    sink += reinterpret_cast<uintptr_t>(gatt_db_get_attribute(db, i % handles + 1));
+  });
+
+  bench("gatt_db_find_by_type/primary", [&](uint64_t i) {
+    uint64_t count = 0;
+    gatt_db_find_by_type(db, 1, 0xffff, &primary, countAttribute, &count);
+    sink += count;
+  });
+
+  queue* q = queue_new();
+
+  bench("gatt_db_read_by_type/characteristic", [&](uint64_t i) {
+    gatt_db_read_by_type(db, 1, 0xffff, characteristic, q);
+    sink += queue_length(q);
+    queue_remove_all(q, NULL, NULL, NULL);
+  });
+
+  bench("gatt_db_find_information/25", [&](uint64_t i) {
+    uint16_t start = (i % 32) * 25 + 1;
+    gatt_db_find_information(db, start, start + 24, q);
+    sink += queue_length(q);
+    queue_remove_all(q, NULL, NULL, NULL);
+  });
+
+  queue_destroy(q, NULL);
+  gatt_db_unref(db);
+}
+
+void benchAdvertisement() {
+  //Flags, 16 bit service list, name, tx power and manufacturer data
+  const uint8_t data[] = {
+    0x02, 0x01, 0x06,
+    0x05, 0x03, 0x0d, 0x18, 0x0f, 0x18,
+    0x09, 0x09, 'B', 'e', 'n', 'c', 'h', 'm', 'r', 'k',
+    0x02, 0x0a, 0x04,
+    0x07, 0xff, 0x4c, 0x00, 0x02, 0x15, 0x01, 0x02
+  };
+  uint8_t buffer[LE_ADVERTISING_INFO_SIZE + sizeof(data) + 1];
+  le_advertising_info* info = reinterpret_cast<le_advertising_info*>(buffer);
+
+  info->evt_type = 0x00;
+  info->bdaddr_type = LE_RANDOM_ADDRESS;
+  str2ba("5A:11:22:33:44:55", &info->bdaddr);
+  info->length = sizeof(data);
+  memcpy(buffer + LE_ADVERTISING_INFO_SIZE, data, sizeof(data));
+  buffer[sizeof(buffer) - 1] = (uint8_t) -60;
+
+  bench("BleAdvertisement::parse", [&](uint64_t i) {
+    BleAdvertisement* adv = BleAdvertisement::parse(info);
+    sink += adv->rssi();
+    delete adv;
+  });
+
+  //An address none of the IRKs resolve, so only the first call is a miss
+  RpaResolver resolver;
+  char irk[33], address[18];
+
+  for (unsigned int i = 0; i < 64; i++) {
+    snprintf(irk, sizeof(irk), "%032x", i + 1);
+    snprintf(address, sizeof(address), "00:11:22:33:44:%02X", i);
+    resolver.addIrk(irk, address, "public");
+  }
+
+  bench("BleAdvertisement::parse/rpa64", [&](uint64_t i) {
+    BleAdvertisement* adv = BleAdvertisement::parse(info, &resolver);
+    sink += adv->resolved();
+    delete adv;
+  });
+}
+} //namespace
+
+int main(int argc, char* argv[]) {
+  bool json = false;
+
+  for (int i = 1; i < argc; i++) {
+    string arg = argv[i];
+
+    if (arg == "--json") {
+      json = true;
+    } else if (arg.size() && arg[0] != '-') {
+      filter = arg;
+    } else {
+      cerr << "Usage: " << argv[0] << " [--json] [name filter]" << endl;
+      return 1;
+    }
+  }
+
+  bt_crypto* crypto = bt_crypto_new();
+  if (crypto) {
+    benchCrypto("", crypto);
+    bt_crypto_unref(crypto);
+  }
+
+  //Only there when the kernel exposes the crypto API sockets
+  crypto = bt_crypto_new_backend(BT_CRYPTO_BACKEND_AF_ALG);
+  if (crypto) {
+    benchCrypto("/af_alg", crypto);
+    bt_crypto_unref(crypto);
+  }
+
+  benchEcc();
+  benchUuid();
+  benchQueue();
+  benchGattDb();
+  benchAdvertisement();
+
+  if (json) {
+    printJson();
+  } else {
+    printText();
+  }
+
+  return 0;
+}
@@ -10,6 +10,9 @@ class BtAdapter:
   def disableScanning(self):
     return self.btAdapter.disableScanning()
 
+  def setRpaResolver(self, resolver):
+    self.btAdapter.setRpaResolver(resolver)
+
   def onAdvertisementScanned(self, adv):
     pass
 
@@ -19,6 +22,9 @@ class BtAdapter:
     print '  Address Type: {0}'.format(adv.addressType)
     print '  RSSI: {0}'.format(adv.rssi)
 
+    if (adv.resolved):
+      print '  Identity Address: {0} ({1})'.format(adv.identityAddress, adv.identityAddressType)
+
     if (adv.shortenedLocalName is not None):
       print '  Shortened Local Name: {0}'.format(adv.shortenedLocalName)
 
@@ -91,3 +97,42 @@ class GattClient(object):
 
   def disconnect(self):
     return self.client.disconnect()
+
+class LocalCharacteristic:
+  def __init__(self, char):
+    self.char = char
+    char.bind(self)
+
+  def notify(self, value):
+    return self.char.notify(value)
+
+  def onRead(self, btAddress):
+    # Return None to serve the cached value, a string to replace it or an
+    # AttErrorCode to reject the read
+    return None
+
+  def onWrite(self, btAddress, value):
+    # Return None to accept the write or an AttErrorCode to reject it
+    return None
+
+  def onSubscriptionChanged(self, btAddress, notify, indicate):
+    pass
+
+class GattServer(object):
+  def __init__(self):
+    self.server = blueberrypy.GattServer(self)
+
+  def addService(self, service):
+    return self.server.addService(service)
+
+  def start(self):
+    return self.server.start()
+
+  def stop(self):
+    return self.server.stop()
+
+  def onConnected(self, btAddress):
+    pass
+
+  def onDisconnected(self, btAddress, err):
+    pass
@@ -154,6 +154,9 @@ struct btconn {
 	struct rfcomm_chan_hook *rfcomm_chan_hooks;
 	struct btconn *next;
 	void *smp_data;
+	uint8_t *recv_data;	/* L2CAP frame being reassembled */
+	uint16_t recv_len;
+	uint16_t data_len;
 };
 
 struct l2conn {
@@ -256,6 +259,8 @@ static void btconn_free(struct btconn *conn)
 	if (conn->smp_data)
 		smp_conn_del(conn->smp_data);
 
+	free(conn->recv_data);
+
 	while (conn->l2conns) {
 		struct l2conn *l2conn = conn->l2conns;
 
@@ -2136,35 +2141,23 @@ static void process_rfcomm(struct bthost *bthost, struct btconn *conn,
 	}
 }
 
-static void process_acl(struct bthost *bthost, const void *data, uint16_t len)
+static void process_l2cap(struct bthost *bthost, struct btconn *conn,
+					const void *data, uint16_t len)
 {
-	const struct bt_hci_acl_hdr *acl_hdr = data;
-	const struct bt_l2cap_hdr *l2_hdr = data + sizeof(*acl_hdr);
-	uint16_t handle, cid, acl_len, l2_len;
+	const struct bt_l2cap_hdr *l2_hdr = data;
 	struct cid_hook *hook;
-	struct btconn *conn;
 	struct l2conn *l2conn;
 	const void *l2_data;
+	uint16_t cid, l2_len;
 
-	if (len < sizeof(*acl_hdr) + sizeof(*l2_hdr))
+	if (len < sizeof(*l2_hdr))
 		return;
 
-	acl_len = le16_to_cpu(acl_hdr->dlen);
-	if (len != sizeof(*acl_hdr) + acl_len)
-		return;
-
-	handle = acl_handle(acl_hdr->handle);
-	conn = bthost_find_conn(bthost, handle);
-	if (!conn) {
-		printf("ACL data for unknown handle 0x%04x\n", handle);
-		return;
-	}
-
 	l2_len = le16_to_cpu(l2_hdr->len);
-	if (len - sizeof(*acl_hdr) != sizeof(*l2_hdr) + l2_len)
+	if (len != sizeof(*l2_hdr) + l2_len)
 		return;
 
-	l2_data = data + sizeof(*acl_hdr) + sizeof(*l2_hdr);
+	l2_data = data + sizeof(*l2_hdr);
 
 	cid = le16_to_cpu(l2_hdr->cid);
 
@@ -2198,6 +2191,93 @@ static void process_acl(struct bthost *bthost, const void *data, uint16_t len)
 	}
 }
 
+static void process_acl(struct bthost *bthost, const void *data, uint16_t len)
+{
+	const struct bt_hci_acl_hdr *acl_hdr = data;
+	const struct bt_l2cap_hdr *l2_hdr = data + sizeof(*acl_hdr);
+	const void *acl_data = data + sizeof(*acl_hdr);
+	uint16_t handle, acl_len, l2_len;
+	struct btconn *conn;
+	uint8_t *frame;
+
+	if (len < sizeof(*acl_hdr))
+		return;
+
+	acl_len = le16_to_cpu(acl_hdr->dlen);
+	if (len != sizeof(*acl_hdr) + acl_len)
+		return;
+
+	handle = acl_handle(acl_hdr->handle);
+	conn = bthost_find_conn(bthost, handle);
+	if (!conn) {
+		printf("ACL data for unknown handle 0x%04x\n", handle);
+		return;
+	}
+
+	/* Frames longer than the controller's ACL MTU arrive fragmented */
+	switch (acl_flags(acl_hdr->handle) & 0x03) {
+	case 0x00:	/* First non-flushable fragment */
+	case 0x02:	/* First flushable fragment */
+		if (conn->recv_data) {
+			printf("Unexpected ACL start frame\n");
+			free(conn->recv_data);
+			conn->recv_data = NULL;
+		}
+
+		if (acl_len < sizeof(*l2_hdr))
+			return;
+
+		/* With its header the frame must still fit the 16 bit lengths */
+		l2_len = le16_to_cpu(l2_hdr->len);
+		if (l2_len > UINT16_MAX - sizeof(*l2_hdr)) {
+			printf("L2CAP frame too long\n");
+			return;
+		}
+
+		l2_len += sizeof(*l2_hdr);
+		if (acl_len >= l2_len) {
+			process_l2cap(bthost, conn, acl_data, acl_len);
+			return;
+		}
+
+		conn->recv_data = malloc(l2_len);
+		if (!conn->recv_data)
+			return;
+
+		memcpy(conn->recv_data, acl_data, acl_len);
+		conn->recv_len = acl_len;
+		conn->data_len = l2_len;
+		break;
+	case 0x01:	/* Continuing fragment */
+		if (!conn->recv_data) {
+			printf("Unexpected ACL continuation frame\n");
+			return;
+		}
+
+		if (acl_len > conn->data_len - conn->recv_len) {
+			printf("ACL continuation frame too long\n");
+			free(conn->recv_data);
+			conn->recv_data = NULL;
+			return;
+		}
+
+		memcpy(conn->recv_data + conn->recv_len, acl_data, acl_len);
+		conn->recv_len += acl_len;
+
+		if (conn->recv_len < conn->data_len)
+			return;
+
+		/* Handlers may disconnect, taking conn with them */
+		frame = conn->recv_data;
+		conn->recv_data = NULL;
+
+		process_l2cap(bthost, conn, frame, conn->recv_len);
+
+		free(frame);
+		break;
+	}
+}
+
 void bthost_receive_h4(struct bthost *bthost, const void *data, uint16_t len)
 {
 	uint8_t pkt_type;
@@ -0,0 +1,31 @@
+#!/usr/bin/python
+
+import time
+import blueberrypy
+from blueberrypyhelper import GattServer, LocalCharacteristic
+
+class ExampleServer(GattServer):
+  def onConnected(self, btAddress):
+    print 'onConnected({0})'.format(btAddress)
+
+  def onDisconnected(self, btAddress, err):
+    print 'onDisconnected({0}, {1})'.format(btAddress, err)
+
+class Telemetry(LocalCharacteristic):
+  def onSubscriptionChanged(self, btAddress, notify, indicate):
+    print 'onSubscriptionChanged({0}, {1}, {2})'.format(btAddress, notify, indicate)
+
+server = ExampleServer()
+service = blueberrypy.LocalService('0000ffe0-0000-1000-8000-00805f9b34fb', True)
+props = int(blueberrypy.CharacteristicProperty.Read) | int(blueberrypy.CharacteristicProperty.Notify)
+telemetry = Telemetry(service.addCharacteristic('0000ffe1-0000-1000-8000-00805f9b34fb', props))
+
+server.addService(service)
+if not server.start():
+  print 'Failed to start server'
+else:
+  counter = 0
+  while True:
+    telemetry.notify(str(counter))
+    counter += 1
+    time.sleep(0.1)
@@ -127,6 +127,25 @@ int bt_uuid_cmp(const bt_uuid_t *uuid1, const bt_uuid_t *uuid2)
 {
 	bt_uuid_t u1, u2;
 
+	/*
+	 * Values of the same short type compare in the same order as their
+	 * big-endian 128-bit forms, so skip the conversion for them.
+	 */
+	if (uuid1->type == uuid2->type) {
+		switch (uuid1->type) {
+		case BT_UUID16:
+			return (int) uuid1->value.u16 - (int) uuid2->value.u16;
+		case BT_UUID32:
+			if (uuid1->value.u32 == uuid2->value.u32)
+				return 0;
+			return uuid1->value.u32 < uuid2->value.u32 ? -1 : 1;
+		case BT_UUID128:
+			return bt_uuid128_cmp(uuid1, uuid2);
+		default:
+			break;
+		}
+	}
+
 	bt_uuid_to_uuid128(uuid1, &u1);
 	bt_uuid_to_uuid128(uuid2, &u2);
 
@@ -1,4 +1,5 @@
 #include "BleAdvertisement.h"
+#include "RpaResolver.h"
 #include <iostream>
 #include <string>
 
@@ -43,7 +44,7 @@ enum class adv_data_flag_t {
 	SimulatenousLeBrEdrHost   			= 0x10
 };
 
-BleAdvertisement* BleAdvertisement::parse(void* adv_info) {
+BleAdvertisement* BleAdvertisement::parse(void* adv_info, RpaResolver* resolver) {
 	BleAdvertisement* adv = new BleAdvertisement();
 	le_advertising_info* info = (le_advertising_info*) adv_info;
 	uint8_t* data = info->data;
@@ -57,6 +58,10 @@ BleAdvertisement* BleAdvertisement::parse(void* adv_info) {
 	ba2str(&info->bdaddr, tmp);
 	adv->m_btAddress = tmp;
 
+	if (resolver && info->bdaddr_type == LE_RANDOM_ADDRESS) {
+		adv->m_resolved = resolver->resolve(info->bdaddr, adv->m_identityAddress, adv->m_identityAddressType);
+	}
+
 	//Advertisment parts are in the following format:
 	//Byte 1: Length (Number of bytes for the following Type and Data fields)
 	//Byte 2: Type (The type of advertisment part)
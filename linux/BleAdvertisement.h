@@ -5,6 +5,8 @@
 
 namespace bluez {
 namespace native {
+class RpaResolver;
+
 enum class BleAdvertisementType : uint8_t {
 	ConnectableUndirected = 0x00,
 	ConnectableDirected = 0x01,
@@ -15,7 +17,8 @@ enum class BleAdvertisementType : uint8_t {
 
 class BleAdvertisement {
 public:
-  static BleAdvertisement* parse(void* adv_info);
+  // A resolver, if given, maps resolvable private addresses to identities
+  static BleAdvertisement* parse(void* adv_info, RpaResolver* resolver = NULL);
   virtual ~BleAdvertisement() {}
 
   BleAdvertisementType type() { return m_type; }
@@ -23,6 +26,12 @@ public:
   std::string addressType() { return m_addressType; }
   std::string btAddress() { return m_btAddress; }
 
+  // The identity behind a resolved private address, otherwise the address
+  // the advertisement was received from
+  bool resolved() { return m_resolved; }
+  std::string identityAddressType() { return m_resolved ? m_identityAddressType : m_addressType; }
+  std::string identityAddress() { return m_resolved ? m_identityAddress : m_btAddress; }
+
   bool hasFlags();
   bool rawFlags(uint8_t& flags);
   bool limitedDiscoverable();
@@ -56,7 +65,7 @@ public:
   bool manufacturerData(std::string& advertisingInterval);
 
 private:
-  BleAdvertisement() {}
+  BleAdvertisement() : m_resolved(false) {}
 
   template<class T>
   bool getValue(T type, std::string& value) {
@@ -89,6 +98,9 @@ private:
   uint8_t m_rssi;
   std::string m_addressType;
   std::string m_btAddress;
+  bool m_resolved;
+  std::string m_identityAddressType;
+  std::string m_identityAddress;
   std::map<uint8_t, std::string> m_parts;
 };
 } //native
@@ -8,7 +8,7 @@
 using namespace std;
 using namespace bluez::native;
 
-BtAdapter::BtAdapter(int id) {
+BtAdapter::BtAdapter(int id) : m_resolver(NULL) {
   m_id = id;
   m_hci_device = hci_open_dev(id);
 
@@ -45,6 +45,11 @@ bool BtAdapter::disableScanning() {
   return setScanEnable(false, false);
 }
 
+void BtAdapter::setRpaResolver(RpaResolver* resolver) {
+  boost::mutex::scoped_lock lock(m_resolverMutex);
+  m_resolver = resolver;
+}
+
 bool BtAdapter::setScanParameters() {
   le_set_scan_parameters_cp scan_parameters;
 
@@ -119,7 +124,13 @@ void BtAdapter::processHciData() {
   		}
 
   		adv_info = (le_advertising_info *)(le_meta_event->data + 1);
-  		BleAdvertisement* advertisment = BleAdvertisement::parse(adv_info);
+
+      BleAdvertisement* advertisment;
+      {
+        boost::mutex::scoped_lock lock(m_resolverMutex);
+        advertisment = BleAdvertisement::parse(adv_info, m_resolver);
+      }
+
       if (!onAdvertisementScanned(advertisment)) {
         delete advertisment;
       }
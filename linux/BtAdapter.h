@@ -1,6 +1,7 @@
 #pragma once
 #include <boost/thread.hpp>
 #include "BleAdvertisement.h"
+#include "RpaResolver.h"
 
 namespace bluez {
 namespace native {
@@ -12,6 +13,10 @@ public:
   bool enableScanning();
   bool disableScanning();
 
+  // Resolves private addresses of scanned advertisements, NULL disables it.
+  // The resolver isn't owned, it may be destroyed once it has been unset.
+  void setRpaResolver(RpaResolver* resolver);
+
 protected:
   virtual bool onAdvertisementScanned(BleAdvertisement* advertisment) { return false; }
 
@@ -24,6 +29,8 @@ private:
   int m_id;
   bool m_active;
   boost::thread* m_reader_thread;
+  boost::mutex m_resolverMutex;
+  RpaResolver* m_resolver;
 };
 } //native
 } //bluez
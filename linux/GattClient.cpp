@@ -4,14 +4,19 @@
 #include "bluetooth.h"
 #include "l2cap.h"
 
+extern "C" {
+  #include "util.h"
+}
+
 #define ATT_CID 4
 #define INVALID_SOCKET -1
 
 using namespace std;
 using namespace bluez::native;
 
-GattClient::GattClient(uint16_t mtu) :
+GattClient::GattClient(uint16_t mtu, unsigned int enhancedBearers) :
   m_mtu(mtu),
+  m_enhancedBearers(enhancedBearers),
   m_mainLoop(MainLoop::getInstance()),
   m_btAddress(),
   m_connected(false) {
@@ -96,9 +101,140 @@ bool GattClient::connect(std::string btAddress) {
     return false;
   }
 
+  connectEnhancedBearers(dstAddress, dst_type);
+
 	return true;
 }
 
+int GattClient::getBearerCount() {
+  if (!m_connected) {
+    return 0;
+  }
+
+  return bt_att_get_channels(m_att);
+}
+
+bool GattClient::readMultiple(const std::vector<uint16_t>& valueHandles) {
+  if (!m_connected || valueHandles.size() < 2 || valueHandles.size() > UINT8_MAX) {
+    return false;
+  }
+
+  ReadMultipleRequest* request = new ReadMultipleRequest;
+  request->client = this;
+  request->handles = valueHandles;
+
+  unsigned int id = bt_gatt_client_read_multiple_variable(m_client, &request->handles[0], request->handles.size(),
+    &GattClient::_readMultipleCallback, request, &GattClient::_readMultipleDestroy);
+
+  // The destroy callback isn't called when sending fails
+  if (!id) {
+    delete request;
+  }
+
+  return id != 0;
+}
+
+void GattClient::_readMultipleCallback(bool success, uint8_t attErrorCode, const uint8_t* value, uint16_t length,
+  void* obj) {
+  ReadMultipleRequest* request = static_cast<ReadMultipleRequest*>(obj);
+  map<uint16_t, string> values;
+
+  for (auto i = request->handles.begin(); success && i != request->handles.end() && length >= 2; ++i) {
+    uint16_t valueLength = get_le16(value);
+
+    value += 2;
+    length -= 2;
+
+    if (valueLength > length) {
+      valueLength = length;
+    }
+
+    values[*i] = string(reinterpret_cast<const char*>(value), valueLength);
+    value += valueLength;
+    length -= valueLength;
+  }
+
+  request->client->onReadMultipleResponse(success, attErrorCode, values);
+}
+
+void GattClient::_readMultipleDestroy(void* obj) {
+  delete static_cast<ReadMultipleRequest*>(obj);
+}
+
+void GattClient::connectEnhancedBearers(const bdaddr_t& dstAddress, uint8_t dstType) {
+  for (unsigned int i = 0; i < m_enhancedBearers; ++i) {
+    int socket = connectEnhancedBearer(dstAddress, dstType);
+    if (socket < 0) {
+      // Peers without Enhanced ATT keep working over the fixed channel
+      break;
+    }
+
+    int err = bt_att_attach_fd(m_att, socket);
+    if (err < 0) {
+      fprintf(stderr, "Failed to attach ATT bearer: %s\n", strerror(-err));
+      close(socket);
+      break;
+    }
+  }
+}
+
+int GattClient::connectEnhancedBearer(const bdaddr_t& dstAddress, uint8_t dstType) {
+  bdaddr_t srcAddress = {{0, 0, 0, 0, 0, 0}};
+  sockaddr_l2 srcSocketAddress;
+  sockaddr_l2 dstSocketAddress;
+  bt_security btsec;
+  uint8_t mode = BT_MODE_EXT_FLOWCTL;
+  uint16_t mtu = m_mtu < BT_ATT_EATT_MIN_MTU ? BT_ATT_EATT_MIN_MTU : m_mtu;
+
+  int socket = ::socket(PF_BLUETOOTH, SOCK_SEQPACKET, BTPROTO_L2CAP);
+  if (socket < 0) {
+    perror("socket(PF_BLUETOOTH)");
+    return -1;
+  }
+
+  memset(&srcSocketAddress, 0, sizeof(srcSocketAddress));
+  srcSocketAddress.l2_family = AF_BLUETOOTH;
+  srcSocketAddress.l2_bdaddr_type = BDADDR_LE_PUBLIC;
+  bacpy(&srcSocketAddress.l2_bdaddr, &srcAddress);
+
+  if (bind(socket, (struct sockaddr *)&srcSocketAddress, sizeof(srcSocketAddress)) < 0) {
+    perror("bind()");
+    goto fail;
+  }
+
+  // EATT is only allowed on an encrypted link, never go below the level
+  // of the fixed bearer
+  memset(&btsec, 0, sizeof(btsec));
+  btsec.level = BT_SECURITY_MEDIUM;
+  if (bt_att_get_security(m_att) > BT_SECURITY_MEDIUM) {
+    btsec.level = bt_att_get_security(m_att);
+  }
+
+  if (setsockopt(socket, SOL_BLUETOOTH, BT_SECURITY, &btsec, sizeof(btsec)) != 0 ||
+      setsockopt(socket, SOL_BLUETOOTH, BT_MODE, &mode, sizeof(mode)) != 0 ||
+      setsockopt(socket, SOL_BLUETOOTH, BT_RCVMTU, &mtu, sizeof(mtu)) != 0) {
+    perror("setsockopt(SOL_BLUETOOTH)");
+    goto fail;
+  }
+
+  memset(&dstSocketAddress, 0, sizeof(dstSocketAddress));
+  dstSocketAddress.l2_family = AF_BLUETOOTH;
+  dstSocketAddress.l2_psm = htobs(BT_ATT_EATT_PSM);
+  dstSocketAddress.l2_bdaddr_type = dstType;
+  bacpy(&dstSocketAddress.l2_bdaddr, &dstAddress);
+
+  if (::connect(socket, (struct sockaddr *) &dstSocketAddress, sizeof(dstSocketAddress)) < 0) {
+    perror("connect(EATT)");
+    goto fail;
+  }
+
+  return socket;
+
+fail:
+  close(socket);
+  return -1;
+}
+
 bool GattClient::disconnect() {
   if (!m_connected) {
     cout << "disconnect() called, but not connected" << endl;
@@ -10,6 +10,8 @@ extern "C" {
 #include "MainLoop.h"
 #include "GattService.h"
 #include <list>
+#include <map>
+#include <vector>
 
 namespace bluez {
 namespace native {
@@ -18,20 +20,33 @@ private:
   typedef std::list<GattService*> ServiceCollection;
 
 public:
-  GattClient(uint16_t mtu = BT_ATT_MAX_LE_MTU);
+  // enhancedBearers extra L2CAP channels are opened to peers supporting
+  // Enhanced ATT so that requests can run in parallel
+  GattClient(uint16_t mtu = BT_ATT_MAX_LE_MTU, unsigned int enhancedBearers = 0);
   virtual ~GattClient();
 
   virtual void onServicesDiscovered(bool success, uint8_t attErrorCode) {}
+  // Values are keyed by value handle, the last one may be truncated
+  virtual void onReadMultipleResponse(bool success, uint8_t attErrorCode, std::map<uint16_t, std::string> values) {}
 
   bool connect(std::string btAddress);
   bool disconnect();
 
+  // Number of ATT bearers in use, including the fixed channel
+  int getBearerCount();
+
+  // Reads several variable length values in a single request, the peer
+  // must support Read Multiple Variable Length
+  bool readMultiple(const std::vector<uint16_t>& valueHandles);
+
   typedef ServiceCollection::const_iterator ServiceIterator;
   ServiceIterator ServiceCollectionBegin() const { return m_services.begin(); }
   ServiceIterator ServiceCollectionEnd() const { return m_services.end(); }
 
 private:
   bool initializeAtt();
+  void connectEnhancedBearers(const bdaddr_t& dstAddress, uint8_t dstType);
+  int connectEnhancedBearer(const bdaddr_t& dstAddress, uint8_t dstType);
   void onDisconnected(int err);
 
   static void _onDisconnected(int err, void* obj);
@@ -46,10 +61,19 @@ private:
   static void _onServiceChanged(uint16_t startHandle, uint16_t endHandle, void* obj);
   void onServiceChanged(uint16_t startHandle, uint16_t endHandle);
 
+  struct ReadMultipleRequest {
+    GattClient* client;
+    std::vector<uint16_t> handles;
+  };
+
+  static void _readMultipleCallback(bool success, uint8_t attErrorCode, const uint8_t* value, uint16_t length, void* obj);
+  static void _readMultipleDestroy(void* obj);
+
   static void _createService(gatt_db_attribute* attr, void* obj);
   void createService(gatt_db_attribute* attr);
 
   uint16_t m_mtu;
+  unsigned int m_enhancedBearers;
   MainLoop& m_mainLoop;
   std::string m_btAddress;
   bool m_connected;
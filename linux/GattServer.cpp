@@ -0,0 +1,331 @@
+#include "GattServer.h"
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+extern "C" {
+  #include "att.h"
+  #include "mainloop.h"
+}
+
+#include "bluetooth.h"
+#include "l2cap.h"
+
+#define ATT_CID 4
+#define INVALID_SOCKET -1
+#define MAX_PENDING_NOTIFICATIONS 1024
+// Notifications are dropped for a connection that has this many PDUs queued
+#define MAX_PENDING_WRITES 64
+
+using namespace std;
+using namespace bluez::native;
+
+GattServer::GattServer(uint16_t mtu) :
+  m_mtu(mtu ? mtu : BT_ATT_MAX_LE_MTU),
+  m_mainLoop(MainLoop::getInstance()),
+  m_db(gatt_db_new()),
+  m_group(bt_gatt_server_group_new(MAX_PENDING_WRITES)),
+  m_socket(INVALID_SOCKET),
+  m_eventFd(INVALID_SOCKET) {
+
+  m_mainLoop.ref();
+
+  // Lets clients validate their cache with the Database Hash
+  if (!bt_gatt_server_add_gatt_service(m_db)) {
+    fprintf(stderr, "Failed to add GATT service\n");
+  }
+}
+
+GattServer::~GattServer() {
+  stop();
+
+  bt_gatt_server_group_unref(m_group);
+  gatt_db_unref(m_db);
+
+  for(auto i = m_services.begin(); i != m_services.end(); ++i) {
+    delete *i;
+  }
+
+  m_services.clear();
+
+  m_mainLoop.unref();
+}
+
+bool GattServer::addService(LocalService* service) {
+  if (!service || !m_db) {
+    return false;
+  }
+
+  if (!service->registerService(this, m_db)) {
+    return false;
+  }
+
+  m_services.push_back(service);
+  return true;
+}
+
+bool GattServer::start() {
+  bdaddr_t srcAddress = {{0, 0, 0, 0, 0, 0}};
+  sockaddr_l2 srcSocketAddress;
+  bt_security btsec;
+
+  if (m_socket != INVALID_SOCKET) {
+    return true;
+  }
+
+  m_socket = socket(PF_BLUETOOTH, SOCK_SEQPACKET | SOCK_CLOEXEC, BTPROTO_L2CAP);
+  if (m_socket < 0) {
+    perror("socket(PF_BLUETOOTH)");
+    m_socket = INVALID_SOCKET;
+    return false;
+  }
+
+  memset(&srcSocketAddress, 0, sizeof(srcSocketAddress));
+  srcSocketAddress.l2_family = AF_BLUETOOTH;
+  srcSocketAddress.l2_cid = htobs(ATT_CID);
+  srcSocketAddress.l2_bdaddr_type = BDADDR_LE_PUBLIC;
+  bacpy(&srcSocketAddress.l2_bdaddr, &srcAddress);
+
+  if (bind(m_socket, (struct sockaddr *)&srcSocketAddress, sizeof(srcSocketAddress)) < 0) {
+    perror("bind()");
+    goto fail;
+  }
+
+  memset(&btsec, 0, sizeof(btsec));
+  btsec.level = BT_SECURITY_LOW;
+  if (setsockopt(m_socket, SOL_BLUETOOTH, BT_SECURITY, &btsec, sizeof(btsec)) != 0) {
+    perror("setsockopt(SOL_BLUETOOTH, BT_SECURITY)");
+    goto fail;
+  }
+
+  if (listen(m_socket, 10) < 0) {
+    perror("listen()");
+    goto fail;
+  }
+
+  m_eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (m_eventFd < 0) {
+    perror("eventfd()");
+    m_eventFd = INVALID_SOCKET;
+    goto fail;
+  }
+
+  if (mainloop_add_fd(m_eventFd, EPOLLIN, &GattServer::_onNotificationsPending, this, NULL) < 0) {
+    close(m_eventFd);
+    m_eventFd = INVALID_SOCKET;
+    goto fail;
+  }
+
+  if (mainloop_add_fd(m_socket, EPOLLIN, &GattServer::_onAccept, this, NULL) < 0) {
+    mainloop_remove_fd(m_eventFd);
+    close(m_eventFd);
+    m_eventFd = INVALID_SOCKET;
+    goto fail;
+  }
+
+  return true;
+
+fail:
+  close(m_socket);
+  m_socket = INVALID_SOCKET;
+  return false;
+}
+
+bool GattServer::stop() {
+  map<bt_att*, Connection*> connections;
+
+  if (m_socket == INVALID_SOCKET) {
+    return true;
+  }
+
+  mainloop_remove_fd(m_socket);
+  close(m_socket);
+  m_socket = INVALID_SOCKET;
+
+  {
+    boost::mutex::scoped_lock lock(m_pendingMutex);
+    mainloop_remove_fd(m_eventFd);
+    close(m_eventFd);
+    m_eventFd = INVALID_SOCKET;
+    m_pending.clear();
+  }
+
+  {
+    boost::mutex::scoped_lock lock(m_connectionsMutex);
+    connections.swap(m_connections);
+  }
+
+  for (auto i = connections.begin(); i != connections.end(); ++i) {
+    Connection* connection = i->second;
+
+    bt_att_unregister_all(connection->att);
+
+    for (auto j = m_services.begin(); j != m_services.end(); ++j) {
+      (*j)->removeSubscriber(connection->att);
+    }
+
+    closeConnection(connection);
+  }
+
+  return true;
+}
+
+size_t GattServer::getConnectionCount() {
+  boost::mutex::scoped_lock lock(m_connectionsMutex);
+  return m_connections.size();
+}
+
+std::string GattServer::getAddress(bt_att* att) {
+  boost::mutex::scoped_lock lock(m_connectionsMutex);
+  auto i = m_connections.find(att);
+
+  if (i == m_connections.end()) {
+    return string();
+  }
+
+  return i->second->btAddress;
+}
+
+bool GattServer::queueNotification(LocalCharacteristic* characteristic, const std::string& value) {
+  boost::mutex::scoped_lock lock(m_pendingMutex);
+  uint64_t wakeup = 1;
+
+  if (m_eventFd == INVALID_SOCKET || m_pending.size() >= MAX_PENDING_NOTIFICATIONS) {
+    return false;
+  }
+
+  // Only the first queued notification needs to wake up the mainloop
+  if (m_pending.empty() && write(m_eventFd, &wakeup, sizeof(wakeup)) < 0) {
+    return false;
+  }
+
+  m_pending.push_back(PendingNotification(characteristic, value));
+  return true;
+}
+
+void GattServer::setSubscription(bt_att* att, uint16_t valueHandle, uint16_t ccc) {
+  bt_gatt_server_group_set_ccc(m_group, att, valueHandle, ccc);
+}
+
+void GattServer::sendNotification(uint16_t valueHandle, const std::string& value) {
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(value.data());
+
+  // One PDU is built and shared by every subscribed connection
+  bt_gatt_server_group_notify(m_group, valueHandle, data, value.length());
+}
+
+void GattServer::_onAccept(int fd, uint32_t events, void* obj) {
+  GattServer* server = static_cast<GattServer*>(obj);
+  server->onAccept();
+}
+
+void GattServer::onAccept() {
+  sockaddr_l2 addr;
+  socklen_t addrLength = sizeof(addr);
+  char btAddress[18];
+
+  memset(&addr, 0, sizeof(addr));
+  int socket = accept(m_socket, (struct sockaddr *)&addr, &addrLength);
+  if (socket < 0) {
+    perror("accept()");
+    return;
+  }
+
+  ba2str(&addr.l2_bdaddr, btAddress);
+
+  bt_att* att = bt_att_new(socket, false);
+  if (!att) {
+    fprintf(stderr, "Failed to initialze ATT transport layer\n");
+    close(socket);
+    return;
+  }
+
+  bt_att_set_close_on_unref(att, true);
+
+  Connection* connection = new Connection;
+  connection->owner = this;
+  connection->btAddress = btAddress;
+  connection->att = att;
+  connection->server = bt_gatt_server_new(m_db, att, m_mtu);
+
+  if (!connection->server || !bt_gatt_server_group_add(m_group, connection->server) ||
+      !bt_att_register_disconnect(att, &GattServer::_onDisconnected, connection, NULL)) {
+    fprintf(stderr, "Failed to create GATT server\n");
+    closeConnection(connection);
+    return;
+  }
+
+  bt_gatt_server_set_debug(connection->server, &GattServer::_onDebugMessage, this, NULL);
+
+  {
+    boost::mutex::scoped_lock lock(m_connectionsMutex);
+    m_connections[att] = connection;
+  }
+
+  onConnected(connection->btAddress);
+}
+
+void GattServer::_onNotificationsPending(int fd, uint32_t events, void* obj) {
+  GattServer* server = static_cast<GattServer*>(obj);
+  server->onNotificationsPending();
+}
+
+void GattServer::onNotificationsPending() {
+  list<PendingNotification> pending;
+  uint64_t count;
+
+  {
+    boost::mutex::scoped_lock lock(m_pendingMutex);
+    if (m_eventFd == INVALID_SOCKET) {
+      return;
+    }
+
+    if (read(m_eventFd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+      perror("read()");
+    }
+
+    pending.swap(m_pending);
+  }
+
+  for (auto i = pending.begin(); i != pending.end(); ++i) {
+    i->first->fanOut(i->second);
+  }
+}
+
+void GattServer::_onDisconnected(int err, void* obj) {
+  Connection* connection = static_cast<Connection*>(obj);
+  connection->owner->onConnectionClosed(connection, err);
+}
+
+void GattServer::onConnectionClosed(Connection* connection, int err) {
+  string btAddress = connection->btAddress;
+
+  {
+    boost::mutex::scoped_lock lock(m_connectionsMutex);
+    m_connections.erase(connection->att);
+  }
+
+  for (auto i = m_services.begin(); i != m_services.end(); ++i) {
+    (*i)->removeSubscriber(connection->att);
+  }
+
+  // bt_att holds its own reference while running disconnect handlers
+  closeConnection(connection);
+
+  onDisconnected(btAddress, err);
+}
+
+void GattServer::_onDebugMessage(const char* str, void* obj) {
+  GattServer* server = static_cast<GattServer*>(obj);
+  server->onDebugMessage(str);
+}
+
+void GattServer::onDebugMessage(const char* str) {}
+
+void GattServer::closeConnection(Connection* connection) {
+  bt_gatt_server_group_remove(m_group, connection->server);
+  bt_gatt_server_unref(connection->server);
+  bt_att_unref(connection->att);
+  delete connection;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+extern "C" {
+  #include "bluetooth.h"
+  #include "uuid.h"
+  #include "gatt-db.h"
+  #include "gatt-server.h"
+}
+
+#include <boost/thread/mutex.hpp>
+#include <string>
+#include "MainLoop.h"
+#include "LocalService.h"
+#include <list>
+#include <map>
+
+namespace bluez {
+namespace native {
+class GattServer {
+private:
+  typedef std::list<LocalService*> ServiceCollection;
+
+public:
+  // An mtu of 0 selects BT_ATT_MAX_LE_MTU, att.h can't be included here
+  // next to GattClient.h
+  GattServer(uint16_t mtu = 0);
+  virtual ~GattServer();
+
+  virtual void onConnected(std::string btAddress) {}
+  virtual void onDisconnected(std::string btAddress, int err) {}
+
+  // Registers the service in the database, the server takes ownership
+  bool addService(LocalService* service);
+
+  // Accepts ATT connections on the LE fixed channel
+  bool start();
+  bool stop();
+
+  size_t getConnectionCount();
+
+  typedef ServiceCollection::const_iterator ServiceIterator;
+  ServiceIterator ServiceCollectionBegin() const { return m_services.begin(); }
+  ServiceIterator ServiceCollectionEnd() const { return m_services.end(); }
+
+private:
+  friend class LocalCharacteristic;
+
+  struct Connection {
+    GattServer* owner;
+    std::string btAddress;
+    bt_att* att;
+    bt_gatt_server* server;
+  };
+
+  typedef std::pair<LocalCharacteristic*, std::string> PendingNotification;
+
+  std::string getAddress(bt_att* att);
+  bool queueNotification(LocalCharacteristic* characteristic, const std::string& value);
+  void setSubscription(bt_att* att, uint16_t valueHandle, uint16_t ccc);
+  void sendNotification(uint16_t valueHandle, const std::string& value);
+
+  static void _onAccept(int fd, uint32_t events, void* obj);
+  void onAccept();
+  static void _onNotificationsPending(int fd, uint32_t events, void* obj);
+  void onNotificationsPending();
+  static void _onDisconnected(int err, void* obj);
+  void onConnectionClosed(Connection* connection, int err);
+  static void _onDebugMessage(const char* str, void* obj);
+  void onDebugMessage(const char* str);
+
+  void closeConnection(Connection* connection);
+
+  uint16_t m_mtu;
+  MainLoop& m_mainLoop;
+  gatt_db* m_db;
+  // Tracks subscriptions of all connections and fans notifications out
+  bt_gatt_server_group* m_group;
+  int m_socket;
+  int m_eventFd;
+  ServiceCollection m_services;
+
+  boost::mutex m_connectionsMutex;
+  std::map<bt_att*, Connection*> m_connections;
+
+  // notify() may be called from any thread, sending happens on the mainloop
+  boost::mutex m_pendingMutex;
+  std::list<PendingNotification> m_pending;
+};
+} //native
+} //bluez
@@ -0,0 +1,247 @@
+#include "LocalCharacteristic.h"
+#include "GattServer.h"
+#include "GattUtilities.h"
+
+extern "C" {
+  #include "att.h"
+  #include "util.h"
+}
+
+#define CCC_NOTIFY 0x0001
+#define CCC_INDICATE 0x0002
+
+using namespace std;
+using namespace bluez::native;
+
+LocalCharacteristic::LocalCharacteristic(bt_uuid_t uuid, uint8_t properties) :
+  m_server(NULL),
+  m_attribute(NULL),
+  m_handle(0),
+  m_valueHandle(0),
+  m_properties(properties),
+  m_uuid(uuid),
+  m_callback(NULL) {
+}
+
+LocalCharacteristic::~LocalCharacteristic() {
+}
+
+uint16_t LocalCharacteristic::getHandle() {
+  return m_handle;
+}
+
+uint16_t LocalCharacteristic::getValueHandle() {
+  return m_valueHandle;
+}
+
+uint8_t LocalCharacteristic::getProperties() {
+  return m_properties;
+}
+
+std::string LocalCharacteristic::getUuid() {
+  return uuidToString(&m_uuid);
+}
+
+void LocalCharacteristic::bind(ILocalCharacteristicCallback* callback) {
+  m_callback = callback;
+}
+
+void LocalCharacteristic::unbind() {
+  m_callback = NULL;
+}
+
+std::string LocalCharacteristic::getValue() {
+  boost::mutex::scoped_lock lock(m_valueMutex);
+  return m_value;
+}
+
+void LocalCharacteristic::setValue(const std::string& value) {
+  boost::mutex::scoped_lock lock(m_valueMutex);
+  m_value = value;
+}
+
+bool LocalCharacteristic::notify(const std::string& value) {
+  setValue(value);
+
+  if (!m_server || !hasCcc()) {
+    return false;
+  }
+
+  return m_server->queueNotification(this, value);
+}
+
+bool LocalCharacteristic::hasCcc() {
+  return (m_properties & (BT_GATT_CHRC_PROP_NOTIFY | BT_GATT_CHRC_PROP_INDICATE)) != 0;
+}
+
+bool LocalCharacteristic::registerCharacteristic(GattServer* server, gatt_db_attribute* service) {
+  uint32_t permissions = 0;
+
+  if (m_properties & BT_GATT_CHRC_PROP_READ) {
+    permissions |= BT_ATT_PERM_READ;
+  }
+
+  if (m_properties & (BT_GATT_CHRC_PROP_WRITE | BT_GATT_CHRC_PROP_WRITE_WITHOUT_RESP)) {
+    permissions |= BT_ATT_PERM_WRITE;
+  }
+
+  m_attribute = gatt_db_service_add_characteristic(service, &m_uuid, permissions, m_properties,
+    &LocalCharacteristic::_onRead, &LocalCharacteristic::_onWrite, this);
+  if (!m_attribute) {
+    return false;
+  }
+
+  if (hasCcc()) {
+    bt_uuid_t cccUuid;
+    bt_uuid16_create(&cccUuid, GATT_CLIENT_CHARAC_CFG_UUID);
+
+    if (!gatt_db_service_add_descriptor(service, &cccUuid, BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
+        &LocalCharacteristic::_onCccRead, &LocalCharacteristic::_onCccWrite, this)) {
+      return false;
+    }
+  }
+
+  m_server = server;
+  m_valueHandle = gatt_db_attribute_get_handle(m_attribute);
+  m_handle = m_valueHandle - 1;
+
+  return true;
+}
+
+void LocalCharacteristic::fanOut(const std::string& value) {
+  if (!m_subscribers.empty()) {
+    m_server->sendNotification(m_valueHandle, value);
+  }
+}
+
+void LocalCharacteristic::removeSubscriber(bt_att* att) {
+  m_subscribers.erase(att);
+}
+
+void LocalCharacteristic::_onRead(gatt_db_attribute* attr, unsigned int id, uint16_t offset, uint8_t opcode,
+  bt_att* att, void* obj) {
+  LocalCharacteristic* characteristic = static_cast<LocalCharacteristic*>(obj);
+  characteristic->onRead(attr, id, offset, att);
+}
+
+void LocalCharacteristic::onRead(gatt_db_attribute* attr, unsigned int id, uint16_t offset, bt_att* att) {
+  string value = getValue();
+  uint8_t ecode = 0;
+
+  // Long reads continue from the value handed out for offset 0
+  if (offset == 0 && m_callback) {
+    ecode = m_callback->onRead(m_server->getAddress(att), value);
+    if (ecode == 0) {
+      setValue(value);
+    }
+  }
+
+  if (ecode == 0 && offset > value.length()) {
+    ecode = BT_ATT_ERROR_INVALID_OFFSET;
+  }
+
+  if (ecode != 0) {
+    gatt_db_attribute_read_result(attr, id, ecode, NULL, 0);
+    return;
+  }
+
+  gatt_db_attribute_read_result(attr, id, 0, reinterpret_cast<const uint8_t*>(value.data()) + offset,
+    value.length() - offset);
+}
+
+void LocalCharacteristic::_onWrite(gatt_db_attribute* attr, unsigned int id, uint16_t offset, const uint8_t* value,
+  size_t length, uint8_t opcode, bt_att* att, void* obj) {
+  LocalCharacteristic* characteristic = static_cast<LocalCharacteristic*>(obj);
+  characteristic->onWrite(attr, id, offset, value, length, opcode, att);
+}
+
+void LocalCharacteristic::onWrite(gatt_db_attribute* attr, unsigned int id, uint16_t offset, const uint8_t* value,
+  size_t length, uint8_t opcode, bt_att* att) {
+  string newValue = getValue();
+  uint8_t ecode = 0;
+
+  if (offset > newValue.length()) {
+    ecode = BT_ATT_ERROR_INVALID_OFFSET;
+  } else {
+    newValue.resize(offset);
+    newValue.append(reinterpret_cast<const char*>(value), length);
+
+    if (m_callback) {
+      ecode = m_callback->onWrite(m_server->getAddress(att), newValue);
+    }
+
+    if (ecode == 0) {
+      setValue(newValue);
+    }
+  }
+
+  gatt_db_attribute_write_result(attr, id, ecode);
+}
+
+void LocalCharacteristic::_onCccRead(gatt_db_attribute* attr, unsigned int id, uint16_t offset, uint8_t opcode,
+  bt_att* att, void* obj) {
+  LocalCharacteristic* characteristic = static_cast<LocalCharacteristic*>(obj);
+  characteristic->onCccRead(attr, id, offset, att);
+}
+
+void LocalCharacteristic::onCccRead(gatt_db_attribute* attr, unsigned int id, uint16_t offset, bt_att* att) {
+  uint16_t ccc = 0;
+  uint8_t value[2];
+
+  auto i = m_subscribers.find(att);
+  if (i != m_subscribers.end()) {
+    ccc = i->second;
+  }
+
+  if (offset > sizeof(value)) {
+    gatt_db_attribute_read_result(attr, id, BT_ATT_ERROR_INVALID_OFFSET, NULL, 0);
+    return;
+  }
+
+  put_le16(ccc, value);
+  gatt_db_attribute_read_result(attr, id, 0, value + offset, sizeof(value) - offset);
+}
+
+void LocalCharacteristic::_onCccWrite(gatt_db_attribute* attr, unsigned int id, uint16_t offset, const uint8_t* value,
+  size_t length, uint8_t opcode, bt_att* att, void* obj) {
+  LocalCharacteristic* characteristic = static_cast<LocalCharacteristic*>(obj);
+  characteristic->onCccWrite(attr, id, offset, value, length, att);
+}
+
+void LocalCharacteristic::onCccWrite(gatt_db_attribute* attr, unsigned int id, uint16_t offset, const uint8_t* value,
+  size_t length, bt_att* att) {
+  uint16_t ccc;
+
+  if (offset) {
+    gatt_db_attribute_write_result(attr, id, BT_ATT_ERROR_INVALID_OFFSET);
+    return;
+  }
+
+  if (!value || length != 2) {
+    gatt_db_attribute_write_result(attr, id, BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN);
+    return;
+  }
+
+  ccc = get_le16(value);
+
+  if (((ccc & CCC_NOTIFY) && !(m_properties & BT_GATT_CHRC_PROP_NOTIFY)) ||
+      ((ccc & CCC_INDICATE) && !(m_properties & BT_GATT_CHRC_PROP_INDICATE))) {
+    // Client Characteristic Configuration Descriptor Improperly Configured
+    gatt_db_attribute_write_result(attr, id, 0xFD);
+    return;
+  }
+
+  if (ccc) {
+    m_subscribers[att] = ccc;
+  } else {
+    m_subscribers.erase(att);
+  }
+
+  m_server->setSubscription(att, m_valueHandle, ccc);
+
+  gatt_db_attribute_write_result(attr, id, 0);
+
+  if (m_callback) {
+    m_callback->onSubscriptionChanged(m_server->getAddress(att), (ccc & CCC_NOTIFY) != 0, (ccc & CCC_INDICATE) != 0);
+  }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+extern "C" {
+  #include "bluetooth.h"
+  #include "uuid.h"
+  #include "gatt-db.h"
+}
+
+#include <boost/thread/mutex.hpp>
+#include <map>
+#include <string>
+
+struct bt_att;
+
+namespace bluez {
+namespace native {
+class GattServer;
+
+class ILocalCharacteristicCallback {
+public:
+  // Called with value holding the cached value, return an ATT error code
+  virtual uint8_t onRead(std::string btAddress, std::string& value) = 0;
+  // Called with the complete new value, return an ATT error code
+  virtual uint8_t onWrite(std::string btAddress, std::string value) = 0;
+  virtual void onSubscriptionChanged(std::string btAddress, bool notify, bool indicate) = 0;
+};
+
+class LocalCharacteristic {
+public:
+  ~LocalCharacteristic();
+
+  uint16_t getHandle();
+  uint16_t getValueHandle();
+  uint8_t getProperties();
+  std::string getUuid();
+
+  void bind(ILocalCharacteristicCallback* callback);
+  void unbind();
+
+  std::string getValue();
+  void setValue(const std::string& value);
+
+  // Updates the cached value and sends it to every subscribed connection
+  bool notify(const std::string& value);
+
+private:
+  friend class LocalService;
+  friend class GattServer;
+
+  LocalCharacteristic(bt_uuid_t uuid, uint8_t properties);
+
+  bool hasCcc();
+  bool registerCharacteristic(GattServer* server, gatt_db_attribute* service);
+  void fanOut(const std::string& value);
+  void removeSubscriber(bt_att* att);
+
+  static void _onRead(gatt_db_attribute* attr, unsigned int id, uint16_t offset, uint8_t opcode, bt_att* att, void* obj);
+  void onRead(gatt_db_attribute* attr, unsigned int id, uint16_t offset, bt_att* att);
+  static void _onWrite(gatt_db_attribute* attr, unsigned int id, uint16_t offset, const uint8_t* value, size_t length,
+    uint8_t opcode, bt_att* att, void* obj);
+  void onWrite(gatt_db_attribute* attr, unsigned int id, uint16_t offset, const uint8_t* value, size_t length,
+    uint8_t opcode, bt_att* att);
+  static void _onCccRead(gatt_db_attribute* attr, unsigned int id, uint16_t offset, uint8_t opcode, bt_att* att, void* obj);
+  void onCccRead(gatt_db_attribute* attr, unsigned int id, uint16_t offset, bt_att* att);
+  static void _onCccWrite(gatt_db_attribute* attr, unsigned int id, uint16_t offset, const uint8_t* value, size_t length,
+    uint8_t opcode, bt_att* att, void* obj);
+  void onCccWrite(gatt_db_attribute* attr, unsigned int id, uint16_t offset, const uint8_t* value, size_t length,
+    bt_att* att);
+
+  GattServer* m_server;
+  gatt_db_attribute* m_attribute;
+  uint16_t m_handle;
+  uint16_t m_valueHandle;
+  uint8_t m_properties;
+  bt_uuid_t m_uuid;
+  ILocalCharacteristicCallback* m_callback;
+
+  boost::mutex m_valueMutex;
+  std::string m_value;
+
+  // CCC value per connection, only touched from the mainloop thread
+  std::map<bt_att*, uint16_t> m_subscribers;
+};
+} //native
+} //bluez
@@ -0,0 +1,101 @@
+#include "LocalService.h"
+#include "GattUtilities.h"
+
+using namespace std;
+using namespace bluez::native;
+
+LocalService* LocalService::create(std::string uuid, bool primary) {
+  bt_uuid_t btUuid;
+
+  if (bt_string_to_uuid(&btUuid, uuid.c_str()) < 0) {
+    return NULL;
+  }
+
+  return new LocalService(btUuid, primary);
+}
+
+LocalService::LocalService(bt_uuid_t uuid, bool primary) :
+  m_attribute(NULL),
+  m_startHandle(0),
+  m_endHandle(0),
+  m_primary(primary),
+  m_uuid(uuid) {
+}
+
+LocalService::~LocalService() {
+  for(auto i = m_characteristics.begin(); i != m_characteristics.end(); ++i) {
+    delete *i;
+  }
+
+  m_characteristics.clear();
+}
+
+LocalCharacteristic* LocalService::addCharacteristic(std::string uuid, uint8_t properties) {
+  bt_uuid_t btUuid;
+
+  if (m_attribute || bt_string_to_uuid(&btUuid, uuid.c_str()) < 0) {
+    return NULL;
+  }
+
+  LocalCharacteristic* characteristic = new LocalCharacteristic(btUuid, properties);
+  m_characteristics.push_back(characteristic);
+
+  return characteristic;
+}
+
+uint16_t LocalService::getStartHandle() {
+  return m_startHandle;
+}
+
+uint16_t LocalService::getEndHandle() {
+  return m_endHandle;
+}
+
+bool LocalService::getPrimary() {
+  return m_primary;
+}
+
+std::string LocalService::getUuid() {
+  return uuidToString(&m_uuid);
+}
+
+uint16_t LocalService::getHandleCount() {
+  // Service declaration, then declaration, value and optional CCC per characteristic
+  uint16_t count = 1;
+
+  for(auto i = m_characteristics.begin(); i != m_characteristics.end(); ++i) {
+    count += (*i)->hasCcc() ? 3 : 2;
+  }
+
+  return count;
+}
+
+bool LocalService::registerService(GattServer* server, gatt_db* db) {
+  if (m_attribute) {
+    return false;
+  }
+
+  gatt_db_attribute* attr = gatt_db_add_service(db, &m_uuid, m_primary, getHandleCount());
+  if (!attr) {
+    return false;
+  }
+
+  for(auto i = m_characteristics.begin(); i != m_characteristics.end(); ++i) {
+    if (!(*i)->registerCharacteristic(server, attr)) {
+      gatt_db_remove_service(db, attr);
+      return false;
+    }
+  }
+
+  gatt_db_attribute_get_service_handles(attr, &m_startHandle, &m_endHandle);
+  gatt_db_service_set_active(attr, true);
+  m_attribute = attr;
+
+  return true;
+}
+
+void LocalService::removeSubscriber(bt_att* att) {
+  for(auto i = m_characteristics.begin(); i != m_characteristics.end(); ++i) {
+    (*i)->removeSubscriber(att);
+  }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+extern "C" {
+  #include "bluetooth.h"
+  #include "uuid.h"
+  #include "gatt-db.h"
+}
+
+#include "LocalCharacteristic.h"
+#include <stdint.h>
+#include <list>
+#include <string>
+
+namespace bluez {
+namespace native {
+class GattServer;
+
+class LocalService {
+private:
+  typedef std::list<LocalCharacteristic*> CharacteristicCollection;
+
+public:
+  static LocalService* create(std::string uuid, bool primary = true);
+  ~LocalService();
+
+  // Characteristics can only be added before the service is added to a GattServer
+  LocalCharacteristic* addCharacteristic(std::string uuid, uint8_t properties);
+
+  uint16_t getStartHandle();
+  uint16_t getEndHandle();
+  bool getPrimary();
+  std::string getUuid();
+
+  typedef CharacteristicCollection::const_iterator CharacteristicIterator;
+  CharacteristicIterator CharacteristicCollectionBegin() const { return m_characteristics.begin(); }
+  CharacteristicIterator CharacteristicCollectionEnd() const { return m_characteristics.end(); }
+
+private:
+  friend class GattServer;
+
+  LocalService(bt_uuid_t uuid, bool primary);
+
+  uint16_t getHandleCount();
+  bool registerService(GattServer* server, gatt_db* db);
+  void removeSubscriber(bt_att* att);
+
+  gatt_db_attribute* m_attribute;
+  uint16_t m_startHandle;
+  uint16_t m_endHandle;
+  bool m_primary;
+  bt_uuid_t m_uuid;
+  CharacteristicCollection m_characteristics;
+};
+} //native
+} //bluez
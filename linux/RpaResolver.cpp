@@ -0,0 +1,94 @@
+#include "RpaResolver.h"
+#include <stdio.h>
+
+#include "hci.h"
+
+using namespace std;
+using namespace bluez::native;
+
+namespace {
+bool parseAddressType(const string& addressType, uint8_t& type) {
+  if (addressType == "public") {
+    type = LE_PUBLIC_ADDRESS;
+  } else if (addressType == "random") {
+    type = LE_RANDOM_ADDRESS;
+  } else {
+    return false;
+  }
+
+  return true;
+}
+}
+
+RpaResolver::RpaResolver(size_t cacheSize) :
+  m_resolver(bt_rpa_resolver_new(cacheSize)) {
+}
+
+RpaResolver::~RpaResolver() {
+  bt_rpa_resolver_unref(m_resolver);
+}
+
+bool RpaResolver::addIrk(const std::string& irk, const std::string& btAddress, const std::string& addressType) {
+  uint8_t key[16];
+  bdaddr_t address;
+  uint8_t type;
+
+  if (irk.length() != sizeof(key) * 2 || !parseAddressType(addressType, type) ||
+      str2ba(btAddress.c_str(), &address) < 0) {
+    return false;
+  }
+
+  for (size_t i = 0; i < sizeof(key); ++i) {
+    if (sscanf(irk.c_str() + i * 2, "%2hhx", &key[i]) != 1) {
+      return false;
+    }
+  }
+
+  boost::mutex::scoped_lock lock(m_mutex);
+  return bt_rpa_resolver_add_irk(m_resolver, key, address.b, type);
+}
+
+bool RpaResolver::removeIrk(const std::string& btAddress, const std::string& addressType) {
+  bdaddr_t address;
+  uint8_t type;
+
+  if (!parseAddressType(addressType, type) || str2ba(btAddress.c_str(), &address) < 0) {
+    return false;
+  }
+
+  boost::mutex::scoped_lock lock(m_mutex);
+  return bt_rpa_resolver_remove_irk(m_resolver, address.b, type);
+}
+
+void RpaResolver::clear() {
+  boost::mutex::scoped_lock lock(m_mutex);
+  bt_rpa_resolver_clear(m_resolver);
+}
+
+size_t RpaResolver::getIrkCount() {
+  boost::mutex::scoped_lock lock(m_mutex);
+  return bt_rpa_resolver_get_irk_count(m_resolver);
+}
+
+bool RpaResolver::resolve(const bdaddr_t& rpa, std::string& btAddress, std::string& addressType) {
+  bdaddr_t identity;
+  uint8_t type;
+  char tmp[18];
+
+  // Static and non-resolvable random addresses never match, skip the lock
+  if (!bt_rpa_is_resolvable(rpa.b)) {
+    return false;
+  }
+
+  {
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (!bt_rpa_resolver_resolve(m_resolver, rpa.b, identity.b, &type)) {
+      return false;
+    }
+  }
+
+  ba2str(&identity, tmp);
+  btAddress = tmp;
+  addressType = (type == LE_PUBLIC_ADDRESS) ? "public" : "random";
+  return true;
+}
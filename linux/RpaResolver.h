@@ -0,0 +1,35 @@
+#pragma once
+
+extern "C" {
+  #include "bluetooth.h"
+  #include "rpa.h"
+}
+
+#include <boost/thread/mutex.hpp>
+#include <string>
+
+namespace bluez {
+namespace native {
+class RpaResolver {
+public:
+  // Results of the last cacheSize addresses are kept, 0 disables the cache
+  RpaResolver(size_t cacheSize = 1024);
+  virtual ~RpaResolver();
+
+  // irk is 32 hex digits in the order BlueZ stores it in the device info
+  // file, least significant octet first. addressType is "public" or "random".
+  bool addIrk(const std::string& irk, const std::string& btAddress, const std::string& addressType);
+  bool removeIrk(const std::string& btAddress, const std::string& addressType);
+  void clear();
+
+  size_t getIrkCount();
+
+  // Looks up the identity of a resolvable private address
+  bool resolve(const bdaddr_t& rpa, std::string& btAddress, std::string& addressType);
+
+private:
+  boost::mutex m_mutex;
+  bt_rpa_resolver* m_resolver;
+};
+} //native
+} //bluez
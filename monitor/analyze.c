@@ -27,7 +27,12 @@
 #endif
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/time.h>
 
 #include "src/shared/util.h"
 #include "src/shared/queue.h"
@@ -35,19 +40,339 @@
 #include "monitor/bt.h"
 #include "analyze.h"
 
+#define MAX_JOBS	64
+
+#define LIVE_TOP_ADV	5
+
+#define ATT_CID		0x0004
+
+#define DIR_TX		0
+#define DIR_RX		1
+
+struct latency {
+	unsigned long count;
+	uint64_t total;
+	uint64_t min;
+	uint64_t max;
+};
+
+struct att_request {
+	bool valid;
+	uint8_t opcode;
+	struct timeval tv;
+};
+
+/*
+ * Requests sent in one direction are answered from the other one. When a
+ * trace is analyzed in ranges, a range records the request still pending
+ * at its end and the first response it saw without a request, so that the
+ * latency across two ranges can be recovered while merging.
+ */
+struct att_stats {
+	unsigned long opcodes[2][256];
+	struct latency latency[256];
+	struct att_request pending[2];
+	bool seen_req[2];
+	bool lead_done[2];
+	bool lead_valid[2];
+	struct timeval lead_rsp[2];
+};
+
+struct hci_conn {
+	uint16_t handle;
+	uint8_t type;
+	uint8_t bdaddr[6];
+	uint8_t bdaddr_type;
+	bool implicit;
+	bool closed;
+	struct timeval first_acl;
+	struct timeval last_acl;
+	unsigned long tx_pkts;
+	unsigned long tx_bytes;
+	unsigned long rx_pkts;
+	unsigned long rx_bytes;
+	unsigned long att_pdus;
+	struct att_stats *att;
+
+	/* Counters as of the last live statistics update */
+	unsigned long prev_bytes;
+	unsigned long prev_att_pdus;
+};
+
+#define CONN_TYPE_BREDR		0x00
+#define CONN_TYPE_LE		0x01
+#define CONN_TYPE_UNKNOWN	0xff
+
+struct adv_addr {
+	uint8_t addr[6];
+	uint8_t addr_type;
+	unsigned long count;
+	unsigned long prev_count;
+	struct timeval first;
+	struct timeval last;
+	struct adv_addr *next;
+};
+
 struct hci_dev {
 	uint16_t index;
 	uint8_t type;
 	uint8_t bdaddr[6];
+	bool bdaddr_set;
+	bool implicit;
 	struct timeval time_added;
 	struct timeval time_removed;
 	unsigned long num_cmd;
 	unsigned long num_evt;
 	unsigned long num_acl;
 	unsigned long num_sco;
+	unsigned long num_adv;
+	struct queue *conn_list;
+	struct queue *conn_map;
+	struct queue *adv_list;
+
+	/* Only reported by the live statistics */
+	bool cmd_pending;
+	uint16_t cmd_opcode;
+	struct timeval cmd_time;
+	struct latency cmd_latency;
+	unsigned long prev_cmd;
+	unsigned long prev_evt;
+	unsigned long prev_acl;
+	unsigned long prev_sco;
+	unsigned long prev_adv;
+};
+
+enum log_type {
+	LOG_DEV_ADDED,
+	LOG_DEV_REMOVED,
+	LOG_TEXT,
+	LOG_WRONG_OPCODE,
+};
+
+/* What a range did that has to be replayed in order while merging */
+struct log_entry {
+	enum log_type type;
+	uint16_t index;
+	uint16_t opcode;
+	struct hci_dev *dev;
+	char *text;
+};
+
+struct analyze {
+	const char *path;
+	uint64_t start;
+	uint64_t end;
+	pthread_t thread;
+	struct queue *dev_list;
+	struct queue *log;
+	unsigned long num_packets;
 };
 
-static struct queue *dev_list;
+static const char *addr_type_str(uint8_t type)
+{
+	switch (type) {
+	case 0x00:
+		return "public";
+	case 0x01:
+		return "random";
+	case 0x02:
+		return "public identity";
+	case 0x03:
+		return "random identity";
+	case 0xff:
+		return "anonymous";
+	default:
+		return "unknown";
+	}
+}
+
+static double tv_diff(const struct timeval *a, const struct timeval *b)
+{
+	struct timeval res;
+
+	timersub(a, b, &res);
+
+	return res.tv_sec + res.tv_usec / 1000000.0;
+}
+
+static unsigned int conn_key(const void *data)
+{
+	const struct hci_conn *conn = data;
+
+	return conn->handle;
+}
+
+static unsigned int adv_hash(const uint8_t *addr, uint8_t addr_type)
+{
+	unsigned int hash = 2166136261u;
+	int i;
+
+	for (i = 0; i < 6; i++)
+		hash = (hash ^ addr[i]) * 16777619u;
+
+	return (hash ^ addr_type) * 16777619u;
+}
+
+static unsigned int adv_key(const void *data)
+{
+	const struct adv_addr *adv = data;
+
+	return adv_hash(adv->addr, adv->addr_type);
+}
+
+static void conn_free(void *data)
+{
+	struct hci_conn *conn = data;
+
+	free(conn->att);
+	free(conn);
+}
+
+static void adv_free(void *data)
+{
+	struct adv_addr *adv = data;
+
+	while (adv) {
+		struct adv_addr *next = adv->next;
+
+		free(adv);
+		adv = next;
+	}
+}
+
+static void dev_free(void *data)
+{
+	struct hci_dev *dev = data;
+
+	queue_destroy(dev->conn_map, NULL);
+	queue_destroy(dev->conn_list, conn_free);
+	queue_destroy(dev->adv_list, adv_free);
+	free(dev);
+}
+
+static void print_conn(void *data, void *user_data)
+{
+	struct hci_conn *conn = data;
+	double duration;
+	int i;
+
+	switch (conn->type) {
+	case CONN_TYPE_BREDR:
+		printf("    BR/EDR handle %u", conn->handle);
+		break;
+	case CONN_TYPE_LE:
+		printf("    LE handle %u", conn->handle);
+		break;
+	default:
+		printf("    Handle %u\n", conn->handle);
+		break;
+	}
+
+	if (conn->type != CONN_TYPE_UNKNOWN) {
+		printf(" %2.2X:%2.2X:%2.2X:%2.2X:%2.2X:%2.2X",
+			conn->bdaddr[5], conn->bdaddr[4], conn->bdaddr[3],
+			conn->bdaddr[2], conn->bdaddr[1], conn->bdaddr[0]);
+
+		if (conn->type == CONN_TYPE_LE)
+			printf(" (%s)", addr_type_str(conn->bdaddr_type));
+
+		printf("\n");
+	}
+
+	printf("      %lu TX packets, %lu bytes\n", conn->tx_pkts,
+							conn->tx_bytes);
+	printf("      %lu RX packets, %lu bytes\n", conn->rx_pkts,
+							conn->rx_bytes);
+
+	duration = tv_diff(&conn->last_acl, &conn->first_acl);
+	if (duration > 0)
+		printf("      %.3f seconds, %.1f kbit/s\n", duration,
+			(conn->tx_bytes + conn->rx_bytes) * 8 / duration / 1000);
+
+	if (!conn->att)
+		return;
+
+	for (i = 0; i < 256; i++) {
+		struct latency *lat = &conn->att->latency[i];
+
+		if (!conn->att->opcodes[DIR_TX][i] &&
+					!conn->att->opcodes[DIR_RX][i])
+			continue;
+
+		printf("      ATT opcode 0x%2.2x: %lu TX, %lu RX", i,
+						conn->att->opcodes[DIR_TX][i],
+						conn->att->opcodes[DIR_RX][i]);
+
+		if (lat->count)
+			printf(", latency %.3f/%.3f/%.3f msec",
+					lat->min / 1000.0,
+					lat->total / 1000.0 / lat->count,
+					lat->max / 1000.0);
+
+		printf("\n");
+	}
+}
+
+static int adv_compare(const void *a, const void *b)
+{
+	const struct adv_addr *adv_a = *(const struct adv_addr **) a;
+	const struct adv_addr *adv_b = *(const struct adv_addr **) b;
+
+	if (adv_a->count != adv_b->count)
+		return adv_a->count < adv_b->count ? 1 : -1;
+
+	return memcmp(adv_a->addr, adv_b->addr, 6);
+}
+
+static void print_adv(struct hci_dev *dev)
+{
+	const struct queue_entry *entry;
+	struct adv_addr **list, *adv;
+	unsigned int count = 0, i;
+
+	for (entry = queue_get_entries(dev->adv_list); entry;
+							entry = entry->next)
+		for (adv = entry->data; adv; adv = adv->next)
+			count++;
+
+	if (!count)
+		return;
+
+	list = new0(struct adv_addr *, count);
+	if (!list)
+		return;
+
+	count = 0;
+
+	for (entry = queue_get_entries(dev->adv_list); entry;
+							entry = entry->next)
+		for (adv = entry->data; adv; adv = adv->next)
+			list[count++] = adv;
+
+	qsort(list, count, sizeof(*list), adv_compare);
+
+	printf("  %u advertisers\n", count);
+
+	for (i = 0; i < count; i++) {
+		double duration;
+
+		adv = list[i];
+		duration = tv_diff(&adv->last, &adv->first);
+
+		printf("    %2.2X:%2.2X:%2.2X:%2.2X:%2.2X:%2.2X (%s)",
+					adv->addr[5], adv->addr[4], adv->addr[3],
+					adv->addr[2], adv->addr[1], adv->addr[0],
+					addr_type_str(adv->addr_type));
+
+		if (duration > 0)
+			printf(" %lu reports, %.2f/sec\n", adv->count,
+						(adv->count - 1) / duration);
+		else
+			printf(" %lu reports\n", adv->count);
+	}
+
+	free(list);
+}
 
 static void dev_destroy(void *data)
 {
@@ -74,9 +399,17 @@ static void dev_destroy(void *data)
 	printf("  %lu events\n", dev->num_evt);
 	printf("  %lu ACL packets\n", dev->num_acl);
 	printf("  %lu SCO packets\n", dev->num_sco);
+
+	if (!queue_isempty(dev->conn_list)) {
+		printf("  %u connections\n", queue_length(dev->conn_list));
+		queue_foreach(dev->conn_list, print_conn, NULL);
+	}
+
+	print_adv(dev);
+
 	printf("\n");
 
-	free(dev);
+	dev_free(dev);
 }
 
 static struct hci_dev *dev_alloc(uint16_t index)
@@ -90,6 +423,15 @@ static struct hci_dev *dev_alloc(uint16_t index)
 	}
 
 	dev->index = index;
+	dev->conn_list = queue_new();
+	dev->conn_map = queue_new_keyed(conn_key);
+	dev->adv_list = queue_new_keyed(adv_key);
+
+	if (!dev->conn_list || !dev->conn_map || !dev->adv_list) {
+		fprintf(stderr, "Failed to allocate new device entry\n");
+		dev_free(dev);
+		return NULL;
+	}
 
 	return dev;
 }
@@ -102,163 +444,931 @@ static bool dev_match_index(const void *a, const void *b)
 	return dev->index == index;
 }
 
-static struct hci_dev *dev_lookup(uint16_t index)
+static struct log_entry *log_add(struct analyze *ctx, enum log_type type,
+				uint16_t index, struct hci_dev *dev, char *text)
+{
+	struct log_entry *entry;
+
+	/* Live statistics are never merged */
+	if (!ctx->log) {
+		free(text);
+		return NULL;
+	}
+
+	entry = new0(struct log_entry, 1);
+	if (!entry) {
+		free(text);
+		return NULL;
+	}
+
+	entry->type = type;
+	entry->index = index;
+	entry->dev = dev;
+	entry->text = text;
+
+	queue_push_tail(ctx->log, entry);
+
+	return entry;
+}
+
+static void log_free(void *data)
+{
+	struct log_entry *entry = data;
+
+	if (entry->dev)
+		dev_free(entry->dev);
+
+	free(entry->text);
+	free(entry);
+}
+
+static struct hci_dev *dev_lookup(struct analyze *ctx, uint16_t index)
 {
 	struct hci_dev *dev;
 
-	dev = queue_find(dev_list, dev_match_index, UINT_TO_PTR(index));
+	dev = queue_find(ctx->dev_list, dev_match_index, UINT_TO_PTR(index));
 	if (!dev) {
-		fprintf(stderr, "Creating new device for unknown index\n");
-
 		dev = dev_alloc(index);
 		if (!dev)
 			return NULL;
 
-		queue_push_tail(dev_list, dev);
+		/* Might have been added before this range */
+		dev->implicit = true;
+
+		queue_push_tail(ctx->dev_list, dev);
+		log_add(ctx, LOG_DEV_ADDED, index, dev, NULL);
 	}
 
 	return dev;
 }
 
-static void new_index(struct timeval *tv, uint16_t index,
-					const void *data, uint16_t size)
+static struct hci_conn *conn_alloc(uint16_t handle, uint8_t type)
 {
-	const struct btsnoop_opcode_new_index *ni = data;
-	struct hci_dev *dev;
+	struct hci_conn *conn;
 
-	dev = dev_alloc(index);
-	if (!dev)
-		return;
+	conn = new0(struct hci_conn, 1);
+	if (!conn)
+		return NULL;
 
-	dev->type = ni->type;
-	memcpy(dev->bdaddr, ni->bdaddr, 6);
+	conn->handle = handle;
+	conn->type = type;
 
-	queue_push_tail(dev_list, dev);
+	return conn;
 }
 
-static void del_index(struct timeval *tv, uint16_t index,
-					const void *data, uint16_t size)
+static struct hci_conn *conn_add(struct hci_dev *dev, uint16_t handle,
+							uint8_t type)
 {
-	struct hci_dev *dev;
+	struct hci_conn *conn;
 
-	dev = queue_remove_if(dev_list, dev_match_index, UINT_TO_PTR(index));
-	if (!dev) {
-		fprintf(stderr, "Remove for an unexisting device\n");
+	conn = queue_remove_by_key(dev->conn_map, handle);
+	if (conn)
+		conn->closed = true;
+
+	conn = conn_alloc(handle, type);
+	if (!conn)
+		return NULL;
+
+	queue_push_tail(dev->conn_list, conn);
+	queue_push_tail(dev->conn_map, conn);
+
+	return conn;
+}
+
+static struct hci_conn *conn_lookup(struct hci_dev *dev, uint16_t handle)
+{
+	struct hci_conn *conn;
+
+	conn = queue_find_by_key(dev->conn_map, handle);
+	if (conn)
+		return conn;
+
+	conn = conn_add(dev, handle, CONN_TYPE_UNKNOWN);
+	if (conn)
+		conn->implicit = true;
+
+	return conn;
+}
+
+static void conn_remove(struct hci_dev *dev, uint16_t handle)
+{
+	struct hci_conn *conn;
+
+	/* A connection from before this range still needs closing */
+	conn = conn_lookup(dev, handle);
+	if (!conn)
 		return;
+
+	queue_remove_by_key(dev->conn_map, handle);
+	conn->closed = true;
+}
+
+static void adv_insert(struct hci_dev *dev, struct adv_addr *head,
+							struct adv_addr *adv)
+{
+	/* Addresses with the same key hang off the first one */
+	if (head) {
+		adv->next = head->next;
+		head->next = adv;
+	} else
+		queue_push_tail(dev->adv_list, adv);
+}
+
+static struct adv_addr *adv_lookup(struct hci_dev *dev, const uint8_t *addr,
+							uint8_t addr_type)
+{
+	struct adv_addr *head, *adv;
+
+	head = queue_find_by_key(dev->adv_list, adv_hash(addr, addr_type));
+
+	for (adv = head; adv; adv = adv->next) {
+		if (adv->addr_type == addr_type && !memcmp(adv->addr, addr, 6))
+			return adv;
 	}
 
-	dev_destroy(dev);
+	adv = new0(struct adv_addr, 1);
+	if (!adv)
+		return NULL;
+
+	memcpy(adv->addr, addr, 6);
+	adv->addr_type = addr_type;
+
+	adv_insert(dev, head, adv);
+
+	return adv;
 }
 
-static void command_pkt(struct timeval *tv, uint16_t index,
-					const void *data, uint16_t size)
+static void adv_report(struct hci_dev *dev, struct timeval *tv,
+				const uint8_t *addr, uint8_t addr_type)
 {
-	const struct bt_hci_cmd_hdr *hdr = data;
-	struct hci_dev *dev;
+	struct adv_addr *adv;
 
-	data += sizeof(*hdr);
-	size -= sizeof(*hdr);
+	dev->num_adv++;
 
-	dev = dev_lookup(index);
-	if (!dev)
+	adv = adv_lookup(dev, addr, addr_type);
+	if (!adv)
 		return;
 
-	dev->num_cmd++;
+	if (!adv->count++)
+		adv->first = *tv;
+
+	adv->last = *tv;
 }
 
-static void rsp_read_bd_addr(struct hci_dev *dev, struct timeval *tv,
-					const void *data, uint16_t size)
+static void latency_add(struct latency *lat, uint64_t value)
 {
-	const struct bt_hci_rsp_read_bd_addr *rsp = data;
+	if (!lat->count || value < lat->min)
+		lat->min = value;
 
-	printf("Read BD Addr event with status 0x%2.2x\n", rsp->status);
+	if (value > lat->max)
+		lat->max = value;
 
-	if (rsp->status)
+	lat->total += value;
+	lat->count++;
+}
+
+static void latency_merge(struct latency *lat,
+					const struct latency *other)
+{
+	if (!other->count)
 		return;
 
-	memcpy(dev->bdaddr, rsp->bdaddr, 6);
+	if (!lat->count || other->min < lat->min)
+		lat->min = other->min;
+
+	if (other->max > lat->max)
+		lat->max = other->max;
+
+	lat->total += other->total;
+	lat->count += other->count;
 }
 
-static void evt_cmd_complete(struct hci_dev *dev, struct timeval *tv,
-					const void *data, uint16_t size)
+static void att_sample(struct att_stats *att, const struct att_request *req,
+						const struct timeval *tv)
 {
-	const struct bt_hci_evt_cmd_complete *evt = data;
-	uint16_t opcode;
+	struct timeval diff;
 
-	data += sizeof(*evt);
-	size -= sizeof(*evt);
+	if (timercmp(tv, &req->tv, <))
+		return;
 
-	opcode = le16_to_cpu(evt->opcode);
+	timersub(tv, &req->tv, &diff);
+	latency_add(&att->latency[req->opcode],
+				diff.tv_sec * 1000000ull + diff.tv_usec);
+}
 
+static bool att_is_request(uint8_t opcode)
+{
 	switch (opcode) {
-	case BT_HCI_CMD_READ_BD_ADDR:
-		rsp_read_bd_addr(dev, tv, data, size);
-		break;
+	case 0x02:
+	case 0x04:
+	case 0x06:
+	case 0x08:
+	case 0x0a:
+	case 0x0c:
+	case 0x0e:
+	case 0x10:
+	case 0x12:
+	case 0x16:
+	case 0x18:
+	case 0x1d:
+	case 0x20:
+		return true;
 	}
+
+	return false;
 }
 
-static void event_pkt(struct timeval *tv, uint16_t index,
-					const void *data, uint16_t size)
+static bool att_is_response(uint8_t opcode)
 {
-	const struct bt_hci_evt_hdr *hdr = data;
-	struct hci_dev *dev;
+	return opcode == 0x01 || opcode == 0x1e ||
+			(opcode != 0x1d && att_is_request(opcode - 1));
+}
 
-	data += sizeof(*hdr);
-	size -= sizeof(*hdr);
+static void att_pdu(struct hci_conn *conn, struct timeval *tv, int dir,
+							uint8_t opcode)
+{
+	struct att_stats *att;
+	int req_dir = !dir;
 
-	dev = dev_lookup(index);
-	if (!dev)
+	if (!conn->att) {
+		conn->att = new0(struct att_stats, 1);
+		if (!conn->att)
+			return;
+	}
+
+	att = conn->att;
+	att->opcodes[dir][opcode]++;
+	conn->att_pdus++;
+
+	if (att_is_request(opcode)) {
+		att->pending[dir].valid = true;
+		att->pending[dir].opcode = opcode;
+		att->pending[dir].tv = *tv;
+		att->seen_req[dir] = true;
 		return;
+	}
 
-	dev->num_evt++;
+	if (!att_is_response(opcode))
+		return;
 
-	switch (hdr->evt) {
-	case BT_HCI_EVT_CMD_COMPLETE:
-		evt_cmd_complete(dev, tv, data, size);
-		break;
+	if (att->pending[req_dir].valid) {
+		att_sample(att, &att->pending[req_dir], tv);
+		att->pending[req_dir].valid = false;
+		return;
+	}
+
+	/* Only the first one can answer a request from before this range */
+	if (!att->seen_req[req_dir] && !att->lead_done[req_dir]) {
+		att->lead_done[req_dir] = true;
+		att->lead_valid[req_dir] = true;
+		att->lead_rsp[req_dir] = *tv;
 	}
 }
 
-static void acl_pkt(struct timeval *tv, uint16_t index,
+static void new_index(struct analyze *ctx, struct timeval *tv, uint16_t index,
 					const void *data, uint16_t size)
 {
-	const struct bt_hci_acl_hdr *hdr = data;
+	const struct btsnoop_opcode_new_index *ni = data;
 	struct hci_dev *dev;
 
-	data += sizeof(*hdr);
-	size -= sizeof(*hdr);
-
-	dev = dev_lookup(index);
+	dev = dev_alloc(index);
 	if (!dev)
 		return;
 
-	dev->num_acl++;
+	dev->type = ni->type;
+	memcpy(dev->bdaddr, ni->bdaddr, 6);
+
+	queue_push_tail(ctx->dev_list, dev);
+	log_add(ctx, LOG_DEV_ADDED, index, dev, NULL);
 }
 
-static void sco_pkt(struct timeval *tv, uint16_t index,
+static void del_index(struct analyze *ctx, struct timeval *tv, uint16_t index,
 					const void *data, uint16_t size)
 {
-	const struct bt_hci_sco_hdr *hdr = data;
 	struct hci_dev *dev;
 
-	data += sizeof(*hdr);
-	size -= sizeof(*hdr);
+	dev = queue_remove_if(ctx->dev_list, dev_match_index,
+							UINT_TO_PTR(index));
 
-	dev = dev_lookup(index);
-	if (!dev)
+	/* Without a log nothing else refers to the device */
+	if (!ctx->log) {
+		if (dev)
+			dev_free(dev);
 		return;
+	}
 
-	dev->num_sco++;
+	log_add(ctx, LOG_DEV_REMOVED, index, NULL, NULL);
 }
 
-void analyze_trace(const char *path)
+static void command_pkt(struct analyze *ctx, struct timeval *tv,
+			uint16_t index, const void *data, uint16_t size)
 {
-	struct btsnoop *btsnoop_file;
-	unsigned long num_packets = 0;
-	uint32_t type;
+	const struct bt_hci_cmd_hdr *hdr = data;
+	struct hci_dev *dev;
 
-	btsnoop_file = btsnoop_open(path, BTSNOOP_FLAG_PKLG_SUPPORT);
-	if (!btsnoop_file)
+	data += sizeof(*hdr);
+	size -= sizeof(*hdr);
+
+	dev = dev_lookup(ctx, index);
+	if (!dev)
+		return;
+
+	dev->num_cmd++;
+
+	dev->cmd_pending = true;
+	dev->cmd_opcode = le16_to_cpu(hdr->opcode);
+	dev->cmd_time = *tv;
+}
+
+static void cmd_done(struct hci_dev *dev, struct timeval *tv, uint16_t opcode)
+{
+	struct timeval diff;
+
+	if (!dev->cmd_pending || dev->cmd_opcode != opcode)
+		return;
+
+	dev->cmd_pending = false;
+
+	if (timercmp(tv, &dev->cmd_time, <))
+		return;
+
+	timersub(tv, &dev->cmd_time, &diff);
+	latency_add(&dev->cmd_latency,
+				diff.tv_sec * 1000000ull + diff.tv_usec);
+}
+
+static void rsp_read_bd_addr(struct analyze *ctx, struct hci_dev *dev,
+				struct timeval *tv, const void *data, uint16_t size)
+{
+	const struct bt_hci_rsp_read_bd_addr *rsp = data;
+	char *text;
+
+	if (asprintf(&text, "Read BD Addr event with status 0x%2.2x\n",
+							rsp->status) >= 0)
+		log_add(ctx, LOG_TEXT, dev->index, NULL, text);
+
+	if (rsp->status)
+		return;
+
+	memcpy(dev->bdaddr, rsp->bdaddr, 6);
+	dev->bdaddr_set = true;
+}
+
+static void evt_cmd_complete(struct analyze *ctx, struct hci_dev *dev,
+				struct timeval *tv, const void *data, uint16_t size)
+{
+	const struct bt_hci_evt_cmd_complete *evt = data;
+	uint16_t opcode;
+
+	data += sizeof(*evt);
+	size -= sizeof(*evt);
+
+	opcode = le16_to_cpu(evt->opcode);
+
+	cmd_done(dev, tv, opcode);
+
+	switch (opcode) {
+	case BT_HCI_CMD_READ_BD_ADDR:
+		rsp_read_bd_addr(ctx, dev, tv, data, size);
+		break;
+	}
+}
+
+static void evt_cmd_status(struct hci_dev *dev, struct timeval *tv,
+					const void *data, uint16_t size)
+{
+	const struct bt_hci_evt_cmd_status *evt = data;
+
+	if (size < sizeof(*evt))
+		return;
+
+	cmd_done(dev, tv, le16_to_cpu(evt->opcode));
+}
+
+static void evt_conn_complete(struct hci_dev *dev, struct timeval *tv,
+					const void *data, uint16_t size)
+{
+	const struct bt_hci_evt_conn_complete *evt = data;
+	struct hci_conn *conn;
+
+	if (size < sizeof(*evt) || evt->status || evt->link_type != 0x01)
+		return;
+
+	conn = conn_add(dev, le16_to_cpu(evt->handle), CONN_TYPE_BREDR);
+	if (!conn)
+		return;
+
+	memcpy(conn->bdaddr, evt->bdaddr, 6);
+}
+
+static void evt_disconnect_complete(struct hci_dev *dev, struct timeval *tv,
+					const void *data, uint16_t size)
+{
+	const struct bt_hci_evt_disconnect_complete *evt = data;
+
+	if (size < sizeof(*evt) || evt->status)
+		return;
+
+	conn_remove(dev, le16_to_cpu(evt->handle));
+}
+
+static void le_conn_complete(struct hci_dev *dev, uint8_t status,
+				uint16_t handle, uint8_t addr_type,
+				const uint8_t *addr)
+{
+	struct hci_conn *conn;
+
+	if (status)
+		return;
+
+	conn = conn_add(dev, le16_to_cpu(handle), CONN_TYPE_LE);
+	if (!conn)
+		return;
+
+	memcpy(conn->bdaddr, addr, 6);
+	conn->bdaddr_type = addr_type;
+}
+
+static void le_adv_report(struct hci_dev *dev, struct timeval *tv,
+					const void *data, uint16_t size)
+{
+	const struct bt_hci_evt_le_adv_report *evt = data;
+	uint8_t num_reports;
+
+	if (size < sizeof(*evt))
+		return;
+
+	num_reports = evt->num_reports;
+
+	/* Reports follow each other, each one ending with its RSSI */
+	while (num_reports--) {
+		if (size < sizeof(*evt) ||
+				size < sizeof(*evt) + evt->data_len + 1)
+			return;
+
+		adv_report(dev, tv, evt->addr, evt->addr_type);
+
+		data += sizeof(*evt) + evt->data_len;
+		size -= sizeof(*evt) + evt->data_len;
+		evt = data;
+	}
+}
+
+static void le_direct_adv_report(struct hci_dev *dev, struct timeval *tv,
+					const void *data, uint16_t size)
+{
+	const struct bt_hci_evt_le_direct_adv_report *evt = data;
+	uint8_t num_reports;
+
+	if (size < sizeof(*evt))
+		return;
+
+	num_reports = evt->num_reports;
+
+	while (num_reports-- && size >= sizeof(*evt)) {
+		adv_report(dev, tv, evt->addr, evt->addr_type);
+
+		data += sizeof(*evt) - 1;
+		size -= sizeof(*evt) - 1;
+		evt = data;
+	}
+}
+
+static void le_ext_adv_report(struct hci_dev *dev, struct timeval *tv,
+					const void *data, uint16_t size)
+{
+	const struct bt_hci_evt_le_ext_adv_report *evt = data;
+	const struct bt_hci_le_ext_adv_report *report;
+	uint8_t num_reports;
+
+	if (size < sizeof(*evt))
+		return;
+
+	num_reports = evt->num_reports;
+	data += sizeof(*evt);
+	size -= sizeof(*evt);
+
+	while (num_reports--) {
+		report = data;
+
+		if (size < sizeof(*report) ||
+				size < sizeof(*report) + report->data_len)
+			return;
+
+		adv_report(dev, tv, report->addr, report->addr_type);
+
+		data += sizeof(*report) + report->data_len;
+		size -= sizeof(*report) + report->data_len;
+	}
+}
+
+static void evt_le_meta_event(struct hci_dev *dev, struct timeval *tv,
+					const void *data, uint16_t size)
+{
+	uint8_t subevent;
+
+	if (size < 1)
+		return;
+
+	subevent = *((const uint8_t *) data);
+
+	data++;
+	size--;
+
+	switch (subevent) {
+	case BT_HCI_EVT_LE_CONN_COMPLETE:
+		if (size >= sizeof(struct bt_hci_evt_le_conn_complete)) {
+			const struct bt_hci_evt_le_conn_complete *evt = data;
+
+			le_conn_complete(dev, evt->status, evt->handle,
+					evt->peer_addr_type, evt->peer_addr);
+		}
+		break;
+	case BT_HCI_EVT_LE_ENHANCED_CONN_COMPLETE:
+		if (size >= sizeof(struct
+				bt_hci_evt_le_enhanced_conn_complete)) {
+			const struct bt_hci_evt_le_enhanced_conn_complete *evt;
+
+			evt = data;
+			le_conn_complete(dev, evt->status, evt->handle,
+					evt->peer_addr_type, evt->peer_addr);
+		}
+		break;
+	case BT_HCI_EVT_LE_ADV_REPORT:
+		le_adv_report(dev, tv, data, size);
+		break;
+	case BT_HCI_EVT_LE_DIRECT_ADV_REPORT:
+		le_direct_adv_report(dev, tv, data, size);
+		break;
+	case BT_HCI_EVT_LE_EXT_ADV_REPORT:
+		le_ext_adv_report(dev, tv, data, size);
+		break;
+	}
+}
+
+static void event_pkt(struct analyze *ctx, struct timeval *tv,
+			uint16_t index, const void *data, uint16_t size)
+{
+	const struct bt_hci_evt_hdr *hdr = data;
+	struct hci_dev *dev;
+
+	data += sizeof(*hdr);
+	size -= sizeof(*hdr);
+
+	dev = dev_lookup(ctx, index);
+	if (!dev)
+		return;
+
+	dev->num_evt++;
+
+	switch (hdr->evt) {
+	case BT_HCI_EVT_CMD_COMPLETE:
+		evt_cmd_complete(ctx, dev, tv, data, size);
+		break;
+	case BT_HCI_EVT_CMD_STATUS:
+		evt_cmd_status(dev, tv, data, size);
+		break;
+	case BT_HCI_EVT_CONN_COMPLETE:
+		evt_conn_complete(dev, tv, data, size);
+		break;
+	case BT_HCI_EVT_DISCONNECT_COMPLETE:
+		evt_disconnect_complete(dev, tv, data, size);
+		break;
+	case BT_HCI_EVT_LE_META_EVENT:
+		evt_le_meta_event(dev, tv, data, size);
+		break;
+	}
+}
+
+static void acl_pkt(struct analyze *ctx, struct timeval *tv, uint16_t index,
+			int dir, const void *data, uint16_t size)
+{
+	const struct bt_hci_acl_hdr *hdr = data;
+	const struct bt_l2cap_hdr *l2cap;
+	struct hci_dev *dev;
+	struct hci_conn *conn;
+	uint16_t handle;
+	uint8_t flags;
+
+	data += sizeof(*hdr);
+	size -= sizeof(*hdr);
+
+	dev = dev_lookup(ctx, index);
+	if (!dev)
+		return;
+
+	dev->num_acl++;
+
+	if (size > UINT16_MAX - sizeof(*hdr))
+		return;
+
+	handle = le16_to_cpu(hdr->handle);
+	flags = handle >> 12;
+
+	conn = conn_lookup(dev, handle & 0x0fff);
+	if (!conn)
+		return;
+
+	if (!conn->tx_pkts && !conn->rx_pkts)
+		conn->first_acl = *tv;
+
+	conn->last_acl = *tv;
+
+	if (dir == DIR_TX) {
+		conn->tx_pkts++;
+		conn->tx_bytes += size;
+	} else {
+		conn->rx_pkts++;
+		conn->rx_bytes += size;
+	}
+
+	/* Only start fragments carry the L2CAP header */
+	if ((flags & 0x03) == 0x01 || size < sizeof(*l2cap) + 1)
+		return;
+
+	l2cap = data;
+	if (le16_to_cpu(l2cap->cid) != ATT_CID)
+		return;
+
+	att_pdu(conn, tv, dir, *((const uint8_t *) data + sizeof(*l2cap)));
+}
+
+static void sco_pkt(struct analyze *ctx, struct timeval *tv, uint16_t index,
+					const void *data, uint16_t size)
+{
+	const struct bt_hci_sco_hdr *hdr = data;
+	struct hci_dev *dev;
+
+	data += sizeof(*hdr);
+	size -= sizeof(*hdr);
+
+	dev = dev_lookup(ctx, index);
+	if (!dev)
+		return;
+
+	dev->num_sco++;
+}
+
+static bool process_packet(struct analyze *ctx, struct timeval *tv,
+					uint16_t index, uint16_t opcode,
+					const void *buf, uint16_t pktlen)
+{
+	struct log_entry *entry;
+
+	switch (opcode) {
+	case BTSNOOP_OPCODE_NEW_INDEX:
+		new_index(ctx, tv, index, buf, pktlen);
+		break;
+	case BTSNOOP_OPCODE_DEL_INDEX:
+		del_index(ctx, tv, index, buf, pktlen);
+		break;
+	case BTSNOOP_OPCODE_COMMAND_PKT:
+		command_pkt(ctx, tv, index, buf, pktlen);
+		break;
+	case BTSNOOP_OPCODE_EVENT_PKT:
+		event_pkt(ctx, tv, index, buf, pktlen);
+		break;
+	case BTSNOOP_OPCODE_ACL_TX_PKT:
+		acl_pkt(ctx, tv, index, DIR_TX, buf, pktlen);
+		break;
+	case BTSNOOP_OPCODE_ACL_RX_PKT:
+		acl_pkt(ctx, tv, index, DIR_RX, buf, pktlen);
+		break;
+	case BTSNOOP_OPCODE_SCO_TX_PKT:
+	case BTSNOOP_OPCODE_SCO_RX_PKT:
+		sco_pkt(ctx, tv, index, buf, pktlen);
+		break;
+	default:
+		entry = log_add(ctx, LOG_WRONG_OPCODE, index, NULL, NULL);
+		if (entry)
+			entry->opcode = opcode;
+		return false;
+	}
+
+	ctx->num_packets++;
+
+	return true;
+}
+
+static void *analyze_range(void *user_data)
+{
+	struct analyze *ctx = user_data;
+	struct btsnoop *btsnoop_file;
+
+	btsnoop_file = btsnoop_open(ctx->path, BTSNOOP_FLAG_PKLG_SUPPORT |
+							BTSNOOP_FLAG_MMAP);
+	if (!btsnoop_file)
+		return NULL;
+
+	if (!btsnoop_set_range(btsnoop_file, ctx->start, ctx->end))
+		goto done;
+
+	while (1) {
+		const void *buf;
+		struct timeval tv;
+		uint16_t index, opcode, pktlen;
+
+		if (!btsnoop_next_hci(btsnoop_file, &tv, &index, &opcode,
+								&buf, &pktlen))
+			break;
+
+		if (!process_packet(ctx, &tv, index, opcode, buf, pktlen))
+			break;
+	}
+
+done:
+	btsnoop_unref(btsnoop_file);
+
+	/* Pooled queue entries would be lost with the thread */
+	queue_release_pool();
+
+	return NULL;
+}
+
+static void att_merge(struct hci_conn *conn, const struct att_stats *other)
+{
+	struct att_stats *att;
+	int dir, i;
+
+	if (!conn->att) {
+		conn->att = new0(struct att_stats, 1);
+		if (!conn->att)
+			return;
+	}
+
+	att = conn->att;
+
+	for (dir = 0; dir < 2; dir++) {
+		for (i = 0; i < 256; i++)
+			att->opcodes[dir][i] += other->opcodes[dir][i];
+
+		if (other->lead_valid[dir] && att->pending[dir].valid) {
+			att_sample(att, &att->pending[dir], &other->lead_rsp[dir]);
+			att->pending[dir].valid = false;
+		}
+
+		if (other->seen_req[dir])
+			att->pending[dir] = other->pending[dir];
+	}
+
+	for (i = 0; i < 256; i++)
+		latency_merge(&att->latency[i], &other->latency[i]);
+}
+
+static void conn_merge(struct hci_dev *dev, const struct hci_conn *other)
+{
+	struct hci_conn *conn = NULL;
+
+	if (other->implicit)
+		conn = queue_find_by_key(dev->conn_map, other->handle);
+
+	if (!conn) {
+		conn = conn_add(dev, other->handle, other->type);
+		if (!conn)
+			return;
+
+		memcpy(conn->bdaddr, other->bdaddr, 6);
+		conn->bdaddr_type = other->bdaddr_type;
+	}
+
+	if (other->tx_pkts || other->rx_pkts) {
+		if (!conn->tx_pkts && !conn->rx_pkts)
+			conn->first_acl = other->first_acl;
+
+		conn->last_acl = other->last_acl;
+	}
+
+	conn->tx_pkts += other->tx_pkts;
+	conn->tx_bytes += other->tx_bytes;
+	conn->rx_pkts += other->rx_pkts;
+	conn->rx_bytes += other->rx_bytes;
+
+	if (other->att)
+		att_merge(conn, other->att);
+
+	if (other->closed) {
+		queue_remove_by_key(dev->conn_map, conn->handle);
+		conn->closed = true;
+	}
+}
+
+static void dev_merge(struct hci_dev *dev, const struct hci_dev *other)
+{
+	const struct queue_entry *entry;
+	const struct adv_addr *src;
+	struct adv_addr *adv;
+
+	dev->num_cmd += other->num_cmd;
+	dev->num_evt += other->num_evt;
+	dev->num_acl += other->num_acl;
+	dev->num_sco += other->num_sco;
+
+	if (other->bdaddr_set)
+		memcpy(dev->bdaddr, other->bdaddr, 6);
+
+	for (entry = queue_get_entries(other->conn_list); entry;
+							entry = entry->next)
+		conn_merge(dev, entry->data);
+
+	for (entry = queue_get_entries(other->adv_list); entry;
+							entry = entry->next) {
+		for (src = entry->data; src; src = src->next) {
+			adv = adv_lookup(dev, src->addr, src->addr_type);
+			if (!adv)
+				continue;
+
+			if (!adv->count || timercmp(&src->first, &adv->first, <))
+				adv->first = src->first;
+
+			if (!adv->count || timercmp(&src->last, &adv->last, >))
+				adv->last = src->last;
+
+			adv->count += src->count;
+		}
+	}
+}
+
+/* Replays a range in trace order on top of everything before it */
+static bool merge_range(struct queue *dev_list, struct analyze *ctx)
+{
+	const struct queue_entry *entry;
+	struct hci_dev *dev;
+
+	for (entry = queue_get_entries(ctx->log); entry; entry = entry->next) {
+		struct log_entry *log = entry->data;
+
+		switch (log->type) {
+		case LOG_DEV_ADDED:
+			dev = NULL;
+
+			if (log->dev->implicit) {
+				dev = queue_find(dev_list, dev_match_index,
+						UINT_TO_PTR(log->index));
+				if (!dev)
+					fprintf(stderr, "Creating new device "
+							"for unknown index\n");
+			}
+
+			if (!dev) {
+				dev = dev_alloc(log->index);
+				if (!dev)
+					break;
+
+				dev->type = log->dev->type;
+				memcpy(dev->bdaddr, log->dev->bdaddr, 6);
+				queue_push_tail(dev_list, dev);
+			}
+
+			dev_merge(dev, log->dev);
+			break;
+		case LOG_DEV_REMOVED:
+			dev = queue_remove_if(dev_list, dev_match_index,
+						UINT_TO_PTR(log->index));
+			if (!dev) {
+				fprintf(stderr, "Remove for an unexisting "
+								"device\n");
+				break;
+			}
+
+			dev_destroy(dev);
+			break;
+		case LOG_TEXT:
+			fputs(log->text, stdout);
+			break;
+		case LOG_WRONG_OPCODE:
+			fprintf(stderr, "Wrong opcode %u\n", log->opcode);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static unsigned int get_jobs(unsigned int jobs)
+{
+	long cpus;
+
+	if (!jobs) {
+		cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		jobs = cpus > 0 ? cpus : 1;
+	}
+
+	return jobs < MAX_JOBS ? jobs : MAX_JOBS;
+}
+
+void analyze_trace(const char *path, unsigned int jobs)
+{
+	struct btsnoop *btsnoop_file;
+	struct analyze ranges[MAX_JOBS];
+	uint64_t offsets[MAX_JOBS + 1];
+	struct queue *dev_list = NULL;
+	unsigned long num_packets = 0;
+	unsigned int num_ranges = 0, i;
+	uint32_t type;
+
+	btsnoop_file = btsnoop_open(path, BTSNOOP_FLAG_PKLG_SUPPORT |
+							BTSNOOP_FLAG_MMAP);
+	if (!btsnoop_file)
 		return;
 
 	type = btsnoop_get_type(btsnoop_file);
@@ -279,48 +1389,365 @@ void analyze_trace(const char *path)
 		goto done;
 	}
 
-	while (1) {
-		unsigned char buf[BTSNOOP_MAX_PACKET_SIZE];
-		struct timeval tv;
-		uint16_t index, opcode, pktlen;
+	/* Ranges start on record boundaries taken from the trace index */
+	num_ranges = btsnoop_split(btsnoop_file, get_jobs(jobs), offsets);
 
-		if (!btsnoop_read_hci(btsnoop_file, &tv, &index, &opcode,
-								buf, &pktlen))
-			break;
+	for (i = 0; i < num_ranges; i++) {
+		struct analyze *ctx = &ranges[i];
 
-		switch (opcode) {
-		case BTSNOOP_OPCODE_NEW_INDEX:
-			new_index(&tv, index, buf, pktlen);
-			break;
-		case BTSNOOP_OPCODE_DEL_INDEX:
-			del_index(&tv, index, buf, pktlen);
-			break;
-		case BTSNOOP_OPCODE_COMMAND_PKT:
-			command_pkt(&tv, index, buf, pktlen);
-			break;
-		case BTSNOOP_OPCODE_EVENT_PKT:
-			event_pkt(&tv, index, buf, pktlen);
-			break;
-		case BTSNOOP_OPCODE_ACL_TX_PKT:
-		case BTSNOOP_OPCODE_ACL_RX_PKT:
-			acl_pkt(&tv, index, buf, pktlen);
-			break;
-		case BTSNOOP_OPCODE_SCO_TX_PKT:
-		case BTSNOOP_OPCODE_SCO_RX_PKT:
-			sco_pkt(&tv, index, buf, pktlen);
-			break;
-		default:
-			fprintf(stderr, "Wrong opcode %u\n", opcode);
-			goto done;
+		memset(ctx, 0, sizeof(*ctx));
+		ctx->path = path;
+		ctx->start = offsets[i];
+		ctx->end = offsets[i + 1];
+		ctx->dev_list = queue_new();
+		ctx->log = queue_new();
+	}
+
+	for (i = 1; i < num_ranges; i++) {
+		if (pthread_create(&ranges[i].thread, NULL, analyze_range,
+							&ranges[i])) {
+			ranges[i].thread = 0;
+			analyze_range(&ranges[i]);
 		}
+	}
+
+	if (num_ranges)
+		analyze_range(&ranges[0]);
+
+	for (i = 1; i < num_ranges; i++) {
+		if (ranges[i].thread)
+			pthread_join(ranges[i].thread, NULL);
+	}
 
-		num_packets++;
+	for (i = 0; i < num_ranges; i++) {
+		if (!merge_range(dev_list, &ranges[i]))
+			goto free;
+
+		num_packets += ranges[i].num_packets;
 	}
 
 	printf("Trace contains %lu packets\n\n", num_packets);
 
 	queue_destroy(dev_list, dev_destroy);
+	dev_list = NULL;
+
+free:
+	for (i = 0; i < num_ranges; i++) {
+		queue_destroy(ranges[i].dev_list, NULL);
+		queue_destroy(ranges[i].log, log_free);
+	}
+
+	queue_destroy(dev_list, dev_free);
 
 done:
 	btsnoop_unref(btsnoop_file);
 }
+
+static struct analyze *live_ctx;
+static struct timespec live_time;
+static unsigned long live_packets;
+
+static double live_rate(unsigned long value, unsigned long prev,
+							double elapsed)
+{
+	return (value - prev) / elapsed;
+}
+
+static int live_conn_compare(const void *a, const void *b)
+{
+	const struct hci_conn *conn_a = *(const struct hci_conn **) a;
+	const struct hci_conn *conn_b = *(const struct hci_conn **) b;
+	unsigned long bytes_a, bytes_b;
+
+	bytes_a = conn_a->tx_bytes + conn_a->rx_bytes - conn_a->prev_bytes;
+	bytes_b = conn_b->tx_bytes + conn_b->rx_bytes - conn_b->prev_bytes;
+
+	if (bytes_a != bytes_b)
+		return bytes_a < bytes_b ? 1 : -1;
+
+	return conn_a->handle - conn_b->handle;
+}
+
+static bool match_closed(const void *data, const void *match_data)
+{
+	const struct hci_conn *conn = data;
+
+	return conn->closed;
+}
+
+static void live_conns(struct hci_dev *dev, double elapsed)
+{
+	const struct queue_entry *entry;
+	struct hci_conn **list, *conn;
+	unsigned int count = 0, i;
+	int j;
+
+	/* Connections that went away are only kept until now */
+	queue_remove_all(dev->conn_list, match_closed, NULL, conn_free);
+
+	count = queue_length(dev->conn_list);
+	if (!count)
+		return;
+
+	list = new0(struct hci_conn *, count);
+	if (!list)
+		return;
+
+	count = 0;
+
+	for (entry = queue_get_entries(dev->conn_list); entry;
+							entry = entry->next)
+		list[count++] = entry->data;
+
+	qsort(list, count, sizeof(*list), live_conn_compare);
+
+	printf("  %u connections\n", count);
+
+	for (i = 0; i < count; i++) {
+		conn = list[i];
+
+		switch (conn->type) {
+		case CONN_TYPE_BREDR:
+			printf("    BR/EDR handle %u", conn->handle);
+			break;
+		case CONN_TYPE_LE:
+			printf("    LE handle %u", conn->handle);
+			break;
+		default:
+			printf("    Handle %u", conn->handle);
+			break;
+		}
+
+		if (conn->type != CONN_TYPE_UNKNOWN)
+			printf(" %2.2X:%2.2X:%2.2X:%2.2X:%2.2X:%2.2X",
+				conn->bdaddr[5], conn->bdaddr[4],
+				conn->bdaddr[3], conn->bdaddr[2],
+				conn->bdaddr[1], conn->bdaddr[0]);
+
+		printf(" %.1f kbit/s", live_rate(conn->tx_bytes +
+					conn->rx_bytes, conn->prev_bytes,
+					elapsed) * 8 / 1000);
+
+		conn->prev_bytes = conn->tx_bytes + conn->rx_bytes;
+
+		if (!conn->att) {
+			printf("\n");
+			continue;
+		}
+
+		printf(", %.1f ATT PDU/sec\n", live_rate(conn->att_pdus,
+					conn->prev_att_pdus, elapsed));
+
+		conn->prev_att_pdus = conn->att_pdus;
+
+		printf("     ");
+
+		for (j = 0; j < 256; j++) {
+			unsigned long pdus;
+
+			pdus = conn->att->opcodes[DIR_TX][j] +
+					conn->att->opcodes[DIR_RX][j];
+			if (pdus)
+				printf(" 0x%2.2x:%lu", j, pdus);
+		}
+
+		printf("\n");
+	}
+
+	free(list);
+}
+
+static int live_adv_compare(const void *a, const void *b)
+{
+	const struct adv_addr *adv_a = *(const struct adv_addr **) a;
+	const struct adv_addr *adv_b = *(const struct adv_addr **) b;
+	unsigned long count_a = adv_a->count - adv_a->prev_count;
+	unsigned long count_b = adv_b->count - adv_b->prev_count;
+
+	if (count_a != count_b)
+		return count_a < count_b ? 1 : -1;
+
+	return memcmp(adv_a->addr, adv_b->addr, 6);
+}
+
+static void live_advs(struct hci_dev *dev, double elapsed)
+{
+	const struct queue_entry *entry;
+	struct queue *adv_list;
+	struct adv_addr **list, *adv;
+	unsigned int count = 0, i;
+
+	for (entry = queue_get_entries(dev->adv_list); entry;
+							entry = entry->next)
+		for (adv = entry->data; adv; adv = adv->next)
+			count++;
+
+	if (!count)
+		return;
+
+	list = new0(struct adv_addr *, count);
+	if (!list)
+		return;
+
+	count = 0;
+
+	for (entry = queue_get_entries(dev->adv_list); entry;
+							entry = entry->next)
+		for (adv = entry->data; adv; adv = adv->next)
+			list[count++] = adv;
+
+	qsort(list, count, sizeof(*list), live_adv_compare);
+
+	for (i = 0; i < count && i < LIVE_TOP_ADV; i++) {
+		adv = list[i];
+
+		if (adv->count == adv->prev_count)
+			break;
+
+		printf("    %2.2X:%2.2X:%2.2X:%2.2X:%2.2X:%2.2X (%s)"
+					" %.1f reports/sec\n",
+					adv->addr[5], adv->addr[4], adv->addr[3],
+					adv->addr[2], adv->addr[1], adv->addr[0],
+					addr_type_str(adv->addr_type),
+					live_rate(adv->count, adv->prev_count,
+								elapsed));
+	}
+
+	/* Forget advertisers that have been quiet since the last update */
+	adv_list = queue_new_keyed(adv_key);
+	if (!adv_list) {
+		free(list);
+		return;
+	}
+
+	queue_destroy(dev->adv_list, NULL);
+	dev->adv_list = adv_list;
+
+	for (i = 0; i < count; i++) {
+		adv = list[i];
+		adv->next = NULL;
+
+		if (adv->count == adv->prev_count) {
+			free(adv);
+			continue;
+		}
+
+		adv->prev_count = adv->count;
+		adv_insert(dev, queue_find_by_key(adv_list, adv_key(adv)), adv);
+	}
+
+	free(list);
+}
+
+static void live_dev(void *data, void *user_data)
+{
+	struct hci_dev *dev = data;
+	double elapsed = *((double *) user_data);
+	struct latency *lat = &dev->cmd_latency;
+
+	printf("Controller %u %2.2X:%2.2X:%2.2X:%2.2X:%2.2X:%2.2X\n",
+			dev->index,
+			dev->bdaddr[5], dev->bdaddr[4], dev->bdaddr[3],
+			dev->bdaddr[2], dev->bdaddr[1], dev->bdaddr[0]);
+	printf("  %.1f commands/sec, %.1f events/sec\n",
+			live_rate(dev->num_cmd, dev->prev_cmd, elapsed),
+			live_rate(dev->num_evt, dev->prev_evt, elapsed));
+	printf("  %.1f ACL packets/sec, %.1f SCO packets/sec\n",
+			live_rate(dev->num_acl, dev->prev_acl, elapsed),
+			live_rate(dev->num_sco, dev->prev_sco, elapsed));
+
+	if (lat->count)
+		printf("  Command latency %.3f/%.3f/%.3f msec\n",
+					lat->min / 1000.0,
+					lat->total / 1000.0 / lat->count,
+					lat->max / 1000.0);
+
+	live_conns(dev, elapsed);
+
+	printf("  %.1f advertising reports/sec\n",
+			live_rate(dev->num_adv, dev->prev_adv, elapsed));
+
+	live_advs(dev, elapsed);
+
+	printf("\n");
+
+	dev->prev_cmd = dev->num_cmd;
+	dev->prev_evt = dev->num_evt;
+	dev->prev_acl = dev->num_acl;
+	dev->prev_sco = dev->num_sco;
+	dev->prev_adv = dev->num_adv;
+	memset(lat, 0, sizeof(*lat));
+}
+
+bool analyze_live_start(void)
+{
+	live_ctx = new0(struct analyze, 1);
+	if (!live_ctx)
+		return false;
+
+	live_ctx->dev_list = queue_new();
+	if (!live_ctx->dev_list) {
+		free(live_ctx);
+		live_ctx = NULL;
+		return false;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &live_time);
+
+	return true;
+}
+
+void analyze_live_packet(struct timeval *tv, uint16_t index, uint16_t opcode,
+					const void *data, uint16_t size)
+{
+	struct timeval now;
+
+	if (!live_ctx)
+		return;
+
+	if (!tv) {
+		gettimeofday(&now, NULL);
+		tv = &now;
+	}
+
+	process_packet(live_ctx, tv, index, opcode, data, size);
+}
+
+void analyze_live_print(void)
+{
+	struct timespec now;
+	double elapsed;
+
+	if (!live_ctx)
+		return;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	elapsed = (now.tv_sec - live_time.tv_sec) +
+			(now.tv_nsec - live_time.tv_nsec) / 1000000000.0;
+	if (elapsed <= 0)
+		return;
+
+	if (isatty(STDOUT_FILENO))
+		printf("\033[H\033[2J");
+
+	printf("%lu packets, %.1f/sec\n\n", live_ctx->num_packets,
+			live_rate(live_ctx->num_packets, live_packets, elapsed));
+
+	queue_foreach(live_ctx->dev_list, live_dev, &elapsed);
+
+	fflush(stdout);
+
+	live_packets = live_ctx->num_packets;
+	live_time = now;
+}
+
+void analyze_live_stop(void)
+{
+	if (!live_ctx)
+		return;
+
+	queue_destroy(live_ctx->dev_list, dev_free);
+	free(live_ctx);
+	live_ctx = NULL;
+}
@@ -22,4 +22,14 @@
  *
  */
 
-void analyze_trace(const char *path);
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/time.h>
+
+void analyze_trace(const char *path, unsigned int jobs);
+
+bool analyze_live_start(void);
+void analyze_live_packet(struct timeval *tv, uint16_t index, uint16_t opcode,
+					const void *data, uint16_t size);
+void analyze_live_print(void);
+void analyze_live_stop(void);
@@ -28,12 +28,15 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <ctype.h>
 #include <errno.h>
+#include <time.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/time.h>
 #include <sys/socket.h>
+#include <sys/eventfd.h>
 #include <sys/un.h>
 
 #include "lib/bluetooth.h"
@@ -41,6 +44,7 @@
 #include "lib/mgmt.h"
 
 #include "src/shared/util.h"
+#include "src/shared/queue.h"
 #include "src/shared/btsnoop.h"
 #include "src/shared/mainloop.h"
 
@@ -48,24 +52,76 @@
 #include "packet.h"
 #include "hcidump.h"
 #include "ellisys.h"
+#include "filter.h"
+#include "analyze.h"
+#include "export.h"
 #include "control.h"
 
+#define WRITER_BUFFER_SIZE	(1024 * 1024)
+#define WRITER_FLUSH_INTERVAL	1000
+
+#define RECV_BATCH		32
+#define DECODE_BACKLOG		4096
+#define DECODE_BUDGET		64
+
 static struct btsnoop *btsnoop_file = NULL;
+static int flush_timeout = -1;
+static int stats_timeout = -1;
+static unsigned int stats_interval;
 static bool hcidump_fallback = false;
 
+struct window_time {
+	bool set;
+	bool relative;
+	struct timeval tv;
+};
+
+static struct window_time window_from;
+static struct window_time window_to;
+static uint16_t window_index = HCI_DEV_NONE;
+
+struct recv_batch {
+	struct mmsghdr msgs[RECV_BATCH];
+	struct iovec iov[RECV_BATCH][2];
+	struct mgmt_hdr hdr[RECV_BATCH];
+	unsigned char control[RECV_BATCH][CMSG_SPACE(sizeof(struct timeval))];
+	unsigned char buf[RECV_BATCH][BTSNOOP_MAX_PACKET_SIZE];
+};
+
 struct control_data {
 	uint16_t channel;
 	int fd;
+	struct recv_batch *batch;
 	unsigned char buf[BTSNOOP_MAX_PACKET_SIZE];
 	uint16_t offset;
 };
 
+/*
+ * Packets that have been captured but not yet decoded. Writing to disk
+ * happens as soon as a packet is received, while the text decode drains
+ * this queue from the mainloop and is allowed to fall behind.
+ */
+struct decode_entry {
+	uint16_t channel;
+	bool has_tv;
+	struct timeval tv;
+	uint16_t index;
+	uint16_t opcode;
+	uint16_t size;
+	unsigned int skipped;
+	uint8_t data[];
+};
+
+static struct queue *decode_queue = NULL;
+static int decode_fd = -1;
+
 static void free_data(void *user_data)
 {
 	struct control_data *data = user_data;
 
 	close(data->fd);
 
+	free(data->batch);
 	free(data);
 }
 
@@ -899,72 +955,237 @@ void control_message(uint16_t opcode, const void *data, uint16_t size)
 	}
 }
 
+static void decode_packet(uint16_t channel, struct timeval *tv,
+				uint16_t index, uint16_t opcode,
+				const void *data, uint16_t size)
+{
+	switch (channel) {
+	case HCI_CHANNEL_CONTROL:
+		packet_control(tv, index, opcode, data, size);
+		break;
+	case HCI_CHANNEL_MONITOR:
+		packet_monitor(tv, index, opcode, data, size);
+		break;
+	}
+}
+
+static void decode_entry(void *data)
+{
+	struct decode_entry *entry = data;
+
+	decode_packet(entry->channel, entry->has_tv ? &entry->tv : NULL,
+				entry->index, entry->opcode,
+				entry->data, entry->size);
+
+	if (entry->skipped && !export_skipped(entry->skipped))
+		printf("* %u packets not decoded\n", entry->skipped);
+
+	free(entry);
+}
+
+static void decode_callback(int fd, uint32_t events, void *user_data)
+{
+	unsigned int budget = DECODE_BUDGET;
+	uint64_t value;
+
+	while (budget-- > 0) {
+		struct decode_entry *entry = queue_pop_head(decode_queue);
+
+		if (!entry)
+			break;
+
+		decode_entry(entry);
+	}
+
+	/* Stay readable until the backlog has been worked off */
+	if (queue_isempty(decode_queue)) {
+		if (read(fd, &value, sizeof(value)) < 0)
+			return;
+	}
+}
+
+static void queue_decode(uint16_t channel, struct timeval *tv,
+				uint16_t index, uint16_t opcode,
+				const void *data, uint16_t size)
+{
+	struct decode_entry *entry;
+	uint64_t value = 1;
+
+	if (!decode_queue) {
+		decode_packet(channel, tv, index, opcode, data, size);
+		return;
+	}
+
+	/*
+	 * When the decode can't keep up, further packets are only written
+	 * to disk and the last queued one notes how many were not shown.
+	 */
+	if (queue_length(decode_queue) >= DECODE_BACKLOG) {
+		entry = queue_peek_tail(decode_queue);
+		entry->skipped++;
+		return;
+	}
+
+	entry = malloc(sizeof(*entry) + size);
+	if (!entry)
+		return;
+
+	entry->channel = channel;
+	entry->has_tv = tv != NULL;
+	if (tv)
+		entry->tv = *tv;
+	entry->index = index;
+	entry->opcode = opcode;
+	entry->size = size;
+	entry->skipped = 0;
+	memcpy(entry->data, data, size);
+
+	if (queue_isempty(decode_queue)) {
+		if (write(decode_fd, &value, sizeof(value)) < 0) {
+			free(entry);
+			return;
+		}
+	}
+
+	queue_push_tail(decode_queue, entry);
+}
+
+static void decode_setup(void)
+{
+	decode_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (decode_fd < 0)
+		return;
+
+	if (mainloop_add_fd(decode_fd, EPOLLIN, decode_callback,
+							NULL, NULL) < 0) {
+		close(decode_fd);
+		decode_fd = -1;
+		return;
+	}
+
+	decode_queue = queue_new_ring(DECODE_BACKLOG);
+}
+
+static void decode_cleanup(void)
+{
+	if (decode_fd < 0)
+		return;
+
+	mainloop_remove_fd(decode_fd);
+	close(decode_fd);
+	decode_fd = -1;
+
+	/* Show everything that has been captured before exiting */
+	queue_destroy(decode_queue, decode_entry);
+	decode_queue = NULL;
+}
+
+static void capture_packet(uint16_t channel, struct msghdr *msg,
+							unsigned int len)
+{
+	struct mgmt_hdr *hdr = msg->msg_iov[0].iov_base;
+	unsigned char *buf = msg->msg_iov[1].iov_base;
+	struct cmsghdr *cmsg;
+	struct timeval *tv = NULL;
+	struct timeval ctv;
+	uint16_t opcode, index, pktlen;
+
+	if (len < MGMT_HDR_SIZE)
+		return;
+
+	for (cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL;
+				cmsg = CMSG_NXTHDR(msg, cmsg)) {
+		if (cmsg->cmsg_level != SOL_SOCKET)
+			continue;
+
+		if (cmsg->cmsg_type == SCM_TIMESTAMP) {
+			memcpy(&ctv, CMSG_DATA(cmsg), sizeof(ctv));
+			tv = &ctv;
+		}
+	}
+
+	opcode = le16_to_cpu(hdr->opcode);
+	index  = le16_to_cpu(hdr->index);
+	pktlen = le16_to_cpu(hdr->len);
+
+	if (pktlen > len - MGMT_HDR_SIZE)
+		pktlen = len - MGMT_HDR_SIZE;
+
+	switch (channel) {
+	case HCI_CHANNEL_CONTROL:
+		if (stats_timeout < 0)
+			queue_decode(channel, tv, index, opcode, buf, pktlen);
+		break;
+	case HCI_CHANNEL_MONITOR:
+		if (!filter_packet(index, opcode, buf, pktlen))
+			break;
+
+		btsnoop_write_hci(btsnoop_file, tv, index, opcode,
+							buf, pktlen);
+		ellisys_inject_hci(tv, index, opcode, buf, pktlen);
+
+		/* Statistics replace the decode entirely */
+		if (stats_timeout >= 0)
+			analyze_live_packet(tv, index, opcode, buf, pktlen);
+		else
+			queue_decode(channel, tv, index, opcode, buf, pktlen);
+		break;
+	}
+}
+
 static void data_callback(int fd, uint32_t events, void *user_data)
 {
 	struct control_data *data = user_data;
-	unsigned char control[32];
-	struct mgmt_hdr hdr;
-	struct msghdr msg;
-	struct iovec iov[2];
+	struct recv_batch *batch = data->batch;
+	int i, count;
 
 	if (events & (EPOLLERR | EPOLLHUP)) {
 		mainloop_remove_fd(data->fd);
 		return;
 	}
 
-	iov[0].iov_base = &hdr;
-	iov[0].iov_len = MGMT_HDR_SIZE;
-	iov[1].iov_base = data->buf;
-	iov[1].iov_len = sizeof(data->buf);
+	do {
+		for (i = 0; i < RECV_BATCH; i++) {
+			struct msghdr *msg = &batch->msgs[i].msg_hdr;
 
-	memset(&msg, 0, sizeof(msg));
-	msg.msg_iov = iov;
-	msg.msg_iovlen = 2;
-	msg.msg_control = control;
-	msg.msg_controllen = sizeof(control);
+			msg->msg_controllen = sizeof(batch->control[i]);
+			msg->msg_flags = 0;
+		}
 
-	while (1) {
-		struct cmsghdr *cmsg;
-		struct timeval *tv = NULL;
-		struct timeval ctv;
-		uint16_t opcode, index, pktlen;
-		ssize_t len;
+		count = recvmmsg(data->fd, batch->msgs, RECV_BATCH,
+							MSG_DONTWAIT, NULL);
 
-		len = recvmsg(data->fd, &msg, MSG_DONTWAIT);
-		if (len < 0)
-			break;
+		for (i = 0; i < count; i++)
+			capture_packet(data->channel, &batch->msgs[i].msg_hdr,
+							batch->msgs[i].msg_len);
+	} while (count == RECV_BATCH);
+}
 
-		if (len < MGMT_HDR_SIZE)
-			break;
+static struct recv_batch *new_batch(void)
+{
+	struct recv_batch *batch;
+	int i;
 
-		for (cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL;
-					cmsg = CMSG_NXTHDR(&msg, cmsg)) {
-			if (cmsg->cmsg_level != SOL_SOCKET)
-				continue;
+	batch = malloc(sizeof(*batch));
+	if (!batch)
+		return NULL;
 
-			if (cmsg->cmsg_type == SCM_TIMESTAMP) {
-				memcpy(&ctv, CMSG_DATA(cmsg), sizeof(ctv));
-				tv = &ctv;
-			}
-		}
+	memset(batch, 0, sizeof(*batch));
 
-		opcode = le16_to_cpu(hdr.opcode);
-		index  = le16_to_cpu(hdr.index);
-		pktlen = le16_to_cpu(hdr.len);
+	for (i = 0; i < RECV_BATCH; i++) {
+		struct msghdr *msg = &batch->msgs[i].msg_hdr;
 
-		switch (data->channel) {
-		case HCI_CHANNEL_CONTROL:
-			packet_control(tv, index, opcode, data->buf, pktlen);
-			break;
-		case HCI_CHANNEL_MONITOR:
-			btsnoop_write_hci(btsnoop_file, tv, index, opcode,
-							data->buf, pktlen);
-			ellisys_inject_hci(tv, index, opcode,
-							data->buf, pktlen);
-			packet_monitor(tv, index, opcode, data->buf, pktlen);
-			break;
-		}
+		batch->iov[i][0].iov_base = &batch->hdr[i];
+		batch->iov[i][0].iov_len = MGMT_HDR_SIZE;
+		batch->iov[i][1].iov_base = batch->buf[i];
+		batch->iov[i][1].iov_len = sizeof(batch->buf[i]);
+
+		msg->msg_iov = batch->iov[i];
+		msg->msg_iovlen = 2;
+		msg->msg_control = batch->control[i];
 	}
+
+	return batch;
 }
 
 static int open_socket(uint16_t channel)
@@ -1015,8 +1236,15 @@ static int open_channel(uint16_t channel)
 	memset(data, 0, sizeof(*data));
 	data->channel = channel;
 
+	data->batch = new_batch();
+	if (!data->batch) {
+		free(data);
+		return -1;
+	}
+
 	data->fd = open_socket(channel);
 	if (data->fd < 0) {
+		free(data->batch);
 		free(data);
 		return -1;
 	}
@@ -1050,9 +1278,16 @@ static void client_callback(int fd, uint32_t events, void *user_data)
 		if (data->offset > pktlen + MGMT_HDR_SIZE) {
 			uint16_t opcode = le16_to_cpu(hdr->opcode);
 			uint16_t index = le16_to_cpu(hdr->index);
-
-			packet_monitor(NULL, index, opcode,
-					data->buf + MGMT_HDR_SIZE, pktlen);
+			const void *buf = data->buf + MGMT_HDR_SIZE;
+
+			if (filter_packet(index, opcode, buf, pktlen)) {
+				if (stats_timeout >= 0)
+					analyze_live_packet(NULL, index,
+							opcode, buf, pktlen);
+				else
+					packet_monitor(NULL, index,
+							opcode, buf, pktlen);
+			}
 
 			data->offset -= pktlen + MGMT_HDR_SIZE;
 
@@ -1142,21 +1377,208 @@ void control_server(const char *path)
 	server_fd = fd;
 }
 
-bool control_writer(const char *path)
+static void flush_callback(int id, void *user_data)
+{
+	btsnoop_flush(btsnoop_file);
+
+	mainloop_modify_timeout(id, WRITER_FLUSH_INTERVAL);
+}
+
+bool control_writer(const char *path, uint64_t max_size,
+				unsigned int max_age, unsigned int max_files)
 {
 	btsnoop_file = btsnoop_create(path, BTSNOOP_TYPE_MONITOR);
+	if (!btsnoop_file)
+		return false;
 
-	return !!btsnoop_file;
+	/* The index is only an optimization for later reads */
+	btsnoop_enable_index(btsnoop_file);
+
+	if ((max_size || max_age) && !btsnoop_set_rotate(btsnoop_file,
+					max_size, max_age, max_files)) {
+		btsnoop_unref(btsnoop_file);
+		btsnoop_file = NULL;
+		return false;
+	}
+
+	/* Without a buffer every packet is written out directly */
+	if (btsnoop_set_buffer(btsnoop_file, WRITER_BUFFER_SIZE, false))
+		flush_timeout = mainloop_add_timeout(WRITER_FLUSH_INTERVAL,
+						flush_callback, NULL, NULL);
+
+	return true;
+}
+
+static void stats_callback(int id, void *user_data)
+{
+	analyze_live_print();
+
+	mainloop_modify_timeout(id, stats_interval * 1000);
+}
+
+bool control_stats(unsigned int interval)
+{
+	if (!analyze_live_start())
+		return false;
+
+	stats_interval = interval;
+	stats_timeout = mainloop_add_timeout(interval * 1000, stats_callback,
+								NULL, NULL);
+	if (stats_timeout < 0) {
+		analyze_live_stop();
+		return false;
+	}
+
+	return true;
+}
+
+void control_cleanup(void)
+{
+	struct btsnoop_stats stats;
+
+	decode_cleanup();
+
+	if (stats_timeout >= 0) {
+		mainloop_remove_timeout(stats_timeout);
+		stats_timeout = -1;
+		analyze_live_stop();
+	}
+
+	if (flush_timeout >= 0) {
+		mainloop_remove_timeout(flush_timeout);
+		flush_timeout = -1;
+	}
+
+	if (!btsnoop_file)
+		return;
+
+	btsnoop_get_stats(btsnoop_file, &stats);
+
+	if (stats.dropped)
+		fprintf(stderr, "Dropped %llu of %llu packets while writing\n",
+				(unsigned long long) stats.dropped,
+				(unsigned long long) (stats.packets +
+							stats.dropped));
+
+	btsnoop_unref(btsnoop_file);
+	btsnoop_file = NULL;
+}
+
+/*
+ * Accepts "YYYY-MM-DD HH:MM:SS[.frac]" in local time, "@<sec>[.frac]" since
+ * the epoch or "+<sec>[.frac]" since the first packet of the trace.
+ */
+static bool parse_time(const char *str, struct window_time *time)
+{
+	const char *end;
+	char *ptr;
+	struct tm tm;
+	long usec = 0;
+	int digits = 0;
+
+	time->set = true;
+	time->relative = false;
+
+	if (*str == '+' || *str == '@') {
+		time->relative = (*str == '+');
+
+		if (!isdigit(str[1]))
+			return false;
+
+		time->tv.tv_sec = strtol(str + 1, &ptr, 10);
+		end = ptr;
+	} else {
+		memset(&tm, 0, sizeof(tm));
+
+		end = strptime(str, "%Y-%m-%d %H:%M:%S", &tm);
+		if (!end)
+			end = strptime(str, "%Y-%m-%dT%H:%M:%S", &tm);
+		if (!end)
+			return false;
+
+		tm.tm_isdst = -1;
+		time->tv.tv_sec = mktime(&tm);
+		if (time->tv.tv_sec == -1)
+			return false;
+	}
+
+	if (*end == '.') {
+		for (end++; isdigit(*end); end++) {
+			if (digits < 6) {
+				usec = usec * 10 + (*end - '0');
+				digits++;
+			}
+		}
+
+		if (!digits)
+			return false;
+
+		for (; digits < 6; digits++)
+			usec *= 10;
+	}
+
+	time->tv.tv_usec = usec;
+
+	return *end == '\0';
+}
+
+bool control_set_window(const char *from, const char *to, uint16_t index)
+{
+	if (from && !parse_time(from, &window_from))
+		return false;
+
+	if (to && !parse_time(to, &window_to))
+		return false;
+
+	window_index = index;
+
+	return true;
+}
+
+static void resolve_time(struct window_time *time, const struct timeval *start)
+{
+	if (!time->relative)
+		return;
+
+	timeradd(&time->tv, start, &time->tv);
+	time->relative = false;
+}
+
+static void apply_window(void)
+{
+	struct timeval start;
+	uint16_t index, opcode, pktlen;
+	const void *data;
+
+	if (!window_from.set && !window_to.set && window_index == HCI_DEV_NONE)
+		return;
+
+	/* Relative times count from the first packet of the trace */
+	if (window_from.relative || window_to.relative) {
+		if (!btsnoop_next_hci(btsnoop_file, &start, &index, &opcode,
+							&data, &pktlen))
+			return;
+
+		resolve_time(&window_from, &start);
+		resolve_time(&window_to, &start);
+	}
+
+	btsnoop_set_window(btsnoop_file,
+				window_from.set ? &window_from.tv : NULL,
+				window_to.set ? &window_to.tv : NULL,
+				window_index);
 }
 
 void control_reader(const char *path)
 {
 	unsigned char buf[BTSNOOP_MAX_PACKET_SIZE];
+	const void *data;
 	uint16_t pktlen;
 	uint32_t type;
 	struct timeval tv;
 
-	btsnoop_file = btsnoop_open(path, BTSNOOP_FLAG_PKLG_SUPPORT);
+	btsnoop_file = btsnoop_open(path, BTSNOOP_FLAG_PKLG_SUPPORT |
+							BTSNOOP_FLAG_MMAP);
 	if (!btsnoop_file)
 		return;
 
@@ -1180,18 +1602,23 @@ void control_reader(const char *path)
 	case BTSNOOP_TYPE_HCI:
 	case BTSNOOP_TYPE_UART:
 	case BTSNOOP_TYPE_MONITOR:
+		apply_window();
+
 		while (1) {
 			uint16_t index, opcode;
 
-			if (!btsnoop_read_hci(btsnoop_file, &tv, &index,
-							&opcode, buf, &pktlen))
+			if (!btsnoop_next_hci(btsnoop_file, &tv, &index,
+							&opcode, &data, &pktlen))
 				break;
 
 			if (opcode == 0xffff)
 				continue;
 
-			packet_monitor(&tv, index, opcode, buf, pktlen);
-			ellisys_inject_hci(&tv, index, opcode, buf, pktlen);
+			if (!filter_packet(index, opcode, data, pktlen))
+				continue;
+
+			packet_monitor(&tv, index, opcode, data, pktlen);
+			ellisys_inject_hci(&tv, index, opcode, data, pktlen);
 		}
 		break;
 
@@ -1228,6 +1655,8 @@ int control_tracing(void)
 		return 0;
 	}
 
+	decode_setup();
+
 	open_channel(HCI_CHANNEL_CONTROL);
 
 	return 0;
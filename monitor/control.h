@@ -24,9 +24,13 @@
 
 #include <stdint.h>
 
-bool control_writer(const char *path);
+bool control_writer(const char *path, uint64_t max_size,
+				unsigned int max_age, unsigned int max_files);
 void control_reader(const char *path);
+bool control_set_window(const char *from, const char *to, uint16_t index);
 void control_server(const char *path);
+bool control_stats(unsigned int interval);
 int control_tracing(void);
+void control_cleanup(void);
 
 void control_message(uint16_t opcode, const void *data, uint16_t size);
@@ -0,0 +1,815 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "src/shared/util.h"
+#include "src/shared/btsnoop.h"
+#include "bt.h"
+#include "packet.h"
+#include "l2cap.h"
+#include "export.h"
+
+#define RECORD_SIZE	16384
+#define MAX_DEPTH	8
+
+#define ATT_CID		0x0004
+
+enum {
+	FORMAT_NONE,
+	FORMAT_JSON,
+	FORMAT_BINARY,
+};
+
+static int format = FORMAT_NONE;
+
+static uint8_t record[RECORD_SIZE];
+static size_t record_len;
+static bool record_full;
+static bool first[MAX_DEPTH];
+static int depth;
+
+static void put_raw(const void *data, size_t len)
+{
+	if (record_full || record_len + len > sizeof(record)) {
+		record_full = true;
+		return;
+	}
+
+	memcpy(record + record_len, data, len);
+	record_len += len;
+}
+
+static void put_fmt(const char *fmt, ...)
+{
+	va_list ap;
+	int len;
+
+	if (record_full)
+		return;
+
+	va_start(ap, fmt);
+	len = vsnprintf((char *) record + record_len,
+				sizeof(record) - record_len, fmt, ap);
+	va_end(ap);
+
+	if (len < 0 || record_len + len >= sizeof(record)) {
+		record_full = true;
+		return;
+	}
+
+	record_len += len;
+}
+
+static void put_dec(uint64_t value)
+{
+	char buf[20];
+	int i = sizeof(buf);
+
+	do {
+		buf[--i] = '0' + value % 10;
+		value /= 10;
+	} while (value);
+
+	put_raw(buf + i, sizeof(buf) - i);
+}
+
+static void json_open(char c)
+{
+	put_raw(&c, 1);
+
+	if (depth < MAX_DEPTH - 1)
+		first[++depth] = true;
+}
+
+static void json_close(char c)
+{
+	put_raw(&c, 1);
+
+	if (depth > 0)
+		depth--;
+}
+
+static void json_key(const char *name)
+{
+	if (!first[depth])
+		put_raw(",", 1);
+
+	first[depth] = false;
+
+	put_raw("\"", 1);
+	put_raw(name, strlen(name));
+	put_raw("\":", 2);
+}
+
+static void put_tlv(uint8_t tag, const void *value, uint8_t len)
+{
+	put_raw(&tag, 1);
+	put_raw(&len, 1);
+	put_raw(value, len);
+}
+
+static void put_uint(uint8_t tag, const char *name, uint64_t value,
+							uint8_t octets)
+{
+	uint8_t buf[8];
+	int i;
+
+	if (format == FORMAT_JSON) {
+		json_key(name);
+		put_dec(value);
+		return;
+	}
+
+	/* Without a tag the value is only part of JSON */
+	if (!tag)
+		return;
+
+	for (i = 0; i < octets; i++)
+		buf[i] = value >> (i * 8);
+
+	put_tlv(tag, buf, octets);
+}
+
+static void put_int(uint8_t tag, const char *name, int8_t value)
+{
+	if (format == FORMAT_JSON) {
+		json_key(name);
+		put_fmt("%d", value);
+		return;
+	}
+
+	put_tlv(tag, &value, 1);
+}
+
+/* Length of the valid UTF-8 sequence starting a multi-byte character */
+static size_t utf8_len(const unsigned char *str, size_t len)
+{
+	uint32_t code;
+	size_t i, n;
+
+	if (str[0] < 0xc2 || str[0] > 0xf4)
+		return 0;
+
+	n = str[0] >= 0xf0 ? 4 : str[0] >= 0xe0 ? 3 : 2;
+	if (len < n)
+		return 0;
+
+	code = str[0] & (0x7f >> n);
+
+	for (i = 1; i < n; i++) {
+		if ((str[i] & 0xc0) != 0x80)
+			return 0;
+
+		code = (code << 6) | (str[i] & 0x3f);
+	}
+
+	/* Overlong forms, surrogates and code points beyond Unicode */
+	if ((n == 3 && code < 0x800) || (n == 4 && code < 0x10000) ||
+			(code >= 0xd800 && code <= 0xdfff) || code > 0x10ffff)
+		return 0;
+
+	return n;
+}
+
+/*
+ * Strings are only part of JSON, binary readers have the numbers. Valid
+ * UTF-8 is copied as is, control characters and invalid bytes are escaped
+ * as the code point of the byte.
+ */
+static void put_str(const char *name, const char *str, size_t len)
+{
+	const unsigned char *ptr = (const unsigned char *) str;
+	size_t i = 0;
+
+	if (!str || format != FORMAT_JSON)
+		return;
+
+	json_key(name);
+	put_raw("\"", 1);
+
+	while (i < len && ptr[i]) {
+		unsigned char c = ptr[i];
+		size_t n = c < 0x80 ? 0 : utf8_len(ptr + i, len - i);
+
+		if (n) {
+			put_raw(ptr + i, n);
+			i += n;
+			continue;
+		}
+
+		if (c == '"' || c == '\\')
+			put_fmt("\\%c", c);
+		else if (c < 0x20 || c > 0x7e)
+			put_fmt("\\u%04x", c);
+		else
+			put_raw(&c, 1);
+
+		i++;
+	}
+
+	put_raw("\"", 1);
+}
+
+static void put_name(const char *name, const char *str)
+{
+	if (str)
+		put_str(name, str, strlen(str));
+}
+
+static void put_dir(bool in)
+{
+	if (format == FORMAT_JSON) {
+		json_key("dir");
+		put_fmt("\"%s\"", in ? "rx" : "tx");
+		return;
+	}
+
+	put_uint(EXPORT_TAG_DIR, NULL, in, 1);
+}
+
+static void put_addr(const uint8_t *addr, uint8_t type)
+{
+	uint8_t buf[7];
+
+	if (format == FORMAT_JSON) {
+		json_key("addr");
+		put_fmt("\"%2.2X:%2.2X:%2.2X:%2.2X:%2.2X:%2.2X\"",
+					addr[5], addr[4], addr[3],
+					addr[2], addr[1], addr[0]);
+		put_uint(0, "addr_type", type, 1);
+		return;
+	}
+
+	memcpy(buf, addr, 6);
+	buf[6] = type;
+	put_tlv(EXPORT_TAG_ADDR, buf, sizeof(buf));
+}
+
+static void begin_list(const char *name)
+{
+	if (format == FORMAT_JSON) {
+		json_key(name);
+		json_open('[');
+	}
+}
+
+static void end_list(void)
+{
+	if (format == FORMAT_JSON)
+		json_close(']');
+}
+
+static void begin_item(void)
+{
+	if (format == FORMAT_JSON) {
+		if (!first[depth])
+			put_raw(",", 1);
+		first[depth] = false;
+		json_open('{');
+	}
+}
+
+static void end_item(void)
+{
+	if (format == FORMAT_JSON)
+		json_close('}');
+}
+
+static void record_begin(struct timeval *tv)
+{
+	record_len = 0;
+	record_full = false;
+	depth = 0;
+
+	if (format == FORMAT_BINARY)
+		record_len = 2;
+	else
+		json_open('{');
+
+	if (!tv)
+		return;
+
+	if (format == FORMAT_JSON) {
+		json_key("ts");
+		put_fmt("%lld.%06ld", (long long) tv->tv_sec,
+						(long) tv->tv_usec);
+		return;
+	}
+
+	put_uint(EXPORT_TAG_TIME, NULL, tv->tv_sec * 1000000ull +
+							tv->tv_usec, 8);
+}
+
+static void record_end(void)
+{
+	if (format == FORMAT_JSON) {
+		json_close('}');
+		put_raw("\n", 1);
+	} else {
+		record[0] = (record_len - 2) & 0xff;
+		record[1] = (record_len - 2) >> 8;
+	}
+
+	/* Records never come close to the limit unless malformed */
+	if (record_full)
+		return;
+
+	fwrite(record, record_len, 1, stdout);
+}
+
+static void put_type(uint16_t opcode)
+{
+	const char *str;
+
+	if (format == FORMAT_BINARY) {
+		put_uint(EXPORT_TAG_TYPE, NULL, opcode, 2);
+		return;
+	}
+
+	switch (opcode) {
+	case BTSNOOP_OPCODE_NEW_INDEX:
+		str = "new_index";
+		break;
+	case BTSNOOP_OPCODE_DEL_INDEX:
+		str = "del_index";
+		break;
+	case BTSNOOP_OPCODE_COMMAND_PKT:
+		str = "cmd";
+		break;
+	case BTSNOOP_OPCODE_EVENT_PKT:
+		str = "evt";
+		break;
+	case BTSNOOP_OPCODE_ACL_TX_PKT:
+	case BTSNOOP_OPCODE_ACL_RX_PKT:
+		str = "acl";
+		break;
+	case BTSNOOP_OPCODE_SCO_TX_PKT:
+	case BTSNOOP_OPCODE_SCO_RX_PKT:
+		str = "sco";
+		break;
+	default:
+		put_name("type", "other");
+		put_uint(0, "code", opcode, 2);
+		return;
+	}
+
+	put_name("type", str);
+}
+
+static void put_ad(const uint8_t *data, uint8_t len)
+{
+	uint8_t pos = 0;
+
+	begin_list("ad");
+
+	while (pos + 1 < len) {
+		uint8_t field_len = data[pos];
+		unsigned int i;
+
+		if (!field_len || pos + 1 + field_len > len)
+			break;
+
+		if (format == FORMAT_BINARY) {
+			put_tlv(EXPORT_TAG_AD, data + pos + 1, field_len);
+		} else {
+			begin_item();
+			put_uint(0, "type", data[pos + 1], 1);
+			json_key("data");
+			put_raw("\"", 1);
+			for (i = 2; i <= field_len; i++) {
+				static const char hex[] = "0123456789abcdef";
+				char str[2] = { hex[data[pos + i] >> 4],
+						hex[data[pos + i] & 0x0f] };
+
+				put_raw(str, 2);
+			}
+			put_raw("\"", 1);
+			end_item();
+		}
+
+		pos += field_len + 1;
+	}
+
+	end_list();
+}
+
+static void new_index(const void *data, uint16_t size)
+{
+	const struct btsnoop_opcode_new_index *ni = data;
+
+	if (size < sizeof(*ni))
+		return;
+
+	put_uint(0, "controller_type", ni->type, 1);
+	put_uint(0, "bus", ni->bus, 1);
+	put_addr(ni->bdaddr, 0x00);
+	put_str("name", ni->name, sizeof(ni->name));
+}
+
+static void command_pkt(const void *data, uint16_t size)
+{
+	const struct bt_hci_cmd_hdr *hdr = data;
+	uint16_t opcode;
+
+	put_dir(false);
+
+	if (size < sizeof(*hdr))
+		return;
+
+	opcode = le16_to_cpu(hdr->opcode);
+
+	put_uint(EXPORT_TAG_OPCODE, "opcode", opcode, 2);
+	put_name("name", packet_opcode_str(opcode));
+	put_uint(EXPORT_TAG_LENGTH, "length", hdr->plen, 1);
+}
+
+static void put_command(uint16_t opcode)
+{
+	put_uint(EXPORT_TAG_OPCODE, "opcode", opcode, 2);
+	put_name("command", packet_opcode_str(opcode));
+}
+
+static void adv_report(const void *data, uint8_t size)
+{
+	const struct bt_hci_evt_le_adv_report *evt = data;
+	uint8_t num_reports;
+
+	if (size < sizeof(*evt))
+		return;
+
+	num_reports = evt->num_reports;
+
+	begin_list("reports");
+
+	/* Reports follow each other, each one ending with its RSSI */
+	while (num_reports--) {
+		if (size < sizeof(*evt) ||
+				size < sizeof(*evt) + evt->data_len + 1)
+			break;
+
+		begin_item();
+		put_addr(evt->addr, evt->addr_type);
+		put_uint(EXPORT_TAG_ADV_TYPE, "adv_type", evt->event_type, 1);
+		put_int(EXPORT_TAG_RSSI, "rssi", evt->data[evt->data_len]);
+		put_ad(evt->data, evt->data_len);
+		end_item();
+
+		data += sizeof(*evt) + evt->data_len;
+		size -= sizeof(*evt) + evt->data_len;
+		evt = data;
+	}
+
+	end_list();
+}
+
+static void direct_adv_report(const void *data, uint8_t size)
+{
+	const struct bt_hci_evt_le_direct_adv_report *evt = data;
+	uint8_t num_reports;
+
+	if (size < sizeof(*evt))
+		return;
+
+	num_reports = evt->num_reports;
+
+	begin_list("reports");
+
+	while (num_reports-- && size >= sizeof(*evt)) {
+		begin_item();
+		put_addr(evt->addr, evt->addr_type);
+		put_uint(EXPORT_TAG_ADV_TYPE, "adv_type", evt->event_type, 1);
+		put_int(EXPORT_TAG_RSSI, "rssi", evt->rssi);
+		end_item();
+
+		data += sizeof(*evt) - 1;
+		size -= sizeof(*evt) - 1;
+		evt = data;
+	}
+
+	end_list();
+}
+
+static void ext_adv_report(const void *data, uint8_t size)
+{
+	const struct bt_hci_evt_le_ext_adv_report *evt = data;
+	const struct bt_hci_le_ext_adv_report *report;
+	uint8_t num_reports;
+
+	if (size < sizeof(*evt))
+		return;
+
+	num_reports = evt->num_reports;
+	data += sizeof(*evt);
+	size -= sizeof(*evt);
+
+	begin_list("reports");
+
+	while (num_reports--) {
+		report = data;
+
+		if (size < sizeof(*report) ||
+				size < sizeof(*report) + report->data_len)
+			break;
+
+		begin_item();
+		put_addr(report->addr, report->addr_type);
+		put_uint(EXPORT_TAG_ADV_TYPE, "adv_type",
+				le16_to_cpu(report->event_type), 2);
+		put_int(EXPORT_TAG_RSSI, "rssi", report->rssi);
+		put_ad(report->data, report->data_len);
+		end_item();
+
+		data += sizeof(*report) + report->data_len;
+		size -= sizeof(*report) + report->data_len;
+	}
+
+	end_list();
+}
+
+static void le_conn_complete(uint8_t status, uint16_t handle,
+				uint8_t addr_type, const uint8_t *addr)
+{
+	put_uint(EXPORT_TAG_STATUS, "status", status, 1);
+	put_uint(EXPORT_TAG_HANDLE, "handle", le16_to_cpu(handle), 2);
+	put_addr(addr, addr_type);
+}
+
+static void le_meta_event(const void *data, uint8_t size)
+{
+	uint8_t subevent;
+
+	if (size < 1)
+		return;
+
+	subevent = *((const uint8_t *) data);
+
+	data++;
+	size--;
+
+	put_uint(EXPORT_TAG_SUBEVENT, "subevent", subevent, 1);
+	put_name("subevent_name", packet_subevent_str(subevent));
+
+	switch (subevent) {
+	case BT_HCI_EVT_LE_CONN_COMPLETE:
+		if (size >= sizeof(struct bt_hci_evt_le_conn_complete)) {
+			const struct bt_hci_evt_le_conn_complete *evt = data;
+
+			le_conn_complete(evt->status, evt->handle,
+					evt->peer_addr_type, evt->peer_addr);
+		}
+		break;
+	case BT_HCI_EVT_LE_ENHANCED_CONN_COMPLETE:
+		if (size >= sizeof(struct
+				bt_hci_evt_le_enhanced_conn_complete)) {
+			const struct bt_hci_evt_le_enhanced_conn_complete *evt;
+
+			evt = data;
+			le_conn_complete(evt->status, evt->handle,
+					evt->peer_addr_type, evt->peer_addr);
+		}
+		break;
+	case BT_HCI_EVT_LE_ADV_REPORT:
+		adv_report(data, size);
+		break;
+	case BT_HCI_EVT_LE_DIRECT_ADV_REPORT:
+		direct_adv_report(data, size);
+		break;
+	case BT_HCI_EVT_LE_EXT_ADV_REPORT:
+		ext_adv_report(data, size);
+		break;
+	}
+}
+
+static void event_pkt(const void *data, uint16_t size)
+{
+	const struct bt_hci_evt_hdr *hdr = data;
+
+	put_dir(true);
+
+	if (size < sizeof(*hdr))
+		return;
+
+	data += sizeof(*hdr);
+	size -= sizeof(*hdr);
+
+	if (hdr->plen < size)
+		size = hdr->plen;
+
+	put_uint(EXPORT_TAG_EVENT, "event", hdr->evt, 1);
+	put_name("name", packet_event_str(hdr->evt));
+
+	switch (hdr->evt) {
+	case BT_HCI_EVT_CMD_COMPLETE:
+		if (size >= sizeof(struct bt_hci_evt_cmd_complete)) {
+			const struct bt_hci_evt_cmd_complete *evt = data;
+
+			put_command(le16_to_cpu(evt->opcode));
+
+			/* Nearly all return parameters start with it */
+			if (size > sizeof(*evt))
+				put_uint(EXPORT_TAG_STATUS, "status",
+					*((const uint8_t *) (evt + 1)), 1);
+		}
+		break;
+	case BT_HCI_EVT_CMD_STATUS:
+		if (size >= sizeof(struct bt_hci_evt_cmd_status)) {
+			const struct bt_hci_evt_cmd_status *evt = data;
+
+			put_command(le16_to_cpu(evt->opcode));
+			put_uint(EXPORT_TAG_STATUS, "status", evt->status, 1);
+		}
+		break;
+	case BT_HCI_EVT_CONN_COMPLETE:
+		if (size >= sizeof(struct bt_hci_evt_conn_complete)) {
+			const struct bt_hci_evt_conn_complete *evt = data;
+
+			put_uint(EXPORT_TAG_STATUS, "status", evt->status, 1);
+			put_uint(EXPORT_TAG_HANDLE, "handle",
+					le16_to_cpu(evt->handle), 2);
+			put_addr(evt->bdaddr, 0x00);
+		}
+		break;
+	case BT_HCI_EVT_DISCONNECT_COMPLETE:
+		if (size >= sizeof(struct bt_hci_evt_disconnect_complete)) {
+			const struct bt_hci_evt_disconnect_complete *evt = data;
+
+			put_uint(EXPORT_TAG_STATUS, "status", evt->status, 1);
+			put_uint(EXPORT_TAG_HANDLE, "handle",
+					le16_to_cpu(evt->handle), 2);
+		}
+		break;
+	case BT_HCI_EVT_LE_META_EVENT:
+		le_meta_event(data, size);
+		break;
+	}
+}
+
+static bool att_has_handle(uint8_t opcode)
+{
+	switch (opcode) {
+	case 0x0a:	/* Read Request */
+	case 0x0c:	/* Read Blob Request */
+	case 0x12:	/* Write Request */
+	case 0x16:	/* Prepare Write Request */
+	case 0x17:	/* Prepare Write Response */
+	case 0x1b:	/* Handle Value Notification */
+	case 0x1d:	/* Handle Value Indication */
+	case 0x52:	/* Write Command */
+	case 0xd2:	/* Signed Write Command */
+		return true;
+	}
+
+	return false;
+}
+
+static void acl_pkt(bool in, const void *data, uint16_t size)
+{
+	const struct bt_hci_acl_hdr *hdr = data;
+	const struct bt_l2cap_hdr *l2cap;
+	const uint8_t *pdu;
+	uint16_t handle, cid;
+	uint8_t flags;
+
+	put_dir(in);
+
+	if (size < sizeof(*hdr))
+		return;
+
+	data += sizeof(*hdr);
+	size -= sizeof(*hdr);
+
+	handle = le16_to_cpu(hdr->handle);
+	flags = handle >> 12;
+
+	put_uint(EXPORT_TAG_HANDLE, "handle", handle & 0x0fff, 2);
+	put_uint(EXPORT_TAG_LENGTH, "length", le16_to_cpu(hdr->dlen), 2);
+
+	/* Only start fragments carry the L2CAP header */
+	if ((flags & 0x03) == 0x01 || size < sizeof(*l2cap))
+		return;
+
+	l2cap = data;
+	cid = le16_to_cpu(l2cap->cid);
+
+	put_uint(EXPORT_TAG_CID, "cid", cid, 2);
+
+	if (cid != ATT_CID || size < sizeof(*l2cap) + 1)
+		return;
+
+	pdu = data + sizeof(*l2cap);
+
+	put_uint(EXPORT_TAG_ATT_OPCODE, "att_opcode", pdu[0], 1);
+	put_name("att_name", l2cap_att_opcode_str(pdu[0]));
+
+	if (att_has_handle(pdu[0]) && size >= sizeof(*l2cap) + 3)
+		put_uint(EXPORT_TAG_ATT_HANDLE, "att_handle",
+						get_le16(pdu + 1), 2);
+}
+
+static void sco_pkt(bool in, const void *data, uint16_t size)
+{
+	const struct bt_hci_sco_hdr *hdr = data;
+
+	put_dir(in);
+
+	if (size < sizeof(*hdr))
+		return;
+
+	put_uint(EXPORT_TAG_HANDLE, "handle",
+				le16_to_cpu(hdr->handle) & 0x0fff, 2);
+	put_uint(EXPORT_TAG_LENGTH, "length", hdr->dlen, 1);
+}
+
+bool export_set_format(const char *str)
+{
+	if (!strcasecmp(str, "json"))
+		format = FORMAT_JSON;
+	else if (!strcasecmp(str, "binary"))
+		format = FORMAT_BINARY;
+	else
+		return false;
+
+	return true;
+}
+
+bool export_enabled(void)
+{
+	return format != FORMAT_NONE;
+}
+
+bool export_packet(struct timeval *tv, uint16_t index, uint16_t opcode,
+					const void *data, uint16_t size)
+{
+	if (format == FORMAT_NONE)
+		return false;
+
+	record_begin(tv);
+	put_uint(EXPORT_TAG_INDEX, "index", index, 2);
+	put_type(opcode);
+
+	switch (opcode) {
+	case BTSNOOP_OPCODE_NEW_INDEX:
+		new_index(data, size);
+		break;
+	case BTSNOOP_OPCODE_COMMAND_PKT:
+		command_pkt(data, size);
+		break;
+	case BTSNOOP_OPCODE_EVENT_PKT:
+		event_pkt(data, size);
+		break;
+	case BTSNOOP_OPCODE_ACL_TX_PKT:
+		acl_pkt(false, data, size);
+		break;
+	case BTSNOOP_OPCODE_ACL_RX_PKT:
+		acl_pkt(true, data, size);
+		break;
+	case BTSNOOP_OPCODE_SCO_TX_PKT:
+		sco_pkt(false, data, size);
+		break;
+	case BTSNOOP_OPCODE_SCO_RX_PKT:
+		sco_pkt(true, data, size);
+		break;
+	}
+
+	record_end();
+
+	return true;
+}
+
+bool export_skipped(unsigned int count)
+{
+	if (format == FORMAT_NONE)
+		return false;
+
+	record_begin(NULL);
+	put_name("type", "skipped");
+	put_uint(EXPORT_TAG_SKIPPED, "count", count, 4);
+	record_end();
+
+	return true;
+}
@@ -0,0 +1,77 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/time.h>
+
+/*
+ * Every packet becomes one record, in JSON a single line object. Records
+ * have "ts", "index" and "type", which is new_index, del_index, cmd, evt,
+ * acl, sco or other with the opcode as "code". The fields that follow:
+ *
+ *   new_index	controller_type, bus, addr, addr_type, name
+ *   cmd	dir, opcode, name, length
+ *   evt	dir, event, name, then for command complete and status
+ *		opcode, command, status, for (LE) connection complete
+ *		status, handle, addr, addr_type, for disconnection complete
+ *		status, handle and for LE meta events subevent,
+ *		subevent_name plus for advertising reports a "reports" list
+ *		with addr, addr_type, adv_type, rssi and a list of "ad"
+ *		with type and hex data
+ *   acl	dir, handle, length, then for start fragments cid and for
+ *		ATT att_opcode, att_name and att_handle when it has one
+ *   sco	dir, handle, length
+ *
+ * Packets the decoder had to drop are reported with type "skipped" and
+ * their "count". Names are JSON only and written as UTF-8, control
+ * characters and bytes that are not valid UTF-8 are escaped as \u00XX.
+ *
+ * Binary records start with the little endian 16 bit length of what
+ * follows. The record is a sequence of fields, each with a one octet tag,
+ * a one octet length and a little endian value. Fields after an address
+ * belong to that advertising report until the next address.
+ */
+#define EXPORT_TAG_TIME		0x01	/* Microseconds since the epoch */
+#define EXPORT_TAG_INDEX	0x02
+#define EXPORT_TAG_TYPE		0x03	/* Monitor opcode of the record */
+#define EXPORT_TAG_DIR		0x04	/* 0x00 to and 0x01 from controller */
+#define EXPORT_TAG_OPCODE	0x05
+#define EXPORT_TAG_EVENT	0x06
+#define EXPORT_TAG_SUBEVENT	0x07
+#define EXPORT_TAG_STATUS	0x08
+#define EXPORT_TAG_HANDLE	0x09
+#define EXPORT_TAG_LENGTH	0x0a
+#define EXPORT_TAG_CID		0x0b
+#define EXPORT_TAG_ATT_OPCODE	0x0c
+#define EXPORT_TAG_ATT_HANDLE	0x0d
+#define EXPORT_TAG_ADDR		0x0e	/* Address followed by its type */
+#define EXPORT_TAG_ADV_TYPE	0x0f
+#define EXPORT_TAG_RSSI		0x10
+#define EXPORT_TAG_AD		0x11	/* AD type followed by its data */
+#define EXPORT_TAG_SKIPPED	0x12
+
+bool export_set_format(const char *format);
+bool export_enabled(void);
+
+bool export_packet(struct timeval *tv, uint16_t index, uint16_t opcode,
+					const void *data, uint16_t size);
+bool export_skipped(unsigned int count);
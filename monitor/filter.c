@@ -0,0 +1,906 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "src/shared/util.h"
+#include "src/shared/queue.h"
+#include "src/shared/btsnoop.h"
+#include "bt.h"
+#include "filter.h"
+
+/*
+ * Filter expressions are compiled into a postfix program over fields
+ * pulled out of the raw packet, so unmatched packets are dropped before
+ * any decoding or writing happens.
+ *
+ *   expr      = term *( "or" term )
+ *   term      = factor *( [ "and" ] factor )
+ *   factor    = "not" factor / "(" expr ")" / primitive
+ *   primitive = "cmd" [ opcode ] / "evt" [ event ] / "acl" / "sco" /
+ *               "tx" / "rx" / "index" num / "opcode" num / "ogf" num /
+ *               "ocf" num / "subevent" num / "handle" num / "cid" num /
+ *               "addr" pattern
+ *
+ * Index and other system records always pass so that the output, and any
+ * capture written from it, still describes the controllers.
+ */
+
+#define MAX_INSNS	64
+#define MAX_ADDRS	8
+
+enum filter_op {
+	OP_TYPE,
+	OP_TX,
+	OP_RX,
+	OP_INDEX,
+	OP_OPCODE,
+	OP_OGF,
+	OP_OCF,
+	OP_EVENT,
+	OP_SUBEVENT,
+	OP_HANDLE,
+	OP_CID,
+	OP_ADDR,
+	OP_AND,
+	OP_OR,
+	OP_NOT,
+};
+
+#define TYPE_CMD	0x01
+#define TYPE_EVT	0x02
+#define TYPE_ACL	0x04
+#define TYPE_SCO	0x08
+
+struct filter_insn {
+	uint8_t op;
+	uint16_t value;
+	uint8_t addr[6];
+	uint8_t mask[6];
+};
+
+struct filter_pkt {
+	uint16_t index;
+	uint8_t type;
+	bool tx;
+	bool has_opcode;
+	uint16_t opcode;
+	bool has_event;
+	uint8_t event;
+	bool has_subevent;
+	uint8_t subevent;
+	bool has_handle;
+	uint16_t handle;
+	bool has_cid;
+	uint16_t cid;
+	unsigned int num_addrs;
+	const uint8_t *addrs[MAX_ADDRS];
+};
+
+/* Connections are tracked so that data packets match by address and
+ * continuation fragments match by the CID of their start fragment.
+ */
+struct filter_conn {
+	uint16_t index;
+	uint16_t handle;
+	bool addr_valid;
+	uint8_t addr[6];
+	uint16_t cid[2];
+};
+
+struct parser {
+	const char *pos;
+	char token[32];
+	const char *token_pos;
+	const char *expr;
+	unsigned int depth;	/* Results the program leaves so far */
+};
+
+static struct filter_insn program[MAX_INSNS];
+static unsigned int program_len;
+static bool track_conns;
+static struct queue *conn_map;
+
+static const struct {
+	const char *str;
+	uint8_t event;
+} event_names[] = {
+	{ "inquiry_complete",	BT_HCI_EVT_INQUIRY_COMPLETE	},
+	{ "conn_complete",	BT_HCI_EVT_CONN_COMPLETE	},
+	{ "conn_request",	BT_HCI_EVT_CONN_REQUEST		},
+	{ "disconn_complete",	BT_HCI_EVT_DISCONNECT_COMPLETE	},
+	{ "auth_complete",	BT_HCI_EVT_AUTH_COMPLETE	},
+	{ "encrypt_change",	BT_HCI_EVT_ENCRYPT_CHANGE	},
+	{ "cmd_complete",	BT_HCI_EVT_CMD_COMPLETE		},
+	{ "cmd_status",		BT_HCI_EVT_CMD_STATUS		},
+	{ "num_completed",	BT_HCI_EVT_NUM_COMPLETED_PACKETS },
+	{ "le_meta",		BT_HCI_EVT_LE_META_EVENT	},
+	{ "vendor",		0xff				},
+	{ }
+};
+
+static uint8_t get_u8(const void *ptr)
+{
+	return *((const uint8_t *) ptr);
+}
+
+static unsigned int conn_key(const void *data)
+{
+	const struct filter_conn *conn = data;
+
+	return (conn->index << 16) | conn->handle;
+}
+
+static void next_token(struct parser *p)
+{
+	size_t len = 0;
+
+	while (isspace(*p->pos))
+		p->pos++;
+
+	p->token_pos = p->pos;
+
+	if (*p->pos == '(' || *p->pos == ')') {
+		p->token[len++] = *p->pos++;
+	} else {
+		while (*p->pos && !isspace(*p->pos) && *p->pos != '(' &&
+							*p->pos != ')') {
+			if (len < sizeof(p->token) - 1)
+				p->token[len++] = *p->pos;
+			p->pos++;
+		}
+	}
+
+	p->token[len] = '\0';
+}
+
+static bool parse_error(struct parser *p, const char *msg)
+{
+	fprintf(stderr, "Filter: %s at offset %d: %s\n", msg,
+				(int) (p->token_pos - p->expr), p->expr);
+	return false;
+}
+
+static bool emit(struct parser *p, uint8_t op, uint16_t value)
+{
+	if (program_len >= MAX_INSNS)
+		return parse_error(p, "expression too long");
+
+	switch (op) {
+	case OP_AND:
+	case OP_OR:
+		if (p->depth < 2)
+			return parse_error(p, "missing operand");
+		p->depth--;
+		break;
+	case OP_NOT:
+		if (p->depth < 1)
+			return parse_error(p, "missing operand");
+		break;
+	default:
+		p->depth++;
+		break;
+	}
+
+	memset(&program[program_len], 0, sizeof(program[0]));
+	program[program_len].op = op;
+	program[program_len].value = value;
+	program_len++;
+
+	return true;
+}
+
+static bool parse_number(const char *str, unsigned long max,
+							uint16_t *value)
+{
+	unsigned long val;
+	char *end;
+
+	if (!isdigit(*str))
+		return false;
+
+	val = strtoul(str, &end, 0);
+	if (*end || val > max)
+		return false;
+
+	*value = val;
+
+	return true;
+}
+
+/* Addresses are written most significant octet first and may wildcard
+ * single octets or, with a trailing "*", all remaining ones.
+ */
+static bool parse_addr(const char *str, struct filter_insn *insn)
+{
+	int i;
+
+	for (i = 5; i >= 0; i--) {
+		char *end;
+
+		if (str[0] == '*' && !str[1]) {
+			insn->mask[i] = 0x00;
+			while (i-- > 0)
+				insn->mask[i] = 0x00;
+			return true;
+		}
+
+		if (str[0] == '*') {
+			insn->mask[i] = 0x00;
+			end = (char *) str + 1;
+		} else {
+			if (!isxdigit(str[0]))
+				return false;
+
+			insn->addr[i] = strtoul(str, &end, 16);
+			insn->mask[i] = 0xff;
+
+			if (end - str > 2)
+				return false;
+		}
+
+		if (!i)
+			return !*end;
+
+		if (*end != ':')
+			return false;
+
+		str = end + 1;
+	}
+
+	return false;
+}
+
+static bool parse_expr(struct parser *p);
+
+static bool parse_operand(struct parser *p, unsigned long max,
+					uint8_t op, const char *what)
+{
+	uint16_t value;
+
+	next_token(p);
+
+	if (!parse_number(p->token, max, &value))
+		return parse_error(p, what);
+
+	next_token(p);
+
+	return emit(p, op, value);
+}
+
+static bool parse_primitive(struct parser *p)
+{
+	uint16_t value;
+	int i;
+
+	if (!strcmp(p->token, "cmd")) {
+		next_token(p);
+
+		if (!parse_number(p->token, 0xffff, &value))
+			return emit(p, OP_TYPE, TYPE_CMD);
+
+		next_token(p);
+
+		return emit(p, OP_TYPE, TYPE_CMD) &&
+					emit(p, OP_OPCODE, value) &&
+					emit(p, OP_AND, 0);
+	}
+
+	if (!strcmp(p->token, "evt")) {
+		next_token(p);
+
+		for (i = 0; event_names[i].str; i++) {
+			if (!strcmp(p->token, event_names[i].str))
+				break;
+		}
+
+		if (event_names[i].str)
+			value = event_names[i].event;
+		else if (!parse_number(p->token, 0xff, &value))
+			return emit(p, OP_TYPE, TYPE_EVT);
+
+		next_token(p);
+
+		return emit(p, OP_EVENT, value);
+	}
+
+	if (!strcmp(p->token, "acl")) {
+		next_token(p);
+		return emit(p, OP_TYPE, TYPE_ACL);
+	}
+
+	if (!strcmp(p->token, "sco")) {
+		next_token(p);
+		return emit(p, OP_TYPE, TYPE_SCO);
+	}
+
+	if (!strcmp(p->token, "tx")) {
+		next_token(p);
+		return emit(p, OP_TX, 0);
+	}
+
+	if (!strcmp(p->token, "rx")) {
+		next_token(p);
+		return emit(p, OP_RX, 0);
+	}
+
+	if (!strcmp(p->token, "index"))
+		return parse_operand(p, 0xffff, OP_INDEX, "invalid index");
+
+	if (!strcmp(p->token, "opcode"))
+		return parse_operand(p, 0xffff, OP_OPCODE, "invalid opcode");
+
+	if (!strcmp(p->token, "ogf"))
+		return parse_operand(p, 0x3f, OP_OGF, "invalid OGF");
+
+	if (!strcmp(p->token, "ocf"))
+		return parse_operand(p, 0x3ff, OP_OCF, "invalid OCF");
+
+	if (!strcmp(p->token, "subevent"))
+		return parse_operand(p, 0xff, OP_SUBEVENT, "invalid subevent");
+
+	if (!strcmp(p->token, "handle")) {
+		track_conns = true;
+		return parse_operand(p, 0x0fff, OP_HANDLE, "invalid handle");
+	}
+
+	if (!strcmp(p->token, "cid")) {
+		track_conns = true;
+		return parse_operand(p, 0xffff, OP_CID, "invalid CID");
+	}
+
+	if (!strcmp(p->token, "addr")) {
+		track_conns = true;
+
+		if (!emit(p, OP_ADDR, 0))
+			return false;
+
+		next_token(p);
+
+		if (!parse_addr(p->token, &program[program_len - 1]))
+			return parse_error(p, "invalid address");
+
+		next_token(p);
+		return true;
+	}
+
+	if (!*p->token)
+		return parse_error(p, "unexpected end");
+
+	return parse_error(p, "unknown keyword");
+}
+
+static bool parse_factor(struct parser *p)
+{
+	if (!strcmp(p->token, "not")) {
+		next_token(p);
+		return parse_factor(p) && emit(p, OP_NOT, 0);
+	}
+
+	if (!strcmp(p->token, "(")) {
+		next_token(p);
+
+		if (!parse_expr(p))
+			return false;
+
+		if (strcmp(p->token, ")"))
+			return parse_error(p, "missing )");
+
+		next_token(p);
+		return true;
+	}
+
+	return parse_primitive(p);
+}
+
+static bool parse_term(struct parser *p)
+{
+	if (!parse_factor(p))
+		return false;
+
+	while (*p->token && strcmp(p->token, "or") && strcmp(p->token, ")")) {
+		if (!strcmp(p->token, "and"))
+			next_token(p);
+
+		if (!parse_factor(p) || !emit(p, OP_AND, 0))
+			return false;
+	}
+
+	return true;
+}
+
+static bool parse_expr(struct parser *p)
+{
+	if (!parse_term(p))
+		return false;
+
+	while (!strcmp(p->token, "or")) {
+		next_token(p);
+
+		if (!parse_term(p) || !emit(p, OP_OR, 0))
+			return false;
+	}
+
+	return true;
+}
+
+bool filter_compile(const char *expr)
+{
+	struct parser p;
+
+	memset(&p, 0, sizeof(p));
+	p.expr = expr;
+	p.pos = expr;
+
+	program_len = 0;
+	track_conns = false;
+
+	next_token(&p);
+
+	if (!parse_expr(&p))
+		goto failed;
+
+	if (*p.token) {
+		parse_error(&p, "unexpected token");
+		goto failed;
+	}
+
+	if (p.depth != 1) {
+		parse_error(&p, "incomplete expression");
+		goto failed;
+	}
+
+	if (track_conns && !conn_map) {
+		conn_map = queue_new_keyed(conn_key);
+		if (!conn_map)
+			goto failed;
+	}
+
+	return true;
+
+failed:
+	program_len = 0;
+	return false;
+}
+
+void filter_cleanup(void)
+{
+	queue_destroy(conn_map, free);
+	conn_map = NULL;
+	program_len = 0;
+}
+
+static void add_addr(struct filter_pkt *pkt, const void *data, uint16_t size,
+							uint16_t offset)
+{
+	if (pkt->num_addrs < MAX_ADDRS && size >= offset + 6)
+		pkt->addrs[pkt->num_addrs++] = data + offset;
+}
+
+static void set_handle(struct filter_pkt *pkt, const void *data, uint16_t size,
+							uint16_t offset)
+{
+	if (size < offset + 2)
+		return;
+
+	pkt->handle = get_le16(data + offset) & 0x0fff;
+	pkt->has_handle = true;
+}
+
+static struct filter_conn *conn_lookup(uint16_t index, uint16_t handle,
+								bool create)
+{
+	struct filter_conn *conn;
+
+	conn = queue_find_by_key(conn_map, (index << 16) | handle);
+	if (conn || !create)
+		return conn;
+
+	conn = new0(struct filter_conn, 1);
+	if (!conn)
+		return NULL;
+
+	conn->index = index;
+	conn->handle = handle;
+	queue_push_tail(conn_map, conn);
+
+	return conn;
+}
+
+static bool conn_match_index(const void *data, const void *match_data)
+{
+	const struct filter_conn *conn = data;
+
+	return conn->index == PTR_TO_UINT(match_data);
+}
+
+static void conn_connected(struct filter_pkt *pkt, uint8_t status,
+							const uint8_t *addr)
+{
+	struct filter_conn *conn;
+
+	if (!track_conns || status || !pkt->has_handle)
+		return;
+
+	conn = conn_lookup(pkt->index, pkt->handle, true);
+	if (!conn)
+		return;
+
+	memcpy(conn->addr, addr, 6);
+	conn->addr_valid = true;
+	conn->cid[0] = 0;
+	conn->cid[1] = 0;
+}
+
+/* Packets that only carry a handle match by the address connected on it */
+static void add_conn_addr(struct filter_pkt *pkt)
+{
+	struct filter_conn *conn;
+
+	if (!track_conns || !pkt->has_handle)
+		return;
+
+	conn = conn_lookup(pkt->index, pkt->handle, false);
+	if (conn && conn->addr_valid && pkt->num_addrs < MAX_ADDRS)
+		pkt->addrs[pkt->num_addrs++] = conn->addr;
+}
+
+static void parse_cmd(struct filter_pkt *pkt, const void *data, uint16_t size)
+{
+	if (size < sizeof(struct bt_hci_cmd_hdr))
+		return;
+
+	pkt->opcode = get_le16(data);
+	pkt->has_opcode = true;
+
+	data += sizeof(struct bt_hci_cmd_hdr);
+	size -= sizeof(struct bt_hci_cmd_hdr);
+
+	switch (pkt->opcode) {
+	case BT_HCI_CMD_CREATE_CONN:
+	case BT_HCI_CMD_ACCEPT_CONN_REQUEST:
+	case BT_HCI_CMD_REJECT_CONN_REQUEST:
+	case BT_HCI_CMD_REMOTE_NAME_REQUEST:
+		add_addr(pkt, data, size, 0);
+		break;
+	case BT_HCI_CMD_LE_CREATE_CONN:
+		add_addr(pkt, data, size, 6);
+		break;
+	case BT_HCI_CMD_DISCONNECT:
+		set_handle(pkt, data, size, 0);
+		add_conn_addr(pkt);
+		break;
+	}
+}
+
+static void parse_adv_reports(struct filter_pkt *pkt, const void *data,
+							uint16_t size)
+{
+	uint8_t num_reports;
+
+	if (size < 1)
+		return;
+
+	num_reports = get_u8(data);
+	data++;
+	size--;
+
+	switch (pkt->subevent) {
+	case BT_HCI_EVT_LE_ADV_REPORT:
+		/* Event type, address type, address, length, data, RSSI */
+		while (num_reports-- && size >= 10 &&
+				size >= 10 + get_u8(data + 8)) {
+			uint16_t len = 10 + get_u8(data + 8);
+
+			add_addr(pkt, data, size, 2);
+			data += len;
+			size -= len;
+		}
+		break;
+	case BT_HCI_EVT_LE_DIRECT_ADV_REPORT:
+		while (num_reports-- && size >= 16) {
+			add_addr(pkt, data, size, 2);
+			data += 16;
+			size -= 16;
+		}
+		break;
+	case BT_HCI_EVT_LE_EXT_ADV_REPORT:
+		while (num_reports--) {
+			const struct bt_hci_le_ext_adv_report *report = data;
+			uint16_t len;
+
+			if (size < sizeof(*report))
+				break;
+
+			len = sizeof(*report) + report->data_len;
+			if (size < len)
+				break;
+
+			add_addr(pkt, data, size, 3);
+			data += len;
+			size -= len;
+		}
+		break;
+	}
+}
+
+static void parse_le_meta(struct filter_pkt *pkt, const void *data,
+							uint16_t size)
+{
+	uint8_t status;
+
+	if (size < 1)
+		return;
+
+	pkt->subevent = get_u8(data);
+	pkt->has_subevent = true;
+
+	data++;
+	size--;
+
+	switch (pkt->subevent) {
+	case BT_HCI_EVT_LE_CONN_COMPLETE:
+	case BT_HCI_EVT_LE_ENHANCED_CONN_COMPLETE:
+		/* Status, handle, role, peer address type, peer address */
+		set_handle(pkt, data, size, 1);
+		add_addr(pkt, data, size, 5);
+
+		if (pkt->num_addrs) {
+			status = get_u8(data);
+			conn_connected(pkt, status, pkt->addrs[0]);
+		}
+		break;
+	case BT_HCI_EVT_LE_CONN_UPDATE_COMPLETE:
+		set_handle(pkt, data, size, 1);
+		add_conn_addr(pkt);
+		break;
+	case BT_HCI_EVT_LE_ADV_REPORT:
+	case BT_HCI_EVT_LE_DIRECT_ADV_REPORT:
+	case BT_HCI_EVT_LE_EXT_ADV_REPORT:
+		parse_adv_reports(pkt, data, size);
+		break;
+	}
+}
+
+static void parse_evt(struct filter_pkt *pkt, const void *data, uint16_t size)
+{
+	if (size < sizeof(struct bt_hci_evt_hdr))
+		return;
+
+	pkt->event = get_u8(data);
+	pkt->has_event = true;
+
+	data += sizeof(struct bt_hci_evt_hdr);
+	size -= sizeof(struct bt_hci_evt_hdr);
+
+	switch (pkt->event) {
+	case BT_HCI_EVT_CONN_COMPLETE:
+		/* Status, handle, address */
+		set_handle(pkt, data, size, 1);
+		add_addr(pkt, data, size, 3);
+
+		if (pkt->num_addrs)
+			conn_connected(pkt, get_u8(data), pkt->addrs[0]);
+		break;
+	case BT_HCI_EVT_CONN_REQUEST:
+		add_addr(pkt, data, size, 0);
+		break;
+	case BT_HCI_EVT_REMOTE_NAME_REQUEST_COMPLETE:
+		add_addr(pkt, data, size, 1);
+		break;
+	case BT_HCI_EVT_DISCONNECT_COMPLETE:
+	case BT_HCI_EVT_AUTH_COMPLETE:
+	case BT_HCI_EVT_ENCRYPT_CHANGE:
+		set_handle(pkt, data, size, 1);
+		add_conn_addr(pkt);
+		break;
+	case BT_HCI_EVT_CMD_COMPLETE:
+		/* Number of packets, opcode */
+		if (size >= 3) {
+			pkt->opcode = get_le16(data + 1);
+			pkt->has_opcode = true;
+		}
+		break;
+	case BT_HCI_EVT_CMD_STATUS:
+		/* Status, number of packets, opcode */
+		if (size >= 4) {
+			pkt->opcode = get_le16(data + 2);
+			pkt->has_opcode = true;
+		}
+		break;
+	case BT_HCI_EVT_LE_META_EVENT:
+		parse_le_meta(pkt, data, size);
+		break;
+	}
+}
+
+static void parse_acl(struct filter_pkt *pkt, const void *data, uint16_t size)
+{
+	struct filter_conn *conn = NULL;
+	uint16_t handle;
+	uint8_t flags;
+
+	if (size < sizeof(struct bt_hci_acl_hdr))
+		return;
+
+	handle = get_le16(data);
+	flags = handle >> 12;
+
+	pkt->handle = handle & 0x0fff;
+	pkt->has_handle = true;
+
+	if (track_conns)
+		conn = conn_lookup(pkt->index, pkt->handle, true);
+
+	data += sizeof(struct bt_hci_acl_hdr);
+	size -= sizeof(struct bt_hci_acl_hdr);
+
+	/* Only start fragments carry the basic L2CAP header */
+	if ((flags & 0x03) != 0x01 && size >= sizeof(struct bt_l2cap_hdr)) {
+		pkt->cid = get_le16(data + 2);
+		pkt->has_cid = true;
+
+		if (conn)
+			conn->cid[pkt->tx] = pkt->cid;
+	} else if (conn && conn->cid[pkt->tx]) {
+		pkt->cid = conn->cid[pkt->tx];
+		pkt->has_cid = true;
+	}
+
+	if (conn && conn->addr_valid)
+		pkt->addrs[pkt->num_addrs++] = conn->addr;
+}
+
+static void parse_sco(struct filter_pkt *pkt, const void *data, uint16_t size)
+{
+	set_handle(pkt, data, size, 0);
+	add_conn_addr(pkt);
+}
+
+static bool match_addr(const struct filter_insn *insn,
+					const struct filter_pkt *pkt)
+{
+	unsigned int i, n;
+
+	for (i = 0; i < pkt->num_addrs; i++) {
+		for (n = 0; n < 6; n++) {
+			if ((pkt->addrs[i][n] & insn->mask[n]) != insn->addr[n])
+				break;
+		}
+
+		if (n == 6)
+			return true;
+	}
+
+	return false;
+}
+
+static bool match(const struct filter_insn *insn, const struct filter_pkt *pkt)
+{
+	switch (insn->op) {
+	case OP_TYPE:
+		return pkt->type == insn->value;
+	case OP_TX:
+		return pkt->tx;
+	case OP_RX:
+		return !pkt->tx;
+	case OP_INDEX:
+		return pkt->index == insn->value;
+	case OP_OPCODE:
+		return pkt->has_opcode && pkt->opcode == insn->value;
+	case OP_OGF:
+		return pkt->has_opcode && (pkt->opcode >> 10) == insn->value;
+	case OP_OCF:
+		return pkt->has_opcode &&
+				(pkt->opcode & 0x03ff) == insn->value;
+	case OP_EVENT:
+		return pkt->has_event && pkt->event == insn->value;
+	case OP_SUBEVENT:
+		return pkt->has_subevent && pkt->subevent == insn->value;
+	case OP_HANDLE:
+		return pkt->has_handle && pkt->handle == insn->value;
+	case OP_CID:
+		return pkt->has_cid && pkt->cid == insn->value;
+	case OP_ADDR:
+		return match_addr(insn, pkt);
+	}
+
+	return false;
+}
+
+bool filter_packet(uint16_t index, uint16_t opcode, const void *data,
+							uint16_t size)
+{
+	struct filter_pkt pkt;
+	bool stack[MAX_INSNS];
+	unsigned int i, sp = 0;
+
+	if (!program_len)
+		return true;
+
+	memset(&pkt, 0, sizeof(pkt));
+	pkt.index = index;
+
+	switch (opcode) {
+	case BTSNOOP_OPCODE_COMMAND_PKT:
+		pkt.type = TYPE_CMD;
+		pkt.tx = true;
+		parse_cmd(&pkt, data, size);
+		break;
+	case BTSNOOP_OPCODE_EVENT_PKT:
+		pkt.type = TYPE_EVT;
+		parse_evt(&pkt, data, size);
+		break;
+	case BTSNOOP_OPCODE_ACL_TX_PKT:
+	case BTSNOOP_OPCODE_ACL_RX_PKT:
+		pkt.type = TYPE_ACL;
+		pkt.tx = opcode == BTSNOOP_OPCODE_ACL_TX_PKT;
+		parse_acl(&pkt, data, size);
+		break;
+	case BTSNOOP_OPCODE_SCO_TX_PKT:
+	case BTSNOOP_OPCODE_SCO_RX_PKT:
+		pkt.type = TYPE_SCO;
+		pkt.tx = opcode == BTSNOOP_OPCODE_SCO_TX_PKT;
+		parse_sco(&pkt, data, size);
+		break;
+	default:
+		if (opcode == BTSNOOP_OPCODE_DEL_INDEX && conn_map)
+			queue_remove_all(conn_map, conn_match_index,
+						UINT_TO_PTR(index), free);
+		return true;
+	}
+
+	/* The program is checked at compile time to leave one result */
+	for (i = 0; i < program_len; i++) {
+		switch (program[i].op) {
+		case OP_AND:
+			sp--;
+			stack[sp - 1] = stack[sp - 1] && stack[sp];
+			break;
+		case OP_OR:
+			sp--;
+			stack[sp - 1] = stack[sp - 1] || stack[sp];
+			break;
+		case OP_NOT:
+			stack[sp - 1] = !stack[sp - 1];
+			break;
+		default:
+			stack[sp++] = match(&program[i], &pkt);
+			break;
+		}
+	}
+
+	/* Forget connections once their disconnect has been matched */
+	if (track_conns && pkt.type == TYPE_EVT &&
+			pkt.event == BT_HCI_EVT_DISCONNECT_COMPLETE &&
+			pkt.has_handle && size > 3 && !get_u8(data + 2))
+		free(queue_remove_by_key(conn_map,
+					(index << 16) | pkt.handle));
+
+	return stack[0];
+}
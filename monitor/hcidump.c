@@ -40,7 +40,11 @@
 
 #include "src/shared/mainloop.h"
 
+#include "src/shared/btsnoop.h"
+
 #include "packet.h"
+#include "filter.h"
+#include "export.h"
 #include "hcidump.h"
 
 struct hcidump_data {
@@ -106,6 +110,24 @@ static int open_hci_dev(uint16_t index)
 	return fd;
 }
 
+static uint16_t get_opcode(uint8_t type, int dir)
+{
+	switch (type) {
+	case HCI_COMMAND_PKT:
+		return BTSNOOP_OPCODE_COMMAND_PKT;
+	case HCI_EVENT_PKT:
+		return BTSNOOP_OPCODE_EVENT_PKT;
+	case HCI_ACLDATA_PKT:
+		return dir ? BTSNOOP_OPCODE_ACL_RX_PKT :
+						BTSNOOP_OPCODE_ACL_TX_PKT;
+	case HCI_SCODATA_PKT:
+		return dir ? BTSNOOP_OPCODE_SCO_RX_PKT :
+						BTSNOOP_OPCODE_SCO_TX_PKT;
+	}
+
+	return 0xffff;
+}
+
 static void device_callback(int fd, uint32_t events, void *user_data)
 {
 	struct hcidump_data *data = user_data;
@@ -132,6 +154,7 @@ static void device_callback(int fd, uint32_t events, void *user_data)
 		struct cmsghdr *cmsg;
 		struct timeval *tv = NULL;
 		struct timeval ctv;
+		uint16_t opcode;
 		int dir = -1;
 		ssize_t len;
 
@@ -158,6 +181,14 @@ static void device_callback(int fd, uint32_t events, void *user_data)
 		if (dir < 0 || len < 1)
 			continue;
 
+		opcode = get_opcode(buf[0], dir);
+
+		if (!filter_packet(data->index, opcode, buf + 1, len - 1))
+			continue;
+
+		if (export_packet(tv, data->index, opcode, buf + 1, len - 1))
+			continue;
+
 		switch (buf[0]) {
 		case HCI_COMMAND_PKT:
 			packet_hci_command(tv, data->index, buf + 1, len - 1);
@@ -197,6 +228,39 @@ static void open_device(uint16_t index)
 	mainloop_add_fd(data->fd, EPOLLIN, device_callback, data, free_data);
 }
 
+static void new_index(struct timeval *tv, uint16_t index, uint8_t type,
+			uint8_t bus, const bdaddr_t *bdaddr, const char *name)
+{
+	struct btsnoop_opcode_new_index ni;
+	char str[18];
+
+	/* Exports get the same record as from the monitor channel */
+	memset(&ni, 0, sizeof(ni));
+	ni.type = type;
+	ni.bus = bus;
+	memcpy(ni.bdaddr, bdaddr, sizeof(ni.bdaddr));
+	memcpy(ni.name, name, sizeof(ni.name));
+
+	if (export_packet(tv, index, BTSNOOP_OPCODE_NEW_INDEX,
+							&ni, sizeof(ni)))
+		return;
+
+	ba2str(bdaddr, str);
+	packet_new_index(tv, index, str, type, bus, name);
+}
+
+static void del_index(struct timeval *tv, uint16_t index,
+						const bdaddr_t *bdaddr)
+{
+	char str[18];
+
+	if (export_packet(tv, index, BTSNOOP_OPCODE_DEL_INDEX, NULL, 0))
+		return;
+
+	ba2str(bdaddr, str);
+	packet_del_index(tv, index, str);
+}
+
 static void device_info(int fd, uint16_t index, uint8_t *type, uint8_t *bus,
 						bdaddr_t *bdaddr, char *name)
 {
@@ -242,7 +306,7 @@ static void device_list(int fd, int max_dev)
 	for (i = 0; i < dl->dev_num; i++, dr++) {
 		struct timeval tmp_tv, *tv = NULL;
 		uint8_t type = 0xff, bus = 0xff;
-		char str[18], name[8] = "";
+		char name[8] = "";
 		bdaddr_t bdaddr;
 
 		bacpy(&bdaddr, BDADDR_ANY);
@@ -251,8 +315,7 @@ static void device_list(int fd, int max_dev)
 			tv = &tmp_tv;
 
 		device_info(fd, dr->dev_id, &type, &bus, &bdaddr, name);
-		ba2str(&bdaddr, str);
-		packet_new_index(tv, dr->dev_id, str, type, bus, name);
+		new_index(tv, dr->dev_id, type, bus, &bdaddr, name);
 		open_device(dr->dev_id);
 	}
 
@@ -319,7 +382,7 @@ static void stack_internal_callback(int fd, uint32_t events, void *user_data)
 	struct timeval *tv = NULL;
 	struct timeval ctv;
 	uint8_t type = 0xff, bus = 0xff;
-	char str[18], name[8] = "";
+	char name[8] = "";
 	bdaddr_t bdaddr;
 
 	bacpy(&bdaddr, BDADDR_ANY);
@@ -375,13 +438,11 @@ static void stack_internal_callback(int fd, uint32_t events, void *user_data)
 	switch (sd->event) {
 	case HCI_DEV_REG:
 		device_info(fd, sd->dev_id, &type, &bus, &bdaddr, name);
-		ba2str(&bdaddr, str);
-		packet_new_index(tv, sd->dev_id, str, type, bus, name);
+		new_index(tv, sd->dev_id, type, bus, &bdaddr, name);
 		open_device(sd->dev_id);
 		break;
 	case HCI_DEV_UNREG:
-		ba2str(&bdaddr, str);
-		packet_del_index(tv, sd->dev_id, str);
+		del_index(tv, sd->dev_id, &bdaddr);
 		break;
 	}
 }
@@ -2048,6 +2048,12 @@ static void att_error_response(const struct l2cap_frame *frame)
 	case 0x11:
 		str = "Insufficient Resources";
 		break;
+	case 0x12:
+		str = "Database Out of Sync";
+		break;
+	case 0x13:
+		str = "Value Not Allowed";
+		break;
 	case 0xfd:
 		str = "CCC Improperly Configured";
 		break;
@@ -2405,6 +2411,11 @@ static const char *att_opcode_to_str(uint8_t opcode)
 	return "Unknown";
 }
 
+const char *l2cap_att_opcode_str(uint8_t opcode)
+{
+	return att_opcode_to_str(opcode);
+}
+
 static void att_packet(uint16_t index, bool in, uint16_t handle,
 			uint16_t cid, const void *data, uint16_t size)
 {
@@ -39,6 +39,8 @@
 #include "keys.h"
 #include "analyze.h"
 #include "ellisys.h"
+#include "filter.h"
+#include "export.h"
 #include "control.h"
 
 static void signal_callback(int signum, void *user_data)
@@ -59,22 +61,49 @@ static void usage(void)
 	printf("options:\n"
 		"\t-r, --read <file>      Read traces in btsnoop format\n"
 		"\t-w, --write <file>     Save traces in btsnoop format\n"
+		"\t    --rotate-size <MB> Start a new file at this size\n"
+		"\t    --rotate-time <s>  Start a new file after this time\n"
+		"\t    --rotate-keep <n>  Number of previous files to keep\n"
 		"\t-a, --analyze <file>   Analyze traces in btsnoop format\n"
+		"\t    --jobs <num>       Number of threads for analyzing\n"
 		"\t-s, --server <socket>  Start monitor server socket\n"
 		"\t-i, --index <num>      Show only specified controller\n"
+		"\t-f, --filter <expr>    Show and save only matching packets\n"
+		"\t    --stats[=sec]      Show live statistics instead of packets\n"
+		"\t    --export <format>  Write packets as json or binary\n"
+		"\t    --from <time>      Read traces starting at time\n"
+		"\t    --to <time>        Read traces up to time\n"
 		"\t-t, --time             Show time instead of time offset\n"
 		"\t-T, --date             Show time and date information\n"
 		"\t-S, --sco              Dump SCO traffic\n"
 		"\t-E, --ellisys [ip]     Send Ellisys HCI Injection\n"
-		"\t-h, --help             Show help options\n");
+		"\t-h, --help             Show help options\n"
+		"times:\n"
+		"\tYYYY-MM-DD HH:MM:SS[.frac]  Local date and time\n"
+		"\t@<sec>[.frac]               Seconds since the epoch\n"
+		"\t+<sec>[.frac]               Seconds since the first packet\n"
+		"filters:\n"
+		"\tcmd [opcode], evt [code|name], acl, sco, tx, rx,\n"
+		"\tindex <num>, opcode <num>, ogf <num>, ocf <num>,\n"
+		"\tsubevent <num>, handle <num>, cid <num>,\n"
+		"\taddr <xx:xx:xx:*>, combined with and, or, not, ( )\n");
 }
 
 static const struct option main_options[] = {
 	{ "read",    required_argument, NULL, 'r' },
 	{ "write",   required_argument, NULL, 'w' },
+	{ "rotate-size", required_argument, NULL, 'Z' },
+	{ "rotate-time", required_argument, NULL, 'Y' },
+	{ "rotate-keep", required_argument, NULL, 'K' },
 	{ "analyze", required_argument, NULL, 'a' },
+	{ "jobs",    required_argument, NULL, 'J' },
 	{ "server",  required_argument, NULL, 's' },
 	{ "index",   required_argument, NULL, 'i' },
+	{ "filter",  required_argument, NULL, 'f' },
+	{ "stats",   optional_argument, NULL, 'L' },
+	{ "export",  required_argument, NULL, 'X' },
+	{ "from",    required_argument, NULL, 'F' },
+	{ "to",      required_argument, NULL, 'U' },
 	{ "time",    no_argument,       NULL, 't' },
 	{ "date",    no_argument,       NULL, 'T' },
 	{ "sco",     no_argument,	NULL, 'S' },
@@ -90,7 +119,16 @@ int main(int argc, char *argv[])
 	unsigned long filter_mask = 0;
 	const char *reader_path = NULL;
 	const char *writer_path = NULL;
+	unsigned long rotate_size = 0;
+	unsigned long rotate_time = 0;
+	unsigned long rotate_keep = 10;
 	const char *analyze_path = NULL;
+	unsigned int analyze_jobs = 0;
+	const char *window_from = NULL;
+	const char *window_to = NULL;
+	const char *filter_expr = NULL;
+	unsigned int stats_interval = 0;
+	uint16_t index = 0xffff;
 	const char *ellisys_server = NULL;
 	unsigned short ellisys_port = 0;
 	const char *str;
@@ -104,7 +142,7 @@ int main(int argc, char *argv[])
 	for (;;) {
 		int opt;
 
-		opt = getopt_long(argc, argv, "r:w:a:s:i:tTSE:vh",
+		opt = getopt_long(argc, argv, "r:w:a:s:i:f:tTSE:vh",
 						main_options, NULL);
 		if (opt < 0)
 			break;
@@ -116,9 +154,30 @@ int main(int argc, char *argv[])
 		case 'w':
 			writer_path = optarg;
 			break;
+		case 'Z':
+		case 'Y':
+		case 'K':
+			if (!isdigit(*optarg)) {
+				usage();
+				return EXIT_FAILURE;
+			}
+			if (opt == 'Z')
+				rotate_size = strtoul(optarg, NULL, 10);
+			else if (opt == 'Y')
+				rotate_time = strtoul(optarg, NULL, 10);
+			else
+				rotate_keep = strtoul(optarg, NULL, 10);
+			break;
 		case 'a':
 			analyze_path = optarg;
 			break;
+		case 'J':
+			if (!isdigit(*optarg)) {
+				usage();
+				return EXIT_FAILURE;
+			}
+			analyze_jobs = atoi(optarg);
+			break;
 		case 's':
 			control_server(optarg);
 			break;
@@ -131,7 +190,34 @@ int main(int argc, char *argv[])
 				usage();
 				return EXIT_FAILURE;
 			}
-			packet_select_index(atoi(str));
+			index = atoi(str);
+			packet_select_index(index);
+			break;
+		case 'f':
+			filter_expr = optarg;
+			break;
+		case 'L':
+			if (!optarg) {
+				stats_interval = 1;
+				break;
+			}
+			if (!isdigit(*optarg) || !atoi(optarg)) {
+				usage();
+				return EXIT_FAILURE;
+			}
+			stats_interval = atoi(optarg);
+			break;
+		case 'X':
+			if (!export_set_format(optarg)) {
+				usage();
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'F':
+			window_from = optarg;
+			break;
+		case 'U':
+			window_to = optarg;
 			break;
 		case 't':
 			filter_mask &= ~PACKET_FILTER_SHOW_TIME_OFFSET;
@@ -174,20 +260,58 @@ int main(int argc, char *argv[])
 		return EXIT_FAILURE;
 	}
 
+	if ((rotate_size || rotate_time) && !writer_path) {
+		fprintf(stderr, "Rotation requires saving traces\n");
+		return EXIT_FAILURE;
+	}
+
+	if (filter_expr && analyze_path) {
+		fprintf(stderr, "Filter and analyze can't be combined\n");
+		return EXIT_FAILURE;
+	}
+
+	if (stats_interval && (reader_path || analyze_path)) {
+		fprintf(stderr, "Statistics require live tracing\n");
+		return EXIT_FAILURE;
+	}
+
+	if (export_enabled() && (analyze_path || stats_interval)) {
+		fprintf(stderr, "Export can't be combined with analyze "
+							"or statistics\n");
+		return EXIT_FAILURE;
+	}
+
+	if ((window_from || window_to) && !reader_path) {
+		fprintf(stderr, "Time window requires reading traces\n");
+		return EXIT_FAILURE;
+	}
+
+	if (filter_expr && !filter_compile(filter_expr)) {
+		fprintf(stderr, "Invalid filter expression\n");
+		return EXIT_FAILURE;
+	}
+
+	if (!control_set_window(window_from, window_to, index)) {
+		fprintf(stderr, "Invalid time window\n");
+		return EXIT_FAILURE;
+	}
+
 	sigemptyset(&mask);
 	sigaddset(&mask, SIGINT);
 	sigaddset(&mask, SIGTERM);
 
 	mainloop_set_signal(&mask, signal_callback, NULL, NULL);
 
-	printf("Bluetooth monitor ver %s\n", VERSION);
+	/* Exported records are the only output */
+	if (!export_enabled())
+		printf("Bluetooth monitor ver %s\n", VERSION);
 
 	keys_setup();
 
 	packet_set_filter(filter_mask);
 
 	if (analyze_path) {
-		analyze_trace(analyze_path);
+		analyze_trace(analyze_path, analyze_jobs);
 		return EXIT_SUCCESS;
 	}
 
@@ -196,10 +320,13 @@ int main(int argc, char *argv[])
 			ellisys_enable(ellisys_server, ellisys_port);
 
 		control_reader(reader_path);
+		filter_cleanup();
 		return EXIT_SUCCESS;
 	}
 
-	if (writer_path && !control_writer(writer_path)) {
+	if (writer_path && !control_writer(writer_path,
+					rotate_size * 1024 * 1024,
+					rotate_time, rotate_keep)) {
 		printf("Failed to open '%s'\n", writer_path);
 		return EXIT_FAILURE;
 	}
@@ -207,11 +334,18 @@ int main(int argc, char *argv[])
 	if (ellisys_server)
 		ellisys_enable(ellisys_server, ellisys_port);
 
+	if (stats_interval && !control_stats(stats_interval)) {
+		fprintf(stderr, "Failed to start statistics\n");
+		return EXIT_FAILURE;
+	}
+
 	if (control_tracing() < 0)
 		return EXIT_FAILURE;
 
 	exit_status = mainloop_run();
 
+	control_cleanup();
+	filter_cleanup();
 	keys_cleanup();
 
 	return exit_status;
@@ -52,6 +52,7 @@
 #include "l2cap.h"
 #include "control.h"
 #include "vendor.h"
+#include "export.h"
 #include "packet.h"
 
 #define COLOR_INDEX_LABEL		COLOR_WHITE
@@ -3652,6 +3653,9 @@ void packet_control(struct timeval *tv, uint16_t index, uint16_t opcode,
 	if (index_filter && index_number != index)
 		return;
 
+	if (export_enabled())
+		return;
+
 	control_message(opcode, data, size);
 }
 
@@ -3684,6 +3688,9 @@ void packet_monitor(struct timeval *tv, uint16_t index, uint16_t opcode,
 	if (tv && time_offset == ((time_t) -1))
 		time_offset = tv->tv_sec;
 
+	if (export_packet(tv, index, opcode, data, size))
+		return;
+
 	switch (opcode) {
 	case BTSNOOP_OPCODE_NEW_INDEX:
 		ni = data;
@@ -7186,18 +7193,80 @@ static const struct opcode_data opcode_table[] = {
 	{ }
 };
 
-static const char *get_supported_command(int bit)
+/*
+ * Opcodes are looked up for every command, command complete and command
+ * status, so opcode_table is indexed on first use: an open addressing
+ * hash of table positions plus one (zero marks a free slot), kept at
+ * most a quarter full, and a direct index by supported commands bit.
+ */
+#define OPCODE_INDEX_SIZE	1024
+#define OPCODE_INDEX_MASK	(OPCODE_INDEX_SIZE - 1)
+#define SUPPORTED_INDEX_SIZE	(64 * 8)
+
+static uint16_t opcode_index[OPCODE_INDEX_SIZE];
+static const struct opcode_data *supported_index[SUPPORTED_INDEX_SIZE];
+static bool opcode_index_valid;
+
+static unsigned int opcode_hash(uint16_t opcode)
+{
+	return (opcode * 0x9e3779b1u) >> 22;
+}
+
+static void build_opcode_index(void)
 {
 	int i;
 
 	for (i = 0; opcode_table[i].str; i++) {
-		if (opcode_table[i].bit == bit)
-			return opcode_table[i].str;
+		const struct opcode_data *opcode_data = &opcode_table[i];
+		unsigned int slot = opcode_hash(opcode_data->opcode);
+
+		/* Probing in table order keeps the first of any duplicates */
+		while (opcode_index[slot])
+			slot = (slot + 1) & OPCODE_INDEX_MASK;
+
+		opcode_index[slot] = i + 1;
+
+		if (opcode_data->bit < 0 ||
+				opcode_data->bit >= SUPPORTED_INDEX_SIZE)
+			continue;
+
+		if (!supported_index[opcode_data->bit])
+			supported_index[opcode_data->bit] = opcode_data;
+	}
+
+	opcode_index_valid = true;
+}
+
+static const struct opcode_data *find_opcode(uint16_t opcode)
+{
+	unsigned int slot;
+
+	if (!opcode_index_valid)
+		build_opcode_index();
+
+	for (slot = opcode_hash(opcode); opcode_index[slot];
+				slot = (slot + 1) & OPCODE_INDEX_MASK) {
+		const struct opcode_data *opcode_data;
+
+		opcode_data = &opcode_table[opcode_index[slot] - 1];
+		if (opcode_data->opcode == opcode)
+			return opcode_data;
 	}
 
 	return NULL;
 }
 
+static const char *get_supported_command(int bit)
+{
+	if (!opcode_index_valid)
+		build_opcode_index();
+
+	if (bit < 0 || bit >= SUPPORTED_INDEX_SIZE || !supported_index[bit])
+		return NULL;
+
+	return supported_index[bit]->str;
+}
+
 static void inquiry_complete_evt(const void *data, uint8_t size)
 {
 	const struct bt_hci_evt_inquiry_complete *evt = data;
@@ -7348,14 +7417,8 @@ static void cmd_complete_evt(const void *data, uint8_t size)
 	uint16_t ocf = cmd_opcode_ocf(opcode);
 	const struct opcode_data *opcode_data = NULL;
 	const char *opcode_color, *opcode_str;
-	int i;
 
-	for (i = 0; opcode_table[i].str; i++) {
-		if (opcode_table[i].opcode == opcode) {
-			opcode_data = &opcode_table[i];
-			break;
-		}
-	}
+	opcode_data = find_opcode(opcode);
 
 	if (opcode_data) {
 		if (opcode_data->rsp_func)
@@ -7418,14 +7481,8 @@ static void cmd_status_evt(const void *data, uint8_t size)
 	uint16_t ocf = cmd_opcode_ocf(opcode);
 	const struct opcode_data *opcode_data = NULL;
 	const char *opcode_color, *opcode_str;
-	int i;
 
-	for (i = 0; opcode_table[i].str; i++) {
-		if (opcode_table[i].opcode == opcode) {
-			opcode_data = &opcode_table[i];
-			break;
-		}
-	}
+	opcode_data = find_opcode(opcode);
 
 	if (opcode_data) {
 		opcode_color = COLOR_HCI_COMMAND;
@@ -8211,19 +8268,34 @@ static const struct subevent_data subevent_table[] = {
 	{ }
 };
 
+static const struct subevent_data *subevent_index[256];
+static bool subevent_index_valid;
+
+static const struct subevent_data *find_subevent(uint8_t subevent)
+{
+	int i;
+
+	if (!subevent_index_valid) {
+		for (i = 0; subevent_table[i].str; i++) {
+			uint8_t code = subevent_table[i].subevent;
+
+			if (!subevent_index[code])
+				subevent_index[code] = &subevent_table[i];
+		}
+
+		subevent_index_valid = true;
+	}
+
+	return subevent_index[subevent];
+}
+
 static void le_meta_event_evt(const void *data, uint8_t size)
 {
 	uint8_t subevent = *((const uint8_t *) data);
 	const struct subevent_data *subevent_data = NULL;
 	const char *subevent_color, *subevent_str;
-	int i;
 
-	for (i = 0; subevent_table[i].str; i++) {
-		if (subevent_table[i].subevent == subevent) {
-			subevent_data = &subevent_table[i];
-			break;
-		}
-	}
+	subevent_data = find_subevent(subevent);
 
 	if (subevent_data) {
 		if (subevent_data->func)
@@ -8429,6 +8501,27 @@ static const struct event_data event_table[] = {
 	{ }
 };
 
+static const struct event_data *event_index[256];
+static bool event_index_valid;
+
+static const struct event_data *find_event(uint8_t event)
+{
+	int i;
+
+	if (!event_index_valid) {
+		for (i = 0; event_table[i].str; i++) {
+			uint8_t code = event_table[i].event;
+
+			if (!event_index[code])
+				event_index[code] = &event_table[i];
+		}
+
+		event_index_valid = true;
+	}
+
+	return event_index[event];
+}
+
 void packet_new_index(struct timeval *tv, uint16_t index, const char *label,
 				uint8_t type, uint8_t bus, const char *name)
 {
@@ -8447,6 +8540,27 @@ void packet_del_index(struct timeval *tv, uint16_t index, const char *label)
 							label, NULL);
 }
 
+const char *packet_opcode_str(uint16_t opcode)
+{
+	const struct opcode_data *opcode_data = find_opcode(opcode);
+
+	return opcode_data ? opcode_data->str : NULL;
+}
+
+const char *packet_event_str(uint8_t event)
+{
+	const struct event_data *event_data = find_event(event);
+
+	return event_data ? event_data->str : NULL;
+}
+
+const char *packet_subevent_str(uint8_t subevent)
+{
+	const struct subevent_data *subevent_data = find_subevent(subevent);
+
+	return subevent_data ? subevent_data->str : NULL;
+}
+
 void packet_hci_command(struct timeval *tv, uint16_t index,
 					const void *data, uint16_t size)
 {
@@ -8457,7 +8571,6 @@ void packet_hci_command(struct timeval *tv, uint16_t index,
 	const struct opcode_data *opcode_data = NULL;
 	const char *opcode_color, *opcode_str;
 	char extra_str[25];
-	int i;
 
 	if (size < HCI_COMMAND_HDR_SIZE) {
 		sprintf(extra_str, "(len %d)", size);
@@ -8470,12 +8583,7 @@ void packet_hci_command(struct timeval *tv, uint16_t index,
 	data += HCI_COMMAND_HDR_SIZE;
 	size -= HCI_COMMAND_HDR_SIZE;
 
-	for (i = 0; opcode_table[i].str; i++) {
-		if (opcode_table[i].opcode == opcode) {
-			opcode_data = &opcode_table[i];
-			break;
-		}
-	}
+	opcode_data = find_opcode(opcode);
 
 	if (opcode_data) {
 		if (opcode_data->cmd_func)
@@ -8534,7 +8642,6 @@ void packet_hci_event(struct timeval *tv, uint16_t index,
 	const struct event_data *event_data = NULL;
 	const char *event_color, *event_str;
 	char extra_str[25];
-	int i;
 
 	if (size < HCI_EVENT_HDR_SIZE) {
 		sprintf(extra_str, "(len %d)", size);
@@ -8547,12 +8654,7 @@ void packet_hci_event(struct timeval *tv, uint16_t index,
 	data += HCI_EVENT_HDR_SIZE;
 	size -= HCI_EVENT_HDR_SIZE;
 
-	for (i = 0; event_table[i].str; i++) {
-		if (event_table[i].event == hdr->evt) {
-			event_data = &event_table[i];
-			break;
-		}
-	}
+	event_data = find_event(hdr->evt);
 
 	if (event_data) {
 		if (event_data->func)
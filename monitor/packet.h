@@ -64,6 +64,10 @@ void packet_new_index(struct timeval *tv, uint16_t index, const char *label,
 				uint8_t type, uint8_t bus, const char *name);
 void packet_del_index(struct timeval *tv, uint16_t index, const char *label);
 
+const char *packet_opcode_str(uint16_t opcode);
+const char *packet_event_str(uint8_t event);
+const char *packet_subevent_str(uint8_t subevent);
+
 void packet_hci_command(struct timeval *tv, uint16_t index,
 					const void *data, uint16_t size);
 void packet_hci_event(struct timeval *tv, uint16_t index,
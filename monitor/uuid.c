@@ -334,6 +334,8 @@ static struct {
 	{ 0x2aa1, "Magnetic Flux Density - 3D"			},
 	{ 0x2aa2, "Language"					},
 	{ 0x2aa3, "Barometric Pressure Trend"			},
+	{ 0x2b29, "Client Supported Features"			},
+	{ 0x2b2a, "Database Hash"				},
 	{ }
 };
 
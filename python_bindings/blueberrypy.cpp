@@ -22,6 +22,16 @@ BOOST_PYTHON_MODULE(blueberrypy)
     .value("UnsupportedGroupType", AttErrorCode::UnsupportedGroupType)
     .value("InsufficientResources", AttErrorCode::InsufficientResources);
 
+  enum_<CharacteristicProperty>("CharacteristicProperty")
+    .value("Broadcast", CharacteristicProperty::Broadcast)
+    .value("Read", CharacteristicProperty::Read)
+    .value("WriteWithoutResponse", CharacteristicProperty::WriteWithoutResponse)
+    .value("Write", CharacteristicProperty::Write)
+    .value("Notify", CharacteristicProperty::Notify)
+    .value("Indicate", CharacteristicProperty::Indicate)
+    .value("AuthenticatedSignedWrites", CharacteristicProperty::AuthenticatedSignedWrites)
+    .value("ExtendedProperties", CharacteristicProperty::ExtendedProperties);
+
   enum_<BleAdvertisementType>("BleAdvertisementType")
     .value("ConnectableUndirected", BleAdvertisementType::ConnectableUndirected)
     .value("ConnectableDirected", BleAdvertisementType::ConnectableDirected)
@@ -29,15 +39,26 @@ BOOST_PYTHON_MODULE(blueberrypy)
     .value("NonConnectableUndirected", BleAdvertisementType::NonConnectableUndirected)
     .value("ScanResponse", BleAdvertisementType::ScanResponse);
 
-  class_<BtAdapter>("BtAdapter", init<int, PyObject*>())
+  class_<bluez::native::RpaResolver, boost::noncopyable>("RpaResolver")
+    .def(init<size_t>())
+    .def("addIrk", &bluez::native::RpaResolver::addIrk)
+    .def("removeIrk", &bluez::native::RpaResolver::removeIrk)
+    .def("clear", &bluez::native::RpaResolver::clear)
+    .add_property("irkCount", &bluez::native::RpaResolver::getIrkCount);
+
+  class_<BtAdapter, boost::noncopyable>("BtAdapter", init<int, PyObject*>())
     .def("enableScanning", &BtAdapter::enableScanning)
-    .def("disableScanning", &BtAdapter::disableScanning);
+    .def("disableScanning", &BtAdapter::disableScanning)
+    .def("setRpaResolver", &BtAdapter::setRpaResolver, with_custodian_and_ward<1, 2>());
 
   class_<BleAdvertisement>("BleAdvertisement")
     .add_property("type", &BleAdvertisement::type)
     .add_property("rssi", &BleAdvertisement::rssi)
     .add_property("addressType", &BleAdvertisement::addressType)
     .add_property("btAddress", &BleAdvertisement::btAddress)
+    .add_property("resolved", &BleAdvertisement::resolved)
+    .add_property("identityAddressType", &BleAdvertisement::identityAddressType)
+    .add_property("identityAddress", &BleAdvertisement::identityAddress)
     .add_property("hasFlags", &BleAdvertisement::hasFlags)
     .add_property("rawFlags", &BleAdvertisement::rawFlags)
     .add_property("limitedDiscoverable", &BleAdvertisement::limitedDiscoverable)
@@ -68,8 +89,11 @@ BOOST_PYTHON_MODULE(blueberrypy)
 
   class_<GattClient>("GattClient", init<PyObject*>())
     .def(init<PyObject*, uint16_t>())
+    .def(init<PyObject*, uint16_t, unsigned int>())
     .def("connect", &GattClient::connect)
     .def("disconnect", &GattClient::disconnect)
+    .def("readMultiple", &GattClient::readMultipleList)
+    .add_property("bearerCount", &GattClient::getBearerCount)
     .add_property("services", &GattClient::getServices);
 
   class_<GattService>("GattService")
@@ -95,4 +119,30 @@ BOOST_PYTHON_MODULE(blueberrypy)
   class_<GattDescriptor>("GattDescriptor")
     .add_property("handle", &GattDescriptor::getHandle)
     .add_property("uuid", &GattDescriptor::getUuid);
+
+  class_<GattServer, boost::noncopyable>("GattServer", init<PyObject*>())
+    .def(init<PyObject*, uint16_t>())
+    .def("addService", &GattServer::addService)
+    .def("start", &GattServer::start)
+    .def("stop", &GattServer::stop)
+    .add_property("connectionCount", &GattServer::getConnectionCount)
+    .add_property("services", &GattServer::getServices);
+
+  class_<LocalService>("LocalService", init<std::string, bool>())
+    .def("addCharacteristic", &LocalService::addCharacteristic)
+    .add_property("startHandle", &LocalService::getStartHandle)
+    .add_property("endHandle", &LocalService::getEndHandle)
+    .add_property("primary", &LocalService::getPrimary)
+    .add_property("uuid", &LocalService::getUuid)
+    .add_property("characteristics", &LocalService::getCharacteristics);
+
+  class_<LocalCharacteristic>("LocalCharacteristic", no_init)
+    .add_property("handle", &LocalCharacteristic::getHandle)
+    .add_property("valueHandle", &LocalCharacteristic::getValueHandle)
+    .add_property("properties", &LocalCharacteristic::getProperties)
+    .add_property("uuid", &LocalCharacteristic::getUuid)
+    .add_property("value", &LocalCharacteristic::getValue, &LocalCharacteristic::setValue)
+    .def("bind", &LocalCharacteristic::bind)
+    .def("unbind", &LocalCharacteristic::unbind)
+    .def("notify", &LocalCharacteristic::notify);
 }
@@ -1,10 +1,12 @@
 #pragma once
 #include "BtAdapter.h"
 #include "GattClient.h"
+#include "GattServer.h"
 #include <boost/python.hpp>
 #include <string>
 #include <sstream>
 #include <iostream>
+#include <stdexcept>
 
 using namespace boost::python;
 
@@ -29,6 +31,17 @@ enum class AttErrorCode : uint8_t {
   InsufficientResources = 0x11
 };
 
+enum class CharacteristicProperty : uint8_t {
+  Broadcast = 0x01,
+  Read = 0x02,
+  WriteWithoutResponse = 0x04,
+  Write = 0x08,
+  Notify = 0x10,
+  Indicate = 0x20,
+  AuthenticatedSignedWrites = 0x40,
+  ExtendedProperties = 0x80
+};
+
 enum class BleAdvertisementType : uint8_t {
 	ConnectableUndirected = 0x00,
 	ConnectableDirected = 0x01,
@@ -66,6 +79,18 @@ struct BleAdvertisement {
     return boost::python::object(m_advertisement->btAddress());
   }
 
+  bool resolved() {
+    return m_advertisement->resolved();
+  }
+
+  boost::python::object identityAddressType() {
+    return boost::python::object(m_advertisement->identityAddressType());
+  }
+
+  boost::python::object identityAddress() {
+    return boost::python::object(m_advertisement->identityAddress());
+  }
+
   bool hasFlags() {
     return m_advertisement->hasFlags();
   }
@@ -415,6 +440,11 @@ struct GattClient : bluez::native::GattClient {
     PyEval_InitThreads();
   }
 
+  GattClient(PyObject* pyCallback, uint16_t mtu, unsigned int enhancedBearers) :
+    bluez::native::GattClient(mtu, enhancedBearers), m_pyCallback(pyCallback) {
+    PyEval_InitThreads();
+  }
+
   ~GattClient() {}
 
   virtual void onServicesDiscovered(bool success, uint8_t attErrorCode) {
@@ -424,6 +454,29 @@ struct GattClient : bluez::native::GattClient {
     PyGILState_Release(gstate);
   }
 
+  virtual void onReadMultipleResponse(bool success, uint8_t attErrorCode, std::map<uint16_t, std::string> values) {
+    PyGILState_STATE gstate;
+    gstate = PyGILState_Ensure();
+
+    boost::python::dict dict;
+    for (auto i = values.begin(); i != values.end(); ++i) {
+      dict[i->first] = i->second;
+    }
+
+    call_method<void>(m_pyCallback, "onReadMultipleResponse", success, (AttErrorCode) attErrorCode, dict);
+    PyGILState_Release(gstate);
+  }
+
+  bool readMultipleList(boost::python::list valueHandles) {
+    std::vector<uint16_t> handles;
+
+    for (ssize_t i = 0; i < len(valueHandles); ++i) {
+      handles.push_back(boost::python::extract<uint16_t>(valueHandles[i]));
+    }
+
+    return readMultiple(handles);
+  }
+
   boost::python::list getServices() {
     boost::python::list list;
 
@@ -437,3 +490,202 @@ struct GattClient : bluez::native::GattClient {
 
   PyObject* const m_pyCallback;
 };
+
+struct LocalCharacteristic : bluez::native::ILocalCharacteristicCallback {
+  LocalCharacteristic() {
+    throw;
+  }
+
+  LocalCharacteristic(bluez::native::LocalCharacteristic* characteristic) :
+    m_characteristic(characteristic),
+    m_pyCallback(NULL) {
+  }
+
+  ~LocalCharacteristic() {
+    //don't delete m_characteristic as it doesn't belong to us. This
+    //is a wrapper object that doesn't own the underlying object.
+  }
+
+  boost::python::object getHandle() {
+    return boost::python::object(m_characteristic->getHandle());
+  }
+
+  boost::python::object getValueHandle() {
+    return boost::python::object(m_characteristic->getValueHandle());
+  }
+
+  boost::python::object getProperties() {
+    return boost::python::object(m_characteristic->getProperties());
+  }
+
+  boost::python::object getUuid() {
+    return boost::python::object(m_characteristic->getUuid());
+  }
+
+  boost::python::object getValue() {
+    return boost::python::object(m_characteristic->getValue());
+  }
+
+  void setValue(std::string value) {
+    m_characteristic->setValue(value);
+  }
+
+  void bind(PyObject* pyCallback) {
+    m_characteristic->bind(this);
+    m_pyCallback = pyCallback;
+  }
+
+  void unbind() {
+    m_characteristic->unbind();
+    m_pyCallback = NULL;
+  }
+
+  bool notify(std::string value) {
+    return m_characteristic->notify(value);
+  }
+
+  /* ILocalCharacteristicCallback Interface Implementation */
+  virtual uint8_t onRead(std::string btAddress, std::string& value) {
+    uint8_t attErrorCode = 0;
+
+    PyGILState_STATE gstate;
+    gstate = PyGILState_Ensure();
+    boost::python::object result = call_method<boost::python::object>(m_pyCallback, "onRead", btAddress);
+    // None keeps the cached value, a string replaces it, an AttErrorCode fails the read
+    if (extract<std::string>(result).check()) {
+      value = extract<std::string>(result)();
+    } else if (extract<AttErrorCode>(result).check()) {
+      attErrorCode = (uint8_t) extract<AttErrorCode>(result)();
+    }
+    PyGILState_Release(gstate);
+
+    return attErrorCode;
+  }
+
+  virtual uint8_t onWrite(std::string btAddress, std::string value) {
+    uint8_t attErrorCode = 0;
+
+    PyGILState_STATE gstate;
+    gstate = PyGILState_Ensure();
+    boost::python::object result = call_method<boost::python::object>(m_pyCallback, "onWrite", btAddress, value);
+    if (extract<AttErrorCode>(result).check()) {
+      attErrorCode = (uint8_t) extract<AttErrorCode>(result)();
+    }
+    PyGILState_Release(gstate);
+
+    return attErrorCode;
+  }
+
+  virtual void onSubscriptionChanged(std::string btAddress, bool notify, bool indicate) {
+    PyGILState_STATE gstate;
+    gstate = PyGILState_Ensure();
+    call_method<void>(m_pyCallback, "onSubscriptionChanged", btAddress, notify, indicate);
+    PyGILState_Release(gstate);
+  }
+  /* ILocalCharacteristicCallback Interface End */
+
+  bluez::native::LocalCharacteristic* m_characteristic;
+  PyObject* m_pyCallback;
+};
+
+struct LocalService {
+  LocalService() {
+    throw;
+  }
+
+  LocalService(std::string uuid, bool primary) {
+    m_service = bluez::native::LocalService::create(uuid, primary);
+    if (!m_service) {
+      throw std::invalid_argument("invalid service UUID");
+    }
+  }
+
+  LocalService(bluez::native::LocalService* service) {
+    m_service = service;
+  }
+
+  ~LocalService() {
+    //don't delete m_service, it is owned by the GattServer it is added to.
+  }
+
+  boost::python::object addCharacteristic(std::string uuid, uint8_t properties) {
+    bluez::native::LocalCharacteristic* characteristic = m_service->addCharacteristic(uuid, properties);
+    if (!characteristic) {
+      return boost::python::object();
+    }
+
+    return boost::python::object(LocalCharacteristic(characteristic));
+  }
+
+  boost::python::object getStartHandle() {
+    return boost::python::object(m_service->getStartHandle());
+  }
+
+  boost::python::object getEndHandle() {
+    return boost::python::object(m_service->getEndHandle());
+  }
+
+  boost::python::object getPrimary() {
+    return boost::python::object(m_service->getPrimary());
+  }
+
+  boost::python::object getUuid() {
+    return boost::python::object(m_service->getUuid());
+  }
+
+  boost::python::list getCharacteristics() {
+    boost::python::list list;
+
+    for (auto i = m_service->CharacteristicCollectionBegin(); i != m_service->CharacteristicCollectionEnd(); ++i) {
+      LocalCharacteristic* wrapper = new LocalCharacteristic(*i);
+      list.append(wrapper);
+    }
+
+    return list;
+  }
+
+  bluez::native::LocalService* m_service;
+};
+
+struct GattServer : bluez::native::GattServer {
+  GattServer(PyObject* pyCallback) : bluez::native::GattServer(), m_pyCallback(pyCallback) {
+    PyEval_InitThreads();
+  }
+
+  GattServer(PyObject* pyCallback, uint16_t mtu) : bluez::native::GattServer(mtu), m_pyCallback(pyCallback) {
+    PyEval_InitThreads();
+  }
+
+  ~GattServer() {}
+
+  bool addService(LocalService& service) {
+    return bluez::native::GattServer::addService(service.m_service);
+  }
+
+  virtual void onConnected(std::string btAddress) {
+    PyGILState_STATE gstate;
+    gstate = PyGILState_Ensure();
+    call_method<void>(m_pyCallback, "onConnected", btAddress);
+    PyGILState_Release(gstate);
+  }
+
+  virtual void onDisconnected(std::string btAddress, int err) {
+    PyGILState_STATE gstate;
+    gstate = PyGILState_Ensure();
+    call_method<void>(m_pyCallback, "onDisconnected", btAddress, err);
+    PyGILState_Release(gstate);
+  }
+
+  boost::python::list getServices() {
+    boost::python::list list;
+
+    for (auto i = ServiceCollectionBegin(); i != ServiceCollectionEnd(); ++i) {
+      LocalService* wrapper = new LocalService(*i);
+      list.append(wrapper);
+    }
+
+    return list;
+  }
+
+  PyObject* const m_pyCallback;
+};
@@ -0,0 +1,629 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+#include "src/shared/util.h"
+#include "src/shared/aes.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <wmmintrin.h>
+#define HAVE_AESNI
+#endif
+
+/*
+ * The portable implementation is bitsliced so that it has no secret
+ * dependent table lookups or branches. Plane i of the state holds bit i of
+ * every state byte, byte j = 4 * column + row in bit j.
+ */
+
+static void bitslice(const uint8_t in[16], uint32_t q[8])
+{
+	uint64_t x[2], t;
+	int i, j;
+
+	x[0] = get_le64(in);
+	x[1] = get_le64(in + 8);
+
+	/* Transpose each half as an 8x8 bit matrix */
+	for (j = 0; j < 2; j++) {
+		t = (x[j] ^ (x[j] >> 7)) & 0x00aa00aa00aa00aaULL;
+		x[j] ^= t ^ (t << 7);
+		t = (x[j] ^ (x[j] >> 14)) & 0x0000cccc0000ccccULL;
+		x[j] ^= t ^ (t << 14);
+		t = (x[j] ^ (x[j] >> 28)) & 0x00000000f0f0f0f0ULL;
+		x[j] ^= t ^ (t << 28);
+	}
+
+	for (i = 0; i < 8; i++)
+		q[i] = ((x[0] >> (8 * i)) & 0xff) |
+				(((x[1] >> (8 * i)) & 0xff) << 8);
+}
+
+static void unbitslice(const uint32_t q[8], uint8_t out[16])
+{
+	uint64_t x[2] = { 0, 0 }, t;
+	int i, j;
+
+	for (i = 0; i < 8; i++) {
+		x[0] |= (uint64_t) (q[i] & 0xff) << (8 * i);
+		x[1] |= (uint64_t) ((q[i] >> 8) & 0xff) << (8 * i);
+	}
+
+	for (j = 0; j < 2; j++) {
+		t = (x[j] ^ (x[j] >> 7)) & 0x00aa00aa00aa00aaULL;
+		x[j] ^= t ^ (t << 7);
+		t = (x[j] ^ (x[j] >> 14)) & 0x0000cccc0000ccccULL;
+		x[j] ^= t ^ (t << 14);
+		t = (x[j] ^ (x[j] >> 28)) & 0x00000000f0f0f0f0ULL;
+		x[j] ^= t ^ (t << 28);
+	}
+
+	put_le64(x[0], out);
+	put_le64(x[1], out + 8);
+}
+
+/*
+ * S-box circuit from Boyar and Peralta, "A new combinational logic
+ * minimization technique with applications to cryptology". x0 and s0 are
+ * the most significant bits.
+ */
+static void sub_bytes(uint32_t q[8])
+{
+	uint32_t x0, x1, x2, x3, x4, x5, x6, x7;
+	uint32_t y1, y2, y3, y4, y5, y6, y7, y8, y9, y10, y11;
+	uint32_t y12, y13, y14, y15, y16, y17, y18, y19, y20, y21;
+	uint32_t z0, z1, z2, z3, z4, z5, z6, z7, z8, z9;
+	uint32_t z10, z11, z12, z13, z14, z15, z16, z17;
+	uint32_t t0, t1, t2, t3, t4, t5, t6, t7, t8, t9;
+	uint32_t t10, t11, t12, t13, t14, t15, t16, t17, t18, t19;
+	uint32_t t20, t21, t22, t23, t24, t25, t26, t27, t28, t29;
+	uint32_t t30, t31, t32, t33, t34, t35, t36, t37, t38, t39;
+	uint32_t t40, t41, t42, t43, t44, t45, t46, t47, t48, t49;
+	uint32_t t50, t51, t52, t53, t54, t55, t56, t57, t58, t59;
+	uint32_t t60, t61, t62, t63, t64, t65, t66, t67;
+
+	x0 = q[7];
+	x1 = q[6];
+	x2 = q[5];
+	x3 = q[4];
+	x4 = q[3];
+	x5 = q[2];
+	x6 = q[1];
+	x7 = q[0];
+
+	/* Top linear transformation */
+	y14 = x3 ^ x5;
+	y13 = x0 ^ x6;
+	y9 = x0 ^ x3;
+	y8 = x0 ^ x5;
+	t0 = x1 ^ x2;
+	y1 = t0 ^ x7;
+	y4 = y1 ^ x3;
+	y12 = y13 ^ y14;
+	y2 = y1 ^ x0;
+	y5 = y1 ^ x6;
+	y3 = y5 ^ y8;
+	t1 = x4 ^ y12;
+	y15 = t1 ^ x5;
+	y20 = t1 ^ x1;
+	y6 = y15 ^ x7;
+	y10 = y15 ^ t0;
+	y11 = y20 ^ y9;
+	y7 = x7 ^ y11;
+	y17 = y10 ^ y11;
+	y19 = y10 ^ y8;
+	y16 = t0 ^ y11;
+	y21 = y13 ^ y16;
+	y18 = x0 ^ y16;
+
+	/* Non-linear section */
+	t2 = y12 & y15;
+	t3 = y3 & y6;
+	t4 = t3 ^ t2;
+	t5 = y4 & x7;
+	t6 = t5 ^ t2;
+	t7 = y13 & y16;
+	t8 = y5 & y1;
+	t9 = t8 ^ t7;
+	t10 = y2 & y7;
+	t11 = t10 ^ t7;
+	t12 = y9 & y11;
+	t13 = y14 & y17;
+	t14 = t13 ^ t12;
+	t15 = y8 & y10;
+	t16 = t15 ^ t12;
+	t17 = t4 ^ t14;
+	t18 = t6 ^ t16;
+	t19 = t9 ^ t14;
+	t20 = t11 ^ t16;
+	t21 = t17 ^ y20;
+	t22 = t18 ^ y19;
+	t23 = t19 ^ y21;
+	t24 = t20 ^ y18;
+
+	t25 = t21 ^ t22;
+	t26 = t21 & t23;
+	t27 = t24 ^ t26;
+	t28 = t25 & t27;
+	t29 = t28 ^ t22;
+	t30 = t23 ^ t24;
+	t31 = t22 ^ t26;
+	t32 = t31 & t30;
+	t33 = t32 ^ t24;
+	t34 = t23 ^ t33;
+	t35 = t27 ^ t33;
+	t36 = t24 & t35;
+	t37 = t36 ^ t34;
+	t38 = t27 ^ t36;
+	t39 = t29 & t38;
+	t40 = t25 ^ t39;
+
+	t41 = t40 ^ t37;
+	t42 = t29 ^ t33;
+	t43 = t29 ^ t40;
+	t44 = t33 ^ t37;
+	t45 = t42 ^ t41;
+	z0 = t44 & y15;
+	z1 = t37 & y6;
+	z2 = t33 & x7;
+	z3 = t43 & y16;
+	z4 = t40 & y1;
+	z5 = t29 & y7;
+	z6 = t42 & y11;
+	z7 = t45 & y17;
+	z8 = t41 & y10;
+	z9 = t44 & y12;
+	z10 = t37 & y3;
+	z11 = t33 & y4;
+	z12 = t43 & y13;
+	z13 = t40 & y5;
+	z14 = t29 & y2;
+	z15 = t42 & y9;
+	z16 = t45 & y14;
+	z17 = t41 & y8;
+
+	/* Bottom linear transformation */
+	t46 = z15 ^ z16;
+	t47 = z10 ^ z11;
+	t48 = z5 ^ z13;
+	t49 = z9 ^ z10;
+	t50 = z2 ^ z12;
+	t51 = z2 ^ z5;
+	t52 = z7 ^ z8;
+	t53 = z0 ^ z3;
+	t54 = z6 ^ z7;
+	t55 = z16 ^ z17;
+	t56 = z12 ^ t48;
+	t57 = t50 ^ t53;
+	t58 = z4 ^ t46;
+	t59 = z3 ^ t54;
+	t60 = t46 ^ t57;
+	t61 = z14 ^ t57;
+	t62 = t52 ^ t58;
+	t63 = t49 ^ t58;
+	t64 = z4 ^ t59;
+	t65 = t61 ^ t62;
+	t66 = z1 ^ t63;
+	t67 = t64 ^ t65;
+
+	q[7] = t59 ^ t63;
+	q[1] = t56 ^ ~t62;
+	q[0] = t48 ^ ~t60;
+	q[4] = t53 ^ t66;
+	q[3] = t51 ^ t66;
+	q[2] = t47 ^ t65;
+	q[6] = t64 ^ ~q[4];
+	q[5] = t55 ^ ~t67;
+}
+
+static inline uint32_t rotr16(uint32_t x, int n)
+{
+	return ((x >> n) | (x << (16 - n))) & 0xffff;
+}
+
+/* Row r of every column moves left by r columns, that is 4 * r bits */
+static inline uint32_t shift_rows16(uint32_t x)
+{
+	return (x & 0x1111) | rotr16(x & 0x2222, 4) | rotr16(x & 0x4444, 8) |
+						rotr16(x & 0x8888, 12);
+}
+
+static void shift_rows(uint32_t q[8])
+{
+	int i;
+
+	for (i = 0; i < 8; i++)
+		q[i] = shift_rows16(q[i] & 0xffff) |
+					(shift_rows16(q[i] >> 16) << 16);
+}
+
+/* Moves row r + n of each column to row r */
+#define ROW_ROT1(x) ((((x) >> 1) & 0x77777777) | (((x) << 3) & 0x88888888))
+#define ROW_ROT2(x) ((((x) >> 2) & 0x33333333) | (((x) << 2) & 0xcccccccc))
+#define ROW_ROT3(x) ((((x) >> 3) & 0x11111111) | (((x) << 1) & 0xeeeeeeee))
+
+/* s'r = 2 * (sr ^ sr+1) ^ sr+1 ^ sr+2 ^ sr+3 */
+static void mix_columns(uint32_t q[8])
+{
+	uint32_t t[8], r[8];
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		uint32_t b = ROW_ROT1(q[i]);
+
+		t[i] = q[i] ^ b;
+		r[i] = b ^ ROW_ROT2(q[i]) ^ ROW_ROT3(q[i]);
+	}
+
+	/* Multiplication by x modulo x^8 + x^4 + x^3 + x + 1 */
+	q[0] = r[0] ^ t[7];
+	q[1] = r[1] ^ t[0] ^ t[7];
+	q[2] = r[2] ^ t[1];
+	q[3] = r[3] ^ t[2] ^ t[7];
+	q[4] = r[4] ^ t[3] ^ t[7];
+	q[5] = r[5] ^ t[4];
+	q[6] = r[6] ^ t[5];
+	q[7] = r[7] ^ t[6];
+}
+
+static inline void add_round_key(uint32_t q[8], const uint32_t sk0[8],
+						const uint32_t sk1[8])
+{
+	int i;
+
+	for (i = 0; i < 8; i++)
+		q[i] ^= sk0[i] | (sk1[i] << 16);
+}
+
+/*
+ * A block only uses the low 16 bits of each plane, so the upper half
+ * carries a second, independent block (lane 1) through the same rounds.
+ */
+static void encrypt_soft(const struct bt_aes_key *k0,
+				const struct bt_aes_key *k1,
+				const uint8_t in0[16], const uint8_t in1[16],
+				uint8_t out0[16], uint8_t out1[16])
+{
+	uint32_t q[8], q1[8];
+	int i, round;
+
+	bitslice(in0, q);
+	bitslice(in1, q1);
+
+	for (i = 0; i < 8; i++)
+		q[i] |= q1[i] << 16;
+
+	add_round_key(q, k0->sk[0], k1->sk[0]);
+
+	for (round = 1; round < 10; round++) {
+		sub_bytes(q);
+		shift_rows(q);
+		mix_columns(q);
+		add_round_key(q, k0->sk[round], k1->sk[round]);
+	}
+
+	sub_bytes(q);
+	shift_rows(q);
+	add_round_key(q, k0->sk[10], k1->sk[10]);
+
+	unbitslice(q, out0);
+
+	if (!out1)
+		return;
+
+	for (i = 0; i < 8; i++)
+		q1[i] = q[i] >> 16;
+
+	unbitslice(q1, out1);
+}
+
+#ifdef HAVE_AESNI
+__attribute__((target("aes,sse2")))
+static void encrypt_hw(const struct bt_aes_key *key, const uint8_t in[16],
+							uint8_t out[16])
+{
+	const __m128i *rk = (const __m128i *) key->rk;
+	__m128i b;
+	int round;
+
+	b = _mm_xor_si128(_mm_loadu_si128((const __m128i *) in),
+						_mm_loadu_si128(rk));
+
+	for (round = 1; round < 10; round++)
+		b = _mm_aesenc_si128(b, _mm_loadu_si128(rk + round));
+
+	b = _mm_aesenclast_si128(b, _mm_loadu_si128(rk + 10));
+
+	_mm_storeu_si128((__m128i *) out, b);
+}
+
+/* Four independent keys in flight hide the latency of aesenc */
+__attribute__((target("aes,sse2")))
+static void encrypt_hw4(const struct bt_aes_key *keys, const uint8_t in[16],
+							uint8_t (*out)[16])
+{
+	const __m128i *rk0 = (const __m128i *) keys[0].rk;
+	const __m128i *rk1 = (const __m128i *) keys[1].rk;
+	const __m128i *rk2 = (const __m128i *) keys[2].rk;
+	const __m128i *rk3 = (const __m128i *) keys[3].rk;
+	__m128i p, b0, b1, b2, b3;
+	int round;
+
+	p = _mm_loadu_si128((const __m128i *) in);
+
+	b0 = _mm_xor_si128(p, _mm_loadu_si128(rk0));
+	b1 = _mm_xor_si128(p, _mm_loadu_si128(rk1));
+	b2 = _mm_xor_si128(p, _mm_loadu_si128(rk2));
+	b3 = _mm_xor_si128(p, _mm_loadu_si128(rk3));
+
+	for (round = 1; round < 10; round++) {
+		b0 = _mm_aesenc_si128(b0, _mm_loadu_si128(rk0 + round));
+		b1 = _mm_aesenc_si128(b1, _mm_loadu_si128(rk1 + round));
+		b2 = _mm_aesenc_si128(b2, _mm_loadu_si128(rk2 + round));
+		b3 = _mm_aesenc_si128(b3, _mm_loadu_si128(rk3 + round));
+	}
+
+	b0 = _mm_aesenclast_si128(b0, _mm_loadu_si128(rk0 + 10));
+	b1 = _mm_aesenclast_si128(b1, _mm_loadu_si128(rk1 + 10));
+	b2 = _mm_aesenclast_si128(b2, _mm_loadu_si128(rk2 + 10));
+	b3 = _mm_aesenclast_si128(b3, _mm_loadu_si128(rk3 + 10));
+
+	_mm_storeu_si128((__m128i *) out[0], b0);
+	_mm_storeu_si128((__m128i *) out[1], b1);
+	_mm_storeu_si128((__m128i *) out[2], b2);
+	_mm_storeu_si128((__m128i *) out[3], b3);
+}
+
+__attribute__((target("aes,sse2")))
+static inline __m128i expand_hw(__m128i k, __m128i t)
+{
+	t = _mm_shuffle_epi32(t, 0xff);
+	k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+	k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+	k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+
+	return _mm_xor_si128(k, t);
+}
+
+/* The round constant has to be an immediate */
+#define EXPAND_HW(rk, i, rcon) \
+	rk[i] = expand_hw(rk[i - 1], _mm_aeskeygenassist_si128(rk[i - 1], rcon))
+
+__attribute__((target("aes,sse2")))
+static void set_key_hw(struct bt_aes_key *key, const uint8_t k[16])
+{
+	__m128i rk[11];
+	int i;
+
+	rk[0] = _mm_loadu_si128((const __m128i *) k);
+
+	EXPAND_HW(rk, 1, 0x01);
+	EXPAND_HW(rk, 2, 0x02);
+	EXPAND_HW(rk, 3, 0x04);
+	EXPAND_HW(rk, 4, 0x08);
+	EXPAND_HW(rk, 5, 0x10);
+	EXPAND_HW(rk, 6, 0x20);
+	EXPAND_HW(rk, 7, 0x40);
+	EXPAND_HW(rk, 8, 0x80);
+	EXPAND_HW(rk, 9, 0x1b);
+	EXPAND_HW(rk, 10, 0x36);
+
+	for (i = 0; i < 11; i++)
+		_mm_storeu_si128((__m128i *) (key->rk + 16 * i), rk[i]);
+}
+#endif
+
+static bool hw_disabled;
+
+bool bt_aes_has_hw(void)
+{
+#ifdef HAVE_AESNI
+	static int has_hw = -1;
+	unsigned int eax, ebx, ecx, edx;
+
+	if (has_hw < 0)
+		has_hw = __get_cpuid(1, &eax, &ebx, &ecx, &edx) &&
+							(ecx & bit_AES);
+
+	return has_hw;
+#else
+	return false;
+#endif
+}
+
+bool bt_aes_set_hw(bool enable)
+{
+	hw_disabled = !enable;
+
+	return bt_aes_has_hw() && enable;
+}
+
+static inline bool use_hw(void)
+{
+	return !hw_disabled && bt_aes_has_hw();
+}
+
+/* Only the portable code needs the bitsliced round keys */
+static void set_key_soft(struct bt_aes_key *key, const uint8_t k[16])
+{
+	static const uint8_t rcon[10] = {
+		0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36
+	};
+	uint8_t *w = key->rk;
+	uint32_t q[8];
+	uint8_t t[16];
+	int i;
+
+	memcpy(w, k, 16);
+
+	for (i = 16; i < 176; i += 4) {
+		memcpy(t, w + i - 4, 4);
+
+		if (!(i % 16)) {
+			uint8_t b = t[0];
+
+			/* SubWord(RotWord(t)), bitsliced to stay constant-time */
+			t[0] = t[1];
+			t[1] = t[2];
+			t[2] = t[3];
+			t[3] = b;
+			memset(t + 4, 0, 12);
+
+			bitslice(t, q);
+			sub_bytes(q);
+			unbitslice(q, t);
+
+			t[0] ^= rcon[i / 16 - 1];
+		}
+
+		w[i] = w[i - 16] ^ t[0];
+		w[i + 1] = w[i - 15] ^ t[1];
+		w[i + 2] = w[i - 14] ^ t[2];
+		w[i + 3] = w[i - 13] ^ t[3];
+	}
+
+	for (i = 0; i < 11; i++)
+		bitslice(w + 16 * i, key->sk[i]);
+}
+
+void bt_aes_set_key(struct bt_aes_key *key, const uint8_t k[16])
+{
+#ifdef HAVE_AESNI
+	if (use_hw()) {
+		set_key_hw(key, k);
+		return;
+	}
+#endif
+
+	set_key_soft(key, k);
+}
+
+void bt_aes_encrypt(const struct bt_aes_key *key, const uint8_t in[16],
+							uint8_t out[16])
+{
+#ifdef HAVE_AESNI
+	if (use_hw()) {
+		encrypt_hw(key, in, out);
+		return;
+	}
+#endif
+
+	encrypt_soft(key, key, in, in, out, NULL);
+}
+
+void bt_aes_encrypt_batch(const struct bt_aes_key *keys, size_t count,
+				const uint8_t in[16], uint8_t (*out)[16])
+{
+	size_t i = 0;
+
+#ifdef HAVE_AESNI
+	if (use_hw()) {
+		for (; i + 4 <= count; i += 4)
+			encrypt_hw4(keys + i, in, out + i);
+
+		for (; i < count; i++)
+			encrypt_hw(keys + i, in, out[i]);
+
+		return;
+	}
+#endif
+
+	for (; i + 2 <= count; i += 2)
+		encrypt_soft(keys + i, keys + i + 1, in, in, out[i],
+								out[i + 1]);
+
+	if (i < count)
+		encrypt_soft(keys + i, keys + i, in, in, out[i], NULL);
+}
+
+/* Doubling in GF(2^128) for the CMAC subkeys, RFC 4493 section 2.3 */
+static void cmac_dbl(const uint8_t in[16], uint8_t out[16])
+{
+	uint8_t msb = in[0] >> 7;
+	int i;
+
+	for (i = 0; i < 15; i++)
+		out[i] = (in[i] << 1) | (in[i + 1] >> 7);
+
+	out[15] = (in[15] << 1) ^ (0x87 & -msb);
+}
+
+void bt_aes_cmac(const uint8_t k[16], const struct iovec *iov, size_t iov_cnt,
+							uint8_t mac[16])
+{
+	struct bt_aes_key key;
+	uint8_t x[16], block[16], sub[16];
+	size_t fill = 0;
+	int i;
+
+	bt_aes_set_key(&key, k);
+
+	memset(x, 0, sizeof(x));
+
+	for (; iov_cnt; iov++, iov_cnt--) {
+		const uint8_t *p = iov->iov_base;
+		size_t len = iov->iov_len;
+
+		while (len) {
+			size_t n;
+
+			/* The last block is held back for the final step */
+			if (fill == 16) {
+				for (i = 0; i < 16; i++)
+					x[i] ^= block[i];
+
+				bt_aes_encrypt(&key, x, x);
+				fill = 0;
+			}
+
+			n = 16 - fill < len ? 16 - fill : len;
+			memcpy(block + fill, p, n);
+			fill += n;
+			p += n;
+			len -= n;
+		}
+	}
+
+	memset(sub, 0, sizeof(sub));
+	bt_aes_encrypt(&key, sub, sub);
+	cmac_dbl(sub, sub);
+
+	/* Incomplete or empty last blocks get padded and use K2 */
+	if (fill < 16) {
+		block[fill] = 0x80;
+		memset(block + fill + 1, 0, 15 - fill);
+		cmac_dbl(sub, sub);
+	}
+
+	for (i = 0; i < 16; i++)
+		x[i] ^= block[i] ^ sub[i];
+
+	bt_aes_encrypt(&key, x, mac);
+
+	memset(&key, 0, sizeof(key));
+	memset(sub, 0, sizeof(sub));
+}
@@ -0,0 +1,52 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/uio.h>
+
+/*
+ * In-process AES-128. Keys and blocks use the FIPS-197 byte order, the most
+ * significant octet first, like the kernel crypto API.
+ */
+struct bt_aes_key {
+	uint8_t rk[176];	/* Round keys */
+	uint32_t sk[11][8];	/* Round keys in bitsliced form */
+};
+
+bool bt_aes_has_hw(void);
+
+/*
+ * AES-NI is used whenever the CPU has it. Keys are only expanded for the
+ * implementation in use, so they have to be set again after switching.
+ */
+bool bt_aes_set_hw(bool enable);
+
+void bt_aes_set_key(struct bt_aes_key *key, const uint8_t k[16]);
+void bt_aes_encrypt(const struct bt_aes_key *key, const uint8_t in[16],
+							uint8_t out[16]);
+
+/* Encrypts the same block under each of count keys */
+void bt_aes_encrypt_batch(const struct bt_aes_key *keys, size_t count,
+				const uint8_t in[16], uint8_t (*out)[16]);
+
+void bt_aes_cmac(const uint8_t k[16], const struct iovec *iov, size_t iov_cnt,
+							uint8_t mac[16]);
@@ -42,33 +42,49 @@
 #define ATT_OP_CMD_MASK			0x40
 #define ATT_OP_SIGNED_MASK		0x80
 #define ATT_TIMEOUT_INTERVAL		30000  /* 30000 ms */
+#define ATT_WRITE_BATCH			16  /* Max PDUs written per wakeup */
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
 
 /* Length of signature in write signed packet */
 #define BT_ATT_SIGNATURE_LEN		12
 
 struct att_send_op;
+struct bt_att_chan;
 
 struct bt_att {
 	int ref_count;
-	int fd;
-	struct io *io;
-	bool io_on_l2cap;
-	int io_sec_level;		/* Only used for non-L2CAP */
+	struct queue *chans;		/* Bearers, the fixed channel first */
+	struct bt_att_chan *fixed;	/* LE/BR-EDR fixed ATT channel */
+	bool close_on_unref;
 
 	struct queue *req_queue;	/* Queued ATT protocol requests */
-	struct att_send_op *pending_req;
 	struct queue *ind_queue;	/* Queued ATT protocol indications */
-	struct att_send_op *pending_ind;
 	struct queue *write_queue;	/* Queue of PDUs ready to send */
-	bool writer_active;
+	unsigned int write_wakeups;	/* Write-ready wakeups that sent PDUs */
+	unsigned int write_pdus;	/* PDUs sent across those wakeups */
 
 	struct queue *notify_list;	/* List of registered callbacks */
 	struct queue *disconn_list;	/* List of disconnect handlers */
 
-	bool in_req;			/* There's a pending incoming request */
+	/*
+	 * Incoming requests are handed to the upper layer one at a time so
+	 * that a response can be routed back to the bearer the request came
+	 * in on. Requests arriving on other bearers meanwhile wait in
+	 * req_waiting.
+	 */
+	struct bt_att_chan *req_chan;
+	struct queue *req_waiting;
 
-	uint8_t *buf;
-	uint16_t mtu;
+	/*
+	 * Confirmations go back on the bearer the indication came in on:
+	 * ind_chan while the indication is being handed up, otherwise the
+	 * oldest unconfirmed one in ind_waiting.
+	 */
+	struct bt_att_chan *ind_chan;
+	struct queue *ind_waiting;
+
+	uint16_t mtu;			/* Smallest MTU of all bearers */
 
 	unsigned int next_send_id;	/* IDs for "send" ops */
 	unsigned int next_reg_id;	/* IDs for registered callbacks */
@@ -88,6 +104,28 @@ struct bt_att {
 	struct sign_info *remote_sign;
 };
 
+struct bt_att_chan {
+	struct bt_att *att;
+	int fd;
+	struct io *io;
+	bool eatt;			/* L2CAP enhanced credit based channel */
+	bool io_on_l2cap;
+	int io_sec_level;		/* Only used for non-L2CAP */
+
+	struct att_send_op *pending_req;
+	struct att_send_op *pending_ind;
+	struct queue *queue;		/* Responses owed on this bearer */
+	bool writer_active;
+
+	bool in_req;			/* There's a pending incoming request */
+	bool in_ind;			/* Indication waiting to be confirmed */
+	uint8_t *in_pdu;		/* Request waiting for its turn */
+	uint16_t in_len;
+
+	uint8_t *buf;
+	uint16_t mtu;
+};
+
 struct sign_info {
 	uint8_t key[16];
 	bt_att_counter_func_t counter;
@@ -136,6 +174,9 @@ static const struct {
 	{ BT_ATT_OP_HANDLE_VAL_NOT,		ATT_OP_TYPE_NOT },
 	{ BT_ATT_OP_HANDLE_VAL_IND,		ATT_OP_TYPE_IND },
 	{ BT_ATT_OP_HANDLE_VAL_CONF,		ATT_OP_TYPE_CONF },
+	{ BT_ATT_OP_READ_MULT_VL_REQ,		ATT_OP_TYPE_REQ },
+	{ BT_ATT_OP_READ_MULT_VL_RSP,		ATT_OP_TYPE_RSP },
+	{ BT_ATT_OP_HANDLE_NFY_MULT,		ATT_OP_TYPE_NOT },
 	{ }
 };
 
@@ -162,6 +203,7 @@ static const struct {
 	{ BT_ATT_OP_READ_REQ,			BT_ATT_OP_READ_RSP },
 	{ BT_ATT_OP_READ_BLOB_REQ,		BT_ATT_OP_READ_BLOB_RSP },
 	{ BT_ATT_OP_READ_MULT_REQ,		BT_ATT_OP_READ_MULT_RSP },
+	{ BT_ATT_OP_READ_MULT_VL_REQ,		BT_ATT_OP_READ_MULT_VL_RSP },
 	{ BT_ATT_OP_READ_BY_GRP_TYPE_REQ,	BT_ATT_OP_READ_BY_GRP_TYPE_RSP },
 	{ BT_ATT_OP_WRITE_REQ,			BT_ATT_OP_WRITE_RSP },
 	{ BT_ATT_OP_PREP_WRITE_REQ,		BT_ATT_OP_PREP_WRITE_RSP },
@@ -181,6 +223,12 @@ static uint8_t get_req_opcode(uint8_t rsp_opcode)
 	return 0;
 }
 
+struct bt_att_buf {
+	int ref_count;
+	uint16_t len;
+	uint8_t data[0];
+};
+
 struct att_send_op {
 	unsigned int id;
 	unsigned int timeout_id;
@@ -188,11 +236,23 @@ struct att_send_op {
 	uint16_t opcode;
 	void *pdu;
 	uint16_t len;
+	struct bt_att_buf *buf;
 	bt_att_response_func_t callback;
 	bt_att_destroy_func_t destroy;
 	void *user_data;
 };
 
+static void free_att_send_op(struct att_send_op *op)
+{
+	/* A shared buffer owns the PDU memory */
+	if (op->buf)
+		bt_att_buf_unref(op->buf);
+	else
+		free(op->pdu);
+
+	free(op);
+}
+
 static void destroy_att_send_op(void *data)
 {
 	struct att_send_op *op = data;
@@ -203,8 +263,7 @@ static void destroy_att_send_op(void *data)
 	if (op->destroy)
 		op->destroy(op->user_data);
 
-	free(op->pdu);
-	free(op);
+	free_att_send_op(op);
 }
 
 static void cancel_att_send_op(struct att_send_op *op)
@@ -235,12 +294,11 @@ static void destroy_att_notify(void *data)
 	free(notify);
 }
 
-static bool match_notify_id(const void *a, const void *b)
+static unsigned int notify_key(const void *data)
 {
-	const struct att_notify *notify = a;
-	unsigned int id = PTR_TO_UINT(b);
+	const struct att_notify *notify = data;
 
-	return notify->id == id;
+	return notify->id;
 }
 
 struct att_disconn {
@@ -261,12 +319,11 @@ static void destroy_att_disconn(void *data)
 	free(disconn);
 }
 
-static bool match_disconn_id(const void *a, const void *b)
+static unsigned int disconn_key(const void *data)
 {
-	const struct att_disconn *disconn = a;
-	unsigned int id = PTR_TO_UINT(b);
+	const struct att_disconn *disconn = data;
 
-	return disconn->id == id;
+	return disconn->id;
 }
 
 static bool encode_pdu(struct bt_att *att, struct att_send_op *op,
@@ -312,10 +369,7 @@ fail:
 	return false;
 }
 
-static struct att_send_op *create_att_send_op(struct bt_att *att,
-						uint8_t opcode,
-						const void *pdu,
-						uint16_t length,
+static struct att_send_op *new_att_send_op(uint8_t opcode,
 						bt_att_response_func_t callback,
 						void *user_data,
 						bt_att_destroy_func_t destroy)
@@ -323,9 +377,6 @@ static struct att_send_op *create_att_send_op(struct bt_att *att,
 	struct att_send_op *op;
 	enum att_op_type op_type;
 
-	if (length && !pdu)
-		return NULL;
-
 	op_type = get_op_type(opcode);
 	if (op_type == ATT_OP_TYPE_UNKNOWN)
 		return NULL;
@@ -353,6 +404,26 @@ static struct att_send_op *create_att_send_op(struct bt_att *att,
 	op->destroy = destroy;
 	op->user_data = user_data;
 
+	return op;
+}
+
+static struct att_send_op *create_att_send_op(struct bt_att *att,
+						uint8_t opcode,
+						const void *pdu,
+						uint16_t length,
+						bt_att_response_func_t callback,
+						void *user_data,
+						bt_att_destroy_func_t destroy)
+{
+	struct att_send_op *op;
+
+	if (length && !pdu)
+		return NULL;
+
+	op = new_att_send_op(opcode, callback, user_data, destroy);
+	if (!op)
+		return NULL;
+
 	if (!encode_pdu(att, op, pdu, length)) {
 		free(op);
 		return NULL;
@@ -361,53 +432,83 @@ static struct att_send_op *create_att_send_op(struct bt_att *att,
 	return op;
 }
 
-static struct att_send_op *pick_next_send_op(struct bt_att *att)
+/*
+ * Requests that only make sense on the fixed channel: the MTU is exchanged
+ * per bearer by L2CAP on enhanced channels, and the prepare queue of the
+ * remote lives on the bearer the prepared writes were sent on.
+ */
+static bool op_needs_fixed_chan(struct att_send_op *op)
 {
-	struct att_send_op *op;
+	switch (op->opcode) {
+	case BT_ATT_OP_MTU_REQ:
+	case BT_ATT_OP_PREP_WRITE_REQ:
+	case BT_ATT_OP_EXEC_WRITE_REQ:
+		return true;
+	default:
+		return false;
+	}
+}
 
-	/* See if any operations are already in the write queue */
-	op = queue_pop_head(att->write_queue);
-	if (op)
-		return op;
+static bool chan_can_take(struct bt_att_chan *chan, struct queue *queue)
+{
+	struct att_send_op *op = queue_peek_head(queue);
+
+	if (!op)
+		return false;
+
+	if (op->len > chan->mtu)
+		return false;
 
-	/* If there is no pending request, pick an operation from the
-	 * request queue.
+	return !chan->eatt || !op_needs_fixed_chan(op);
+}
+
+static struct att_send_op *pick_next_send_op(struct bt_att_chan *chan)
+{
+	struct bt_att *att = chan->att;
+
+	/* Responses and confirmations owed on this bearer go first */
+	if (!queue_isempty(chan->queue))
+		return queue_pop_head(chan->queue);
+
+	/* Commands and notifications stay on the fixed channel so that they
+	 * keep their relative order.
 	 */
-	if (!att->pending_req) {
-		op = queue_pop_head(att->req_queue);
-		if (op)
-			return op;
-	}
+	if (chan == att->fixed && !queue_isempty(att->write_queue))
+		return queue_pop_head(att->write_queue);
+
+	/* If there is no pending request on this bearer, pick an operation
+	 * from the request queue.
+	 */
+	if (!chan->pending_req && chan_can_take(chan, att->req_queue))
+		return queue_pop_head(att->req_queue);
 
 	/* There is either a request pending or no requests queued. If there is
 	 * no pending indication, pick an operation from the indication queue.
 	 */
-	if (!att->pending_ind) {
-		op = queue_pop_head(att->ind_queue);
-		if (op)
-			return op;
-	}
+	if (!chan->pending_ind && chan_can_take(chan, att->ind_queue))
+		return queue_pop_head(att->ind_queue);
 
 	return NULL;
 }
 
 struct timeout_data {
-	struct bt_att *att;
+	struct bt_att_chan *chan;
 	unsigned int id;
 };
 
 static bool timeout_cb(void *user_data)
 {
 	struct timeout_data *timeout = user_data;
-	struct bt_att *att = timeout->att;
+	struct bt_att_chan *chan = timeout->chan;
+	struct bt_att *att = chan->att;
 	struct att_send_op *op = NULL;
 
-	if (att->pending_req && att->pending_req->id == timeout->id) {
-		op = att->pending_req;
-		att->pending_req = NULL;
-	} else if (att->pending_ind && att->pending_ind->id == timeout->id) {
-		op = att->pending_ind;
-		att->pending_ind = NULL;
+	if (chan->pending_req && chan->pending_req->id == timeout->id) {
+		op = chan->pending_req;
+		chan->pending_req = NULL;
+	} else if (chan->pending_ind && chan->pending_ind->id == timeout->id) {
+		op = chan->pending_ind;
+		chan->pending_ind = NULL;
 	}
 
 	if (!op)
@@ -423,68 +524,73 @@ static bool timeout_cb(void *user_data)
 	destroy_att_send_op(op);
 
 	/*
-	 * Directly terminate the connection as required by the ATT protocol.
+	 * Directly terminate the bearer as required by the ATT protocol.
 	 * This should trigger an io disconnect event which will clean up the
 	 * io and notify the upper layer.
 	 */
-	io_shutdown(att->io);
+	io_shutdown(chan->io);
 
 	return false;
 }
 
 static void write_watch_destroy(void *user_data)
 {
-	struct bt_att *att = user_data;
+	struct bt_att_chan *chan = user_data;
 
-	att->writer_active = false;
+	chan->writer_active = false;
 }
 
-static bool can_write_data(struct io *io, void *user_data)
+static void requeue_send_op(struct bt_att_chan *chan, struct att_send_op *op)
 {
-	struct bt_att *att = user_data;
-	struct att_send_op *op;
-	struct timeout_data *timeout;
-	ssize_t ret;
-	struct iovec iov;
-
-	op = pick_next_send_op(att);
-	if (!op)
-		return false;
+	struct bt_att *att = chan->att;
 
-	iov.iov_base = op->pdu;
-	iov.iov_len = op->len;
-
-	ret = io_send(io, &iov, 1);
-	if (ret < 0) {
-		util_debug(att->debug_callback, att->debug_data,
-					"write failed: %s", strerror(-ret));
-		if (op->callback)
-			op->callback(BT_ATT_OP_ERROR_RSP, NULL, 0,
-							op->user_data);
-
-		destroy_att_send_op(op);
-		return true;
+	switch (op->type) {
+	case ATT_OP_TYPE_REQ:
+		chan->pending_req = NULL;
+		queue_push_head(att->req_queue, op);
+		break;
+	case ATT_OP_TYPE_IND:
+		chan->pending_ind = NULL;
+		queue_push_head(att->ind_queue, op);
+		break;
+	case ATT_OP_TYPE_RSP:
+	case ATT_OP_TYPE_CONF:
+		queue_push_head(chan->queue, op);
+		break;
+	case ATT_OP_TYPE_CMD:
+	case ATT_OP_TYPE_NOT:
+	case ATT_OP_TYPE_UNKNOWN:
+	default:
+		queue_push_head(att->write_queue, op);
+		break;
 	}
+}
+
+static void write_op_done(struct bt_att_chan *chan, struct att_send_op *op)
+{
+	struct bt_att *att = chan->att;
+	struct timeout_data *timeout;
 
 	util_debug(att->debug_callback, att->debug_data,
 					"ATT op 0x%02x", op->opcode);
 
-	util_hexdump('<', op->pdu, ret, att->debug_callback, att->debug_data);
+	util_hexdump('<', op->pdu, op->len, att->debug_callback,
+							att->debug_data);
 
-	/* Based on the operation type, set either the pending request or the
-	 * pending indication. If it came from the write queue, then there is
-	 * no need to keep it around.
+	/* Requests and indications stay around as the pending request or
+	 * pending indication until they are answered. Everything else came
+	 * from the write queue and there is no need to keep it around.
 	 */
 	switch (op->type) {
 	case ATT_OP_TYPE_REQ:
-		att->pending_req = op;
-		break;
 	case ATT_OP_TYPE_IND:
-		att->pending_ind = op;
 		break;
 	case ATT_OP_TYPE_RSP:
 		/* Set in_req to false to indicate that no request is pending */
-		att->in_req = false;
+		chan->in_req = false;
+
+		if (att->req_chan == chan)
+			att->req_chan = NULL;
 
 		/* Fall through to the next case */
 	case ATT_OP_TYPE_CMD:
@@ -493,41 +599,234 @@ static bool can_write_data(struct io *io, void *user_data)
 	case ATT_OP_TYPE_UNKNOWN:
 	default:
 		destroy_att_send_op(op);
-		return true;
+		return;
 	}
 
 	timeout = new0(struct timeout_data, 1);
 	if (!timeout)
-		return true;
+		return;
 
-	timeout->att = att;
+	timeout->chan = chan;
 	timeout->id = op->id;
 	op->timeout_id = timeout_add(ATT_TIMEOUT_INTERVAL, timeout_cb,
 								timeout, free);
+}
+
+static void handle_notify(struct bt_att *att, uint8_t opcode, uint8_t *pdu,
+							ssize_t pdu_len);
+
+static void process_waiting_req(struct bt_att *att)
+{
+	struct bt_att_chan *chan;
+	uint8_t *pdu;
+
+	if (att->req_chan)
+		return;
+
+	chan = queue_pop_head(att->req_waiting);
+	if (!chan)
+		return;
+
+	pdu = chan->in_pdu;
+	chan->in_pdu = NULL;
+	att->req_chan = chan;
+
+	util_debug(att->debug_callback, att->debug_data,
+				"ATT PDU received: 0x%02x", pdu[0]);
+
+	handle_notify(att, pdu[0], pdu + 1, chan->in_len - 1);
+
+	free(pdu);
+}
+
+static bool can_write_data(struct io *io, void *user_data)
+{
+	struct bt_att_chan *chan = user_data;
+	struct bt_att *att = chan->att;
+	struct att_send_op *ops[ATT_WRITE_BATCH];
+	struct iovec iov[ATT_WRITE_BATCH];
+	struct att_send_op *op;
+	int count, sent, i;
+
+	/* Gather as many PDUs as are ready to go out. Requests and indications
+	 * become the pending request or indication as soon as they are picked
+	 * so that there is never more than one of each outstanding.
+	 */
+	for (count = 0; count < ATT_WRITE_BATCH; count++) {
+		op = pick_next_send_op(chan);
+		if (!op)
+			break;
+
+		if (op->type == ATT_OP_TYPE_REQ)
+			chan->pending_req = op;
+		else if (op->type == ATT_OP_TYPE_IND)
+			chan->pending_ind = op;
+
+		ops[count] = op;
+		iov[count].iov_base = op->pdu;
+		iov[count].iov_len = op->len;
+	}
+
+	if (!count)
+		return false;
+
+	sent = io_send_batch(io, iov, count);
+
+	/* A full socket buffer is not an error, nothing went out and it all
+	 * gets retried on the next write-ready wakeup.
+	 */
+	if (sent == -EAGAIN || sent == -EWOULDBLOCK)
+		sent = 0;
+
+	/* Put back whatever did not make it out, last one first so that the
+	 * queues keep their original order. On a real error the first one is
+	 * failed below instead.
+	 */
+	for (i = count - 1; i >= (sent < 0 ? 1 : sent); i--)
+		requeue_send_op(chan, ops[i]);
+
+	if (!sent)
+		return true;
+
+	if (sent < 0) {
+		op = ops[0];
+
+		util_debug(att->debug_callback, att->debug_data,
+					"write failed: %s", strerror(-sent));
+
+		if (chan->pending_req == op)
+			chan->pending_req = NULL;
+		else if (chan->pending_ind == op)
+			chan->pending_ind = NULL;
+
+		if (op->callback)
+			op->callback(BT_ATT_OP_ERROR_RSP, NULL, 0,
+							op->user_data);
+
+		destroy_att_send_op(op);
+		return true;
+	}
+
+	att->write_wakeups++;
+	att->write_pdus += sent;
+
+	for (i = 0; i < sent; i++)
+		write_op_done(chan, ops[i]);
+
+	/* A response went out, let the next waiting request through */
+	if (!att->req_chan && !queue_isempty(att->req_waiting)) {
+		bt_att_ref(att);
+		process_waiting_req(att);
+		bt_att_unref(att);
+	}
 
 	/* Return true as there may be more operations ready to write. */
 	return true;
 }
 
-static void wakeup_writer(struct bt_att *att)
+static bool chan_has_work(struct bt_att_chan *chan)
 {
-	if (att->writer_active)
+	struct bt_att *att = chan->att;
+
+	if (!queue_isempty(chan->queue))
+		return true;
+
+	if (chan == att->fixed && !queue_isempty(att->write_queue))
+		return true;
+
+	if (!chan->pending_req && chan_can_take(chan, att->req_queue))
+		return true;
+
+	return !chan->pending_ind && chan_can_take(chan, att->ind_queue);
+}
+
+static void wakeup_chan_writer(void *data, void *user_data)
+{
+	struct bt_att_chan *chan = data;
+
+	if (chan->writer_active)
 		return;
 
 	/* Set the write handler only if there is anything that can be sent
-	 * at all.
+	 * on this bearer at all.
 	 */
-	if (queue_isempty(att->write_queue)) {
-		if ((att->pending_req || queue_isempty(att->req_queue)) &&
-			(att->pending_ind || queue_isempty(att->ind_queue)))
-			return;
-	}
+	if (!chan_has_work(chan))
+		return;
 
-	if (!io_set_write_handler(att->io, can_write_data, att,
+	if (!io_set_write_handler(chan->io, can_write_data, chan,
 							write_watch_destroy))
 		return;
 
-	att->writer_active = true;
+	chan->writer_active = true;
+}
+
+static void wakeup_writer(struct bt_att *att)
+{
+	/* Idle bearers race for queued requests, whichever becomes writable
+	 * first takes the next one.
+	 */
+	queue_foreach(att->chans, wakeup_chan_writer, NULL);
+}
+
+static void update_mtu(struct bt_att *att)
+{
+	const struct queue_entry *entry;
+	uint16_t mtu = UINT16_MAX;
+
+	for (entry = queue_get_entries(att->chans); entry;
+							entry = entry->next) {
+		struct bt_att_chan *chan = entry->data;
+
+		mtu = MIN(mtu, chan->mtu);
+	}
+
+	att->mtu = mtu == UINT16_MAX ? BT_ATT_DEFAULT_LE_MTU : mtu;
+}
+
+static void fail_pending_op(struct att_send_op *op)
+{
+	if (!op)
+		return;
+
+	if (op->callback)
+		op->callback(BT_ATT_OP_ERROR_RSP, NULL, 0, op->user_data);
+
+	destroy_att_send_op(op);
+}
+
+static void chan_free(struct bt_att_chan *chan)
+{
+	if (chan->pending_req)
+		destroy_att_send_op(chan->pending_req);
+
+	if (chan->pending_ind)
+		destroy_att_send_op(chan->pending_ind);
+
+	queue_destroy(chan->queue, destroy_att_send_op);
+	io_destroy(chan->io);
+	free(chan->in_pdu);
+	free(chan->buf);
+	free(chan);
+}
+
+static void chan_detach(struct bt_att_chan *chan)
+{
+	struct bt_att *att = chan->att;
+
+	queue_remove(att->chans, chan);
+	queue_remove(att->req_waiting, chan);
+	queue_remove(att->ind_waiting, chan);
+
+	if (att->req_chan == chan)
+		att->req_chan = NULL;
+
+	if (att->ind_chan == chan)
+		att->ind_chan = NULL;
+
+	if (att->fixed == chan)
+		att->fixed = NULL;
+
+	update_mtu(att);
 }
 
 static void disconn_handler(void *data, void *user_data)
@@ -542,15 +841,55 @@ static void disconn_handler(void *data, void *user_data)
 		disconn->callback(err, disconn->user_data);
 }
 
+static void eatt_disconnect(struct bt_att_chan *chan)
+{
+	struct bt_att *att = chan->att;
+	struct att_send_op *req = chan->pending_req;
+	struct att_send_op *ind = chan->pending_ind;
+
+	util_debug(att->debug_callback, att->debug_data,
+				"Enhanced ATT bearer %d disconnected", chan->fd);
+
+	/* The remote may have acted on whatever was in flight on the bearer,
+	 * so fail it instead of retrying on another one.
+	 */
+	chan->pending_req = NULL;
+	chan->pending_ind = NULL;
+	chan_detach(chan);
+
+	bt_att_ref(att);
+
+	fail_pending_op(req);
+	fail_pending_op(ind);
+	chan_free(chan);
+
+	process_waiting_req(att);
+	wakeup_writer(att);
+
+	bt_att_unref(att);
+}
+
+static void chan_destroy(struct bt_att_chan *chan)
+{
+	chan_detach(chan);
+	chan_free(chan);
+}
+
 static bool disconnect_cb(struct io *io, void *user_data)
 {
-	struct bt_att *att = user_data;
+	struct bt_att_chan *chan = user_data;
+	struct bt_att *att = chan->att;
 	int err;
 	socklen_t len;
 
+	if (chan->eatt) {
+		eatt_disconnect(chan);
+		return false;
+	}
+
 	len = sizeof(err);
 
-	if (getsockopt(att->fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0) {
+	if (getsockopt(chan->fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0) {
 		util_debug(att->debug_callback, att->debug_data,
 					"Failed to obtain disconnect error: %s",
 					strerror(errno));
@@ -561,11 +900,14 @@ static bool disconnect_cb(struct io *io, void *user_data)
 					"Physical link disconnected: %s",
 					strerror(err));
 
-	io_destroy(att->io);
-	att->io = NULL;
-
 	bt_att_cancel_all(att);
 
+	/* Enhanced bearers share the link with the fixed channel, drop them
+	 * all together.
+	 */
+	while ((chan = queue_peek_head(att->chans)))
+		chan_destroy(chan);
+
 	bt_att_ref(att);
 
 	queue_foreach(att->disconn_list, disconn_handler, INT_TO_PTR(err));
@@ -596,11 +938,12 @@ static bool change_security(struct bt_att *att, uint8_t ecode)
 	return bt_att_set_security(att, security);
 }
 
-static bool handle_error_rsp(struct bt_att *att, uint8_t *pdu,
+static bool handle_error_rsp(struct bt_att_chan *chan, uint8_t *pdu,
 					ssize_t pdu_len, uint8_t *opcode)
 {
+	struct bt_att *att = chan->att;
 	const struct bt_att_pdu_error_rsp *rsp;
-	struct att_send_op *op = att->pending_req;
+	struct att_send_op *op = chan->pending_req;
 
 	if (pdu_len != sizeof(*rsp)) {
 		*opcode = 0;
@@ -618,16 +961,23 @@ static bool handle_error_rsp(struct bt_att *att, uint8_t *pdu,
 	util_debug(att->debug_callback, att->debug_data,
 						"Retrying operation %p", op);
 
-	att->pending_req = NULL;
+	chan->pending_req = NULL;
+
+	/* The timer refers to this bearer, it is armed again on resend */
+	if (op->timeout_id) {
+		timeout_remove(op->timeout_id);
+		op->timeout_id = 0;
+	}
 
 	/* Push operation back to request queue */
 	return queue_push_head(att->req_queue, op);
 }
 
-static void handle_rsp(struct bt_att *att, uint8_t opcode, uint8_t *pdu,
+static void handle_rsp(struct bt_att_chan *chan, uint8_t opcode, uint8_t *pdu,
 								ssize_t pdu_len)
 {
-	struct att_send_op *op = att->pending_req;
+	struct bt_att *att = chan->att;
+	struct att_send_op *op = chan->pending_req;
 	uint8_t req_opcode;
 	uint8_t rsp_opcode;
 	uint8_t *rsp_pdu = NULL;
@@ -640,7 +990,7 @@ static void handle_rsp(struct bt_att *att, uint8_t opcode, uint8_t *pdu,
 	if (!op) {
 		util_debug(att->debug_callback, att->debug_data,
 					"Received unexpected ATT response");
-		io_shutdown(att->io);
+		io_shutdown(chan->io);
 		return;
 	}
 
@@ -650,7 +1000,7 @@ static void handle_rsp(struct bt_att *att, uint8_t opcode, uint8_t *pdu,
 	 */
 	if (opcode == BT_ATT_OP_ERROR_RSP) {
 		/* Return if error response cause a retry */
-		if (handle_error_rsp(att, pdu, pdu_len, &req_opcode)) {
+		if (handle_error_rsp(chan, pdu, pdu_len, &req_opcode)) {
 			wakeup_writer(att);
 			return;
 		}
@@ -680,14 +1030,16 @@ done:
 		op->callback(rsp_opcode, rsp_pdu, rsp_pdu_len, op->user_data);
 
 	destroy_att_send_op(op);
-	att->pending_req = NULL;
+	chan->pending_req = NULL;
 
 	wakeup_writer(att);
 }
 
-static void handle_conf(struct bt_att *att, uint8_t *pdu, ssize_t pdu_len)
+static void handle_conf(struct bt_att_chan *chan, uint8_t *pdu,
+							ssize_t pdu_len)
 {
-	struct att_send_op *op = att->pending_ind;
+	struct bt_att *att = chan->att;
+	struct att_send_op *op = chan->pending_ind;
 
 	/*
 	 * Disconnect the bearer if the confirmation is unexpected or the PDU is
@@ -696,7 +1048,7 @@ static void handle_conf(struct bt_att *att, uint8_t *pdu, ssize_t pdu_len)
 	if (!op || pdu_len) {
 		util_debug(att->debug_callback, att->debug_data,
 				"Received unexpected/invalid ATT confirmation");
-		io_shutdown(att->io);
+		io_shutdown(chan->io);
 		return;
 	}
 
@@ -704,7 +1056,7 @@ static void handle_conf(struct bt_att *att, uint8_t *pdu, ssize_t pdu_len)
 		op->callback(BT_ATT_OP_HANDLE_VAL_CONF, NULL, 0, op->user_data);
 
 	destroy_att_send_op(op);
-	att->pending_ind = NULL;
+	chan->pending_ind = NULL;
 
 	wakeup_writer(att);
 }
@@ -822,24 +1174,49 @@ static void handle_notify(struct bt_att *att, uint8_t opcode, uint8_t *pdu,
 	bt_att_unref(att);
 }
 
+static bool defer_req(struct bt_att_chan *chan, uint8_t *pdu, ssize_t len)
+{
+	struct bt_att *att = chan->att;
+
+	chan->in_pdu = malloc(len);
+	if (!chan->in_pdu)
+		return false;
+
+	memcpy(chan->in_pdu, pdu, len);
+	chan->in_len = len;
+
+	if (!queue_push_tail(att->req_waiting, chan)) {
+		free(chan->in_pdu);
+		chan->in_pdu = NULL;
+		return false;
+	}
+
+	util_debug(att->debug_callback, att->debug_data,
+			"ATT request 0x%02x waiting for another bearer",
+			pdu[0]);
+
+	return true;
+}
+
 static bool can_read_data(struct io *io, void *user_data)
 {
-	struct bt_att *att = user_data;
+	struct bt_att_chan *chan = user_data;
+	struct bt_att *att = chan->att;
 	uint8_t opcode;
 	uint8_t *pdu;
 	ssize_t bytes_read;
 
-	bytes_read = read(att->fd, att->buf, att->mtu);
+	bytes_read = read(chan->fd, chan->buf, chan->mtu);
 	if (bytes_read < 0)
 		return false;
 
-	util_hexdump('>', att->buf, bytes_read,
+	util_hexdump('>', chan->buf, bytes_read,
 					att->debug_callback, att->debug_data);
 
 	if (bytes_read < ATT_MIN_PDU_LEN)
 		return true;
 
-	pdu = att->buf;
+	pdu = chan->buf;
 	opcode = pdu[0];
 
 	bt_att_ref(att);
@@ -849,12 +1226,12 @@ static bool can_read_data(struct io *io, void *user_data)
 	case ATT_OP_TYPE_RSP:
 		util_debug(att->debug_callback, att->debug_data,
 				"ATT response received: 0x%02x", opcode);
-		handle_rsp(att, opcode, pdu + 1, bytes_read - 1);
+		handle_rsp(chan, opcode, pdu + 1, bytes_read - 1);
 		break;
 	case ATT_OP_TYPE_CONF:
 		util_debug(att->debug_callback, att->debug_data,
 				"ATT confirmation received: 0x%02x", opcode);
-		handle_conf(att, pdu + 1, bytes_read - 1);
+		handle_conf(chan, pdu + 1, bytes_read - 1);
 		break;
 	case ATT_OP_TYPE_REQ:
 		/*
@@ -862,24 +1239,48 @@ static bool can_read_data(struct io *io, void *user_data)
 		 * protocol was violated. Disconnect the bearer, which will
 		 * promptly notify the upper layer via disconnect handlers.
 		 */
-		if (att->in_req) {
+		if (chan->in_req) {
 			util_debug(att->debug_callback, att->debug_data,
 					"Received request while another is "
 					"pending: 0x%02x", opcode);
-			io_shutdown(att->io);
+			io_shutdown(chan->io);
 			bt_att_unref(att);
 
 			return false;
 		}
 
-		att->in_req = true;
+		chan->in_req = true;
 
-		/* Fall through to the next case */
+		/* Another bearer's request is still being served */
+		if (att->req_chan) {
+			if (!defer_req(chan, pdu, bytes_read))
+				io_shutdown(chan->io);
+			break;
+		}
+
+		att->req_chan = chan;
+
+		goto notify;
+	case ATT_OP_TYPE_IND:
+		if (!chan->in_ind && !queue_push_tail(att->ind_waiting, chan)) {
+			io_shutdown(chan->io);
+			break;
+		}
+
+		chan->in_ind = true;
+		att->ind_chan = chan;
+
+		util_debug(att->debug_callback, att->debug_data,
+					"ATT PDU received: 0x%02x", opcode);
+		handle_notify(att, opcode, pdu + 1, bytes_read - 1);
+
+		att->ind_chan = NULL;
+		break;
 	case ATT_OP_TYPE_CMD:
 	case ATT_OP_TYPE_NOT:
 	case ATT_OP_TYPE_UNKNOWN:
-	case ATT_OP_TYPE_IND:
 	default:
+notify:
 		/* For all other opcodes notify the upper layer of the PDU and
 		 * let them act on it.
 		 */
@@ -919,17 +1320,91 @@ static bool is_io_l2cap_based(int fd)
 	return proto == BTPROTO_L2CAP;
 }
 
+static uint16_t get_l2cap_mtu(int fd)
+{
+	uint16_t snd = 0, rcv = 0;
+	socklen_t len;
+
+	len = sizeof(snd);
+	if (getsockopt(fd, SOL_BLUETOOTH, BT_SNDMTU, &snd, &len) < 0)
+		return 0;
+
+	len = sizeof(rcv);
+	if (getsockopt(fd, SOL_BLUETOOTH, BT_RCVMTU, &rcv, &len) < 0)
+		return 0;
+
+	return MIN(snd, rcv);
+}
+
+static struct bt_att_chan *chan_new(struct bt_att *att, int fd, bool eatt)
+{
+	struct bt_att_chan *chan;
+
+	chan = new0(struct bt_att_chan, 1);
+	if (!chan)
+		return NULL;
+
+	chan->att = att;
+	chan->fd = fd;
+	chan->eatt = eatt;
+	chan->io_on_l2cap = is_io_l2cap_based(fd);
+	if (!chan->io_on_l2cap)
+		chan->io_sec_level = BT_SECURITY_LOW;
+
+	/* The MTU of an enhanced bearer is set up by L2CAP. Local transports
+	 * used for testing have no limit of their own.
+	 */
+	if (!eatt)
+		chan->mtu = BT_ATT_DEFAULT_LE_MTU;
+	else if (chan->io_on_l2cap)
+		chan->mtu = get_l2cap_mtu(fd);
+	else
+		chan->mtu = BT_ATT_MAX_LE_MTU;
+
+	if (chan->mtu < BT_ATT_DEFAULT_LE_MTU)
+		goto fail;
+
+	chan->buf = malloc(chan->mtu);
+	if (!chan->buf)
+		goto fail;
+
+	chan->queue = queue_new_ring(0);
+	if (!chan->queue)
+		goto fail;
+
+	chan->io = io_new(fd);
+	if (!chan->io)
+		goto fail;
+
+	if (!io_set_read_handler(chan->io, can_read_data, chan, NULL))
+		goto fail;
+
+	if (!io_set_disconnect_handler(chan->io, disconnect_cb, chan, NULL))
+		goto fail;
+
+	if (att->close_on_unref)
+		io_set_close_on_destroy(chan->io, true);
+
+	return chan;
+
+fail:
+	chan_free(chan);
+
+	return NULL;
+}
+
 static void bt_att_free(struct bt_att *att)
 {
-	if (att->pending_req)
-		destroy_att_send_op(att->pending_req);
+	struct bt_att_chan *chan;
 
-	if (att->pending_ind)
-		destroy_att_send_op(att->pending_ind);
+	while ((chan = queue_peek_head(att->chans)))
+		chan_destroy(chan);
 
-	io_destroy(att->io);
 	bt_crypto_unref(att->crypto);
 
+	queue_destroy(att->chans, NULL);
+	queue_destroy(att->req_waiting, NULL);
+	queue_destroy(att->ind_waiting, NULL);
 	queue_destroy(att->req_queue, NULL);
 	queue_destroy(att->ind_queue, NULL);
 	queue_destroy(att->write_queue, NULL);
@@ -945,8 +1420,6 @@ static void bt_att_free(struct bt_att *att)
 	free(att->local_sign);
 	free(att->remote_sign);
 
-	free(att->buf);
-
 	free(att);
 }
 
@@ -961,50 +1434,54 @@ struct bt_att *bt_att_new(int fd, bool ext_signed)
 	if (!att)
 		return NULL;
 
-	att->fd = fd;
 	att->ext_signed = ext_signed;
 	att->mtu = BT_ATT_DEFAULT_LE_MTU;
-	att->buf = malloc(att->mtu);
-	if (!att->buf)
+
+	att->chans = queue_new();
+	if (!att->chans)
 		goto fail;
 
-	att->io = io_new(fd);
-	if (!att->io)
+	att->req_waiting = queue_new();
+	if (!att->req_waiting)
+		goto fail;
+
+	att->ind_waiting = queue_new();
+	if (!att->ind_waiting)
 		goto fail;
 
 	/* crypto is optional, if not available leave it NULL */
 	if (!ext_signed)
 		att->crypto = bt_crypto_new();
 
-	att->req_queue = queue_new();
+	att->req_queue = queue_new_ring(0);
 	if (!att->req_queue)
 		goto fail;
 
-	att->ind_queue = queue_new();
+	att->ind_queue = queue_new_ring(0);
 	if (!att->ind_queue)
 		goto fail;
 
-	att->write_queue = queue_new();
+	att->write_queue = queue_new_ring(0);
 	if (!att->write_queue)
 		goto fail;
 
-	att->notify_list = queue_new();
+	att->notify_list = queue_new_keyed(notify_key);
 	if (!att->notify_list)
 		goto fail;
 
-	att->disconn_list = queue_new();
+	att->disconn_list = queue_new_keyed(disconn_key);
 	if (!att->disconn_list)
 		goto fail;
 
-	if (!io_set_read_handler(att->io, can_read_data, att, NULL))
+	att->fixed = chan_new(att, fd, false);
+	if (!att->fixed)
 		goto fail;
 
-	if (!io_set_disconnect_handler(att->io, disconnect_cb, att, NULL))
+	if (!queue_push_tail(att->chans, att->fixed)) {
+		chan_free(att->fixed);
+		att->fixed = NULL;
 		goto fail;
-
-	att->io_on_l2cap = is_io_l2cap_based(att->fd);
-	if (!att->io_on_l2cap)
-		att->io_sec_level = BT_SECURITY_LOW;
+	}
 
 	return bt_att_ref(att);
 
@@ -1014,6 +1491,45 @@ fail:
 	return NULL;
 }
 
+int bt_att_attach_fd(struct bt_att *att, int fd)
+{
+	struct bt_att_chan *chan;
+
+	if (!att || fd < 0)
+		return -EINVAL;
+
+	if (!att->fixed)
+		return -ENOTCONN;
+
+	chan = chan_new(att, fd, true);
+	if (!chan)
+		return -ENOMEM;
+
+	if (!queue_push_tail(att->chans, chan)) {
+		chan_free(chan);
+		return -ENOMEM;
+	}
+
+	update_mtu(att);
+
+	util_debug(att->debug_callback, att->debug_data,
+				"Enhanced ATT bearer %d attached, MTU %u",
+				fd, chan->mtu);
+
+	/* Let the new bearer pick up whatever is queued */
+	wakeup_writer(att);
+
+	return 0;
+}
+
+int bt_att_get_channels(struct bt_att *att)
+{
+	if (!att)
+		return 0;
+
+	return queue_length(att->chans);
+}
+
 struct bt_att *bt_att_ref(struct bt_att *att)
 {
 	if (!att)
@@ -1038,20 +1554,30 @@ void bt_att_unref(struct bt_att *att)
 	bt_att_free(att);
 }
 
+static void set_close_on_destroy(void *data, void *user_data)
+{
+	struct bt_att_chan *chan = data;
+
+	io_set_close_on_destroy(chan->io, PTR_TO_INT(user_data));
+}
+
 bool bt_att_set_close_on_unref(struct bt_att *att, bool do_close)
 {
-	if (!att || !att->io)
+	if (!att || !att->fixed)
 		return false;
 
-	return io_set_close_on_destroy(att->io, do_close);
+	att->close_on_unref = do_close;
+	queue_foreach(att->chans, set_close_on_destroy, INT_TO_PTR(do_close));
+
+	return true;
 }
 
 int bt_att_get_fd(struct bt_att *att)
 {
-	if (!att)
+	if (!att || !att->fixed)
 		return -1;
 
-	return att->fd;
+	return att->fixed->fd;
 }
 
 bool bt_att_set_debug(struct bt_att *att, bt_att_debug_func_t callback,
@@ -1080,9 +1606,10 @@ uint16_t bt_att_get_mtu(struct bt_att *att)
 
 bool bt_att_set_mtu(struct bt_att *att, uint16_t mtu)
 {
+	struct bt_att_chan *chan;
 	void *buf;
 
-	if (!att)
+	if (!att || !att->fixed)
 		return false;
 
 	if (mtu < BT_ATT_DEFAULT_LE_MTU)
@@ -1092,10 +1619,29 @@ bool bt_att_set_mtu(struct bt_att *att, uint16_t mtu)
 	if (!buf)
 		return false;
 
-	free(att->buf);
+	/* Only the fixed channel exchanges its MTU over ATT */
+	chan = att->fixed;
+	free(chan->buf);
+
+	chan->mtu = mtu;
+	chan->buf = buf;
+
+	update_mtu(att);
+
+	return true;
+}
+
+bool bt_att_get_write_stats(struct bt_att *att, unsigned int *wakeups,
+							unsigned int *pdus)
+{
+	if (!att)
+		return false;
+
+	if (wakeups)
+		*wakeups = att->write_wakeups;
 
-	att->mtu = mtu;
-	att->buf = buf;
+	if (pdus)
+		*pdus = att->write_pdus;
 
 	return true;
 }
@@ -1124,7 +1670,7 @@ unsigned int bt_att_register_disconnect(struct bt_att *att,
 {
 	struct att_disconn *disconn;
 
-	if (!att || !att->io)
+	if (!att || !att->fixed)
 		return 0;
 
 	disconn = new0(struct att_disconn, 1);
@@ -1155,8 +1701,7 @@ bool bt_att_unregister_disconnect(struct bt_att *att, unsigned int id)
 	if (!att || !id)
 		return false;
 
-	disconn = queue_remove_if(att->disconn_list, match_disconn_id,
-							UINT_TO_PTR(id));
+	disconn = queue_remove_by_key(att->disconn_list, id);
 	if (!disconn)
 		return false;
 
@@ -1164,22 +1709,11 @@ bool bt_att_unregister_disconnect(struct bt_att *att, unsigned int id)
 	return true;
 }
 
-unsigned int bt_att_send(struct bt_att *att, uint8_t opcode,
-				const void *pdu, uint16_t length,
-				bt_att_response_func_t callback, void *user_data,
-				bt_att_destroy_func_t destroy)
+static unsigned int queue_send_op(struct bt_att *att, struct att_send_op *op)
 {
-	struct att_send_op *op;
+	struct bt_att_chan *chan;
 	bool result;
 
-	if (!att || !att->io)
-		return 0;
-
-	op = create_att_send_op(att, opcode, pdu, length, callback, user_data,
-								destroy);
-	if (!op)
-		return 0;
-
 	if (att->next_send_id < 1)
 		att->next_send_id = 1;
 
@@ -1193,19 +1727,37 @@ unsigned int bt_att_send(struct bt_att *att, uint8_t opcode,
 	case ATT_OP_TYPE_IND:
 		result = queue_push_tail(att->ind_queue, op);
 		break;
+	case ATT_OP_TYPE_RSP:
+		/* Answer on the bearer the request being served came in on */
+		chan = att->req_chan ? att->req_chan : att->fixed;
+		result = queue_push_tail(chan->queue, op);
+		break;
+	case ATT_OP_TYPE_CONF:
+		chan = att->ind_chan;
+		att->ind_chan = NULL;
+
+		if (chan)
+			queue_remove(att->ind_waiting, chan);
+		else
+			chan = queue_pop_head(att->ind_waiting);
+
+		if (chan)
+			chan->in_ind = false;
+		else
+			chan = att->fixed;
+
+		result = queue_push_tail(chan->queue, op);
+		break;
 	case ATT_OP_TYPE_CMD:
 	case ATT_OP_TYPE_NOT:
 	case ATT_OP_TYPE_UNKNOWN:
-	case ATT_OP_TYPE_RSP:
-	case ATT_OP_TYPE_CONF:
 	default:
 		result = queue_push_tail(att->write_queue, op);
 		break;
 	}
 
 	if (!result) {
-		free(op->pdu);
-		free(op);
+		free_att_send_op(op);
 		return 0;
 	}
 
@@ -1214,6 +1766,138 @@ unsigned int bt_att_send(struct bt_att *att, uint8_t opcode,
 	return op->id;
 }
 
+unsigned int bt_att_send(struct bt_att *att, uint8_t opcode,
+				const void *pdu, uint16_t length,
+				bt_att_response_func_t callback, void *user_data,
+				bt_att_destroy_func_t destroy)
+{
+	struct att_send_op *op;
+
+	if (!att || !att->fixed)
+		return 0;
+
+	op = create_att_send_op(att, opcode, pdu, length, callback, user_data,
+								destroy);
+	if (!op)
+		return 0;
+
+	return queue_send_op(att, op);
+}
+
+unsigned int bt_att_send_buf(struct bt_att *att, struct bt_att_buf *buf,
+				bt_att_response_func_t callback, void *user_data,
+				bt_att_destroy_func_t destroy)
+{
+	struct att_send_op *op;
+	uint16_t len;
+
+	if (!att || !att->fixed || !buf)
+		return 0;
+
+	/* Signatures depend on the bearer, they can't be shared */
+	if (buf->data[0] & ATT_OP_SIGNED_MASK)
+		return 0;
+
+	op = new_att_send_op(buf->data[0], callback, user_data, destroy);
+	if (!op)
+		return 0;
+
+	len = buf->len;
+
+	/* Notifications and indications are truncated to the MTU */
+	if (len > att->mtu) {
+		if (op->type != ATT_OP_TYPE_NOT && op->type != ATT_OP_TYPE_IND) {
+			free(op);
+			return 0;
+		}
+
+		len = att->mtu;
+	}
+
+	op->buf = bt_att_buf_ref(buf);
+	op->pdu = buf->data;
+	op->len = len;
+
+	return queue_send_op(att, op);
+}
+
+struct bt_att_buf *bt_att_buf_new(uint8_t opcode, const struct iovec *iov,
+								int iovcnt)
+{
+	struct bt_att_buf *buf;
+	size_t len = 1;
+	uint8_t *ptr;
+	int i;
+
+	for (i = 0; i < iovcnt; i++)
+		len += iov[i].iov_len;
+
+	if (len > UINT16_MAX)
+		return NULL;
+
+	buf = malloc(sizeof(*buf) + len);
+	if (!buf)
+		return NULL;
+
+	buf->ref_count = 1;
+	buf->len = len;
+	buf->data[0] = opcode;
+
+	ptr = buf->data + 1;
+
+	for (i = 0; i < iovcnt; i++) {
+		if (!iov[i].iov_len)
+			continue;
+
+		memcpy(ptr, iov[i].iov_base, iov[i].iov_len);
+		ptr += iov[i].iov_len;
+	}
+
+	return buf;
+}
+
+struct bt_att_buf *bt_att_buf_ref(struct bt_att_buf *buf)
+{
+	if (!buf)
+		return NULL;
+
+	__sync_fetch_and_add(&buf->ref_count, 1);
+
+	return buf;
+}
+
+void bt_att_buf_unref(struct bt_att_buf *buf)
+{
+	if (!buf)
+		return;
+
+	if (__sync_sub_and_fetch(&buf->ref_count, 1))
+		return;
+
+	free(buf);
+}
+
+unsigned int bt_att_get_pending_writes(struct bt_att *att)
+{
+	const struct queue_entry *entry;
+	unsigned int count;
+
+	if (!att)
+		return 0;
+
+	count = queue_length(att->write_queue) + queue_length(att->req_queue) +
+						queue_length(att->ind_queue);
+
+	for (entry = queue_get_entries(att->chans); entry;
+							entry = entry->next) {
+		struct bt_att_chan *chan = entry->data;
+
+		count += queue_length(chan->queue);
+	}
+
+	return count;
+}
+
 static bool match_op_id(const void *a, const void *b)
 {
 	const struct att_send_op *op = a;
@@ -1222,25 +1906,45 @@ static bool match_op_id(const void *a, const void *b)
 	return op->id == id;
 }
 
-bool bt_att_cancel(struct bt_att *att, unsigned int id)
+static bool chan_cancel(struct bt_att_chan *chan, unsigned int id)
 {
 	struct att_send_op *op;
 
-	if (!att || !id)
-		return false;
-
-	if (att->pending_req && att->pending_req->id == id) {
+	if (chan->pending_req && chan->pending_req->id == id) {
 		/* Don't cancel the pending request; remove it's handlers */
-		cancel_att_send_op(att->pending_req);
+		cancel_att_send_op(chan->pending_req);
 		return true;
 	}
 
-	if (att->pending_ind && att->pending_ind->id == id) {
+	if (chan->pending_ind && chan->pending_ind->id == id) {
 		/* Don't cancel the pending indication; remove it's handlers */
-		cancel_att_send_op(att->pending_ind);
+		cancel_att_send_op(chan->pending_ind);
 		return true;
 	}
 
+	op = queue_remove_if(chan->queue, match_op_id, UINT_TO_PTR(id));
+	if (!op)
+		return false;
+
+	destroy_att_send_op(op);
+
+	return true;
+}
+
+bool bt_att_cancel(struct bt_att *att, unsigned int id)
+{
+	const struct queue_entry *entry;
+	struct att_send_op *op;
+
+	if (!att || !id)
+		return false;
+
+	for (entry = queue_get_entries(att->chans); entry;
+							entry = entry->next) {
+		if (chan_cancel(entry->data, id))
+			return true;
+	}
+
 	op = queue_remove_if(att->req_queue, match_op_id, UINT_TO_PTR(id));
 	if (op)
 		goto done;
@@ -1264,6 +1968,21 @@ done:
 	return true;
 }
 
+static void chan_cancel_all(void *data, void *user_data)
+{
+	struct bt_att_chan *chan = data;
+
+	queue_remove_all(chan->queue, NULL, NULL, destroy_att_send_op);
+
+	if (chan->pending_req)
+		/* Don't cancel the pending request; remove it's handlers */
+		cancel_att_send_op(chan->pending_req);
+
+	if (chan->pending_ind)
+		/* Don't cancel the pending request; remove it's handlers */
+		cancel_att_send_op(chan->pending_ind);
+}
+
 bool bt_att_cancel_all(struct bt_att *att)
 {
 	if (!att)
@@ -1273,13 +1992,7 @@ bool bt_att_cancel_all(struct bt_att *att)
 	queue_remove_all(att->ind_queue, NULL, NULL, destroy_att_send_op);
 	queue_remove_all(att->write_queue, NULL, NULL, destroy_att_send_op);
 
-	if (att->pending_req)
-		/* Don't cancel the pending request; remove it's handlers */
-		cancel_att_send_op(att->pending_req);
-
-	if (att->pending_ind)
-		/* Don't cancel the pending request; remove it's handlers */
-		cancel_att_send_op(att->pending_ind);
+	queue_foreach(att->chans, chan_cancel_all, NULL);
 
 	return true;
 }
@@ -1340,7 +2053,7 @@ unsigned int bt_att_register(struct bt_att *att, uint8_t opcode,
 {
 	struct att_notify *notify;
 
-	if (!att || !callback || !att->io)
+	if (!att || !callback || !att->fixed)
 		return 0;
 
 	notify = new0(struct att_notify, 1);
@@ -1372,8 +2085,7 @@ bool bt_att_unregister(struct bt_att *att, unsigned int id)
 	if (!att || !id)
 		return false;
 
-	notify = queue_remove_if(att->notify_list, match_notify_id,
-							UINT_TO_PTR(id));
+	notify = queue_remove_by_key(att->notify_list, id);
 	if (!notify)
 		return false;
 
@@ -1394,18 +2106,21 @@ bool bt_att_unregister_all(struct bt_att *att)
 
 int bt_att_get_security(struct bt_att *att)
 {
+	struct bt_att_chan *chan;
 	struct bt_security sec;
 	socklen_t len;
 
-	if (!att)
+	if (!att || !att->fixed)
 		return -EINVAL;
 
-	if (!att->io_on_l2cap)
-		return att->io_sec_level;
+	chan = att->fixed;
+
+	if (!chan->io_on_l2cap)
+		return chan->io_sec_level;
 
 	memset(&sec, 0, sizeof(sec));
 	len = sizeof(sec);
-	if (getsockopt(att->fd, SOL_BLUETOOTH, BT_SECURITY, &sec, &len) < 0)
+	if (getsockopt(chan->fd, SOL_BLUETOOTH, BT_SECURITY, &sec, &len) < 0)
 		return -EIO;
 
 	return sec.level;
@@ -1413,21 +2128,24 @@ int bt_att_get_security(struct bt_att *att)
 
 bool bt_att_set_security(struct bt_att *att, int level)
 {
+	struct bt_att_chan *chan;
 	struct bt_security sec;
 
-	if (!att || level < BT_ATT_SECURITY_AUTO ||
+	if (!att || !att->fixed || level < BT_ATT_SECURITY_AUTO ||
 						level > BT_ATT_SECURITY_HIGH)
 		return false;
 
-	if (!att->io_on_l2cap) {
-		att->io_sec_level = level;
+	chan = att->fixed;
+
+	if (!chan->io_on_l2cap) {
+		chan->io_sec_level = level;
 		return true;
 	}
 
 	memset(&sec, 0, sizeof(sec));
 	sec.level = level;
 
-	if (setsockopt(att->fd, SOL_BLUETOOTH, BT_SECURITY, &sec,
+	if (setsockopt(chan->fd, SOL_BLUETOOTH, BT_SECURITY, &sec,
 							sizeof(sec)) < 0)
 		return false;
 
@@ -23,10 +23,12 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <sys/uio.h>
 
 #include "src/shared/att-types.h"
 
 struct bt_att;
+struct bt_att_buf;
 
 struct bt_att *bt_att_new(int fd, bool ext_signed);
 
@@ -37,6 +39,13 @@ bool bt_att_set_close_on_unref(struct bt_att *att, bool do_close);
 
 int bt_att_get_fd(struct bt_att *att);
 
+/*
+ * Adds an Enhanced ATT bearer (an L2CAP enhanced credit based channel) to
+ * the connection. Requests and indications are spread across idle bearers.
+ */
+int bt_att_attach_fd(struct bt_att *att, int fd);
+int bt_att_get_channels(struct bt_att *att);
+
 typedef void (*bt_att_response_func_t)(uint8_t opcode, const void *pdu,
 					uint16_t length, void *user_data);
 typedef void (*bt_att_notify_func_t)(uint8_t opcode, const void *pdu,
@@ -54,6 +63,9 @@ bool bt_att_set_debug(struct bt_att *att, bt_att_debug_func_t callback,
 uint16_t bt_att_get_mtu(struct bt_att *att);
 bool bt_att_set_mtu(struct bt_att *att, uint16_t mtu);
 
+bool bt_att_get_write_stats(struct bt_att *att, unsigned int *wakeups,
+							unsigned int *pdus);
+
 bool bt_att_set_timeout_cb(struct bt_att *att, bt_att_timeout_func_t callback,
 						void *user_data,
 						bt_att_destroy_func_t destroy);
@@ -63,6 +75,21 @@ unsigned int bt_att_send(struct bt_att *att, uint8_t opcode,
 					bt_att_response_func_t callback,
 					void *user_data,
 					bt_att_destroy_func_t destroy);
+
+/*
+ * Refcounted PDU that can be queued on several bearers without copying, e.g.
+ * to send one notification to many connections.
+ */
+struct bt_att_buf *bt_att_buf_new(uint8_t opcode, const struct iovec *iov,
+								int iovcnt);
+struct bt_att_buf *bt_att_buf_ref(struct bt_att_buf *buf);
+void bt_att_buf_unref(struct bt_att_buf *buf);
+unsigned int bt_att_send_buf(struct bt_att *att, struct bt_att_buf *buf,
+					bt_att_response_func_t callback,
+					void *user_data,
+					bt_att_destroy_func_t destroy);
+unsigned int bt_att_get_pending_writes(struct bt_att *att);
+
 bool bt_att_cancel(struct bt_att *att, unsigned int id);
 bool bt_att_cancel_all(struct bt_att *att);
 
@@ -27,11 +27,15 @@
 
 #include <endian.h>
 #include <fcntl.h>
+#include <stdio.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 #include <arpa/inet.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 
 #include "src/shared/btsnoop.h"
 
@@ -64,6 +68,72 @@ struct pklg_pkt {
 } __attribute__ ((packed));
 #define PKLG_PKT_SIZE (sizeof(struct pklg_pkt))
 
+/*
+ * Sidecar index stored next to a capture as <path>.idx. It splits the
+ * records into spans of up to BTSNOOP_IDX_SPAN records and stores the
+ * time range and controller indexes seen in each span, so a reader can
+ * skip whole spans that are outside of its window. Spans holding index
+ * records are flagged, those are never skipped before the window.
+ */
+struct btsnoop_idx_hdr {
+	uint8_t		id[8];		/* Identification Pattern */
+	uint32_t	version;	/* Version Number = 1 */
+	uint32_t	type;		/* Datalink Type of the capture */
+	uint32_t	span;		/* Records per span */
+} __attribute__ ((packed));
+#define BTSNOOP_IDX_HDR_SIZE (sizeof(struct btsnoop_idx_hdr))
+
+struct btsnoop_idx_entry {
+	uint64_t	offset;		/* File offset of the first record */
+	uint32_t	length;		/* Length of the span in octets */
+	uint32_t	packets;	/* Number of records in the span */
+	uint64_t	ts_min;		/* Earliest timestamp in microseconds */
+	uint64_t	ts_max;		/* Latest timestamp in microseconds */
+	uint32_t	index_mask;	/* Controller indexes in the span */
+	uint32_t	flags;		/* BTSNOOP_IDX_FLAG_* */
+} __attribute__ ((packed));
+#define BTSNOOP_IDX_ENTRY_SIZE (sizeof(struct btsnoop_idx_entry))
+
+static const uint8_t btsnoop_idx_id[] = { 0x62, 0x74, 0x73, 0x6e,
+					  0x69, 0x64, 0x78, 0x00 };
+
+static const uint32_t btsnoop_idx_version = 2;
+
+#define BTSNOOP_IDX_FLAG_INDEX	(1 << 0)	/* Has index records */
+
+#define BTSNOOP_IDX_SPAN	1024
+
+struct index_span {
+	uint64_t offset;
+	uint32_t length;
+	uint32_t packets;
+	uint64_t ts_min;
+	uint64_t ts_max;
+	uint32_t index_mask;
+	uint32_t flags;
+};
+
+/*
+ * Buffered writing appends records to one buffer while a thread writes
+ * out the other one. When both are in use the record is dropped and
+ * counted instead of blocking the caller, unless asked to wait.
+ */
+#define BTSNOOP_BUFFER_MIN	(256 * 1024)
+
+struct btsnoop_writer {
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	uint8_t *buf[2];
+	size_t len[2];
+	size_t size;
+	unsigned int fill;
+	bool busy;
+	bool quit;
+	bool failed;
+	bool block;
+};
+
 struct btsnoop {
 	int ref_count;
 	int fd;
@@ -72,8 +142,201 @@ struct btsnoop {
 	uint16_t index;
 	bool aborted;
 	bool pklg_format;
+	const uint8_t *map;
+	size_t map_size;
+	size_t map_offset;
+	uint8_t *buf;
+	char *path;
+	uint64_t write_offset;
+	int index_fd;
+	struct index_span span;
+	struct index_span *spans;
+	size_t num_spans;
+	size_t cur_span;
+	uint64_t range_end;
+	bool window;
+	uint64_t window_from;
+	uint64_t window_to;
+	uint16_t window_index;
+	struct btsnoop_writer *writer;
+	uint64_t file_start;
+	uint64_t max_size;
+	uint64_t max_age;
+	unsigned int max_files;
+	struct btsnoop_stats stats;
+	uint32_t read_drops;
+	uint32_t write_drops;
 };
 
+static bool map_file(struct btsnoop *btsnoop, size_t offset)
+{
+	struct stat st;
+	void *map;
+
+	if (fstat(btsnoop->fd, &st) < 0 || !S_ISREG(st.st_mode))
+		return false;
+
+	if (st.st_size <= 0 || (uint64_t) st.st_size > SIZE_MAX)
+		return false;
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, btsnoop->fd, 0);
+	if (map == MAP_FAILED)
+		return false;
+
+	madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+	btsnoop->map = map;
+	btsnoop->map_size = st.st_size;
+	btsnoop->map_offset = offset;
+
+	return true;
+}
+
+static const void *map_pull(struct btsnoop *btsnoop, size_t len)
+{
+	const uint8_t *ptr;
+
+	if (btsnoop->map_size - btsnoop->map_offset < len)
+		return NULL;
+
+	ptr = btsnoop->map + btsnoop->map_offset;
+	btsnoop->map_offset += len;
+
+	return ptr;
+}
+
+static uint64_t tv_to_us(const struct timeval *tv)
+{
+	return tv->tv_sec * 1000000ull + tv->tv_usec;
+}
+
+static uint32_t index_bit(uint16_t index)
+{
+	/* Indexes beyond the mask share its top bit */
+	return index < 31 ? 1u << index : 1u << 31;
+}
+
+static char *index_path(const char *path)
+{
+	char *str;
+
+	if (asprintf(&str, "%s.idx", path) < 0)
+		return NULL;
+
+	return str;
+}
+
+static void index_entry_put(const struct index_span *span,
+					struct btsnoop_idx_entry *entry)
+{
+	entry->offset = htobe64(span->offset);
+	entry->length = htobe32(span->length);
+	entry->packets = htobe32(span->packets);
+	entry->ts_min = htobe64(span->ts_min);
+	entry->ts_max = htobe64(span->ts_max);
+	entry->index_mask = htobe32(span->index_mask);
+	entry->flags = htobe32(span->flags);
+}
+
+static bool index_append(struct btsnoop *btsnoop,
+					const struct index_span *span)
+{
+	struct index_span *spans;
+
+	if (!(btsnoop->num_spans & (btsnoop->num_spans - 1))) {
+		spans = realloc(btsnoop->spans, (btsnoop->num_spans ?
+				btsnoop->num_spans * 2 : 64) * sizeof(*spans));
+		if (!spans)
+			return false;
+
+		btsnoop->spans = spans;
+	}
+
+	btsnoop->spans[btsnoop->num_spans++] = *span;
+
+	return true;
+}
+
+/*
+ * Completes the span being built. A writer stores it in the sidecar right
+ * away, a reader building the index keeps it in memory.
+ */
+static void index_commit(struct btsnoop *btsnoop)
+{
+	struct btsnoop_idx_entry entry;
+
+	if (!btsnoop->span.packets)
+		return;
+
+	if (btsnoop->index_fd >= 0) {
+		index_entry_put(&btsnoop->span, &entry);
+
+		if (write(btsnoop->index_fd, &entry, sizeof(entry)) < 0) {
+			close(btsnoop->index_fd);
+			btsnoop->index_fd = -1;
+		}
+	} else
+		index_append(btsnoop, &btsnoop->span);
+
+	memset(&btsnoop->span, 0, sizeof(btsnoop->span));
+}
+
+/* Records describing controllers, needed to decode anything after them */
+static bool is_index_record(struct btsnoop *btsnoop, uint16_t opcode)
+{
+	if (btsnoop->type != BTSNOOP_TYPE_MONITOR)
+		return false;
+
+	switch (opcode) {
+	case BTSNOOP_OPCODE_NEW_INDEX:
+	case BTSNOOP_OPCODE_DEL_INDEX:
+	case BTSNOOP_OPCODE_OPEN_INDEX:
+	case BTSNOOP_OPCODE_CLOSE_INDEX:
+	case BTSNOOP_OPCODE_INDEX_INFO:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static void index_add(struct btsnoop *btsnoop, uint64_t offset,
+				uint32_t length, uint64_t ts, uint16_t index,
+				uint16_t opcode)
+{
+	struct index_span *span = &btsnoop->span;
+
+	if (!span->packets) {
+		span->offset = offset;
+		span->ts_min = ts;
+		span->ts_max = ts;
+	}
+
+	span->length += length;
+	span->packets++;
+	span->index_mask |= index_bit(index);
+
+	if (is_index_record(btsnoop, opcode))
+		span->flags |= BTSNOOP_IDX_FLAG_INDEX;
+
+	if (ts < span->ts_min)
+		span->ts_min = ts;
+
+	if (ts > span->ts_max)
+		span->ts_max = ts;
+
+	if (span->packets == BTSNOOP_IDX_SPAN)
+		index_commit(btsnoop);
+}
+
+static void index_hdr_put(struct btsnoop *btsnoop,
+					struct btsnoop_idx_hdr *hdr)
+{
+	memcpy(hdr->id, btsnoop_idx_id, sizeof(btsnoop_idx_id));
+	hdr->version = htobe32(btsnoop_idx_version);
+	hdr->type = htobe32(btsnoop->type);
+	hdr->span = htobe32(BTSNOOP_IDX_SPAN);
+}
+
 struct btsnoop *btsnoop_open(const char *path, unsigned long flags)
 {
 	struct btsnoop *btsnoop;
@@ -90,7 +353,13 @@ struct btsnoop *btsnoop_open(const char *path, unsigned long flags)
 		return NULL;
 	}
 
+	btsnoop->path = strdup(path);
+	if (!btsnoop->path)
+		goto failed;
+
 	btsnoop->flags = flags;
+	btsnoop->index_fd = -1;
+	btsnoop->range_end = UINT64_MAX;
 
 	len = read(btsnoop->fd, &hdr, BTSNOOP_HDR_SIZE);
 	if (len < 0 || len != BTSNOOP_HDR_SIZE)
@@ -119,46 +388,73 @@ struct btsnoop *btsnoop_open(const char *path, unsigned long flags)
 		lseek(btsnoop->fd, 0, SEEK_SET);
 	}
 
+	/*
+	 * The mapping is a snapshot of the file size at open time and
+	 * falls back to read() for anything that can't be mapped.
+	 */
+	if (btsnoop->flags & BTSNOOP_FLAG_MMAP)
+		map_file(btsnoop, btsnoop->pklg_format ? 0 : BTSNOOP_HDR_SIZE);
+
 	return btsnoop_ref(btsnoop);
 
 failed:
 	close(btsnoop->fd);
+	free(btsnoop->path);
 	free(btsnoop);
 
 	return NULL;
 }
 
-struct btsnoop *btsnoop_create(const char *path, uint32_t type)
+static int create_file(const char *path, uint32_t type)
 {
-	struct btsnoop *btsnoop;
 	struct btsnoop_hdr hdr;
 	ssize_t written;
+	int fd;
+
+	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+					S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+	if (fd < 0)
+		return -1;
+
+	memcpy(hdr.id, btsnoop_id, sizeof(btsnoop_id));
+	hdr.version = htobe32(btsnoop_version);
+	hdr.type = htobe32(type);
+
+	written = write(fd, &hdr, BTSNOOP_HDR_SIZE);
+	if (written != BTSNOOP_HDR_SIZE) {
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+struct btsnoop *btsnoop_create(const char *path, uint32_t type)
+{
+	struct btsnoop *btsnoop;
 
 	btsnoop = calloc(1, sizeof(*btsnoop));
 	if (!btsnoop)
 		return NULL;
 
-	btsnoop->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
-					S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
-	if (btsnoop->fd < 0) {
+	btsnoop->path = strdup(path);
+	if (!btsnoop->path) {
 		free(btsnoop);
 		return NULL;
 	}
 
-	btsnoop->type = type;
-	btsnoop->index = 0xffff;
-
-	memcpy(hdr.id, btsnoop_id, sizeof(btsnoop_id));
-	hdr.version = htobe32(btsnoop_version);
-	hdr.type = htobe32(btsnoop->type);
-
-	written = write(btsnoop->fd, &hdr, BTSNOOP_HDR_SIZE);
-	if (written < 0) {
-		close(btsnoop->fd);
+	btsnoop->fd = create_file(path, type);
+	if (btsnoop->fd < 0) {
+		free(btsnoop->path);
 		free(btsnoop);
 		return NULL;
 	}
 
+	btsnoop->type = type;
+	btsnoop->index = 0xffff;
+	btsnoop->index_fd = -1;
+	btsnoop->write_offset = BTSNOOP_HDR_SIZE;
+
 	return btsnoop_ref(btsnoop);
 }
 
@@ -172,6 +468,9 @@ struct btsnoop *btsnoop_ref(struct btsnoop *btsnoop)
 	return btsnoop;
 }
 
+static void writer_drain(struct btsnoop *btsnoop);
+static void writer_free(struct btsnoop *btsnoop);
+
 void btsnoop_unref(struct btsnoop *btsnoop)
 {
 	if (!btsnoop)
@@ -180,9 +479,25 @@ void btsnoop_unref(struct btsnoop *btsnoop)
 	if (__sync_sub_and_fetch(&btsnoop->ref_count, 1))
 		return;
 
+	if (btsnoop->writer) {
+		writer_drain(btsnoop);
+		writer_free(btsnoop);
+	}
+
+	if (btsnoop->index_fd >= 0) {
+		index_commit(btsnoop);
+		close(btsnoop->index_fd);
+	}
+
+	if (btsnoop->map)
+		munmap((void *) btsnoop->map, btsnoop->map_size);
+
 	if (btsnoop->fd >= 0)
 		close(btsnoop->fd);
 
+	free(btsnoop->spans);
+	free(btsnoop->buf);
+	free(btsnoop->path);
 	free(btsnoop);
 }
 
@@ -194,157 +509,719 @@ uint32_t btsnoop_get_type(struct btsnoop *btsnoop)
 	return btsnoop->type;
 }
 
-bool btsnoop_write(struct btsnoop *btsnoop, struct timeval *tv,
-			uint32_t flags, const void *data, uint16_t size)
+/*
+ * Starts writing <path>.idx alongside a capture opened with
+ * btsnoop_create. It has to be called before the first record is written.
+ */
+bool btsnoop_enable_index(struct btsnoop *btsnoop)
 {
-	struct btsnoop_pkt pkt;
-	uint64_t ts;
-	ssize_t written;
+	struct btsnoop_idx_hdr hdr;
+	char *path;
 
-	if (!btsnoop || !tv)
+	if (!btsnoop || !btsnoop->write_offset || btsnoop->index_fd >= 0)
 		return false;
 
-	ts = (tv->tv_sec - 946684800ll) * 1000000ll + tv->tv_usec;
+	if (btsnoop->write_offset != BTSNOOP_HDR_SIZE)
+		return false;
 
-	pkt.size  = htobe32(size);
-	pkt.len   = htobe32(size);
-	pkt.flags = htobe32(flags);
-	pkt.drops = htobe32(0);
-	pkt.ts    = htobe64(ts + 0x00E03AB44A676000ll);
+	path = index_path(btsnoop->path);
+	if (!path)
+		return false;
+
+	btsnoop->index_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+					S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+	free(path);
 
-	written = write(btsnoop->fd, &pkt, BTSNOOP_PKT_SIZE);
-	if (written < 0)
+	if (btsnoop->index_fd < 0)
 		return false;
 
-	if (data && size > 0) {
-		written = write(btsnoop->fd, data, size);
-		if (written < 0)
-			return false;
+	index_hdr_put(btsnoop, &hdr);
+
+	if (write(btsnoop->index_fd, &hdr, sizeof(hdr)) < 0) {
+		close(btsnoop->index_fd);
+		btsnoop->index_fd = -1;
+		return false;
 	}
 
 	return true;
 }
 
-static uint32_t get_flags_from_opcode(uint16_t opcode)
+static bool write_all(int fd, const uint8_t *buf, size_t len)
 {
-	switch (opcode) {
-	case BTSNOOP_OPCODE_NEW_INDEX:
-	case BTSNOOP_OPCODE_DEL_INDEX:
-		break;
-	case BTSNOOP_OPCODE_COMMAND_PKT:
-		return 0x02;
-	case BTSNOOP_OPCODE_EVENT_PKT:
-		return 0x03;
-	case BTSNOOP_OPCODE_ACL_TX_PKT:
-		return 0x00;
-	case BTSNOOP_OPCODE_ACL_RX_PKT:
-		return 0x01;
-	case BTSNOOP_OPCODE_SCO_TX_PKT:
-	case BTSNOOP_OPCODE_SCO_RX_PKT:
-		break;
+	while (len > 0) {
+		ssize_t written = write(fd, buf, len);
+
+		if (written < 0)
+			return false;
+
+		buf += written;
+		len -= written;
 	}
 
-	return 0xff;
+	return true;
 }
 
-bool btsnoop_write_hci(struct btsnoop *btsnoop, struct timeval *tv,
-					uint16_t index, uint16_t opcode,
-					const void *data, uint16_t size)
+static void *writer_thread(void *user_data)
 {
-	uint32_t flags;
+	struct btsnoop *btsnoop = user_data;
+	struct btsnoop_writer *writer = btsnoop->writer;
 
-	if (!btsnoop)
-		return false;
+	pthread_mutex_lock(&writer->lock);
 
-	switch (btsnoop->type) {
-	case BTSNOOP_TYPE_HCI:
-		if (btsnoop->index == 0xffff)
-			btsnoop->index = index;
+	while (1) {
+		unsigned int n;
+		bool result;
 
-		if (index != btsnoop->index)
-			return false;
+		while (!writer->busy && !writer->quit)
+			pthread_cond_wait(&writer->cond, &writer->lock);
 
-		flags = get_flags_from_opcode(opcode);
-		if (flags == 0xff)
-			return false;
-		break;
+		if (!writer->busy)
+			break;
 
-	case BTSNOOP_TYPE_MONITOR:
-		flags = (index << 16) | opcode;
-		break;
+		/* The caller only touches the other buffer meanwhile */
+		n = !writer->fill;
 
-	default:
-		return false;
+		pthread_mutex_unlock(&writer->lock);
+		result = write_all(btsnoop->fd, writer->buf[n], writer->len[n]);
+		pthread_mutex_lock(&writer->lock);
+
+		if (!result)
+			writer->failed = true;
+
+		writer->len[n] = 0;
+		writer->busy = false;
+		pthread_cond_broadcast(&writer->cond);
 	}
 
-	return btsnoop_write(btsnoop, tv, flags, data, size);
+	pthread_mutex_unlock(&writer->lock);
+
+	return NULL;
 }
 
-bool btsnoop_write_phy(struct btsnoop *btsnoop, struct timeval *tv,
-			uint16_t frequency, const void *data, uint16_t size)
+/* Queues the buffer being filled unless the thread is still writing */
+static bool writer_kick(struct btsnoop_writer *writer)
 {
-	uint32_t flags;
+	bool queued = false;
 
-	if (!btsnoop)
-		return false;
-
-	switch (btsnoop->type) {
-	case BTSNOOP_TYPE_SIMULATOR:
-		flags = (1 << 16) | frequency;
-		break;
+	pthread_mutex_lock(&writer->lock);
 
-	default:
-		return false;
+	if (!writer->busy && writer->len[writer->fill]) {
+		writer->busy = true;
+		writer->fill = !writer->fill;
+		pthread_cond_signal(&writer->cond);
+		queued = true;
 	}
 
-	return btsnoop_write(btsnoop, tv, flags, data, size);
+	pthread_mutex_unlock(&writer->lock);
+
+	return queued;
 }
 
-static uint16_t get_opcode_from_pklg(uint8_t type)
+static void writer_wait(struct btsnoop_writer *writer)
 {
-	switch (type) {
-	case 0x00:
-		return BTSNOOP_OPCODE_COMMAND_PKT;
-	case 0x01:
-		return BTSNOOP_OPCODE_EVENT_PKT;
-	case 0x02:
-		return BTSNOOP_OPCODE_ACL_TX_PKT;
-	case 0x03:
-		return BTSNOOP_OPCODE_ACL_RX_PKT;
-	}
+	pthread_mutex_lock(&writer->lock);
 
-	return 0xffff;
+	while (writer->busy)
+		pthread_cond_wait(&writer->cond, &writer->lock);
+
+	pthread_mutex_unlock(&writer->lock);
 }
 
-static bool pklg_read_hci(struct btsnoop *btsnoop, struct timeval *tv,
-					uint16_t *index, uint16_t *opcode,
-					void *data, uint16_t *size)
+/* Returns with everything buffered so far written to the file */
+static void writer_drain(struct btsnoop *btsnoop)
 {
-	struct pklg_pkt pkt;
-	uint32_t toread;
-	uint64_t ts;
-	ssize_t len;
+	writer_wait(btsnoop->writer);
 
-	len = read(btsnoop->fd, &pkt, PKLG_PKT_SIZE);
-	if (len == 0)
-		return false;
+	if (writer_kick(btsnoop->writer))
+		writer_wait(btsnoop->writer);
+}
 
-	if (len < 0 || len != PKLG_PKT_SIZE) {
-		btsnoop->aborted = true;
-		return false;
-	}
+static void writer_free(struct btsnoop *btsnoop)
+{
+	struct btsnoop_writer *writer = btsnoop->writer;
 
-	toread = be32toh(pkt.len) - 9;
+	pthread_mutex_lock(&writer->lock);
+	writer->quit = true;
+	pthread_cond_signal(&writer->cond);
+	pthread_mutex_unlock(&writer->lock);
 
-	ts = be64toh(pkt.ts);
-	tv->tv_sec = ts >> 32;
-	tv->tv_usec = ts & 0xffffffff;
+	pthread_join(writer->thread, NULL);
 
-	*index = 0;
-	*opcode = get_opcode_from_pklg(pkt.type);
+	pthread_cond_destroy(&writer->cond);
+	pthread_mutex_destroy(&writer->lock);
+	free(writer->buf[0]);
+	free(writer->buf[1]);
+	free(writer);
 
-	len = read(btsnoop->fd, data, toread);
-	if (len < 0) {
+	btsnoop->writer = NULL;
+}
+
+/*
+ * Switches a capture opened with btsnoop_create to buffered writing. The
+ * records are written by a separate thread, so btsnoop_flush has to be
+ * called regularly to bound how long they stay in memory. With block set
+ * writing waits for a free buffer instead of dropping records.
+ */
+bool btsnoop_set_buffer(struct btsnoop *btsnoop, size_t size, bool block)
+{
+	struct btsnoop_writer *writer;
+
+	if (!btsnoop || !btsnoop->write_offset || btsnoop->writer)
+		return false;
+
+	writer = calloc(1, sizeof(*writer));
+	if (!writer)
+		return false;
+
+	writer->size = size < BTSNOOP_BUFFER_MIN ? BTSNOOP_BUFFER_MIN : size;
+	writer->block = block;
+	writer->buf[0] = malloc(writer->size);
+	writer->buf[1] = malloc(writer->size);
+
+	if (!writer->buf[0] || !writer->buf[1])
+		goto failed;
+
+	pthread_mutex_init(&writer->lock, NULL);
+	pthread_cond_init(&writer->cond, NULL);
+
+	btsnoop->writer = writer;
+
+	if (pthread_create(&writer->thread, NULL, writer_thread, btsnoop)) {
+		pthread_cond_destroy(&writer->cond);
+		pthread_mutex_destroy(&writer->lock);
+		btsnoop->writer = NULL;
+		goto failed;
+	}
+
+	return true;
+
+failed:
+	free(writer->buf[0]);
+	free(writer->buf[1]);
+	free(writer);
+	return false;
+}
+
+/* Hands buffered records to the writer thread without waiting for it */
+bool btsnoop_flush(struct btsnoop *btsnoop)
+{
+	bool failed;
+
+	if (!btsnoop)
+		return false;
+
+	if (!btsnoop->writer)
+		return true;
+
+	writer_kick(btsnoop->writer);
+
+	pthread_mutex_lock(&btsnoop->writer->lock);
+	failed = btsnoop->writer->failed;
+	pthread_mutex_unlock(&btsnoop->writer->lock);
+
+	return !failed;
+}
+
+/*
+ * Starts a new file once the current one would grow beyond max_size
+ * octets or spans more than max_age seconds. The previous files are
+ * kept as <path>.1 up to <path>.<max_files>, newest first.
+ */
+bool btsnoop_set_rotate(struct btsnoop *btsnoop, uint64_t max_size,
+				unsigned int max_age, unsigned int max_files)
+{
+	if (!btsnoop || !btsnoop->write_offset)
+		return false;
+
+	if (max_size && max_size <= BTSNOOP_HDR_SIZE)
+		return false;
+
+	btsnoop->max_size = max_size;
+	btsnoop->max_age = max_age * 1000000ull;
+	btsnoop->max_files = max_files;
+
+	return true;
+}
+
+void btsnoop_get_stats(struct btsnoop *btsnoop, struct btsnoop_stats *stats)
+{
+	if (!btsnoop) {
+		memset(stats, 0, sizeof(*stats));
+		return;
+	}
+
+	*stats = btsnoop->stats;
+}
+
+/* Cumulative drops recorded with the last record read */
+uint32_t btsnoop_get_drops(struct btsnoop *btsnoop)
+{
+	if (!btsnoop)
+		return 0;
+
+	return btsnoop->read_drops;
+}
+
+/*
+ * Drops of the source the next records come from, written together with
+ * the records that failed to be written.
+ */
+bool btsnoop_set_drops(struct btsnoop *btsnoop, uint32_t drops)
+{
+	if (!btsnoop)
+		return false;
+
+	btsnoop->write_drops = drops;
+
+	return true;
+}
+
+static char *rotate_path(const char *path, unsigned int num)
+{
+	char *str;
+
+	if (!num)
+		return strdup(path);
+
+	if (asprintf(&str, "%s.%u", path, num) < 0)
+		return NULL;
+
+	return str;
+}
+
+static void rotate_rename(const char *path, unsigned int from, unsigned int to)
+{
+	char *old_path, *new_path, *old_idx, *new_idx;
+
+	old_path = rotate_path(path, from);
+	new_path = rotate_path(path, to);
+
+	if (old_path && new_path) {
+		rename(old_path, new_path);
+
+		old_idx = index_path(old_path);
+		new_idx = index_path(new_path);
+
+		/* A stale index of an older file must not stay behind */
+		if (old_idx && new_idx && rename(old_idx, new_idx) < 0)
+			unlink(new_idx);
+
+		free(old_idx);
+		free(new_idx);
+	}
+
+	free(old_path);
+	free(new_path);
+}
+
+static bool rotate(struct btsnoop *btsnoop)
+{
+	bool indexed = btsnoop->index_fd >= 0;
+	unsigned int i;
+
+	if (btsnoop->writer)
+		writer_drain(btsnoop);
+
+	if (indexed) {
+		index_commit(btsnoop);
+		close(btsnoop->index_fd);
+		btsnoop->index_fd = -1;
+	}
+
+	/* After a failed attempt only the new file is left to create */
+	if (btsnoop->fd >= 0) {
+		close(btsnoop->fd);
+		btsnoop->fd = -1;
+
+		for (i = btsnoop->max_files; i > 0; i--)
+			rotate_rename(btsnoop->path, i - 1, i);
+	}
+
+	btsnoop->fd = create_file(btsnoop->path, btsnoop->type);
+	if (btsnoop->fd < 0)
+		return false;
+
+	btsnoop->write_offset = BTSNOOP_HDR_SIZE;
+	btsnoop->stats.rotations++;
+
+	if (indexed)
+		btsnoop_enable_index(btsnoop);
+
+	return true;
+}
+
+static bool need_rotate(struct btsnoop *btsnoop, uint32_t len, uint64_t ts)
+{
+	/* Every file gets at least one record */
+	if (btsnoop->write_offset == BTSNOOP_HDR_SIZE)
+		return false;
+
+	if (btsnoop->max_size && btsnoop->write_offset + len >
+							btsnoop->max_size)
+		return true;
+
+	if (btsnoop->max_age && ts >= btsnoop->file_start &&
+				ts - btsnoop->file_start >= btsnoop->max_age)
+		return true;
+
+	return false;
+}
+
+static bool write_record(struct btsnoop *btsnoop, struct btsnoop_pkt *pkt,
+					const void *data, uint16_t size)
+{
+	struct btsnoop_writer *writer = btsnoop->writer;
+	struct iovec iov[2];
+	uint8_t *buf;
+
+	if (!writer) {
+		iov[0].iov_base = pkt;
+		iov[0].iov_len = BTSNOOP_PKT_SIZE;
+		iov[1].iov_base = (void *) data;
+		iov[1].iov_len = data ? size : 0;
+
+		return writev(btsnoop->fd, iov, 2) ==
+				(ssize_t) (BTSNOOP_PKT_SIZE + iov[1].iov_len);
+	}
+
+	if (writer->len[writer->fill] + BTSNOOP_PKT_SIZE + size > writer->size &&
+							!writer_kick(writer)) {
+		if (!writer->block)
+			return false;
+
+		writer_wait(writer);
+		writer_kick(writer);
+	}
+
+	buf = writer->buf[writer->fill] + writer->len[writer->fill];
+	memcpy(buf, pkt, BTSNOOP_PKT_SIZE);
+
+	if (data && size > 0)
+		memcpy(buf + BTSNOOP_PKT_SIZE, data, size);
+
+	writer->len[writer->fill] += BTSNOOP_PKT_SIZE + size;
+
+	return true;
+}
+
+bool btsnoop_write(struct btsnoop *btsnoop, struct timeval *tv,
+			uint32_t flags, const void *data, uint16_t size)
+{
+	struct btsnoop_pkt pkt;
+	uint64_t ts;
+
+	if (!btsnoop || !tv)
+		return false;
+
+	if (!data)
+		size = 0;
+
+	if (need_rotate(btsnoop, BTSNOOP_PKT_SIZE + size, tv_to_us(tv)) &&
+							!rotate(btsnoop))
+		return false;
+
+	ts = (tv->tv_sec - 946684800ll) * 1000000ll + tv->tv_usec;
+
+	pkt.size  = htobe32(size);
+	pkt.len   = htobe32(size);
+	pkt.flags = htobe32(flags);
+	pkt.drops = htobe32(btsnoop->write_drops + btsnoop->stats.dropped);
+	pkt.ts    = htobe64(ts + 0x00E03AB44A676000ll);
+
+	if (!write_record(btsnoop, &pkt, data, size)) {
+		btsnoop->stats.dropped++;
+		return false;
+	}
+
+	if (btsnoop->write_offset == BTSNOOP_HDR_SIZE)
+		btsnoop->file_start = tv_to_us(tv);
+
+	if (btsnoop->index_fd >= 0)
+		index_add(btsnoop, btsnoop->write_offset, BTSNOOP_PKT_SIZE + size,
+				tv_to_us(tv), btsnoop->type == BTSNOOP_TYPE_MONITOR ?
+							flags >> 16 : 0,
+				flags & 0xffff);
+
+	btsnoop->write_offset += BTSNOOP_PKT_SIZE + size;
+	btsnoop->stats.packets++;
+	btsnoop->stats.bytes += BTSNOOP_PKT_SIZE + size;
+
+	return true;
+}
+
+static uint32_t get_flags_from_opcode(uint16_t opcode)
+{
+	switch (opcode) {
+	case BTSNOOP_OPCODE_NEW_INDEX:
+	case BTSNOOP_OPCODE_DEL_INDEX:
+		break;
+	case BTSNOOP_OPCODE_COMMAND_PKT:
+		return 0x02;
+	case BTSNOOP_OPCODE_EVENT_PKT:
+		return 0x03;
+	case BTSNOOP_OPCODE_ACL_TX_PKT:
+		return 0x00;
+	case BTSNOOP_OPCODE_ACL_RX_PKT:
+		return 0x01;
+	case BTSNOOP_OPCODE_SCO_TX_PKT:
+	case BTSNOOP_OPCODE_SCO_RX_PKT:
+		break;
+	}
+
+	return 0xff;
+}
+
+bool btsnoop_write_hci(struct btsnoop *btsnoop, struct timeval *tv,
+					uint16_t index, uint16_t opcode,
+					const void *data, uint16_t size)
+{
+	uint32_t flags;
+
+	if (!btsnoop)
+		return false;
+
+	switch (btsnoop->type) {
+	case BTSNOOP_TYPE_HCI:
+		if (btsnoop->index == 0xffff)
+			btsnoop->index = index;
+
+		if (index != btsnoop->index)
+			return false;
+
+		flags = get_flags_from_opcode(opcode);
+		if (flags == 0xff)
+			return false;
+		break;
+
+	case BTSNOOP_TYPE_MONITOR:
+		flags = (index << 16) | opcode;
+		break;
+
+	default:
+		return false;
+	}
+
+	return btsnoop_write(btsnoop, tv, flags, data, size);
+}
+
+bool btsnoop_write_phy(struct btsnoop *btsnoop, struct timeval *tv,
+			uint16_t frequency, const void *data, uint16_t size)
+{
+	uint32_t flags;
+
+	if (!btsnoop)
+		return false;
+
+	switch (btsnoop->type) {
+	case BTSNOOP_TYPE_SIMULATOR:
+		flags = (1 << 16) | frequency;
+		break;
+
+	default:
+		return false;
+	}
+
+	return btsnoop_write(btsnoop, tv, flags, data, size);
+}
+
+static uint16_t get_opcode_from_pklg(uint8_t type)
+{
+	switch (type) {
+	case 0x00:
+		return BTSNOOP_OPCODE_COMMAND_PKT;
+	case 0x01:
+		return BTSNOOP_OPCODE_EVENT_PKT;
+	case 0x02:
+		return BTSNOOP_OPCODE_ACL_TX_PKT;
+	case 0x03:
+		return BTSNOOP_OPCODE_ACL_RX_PKT;
+	}
+
+	return 0xffff;
+}
+
+static bool pklg_read_hci(struct btsnoop *btsnoop, struct timeval *tv,
+					uint16_t *index, uint16_t *opcode,
+					void *data, uint16_t *size)
+{
+	struct pklg_pkt pkt;
+	uint32_t toread;
+	uint64_t ts;
+	ssize_t len;
+
+	len = read(btsnoop->fd, &pkt, PKLG_PKT_SIZE);
+	if (len == 0)
+		return false;
+
+	if (len < 0 || len != PKLG_PKT_SIZE) {
+		btsnoop->aborted = true;
+		return false;
+	}
+
+	toread = be32toh(pkt.len) - 9;
+
+	ts = be64toh(pkt.ts);
+	tv->tv_sec = ts >> 32;
+	tv->tv_usec = ts & 0xffffffff;
+
+	*index = 0;
+	*opcode = get_opcode_from_pklg(pkt.type);
+
+	len = read(btsnoop->fd, data, toread);
+	if (len < 0) {
+		btsnoop->aborted = true;
+		return false;
+	}
+
+	*size = toread;
+
+	return true;
+}
+
+static uint16_t get_opcode_from_flags(uint8_t type, uint32_t flags)
+{
+	switch (type) {
+	case 0x01:
+		return BTSNOOP_OPCODE_COMMAND_PKT;
+	case 0x02:
+		if (flags & 0x01)
+			return BTSNOOP_OPCODE_ACL_RX_PKT;
+		else
+			return BTSNOOP_OPCODE_ACL_TX_PKT;
+	case 0x03:
+		if (flags & 0x01)
+			return BTSNOOP_OPCODE_SCO_RX_PKT;
+		else
+			return BTSNOOP_OPCODE_SCO_TX_PKT;
+	case 0x04:
+		return BTSNOOP_OPCODE_EVENT_PKT;
+	case 0xff:
+		if (flags & 0x02) {
+			if (flags & 0x01)
+				return BTSNOOP_OPCODE_EVENT_PKT;
+			else
+				return BTSNOOP_OPCODE_COMMAND_PKT;
+		} else {
+			if (flags & 0x01)
+				return BTSNOOP_OPCODE_ACL_RX_PKT;
+			else
+				return BTSNOOP_OPCODE_ACL_TX_PKT;
+		}
+		break;
+	}
+
+	return 0xffff;
+}
+
+static bool pklg_map_hci(struct btsnoop *btsnoop, struct timeval *tv,
+					uint16_t *index, uint16_t *opcode,
+					const void **data, uint16_t *size)
+{
+	const struct pklg_pkt *pkt;
+	uint32_t toread;
+	uint64_t ts;
+
+	if (btsnoop->map_offset == btsnoop->map_size)
+		return false;
+
+	pkt = map_pull(btsnoop, PKLG_PKT_SIZE);
+	if (!pkt) {
+		btsnoop->aborted = true;
+		return false;
+	}
+
+	toread = be32toh(pkt->len);
+	if (toread < 9 || toread - 9 > BTSNOOP_MAX_PACKET_SIZE) {
+		btsnoop->aborted = true;
+		return false;
+	}
+
+	toread -= 9;
+
+	*data = map_pull(btsnoop, toread);
+	if (!*data) {
+		btsnoop->aborted = true;
+		return false;
+	}
+
+	ts = be64toh(pkt->ts);
+	tv->tv_sec = ts >> 32;
+	tv->tv_usec = ts & 0xffffffff;
+
+	*index = 0;
+	*opcode = get_opcode_from_pklg(pkt->type);
+	*size = toread;
+
+	return true;
+}
+
+static bool btsnoop_map_hci(struct btsnoop *btsnoop, struct timeval *tv,
+					uint16_t *index, uint16_t *opcode,
+					const void **data, uint16_t *size)
+{
+	const struct btsnoop_pkt *pkt;
+	const uint8_t *pkt_type;
+	uint32_t toread, flags;
+	uint64_t ts;
+
+	if (btsnoop->map_offset >= btsnoop->range_end)
+		return false;
+
+	if (btsnoop->pklg_format)
+		return pklg_map_hci(btsnoop, tv, index, opcode, data, size);
+
+	if (btsnoop->map_offset == btsnoop->map_size)
+		return false;
+
+	pkt = map_pull(btsnoop, BTSNOOP_PKT_SIZE);
+	if (!pkt) {
+		btsnoop->aborted = true;
+		return false;
+	}
+
+	toread = be32toh(pkt->size);
+	if (toread > BTSNOOP_MAX_PACKET_SIZE) {
+		btsnoop->aborted = true;
+		return false;
+	}
+
+	flags = be32toh(pkt->flags);
+	btsnoop->read_drops = be32toh(pkt->drops);
+
+	ts = be64toh(pkt->ts) - 0x00E03AB44A676000ll;
+	tv->tv_sec = (ts / 1000000ll) + 946684800ll;
+	tv->tv_usec = ts % 1000000ll;
+
+	switch (btsnoop->type) {
+	case BTSNOOP_TYPE_HCI:
+		*index = 0;
+		*opcode = get_opcode_from_flags(0xff, flags);
+		break;
+
+	case BTSNOOP_TYPE_UART:
+		pkt_type = map_pull(btsnoop, 1);
+		if (!pkt_type || !toread) {
+			btsnoop->aborted = true;
+			return false;
+		}
+		toread--;
+
+		*index = 0;
+		*opcode = get_opcode_from_flags(*pkt_type, flags);
+		break;
+
+	case BTSNOOP_TYPE_MONITOR:
+		*index = flags >> 16;
+		*opcode = flags & 0xffff;
+		break;
+
+	default:
+		btsnoop->aborted = true;
+		return false;
+	}
+
+	*data = map_pull(btsnoop, toread);
+	if (!*data) {
 		btsnoop->aborted = true;
 		return false;
 	}
@@ -354,42 +1231,7 @@ static bool pklg_read_hci(struct btsnoop *btsnoop, struct timeval *tv,
 	return true;
 }
 
-static uint16_t get_opcode_from_flags(uint8_t type, uint32_t flags)
-{
-	switch (type) {
-	case 0x01:
-		return BTSNOOP_OPCODE_COMMAND_PKT;
-	case 0x02:
-		if (flags & 0x01)
-			return BTSNOOP_OPCODE_ACL_RX_PKT;
-		else
-			return BTSNOOP_OPCODE_ACL_TX_PKT;
-	case 0x03:
-		if (flags & 0x01)
-			return BTSNOOP_OPCODE_SCO_RX_PKT;
-		else
-			return BTSNOOP_OPCODE_SCO_TX_PKT;
-	case 0x04:
-		return BTSNOOP_OPCODE_EVENT_PKT;
-	case 0xff:
-		if (flags & 0x02) {
-			if (flags & 0x01)
-				return BTSNOOP_OPCODE_EVENT_PKT;
-			else
-				return BTSNOOP_OPCODE_COMMAND_PKT;
-		} else {
-			if (flags & 0x01)
-				return BTSNOOP_OPCODE_ACL_RX_PKT;
-			else
-				return BTSNOOP_OPCODE_ACL_TX_PKT;
-		}
-		break;
-	}
-
-	return 0xffff;
-}
-
-bool btsnoop_read_hci(struct btsnoop *btsnoop, struct timeval *tv,
+static bool read_hci(struct btsnoop *btsnoop, struct timeval *tv,
 					uint16_t *index, uint16_t *opcode,
 					void *data, uint16_t *size)
 {
@@ -399,7 +1241,18 @@ bool btsnoop_read_hci(struct btsnoop *btsnoop, struct timeval *tv,
 	uint8_t pkt_type;
 	ssize_t len;
 
-	if (!btsnoop || btsnoop->aborted)
+	if (btsnoop->map) {
+		const void *ptr;
+
+		if (!btsnoop_map_hci(btsnoop, tv, index, opcode, &ptr, size))
+			return false;
+
+		memcpy(data, ptr, *size);
+		return true;
+	}
+
+	if (btsnoop->range_end != UINT64_MAX &&
+		lseek(btsnoop->fd, 0, SEEK_CUR) >= (off_t) btsnoop->range_end)
 		return false;
 
 	if (btsnoop->pklg_format)
@@ -421,6 +1274,7 @@ bool btsnoop_read_hci(struct btsnoop *btsnoop, struct timeval *tv,
 	}
 
 	flags = be32toh(pkt.flags);
+	btsnoop->read_drops = be32toh(pkt.drops);
 
 	ts = be64toh(pkt.ts) - 0x00E03AB44A676000ll;
 	tv->tv_sec = (ts / 1000000ll) + 946684800ll;
@@ -465,6 +1319,474 @@ bool btsnoop_read_hci(struct btsnoop *btsnoop, struct timeval *tv,
 	return true;
 }
 
+static bool read_at(struct btsnoop *btsnoop, uint64_t offset,
+						void *data, size_t size)
+{
+	if (btsnoop->map) {
+		if (offset > btsnoop->map_size ||
+				btsnoop->map_size - offset < size)
+			return false;
+
+		memcpy(data, btsnoop->map + offset, size);
+		return true;
+	}
+
+	return pread(btsnoop->fd, data, size, offset) == (ssize_t) size;
+}
+
+static uint64_t get_offset(struct btsnoop *btsnoop)
+{
+	off_t offset;
+
+	if (btsnoop->map)
+		return btsnoop->map_offset;
+
+	offset = lseek(btsnoop->fd, 0, SEEK_CUR);
+
+	return offset < 0 ? 0 : offset;
+}
+
+static void set_offset(struct btsnoop *btsnoop, uint64_t offset)
+{
+	if (btsnoop->map)
+		btsnoop->map_offset = offset;
+	else if (lseek(btsnoop->fd, offset, SEEK_SET) < 0)
+		btsnoop->aborted = true;
+}
+
+/* Reads the record header at offset, as the reader would see it */
+static bool peek_record(struct btsnoop *btsnoop, uint64_t offset,
+				uint32_t *length, uint64_t *ts, uint16_t *index,
+				uint16_t *opcode)
+{
+	struct btsnoop_pkt pkt;
+	uint32_t size, flags;
+
+	if (!read_at(btsnoop, offset, &pkt, BTSNOOP_PKT_SIZE))
+		return false;
+
+	size = be32toh(pkt.size);
+	if (size > BTSNOOP_MAX_PACKET_SIZE)
+		return false;
+
+	flags = be32toh(pkt.flags);
+
+	*length = BTSNOOP_PKT_SIZE + size;
+	*ts = be64toh(pkt.ts) - 0x00E03AB44A676000ll + 946684800000000ll;
+	*index = btsnoop->type == BTSNOOP_TYPE_MONITOR ? flags >> 16 : 0;
+	*opcode = btsnoop->type == BTSNOOP_TYPE_MONITOR ? flags & 0xffff : 0;
+
+	return true;
+}
+
+static uint64_t file_size(struct btsnoop *btsnoop)
+{
+	struct stat st;
+
+	if (btsnoop->map)
+		return btsnoop->map_size;
+
+	if (fstat(btsnoop->fd, &st) < 0)
+		return 0;
+
+	return st.st_size;
+}
+
+/* Adds spans for all complete records from offset to the end of file */
+static void index_scan(struct btsnoop *btsnoop, uint64_t offset)
+{
+	uint64_t size = file_size(btsnoop);
+	uint32_t length;
+	uint64_t ts;
+	uint16_t index, opcode;
+
+	while (peek_record(btsnoop, offset, &length, &ts, &index, &opcode)) {
+		if (size - offset < length)
+			break;
+
+		index_add(btsnoop, offset, length, ts, index, opcode);
+		offset += length;
+	}
+
+	index_commit(btsnoop);
+}
+
+static bool check_span(struct btsnoop *btsnoop, const struct index_span *span)
+{
+	uint32_t length;
+	uint64_t ts;
+	uint16_t index, opcode;
+
+	if (!peek_record(btsnoop, span->offset, &length, &ts, &index,
+								&opcode))
+		return false;
+
+	return ts >= span->ts_min && ts <= span->ts_max &&
+					(span->index_mask & index_bit(index));
+}
+
+static bool index_load(struct btsnoop *btsnoop)
+{
+	struct btsnoop_idx_hdr hdr;
+	struct btsnoop_idx_entry entry;
+	struct index_span span;
+	uint64_t offset = BTSNOOP_HDR_SIZE;
+	uint64_t size = file_size(btsnoop);
+	char *path;
+	FILE *fp;
+
+	path = index_path(btsnoop->path);
+	if (!path)
+		return false;
+
+	fp = fopen(path, "re");
+	free(path);
+
+	if (!fp)
+		return false;
+
+	if (fread(&hdr, sizeof(hdr), 1, fp) != 1 ||
+			memcmp(hdr.id, btsnoop_idx_id, sizeof(btsnoop_idx_id)) ||
+			be32toh(hdr.version) != btsnoop_idx_version ||
+			be32toh(hdr.type) != btsnoop->type)
+		goto failed;
+
+	while (fread(&entry, sizeof(entry), 1, fp) == 1) {
+		span.offset = be64toh(entry.offset);
+		span.length = be32toh(entry.length);
+		span.packets = be32toh(entry.packets);
+		span.ts_min = be64toh(entry.ts_min);
+		span.ts_max = be64toh(entry.ts_max);
+		span.index_mask = be32toh(entry.index_mask);
+		span.flags = be32toh(entry.flags);
+
+		/* Spans have to cover the capture without gaps */
+		if (span.offset != offset || !span.packets ||
+				span.ts_min > span.ts_max ||
+				size - offset < span.length)
+			goto failed;
+
+		if (!index_append(btsnoop, &span))
+			goto failed;
+
+		offset += span.length;
+	}
+
+	fclose(fp);
+
+	/* A capture that was replaced keeps its stale index around */
+	if (btsnoop->num_spans && !check_span(btsnoop, &btsnoop->spans[0]))
+		goto reset;
+
+	/* Whatever was written after the index was last updated */
+	index_scan(btsnoop, offset);
+
+	return true;
+
+failed:
+	fclose(fp);
+reset:
+	free(btsnoop->spans);
+	btsnoop->spans = NULL;
+	btsnoop->num_spans = 0;
+
+	return false;
+}
+
+static bool index_save(struct btsnoop *btsnoop)
+{
+	struct btsnoop_idx_hdr hdr;
+	struct btsnoop_idx_entry entry;
+	char *path, *tmp;
+	bool result = false;
+	size_t i;
+	FILE *fp;
+	int fd;
+
+	path = index_path(btsnoop->path);
+	if (!path)
+		return false;
+
+	if (asprintf(&tmp, "%s.XXXXXX", path) < 0) {
+		free(path);
+		return false;
+	}
+
+	fd = mkostemp(tmp, O_CLOEXEC);
+	if (fd < 0)
+		goto done;
+
+	fp = fdopen(fd, "w");
+	if (!fp) {
+		close(fd);
+		unlink(tmp);
+		goto done;
+	}
+
+	index_hdr_put(btsnoop, &hdr);
+	fwrite(&hdr, sizeof(hdr), 1, fp);
+
+	for (i = 0; i < btsnoop->num_spans; i++) {
+		index_entry_put(&btsnoop->spans[i], &entry);
+		fwrite(&entry, sizeof(entry), 1, fp);
+	}
+
+	fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+	if (fclose(fp) || rename(tmp, path) < 0)
+		unlink(tmp);
+	else
+		result = true;
+
+done:
+	free(tmp);
+	free(path);
+
+	return result;
+}
+
+/*
+ * Writes <path>.idx for a capture opened with btsnoop_open, so that later
+ * reads with a window can seek over spans. Reading never writes it, the
+ * directory of a capture may not be ours to write to.
+ */
+bool btsnoop_save_index(struct btsnoop *btsnoop)
+{
+	if (!btsnoop || btsnoop->write_offset || btsnoop->pklg_format)
+		return false;
+
+	if (!btsnoop->spans && !index_load(btsnoop))
+		index_scan(btsnoop, BTSNOOP_HDR_SIZE);
+
+	return index_save(btsnoop);
+}
+
+/*
+ * Limits what btsnoop_read_hci and btsnoop_next_hci return to records
+ * between from and to, and of the given controller unless index is 0xffff.
+ * Either end of the window can be NULL. Reading restarts from the first
+ * record. Records with index 0xffff pass the controller check, and index
+ * records from before the window pass as well so that the controllers of
+ * the window are known. The sidecar index is loaded, or built in memory,
+ * to seek over spans outside the window.
+ */
+bool btsnoop_set_window(struct btsnoop *btsnoop, const struct timeval *from,
+				const struct timeval *to, uint16_t index)
+{
+	if (!btsnoop || btsnoop->write_offset)
+		return false;
+
+	btsnoop->aborted = false;
+	btsnoop->window = true;
+	btsnoop->window_from = from ? tv_to_us(from) : 0;
+	btsnoop->window_to = to ? tv_to_us(to) : UINT64_MAX;
+	btsnoop->window_index = index;
+	btsnoop->cur_span = 0;
+
+	/* Apple Packet Logger files are only filtered */
+	if (btsnoop->pklg_format) {
+		set_offset(btsnoop, 0);
+		return true;
+	}
+
+	set_offset(btsnoop, BTSNOOP_HDR_SIZE);
+
+	if (!btsnoop->spans && !index_load(btsnoop))
+		index_scan(btsnoop, BTSNOOP_HDR_SIZE);
+
+	return true;
+}
+
+/*
+ * Splits the records into at most count ranges of similar size, along span
+ * boundaries of the index. offsets receives count + 1 entries, range n
+ * goes from offsets[n] up to offsets[n + 1]. The last range always runs to
+ * the end of the file. Returns the number of ranges.
+ */
+unsigned int btsnoop_split(struct btsnoop *btsnoop, unsigned int count,
+							uint64_t *offsets)
+{
+	uint64_t start, total, next;
+	unsigned int n = 0;
+	size_t i;
+
+	if (!btsnoop || !count || btsnoop->write_offset)
+		return 0;
+
+	start = btsnoop->pklg_format ? 0 : BTSNOOP_HDR_SIZE;
+	offsets[0] = start;
+
+	if (!btsnoop->pklg_format && !btsnoop->spans &&
+						!index_load(btsnoop))
+		index_scan(btsnoop, BTSNOOP_HDR_SIZE);
+
+	if (btsnoop->num_spans < 2 || count == 1) {
+		offsets[1] = UINT64_MAX;
+		return 1;
+	}
+
+	total = btsnoop->spans[btsnoop->num_spans - 1].offset - start;
+
+	for (i = 1; i < btsnoop->num_spans && n + 1 < count; i++) {
+		next = btsnoop->spans[i].offset;
+
+		if (next - start >= total * (n + 1) / count)
+			offsets[++n] = next;
+	}
+
+	offsets[++n] = UINT64_MAX;
+
+	return n;
+}
+
+/* Restricts reading to the records from start up to end */
+bool btsnoop_set_range(struct btsnoop *btsnoop, uint64_t start, uint64_t end)
+{
+	if (!btsnoop || btsnoop->write_offset || start > end)
+		return false;
+
+	btsnoop->aborted = false;
+	btsnoop->range_end = end;
+	btsnoop->cur_span = 0;
+	set_offset(btsnoop, start);
+
+	return !btsnoop->aborted;
+}
+
+static bool in_window(struct btsnoop *btsnoop, const struct timeval *tv,
+						uint16_t index, uint16_t opcode)
+{
+	uint64_t ts;
+
+	if (!btsnoop->window)
+		return true;
+
+	/* System records don't belong to any controller */
+	if (btsnoop->window_index != 0xffff && index != 0xffff &&
+					btsnoop->window_index != index)
+		return false;
+
+	ts = tv_to_us(tv);
+
+	if (ts < btsnoop->window_from)
+		return is_index_record(btsnoop, opcode);
+
+	return ts <= btsnoop->window_to;
+}
+
+static bool span_in_window(struct btsnoop *btsnoop,
+					const struct index_span *span)
+{
+	if (btsnoop->window_index != 0xffff &&
+			!(span->index_mask & (index_bit(btsnoop->window_index) |
+							index_bit(0xffff))))
+		return false;
+
+	if (span->ts_min > btsnoop->window_to)
+		return false;
+
+	return span->ts_max >= btsnoop->window_from ||
+					(span->flags & BTSNOOP_IDX_FLAG_INDEX);
+}
+
+/* Moves the read position past spans that have nothing in the window */
+static void seek_window(struct btsnoop *btsnoop)
+{
+	uint64_t offset;
+	bool skipped = false;
+
+	if (!btsnoop->window || !btsnoop->num_spans)
+		return;
+
+	offset = get_offset(btsnoop);
+
+	while (btsnoop->cur_span < btsnoop->num_spans) {
+		struct index_span *span = &btsnoop->spans[btsnoop->cur_span];
+
+		if (offset >= span->offset + span->length) {
+			btsnoop->cur_span++;
+			continue;
+		}
+
+		if (span_in_window(btsnoop, span))
+			break;
+
+		offset = span->offset + span->length;
+		btsnoop->cur_span++;
+		skipped = true;
+	}
+
+	if (!skipped)
+		return;
+
+	/* Fall back to reading everything if the index doesn't match */
+	if (btsnoop->cur_span < btsnoop->num_spans &&
+			!check_span(btsnoop, &btsnoop->spans[btsnoop->cur_span])) {
+		free(btsnoop->spans);
+		btsnoop->spans = NULL;
+		btsnoop->num_spans = 0;
+		set_offset(btsnoop, BTSNOOP_HDR_SIZE);
+		return;
+	}
+
+	set_offset(btsnoop, offset);
+}
+
+bool btsnoop_read_hci(struct btsnoop *btsnoop, struct timeval *tv,
+					uint16_t *index, uint16_t *opcode,
+					void *data, uint16_t *size)
+{
+	if (!btsnoop || btsnoop->aborted)
+		return false;
+
+	do {
+		seek_window(btsnoop);
+
+		if (!read_hci(btsnoop, tv, index, opcode, data, size))
+			return false;
+	} while (!in_window(btsnoop, tv, *index, *opcode));
+
+	return true;
+}
+
+/*
+ * Like btsnoop_read_hci, but without copying. With BTSNOOP_FLAG_MMAP the
+ * data points into the mapped file and stays valid until the last reference
+ * is dropped, otherwise it points to a buffer reused by the next call.
+ */
+bool btsnoop_next_hci(struct btsnoop *btsnoop, struct timeval *tv,
+					uint16_t *index, uint16_t *opcode,
+					const void **data, uint16_t *size)
+{
+	if (!btsnoop || btsnoop->aborted)
+		return false;
+
+	if (btsnoop->map) {
+		do {
+			seek_window(btsnoop);
+
+			if (!btsnoop_map_hci(btsnoop, tv, index, opcode,
+								data, size))
+				return false;
+		} while (!in_window(btsnoop, tv, *index, *opcode));
+
+		return true;
+	}
+
+	if (!btsnoop->buf) {
+		btsnoop->buf = malloc(BTSNOOP_MAX_PACKET_SIZE);
+		if (!btsnoop->buf)
+			return false;
+	}
+
+	if (!btsnoop_read_hci(btsnoop, tv, index, opcode, btsnoop->buf, size))
+		return false;
+
+	*data = btsnoop->buf;
+
+	return true;
+}
+
 bool btsnoop_read_phy(struct btsnoop *btsnoop, struct timeval *tv,
 			uint16_t *frequency, void *data, uint16_t *size)
 {
@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <sys/time.h>
 
 #define BTSNOOP_TYPE_INVALID		0
@@ -34,6 +35,7 @@
 #define BTSNOOP_TYPE_SIMULATOR		2002
 
 #define BTSNOOP_FLAG_PKLG_SUPPORT	(1 << 0)
+#define BTSNOOP_FLAG_MMAP		(1 << 1)
 
 #define BTSNOOP_OPCODE_NEW_INDEX	0
 #define BTSNOOP_OPCODE_DEL_INDEX	1
@@ -43,6 +45,9 @@
 #define BTSNOOP_OPCODE_ACL_RX_PKT	5
 #define BTSNOOP_OPCODE_SCO_TX_PKT	6
 #define BTSNOOP_OPCODE_SCO_RX_PKT	7
+#define BTSNOOP_OPCODE_OPEN_INDEX	8
+#define BTSNOOP_OPCODE_CLOSE_INDEX	9
+#define BTSNOOP_OPCODE_INDEX_INFO	10
 
 #define BTSNOOP_MAX_PACKET_SIZE		(1486 + 4)
 
@@ -55,6 +60,13 @@ struct btsnoop_opcode_new_index {
 
 struct btsnoop;
 
+struct btsnoop_stats {
+	uint64_t packets;
+	uint64_t bytes;
+	uint64_t dropped;
+	unsigned int rotations;
+};
+
 struct btsnoop *btsnoop_open(const char *path, unsigned long flags);
 struct btsnoop *btsnoop_create(const char *path, uint32_t type);
 
@@ -63,6 +75,21 @@ void btsnoop_unref(struct btsnoop *btsnoop);
 
 uint32_t btsnoop_get_type(struct btsnoop *btsnoop);
 
+bool btsnoop_enable_index(struct btsnoop *btsnoop);
+bool btsnoop_save_index(struct btsnoop *btsnoop);
+bool btsnoop_set_buffer(struct btsnoop *btsnoop, size_t size, bool block);
+bool btsnoop_set_rotate(struct btsnoop *btsnoop, uint64_t max_size,
+				unsigned int max_age, unsigned int max_files);
+bool btsnoop_flush(struct btsnoop *btsnoop);
+void btsnoop_get_stats(struct btsnoop *btsnoop, struct btsnoop_stats *stats);
+uint32_t btsnoop_get_drops(struct btsnoop *btsnoop);
+bool btsnoop_set_drops(struct btsnoop *btsnoop, uint32_t drops);
+bool btsnoop_set_window(struct btsnoop *btsnoop, const struct timeval *from,
+				const struct timeval *to, uint16_t index);
+unsigned int btsnoop_split(struct btsnoop *btsnoop, unsigned int count,
+							uint64_t *offsets);
+bool btsnoop_set_range(struct btsnoop *btsnoop, uint64_t start, uint64_t end);
+
 bool btsnoop_write(struct btsnoop *btsnoop, struct timeval *tv,
 			uint32_t flags, const void *data, uint16_t size);
 bool btsnoop_write_hci(struct btsnoop *btsnoop, struct timeval *tv,
@@ -74,5 +101,8 @@ bool btsnoop_write_phy(struct btsnoop *btsnoop, struct timeval *tv,
 bool btsnoop_read_hci(struct btsnoop *btsnoop, struct timeval *tv,
 					uint16_t *index, uint16_t *opcode,
 					void *data, uint16_t *size);
+bool btsnoop_next_hci(struct btsnoop *btsnoop, struct timeval *tv,
+					uint16_t *index, uint16_t *opcode,
+					const void **data, uint16_t *size);
 bool btsnoop_read_phy(struct btsnoop *btsnoop, struct timeval *tv,
 			uint16_t *frequency, void *data, uint16_t *size);
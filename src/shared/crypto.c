@@ -29,8 +29,10 @@
 #include <unistd.h>
 #include <string.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 
 #include "src/shared/util.h"
+#include "src/shared/aes.h"
 #include "src/shared/crypto.h"
 
 #ifndef HAVE_LINUX_IF_ALG_H
@@ -77,6 +79,7 @@ struct af_alg_iv {
 
 struct bt_crypto {
 	int ref_count;
+	enum bt_crypto_backend backend;
 	int ecb_aes;
 	int urandom;
 	int cmac_aes;
@@ -137,7 +140,7 @@ static int cmac_aes_setup(void)
 	return fd;
 }
 
-struct bt_crypto *bt_crypto_new(void)
+struct bt_crypto *bt_crypto_new_backend(enum bt_crypto_backend backend)
 {
 	struct bt_crypto *crypto;
 
@@ -145,23 +148,30 @@ struct bt_crypto *bt_crypto_new(void)
 	if (!crypto)
 		return NULL;
 
-	crypto->ecb_aes = ecb_aes_setup();
-	if (crypto->ecb_aes < 0) {
+	crypto->backend = backend;
+	crypto->ecb_aes = -1;
+	crypto->cmac_aes = -1;
+
+	crypto->urandom = urandom_setup();
+	if (crypto->urandom < 0) {
 		free(crypto);
 		return NULL;
 	}
 
-	crypto->urandom = urandom_setup();
-	if (crypto->urandom < 0) {
-		close(crypto->ecb_aes);
+	if (backend == BT_CRYPTO_BACKEND_USERSPACE)
+		return bt_crypto_ref(crypto);
+
+	crypto->ecb_aes = ecb_aes_setup();
+	if (crypto->ecb_aes < 0) {
+		close(crypto->urandom);
 		free(crypto);
 		return NULL;
 	}
 
 	crypto->cmac_aes = cmac_aes_setup();
 	if (crypto->cmac_aes < 0) {
-		close(crypto->urandom);
 		close(crypto->ecb_aes);
+		close(crypto->urandom);
 		free(crypto);
 		return NULL;
 	}
@@ -169,6 +179,11 @@ struct bt_crypto *bt_crypto_new(void)
 	return bt_crypto_ref(crypto);
 }
 
+struct bt_crypto *bt_crypto_new(void)
+{
+	return bt_crypto_new_backend(BT_CRYPTO_BACKEND_USERSPACE);
+}
+
 struct bt_crypto *bt_crypto_ref(struct bt_crypto *crypto)
 {
 	if (!crypto)
@@ -188,8 +203,12 @@ void bt_crypto_unref(struct bt_crypto *crypto)
 		return;
 
 	close(crypto->urandom);
-	close(crypto->ecb_aes);
-	close(crypto->cmac_aes);
+
+	if (crypto->ecb_aes >= 0)
+		close(crypto->ecb_aes);
+
+	if (crypto->cmac_aes >= 0)
+		close(crypto->cmac_aes);
 
 	free(crypto);
 }
@@ -265,12 +284,72 @@ static inline void swap_buf(const uint8_t *src, uint8_t *dst, uint16_t len)
 		dst[len - 1 - i] = src[i];
 }
 
+/* Key, input and output are most significant octet first */
+static bool aes_e(struct bt_crypto *crypto, const uint8_t key[16],
+				const uint8_t in[16], uint8_t out[16])
+{
+	struct bt_aes_key aes;
+	int fd;
+
+	if (crypto->backend == BT_CRYPTO_BACKEND_USERSPACE) {
+		bt_aes_set_key(&aes, key);
+		bt_aes_encrypt(&aes, in, out);
+		memset(&aes, 0, sizeof(aes));
+		return true;
+	}
+
+	fd = alg_new(crypto->ecb_aes, key, 16);
+	if (fd < 0)
+		return false;
+
+	if (!alg_encrypt(fd, in, 16, out, 16)) {
+		close(fd);
+		return false;
+	}
+
+	close(fd);
+
+	return true;
+}
+
+static bool cmac(struct bt_crypto *crypto, const uint8_t key[16],
+			const struct iovec *iov, size_t iov_cnt,
+			uint8_t out[16])
+{
+	ssize_t len;
+	int fd;
+
+	if (crypto->backend == BT_CRYPTO_BACKEND_USERSPACE) {
+		bt_aes_cmac(key, iov, iov_cnt, out);
+		return true;
+	}
+
+	fd = alg_new(crypto->cmac_aes, key, 16);
+	if (fd < 0)
+		return false;
+
+	len = writev(fd, iov, iov_cnt);
+	if (len < 0) {
+		close(fd);
+		return false;
+	}
+
+	len = read(fd, out, 16);
+	if (len < 0) {
+		close(fd);
+		return false;
+	}
+
+	close(fd);
+
+	return true;
+}
+
 bool bt_crypto_sign_att(struct bt_crypto *crypto, const uint8_t key[16],
 				const uint8_t *m, uint16_t m_len,
 				uint32_t sign_cnt, uint8_t signature[12])
 {
-	int fd;
-	int len;
+	struct iovec iov;
 	uint8_t tmp[16], out[16];
 	uint16_t msg_len = m_len + sizeof(uint32_t);
 	uint8_t msg[msg_len];
@@ -288,26 +367,14 @@ bool bt_crypto_sign_att(struct bt_crypto *crypto, const uint8_t key[16],
 	/* The most significant octet of key corresponds to key[0] */
 	swap_buf(key, tmp, 16);
 
-	fd = alg_new(crypto->cmac_aes, tmp, 16);
-	if (fd < 0)
-		return false;
-
 	/* Swap msg before signing */
 	swap_buf(msg, msg_s, msg_len);
 
-	len = send(fd, msg_s, msg_len, 0);
-	if (len < 0) {
-		close(fd);
-		return false;
-	}
+	iov.iov_base = msg_s;
+	iov.iov_len = msg_len;
 
-	len = read(fd, out, 16);
-	if (len < 0) {
-		close(fd);
+	if (!cmac(crypto, tmp, &iov, 1, out))
 		return false;
-	}
-
-	close(fd);
 
 	/*
 	 * As to BT spec. 4.1 Vol[3], Part C, chapter 10.4.1 sign counter should
@@ -342,7 +409,6 @@ bool bt_crypto_e(struct bt_crypto *crypto, const uint8_t key[16],
 			const uint8_t plaintext[16], uint8_t encrypted[16])
 {
 	uint8_t tmp[16], in[16], out[16];
-	int fd;
 
 	if (!crypto)
 		return false;
@@ -350,24 +416,15 @@ bool bt_crypto_e(struct bt_crypto *crypto, const uint8_t key[16],
 	/* The most significant octet of key corresponds to key[0] */
 	swap_buf(key, tmp, 16);
 
-	fd = alg_new(crypto->ecb_aes, tmp, 16);
-	if (fd < 0)
-		return false;
-
-
 	/* Most significant octet of plaintextData corresponds to in[0] */
 	swap_buf(plaintext, in, 16);
 
-	if (!alg_encrypt(fd, in, 16, out, 16)) {
-		close(fd);
+	if (!aes_e(crypto, tmp, in, out))
 		return false;
-	}
 
 	/* Most significant octet of encryptedData corresponds to out[0] */
 	swap_buf(out, encrypted, 16);
 
-	close(fd);
-
 	return true;
 }
 
@@ -574,34 +631,22 @@ static bool aes_cmac(struct bt_crypto *crypto, uint8_t key[16], uint8_t *msg,
 					size_t msg_len, uint8_t res[16])
 {
 	uint8_t key_msb[16], out[16], msg_msb[CMAC_MSG_MAX];
-	ssize_t len;
-	int fd;
+	struct iovec iov;
 
-	if (msg_len > CMAC_MSG_MAX)
+	if (!crypto || msg_len > CMAC_MSG_MAX)
 		return false;
 
 	swap_buf(key, key_msb, 16);
-	fd = alg_new(crypto->cmac_aes, key_msb, 16);
-	if (fd < 0)
-		return false;
-
 	swap_buf(msg, msg_msb, msg_len);
-	len = send(fd, msg_msb, msg_len, 0);
-	if (len < 0) {
-		close(fd);
-		return false;
-	}
 
-	len = read(fd, out, 16);
-	if (len < 0) {
-		close(fd);
+	iov.iov_base = msg_msb;
+	iov.iov_len = msg_len;
+
+	if (!cmac(crypto, key_msb, &iov, 1, out))
 		return false;
-	}
 
 	swap_buf(out, res, 16);
 
-	close(fd);
-
 	return true;
 }
 
@@ -681,3 +726,19 @@ bool bt_crypto_g2(struct bt_crypto *crypto, uint8_t u[32], uint8_t v[32],
 
 	return true;
 }
+
+/*
+ * Database Hash (Core 5.1, Vol 3, Part G, 7.3.1): AES-CMAC with an all-zero
+ * key over the concatenation of iov. Unlike the security functions the
+ * message is hashed in the order it is given and res is the plain CMAC.
+ */
+bool bt_crypto_gatt_hash(struct bt_crypto *crypto, const struct iovec *iov,
+					size_t iov_cnt, uint8_t res[16])
+{
+	const uint8_t key[16] = {};
+
+	if (!crypto)
+		return false;
+
+	return cmac(crypto, key, iov, iov_cnt, res);
+}
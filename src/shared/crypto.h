@@ -23,10 +23,17 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <sys/uio.h>
 
 struct bt_crypto;
 
+enum bt_crypto_backend {
+	BT_CRYPTO_BACKEND_USERSPACE,	/* In-process AES, default */
+	BT_CRYPTO_BACKEND_AF_ALG,	/* Kernel crypto API sockets */
+};
+
 struct bt_crypto *bt_crypto_new(void);
+struct bt_crypto *bt_crypto_new_backend(enum bt_crypto_backend backend);
 
 struct bt_crypto *bt_crypto_ref(struct bt_crypto *crypto);
 void bt_crypto_unref(struct bt_crypto *crypto);
@@ -59,3 +66,5 @@ bool bt_crypto_g2(struct bt_crypto *crypto, uint8_t u[32], uint8_t v[32],
 bool bt_crypto_sign_att(struct bt_crypto *crypto, const uint8_t key[16],
 				const uint8_t *m, uint16_t m_len,
 				uint32_t sign_cnt, uint8_t signature[12]);
+bool bt_crypto_gatt_hash(struct bt_crypto *crypto, const struct iovec *iov,
+					size_t iov_cnt, uint8_t res[16]);
@@ -0,0 +1,1026 @@
+/*
+ * Copyright (c) 2013, Kenneth MacKay
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *  * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Only to be included from ecc.c, after struct ecc_point is defined. */
+
+/* Table of j * 2^(16 * i) * G, i = 0..15, j = 1..15, in affine coordinates.
+ * Used for fixed-base multiplication in ecc_make_key(). Generated with
+ * ./tools/gen_ecc_table.py > src/shared/ecc-table.h
+ */
+static const struct ecc_point curve_g_table[16][15] = {
+	{
+		{ { 0xF4A13945D898C296ull, 0x77037D812DEB33A0ull,
+		    0xF8BCE6E563A440F2ull, 0x6B17D1F2E12C4247ull },
+		  { 0xCBB6406837BF51F5ull, 0x2BCE33576B315ECEull,
+		    0x8EE7EB4A7C0F9E16ull, 0x4FE342E2FE1A7F9Bull } },
+		{ { 0xA60B48FC47669978ull, 0xC08969E277F21B35ull,
+		    0x8A52380304B51AC3ull, 0x7CF27B188D034F7Eull },
+		  { 0x9E04B79D227873D1ull, 0xBA7DADE63CE98229ull,
+		    0x293D9AC69F7430DBull, 0x07775510DB8ED040ull } },
+		{ { 0xFB41661BC6E7FD6Cull, 0xE6C6B721EFADA985ull,
+		    0xC8F7EF951D4BF165ull, 0x5ECBE4D1A6330A44ull },
+		  { 0x9A79B127A27D5032ull, 0xD82AB036384FB83Dull,
+		    0x374B06CE1A64A2ECull, 0x8734640C4998FF7Eull } },
+		{ { 0x509302446B030852ull, 0x031FE2DB785596EFull,
+		    0xA02DDE659EE62BD0ull, 0xE2534A3532D08FBBull },
+		  { 0x5C42C23F184ED8C6ull, 0x4EFC96C3F30EE005ull,
+		    0x19DFEE5FDA862D76ull, 0xE0F1575A4C633CC7ull } },
+		{ { 0x21554A0DC3D033EDull, 0xEF8C82FD1F5BE524ull,
+		    0xD784C85608668FDFull, 0x51590B7A515140D2ull },
+		  { 0xD1D0BB44FDA16DA4ull, 0x0D012F00D4D80888ull,
+		    0x8AE1BF36BF8A7926ull, 0xE0C17DA8904A727Dull } },
+		{ { 0xC6B0AAE93C2291A9ull, 0x024C740DEBB215B4ull,
+		    0x92D3242CB897DDE3ull, 0xB01A172A76A4602Cull },
+		  { 0xFD7C48538FC77FE2ull, 0x1C00F7701C7E16BDull,
+		    0x6FEC0E2DFBA70379ull, 0xE85C10743237DAD5ull } },
+		{ { 0x300628703187B2A3ull, 0x7EF9F8B8A80FEF5Bull,
+		    0x25BB30667C01FB60ull, 0x8E533B6FA0BF7B46ull },
+		  { 0xC55E1A86C1F400B4ull, 0x53C73633CB041B21ull,
+		    0x6D069F83A6F59000ull, 0x73EB1DBDE0331836ull } },
+		{ { 0xB4DD9DC1DB6FB393ull, 0xC1D238980FCE97DBull,
+		    0x4042742D3AB54CADull, 0x62D9779DBEE9B053ull },
+		  { 0xDA540A6A0F09957Eull, 0xA2ED51F6BBE76A78ull,
+		    0x4FF15D771167CEE0ull, 0xAD5ACCBD91E9D824ull } },
+		{ { 0xD79E8A4B90949EE0ull, 0x9E0ACB8C2C6DF8B3ull,
+		    0x878938D51D71F872ull, 0xEA68D7B6FEDF0B71ull },
+		  { 0xE85A224A4DD048FAull, 0x4D714FEAA4DE823Full,
+		    0x87014A964A8EA0C8ull, 0x2A2744C972C9FCE7ull } },
+		{ { 0x4C36069404C5723Full, 0x45CA6C471C48306Eull,
+		    0x591214D1EA223FB5ull, 0xCEF66D6B2A3A993Eull },
+		  { 0xCA34BBAA44AF0773ull, 0x590DED29FE751EEEull,
+		    0x6E123CDD9D3B4C10ull, 0x878662A229AAAE90ull } },
+		{ { 0x433391D374BC21D1ull, 0x16742ED0255048BFull,
+		    0x0638379DB0C21CDAull, 0x3ED113B7883B4C59ull },
+		  { 0xE2F8EEFCE82A3740ull, 0x090D04DA5E9889DAull,
+		    0x24C843AFA4F4C68Aull, 0x9099209ACCC4C8A2ull } },
+		{ { 0xD500C5EE8624E3C4ull, 0x79983028B2F82C99ull,
+		    0x4626537320E5D551ull, 0x741DD5BDA817D95Eull },
+		  { 0x1995FF22CD4481D3ull, 0x8EEB912C35BA5CA7ull,
+		    0x567383554887B154ull, 0x0770B46A9C385FDCull } },
+		{ { 0x98E15D9D46072C01ull, 0x792E284B65EAD58Aull,
+		    0x61805DF2D85EE2FCull, 0x177C837AE0AC495Aull },
+		  { 0x9C43BBE2EFC7BFD8ull, 0x26EE14C3A1FB4DF3ull,
+		    0xA24091ADB40F4E72ull, 0x63BB58CD4EBEA558ull } },
+		{ { 0x5709277324D2920Bull, 0xF126ACBE7A069C5Eull,
+		    0x7A76647F4336DF3Cull, 0x54E77A001C3862B9ull },
+		  { 0x1BA7C82F60D0B375ull, 0x7171EA7773509008ull,
+		    0x42121F8C05A2E7C3ull, 0xF599F1BB29F43175ull } },
+		{ { 0x63668C63E59B9D5Full, 0xAE03AF92DE3A0EF1ull,
+		    0xADFB378999888265ull, 0xF0454DC6971ABAE7ull },
+		  { 0x47E59CDE0D034F36ull, 0x2A3B21CE75B5FA3Full,
+		    0x4E6594E51F9643E6ull, 0xB5B93EE3592E2D1Full } },
+	},
+	{
+		{ { 0x03E8465C6EADE3C4ull, 0x714AB749C9052A05ull,
+		    0x8E5C643340E586B4ull, 0xA018366F4E91E90Dull },
+		  { 0xF45C42026B26E8D0ull, 0xD5F7284E44614F37ull,
+		    0x7C6CE578349D8369ull, 0xE2BBEC1714110B16ull } },
+		{ { 0xFEBCCEE647A9112Dull, 0xEB7D5ADFFE1CE3EEull,
+		    0x9EA25487EA254C45ull, 0xCD7CE65D707DA2A6ull },
+		  { 0xFFBABE0D3A92B3AFull, 0xA190AA498BEE60A5ull,
+		    0x89B9016AA5EE6708ull, 0x85E04A4B4C966F97ull } },
+		{ { 0x6E1CDEAC59E0AF06ull, 0x92F398A562ED958Dull,
+		    0x50BD3B5A6D45055Cull, 0x9CDF1F00B88D8964ull },
+		  { 0x8D7A32DB6216ADE7ull, 0x828522DC197CA546ull,
+		    0x4D958BBCDC8D94B0ull, 0x916D25FED3F2AD66ull } },
+		{ { 0x6C88AD96C3212F1Aull, 0xE8AF0BC36C998BEFull,
+		    0x8E67D4C73705AE59ull, 0x0F5F0AEA09963471ull },
+		  { 0x755D7B1E7712B09Aull, 0x4F5ED40DDE29AF7Cull,
+		    0x5886AADD4BA16B78ull, 0xF8A8B2B7C8593C95ull } },
+		{ { 0x81372B939305097Eull, 0x38D6170E843BA519ull,
+		    0xAB6B1B2D05404483ull, 0x45BFD9D5D1A663EDull },
+		  { 0x54BA058E908DDC04ull, 0x683B9D33BFD2C159ull,
+		    0xBAD88305470CE908ull, 0x09D1DC12855AFD2Bull } },
+		{ { 0x000349ACD95BCC47ull, 0xB0E2D44B1A7F80EFull,
+		    0x3407FAE48FA79A96ull, 0x7784F06CF9BFB400ull },
+		  { 0x02FBDE0180FBB3B4ull, 0xF464B5CDD4F6FFB6ull,
+		    0x3F8DE493B2FEE6CEull, 0xCCA2733EC3EDC43Aull } },
+		{ { 0xCD31F1A0B63BD6DFull, 0xD1FC23C2DD66AEC3ull,
+		    0x671E9F9C02895E6Full, 0xB599AD156476693Bull },
+		  { 0x8EA1CEA38EFA09ACull, 0x6A40C4F691134B45ull,
+		    0x4637360B8B23C416ull, 0x6979D1DEC4FAB332ull } },
+		{ { 0x2435158CFC4471BBull, 0x91428BF4E1E6E917ull,
+		    0xF15F0D870AE25C90ull, 0x471AD0A8D57F5939ull },
+		  { 0x454318FA49693A0Cull, 0xB0D7E9FF7F23982Cull,
+		    0x2A367AB48094D138ull, 0x2234CA62778E8E39ull } },
+		{ { 0xAF8613F327142D62ull, 0x1D9A6A35F83BC26Dull,
+		    0x92662B1227E854C1ull, 0xF4DCA1F16732AC0Eull },
+		  { 0xAC9ECCC07A618FC9ull, 0xBB979ACEFDCD3D7Full,
+		    0xD49F381B91ABC659ull, 0x551167E5B4B4CD46ull } },
+		{ { 0xA92C68146C180378ull, 0xB3040EBDF3523741ull,
+		    0x49D201427DAF6500ull, 0x45DC683E625BAE73ull },
+		  { 0x42A66EA68E817A27ull, 0xD04CED33A08DF786ull,
+		    0xC89BEAAC3E588137ull, 0xBD0197242631880Full } },
+		{ { 0x1ECB1FF4615FAE61ull, 0x7F15C7DC4F395F82ull,
+		    0xD9C4E240E716BB5Aull, 0xF07278A0E6E09B66ull },
+		  { 0xF7D0CB74896376F9ull, 0x2C270715B837EABCull,
+		    0xF7D7A0821898F7D4ull, 0x1A681B2B14A71EA5ull } },
+		{ { 0x2E06DAE905566022ull, 0xA2D3E61463D4DFFFull,
+		    0x7405E146BE83337Full, 0x93E498F09E88D0D6ull },
+		  { 0xB1CB31EEC7C53F91ull, 0x3B27A24BC689E611ull,
+		    0x9096E0F3540088F4ull, 0x7D974929D221120Dull } },
+		{ { 0x0C4E04152466591Full, 0xBE172EA8FFC68D6Aull,
+		    0xF143AB533BA858CCull, 0x1FC52457AF0A0DB0ull },
+		  { 0x44EFEF57396F8CDBull, 0x29F8CAC232EC7822ull,
+		    0xE9EC76FE5B434E16ull, 0x489C1838089EBC11ull } },
+		{ { 0x5EA48F58173B4DF8ull, 0x1DF4170C442D4D0Aull,
+		    0xCC34630510B36F5Dull, 0xED9EA11F2D7B0206ull },
+		  { 0xCF5AFD9CE069CE7Bull, 0x52ACBB37E2CE6A55ull,
+		    0x3D0E3D4C3F02B537ull, 0x175D2F8031D02978ull } },
+		{ { 0x125D0B8C322A8EBCull, 0xA291CDB718F96715ull,
+		    0xFD7F0B5B30CA56D5ull, 0xFA2501B31A48C5F4ull },
+		  { 0x80D927B5AA8A775Bull, 0xEA58E08E6CBC8331ull,
+		    0x33851E661A6FA8CBull, 0x71C932B14F858962ull } },
+	},
+	{
+		{ { 0x3A5A9E22185A5943ull, 0x1AB919365C65DFB6ull,
+		    0x21656B32262C71DAull, 0x7FE36B40AF22AF89ull },
+		  { 0xD50D152C699CA101ull, 0x74B3D5867B8AF212ull,
+		    0x9F09F40407DCA6F1ull, 0xE697D45825B63624ull } },
+		{ { 0x336DD1E7C68278C2ull, 0xA1DD10B8A60E47C0ull,
+		    0x6554CAA343ADFA5Aull, 0x6177947147864343ull },
+		  { 0x9D03ECB2EFABD2CFull, 0x327969992317A1A6ull,
+		    0x03BFF005C8986473ull, 0x4ECEE7D5A568791Full } },
+		{ { 0x76A78091DF0922A8ull, 0x8E90E9D2545CF8D9ull,
+		    0x80924E56022F8B80ull, 0x4B656A405B4E2D73ull },
+		  { 0x4DADCAC5999A80BBull, 0xD473B9E2B9850F69ull,
+		    0x20D04CC255D8C4D6ull, 0xEE1EA31D12E77839ull } },
+		{ { 0xAEAB93965A7D9344ull, 0xF7221ABA0101B56Bull,
+		    0x193D8758ABF96019ull, 0x521CF0CD89729D1Aull },
+		  { 0x4529F28196B7064Aull, 0x7A1341CA5A95FBA1ull,
+		    0xC583FE0ED386371Bull, 0xD60220DACBF9E9BAull } },
+		{ { 0xB504F88869D07E9Eull, 0xA09E7CA1F6A60C36ull,
+		    0x93DB2BE0FB3D8E5Eull, 0x9D78956EBD65E13Dull },
+		  { 0xF4DD615AC3D8C8EEull, 0x7460A2DA3B94C7B2ull,
+		    0x6542A89C1D3210CEull, 0xD5149E6EF48EA8CDull } },
+		{ { 0xBB430CF33B281418ull, 0x7CE5019BB0000E35ull,
+		    0x4D56C2613639E706ull, 0x7C86B3AD8863A8DDull },
+		  { 0x79DD3EED3117E0ECull, 0x82EA7C317BC0861Bull,
+		    0x4C62B97768DAA72Full, 0xD958BACCEEBEFE95ull } },
+		{ { 0x667750867DC4950Full, 0x5741B2ADBD394207ull,
+		    0x57236846E4DB6316ull, 0x4ACB1272E1353FA9ull },
+		  { 0x66C6E44463D8B4DFull, 0xDF9E4280B5866AC5ull,
+		    0x8CF298F6CC71E29Full, 0x726CD20FB743CDADull } },
+		{ { 0x0B3184A32B3FCE8Cull, 0xBD4BBDEC1543D1A7ull,
+		    0x562FC9EFCE42700Bull, 0x176C11C1328ED07Bull },
+		  { 0x6EA68436A3C9F19Full, 0x5C5D842A5BB51AB1ull,
+		    0x89592180B7DE3B7Eull, 0xD17F8DAE934B8A35ull } },
+		{ { 0xF40C7A7BED7E8CBDull, 0x2A667F8AF007D816ull,
+		    0x234453550C81464Aull, 0x640C5EBF1A6B17B4ull },
+		  { 0x06E2903CBEC5A5DBull, 0xBA069FB18CFF9B02ull,
+		    0x2AE9C6EB701EAB9Eull, 0xD6AE88FD829CFD2Full } },
+		{ { 0x63AE2B005E57D10Dull, 0xAF42E93B573FE788ull,
+		    0x09D378B7CF26B9D2ull, 0x493471ABC939487Bull },
+		  { 0x83259603C6056DBEull, 0xBDADD5EC623364EDull,
+		    0xE96C54F99A845ACCull, 0x60D9691165077EFFull } },
+		{ { 0xF70A04B07E86BDDCull, 0xF1D26B97975CE3D5ull,
+		    0x451562C90DDB6B9Bull, 0x8BBA04B1B4284B32ull },
+		  { 0x5223C5A1E9E349C4ull, 0xC6ACFDE4F4196E5Full,
+		    0x659BF9216699437Aull, 0xC34099C09C208EBFull } },
+		{ { 0x5DD2C18196A081E1ull, 0x482C9028D974A0EFull,
+		    0xFC1C48CF4A13975Eull, 0x7085B59C1C09E312ull },
+		  { 0x914ADEA64659F1ECull, 0x4E9F136375066381ull,
+		    0x3CC6B741515810A6ull, 0x55A062A24931EECBull } },
+		{ { 0xD170E7804257F582ull, 0x1F9909EADEC3A258ull,
+		    0x10A6943F7C5A5FE4ull, 0x8B0A5744FECD37E2ull },
+		  { 0x4817FEDF37372D4Bull, 0x56DB46BA7B160766ull,
+		    0x662A15A137E37D46ull, 0x9E57A44EC0D6C739ull } },
+		{ { 0xD1D41ECA113FB3BBull, 0xC52FBE5033F758E6ull,
+		    0xD8EC684ABBEA778Full, 0x526FD9E3E7B79DD1ull },
+		  { 0x8B72D1CF470B5E0Eull, 0x2622644C6800F600ull,
+		    0xA0FCE55430C0A98Full, 0xCB3D9FDBE104383Aull } },
+		{ { 0x3F1449F9985E797Eull, 0xF06E224F2E3C3168ull,
+		    0x1F856F493D9678A6ull, 0x0A13FF97C2647897ull },
+		  { 0x8327AB9F539D666Full, 0xF27F6F0A7580C392ull,
+		    0x917D818E8FA1DC3Full, 0xEB1A964B225C83D5ull } },
+	},
+	{
+		{ { 0xC2EBAF8017E55104ull, 0xF73A835FBB8E9C71ull,
+		    0x63DE93C34D8B561Cull, 0xD8DE765227B78737ull },
+		  { 0x2A02EF80E52E08CDull, 0xC2F73FCE1940DB1Bull,
+		    0x5C4C628AD1DCF924ull, 0x2FD29465BE13F2D1ull } },
+		{ { 0x06EB9409F722A81Bull, 0xE9227BAB9467B68Full,
+		    0x6020F71756A0A320ull, 0xD03EB26A9A38B79Bull },
+		  { 0x95E25F86D8A85767ull, 0x9DFF1A286DF208F5ull,
+		    0x6CE057045262D412ull, 0x50C5FCB02C21A3E7ull } },
+		{ { 0x6939C2C7E987BFD3ull, 0x87C5472FF4C4284Cull,
+		    0x551DFBEAFADDD191ull, 0xE3A5786FBD518E33ull },
+		  { 0x7ED31B6C8CC23E7Dull, 0xA3DCF2ECD928E081ull,
+		    0x8477B9FF4AD8210Cull, 0xF74BAD09535840E6ull } },
+		{ { 0xE834110D03F61C13ull, 0xFF6986D6F1790DD7ull,
+		    0x2D3AD94E07C7976Full, 0xFE4091010EB8CDA7ull },
+		  { 0xC3D3CECDBDA0B3AEull, 0xF986FBDB99E1D973ull,
+		    0x39486FAF093B0B79ull, 0x081759C1DA404032ull } },
+		{ { 0xB67951D222D5056Eull, 0x0EDCB5A7E247A07Cull,
+		    0x11525FFCE96E5E48ull, 0x42A97041ECA520D4ull },
+		  { 0x48414DC8B0F7DB11ull, 0xB64E483D6E9FD1FDull,
+		    0x6EC36DD26B563B26ull, 0xF2FC7F66CF008706ull } },
+		{ { 0x7BCA829E0A94A6B1ull, 0xCA300C28D0D9E4B6ull,
+		    0x28A7CEBE93FC4323ull, 0x5873B9F32AA7B78Dull },
+		  { 0x52BF9F98DE524C9Dull, 0x1F5054889FFB3DF0ull,
+		    0xF4E0379CC39BB95Aull, 0x17A7DBF4ED5E2EB5ull } },
+		{ { 0xC6745F91D3DAFD3Bull, 0x6FB899F02DCB3956ull,
+		    0xFE232C2ED65379D6ull, 0x0D6CA71B1C27964Cull },
+		  { 0xD6ADF1421A6FE6E8ull, 0xA02248ABEE88771Aull,
+		    0x9FE494A02707DE58ull, 0xA85130B38FDE293Dull } },
+		{ { 0x13D00C248FA8EE41ull, 0xCB4E6644C7743648ull,
+		    0x1E80957063154403ull, 0xC90E300839DD5895ull },
+		  { 0x47A63667C3D7C1AEull, 0x5045534717ACCD6Eull,
+		    0x9C0710C653840362ull, 0x62F504176D19E73Cull } },
+		{ { 0xF6BF9C7FF1131F8Bull, 0x69646960CFA20D4Dull,
+		    0x7D4C22DF9C431FB4ull, 0x05EDCA7AD865A3D9ull },
+		  { 0x0ECF0B19BA6F779Full, 0x33525005F0E89D49ull,
+		    0x01C9D71B5F0271BEull, 0x9E58881E48E886BCull } },
+		{ { 0xB379F9608DC703CCull, 0xAEA569B7160376B3ull,
+		    0xAC9356EB5857C526ull, 0x73CFDACBEF8C6A4Cull },
+		  { 0xA65E18594E1E5C55ull, 0x78EF3B9A43E85885ull,
+		    0x394DFCDF253517EDull, 0x4F80F3584201E6D2ull } },
+		{ { 0x9C8F9F41EB597E4Dull, 0x4974F325E77D1A31ull,
+		    0x121B45A33B771C11ull, 0x5A13C0560BC7A0A4ull },
+		  { 0xAF7E4869E41856E0ull, 0x7BDE87AB59136664ull,
+		    0x51FD18A0F22D73CEull, 0xC9E73C13890F97FFull } },
+		{ { 0xF790B4EFA70216CAull, 0x57E23B198E1539BAull,
+		    0xB21C60AE448FB2EAull, 0xB6EE9F71AB3F761Cull },
+		  { 0x24865BA1C5759234ull, 0x76EED96A290F9F0Bull,
+		    0xC820B826A8E9F4BBull, 0x5594644173E90B46ull } },
+		{ { 0xDAA789614260FAF0ull, 0xA2BBD34597E95935ull,
+		    0x43144E1A680F272Eull, 0x96B25656017B6E75ull },
+		  { 0xC0E42520E366D412ull, 0x890BBF98707D4F5Aull,
+		    0x00AD8E5733BF99E1ull, 0xDCF8A6A001B37CACull } },
+		{ { 0x8D9140F3D7F07578ull, 0x59B20724D6DB1A81ull,
+		    0x455322BB63570DF1ull, 0x8F51C431527FD5DEull },
+		  { 0x500400F045E9298Bull, 0x044CD7048083BE29ull,
+		    0x912A4F8D105DADE4ull, 0xFB97B65F1E044468ull } },
+		{ { 0xA49A1BE4AAD13276ull, 0xCA6350EAE9C043C7ull,
+		    0x26F12B2B387771A3ull, 0x0B971910C41CDE24ull },
+		  { 0xB338F3420A84DADBull, 0x593D79298270FAE3ull,
+		    0xD4E2E45B3BF6811Full, 0xAC28486EF006EEFBull } },
+	},
+	{
+		{ { 0x90E75CB48E14DB63ull, 0x29493BAAAD651F7Eull,
+		    0x8492592E326E25DEull, 0x0FA822BC2811AAA5ull },
+		  { 0xE41124545F462EE7ull, 0x34B1A65050FE82F5ull,
+		    0x6F4AD4BCB3DF188Bull, 0xBFF44AE8F5DBA80Dull } },
+		{ { 0x794A16BAA05F57B5ull, 0x53FE448A57324591ull,
+		    0xE4C13D0306960801ull, 0x031A8747DF8DC746ull },
+		  { 0x1827EE579C0343FDull, 0x1431C18C42B8DEF2ull,
+		    0x60E8AA6C1E387A32ull, 0x883A2C64FDA8D586ull } },
+		{ { 0x752C453F7DB3CDECull, 0xDBEF3A12B228EBF5ull,
+		    0xE596645E7BEA4BC8ull, 0x85B2C064FF912F5Cull },
+		  { 0x8F4D08204A03F81Full, 0xDC980B34E64CF8E0ull,
+		    0x63C7FA2D2FCC6D00ull, 0xF64B278F39D11536ull } },
+		{ { 0x015E2E65580B2322ull, 0x4ECCAC6096513CCAull,
+		    0xF9571975C0D5934Aull, 0xA7163C2B9B973C17ull },
+		  { 0x3933B2232197FFE9ull, 0xB841A4F4E09952D7ull,
+		    0x63389991545A6B7Aull, 0x308A9A797AF31FA5ull } },
+		{ { 0x288A5AE48607B030ull, 0x24DAFF63E584D673ull,
+		    0x7851FBACEC16F29Cull, 0x110B0376C4021467ull },
+		  { 0xF43AA112B3617C3Aull, 0x87BE1556FB298749ull,
+		    0x4C6EB89F8461C70Cull, 0x84432B85318EE673ull } },
+		{ { 0x9AFBD3916A334020ull, 0xA18159998EF9AFB9ull,
+		    0xE22A0772517690ACull, 0x3C714524875D4EEDull },
+		  { 0x6102A85CBA701655ull, 0x152FCAAFE7938C2Cull,
+		    0x4889E729FF7F3D8Cull, 0x7F090565771AAF5Cull } },
+		{ { 0x54EDD81C75A76F08ull, 0x3295F2538BBBED4Eull,
+		    0x14F6E1242B1CAAF8ull, 0x18784E449F6471D7ull },
+		  { 0x0B39605D6B824993ull, 0xFC9D74A7A60A2532ull,
+		    0x1777A8FDAC71E671ull, 0x8D76ED7F4A1E1AE7ull } },
+		{ { 0x6CB04A6A5C42A280ull, 0x02A50C382DB2670Cull,
+		    0x811B3923EF4B991Full, 0x1BFFAB8C03AB8279ull },
+		  { 0xC9C742364DDB9261ull, 0x982A369AA9D24FB6ull,
+		    0x332AC758529F1AAAull, 0x2982B620CEB1D098ull } },
+		{ { 0xCE8E33C9FA6FAD81ull, 0x9C3365748C0CB03Eull,
+		    0xAEF56DD7703A037Dull, 0x58A2F9E07D05E6B9ull },
+		  { 0x5400615E3B109594ull, 0x798BB2D32D300B82ull,
+		    0xC1B682F8717FA6BDull, 0x06AB64C5AC5560E0ull } },
+		{ { 0xF0EBCB0ED3444C74ull, 0x9E5CB1D7B595F7FFull,
+		    0xFB88219241F2D6C5ull, 0xD9A822BA07B6BC2Aull },
+		  { 0x5F9ED1AFC2338891ull, 0x2D6ABBD72AEF8A78ull,
+		    0x0E7B8740FF7B504Full, 0x48E4749ECB370ECBull } },
+		{ { 0xFB22F11F9EB52583ull, 0xEA8A99CEC10CC13Aull,
+		    0x40EE6DBB278F676Full, 0x1EF020DCCE7EBBA2ull },
+		  { 0x55B278197A3F17AEull, 0x6AC300F97012D4CBull,
+		    0x097F6C0F4B969530ull, 0x594476B25A7A14B0ull } },
+		{ { 0xE788E04AB021A9BEull, 0x18B0C59B8AC074B7ull,
+		    0x9D76B8258B28B28Cull, 0x66AA4FD12ADD747Aull },
+		  { 0x88B5A3AC03A15A99ull, 0x9D64422D106AA108ull,
+		    0xCA94F6C567E1DC3Full, 0x10C65E609047474Cull } },
+		{ { 0xB5C23EC1F0A1958Full, 0x4F39B5246FB56643ull,
+		    0x95DD144CFABFA32Cull, 0x4E4A8163C1D6A213ull },
+		  { 0xA43B3F5148636F8Aull, 0x4004085FB2C43D66ull,
+		    0x033F4A3EE29C6FA8ull, 0x2574A45B79E8C8D1ull } },
+		{ { 0xEF0F43B30A7338BFull, 0xD10A694EA5FF8400ull,
+		    0x7C2B1A4EBB312CC8ull, 0xE31D414BC13EA842ull },
+		  { 0xD23C40B0F878F170ull, 0x35CEE4F5D7185BC0ull,
+		    0xA87559754BF051FCull, 0xF8AB200A672A9E53ull } },
+		{ { 0xE8275A8464935DB5ull, 0x281798261C6BDB0Eull,
+		    0xE3327E0ED594519Eull, 0xF6966A16ADD61104ull },
+		  { 0x3A34836C1D166838ull, 0x2D7453A34401BF01ull,
+		    0xC1A5EE572C3C755Eull, 0xBA0DE307A9031DB2ull } },
+	},
+	{
+		{ { 0xD4D3D2DE4351964Cull, 0x346924376F5412C1ull,
+		    0xAE5ABCA185755C08ull, 0x6E29F959BE28C47Full },
+		  { 0x118824BD563FD88Full, 0xEF640C527A0BFB63ull,
+		    0x5052EC6CC184246Dull, 0x34565D9F500F32F6ull } },
+		{ { 0x61E0F0EFE5E84DA4ull, 0x3B09F0776ED90CADull,
+		    0x10CFA381496E6894ull, 0x8EFA0F79B5909A0Bull },
+		  { 0xFDE19F42596969D3ull, 0x79957C4897816035ull,
+		    0x9FA46F1C5DAAFD14ull, 0x242418E7934CD613ull } },
+		{ { 0x3F9501038C0E49CCull, 0x41232DA85BC5400Dull,
+		    0xDD8288DECBB740EDull, 0xD691D4A978970F6Eull },
+		  { 0xDD0BB4C1D00F4152ull, 0xAC5BE1D02AD043F2ull,
+		    0xF7FBBDB5763E0C52ull, 0x7A79E7874B78F397ull } },
+		{ { 0x4ACAF2C0023AC4CEull, 0x1F8973E31EB3F397ull,
+		    0xB9D6D6D0F360DB2Full, 0xD0D4AF73CB8FDB30ull },
+		  { 0xE3DF0360A47DD6B9ull, 0x61850B1C863AAE77ull,
+		    0xBBE9CCEE3E529530ull, 0xED90F8C8F15D7DDCull } },
+		{ { 0x3D876B9F2B9B930Aull, 0xDEB1352A4530F58Full,
+		    0xDEE5B7DF7A7BBC49ull, 0x2A5D6846A2E0D7C5ull },
+		  { 0x86FF345F3B2CAECAull, 0xEA5B73435E271685ull,
+		    0xE5CCF03903C4AB58ull, 0xDC3D7C096876476Dull } },
+		{ { 0x0BC6E130B886719Aull, 0x165CB495470922F0ull,
+		    0xFD851C4D332B75E3ull, 0x8B277F8CE445915Bull },
+		  { 0x078B30FE6ED37C38ull, 0x55213780CEA31A3Dull,
+		    0x6E4B52EE69EC9139ull, 0xCF44D77B164543BCull } },
+		{ { 0xFA7DCBD2816959EFull, 0x7679D056741DB59Aull,
+		    0x2F0431412E275DF8ull, 0x8764496A389BB526ull },
+		  { 0x660311CBE0CD5010ull, 0x2856AD4172F9E3F1ull,
+		    0x9E0B412796ED961Full, 0x599B69D61D002FFDull } },
+		{ { 0xE399DA6192397D42ull, 0x38D1D60251256EACull,
+		    0xA6D6F71B65B85F90ull, 0x829B8DD0ED5452E8ull },
+		  { 0x91B71631E3DF5612ull, 0x5C5ADC4263AD1A5Dull,
+		    0x99E73C8A896241AFull, 0xD300EC543FCCF46Dull } },
+		{ { 0x639409CE3AEF0F84ull, 0xB0BB506A871C75B9ull,
+		    0x33DE3FAC17ADB8CAull, 0x94D393BC812471B1ull },
+		  { 0x85AE61B9378BA7C1ull, 0xDD3F402650ACF12Aull,
+		    0x1E1CBC386B239A07ull, 0x5A826AB4EB4B63F2ull } },
+		{ { 0xEADECF09028CDCB4ull, 0x72A1B40690A1CF86ull,
+		    0x2EA231DCCE55180Full, 0xE925A006C6F2A348ull },
+		  { 0xBB9619760589AF3Aull, 0x8EAD37DD62073759ull,
+		    0x4DD045436194510Dull, 0xE402787FAD456996ull } },
+		{ { 0xED455784EFFED1B7ull, 0xE2DBD126564AA3B4ull,
+		    0xD17509702D34BD2Eull, 0x4A72B5A0889E4E2Dull },
+		  { 0xB5F29FD89601DC5Full, 0x85E64B8EC74D9845ull,
+		    0xC8C33FC047C8EA96ull, 0x3531E6EA4A1D20E2ull } },
+		{ { 0x368F5340EA0046BFull, 0xCFCF8A096442A045ull,
+		    0xEC01DB905A3615F7ull, 0x88EF3688969B1509ull },
+		  { 0xEBE6AD23BFA86F2Eull, 0x8AE2D212F193196Cull,
+		    0xDF93DEEA7A4B46FCull, 0xE4204DDF22F356B9ull } },
+		{ { 0x02043F25D0467317ull, 0x9141DC41D8D9186Aull,
+		    0xA78666F2FADE7900ull, 0xD7F01CFC5A371E15ull },
+		  { 0x5CB957D5CF7D014Eull, 0x28A01743697FBD89ull,
+		    0xEC7361406C15EF57ull, 0x888DBBD987726C26ull } },
+		{ { 0x33BE1811B6799F9Aull, 0x85D6390ACDF4C550ull,
+		    0x072DB42A73B408F2ull, 0xDBFE86D71283894Full },
+		  { 0x50DE611DC79DC6E9ull, 0x7FAEF77D234E71F8ull,
+		    0xA558A73FBF3E51FCull, 0x445B3C7D17C68718ull } },
+		{ { 0x3BD7590A7DEA02C1ull, 0xE4FBB9B7C774087Cull,
+		    0xBE80BF9D91E31206ull, 0x7E50A0B9F77C371Bull },
+		  { 0x33C946DFED45C201ull, 0x7423934F158E1B28ull,
+		    0x616C6F1DDB8B9517ull, 0xC3405D3C4E0FE29Cull } },
+	},
+	{
+		{ { 0xA84AA9397512218Eull, 0xE9A521B074CA0141ull,
+		    0x57880B3A18A2E902ull, 0x4A5B506612A677A6ull },
+		  { 0x0BEADA7A4C4F3840ull, 0x626DB15419E26D9Dull,
+		    0xC42604FBE1627D40ull, 0xEB13461CEAC089F1ull } },
+		{ { 0x1B68EDCCBF8D5842ull, 0xDA74BE4D8455B67Cull,
+		    0x521473143EB337C5ull, 0xCC8FE9ECCCDAF543ull },
+		  { 0x567E1AC9487100C7ull, 0x5DF1592D458677C8ull,
+		    0x75CEC6140B91FB77ull, 0xC2A5D01CD9F2FC3Full } },
+		{ { 0x52EF40E2518473FDull, 0xBBB9026BC6973391ull,
+		    0x85292AB99728A9E3ull, 0x1064063233318BA0ull },
+		  { 0xAFA6162E785CF805ull, 0xCFBE190D0C21D039ull,
+		    0xC8E7829E6585883Cull, 0x9C6832823B8BA2D8ull } },
+		{ { 0x23F389BE0C37DA54ull, 0x71B0B96CBC1184DEull,
+		    0x8006B50F37E86261ull, 0x11C881390823D8CEull },
+		  { 0x567C651408EE3DF5ull, 0xB3E32B21384D2ADFull,
+		    0xA42AAF13CAF61AE4ull, 0x82F5CA516726BDA3ull } },
+		{ { 0x3567EEC8653F30F3ull, 0x2B423ED2EDA238DDull,
+		    0x5EDA410D54083F21ull, 0x38C8AD8FF05F27BFull },
+		  { 0xA060E749EBE9217Bull, 0x6583FA982959DF37ull,
+		    0xF3909654DDBD641Full, 0x83C2617876DCB116ull } },
+		{ { 0x62B66E34FD7046CCull, 0x280398B6E32D8D77ull,
+		    0x23A5D12E930F5E51ull, 0x3F789C12505A876Cull },
+		  { 0x1487856590683E4Dull, 0x6320DE848E0B3FD6ull,
+		    0x64C974DD964E47A2ull, 0xD0D9F1B3A291A6E5ull } },
+		{ { 0x543E6911B6EF1584ull, 0x77A9A2A38F920CBFull,
+		    0x5858FBE3FD351842ull, 0x6FCB8CBCE860BB09ull },
+		  { 0xC3C9F7C21D3110F2ull, 0x5992F6D6928A4325ull,
+		    0xD54C0823AC30459Dull, 0xA8F1A83D8B721D76ull } },
+		{ { 0x355C95A1FD698F73ull, 0xCB4CB3A72A5C98EAull,
+		    0x676E37E7FC8B8D71ull, 0x9C7A4EFA52A32680ull },
+		  { 0x122443BD120CF142ull, 0x94B07CD5EA879E7Cull,
+		    0x16C424C1D0ADE69Bull, 0xA2C4A71AB2150C7Bull } },
+		{ { 0xE8F51340462255EFull, 0x50D71D346764078Cull,
+		    0x73515C90DE45B0EEull, 0x7811D0B93F76E2BDull },
+		  { 0xA58BEF9B1BE3252Eull, 0xF51ED0513AD43768ull,
+		    0x54C02E9401B85132ull, 0x99BB76370BB5AC7Aull } },
+		{ { 0x1BF6578B3517B889ull, 0xB998A3F0AFB9323Aull,
+		    0x3798D6C6E4CB1ECFull, 0xBAF532BFBEC94D7Dull },
+		  { 0xFA19FE6749FDCA6Cull, 0xFEF1D3823E27338Full,
+		    0xF1B51983B721939Dull, 0xE7BCC2A44E4A22D0ull } },
+		{ { 0x93E110F1353D2EA7ull, 0x9EED0823A3FA8650ull,
+		    0x0C7B729D5F816F2Aull, 0xC3583D944A8B50CEull },
+		  { 0x2B183E9E0B667BBDull, 0xD6C925A6515F1C43ull,
+		    0x5964627EF89FCCCDull, 0x53967AC09391E90Full } },
+		{ { 0xFDF0B36A7A032C75ull, 0xA4F6C1826B9D71D5ull,
+		    0x346E877E467A90E1ull, 0x0280A27D97EF8D60ull },
+		  { 0x6C3043CB76C0F2B1ull, 0xDC7171891F30FD67ull,
+		    0x41351993ED79A6ADull, 0x8CA3591D1507693Cull } },
+		{ { 0x8EDDF0E0502E3099ull, 0x53F213A662840165ull,
+		    0xF3A0F018BB7AD00Dull, 0xD591CF283CDEE501ull },
+		  { 0x33BC2765455AC5AFull, 0x5CF2EFF88B116FD6ull,
+		    0x4E51330D350BC582ull, 0x87EBE5CFC478E6E4ull } },
+		{ { 0xC03562BD884A85E9ull, 0xDC75980F62E2FBA9ull,
+		    0x829800F8315DA4D5ull, 0x86192922E83C5BC0ull },
+		  { 0x34B026A6CF94138Bull, 0x72EB2277193E431Full,
+		    0x9F84E2C1FA2CBD68ull, 0x9A468A0E4B1B52DFull } },
+		{ { 0x2B26564632A940A5ull, 0x4A435EB5A414E6B1ull,
+		    0xC01241E1A4F9E871ull, 0xA0AA0D612F3235C4ull },
+		  { 0x93F882A68B950422ull, 0x6C691CDDA7D1BF93ull,
+		    0x19B34CF9A0181F3Eull, 0x22340EBA76F76428ull } },
+	},
+	{
+		{ { 0xF0699BF9E2F2B734ull, 0x79C3BB5B5501D267ull,
+		    0x0634A786F1164457ull, 0x224A02299EECC99Aull },
+		  { 0x840F585491EC7FDFull, 0x07B704B673C7AFD0ull,
+		    0x149A08AD871D7FFFull, 0xFA41A8D29B6D22B4ull } },
+		{ { 0xA8DF3DAE1991E607ull, 0xE310D10E196E11DEull,
+		    0x760F78B8AF6B2261ull, 0xAFD35B35BEA5BDA1ull },
+		  { 0x5E0B73BC4308126Full, 0xBAB7D9872155AF41ull,
+		    0x96D8EE266B81EC93ull, 0x03555F48E204E994ull } },
+		{ { 0xC9E92F475D254033ull, 0x78368280C2A4707Aull,
+		    0xFCDADFA688B6F240ull, 0xE63502EE153CEC59ull },
+		  { 0x7E8AA88968F05E3Full, 0x2C915A0C4BFCF360ull,
+		    0xAD74E80F0709CE48ull, 0xA7C5837B1F621E11ull } },
+		{ { 0x7E16CC51F0B9A00Aull, 0x05174DA42F93E68Full,
+		    0xA0C7CC97B56175D5ull, 0xE5CEAC4035EB4955ull },
+		  { 0x157FF80E67984A57ull, 0x8CEDDB7586FE794Full,
+		    0x854A459C3396D1E4ull, 0x660CB9301FCD56B9ull } },
+		{ { 0x2B9609AFE1E08F33ull, 0xB1FD631DCB982CCAull,
+		    0x12AB45C533F000E2ull, 0x5648DEC272EB9687ull },
+		  { 0x26EED9AC4269F1C9ull, 0x3E72BBF2E0117951ull,
+		    0xF478F5C64D77A269ull, 0x95FDDC70708F7043ull } },
+		{ { 0x8DAA3455E8A5C546ull, 0x1F0EA68BA3187B91ull,
+		    0x3E774B6D5268D693ull, 0xA643C538AFC5667Bull },
+		  { 0xEB1E337CD3FFF857ull, 0x4893DB480DC64A7Bull,
+		    0x460033011CFD3519ull, 0xA8D602EA4377DB0Eull } },
+		{ { 0xE3B8200BFAB98C43ull, 0xC5BA57757E3E8AA4ull,
+		    0x95152F8ECBEC8F03ull, 0x1941C19F3380ED26ull },
+		  { 0x8FA210DA22ABE217ull, 0xD8F62D3DB8DF5639ull,
+		    0xE2B6DB2A48FB8C53ull, 0x8E66B834595DB2B6ull } },
+		{ { 0x4F556DB22343750Bull, 0x944995A27D329C76ull,
+		    0x8EC64FD2A2B75F9Cull, 0x0E415C462BE67902ull },
+		  { 0xA6097C15BECD56CCull, 0x6EF691A45FF7EC06ull,
+		    0x27BCA21077F8CDDCull, 0xC3056E7177F984E2ull } },
+		{ { 0xE6670D1042D8C2F4ull, 0xD73321B9F79C0189ull,
+		    0x7FA73BDE364D8A0Bull, 0xFC586431D10B4BD6ull },
+		  { 0x0118C88FFCFD274Aull, 0x29E2CB05EBC338B4ull,
+		    0x4A33C279E6BDB4ABull, 0x99FADE52CE8AD956ull } },
+		{ { 0x830CE044E750B852ull, 0xA172F111C50C5F41ull,
+		    0x3A3B61F117D48ACDull, 0x956D85AC3FCA3E4Full },
+		  { 0x5F09724600EB56D7ull, 0x2DCB5B21ADC5C746ull,
+		    0x8911E9CD3B8293A7ull, 0x371A37CCF6DEEDF9ull } },
+		{ { 0x12B077F1D1FF0F18ull, 0x07E0BCE70549A42Dull,
+		    0xA9BFBACF9AF2D6C2ull, 0xEE993BA6B0C4F1DEull },
+		  { 0x8013876CA50782ADull, 0xB435C80DF70F2CB1ull,
+		    0x1F6C5D58CE85BCFEull, 0xD87FD4D94578DB2Cull } },
+		{ { 0xD77107B51F2CA098ull, 0xE4066263414B9D7Aull,
+		    0x6148A999FE559BF5ull, 0xD9BDB44B1B3520A3ull },
+		  { 0x7406BBD75ABCA6B7ull, 0x0DE0C9740EE3AB32ull,
+		    0xE5E5518457563F01ull, 0x552624FDA1DD30CDull } },
+		{ { 0xE47A7F754FDDE3FCull, 0xE5A8889E05628CC9ull,
+		    0x8DA0DC41A52F31FBull, 0xBA49517AAE9FE242ull },
+		  { 0xA3EFD232EFCB7D01ull, 0xDFDE1C81E3292CAAull,
+		    0x0B4EE4376013359Aull, 0xA88FB6E1CA945595ull } },
+		{ { 0xDC9D02357A6FE7CCull, 0xC365429884F435B7ull,
+		    0x78A0D632207686B5ull, 0x6D354193D97A95B8ull },
+		  { 0xC41AFB5FEEBDBCDEull, 0x5249918F8B53468Cull,
+		    0x3F44255459CDB568ull, 0x6F5D4E0DA0883528ull } },
+		{ { 0x78892A2F7D14DA68ull, 0x4A64C1F84DD20173ull,
+		    0x4DE2CF82737612B5ull, 0xD3398F17422AF1BAull },
+		  { 0x3F07631B55A90E3Dull, 0xAFC7A7922D41453Aull,
+		    0xEB7252D1E8A2B020ull, 0xA34AD4D4D1FD3D60ull } },
+	},
+	{
+		{ { 0x57C84FC9D789BD85ull, 0xFC35FF7DC297EAC3ull,
+		    0xFB982FD588C6766Eull, 0x447D739BEEDB5E67ull },
+		  { 0x0C7E33C972E25B32ull, 0x3D349B95A7FAE500ull,
+		    0xE12E9D953A4AAFF7ull, 0x2D4825AB834131EEull } },
+		{ { 0xEB0421211A6B665Eull, 0x802F779EA7F6803Aull,
+		    0x47501F2A3C0804C3ull, 0xA263919B4945A1D4ull },
+		  { 0x9EE4040030BCDCFBull, 0xAC3F83DF4C00EFE2ull,
+		    0x2E9D3C9DE60D60C5ull, 0x873200BD2AED20FCull } },
+		{ { 0x73E1998EDEA6DB68ull, 0xDDFAD856082632C2ull,
+		    0x58B14DF965DEF4F6ull, 0xF8B6533E03CA017Full },
+		  { 0x69BD25B0AE760DA9ull, 0x6BBD70DD9C5CA0EDull,
+		    0x2F046DDA50AA3EC6ull, 0xC30F4EF5EC445486ull } },
+		{ { 0xF6F1D3AC4D771F0Cull, 0xACAD16E63BE0AEA8ull,
+		    0x18E63ADD579547F0ull, 0x2890D721E57E1961ull },
+		  { 0x0A5728ECB5890D78ull, 0x7DC0E7F77EF54069ull,
+		    0xAF77E1D1416752ECull, 0x69B5B8159DDC032Aull } },
+		{ { 0x66D5D4EBF924E753ull, 0x5F0173072CF8727Cull,
+		    0x548EF18729EDFB75ull, 0xF35289D35582847Cull },
+		  { 0xAA45B5C2EB13A20Cull, 0xC562FC57292D0F04ull,
+		    0x93DF08A1B50E1BD8ull, 0x75C1781EC5EC13FBull } },
+		{ { 0xF8B6930D2670213Aull, 0x946D1BF2AF7A9DA4ull,
+		    0x5430C3C0595033CBull, 0x929F5CFAEC5BE480ull },
+		  { 0xA53059C5CD486F14ull, 0x1B383964F7F20170ull,
+		    0xC5AC64BB51E39045ull, 0x29CD3692293320C6ull } },
+		{ { 0x2395CB673018017Eull, 0xAF141FFFD6DF23D7ull,
+		    0x4834185FB6734E01ull, 0xCFD06B74DA441716ull },
+		  { 0xA0AE7BE4CE0DFF50ull, 0x003030786B779777ull,
+		    0x8103B39587DA7950ull, 0xB647B7A9B72BA913ull } },
+		{ { 0x4F5822EFAC7E9E44ull, 0xD4E3FF5E71DA1781ull,
+		    0x81690628033DE305ull, 0x7B8B8867DD4D9C6Full },
+		  { 0x0767022AA8CD12C3ull, 0x64057E6DBBD72365ull,
+		    0x2246073C7DD5ADB5ull, 0x8BC6273E511680B4ull } },
+		{ { 0x04C81905792DB860ull, 0x81089288329A247Bull,
+		    0x1512D6D08F15DBE9ull, 0x0755E74C4AD5DCD1ull },
+		  { 0x7D6600DBA0D09849ull, 0xB2937464CFC2777Aull,
+		    0xD249B2D823815BC2ull, 0xFE16AFA753AD9E4Dull } },
+		{ { 0xC6327E20CC2F3082ull, 0x585E6C58DD17AEB9ull,
+		    0x7BBF9038D79BFF6Bull, 0x823C8DE5A5E97DBEull },
+		  { 0xAC1B42A9958BD76Cull, 0xCDF006775A45964Cull,
+		    0x17EDCE97ABBFE885ull, 0x61FBA612A1E936CDull } },
+		{ { 0xA9EF6955EA26BA6Bull, 0xDD2CA2A496DA12C3ull,
+		    0x68A10C0D7EB0BBDEull, 0x88FBA84CC372C969ull },
+		  { 0x80414781E44972F8ull, 0x484A9E28E00CFDCEull,
+		    0xD266DA45B514788Dull, 0x512AEF649D39BE0Full } },
+		{ { 0xEEE143C1F0F870D2ull, 0xCF8A00249E4D1558ull,
+		    0x02FAEA8E759ACD21ull, 0x05F0C3CABE40EDE9ull },
+		  { 0x5F537C956E60E8CCull, 0xC2F725737AEB5F8Aull,
+		    0xBCE7A5998AB1AC23ull, 0x34B55D934F6D2C56ull } },
+		{ { 0x39C48A4294720CABull, 0x1A1EA5D41739B17Eull,
+		    0x8E50F6E7555C6F2Cull, 0xE1A0ACCBEC055BEBull },
+		  { 0xA6D453F574B185C9ull, 0x084A2A71D080254Eull,
+		    0x1836F83077EEBCBFull, 0xE07968FB7E98C854ull } },
+		{ { 0x3A5357FBC1F6B0BAull, 0x8101DEBA1F12354Dull,
+		    0x1FD65B91ABEF8070ull, 0x9211EA4A827801D8ull },
+		  { 0xD91415F9A2B8E349ull, 0x4EE478B7AF28BBB2ull,
+		    0xC74BA7E95899CD44ull, 0xE7E91892E2152AB3ull } },
+		{ { 0x2A828FDFEC26C42Aull, 0x249BFB7E46B11BB6ull,
+		    0x50DB358931E7E6A0ull, 0x0AE93B86E6A73C7Eull },
+		  { 0x91063343B9F808CAull, 0x278A39EEF5AADB64ull,
+		    0xA942E3EDC1E20B37ull, 0x7028F6DD14787E13ull } },
+	},
+	{
+		{ { 0x826FADC0523B716Dull, 0x0D238966F74E1A6Bull,
+		    0xE8A5C7938D18DF9Eull, 0xF81F5BE38B8CA534ull },
+		  { 0x464002F512632401ull, 0x660758503A878330ull,
+		    0x1D56D29D380E0328ull, 0xDC7F49329C1F06DFull } },
+		{ { 0x46E0C52790789539ull, 0x0E4E1A713BD05725ull,
+		    0x158EA76280D63182ull, 0x7459E772C29C4C3Full },
+		  { 0x3CDF5A471439D97Full, 0x383AF5E04F7DB391ull,
+		    0xEC7E8E858A2EC1A9ull, 0x892BC7F5183444EAull } },
+		{ { 0x84C5685039D19D8Aull, 0x3B41278951A55215ull,
+		    0x5AF6EC35C16D490Aull, 0xA6008450FB128638ull },
+		  { 0xFD95DBB3590D2C4Full, 0xF0FE008FA726573Dull,
+		    0xC8F6D45E7BE9CA84ull, 0x7B4B79C067A37C72ull } },
+		{ { 0xF4727E8C8EF2DFE7ull, 0x345E4FD95B8881C4ull,
+		    0xC604C9F87D2EFD3Full, 0x2E1C7C383D7F8492ull },
+		  { 0x3F85CCA2C55E5F2Aull, 0xC2D747D667B0C5BDull,
+		    0x6D9F4529FF7EA8F1ull, 0xC629DC2B09F0BE26ull } },
+		{ { 0x26987B39496CAC9Full, 0x59E38CEA5C44DE72ull,
+		    0xC64C09798FEB0E1Cull, 0xDE5382B1967DF354ull },
+		  { 0x7CE082FDAFA473D3ull, 0xC2E3E29473D84115ull,
+		    0x62C3B00991CF9F2Bull, 0x9C47B678B69C9185ull } },
+		{ { 0x3B4C7C0831BF35A9ull, 0xE2ED30366D621C90ull,
+		    0x40CB0798638B5965ull, 0x74DFABECC5345E53ull },
+		  { 0x3615B07B36A268E1ull, 0x3F5FA126C564848Dull,
+		    0x69281E79C517CE99ull, 0x48341B4C8956A770ull } },
+		{ { 0x7CB2963786807A23ull, 0x400020516A25FF3Eull,
+		    0x5344B99D51194EC8ull, 0xA7227B0807F2A908ull },
+		  { 0x1C471983D4115894ull, 0xE7BF8157B728CDC9ull,
+		    0x45DA847920A075ABull, 0xF5507525D45D39E8ull } },
+		{ { 0xACEBE833F2F21873ull, 0x022FC19D8429B019ull,
+		    0xE63138A90228DC28ull, 0x8C86799B36E7D519ull },
+		  { 0x8905B7D7E5159140ull, 0x5DBF4306E861F0ECull,
+		    0x61CE9FE475A272D1ull, 0x5C0C2C12A5A3E85Dull } },
+		{ { 0x5A797FC2044D14C0ull, 0x005CAB5FA1A8F35Eull,
+		    0x465ABE73A3661D39ull, 0xCD2B2E8D42344596ull },
+		  { 0xA560ACF222496315ull, 0xFDDB6F0CB9ACCECEull,
+		    0x4D505EEDDAC0F671ull, 0xF13012DF9B0870A2ull } },
+		{ { 0xA94A60E30F18A7ABull, 0xEAAFC3E392C6CDC9ull,
+		    0x12DE04490CD9BA82ull, 0x183950FDDD7BE0A1ull },
+		  { 0x6AE5DDF8560B4B74ull, 0xCC6E77E9D46108BDull,
+		    0x81CDA4CB3F77A930ull, 0xAA8CBEC079204CC3ull } },
+		{ { 0x66F4EB12399A1566ull, 0xF25C655AFF228F69ull,
+		    0x4CEFBC9B83DF9DD8ull, 0x11B2E84C8F0DF7EBull },
+		  { 0x59A4B3C05C56BB73ull, 0x824B55840CD80968ull,
+		    0xD042D698797405CCull, 0x6103769DBCA23175ull } },
+		{ { 0x5FD577FAB0F2928Cull, 0xF6BC238850E7187Full,
+		    0xA088CF12640A72F1ull, 0x675107E17BC4604Dull },
+		  { 0x8740BE4015174F14ull, 0xB26711D18B114573ull,
+		    0x5D664043D781F304ull, 0x6034E0018EA3F8D3ull } },
+		{ { 0x7D09EB28DBA6F34Aull, 0x31286A0FE245C6F8ull,
+		    0x759DA0A3EF991485ull, 0xFB6D19295F2BA070ull },
+		  { 0x9B5F3C822BCF0452ull, 0xECFCFA2DC9685B1Full,
+		    0x9E388FD4C4A791B9ull, 0xF29B2D29D7BF46DDull } },
+		{ { 0x48FCC264147C34D0ull, 0x26DC449C991C9EB3ull,
+		    0xDDB77E96F0B512ACull, 0xE42B60F34A9E51B9ull },
+		  { 0x6DE84BD897A87EB0ull, 0xBDF8BF104FC3C2F0ull,
+		    0xBE07CB0C7EB81C57ull, 0xFF0CC44F2CD6F0DDull } },
+		{ { 0x74CA2D2A0A435427ull, 0xA690109827E4DB50ull,
+		    0x0AAF67650D906651ull, 0xFF429FCC103C13C1ull },
+		  { 0x8E50450D39853824ull, 0x205BEE534A3A0DA2ull,
+		    0x94D409C856186876ull, 0x2ADDF9668A4ECDB0ull } },
+	},
+	{
+		{ { 0xAEE9C75DF7F82F2Aull, 0x9E4C35874AFDF43Aull,
+		    0xF5622DF437371326ull, 0x8A535F566EC73617ull },
+		  { 0xC5F9A0AC223094B7ull, 0xCDE533864C8C7669ull,
+		    0x37E02819085A92BFull, 0x0455C08468B08BD7ull } },
+		{ { 0xE8B043C401CD7F36ull, 0x5799C8F19419149Bull,
+		    0xD36E2C6048BDFA17ull, 0x4EAFA17A88814D84ull },
+		  { 0xC778C64A0B2D1C43ull, 0x5036A58CAD4543D2ull,
+		    0xEE45531527EFC47Bull, 0xA47974D851EC201Full } },
+		{ { 0xFB14F217AB348FA0ull, 0xE0FE2459051541DDull,
+		    0xC2A223236C24B4BCull, 0x86EAC93DDDEB882Dull },
+		  { 0x4EE380954DA51CEEull, 0x6C26D96351CFEE8Aull,
+		    0x5A436F9E8D6F4671ull, 0x948F3853CBBC4D8Dull } },
+		{ { 0xCC319D54B96214FBull, 0x71DC987A8FEBC765ull,
+		    0xCDA9E496CDF1C589ull, 0xC6122FC44FBFDB25ull },
+		  { 0x3702BD8FB7ADFFF7ull, 0x08A6E48C1E271F8Aull,
+		    0x9031C9868877F91Full, 0xEA205BEC8343AC41ull } },
+		{ { 0x7AF41FFC99222C03ull, 0x948CE77E87E5E103ull,
+		    0x3F5E7D784859F407ull, 0x8BF09EBAF9FB3AAEull },
+		  { 0xA145F742EA72BB54ull, 0x9C9EC0E1DE20E1D4ull,
+		    0x3B48B1DBE7E5BA30ull, 0x509CBAAFE2E27A73ull } },
+		{ { 0x1686977A8D215BFDull, 0x8BE074267F1462B7ull,
+		    0x85B6220EA2D65D24ull, 0x8B4FCEBE1F52629Eull },
+		  { 0x06EAF00A475EC26Bull, 0xF9D502D09D21ADD6ull,
+		    0xF96FB1CADA9254FFull, 0x1F3307A9A822157Eull } },
+		{ { 0xB453A2C1D1AE9300ull, 0x5E1C470475C48280ull,
+		    0x19130BADA2F3735Bull, 0xE85E2DCBB7E70FC6ull },
+		  { 0x72A0DFDD1546E25Eull, 0xDEB7E185DF8C31BBull,
+		    0xC7BA7B5B823C2707ull, 0x451AAFA6D51CE0BFull } },
+		{ { 0xE97BE9ED0E9D6B84ull, 0x6F4FFFDDEE86B987ull,
+		    0x24B4042C13019FDAull, 0xB6D94022C1812137ull },
+		  { 0xE1BCAA0FBCA7CB21ull, 0xC23273EAEC4F382Aull,
+		    0x8634478884D77AD3ull, 0x93FF3F4162928723ull } },
+		{ { 0x2525D55605260CB8ull, 0x836F4A80CEB2152Full,
+		    0xA3F027DA1BA7DBF6ull, 0x3F5FB0F228C92F82ull },
+		  { 0x72FB4B441852C964ull, 0xFA3E8751FC5EC332ull,
+		    0x0E38DE15366783F2ull, 0xC55834DADA499987ull } },
+		{ { 0xEC11FC70323BA10Eull, 0xE0D54ADA7C4C386Aull,
+		    0xD92FFC6AAD7E567Eull, 0xC453BFC7281CF5C4ull },
+		  { 0xF2C263A396EE110Aull, 0x67ADB73EBB9E9BA2ull,
+		    0x2DF5245C3FE776CAull, 0xE6FA24418B36635Dull } },
+		{ { 0x4AA44442DA1CD60Full, 0x9F9698A9CC3092EAull,
+		    0x57AED074B4DA002Bull, 0x33685622B18D9996ull },
+		  { 0x4BF737650FD57D67ull, 0x5FEF5A4CBC50B8B2ull,
+		    0xBA858C00DEA7AF17ull, 0xD42F509EF1247CD9ull } },
+		{ { 0x6B96E60EC43E4011ull, 0x657FE995DDBB2E9Dull,
+		    0x8622F79DF3C7D730ull, 0x4C302E77F4602E9Dull },
+		  { 0x991210B65C5D5B0Bull, 0x8349CD4299A3FE76ull,
+		    0xC335017A576B9579ull, 0x776BC24768D62940ull } },
+		{ { 0xF053B6EBB7576342ull, 0x5B2C88833999222Aull,
+		    0xF7D0F9D8960979D9ull, 0x4813EB5C08F00080ull },
+		  { 0x64C155EB97376316ull, 0xCA2DC67D506A904Full,
+		    0xF66016848E33524Aull, 0x00043FD4233A4240ull } },
+		{ { 0x7B65E413A304E88Cull, 0x3173B811BB7F88C6ull,
+		    0x3754CC46FE2BB908ull, 0x871257A6D8FCB31Cull },
+		  { 0x31B8B859F97623C5ull, 0xCEE324D7B43C076Cull,
+		    0x2856CDF59CB86527ull, 0x10C8E34819BAFF2Aull } },
+		{ { 0x9F67171DFF69B2BEull, 0xBA41F74EDC1111C0ull,
+		    0xF1322DBBAE386E56ull, 0x80C3F1F9A5AE997Aull },
+		  { 0x8904B97C4102D2F5ull, 0xF14B74B35CB7A8BFull,
+		    0x2980E2765B1D5A9Bull, 0x0A932140A009DE85ull } },
+	},
+	{
+		{ { 0x28CF1AB99076F57Bull, 0x030B86E3CECAC607ull,
+		    0xB927E3501CF2A53Full, 0x20E118564880C79Cull },
+		  { 0x8583BEDBADA7AFE6ull, 0x9FE0DC9B40E1B71Eull,
+		    0x31BDC3E3FB6DE997ull, 0xFF67B352AC437EF7ull } },
+		{ { 0x9E849544D4C20855ull, 0x62DF6C0F0BA0405Bull,
+		    0x3FEFE10D9289D72Bull, 0x4EED0B4DFBB5C307ull },
+		  { 0x4C087A3F8BDFFD1Full, 0x1136CCD32D34FE3Full,
+		    0x1941D3287FC115C8ull, 0xACE0FB288A56693Aull } },
+		{ { 0x849E3AED4B661DA4ull, 0x940A51AC64A84A5Cull,
+		    0x8F7C7FD903061A21ull, 0xFFCA2A5BB86606CEull },
+		  { 0x8984835EAF9B8A5Aull, 0x478F87ADE5687F6Full,
+		    0xA53CC9A148F46C8Cull, 0xCE1CB0E32B71CDC8ull } },
+		{ { 0x83D637E60524722Bull, 0xFEB99F12E6A12DE7ull,
+		    0x0A45B1168ED12D20ull, 0x42E0437C7ACA84F7ull },
+		  { 0x766939C81FEA76C6ull, 0xDBEA2A6DAF54265Aull,
+		    0xBAFD84CCC9B4EA3Eull, 0x2DE1DA0901D920EEull } },
+		{ { 0x3CAC1E139C8CFD22ull, 0x4E2B0671B636BE58ull,
+		    0x636535150DAD354Aull, 0xFF209CEDFFC116ABull },
+		  { 0x2389B14E93BC5535ull, 0x0D4F4B92C9684B94ull,
+		    0x207D41D24CCFF1C8ull, 0xAD79F397469D0F7Eull } },
+		{ { 0xC4AD7478ECDC9426ull, 0x0E411D07935382A4ull,
+		    0x9025F8240670DFDEull, 0xB30DDEFBC268D865ull },
+		  { 0xF33E104B29C7275Eull, 0x5B93309CAEC0238Full,
+		    0x4AB3871BC983D48Bull, 0x7DBF4FD5C014C153ull } },
+		{ { 0xE807E5858F4E983Eull, 0x6D9E6EC87017F77Cull,
+		    0x58604080D33B4B15ull, 0x33D5F02D0B079BA9ull },
+		  { 0x6D70DB8791EA37A9ull, 0x7A71AA9259630C95ull,
+		    0x73C3D61655BBA1EBull, 0x01EB5A76D39C4784ull } },
+		{ { 0xC6F24FC37BCEC904ull, 0x49A7CBF2445CC228ull,
+		    0xC499EA8FC2EF48C9ull, 0x070D96CCC51AFB00ull },
+		  { 0xF62F4DB2A3AB316Full, 0x53BDEC7B34681BACull,
+		    0xFC61582D55F0E977ull, 0x9B915EF5FF0ABC21ull } },
+		{ { 0xB695A79F61E52A73ull, 0xD0E3116C9705A1BCull,
+		    0xA9E974D9ADBB5E65ull, 0x8F1BD23DA6261690ull },
+		  { 0x57DA1451EBEA8F2Eull, 0x590502E64B1850A8ull,
+		    0xB8769E430743EADEull, 0x4C7A8F6393ADA8B8ull } },
+		{ { 0xB99A48999B3AC988ull, 0x422A103D58FB12CAull,
+		    0x90F30CFF81CF63F0ull, 0x7A8222EF9E8BB711ull },
+		  { 0x3030280DC665B755ull, 0x881FF21F1A211557ull,
+		    0x0E7BFF3ACDBD84F2ull, 0xD24A183E19EA8E1Aull } },
+		{ { 0x5842FEC2FD2BC078ull, 0xC4A0760529F3EF5Aull,
+		    0xEE6298B7DAD880AEull, 0x963BC9FEF7B637F3ull },
+		  { 0x7DDB231F5AFB8657ull, 0xC5EC0428F443A3C2ull,
+		    0x80A3E5092980A4F1ull, 0x7ED3383FCD1E7622ull } },
+		{ { 0xFA281F3FA8A4D326ull, 0xD1AE0C830C4719F5ull,
+		    0x8B8BCD87E4A8D86Cull, 0xE9A4D09A8DC935ECull },
+		  { 0xE6A8C7887D9DDAB1ull, 0x618EFF0672AAC13Full,
+		    0x5EDD81C41E336F77ull, 0x89B4E59EC839F9C0ull } },
+		{ { 0x6871E76EAFB608ADull, 0x74805654D88FD93Aull,
+		    0xE631ADDCB7C8BC49ull, 0x89FE6DAD861DA844ull },
+		  { 0x601406E7864D4DADull, 0xAEA9D513E0F0A87Bull,
+		    0x87B57DFFB725DF39ull, 0x2898278231F4E8FCull } },
+		{ { 0xE4F5F21825B6E7FAull, 0x3C72E26A6E9500FCull,
+		    0x5ECDAB57B08BDB17ull, 0xEB150E2E8D4E7C3Eull },
+		  { 0xF7135CA79C00DD1Full, 0xD2013CD9C6155901ull,
+		    0xF2006D1494C959D6ull, 0xEF367C87DE05B875ull } },
+		{ { 0x0718981B19AE4A29ull, 0xDF2FDA6EA2232A0Bull,
+		    0x510D7AC4E1166984ull, 0xC348047F3BD79759ull },
+		  { 0x34959AC4CEB09235ull, 0x8422E99F0549AEBFull,
+		    0x13DA8DD20E0DAE9Aull, 0x584781F2056A1C56ull } },
+	},
+	{
+		{ { 0x6CF20FFB313728BEull, 0x96439591A3C6B94Aull,
+		    0x2736FF8344315FC5ull, 0xA6D39677A7849276ull },
+		  { 0xF2BAB833C357F5F4ull, 0x824A920C2284059Bull,
+		    0x66B8BABD2D27ECDFull, 0x674F84749B0B8816ull } },
+		{ { 0x1583948C5974BB08ull, 0x75F3B0CAAEEADD25ull,
+		    0x4A661CAA2D2A1086ull, 0x3F06DCD2CE62E80Dull },
+		  { 0x89655DA995083C99ull, 0x831606905E88F53Eull,
+		    0x985807BE931D9B2Eull, 0x08BC2550CE1922DBull } },
+		{ { 0xC054B569CF15D864ull, 0x2406FDC6A1CC8D3Cull,
+		    0xAFC8ECE7BE26CF35ull, 0x07EF66D7C5DEDB0Dull },
+		  { 0x54625427740907FEull, 0x9F470E3B1CCE4A8Bull,
+		    0x06D40C5221FD505Eull, 0x2DB3325DB89DE6A5ull } },
+		{ { 0x1C101B8FD5C7C27Cull, 0xEB3228B94BDC794Cull,
+		    0xE0C05B31527E97B7ull, 0xEC61FF29918A1D05ull },
+		  { 0xADF01167D9DDFE51ull, 0xFE3C46C47690233Dull,
+		    0xD0960F82C7759298ull, 0x02FA1D3DC1B257A1ull } },
+		{ { 0xC695143C17C7C05Eull, 0xB283CB952CE5416Aull,
+		    0x14F3A72F75F28C0Bull, 0x82DF4E5FC06DC460ull },
+		  { 0xB9613D02D8FFF26Bull, 0xCF15D946842DB300ull,
+		    0x275216211217CBD1ull, 0xE4E188C98C96420Aull } },
+		{ { 0xC23E42E21D7DD05Cull, 0xC54F84D4C1B00E1Aull,
+		    0x69A3FB20E7D116D1ull, 0x5BB18BCDFF791761ull },
+		  { 0x56C549F2CB96A309ull, 0x95187587A4D2A416ull,
+		    0xF81B6DD5D7F58215ull, 0x42AD92172DEA4874ull } },
+		{ { 0x80AE1D41540368B0ull, 0x1324C22F8FEE949Dull,
+		    0x7D9E5B8D38E47A62ull, 0x261EFC9BC12B0C6Aull },
+		  { 0x13AD2559BDEB011Full, 0x7E340BE1E39B5D30ull,
+		    0xFDC8852CD64FFF79ull, 0x8A9D2ADBE386FCE9ull } },
+		{ { 0xC409332DE46E2050ull, 0xF5AC2A3900F5ABF0ull,
+		    0x4D6C6698316797E2ull, 0x9A79BFBFE71E347Full },
+		  { 0x7A3F4781926250D2ull, 0xCA94FACCB6DFDE31ull,
+		    0xB6F671F3B224EFA9ull, 0xE98B4DE6D316E200ull } },
+		{ { 0xF1033E9515EB8034ull, 0xF30B335F56E8CA4Aull,
+		    0x49AA7E59D9E7692Dull, 0x6D48DFD77A2C2791ull },
+		  { 0xE873087A5AB0CE30ull, 0x080210EA2A3E8961ull,
+		    0x3D5E79649E054763ull, 0x3CB47245165DD12Full } },
+		{ { 0x856EF847D4598089ull, 0x0E867737AA8D3616ull,
+		    0x552F2572BDF5A5BAull, 0x1F3FA7C10B9878CFull },
+		  { 0xED4B37C59825D989ull, 0x1DE1B2E886E5A500ull,
+		    0xC7CAE5B3F6CD1D1Eull, 0x7C27C1D9DB7B9E55ull } },
+		{ { 0xB5143DFC540535C8ull, 0x65F0A5630C8DB13Eull,
+		    0xA49123FB4FC54E6Full, 0x93A5C01E7BB98923ull },
+		  { 0xC49574083D59B844ull, 0x66A16204935BEDFFull,
+		    0xC16A84358E15A5C1ull, 0x2D440E904980C2F4ull } },
+		{ { 0x50AE677014BFC0D8ull, 0x71E2C88697A4800Eull,
+		    0xD2A4B4298373D400ull, 0xFB9198671B7EBB21ull },
+		  { 0x775250F36A805701ull, 0x07E90760D5C244B5ull,
+		    0x041E4E90FE1E9D28ull, 0x17FC6939A5FF362Bull } },
+		{ { 0xA261A5669E2047BAull, 0xE54704996BB0F652ull,
+		    0xB35DA0E017D67031ull, 0x3FB0B929161272BBull },
+		  { 0x57FECD4EDDB24158ull, 0x6C420AE7717009D3ull,
+		    0xCA72621C99666DC8ull, 0x9D467AE68217DF94ull } },
+		{ { 0xA9B77255B15D3AC8ull, 0x871E4ED9D99444EEull,
+		    0x5686DB122EC8AD7Full, 0xC8817E631BFDB29Cull },
+		  { 0xBF2C496232B9A312ull, 0xF5107BFE96DD8358ull,
+		    0xC293C342158697C4ull, 0xD157CC02D749CFD4ull } },
+		{ { 0x00BDBDBAE2DF71C1ull, 0x1C3186BEAFBB723Aull,
+		    0xD0763BA9DE33E438ull, 0xDAB09439E08E83D5ull },
+		  { 0xB873484124C3A1E3ull, 0x6E96330CA4B44E3Bull,
+		    0x385AE86F20D20B3Dull, 0x763CBC1E544E1CEFull } },
+	},
+	{
+		{ { 0x320F09C3839BB85Full, 0x0101FB06A050E62Cull,
+		    0x557582C99AD53458ull, 0x55D5398D1666432Bull },
+		  { 0xF7F631184FED936Full, 0xD90D6A7F1833D9E1ull,
+		    0x059C6A9E8EBAA72Aull, 0x576E229049FF8E2Dull } },
+		{ { 0xF642E95B4F491155ull, 0x28B1EB93FFF3C118ull,
+		    0xFD23639585D56F8Dull, 0x419A4F03AE7617CCull },
+		  { 0x4B91BA6AD489BBC7ull, 0xC7AB4A22074C6889ull,
+		    0x2E334B1484804545ull, 0x237C2D343A6E835Bull } },
+		{ { 0xC07E2B9212EA285Aull, 0x9F01C1E6F7B910D1ull,
+		    0x7858058DDDC0A7A3ull, 0x1BB46408814F888Bull },
+		  { 0xDC0C8A79907DC702ull, 0x1E52A34B992FA94Eull,
+		    0xA40FD9B892B4A4FCull, 0x8A3016BFAFAE1125ull } },
+		{ { 0xC0841BA9E49E8F34ull, 0xC3E61DAE0B35D0FCull,
+		    0x372304AD31ABF75Eull, 0xA2157EB3DADF2828ull },
+		  { 0x1A8E983289EEBEF3ull, 0x064BBBA35B187F4Eull,
+		    0x0FB42577CCFBE5A2ull, 0x0817697DA70DF31Dull } },
+		{ { 0x45012900D539785Aull, 0x8C88D076B8297F01ull,
+		    0xE0973E2678627A54ull, 0x04BC4E70E02FA14Eull },
+		  { 0x53990475CA62E3BBull, 0x877017727A3275C3ull,
+		    0xA5F5A1CF3F3DFB4Full, 0x5729F224B8CB4CC3ull } },
+		{ { 0x4E9C6714B80F772Aull, 0x4C3758A2B96EE4B2ull,
+		    0x7E54F059669A910Eull, 0xB76F40233E918CE5ull },
+		  { 0x2B481D7C72EEFF74ull, 0x56BA24196B16AE25ull,
+		    0x9618F274CEB09998ull, 0x05197211A7AED93Cull } },
+		{ { 0x112D4BB1E114CFB5ull, 0xD136189AA3D5A6A3ull,
+		    0x587739E1B7DF0876ull, 0xD3E492FDC1F88173ull },
+		  { 0xBCEB9AA5697F7045ull, 0x9C88F06E46754EEFull,
+		    0x1FEE2676BF15FEA3ull, 0x3604A70A73F8C48Bull } },
+		{ { 0xD4EB281C2D5C502Eull, 0x27FCE62D1DF14515ull,
+		    0xFB28652A88C376D2ull, 0xDC386DB7F409D9E0ull },
+		  { 0x23B47A257BFC1E4Full, 0x372C3DB3CC760B7Bull,
+		    0xE7E69C459D7AD72Bull, 0x526C6376CF20188Aull } },
+		{ { 0x1A2674BBAC55DDFFull, 0x1DAD1B3F64D4B787ull,
+		    0x8A4E52310FCDC179ull, 0xBEBFC25586284253ull },
+		  { 0x6D4DB0CA3EA2F303ull, 0x3CCA822D650BAA70ull,
+		    0x8A3A11C4B776576Cull, 0x850DE265C09604CEull } },
+		{ { 0xE49E72F50E08EF14ull, 0x81EC6EEDB69003FDull,
+		    0x0A8DA901C55D8F91ull, 0xEF938FBA5E02418Aull },
+		  { 0x84D5FFB0CAC193C7ull, 0x6F667F2A4FCD01B8ull,
+		    0x0DAB07948E47B80Eull, 0x824400400839F5DAull } },
+		{ { 0x91AF41E4C99EAD51ull, 0x5DA3543A21D9224Eull,
+		    0x2FB2931D16078471ull, 0x36E984DC73D20D60ull },
+		  { 0xC6FB9D426E0E5E3Eull, 0x3BABBEC1704280AFull,
+		    0x4BFBDFC9ACE32B20ull, 0x1437714721BF485Full } },
+		{ { 0x68119A550BDEB2CBull, 0x2C0CB5078F86A05Bull,
+		    0x4C9AF29039895A09ull, 0x2EE47B1E63B15D11ull },
+		  { 0x53ED9C7E453AD96Dull, 0x23B9D3B2811F1749ull,
+		    0x4EFD69719DD7C79Bull, 0x6ED220B6C3014A34ull } },
+		{ { 0x7A8B77BB23093DF0ull, 0x785E24816776464Dull,
+		    0xF315147954D793AFull, 0x91B6750043F604AEull },
+		  { 0x5CDE8C37D2CC9F14ull, 0x933685F8F9CAF67Full,
+		    0x477C7ADA96E21C5Dull, 0x07FEDB1E5824A00Dull } },
+		{ { 0x1688A672861140A8ull, 0x0A071EB5C5296EA6ull,
+		    0x8F231CA3C63AFEB7ull, 0x2530F0D5FD4F42A5ull },
+		  { 0x71EA3723A918D4BCull, 0x40CB6D19BEF1B4D5ull,
+		    0xBB07D89392CFF663ull, 0xADCBE6A85CB4C684ull } },
+		{ { 0xA2367B86FB7B8DC4ull, 0x5B3493028A9B3848ull,
+		    0x7C497E1A03602FACull, 0xC5D9C3C7A1C4883Eull },
+		  { 0xED64978D1B2DF0EAull, 0xD0D8F72FD1FD4936ull,
+		    0x5808C38605C50AF3ull, 0x3E59B9E25CFDB79Eull } },
+	},
+	{
+		{ { 0x6A703F10E895DF07ull, 0xFD75F3FA01876BD8ull,
+		    0xEB5B06E70CE08FFEull, 0x68F6B8542783DFEEull },
+		  { 0x90C76F8A78712655ull, 0xCF5293D2F310BF7Full,
+		    0xFBC8044DFDA45028ull, 0xCBE1FEBA92E40CE6ull } },
+		{ { 0x9D10531D80C15FC7ull, 0x666623F172E99258ull,
+		    0xF3CF09CD0E55E541ull, 0xE1B40C548C1C0D5Full },
+		  { 0x17CA84682A318024ull, 0x00924520DE9BB624ull,
+		    0xF47D811207F4708Full, 0x1EA8AAAC3F384FF9ull } },
+		{ { 0xE418FA233AA89692ull, 0x713B08D6F94C2308ull,
+		    0xE996E6412418A776ull, 0x3BDFCA7181668F4Dull },
+		  { 0x93DBDB431A510308ull, 0xC7DC0C6345E2EF13ull,
+		    0x49426151AEDA5333ull, 0x0A721F68565167B8ull } },
+		{ { 0xA25B597E831EBA7Eull, 0xF1E49C2570989E56ull,
+		    0x4201BBA7BC72A37Eull, 0x963E315DBA2A02DFull },
+		  { 0x3DFA4B328E7C79C0ull, 0x869D0AE5C0D5F13Cull,
+		    0xA2A3CB7C52167E11ull, 0x5C02BA13C84A3935ull } },
+		{ { 0x079B2342C37EA1D7ull, 0xB2393658F89AAE4Dull,
+		    0x35328552518D9E4Full, 0xACA8AC95B7521056ull },
+		  { 0xDDEFB1049BA973A2ull, 0xE1EDBFDC413935E9ull,
+		    0x94304C4B92872189ull, 0x7F12C567DD75CC20ull } },
+		{ { 0x02D58A93ED8D3763ull, 0x163C1B41B3D25D44ull,
+		    0x8C0821207C82521Eull, 0x79CC32165D5941A2ull },
+		  { 0x36AAB0F0BC5F6BFCull, 0xADABC17581D3626Bull,
+		    0x27CC1D59942FFC3Eull, 0x9CF893E8073053D0ull } },
+		{ { 0x5DB2781CD3245B7Full, 0xA37D669690597FBFull,
+		    0x206C21AF98D85311ull, 0xFA904704DB667C0Eull },
+		  { 0xEF833DF14DDF6BEFull, 0xCB9EECD2624F1D47ull,
+		    0x2D6FA3ED40F1C189ull, 0x1A1C8C3674A836A4ull } },
+		{ { 0x6C38BA21348560A9ull, 0xB3E960FD626F217Cull,
+		    0x7BE369478640DA20ull, 0x6FA2D99005994393ull },
+		  { 0xB9609377BAE52757ull, 0xFE39CDABC551C5EEull,
+		    0x3754A352A6985C3Aull, 0x9EBA0CC3915AC7E8ull } },
+		{ { 0xB61F78FD77F0953Aull, 0x18491483FF15439Aull,
+		    0xD672B8E1D2FA92A8ull, 0x1D431AAB91F57D8Cull },
+		  { 0x17C59D769D68F260ull, 0xF48E29A908707E7Cull,
+		    0xBC530C83CE15FAE0ull, 0x08D667C3BF19121Eull } },
+		{ { 0x590DA9836039279Aull, 0xE6E4C087B13DB4A8ull,
+		    0x8275247200D57597ull, 0xB7BDFAA7FC579C88ull },
+		  { 0xDBBD0AAB42152AE1ull, 0xA7E6E36988BAFC31ull,
+		    0x4BD23C461E4585F6ull, 0x1D2FA9F7C76FD5D1ull } },
+		{ { 0x5A31171365227C70ull, 0xF32BEAB333A3EA70ull,
+		    0xDDA4B35B2E31C60Full, 0x6DEEEA0D5A3E1137ull },
+		  { 0xAD6DA3810369B9B7ull, 0x287AEC1E569083DBull,
+		    0x0014CBAFEF6ACC84ull, 0xCBB93F0FC7443E40ull } },
+		{ { 0x69B6093AE31413A4ull, 0x07E015CE6891E8CDull,
+		    0x8BD75F71B68BA4B7ull, 0x9504E87A52E6A510ull },
+		  { 0x5A297AF9DF51C38Aull, 0x261F8470D70DD9C3ull,
+		    0x66BC455D63C7F186ull, 0xB6071D8FE3047CBFull } },
+		{ { 0xFB5FD5E88421B54Dull, 0x579B2B83A5564A4Full,
+		    0xD4AC9D2BB1FA9DCAull, 0x28135C10635578D8ull },
+		  { 0xADCCF09B8EE5D868ull, 0xEF0494CC91E310D8ull,
+		    0x06FA9D74107F8C15ull, 0x9ED84ABE3851BE15ull } },
+		{ { 0x5F4B8C276064184Eull, 0x73A39F9F9B819758ull,
+		    0x4A29A5793EC07948ull, 0xCB7B973AA8BF19F0ull },
+		  { 0xA21A6AA9735BF117ull, 0x1599EC23C2586640ull,
+		    0xD5FA500FDA87860Aull, 0x349AEF9136DD9245ull } },
+		{ { 0x917E5591E8E4AC10ull, 0x7996A812ACE24A9Aull,
+		    0xD6C3CC5A09FFB568ull, 0x339A057620B1077Bull },
+		  { 0xF76DA8644D1312A0ull, 0x5039E788F41CC66Eull,
+		    0x43854DF78ACF553Eull, 0xCA985FBEDD6A947Full } },
+	},
+	{
+		{ { 0x606304B1A44E8DE3ull, 0x5C08966A2ECC1E07ull,
+		    0x3A5A7DCF08BD1791ull, 0xF50B99B7468810B7ull },
+		  { 0x4A3F3BA6DB7F3588ull, 0xE975F18D21721E85ull,
+		    0x8789973A2DEDCEBBull, 0xE2B5061E55F18F0Cull } },
+		{ { 0xA9103A2D60DC749Cull, 0xD83321FBA27AD800ull,
+		    0xB09C743020A46E97ull, 0x2A148954227198C9ull },
+		  { 0xF2E1F28FF0FA3CF2ull, 0xBEF92DCDC39B6F01ull,
+		    0xEA3C2440A37608C4ull, 0xAA215A188974E422ull } },
+		{ { 0xDDDC6B6B82ACCF8Bull, 0x81D2999182816FA7ull,
+		    0x645F30E251394304ull, 0x598D7F61A5505770ull },
+		  { 0x1B84673C0F6CB808ull, 0xD2289A8F353540B9ull,
+		    0x546C5162B273EBCAull, 0x9F3121F74F8F2609ull } },
+		{ { 0x1E0CC372DD962ABCull, 0x1EBB7D208E87BDCCull,
+		    0xCC7A3EC58A642C87ull, 0x0A5A4878F4CC4453ull },
+		  { 0xE85DAABC9E2CC3FAull, 0x5832A64C8E50A9FAull,
+		    0x4D72B14DF2903017ull, 0xF7148B2288B0DC57ull } },
+		{ { 0x9FB39A5464AA7B3Eull, 0x13C4EF1B056C9CEAull,
+		    0x64FD2091541C5810ull, 0x715A2012F49F4C4Dull },
+		  { 0xD9A33944BC7D081Dull, 0x421BC588A88B47D0ull,
+		    0x1F79288F8A913B62ull, 0x5922B3B1AA606C0Aull } },
+		{ { 0x85C3FA7018AE2298ull, 0xCB07ADEF81B3E0D6ull,
+		    0xAA74356789578652ull, 0xF8093CA11AC87D03ull },
+		  { 0x06C36192D35C93B0ull, 0xE4509A0F6DB6006Full,
+		    0xB16129EC307E9CF3ull, 0x32074F216EF49C10ull } },
+		{ { 0xD1BDB697620DB220ull, 0xC71CCB101687ACE4ull,
+		    0xC409CE897FB87876ull, 0x49EC8C5E6AA9B125ull },
+		  { 0x99B8ACA0677338C2ull, 0x842C3073E53B9CCEull,
+		    0x3DA9CC34865F5429ull, 0x99A97D4FE5EA629Bull } },
+		{ { 0x93925B40128AA5CDull, 0xCECEAF38ED9768E7ull,
+		    0x20FEB9FBDD6C93FCull, 0xF5E3EFCB5A92F1B3ull },
+		  { 0xAB2799C7CEAA0FB4ull, 0x84E0A6F4B110CEC9ull,
+		    0x4E51E2DFEB07BD2Bull, 0x76CFA2899BF3DE05ull } },
+		{ { 0x51EBCA315E771268ull, 0x2F4F14A7D90A6568ull,
+		    0x3E6F190E05E07B7Aull, 0x1F8FB70D4850B448ull },
+		  { 0x1AFD3010C909C8DDull, 0x4E1D3C311C92B3ABull,
+		    0x12C2ED74726192A1ull, 0xF53E7ADB461BA2BFull } },
+		{ { 0xA2C15B625A3BA4EEull, 0x800F385ADE168FF2ull,
+		    0xB1C320078C03D084ull, 0xDF8B2BE9C62045ACull },
+		  { 0x40EAD285431A9955ull, 0xD0A8A06C08D307E7ull,
+		    0xD1955020049F17EBull, 0xD8835D9003CFD523ull } },
+		{ { 0x55EC0F2B28D9819Eull, 0xD606792F742DAB1Aull,
+		    0xDD5D142BA678732Cull, 0xB8D5C71A6497F61Full },
+		  { 0xDC78BE8EA9138AC4ull, 0xE2F49F1361D45C3Cull,
+		    0x3B6EE4359B63DC79ull, 0x1CD14EF132137F82ull } },
+		{ { 0x1AE9A5558C3B3D61ull, 0x53B60AA6BD66C3E9ull,
+		    0x6595FFC144469D82ull, 0x30128814F6AC0487ull },
+		  { 0x772B5E6C8F2DBB38ull, 0xAC30F673875ADC53ull,
+		    0x12C4C890B81F7E14ull, 0x5D57C66104D3C4ECull } },
+		{ { 0x6A93DBE660BCA3F3ull, 0xECB3435145600490ull,
+		    0xDD63EB61C880D8C4ull, 0x2265B5AC65BAAE3Dull },
+		  { 0x25829C6C517409FFull, 0x3C80A612D2393D5Aull,
+		    0x61A313A3B1096498ull, 0x97A198BF5CACFE0Full } },
+		{ { 0xE79C12B6916E8A30ull, 0xFC7AF0C38C1CB896ull,
+		    0x24AF7E03F4371BA5ull, 0x64D0C4F5A46437FAull },
+		  { 0xD81D912650BFEB69ull, 0x7CFCF2050F1FDCE5ull,
+		    0x6D03198DE496A8C5ull, 0x86654D5973B6ABE3ull } },
+		{ { 0x372D23FF45BAC36Eull, 0x599899459975DCD0ull,
+		    0x21FD8A9F5FC9ABCBull, 0xAF381CD103584925ull },
+		  { 0xFF3D887AB1B119A9ull, 0x589B82F1EF4D4A90ull,
+		    0xC9457F22951A2648ull, 0x681A087FB7DF0FBDull } },
+	},
+};
@@ -56,19 +56,25 @@ typedef struct {
 #define CURVE_P_32 {	0xFFFFFFFFFFFFFFFFull, 0x00000000FFFFFFFFull, \
 			0x0000000000000000ull, 0xFFFFFFFF00000001ull }
 
-#define CURVE_G_32 { \
-		{	0xF4A13945D898C296ull, 0x77037D812DEB33A0ull,	\
-			0xF8BCE6E563A440F2ull, 0x6B17D1F2E12C4247ull }, \
-		{	0xCBB6406837BF51F5ull, 0x2BCE33576B315ECEull,	\
-			0x8EE7EB4A7C0F9E16ull, 0x4FE342E2FE1A7F9Bull }	\
-}
-
 #define CURVE_N_32 {	0xF3B9CAC2FC632551ull, 0xBCE6FAADA7179E84ull,	\
 			0xFFFFFFFFFFFFFFFFull, 0xFFFFFFFF00000000ull }
 
-static uint64_t curve_p[NUM_ECC_DIGITS] = CURVE_P_32;
-static struct ecc_point curve_g = CURVE_G_32;
-static uint64_t curve_n[NUM_ECC_DIGITS] = CURVE_N_32;
+#define CURVE_B_32 {	0x3BCE3C3E27D2604Bull, 0x651D06B0CC53B0F6ull,	\
+			0xB3EBBD55769886BCull, 0x5AC635D8AA3A93E7ull }
+
+/* 2^256 - p */
+#define CURVE_2_256_P_32 {	0x0000000000000001ull, 0xFFFFFFFF00000000ull, \
+				0xFFFFFFFFFFFFFFFFull, 0x00000000FFFFFFFEull }
+
+/* 5p - 4 * 2^256 */
+#define CURVE_5P_32 {	0xFFFFFFFFFFFFFFFBull, 0x00000004FFFFFFFFull, \
+			0x0000000000000000ull, 0xFFFFFFFB00000005ull }
+
+static const uint64_t curve_p[NUM_ECC_DIGITS] = CURVE_P_32;
+static const uint64_t curve_b[NUM_ECC_DIGITS] = CURVE_B_32;
+static const uint64_t curve_n[NUM_ECC_DIGITS] = CURVE_N_32;
+static const uint64_t curve_2_256_p[NUM_ECC_DIGITS] = CURVE_2_256_P_32;
+static const uint64_t curve_5p[NUM_ECC_DIGITS] = CURVE_5P_32;
 
 static bool get_random_number(uint64_t *vli)
 {
@@ -128,37 +134,6 @@ static uint64_t vli_test_bit(const uint64_t *vli, unsigned int bit)
 	return (vli[bit / 64] & ((uint64_t) 1 << (bit % 64)));
 }
 
-/* Counts the number of 64-bit "digits" in vli. */
-static unsigned int vli_num_digits(const uint64_t *vli)
-{
-	int i;
-
-	/* Search from the end until we find a non-zero digit.
-	 * We do it in reverse because we expect that most digits will
-	 * be nonzero.
-	 */
-	for (i = NUM_ECC_DIGITS - 1; i >= 0 && vli[i] == 0; i--);
-
-	return (i + 1);
-}
-
-/* Counts the number of bits required for vli. */
-static unsigned int vli_num_bits(const uint64_t *vli)
-{
-	unsigned int i, num_digits;
-	uint64_t digit;
-
-	num_digits = vli_num_digits(vli);
-	if (num_digits == 0)
-		return 0;
-
-	digit = vli[num_digits - 1];
-	for (i = 0; digit; i++)
-		digit >>= 1;
-
-	return ((num_digits - 1) * 64 + i);
-}
-
 /* Sets dest = src. */
 static void vli_set(uint64_t *dest, const uint64_t *src)
 {
@@ -183,6 +158,41 @@ static int vli_cmp(const uint64_t *left, const uint64_t *right)
     return 0;
 }
 
+/* The helpers below take masks that are either all zeros or all ones so
+ * that secret dependent choices don't turn into branches.
+ */
+
+/* Sets dest = src if mask is set. */
+static void vli_select(uint64_t *dest, const uint64_t *src, uint64_t mask)
+{
+	int i;
+
+	for (i = 0; i < NUM_ECC_DIGITS; i++)
+		dest[i] ^= mask & (dest[i] ^ src[i]);
+}
+
+/* Swaps left and right if mask is set. */
+static void vli_cswap(uint64_t *left, uint64_t *right, uint64_t mask)
+{
+	int i;
+
+	for (i = 0; i < NUM_ECC_DIGITS; i++) {
+		uint64_t diff = mask & (left[i] ^ right[i]);
+
+		left[i] ^= diff;
+		right[i] ^= diff;
+	}
+}
+
+/* Sets result = in & mask. */
+static void vli_and(uint64_t *result, const uint64_t *in, uint64_t mask)
+{
+	int i;
+
+	for (i = 0; i < NUM_ECC_DIGITS; i++)
+		result[i] = in[i] & mask;
+}
+
 /* Computes result = in << c, returning carry. Can modify in place
  * (if result == in). 0 < shift < 64.
  */
@@ -225,11 +235,11 @@ static uint64_t vli_add(uint64_t *result, const uint64_t *left,
 	int i;
 
 	for (i = 0; i < NUM_ECC_DIGITS; i++) {
-		uint64_t sum;
+		uint64_t sum = left[i] + right[i];
+		uint64_t c = (sum < left[i]);
 
-		sum = left[i] + right[i] + carry;
-		if (sum != left[i])
-			carry = (sum < left[i]);
+		sum += carry;
+		carry = c | (sum < carry);
 
 		result[i] = sum;
 	}
@@ -245,11 +255,12 @@ static uint64_t vli_sub(uint64_t *result, const uint64_t *left,
 	int i;
 
 	for (i = 0; i < NUM_ECC_DIGITS; i++) {
-		uint64_t diff;
+		uint64_t diff = left[i] - right[i];
+		uint64_t b = (diff > left[i]);
 
-		diff = left[i] - right[i] - borrow;
-		if (diff != left[i])
-			borrow = (diff > left[i]);
+		b |= (diff < borrow);
+		diff -= borrow;
+		borrow = b;
 
 		result[i] = diff;
 	}
@@ -257,6 +268,82 @@ static uint64_t vli_sub(uint64_t *result, const uint64_t *left,
 	return borrow;
 }
 
+#ifdef __SIZEOF_INT128__
+typedef unsigned __int128 u128;
+
+static uint128_t mul_64_64(uint64_t left, uint64_t right)
+{
+	u128 m = (u128) left * right;
+	uint128_t result;
+
+	result.m_low = m;
+	result.m_high = m >> 64;
+
+	return result;
+}
+
+static void vli_mult(uint64_t *result, const uint64_t *left,
+							const uint64_t *right)
+{
+	int i, j;
+
+	for (i = 0; i < NUM_ECC_DIGITS * 2; i++)
+		result[i] = 0;
+
+	for (i = 0; i < NUM_ECC_DIGITS; i++) {
+		uint64_t carry = 0;
+
+		for (j = 0; j < NUM_ECC_DIGITS; j++) {
+			u128 t = (u128) left[i] * right[j] + result[i + j] +
+									carry;
+
+			result[i + j] = t;
+			carry = t >> 64;
+		}
+
+		result[i + NUM_ECC_DIGITS] = carry;
+	}
+}
+
+static void vli_square(uint64_t *result, const uint64_t *left)
+{
+	uint64_t carry;
+	int i, j;
+
+	for (i = 0; i < NUM_ECC_DIGITS * 2; i++)
+		result[i] = 0;
+
+	/* Cross products, each of which appears twice */
+	for (i = 0; i < NUM_ECC_DIGITS - 1; i++) {
+		carry = 0;
+
+		for (j = i + 1; j < NUM_ECC_DIGITS; j++) {
+			u128 t = (u128) left[i] * left[j] + result[i + j] +
+									carry;
+
+			result[i + j] = t;
+			carry = t >> 64;
+		}
+
+		result[i + NUM_ECC_DIGITS] = carry;
+	}
+
+	for (i = NUM_ECC_DIGITS * 2 - 1; i > 0; i--)
+		result[i] = (result[i] << 1) | (result[i - 1] >> 63);
+
+	/* Squares on the diagonal */
+	carry = 0;
+
+	for (i = 0; i < NUM_ECC_DIGITS; i++) {
+		u128 t = (u128) left[i] * left[i] + result[2 * i] + carry;
+
+		result[2 * i] = t;
+		t = (t >> 64) + result[2 * i + 1];
+		result[2 * i + 1] = t;
+		carry = t >> 64;
+	}
+}
+#else
 static uint128_t mul_64_64(uint64_t left, uint64_t right)
 {
 	uint64_t a0 = left & 0xffffffffull;
@@ -366,6 +453,27 @@ static void vli_square(uint64_t *result, const uint64_t *left)
 
 	result[NUM_ECC_DIGITS * 2 - 1] = r01.m_low;
 }
+#endif
+
+/* Computes result = left * right for a small right, returning carry. */
+static uint64_t vli_mult_small(uint64_t *result, const uint64_t *left,
+							uint64_t right)
+{
+	uint64_t carry = 0;
+	int i;
+
+	for (i = 0; i < NUM_ECC_DIGITS; i++) {
+		uint128_t product = mul_64_64(left[i], right);
+
+		product.m_low += carry;
+		product.m_high += (product.m_low < carry);
+
+		result[i] = product.m_low;
+		carry = product.m_high;
+	}
+
+	return carry;
+}
 
 /* Computes result = (left + right) % mod.
  * Assumes that left < mod and right < mod, result != mod.
@@ -373,15 +481,16 @@ static void vli_square(uint64_t *result, const uint64_t *left)
 static void vli_mod_add(uint64_t *result, const uint64_t *left,
 				const uint64_t *right, const uint64_t *mod)
 {
-	uint64_t carry;
+	uint64_t tmp[NUM_ECC_DIGITS];
+	uint64_t carry, borrow;
 
 	carry = vli_add(result, left, right);
+	borrow = vli_sub(tmp, result, mod);
 
 	/* result > mod (result = mod + remainder), so subtract mod to
 	 * get remainder.
 	 */
-	if (carry || vli_cmp(result, mod) >= 0)
-		vli_sub(result, result, mod);
+	vli_select(result, tmp, -(carry | (borrow ^ 1)));
 }
 
 /* Computes result = (left - right) % mod.
@@ -390,14 +499,15 @@ static void vli_mod_add(uint64_t *result, const uint64_t *left,
 static void vli_mod_sub(uint64_t *result, const uint64_t *left,
 				const uint64_t *right, const uint64_t *mod)
 {
+	uint64_t tmp[NUM_ECC_DIGITS];
 	uint64_t borrow = vli_sub(result, left, right);
 
 	/* In this case, p_result == -diff == (max int) - diff.
 	 * Since -x % d == d - x, we can get the correct result from
 	 * result + mod (with overflow).
 	 */
-	if (borrow)
-		vli_add(result, result, mod);
+	vli_and(tmp, mod, -borrow);
+	vli_add(result, result, tmp);
 }
 
 /* Computes result = product % curve_p
@@ -405,6 +515,7 @@ static void vli_mod_sub(uint64_t *result, const uint64_t *left,
 static void vli_mmod_fast(uint64_t *result, const uint64_t *product)
 {
 	uint64_t tmp[NUM_ECC_DIGITS];
+	uint64_t borrow;
 	int carry;
 
 	/* t */
@@ -467,14 +578,22 @@ static void vli_mmod_fast(uint64_t *result, const uint64_t *product)
 	tmp[3] = product[6] & 0xffffffff00000000ull;
 	carry -= vli_sub(result, result, tmp);
 
-	if (carry < 0) {
-		do {
-			carry += vli_add(result, result, curve_p);
-		} while (carry < 0);
-	} else {
-		while (carry || vli_cmp(curve_p, result) != 1)
-			carry -= vli_sub(result, result, curve_p);
-	}
+	/* The value is now carry * 2^256 + result with carry in [-4, 6].
+	 * Adding 5p makes it positive and keeps it below 12 * 2^256, then
+	 * 2^256 = 2^256 - p (mod p) folds the carry back in without any
+	 * data dependent loops.
+	 */
+	carry += 4 + vli_add(result, result, curve_5p);
+
+	vli_mult_small(tmp, curve_2_256_p, carry);
+	borrow = vli_add(result, result, tmp);
+
+	vli_and(tmp, curve_2_256_p, -borrow);
+	vli_add(result, result, tmp);
+
+	/* result < 2^256 < 2p */
+	borrow = vli_sub(tmp, result, curve_p);
+	vli_select(result, tmp, borrow - 1);
 }
 
 /* Computes result = (left * right) % curve_p. */
@@ -496,83 +615,56 @@ static void vli_mod_square_fast(uint64_t *result, const uint64_t *left)
 	vli_mmod_fast(result, product);
 }
 
-#define EVEN(vli) (!(vli[0] & 1))
-/* Computes result = (1 / p_input) % mod. All VLIs are the same size.
- * See "From Euclid's GCD to Montgomery Multiplication to the Great Divide"
- * https://labs.oracle.com/techrep/2001/smli_tr-2001-95.pdf
- */
-static void vli_mod_inv(uint64_t *result, const uint64_t *input,
-							const uint64_t *mod)
+/* Computes result = left^(2^n) % curve_p. */
+static void vli_mod_square_n(uint64_t *result, const uint64_t *left,
+							unsigned int n)
 {
-	uint64_t a[NUM_ECC_DIGITS], b[NUM_ECC_DIGITS];
-	uint64_t u[NUM_ECC_DIGITS], v[NUM_ECC_DIGITS];
-	uint64_t carry;
-	int cmp_result;
-
-	if (vli_is_zero(input)) {
-		vli_clear(result);
-		return;
-	}
-
-	vli_set(a, input);
-	vli_set(b, mod);
-	vli_clear(u);
-	u[0] = 1;
-	vli_clear(v);
-
-	while ((cmp_result = vli_cmp(a, b)) != 0) {
-		carry = 0;
+	vli_set(result, left);
 
-		if (EVEN(a)) {
-			vli_rshift1(a);
-
-			if (!EVEN(u))
-				carry = vli_add(u, u, mod);
-
-			vli_rshift1(u);
-			if (carry)
-				u[NUM_ECC_DIGITS - 1] |= 0x8000000000000000ull;
-		} else if (EVEN(b)) {
-			vli_rshift1(b);
-
-			if (!EVEN(v))
-				carry = vli_add(v, v, mod);
-
-			vli_rshift1(v);
-			if (carry)
-				v[NUM_ECC_DIGITS - 1] |= 0x8000000000000000ull;
-		} else if (cmp_result > 0) {
-			vli_sub(a, a, b);
-			vli_rshift1(a);
-
-			if (vli_cmp(u, v) < 0)
-				vli_add(u, u, mod);
-
-			vli_sub(u, u, v);
-			if (!EVEN(u))
-				carry = vli_add(u, u, mod);
-
-			vli_rshift1(u);
-			if (carry)
-				u[NUM_ECC_DIGITS - 1] |= 0x8000000000000000ull;
-		} else {
-			vli_sub(b, b, a);
-			vli_rshift1(b);
-
-			if (vli_cmp(v, u) < 0)
-				vli_add(v, v, mod);
-
-			vli_sub(v, v, u);
-			if (!EVEN(v))
-				carry = vli_add(v, v, mod);
-
-			vli_rshift1(v);
-			if (carry)
-				v[NUM_ECC_DIGITS - 1] |= 0x8000000000000000ull;
-		}
-	}
+	while (n--)
+		vli_mod_square_fast(result, result);
+}
 
-	vli_set(result, u);
+/* Computes result = (1 / input) % curve_p as input^(p - 2), which takes
+ * the same time for any input. Returns 0 for input 0.
+ */
+static void vli_mod_inv(uint64_t *result, const uint64_t *input)
+{
+	uint64_t e2[NUM_ECC_DIGITS], e4[NUM_ECC_DIGITS];
+	uint64_t e8[NUM_ECC_DIGITS], e16[NUM_ECC_DIGITS];
+	uint64_t e32[NUM_ECC_DIGITS], t[NUM_ECC_DIGITS];
+
+	/* ek = input^(2^k - 1) */
+	vli_mod_square_fast(e2, input);
+	vli_mod_mult_fast(e2, e2, input);
+	vli_mod_square_n(e4, e2, 2);
+	vli_mod_mult_fast(e4, e4, e2);
+	vli_mod_square_n(e8, e4, 4);
+	vli_mod_mult_fast(e8, e8, e4);
+	vli_mod_square_n(e16, e8, 8);
+	vli_mod_mult_fast(e16, e16, e8);
+	vli_mod_square_n(e32, e16, 16);
+	vli_mod_mult_fast(e32, e32, e16);
+
+	/* p - 2 = ffffffff 00000001 00000000 00000000
+	 *         00000000 ffffffff ffffffff fffffffd
+	 */
+	vli_mod_square_n(t, e32, 32);
+	vli_mod_mult_fast(t, t, input);
+	vli_mod_square_n(t, t, 128);
+	vli_mod_mult_fast(t, t, e32);
+	vli_mod_square_n(t, t, 32);
+	vli_mod_mult_fast(t, t, e32);
+	vli_mod_square_n(t, t, 16);
+	vli_mod_mult_fast(t, t, e16);
+	vli_mod_square_n(t, t, 8);
+	vli_mod_mult_fast(t, t, e8);
+	vli_mod_square_n(t, t, 4);
+	vli_mod_mult_fast(t, t, e4);
+	vli_mod_square_n(t, t, 2);
+	vli_mod_mult_fast(t, t, e2);
+	vli_mod_square_n(t, t, 2);
+	vli_mod_mult_fast(result, t, input);
 }
 
 /* ------ Point operations ------ */
@@ -583,6 +675,28 @@ static bool ecc_point_is_zero(const struct ecc_point *point)
 	return (vli_is_zero(point->x) && vli_is_zero(point->y));
 }
 
+/* Returns true if the point is on the curve, y^2 = x^3 - 3x + b. */
+static bool ecc_point_is_valid(const struct ecc_point *point)
+{
+	uint64_t lhs[NUM_ECC_DIGITS], rhs[NUM_ECC_DIGITS];
+	uint64_t tmp[NUM_ECC_DIGITS];
+
+	if (vli_cmp(curve_p, point->x) != 1 ||
+					vli_cmp(curve_p, point->y) != 1)
+		return false;
+
+	vli_mod_square_fast(lhs, point->y);
+
+	vli_mod_square_fast(rhs, point->x);
+	vli_mod_mult_fast(rhs, rhs, point->x);
+	vli_mod_add(tmp, point->x, point->x, curve_p);
+	vli_mod_add(tmp, tmp, point->x, curve_p);
+	vli_mod_sub(rhs, rhs, tmp, curve_p);
+	vli_mod_add(rhs, rhs, curve_b, curve_p);
+
+	return vli_cmp(lhs, rhs) == 0;
+}
+
 /* Point multiplication algorithm using Montgomery's ladder with co-Z
  * coordinates. From http://eprint.iacr.org/2011/338.pdf
  */
@@ -593,6 +707,7 @@ static void ecc_point_double_jacobian(uint64_t *x1, uint64_t *y1, uint64_t *z1)
 	/* t1 = x, t2 = y, t3 = z */
 	uint64_t t4[NUM_ECC_DIGITS];
 	uint64_t t5[NUM_ECC_DIGITS];
+	uint64_t carry;
 
 	if (vli_is_zero(z1))
 		return;
@@ -610,13 +725,12 @@ static void ecc_point_double_jacobian(uint64_t *x1, uint64_t *y1, uint64_t *z1)
 
 	vli_mod_add(z1, x1, x1, curve_p); /* t3 = 2*(x1^2 - z1^4) */
 	vli_mod_add(x1, x1, z1, curve_p); /* t1 = 3*(x1^2 - z1^4) */
-	if (vli_test_bit(x1, 0)) {
-		uint64_t carry = vli_add(x1, x1, curve_p);
-		vli_rshift1(x1);
-		x1[NUM_ECC_DIGITS - 1] |= carry << 63;
-	} else {
-		vli_rshift1(x1);
-	}
+
+	/* Halve, adding p first if odd */
+	vli_and(z1, curve_p, -(x1[0] & 1));
+	carry = vli_add(x1, x1, z1);
+	vli_rshift1(x1);
+	x1[NUM_ECC_DIGITS - 1] |= carry << 63;
 	/* t1 = 3/2*(x1^2 - z1^4) = B */
 
 	vli_mod_square_fast(z1, x1);      /* t3 = B^2 */
@@ -728,41 +842,68 @@ static void xycz_add_c(uint64_t *x1, uint64_t *y1, uint64_t *x2, uint64_t *y2)
 	vli_set(x1, t7);
 }
 
+/* Computes result = scalar * point. The scalar is first padded with a
+ * multiple of the group order to a fixed 257 bits so that the ladder
+ * always runs the same number of steps, and both ladder registers are
+ * only ever touched through conditional swaps. Scalars 1, n - 2 and n - 1
+ * run into the exceptional cases of the co-Z formulas and give the point
+ * at infinity, which callers already treat as failure.
+ */
 static void ecc_point_mult(struct ecc_point *result,
 				const struct ecc_point *point,
-				uint64_t *scalar, uint64_t *initial_z,
-				int num_bits)
+				const uint64_t *scalar, uint64_t *initial_z)
 {
 	/* R0 and R1 */
 	uint64_t rx[2][NUM_ECC_DIGITS];
 	uint64_t ry[2][NUM_ECC_DIGITS];
-	uint64_t z[NUM_ECC_DIGITS];
-	int i, nb;
+	uint64_t k[NUM_ECC_DIGITS], k2[NUM_ECC_DIGITS];
+	uint64_t z[NUM_ECC_DIGITS], tmp[NUM_ECC_DIGITS];
+	uint64_t carry, swap, prev = 0;
+	int i;
+
+	/* k = scalar + n if that carries into bit 256, else scalar + 2n */
+	carry = vli_add(k, scalar, curve_n);
+	vli_add(k2, k, curve_n);
+	vli_select(k, k2, carry - 1);
 
 	vli_set(rx[1], point->x);
 	vli_set(ry[1], point->y);
 
 	xycz_initial_double(rx[1], ry[1], rx[0], ry[0], initial_z);
 
-	for (i = num_bits - 2; i > 0; i--) {
-		nb = !vli_test_bit(scalar, i);
-		xycz_add_c(rx[1 - nb], ry[1 - nb], rx[nb], ry[nb]);
-		xycz_add(rx[nb], ry[nb], rx[1 - nb], ry[1 - nb]);
+	/* Slot 1 holds R1 while the current bit is set and R0 otherwise */
+	for (i = NUM_ECC_DIGITS * 64 - 1; i > 0; i--) {
+		swap = !vli_test_bit(k, i);
+		vli_cswap(rx[0], rx[1], -(swap ^ prev));
+		vli_cswap(ry[0], ry[1], -(swap ^ prev));
+		prev = swap;
+
+		xycz_add_c(rx[1], ry[1], rx[0], ry[0]);
+		xycz_add(rx[0], ry[0], rx[1], ry[1]);
 	}
 
-	nb = !vli_test_bit(scalar, 0);
-	xycz_add_c(rx[1 - nb], ry[1 - nb], rx[nb], ry[nb]);
+	swap = !vli_test_bit(k, 0);
+	vli_cswap(rx[0], rx[1], -(swap ^ prev));
+	vli_cswap(ry[0], ry[1], -(swap ^ prev));
+
+	xycz_add_c(rx[1], ry[1], rx[0], ry[0]);
 
 	/* Find final 1/Z value. */
 	vli_mod_sub(z, rx[1], rx[0], curve_p); /* X1 - X0 */
-	vli_mod_mult_fast(z, z, ry[1 - nb]); /* Yb * (X1 - X0) */
+	vli_clear(tmp);
+	vli_mod_sub(tmp, tmp, z, curve_p);
+	vli_select(z, tmp, -swap);
+	vli_mod_mult_fast(z, z, ry[1]);      /* Yb * (X1 - X0) */
 	vli_mod_mult_fast(z, z, point->x);   /* xP * Yb * (X1 - X0) */
-	vli_mod_inv(z, z, curve_p);          /* 1 / (xP * Yb * (X1 - X0)) */
+	vli_mod_inv(z, z);                   /* 1 / (xP * Yb * (X1 - X0)) */
 	vli_mod_mult_fast(z, z, point->y);   /* yP / (xP * Yb * (X1 - X0)) */
-	vli_mod_mult_fast(z, z, rx[1 - nb]); /* Xb * yP / (xP * Yb * (X1 - X0)) */
+	vli_mod_mult_fast(z, z, rx[1]);      /* Xb * yP / (xP * Yb * (X1 - X0)) */
 	/* End 1/Z calculation */
 
-	xycz_add(rx[nb], ry[nb], rx[1 - nb], ry[1 - nb]);
+	xycz_add(rx[0], ry[0], rx[1], ry[1]);
+
+	vli_cswap(rx[0], rx[1], -swap);
+	vli_cswap(ry[0], ry[1], -swap);
 
 	apply_z(rx[0], ry[0], z);
 
@@ -770,6 +911,173 @@ static void ecc_point_mult(struct ecc_point *result,
 	vli_set(result->y, ry[0]);
 }
 
+/* Fixed-base multiplication of the generator for key generation. The
+ * formulas below are the complete projective ones for a = -3 from
+ * https://eprint.iacr.org/2015/1060.pdf (algorithms 5 and 6), which
+ * have no special cases for doubling or the point at infinity (0 : 1 : 0).
+ */
+struct ecc_point_proj {
+	uint64_t x[NUM_ECC_DIGITS];
+	uint64_t y[NUM_ECC_DIGITS];
+	uint64_t z[NUM_ECC_DIGITS];
+};
+
+#include "ecc-table.h"
+
+static void ecc_point_double_proj(struct ecc_point_proj *p)
+{
+	uint64_t t0[NUM_ECC_DIGITS], t1[NUM_ECC_DIGITS];
+	uint64_t t2[NUM_ECC_DIGITS], t3[NUM_ECC_DIGITS];
+	uint64_t x3[NUM_ECC_DIGITS], y3[NUM_ECC_DIGITS];
+	uint64_t z3[NUM_ECC_DIGITS];
+
+	vli_mod_square_fast(t0, p->x);
+	vli_mod_square_fast(t1, p->y);
+	vli_mod_square_fast(t2, p->z);
+	vli_mod_mult_fast(t3, p->x, p->y);
+	vli_mod_add(t3, t3, t3, curve_p);
+	vli_mod_mult_fast(z3, p->x, p->z);
+	vli_mod_add(z3, z3, z3, curve_p);
+	vli_mod_mult_fast(y3, curve_b, t2);
+	vli_mod_sub(y3, y3, z3, curve_p);
+	vli_mod_add(x3, y3, y3, curve_p);
+	vli_mod_add(y3, x3, y3, curve_p);
+	vli_mod_sub(x3, t1, y3, curve_p);
+	vli_mod_add(y3, t1, y3, curve_p);
+	vli_mod_mult_fast(y3, x3, y3);
+	vli_mod_mult_fast(x3, x3, t3);
+	vli_mod_add(t3, t2, t2, curve_p);
+	vli_mod_add(t2, t2, t3, curve_p);
+	vli_mod_mult_fast(z3, curve_b, z3);
+	vli_mod_sub(z3, z3, t2, curve_p);
+	vli_mod_sub(z3, z3, t0, curve_p);
+	vli_mod_add(t3, z3, z3, curve_p);
+	vli_mod_add(z3, z3, t3, curve_p);
+	vli_mod_add(t3, t0, t0, curve_p);
+	vli_mod_add(t0, t3, t0, curve_p);
+	vli_mod_sub(t0, t0, t2, curve_p);
+	vli_mod_mult_fast(t0, t0, z3);
+	vli_mod_add(y3, y3, t0, curve_p);
+	vli_mod_mult_fast(t0, p->y, p->z);
+	vli_mod_add(t0, t0, t0, curve_p);
+	vli_mod_mult_fast(z3, t0, z3);
+	vli_mod_sub(x3, x3, z3, curve_p);
+	vli_mod_mult_fast(z3, t0, t1);
+	vli_mod_add(z3, z3, z3, curve_p);
+	vli_mod_add(z3, z3, z3, curve_p);
+
+	vli_set(p->x, x3);
+	vli_set(p->y, y3);
+	vli_set(p->z, z3);
+}
+
+/* P = P + Q for an affine Q other than the point at infinity */
+static void ecc_point_add_mixed(struct ecc_point_proj *p,
+						const struct ecc_point *q)
+{
+	uint64_t t0[NUM_ECC_DIGITS], t1[NUM_ECC_DIGITS];
+	uint64_t t2[NUM_ECC_DIGITS], t3[NUM_ECC_DIGITS];
+	uint64_t t4[NUM_ECC_DIGITS], x3[NUM_ECC_DIGITS];
+	uint64_t y3[NUM_ECC_DIGITS], z3[NUM_ECC_DIGITS];
+
+	vli_mod_mult_fast(t0, p->x, q->x);
+	vli_mod_mult_fast(t1, p->y, q->y);
+	vli_mod_add(t3, q->x, q->y, curve_p);
+	vli_mod_add(t4, p->x, p->y, curve_p);
+	vli_mod_mult_fast(t3, t3, t4);
+	vli_mod_add(t4, t0, t1, curve_p);
+	vli_mod_sub(t3, t3, t4, curve_p);
+	vli_mod_mult_fast(t4, q->y, p->z);
+	vli_mod_add(t4, t4, p->y, curve_p);
+	vli_mod_mult_fast(y3, q->x, p->z);
+	vli_mod_add(y3, y3, p->x, curve_p);
+	vli_mod_mult_fast(z3, curve_b, p->z);
+	vli_mod_sub(x3, y3, z3, curve_p);
+	vli_mod_add(z3, x3, x3, curve_p);
+	vli_mod_add(x3, x3, z3, curve_p);
+	vli_mod_sub(z3, t1, x3, curve_p);
+	vli_mod_add(x3, t1, x3, curve_p);
+	vli_mod_mult_fast(y3, curve_b, y3);
+	vli_mod_add(t1, p->z, p->z, curve_p);
+	vli_mod_add(t2, t1, p->z, curve_p);
+	vli_mod_sub(y3, y3, t2, curve_p);
+	vli_mod_sub(y3, y3, t0, curve_p);
+	vli_mod_add(t1, y3, y3, curve_p);
+	vli_mod_add(y3, t1, y3, curve_p);
+	vli_mod_add(t1, t0, t0, curve_p);
+	vli_mod_add(t0, t1, t0, curve_p);
+	vli_mod_sub(t0, t0, t2, curve_p);
+	vli_mod_mult_fast(t1, t4, y3);
+	vli_mod_mult_fast(t2, t0, y3);
+	vli_mod_mult_fast(y3, x3, z3);
+	vli_mod_add(y3, y3, t2, curve_p);
+	vli_mod_mult_fast(x3, t3, x3);
+	vli_mod_sub(x3, x3, t1, curve_p);
+	vli_mod_mult_fast(z3, t4, z3);
+	vli_mod_mult_fast(t1, t3, t0);
+	vli_mod_add(z3, z3, t1, curve_p);
+
+	vli_set(p->x, x3);
+	vli_set(p->y, y3);
+	vli_set(p->z, z3);
+}
+
+/* Computes result = scalar * G with the comb table. The scalar is split
+ * into 4-bit digits and digit 4 * i + s is looked up in row i, so each
+ * of the 4 passes adds one entry per row and only 12 doublings are
+ * needed in total. Every entry of a row is read to pick the one needed.
+ */
+static void ecc_point_mult_base(struct ecc_point *result,
+						const uint64_t *scalar)
+{
+	struct ecc_point_proj acc, sum;
+	struct ecc_point entry;
+	uint64_t z[NUM_ECC_DIGITS];
+	unsigned int i, j;
+	int s;
+
+	vli_clear(acc.x);
+	vli_clear(acc.y);
+	vli_clear(acc.z);
+	acc.y[0] = 1;
+
+	for (s = 3; s >= 0; s--) {
+		if (s != 3) {
+			for (j = 0; j < 4; j++)
+				ecc_point_double_proj(&acc);
+		}
+
+		for (i = 0; i < 16; i++) {
+			unsigned int bit = 16 * i + 4 * s;
+			uint64_t digit, mask;
+
+			digit = (scalar[bit / 64] >> (bit % 64)) & 0xf;
+
+			entry = curve_g_table[i][0];
+			for (j = 2; j <= 15; j++) {
+				mask = ((digit ^ j) - 1) >> 63;
+				vli_select(entry.x, curve_g_table[i][j - 1].x,
+									-mask);
+				vli_select(entry.y, curve_g_table[i][j - 1].y,
+									-mask);
+			}
+
+			/* A zero digit still does the work, then drops it */
+			sum = acc;
+			ecc_point_add_mixed(&sum, &entry);
+
+			mask = -(uint64_t) (digit != 0);
+			vli_select(acc.x, sum.x, mask);
+			vli_select(acc.y, sum.y, mask);
+			vli_select(acc.z, sum.z, mask);
+		}
+	}
+
+	vli_mod_inv(z, acc.z);
+	vli_mod_mult_fast(result->x, acc.x, z);
+	vli_mod_mult_fast(result->y, acc.y, z);
+}
+
 /* Little endian byte-array to native conversion */
 static void ecc_bytes2native(const uint8_t bytes[ECC_BYTES],
 						uint64_t native[NUM_ECC_DIGITS])
@@ -828,7 +1136,7 @@ bool ecc_make_key(uint8_t public_key[64], uint8_t private_key[32])
 		if (vli_cmp(curve_n, priv) != 1)
 			continue;
 
-		ecc_point_mult(&pk, &curve_g, priv, NULL, vli_num_bits(priv));
+		ecc_point_mult_base(&pk, priv);
 	} while (ecc_point_is_zero(&pk));
 
 	ecc_native2bytes(priv, private_key);
@@ -853,7 +1161,11 @@ bool ecdh_shared_secret(const uint8_t public_key[64],
 	ecc_bytes2native(&public_key[32], pk.y);
 	ecc_bytes2native(private_key, priv);
 
-	ecc_point_mult(&product, &pk, priv, rand, vli_num_bits(priv));
+	/* Invalid curve points would leak the private key */
+	if (!ecc_point_is_valid(&pk))
+		return false;
+
+	ecc_point_mult(&product, &pk, priv, rand);
 
 	ecc_native2bytes(product.x, secret);
 
@@ -87,7 +87,7 @@ struct bt_gatt_client {
 	struct queue *notify_list;
 	struct queue *notify_chrcs;
 	int next_reg_id;
-	unsigned int disc_id, notify_id, ind_id;
+	unsigned int disc_id, notify_id, ind_id, nfy_mult_id;
 
 	/*
 	 * Handles of the GATT Service and the Service Changed characteristic
@@ -109,6 +109,13 @@ struct bt_gatt_client {
 
 	struct bt_gatt_request *discovery_req;
 	unsigned int mtu_req_id;
+
+	/* Database Hash read while the cached database is validated */
+	unsigned int db_hash_id;
+	bool db_hash_checked;
+
+	/* Client Supported Features write done once ready */
+	unsigned int cli_feat_id;
 };
 
 struct request {
@@ -130,6 +137,13 @@ static struct request *request_ref(struct request *req)
 	return req;
 }
 
+static unsigned int request_key(const void *data)
+{
+	const struct request *req = data;
+
+	return req->id;
+}
+
 static struct request *request_create(struct bt_gatt_client *client)
 {
 	struct request *req;
@@ -141,9 +155,9 @@ static struct request *request_create(struct bt_gatt_client *client)
 	if (client->next_request_id < 1)
 		client->next_request_id = 1;
 
-	queue_push_tail(client->pending_requests, req);
 	req->client = client;
 	req->id = client->next_request_id++;
+	queue_push_tail(client->pending_requests, req);
 
 	return request_ref(req);
 }
@@ -282,12 +296,11 @@ static void notify_chrc_free(void *data)
 	free(chrc);
 }
 
-static bool match_notify_data_id(const void *a, const void *b)
+static unsigned int notify_data_key(const void *data)
 {
-	const struct notify_data *notify_data = a;
-	unsigned int id = PTR_TO_UINT(b);
+	const struct notify_data *notify_data = data;
 
-	return notify_data->id == id;
+	return notify_data->id;
 }
 
 struct handle_range {
@@ -1073,6 +1086,125 @@ static void notify_client_ready(struct bt_gatt_client *client, bool success,
 	bt_gatt_client_unref(client);
 }
 
+static void discover_all(struct discovery_op *op, uint8_t att_ecode)
+{
+	struct bt_gatt_client *client = op->client;
+
+	client->discovery_req = bt_gatt_discover_all_primary_services(
+							client->att, NULL,
+							discover_primary_cb,
+							discovery_op_ref(op),
+							discovery_op_unref);
+	if (client->discovery_req)
+		return;
+
+	util_debug(client->debug_callback, client->debug_data,
+			"Failed to initiate primary service discovery");
+
+	client->in_init = false;
+	notify_client_ready(client, false, att_ecode);
+
+	discovery_op_unref(op);
+}
+
+static void get_first_attribute(struct gatt_db_attribute *attrib,
+							void *user_data);
+
+static struct gatt_db_attribute *get_db_hash_attr(struct gatt_db *db)
+{
+	struct gatt_db_attribute *attr = NULL;
+	bt_uuid_t uuid;
+
+	bt_uuid16_create(&uuid, GATT_CHARAC_DB_HASH);
+
+	gatt_db_find_by_type(db, 0x0001, 0xffff, &uuid, get_first_attribute,
+									&attr);
+
+	return attr;
+}
+
+static void db_hash_value_cb(struct gatt_db_attribute *attrib, int err,
+					const uint8_t *value, size_t length,
+					void *user_data)
+{
+	uint8_t *hash = user_data;
+
+	if (!err && length == 16)
+		memcpy(hash, value, 16);
+}
+
+static void db_hash_write_cb(struct gatt_db_attribute *attrib, int err,
+								void *user_data)
+{
+}
+
+/* Returns the Database Hash value in a Read By Type response */
+static const uint8_t *db_hash_rsp(uint8_t opcode, const void *pdu,
+							uint16_t length)
+{
+	const uint8_t *rsp = pdu;
+
+	if (opcode != BT_ATT_OP_READ_BY_TYPE_RSP || length < 19 ||
+								rsp[0] != 18)
+		return NULL;
+
+	return rsp + 3;
+}
+
+static bool read_db_hash(struct discovery_op *op,
+					bt_att_response_func_t callback)
+{
+	struct bt_gatt_client *client = op->client;
+	uint8_t pdu[6];
+
+	put_le16(0x0001, pdu);
+	put_le16(0xffff, pdu + 2);
+	put_le16(GATT_CHARAC_DB_HASH, pdu + 4);
+
+	client->db_hash_id = bt_att_send(client->att,
+						BT_ATT_OP_READ_BY_TYPE_REQ,
+						pdu, sizeof(pdu), callback,
+						discovery_op_ref(op),
+						discovery_op_unref);
+	if (client->db_hash_id)
+		return true;
+
+	discovery_op_unref(op);
+
+	return false;
+}
+
+static void db_hash_check_cb(uint8_t opcode, const void *pdu,
+					uint16_t length, void *user_data)
+{
+	struct discovery_op *op = user_data;
+	struct bt_gatt_client *client = op->client;
+	uint8_t cached[16] = {};
+	const uint8_t *value;
+
+	client->db_hash_id = 0;
+
+	gatt_db_attribute_read(get_db_hash_attr(client->db), 0, 0, NULL,
+						db_hash_value_cb, cached);
+
+	value = db_hash_rsp(opcode, pdu, length);
+	if (value && !memcmp(value, cached, 16)) {
+		util_debug(client->debug_callback, client->debug_data,
+				"Database Hash matches, skipping discovery");
+		client->db_hash_checked = true;
+		op->success = true;
+		op->complete_func(op, true, 0);
+		return;
+	}
+
+	util_debug(client->debug_callback, client->debug_data,
+				"Database Hash changed, discovering services");
+
+	gatt_db_clear(client->db);
+
+	discover_all(op, 0);
+}
+
 static void exchange_mtu_cb(bool success, uint8_t att_ecode, void *user_data)
 {
 	struct discovery_op *op = user_data;
@@ -1107,21 +1239,12 @@ static void exchange_mtu_cb(bool success, uint8_t att_ecode, void *user_data)
 					bt_att_get_mtu(client->att));
 
 discover:
-	client->discovery_req = bt_gatt_discover_all_primary_services(
-							client->att, NULL,
-							discover_primary_cb,
-							discovery_op_ref(op),
-							discovery_op_unref);
-	if (client->discovery_req)
+	/* A cached database is only rediscovered if its hash went stale */
+	if (!gatt_db_isempty(client->db) && get_db_hash_attr(client->db) &&
+					read_db_hash(op, db_hash_check_cb))
 		return;
 
-	util_debug(client->debug_callback, client->debug_data,
-			"Failed to initiate primary service discovery");
-
-	client->in_init = false;
-	notify_client_ready(client, false, att_ecode);
-
-	discovery_op_unref(op);
+	discover_all(op, att_ecode);
 }
 
 struct service_changed_op {
@@ -1282,15 +1405,15 @@ static unsigned int register_notify(struct bt_gatt_client *client,
 	notify_data->user_data = user_data;
 	notify_data->destroy = destroy;
 
-	/* Add the handler to the bt_gatt_client's general list */
-	queue_push_tail(client->notify_list, notify_data);
-
 	/* Assign an ID to the handler. */
 	if (client->next_reg_id < 1)
 		client->next_reg_id = 1;
 
 	notify_data->id = client->next_reg_id++;
 
+	/* Add the handler to the bt_gatt_client's general list */
+	queue_push_tail(client->notify_list, notify_data);
+
 	/*
 	 * If a write to the CCC descriptor is in progress, then queue this
 	 * request.
@@ -1381,6 +1504,52 @@ static bool register_service_changed(struct bt_gatt_client *client)
 	return client->svc_chngd_ind_id ? true : false;
 }
 
+static void write_client_features_cb(uint8_t opcode, const void *pdu,
+					uint16_t length, void *user_data)
+{
+	struct bt_gatt_client *client = user_data;
+
+	client->cli_feat_id = 0;
+
+	if (opcode != BT_ATT_OP_WRITE_RSP)
+		util_debug(client->debug_callback, client->debug_data,
+				"Failed to write Client Supported Features");
+}
+
+/*
+ * Tell the server which features are supported, on every connection as it
+ * does not keep them across connections. Robust caching gets change-unaware
+ * errors instead of stale handles after the database changed.
+ */
+static void write_client_features(struct bt_gatt_client *client)
+{
+	struct gatt_db_attribute *attr = NULL;
+	bt_uuid_t uuid;
+	uint8_t pdu[3];
+
+	if (client->cli_feat_id)
+		return;
+
+	bt_uuid16_create(&uuid, GATT_CHARAC_CLI_FEAT);
+
+	gatt_db_find_by_type(client->db, 0x0001, 0xffff, &uuid,
+						get_first_attribute, &attr);
+	if (!attr)
+		return;
+
+	put_le16(gatt_db_attribute_get_handle(attr), pdu);
+	pdu[2] = BT_GATT_CHRC_CLI_FEAT_ROBUST_CACHING |
+					BT_GATT_CHRC_CLI_FEAT_NFY_MULTI;
+
+	client->cli_feat_id = bt_att_send(client->att, BT_ATT_OP_WRITE_REQ,
+						pdu, sizeof(pdu),
+						write_client_features_cb,
+						client, NULL);
+	if (!client->cli_feat_id)
+		util_debug(client->debug_callback, client->debug_data,
+				"Failed to write Client Supported Features");
+}
+
 static void service_changed_complete(struct discovery_op *op, bool success,
 							uint8_t att_ecode)
 {
@@ -1506,16 +1675,46 @@ static void service_changed_cb(uint16_t value_handle, const uint8_t *value,
 	queue_push_tail(client->svc_chngd_queue, op);
 }
 
+static void init_complete(struct discovery_op *op, bool success,
+							uint8_t att_ecode);
+
+static void db_hash_store_cb(uint8_t opcode, const void *pdu,
+					uint16_t length, void *user_data)
+{
+	struct discovery_op *op = user_data;
+	struct bt_gatt_client *client = op->client;
+	const uint8_t *value;
+
+	client->db_hash_id = 0;
+	client->db_hash_checked = true;
+
+	/* Cache the hash with the database to validate it on reconnection */
+	value = db_hash_rsp(opcode, pdu, length);
+	if (value)
+		gatt_db_attribute_write(get_db_hash_attr(client->db), 0, value,
+						16, 0, NULL, db_hash_write_cb,
+						NULL);
+
+	init_complete(op, true, 0);
+}
+
 static void init_complete(struct discovery_op *op, bool success,
 							uint8_t att_ecode)
 {
 	struct bt_gatt_client *client = op->client;
 
+	if (success && !client->db_hash_checked &&
+					get_db_hash_attr(client->db) &&
+					read_db_hash(op, db_hash_store_cb))
+		return;
+
 	client->in_init = false;
 
 	if (!success)
 		goto fail;
 
+	write_client_features(client);
+
 	if (register_service_changed(client))
 		goto done;
 
@@ -1569,7 +1768,8 @@ static bool gatt_client_init(struct bt_gatt_client *client, uint16_t mtu)
 }
 
 struct pdu_data {
-	const void *pdu;
+	uint16_t value_handle;
+	const uint8_t *value;
 	uint16_t length;
 };
 
@@ -1623,23 +1823,17 @@ static void notify_handler(void *data, void *user_data)
 {
 	struct notify_data *notify_data = data;
 	struct pdu_data *pdu_data = user_data;
-	uint16_t value_handle;
-	const uint8_t *value = NULL;
 
-	value_handle = get_le16(pdu_data->pdu);
-
-	if (notify_data->chrc->value_handle != value_handle)
+	if (notify_data->chrc->value_handle != pdu_data->value_handle)
 		return;
 
-	if (pdu_data->length > 2)
-		value = pdu_data->pdu + 2;
-
 	/*
 	 * Even if the notify data has a pending ATT request to write to the
 	 * CCC, there is really no reason not to notify the handlers.
 	 */
 	if (notify_data->notify)
-		notify_data->notify(value_handle, value, pdu_data->length - 2,
+		notify_data->notify(pdu_data->value_handle, pdu_data->value,
+							pdu_data->length,
 							notify_data->user_data);
 }
 
@@ -1652,10 +1846,15 @@ static void notify_cb(uint8_t opcode, const void *pdu, uint16_t length,
 	bt_gatt_client_ref(client);
 
 	memset(&pdu_data, 0, sizeof(pdu_data));
-	pdu_data.pdu = pdu;
-	pdu_data.length = length;
 
-	queue_foreach(client->notify_list, notify_handler, &pdu_data);
+	if (length >= 2) {
+		pdu_data.value_handle = get_le16(pdu);
+		pdu_data.length = length - 2;
+		if (pdu_data.length)
+			pdu_data.value = (const uint8_t *) pdu + 2;
+
+		queue_foreach(client->notify_list, notify_handler, &pdu_data);
+	}
 
 	if (opcode == BT_ATT_OP_HANDLE_VAL_IND)
 		bt_att_send(client->att, BT_ATT_OP_HANDLE_VAL_CONF, NULL, 0,
@@ -1664,6 +1863,43 @@ static void notify_cb(uint8_t opcode, const void *pdu, uint16_t length,
 	bt_gatt_client_unref(client);
 }
 
+static void notify_mult_cb(uint8_t opcode, const void *pdu, uint16_t length,
+								void *user_data)
+{
+	struct bt_gatt_client *client = user_data;
+	const uint8_t *ptr = pdu;
+	struct pdu_data pdu_data;
+
+	bt_gatt_client_ref(client);
+
+	/* Handle Length Value Tuples, dispatched as separate notifications */
+	while (length >= 4) {
+		memset(&pdu_data, 0, sizeof(pdu_data));
+		pdu_data.value_handle = get_le16(ptr);
+		pdu_data.length = get_le16(ptr + 2);
+
+		ptr += 4;
+		length -= 4;
+
+		if (pdu_data.length > length) {
+			util_debug(client->debug_callback, client->debug_data,
+					"Malformed Multiple Handle Value "
+					"Notification");
+			break;
+		}
+
+		if (pdu_data.length)
+			pdu_data.value = ptr;
+
+		queue_foreach(client->notify_list, notify_handler, &pdu_data);
+
+		ptr += pdu_data.length;
+		length -= pdu_data.length;
+	}
+
+	bt_gatt_client_unref(client);
+}
+
 static void notify_data_cleanup(void *data)
 {
 	struct notify_data *notify_data = data;
@@ -1690,6 +1926,7 @@ static void bt_gatt_client_free(struct bt_gatt_client *client)
 		bt_att_unregister_disconnect(client->att, client->disc_id);
 		bt_att_unregister(client->att, client->notify_id);
 		bt_att_unregister(client->att, client->ind_id);
+		bt_att_unregister(client->att, client->nfy_mult_id);
 		bt_att_unref(client->att);
 	}
 
@@ -1746,7 +1983,7 @@ struct bt_gatt_client *bt_gatt_client_new(struct gatt_db *db,
 	if (!client->svc_chngd_queue)
 		goto fail;
 
-	client->notify_list = queue_new();
+	client->notify_list = queue_new_keyed(notify_data_key);
 	if (!client->notify_list)
 		goto fail;
 
@@ -1754,7 +1991,7 @@ struct bt_gatt_client *bt_gatt_client_new(struct gatt_db *db,
 	if (!client->notify_chrcs)
 		goto fail;
 
-	client->pending_requests = queue_new();
+	client->pending_requests = queue_new_keyed(request_key);
 	if (!client->pending_requests)
 		goto fail;
 
@@ -1768,6 +2005,11 @@ struct bt_gatt_client *bt_gatt_client_new(struct gatt_db *db,
 	if (!client->ind_id)
 		goto fail;
 
+	client->nfy_mult_id = bt_att_register(att, BT_ATT_OP_HANDLE_NFY_MULT,
+						notify_mult_cb, client, NULL);
+	if (!client->nfy_mult_id)
+		goto fail;
+
 	client->att = bt_att_ref(att);
 	client->db = gatt_db_ref(db);
 
@@ -1894,14 +2136,6 @@ struct gatt_db *bt_gatt_client_get_db(struct bt_gatt_client *client)
 	return client->db;
 }
 
-static bool match_req_id(const void *a, const void *b)
-{
-	const struct request *req = a;
-	unsigned int id = PTR_TO_UINT(b);
-
-	return req->id == id;
-}
-
 static void cancel_long_write_cb(uint8_t opcode, const void *pdu, uint16_t len,
 								void *user_data)
 {
@@ -1971,8 +2205,7 @@ bool bt_gatt_client_cancel(struct bt_gatt_client *client, unsigned int id)
 	if (!client || !id || !client->att)
 		return false;
 
-	req = queue_remove_if(client->pending_requests, match_req_id,
-							UINT_TO_PTR(id));
+	req = queue_remove_by_key(client->pending_requests, id);
 	if (!req)
 		return false;
 
@@ -1996,6 +2229,12 @@ bool bt_gatt_client_cancel_all(struct bt_gatt_client *client)
 	if (client->mtu_req_id)
 		bt_att_cancel(client->att, client->mtu_req_id);
 
+	if (client->db_hash_id)
+		bt_att_cancel(client->att, client->db_hash_id);
+
+	if (client->cli_feat_id)
+		bt_att_cancel(client->att, client->cli_feat_id);
+
 	return true;
 }
 
@@ -2099,7 +2338,9 @@ static void read_multiple_cb(uint8_t opcode, const void *pdu, uint16_t length,
 	uint8_t att_ecode;
 	bool success;
 
-	if (opcode != BT_ATT_OP_READ_MULT_RSP || (!pdu && length)) {
+	if ((opcode != BT_ATT_OP_READ_MULT_RSP &&
+				opcode != BT_ATT_OP_READ_MULT_VL_RSP) ||
+				(!pdu && length)) {
 		success = false;
 
 		if (opcode == BT_ATT_OP_ERROR_RSP)
@@ -2118,7 +2359,8 @@ static void read_multiple_cb(uint8_t opcode, const void *pdu, uint16_t length,
 		op->callback(success, att_ecode, pdu, length, op->user_data);
 }
 
-unsigned int bt_gatt_client_read_multiple(struct bt_gatt_client *client,
+static unsigned int read_multiple(struct bt_gatt_client *client,
+					uint8_t opcode,
 					uint16_t *handles, uint8_t num_handles,
 					bt_gatt_client_read_callback_t callback,
 					void *user_data,
@@ -2158,8 +2400,7 @@ unsigned int bt_gatt_client_read_multiple(struct bt_gatt_client *client,
 	for (i = 0; i < num_handles; i++)
 		put_le16(handles[i], pdu + (2 * i));
 
-	req->att_id = bt_att_send(client->att, BT_ATT_OP_READ_MULT_REQ,
-							pdu, sizeof(pdu),
+	req->att_id = bt_att_send(client->att, opcode, pdu, sizeof(pdu),
 							read_multiple_cb, req,
 							request_unref);
 	if (!req->att_id) {
@@ -2171,6 +2412,29 @@ unsigned int bt_gatt_client_read_multiple(struct bt_gatt_client *client,
 	return req->id;
 }
 
+unsigned int bt_gatt_client_read_multiple(struct bt_gatt_client *client,
+					uint16_t *handles, uint8_t num_handles,
+					bt_gatt_client_read_callback_t callback,
+					void *user_data,
+					bt_gatt_client_destroy_func_t destroy)
+{
+	return read_multiple(client, BT_ATT_OP_READ_MULT_REQ, handles,
+						num_handles, callback,
+						user_data, destroy);
+}
+
+unsigned int bt_gatt_client_read_multiple_variable(
+					struct bt_gatt_client *client,
+					uint16_t *handles, uint8_t num_handles,
+					bt_gatt_client_read_callback_t callback,
+					void *user_data,
+					bt_gatt_client_destroy_func_t destroy)
+{
+	return read_multiple(client, BT_ATT_OP_READ_MULT_VL_REQ, handles,
+						num_handles, callback,
+						user_data, destroy);
+}
+
 struct read_long_op {
 	struct bt_gatt_client *client;
 	int ref_count;
@@ -2827,8 +3091,7 @@ static struct request *get_reliable_request(struct bt_gatt_client *client,
 
 	/* Following prepare writes */
 	if (id != 0)
-		req = queue_find(client->pending_requests, match_req_id,
-							UINT_TO_PTR(id));
+		req = queue_find_by_key(client->pending_requests, id);
 	else
 		req = request_create(client);
 
@@ -2985,8 +3248,7 @@ unsigned int bt_gatt_client_write_execute(struct bt_gatt_client *client,
 	if (!op)
 		return 0;
 
-	req = queue_find(client->pending_requests, match_req_id,
-							UINT_TO_PTR(id));
+	req = queue_find_by_key(client->pending_requests, id);
 	if (!req) {
 		free(op);
 		return 0;
@@ -3039,8 +3301,7 @@ bool bt_gatt_client_unregister_notify(struct bt_gatt_client *client,
 	if (!client || !id)
 		return false;
 
-	notify_data = queue_remove_if(client->notify_list, match_notify_data_id,
-							UINT_TO_PTR(id));
+	notify_data = queue_remove_by_key(client->notify_list, id);
 	if (!notify_data)
 		return false;
 
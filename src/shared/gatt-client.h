@@ -94,6 +94,16 @@ unsigned int bt_gatt_client_read_multiple(struct bt_gatt_client *client,
 					bt_gatt_client_read_callback_t callback,
 					void *user_data,
 					bt_gatt_client_destroy_func_t destroy);
+/*
+ * The callback gets the raw list of length/value tuples, in the order of
+ * handles. Only the last value may be truncated to fit the MTU.
+ */
+unsigned int bt_gatt_client_read_multiple_variable(
+					struct bt_gatt_client *client,
+					uint16_t *handles, uint8_t num_handles,
+					bt_gatt_client_read_callback_t callback,
+					void *user_data,
+					bt_gatt_client_destroy_func_t destroy);
 
 unsigned int bt_gatt_client_write_without_response(
 					struct bt_gatt_client *client,
@@ -30,6 +30,7 @@
 #include "src/shared/queue.h"
 #include "src/shared/timeout.h"
 #include "src/shared/att.h"
+#include "src/shared/crypto.h"
 #include "src/shared/gatt-db.h"
 
 #ifndef MAX
@@ -39,6 +40,32 @@
 #define MAX_CHAR_DECL_VALUE_LEN 19
 #define MAX_INCLUDED_VALUE_LEN 6
 #define ATTRIBUTE_TIMEOUT 5000
+#define HANDLE_PAGE_SHIFT 8
+#define HANDLE_PAGE_SIZE (1 << HANDLE_PAGE_SHIFT)
+#define HANDLE_PAGE_COUNT (0x10000 >> HANDLE_PAGE_SHIFT)
+
+/* Attribute types with their own handle-sorted bucket in struct gatt_db */
+enum {
+	BUCKET_PRIMARY,
+	BUCKET_SECONDARY,
+	BUCKET_INCLUDE,
+	BUCKET_CHARAC,
+	BUCKET_EXT_PROPER,
+	BUCKET_USER_DESC,
+	BUCKET_CCC,
+	NUM_BUCKETS,
+	BUCKET_NONE = NUM_BUCKETS
+};
+
+static const uint16_t bucket_types[NUM_BUCKETS] = {
+	[BUCKET_PRIMARY] = GATT_PRIM_SVC_UUID,
+	[BUCKET_SECONDARY] = GATT_SND_SVC_UUID,
+	[BUCKET_INCLUDE] = GATT_INCLUDE_UUID,
+	[BUCKET_CHARAC] = GATT_CHARAC_UUID,
+	[BUCKET_EXT_PROPER] = GATT_CHARAC_EXT_PROPER_UUID,
+	[BUCKET_USER_DESC] = GATT_CHARAC_USER_DESC_UUID,
+	[BUCKET_CCC] = GATT_CLIENT_CHARAC_CFG_UUID,
+};
 
 static const bt_uuid_t primary_service_uuid = { .type = BT_UUID16,
 					.value.u16 = GATT_PRIM_SVC_UUID };
@@ -49,6 +76,12 @@ static const bt_uuid_t characteristic_uuid = { .type = BT_UUID16,
 static const bt_uuid_t included_service_uuid = { .type = BT_UUID16,
 					.value.u16 = GATT_INCLUDE_UUID };
 
+struct attr_list {
+	struct gatt_db_attribute **attrs;
+	unsigned int len;
+	unsigned int size;
+};
+
 struct gatt_db {
 	int ref_count;
 	uint16_t next_handle;
@@ -56,6 +89,20 @@ struct gatt_db {
 
 	struct queue *notify_list;
 	unsigned int next_notify_id;
+
+	/*
+	 * All attributes of all services sorted by handle, the same split
+	 * up per well-known type, and a sparse two-level table mapping a
+	 * handle directly to its attribute.
+	 */
+	struct attr_list index;
+	struct attr_list buckets[NUM_BUCKETS];
+	struct gatt_db_attribute **handle_map[HANDLE_PAGE_COUNT];
+
+	/* Database Hash, recomputed on demand once hash_valid is cleared */
+	struct bt_crypto *crypto;
+	uint8_t hash[16];
+	bool hash_valid;
 };
 
 struct notify {
@@ -86,6 +133,8 @@ struct gatt_db_attribute {
 	struct gatt_db_service *service;
 	uint16_t handle;
 	bt_uuid_t uuid;
+	uint128_t uuid128;
+	unsigned int bucket;
 	uint32_t permissions;
 	uint16_t value_len;
 	uint8_t *value;
@@ -105,10 +154,70 @@ struct gatt_db_service {
 	struct gatt_db *db;
 	bool active;
 	bool claimed;
+	uint128_t uuid128;
 	uint16_t num_handles;
 	struct gatt_db_attribute **attributes;
+
+	/* This service's share of the Database Hash input, NULL when stale */
+	uint8_t *hash_data;
+	size_t hash_len;
 };
 
+static void uuid_to_uuid128(const bt_uuid_t *uuid, uint128_t *u128)
+{
+	bt_uuid_t tmp;
+
+	if (uuid->type == BT_UUID128) {
+		*u128 = uuid->value.u128;
+		return;
+	}
+
+	memset(&tmp, 0, sizeof(tmp));
+	bt_uuid_to_uuid128(uuid, &tmp);
+	*u128 = tmp.value.u128;
+}
+
+static bool uuid128_eq(const uint128_t *a, const uint128_t *b)
+{
+	return !memcmp(a, b, sizeof(*a));
+}
+
+/* Returns 0 unless uuid is a 16-bit Bluetooth UUID, in any of its widths */
+static uint16_t uuid_to_uuid16(const bt_uuid_t *uuid)
+{
+	uint128_t u128, base;
+	bt_uuid_t u16;
+	uint16_t value;
+
+	if (uuid->type == BT_UUID16)
+		return uuid->value.u16;
+
+	uuid_to_uuid128(uuid, &u128);
+	value = get_be16(&u128.data[2]);
+
+	bt_uuid16_create(&u16, value);
+	uuid_to_uuid128(&u16, &base);
+
+	return uuid128_eq(&u128, &base) ? value : 0;
+}
+
+static unsigned int uuid_bucket(const bt_uuid_t *uuid)
+{
+	uint16_t value;
+	unsigned int i;
+
+	value = uuid_to_uuid16(uuid);
+	if (!value)
+		return BUCKET_NONE;
+
+	for (i = 0; i < NUM_BUCKETS; i++) {
+		if (bucket_types[i] == value)
+			return i;
+	}
+
+	return BUCKET_NONE;
+}
+
 static void pending_read_result(struct pending_read *p, int err,
 					const uint8_t *data, size_t length)
 {
@@ -172,6 +281,8 @@ static struct gatt_db_attribute *new_attribute(struct gatt_db_service *service,
 	attribute->service = service;
 	attribute->handle = handle;
 	attribute->uuid = *type;
+	uuid_to_uuid128(type, &attribute->uuid128);
+	attribute->bucket = uuid_bucket(type);
 	attribute->value_len = len;
 	if (len) {
 		attribute->value = malloc0(len);
@@ -196,6 +307,162 @@ failed:
 	return NULL;
 }
 
+static unsigned int list_lower_bound(const struct attr_list *list,
+							unsigned int handle)
+{
+	unsigned int lo = 0, hi = list->len;
+
+	while (lo < hi) {
+		unsigned int mid = lo + (hi - lo) / 2;
+
+		if (list->attrs[mid]->handle < handle)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+static bool list_insert(struct attr_list *list,
+					struct gatt_db_attribute *attr)
+{
+	unsigned int pos;
+
+	if (list->len == list->size) {
+		struct gatt_db_attribute **attrs;
+		unsigned int size = list->size ? list->size * 2 : 16;
+
+		attrs = realloc(list->attrs, size * sizeof(*attrs));
+		if (!attrs)
+			return false;
+
+		list->attrs = attrs;
+		list->size = size;
+	}
+
+	pos = list_lower_bound(list, attr->handle);
+
+	memmove(&list->attrs[pos + 1], &list->attrs[pos],
+				(list->len - pos) * sizeof(*list->attrs));
+	list->attrs[pos] = attr;
+	list->len++;
+
+	return true;
+}
+
+static void list_remove_range(struct attr_list *list, uint16_t start,
+								uint16_t end)
+{
+	unsigned int lo, hi;
+
+	lo = list_lower_bound(list, start);
+	hi = list_lower_bound(list, end + 1U);
+
+	if (lo == hi)
+		return;
+
+	memmove(&list->attrs[lo], &list->attrs[hi],
+				(list->len - hi) * sizeof(*list->attrs));
+	list->len -= hi - lo;
+}
+
+static struct gatt_db_attribute *index_lookup(struct gatt_db *db,
+							uint16_t handle)
+{
+	struct gatt_db_attribute **page;
+
+	page = db->handle_map[handle >> HANDLE_PAGE_SHIFT];
+	if (!page)
+		return NULL;
+
+	return page[handle & (HANDLE_PAGE_SIZE - 1)];
+}
+
+static void service_hash_invalidate(struct gatt_db_service *service)
+{
+	free(service->hash_data);
+	service->hash_data = NULL;
+	service->hash_len = 0;
+
+	if (service->db)
+		service->db->hash_valid = false;
+}
+
+static bool index_add(struct gatt_db *db, struct gatt_db_attribute *attr)
+{
+	struct gatt_db_attribute ***page;
+
+	if (!attr->handle || index_lookup(db, attr->handle))
+		return false;
+
+	page = &db->handle_map[attr->handle >> HANDLE_PAGE_SHIFT];
+	if (!*page) {
+		*page = new0(struct gatt_db_attribute *, HANDLE_PAGE_SIZE);
+		if (!*page)
+			return false;
+	}
+
+	if (!list_insert(&db->index, attr))
+		return false;
+
+	if (attr->bucket != BUCKET_NONE &&
+			!list_insert(&db->buckets[attr->bucket], attr)) {
+		list_remove_range(&db->index, attr->handle, attr->handle);
+		return false;
+	}
+
+	(*page)[attr->handle & (HANDLE_PAGE_SIZE - 1)] = attr;
+
+	service_hash_invalidate(attr->service);
+
+	return true;
+}
+
+static void index_remove_range(struct gatt_db *db, uint16_t start,
+								uint16_t end)
+{
+	unsigned int lo, hi, i;
+
+	lo = list_lower_bound(&db->index, start);
+	hi = list_lower_bound(&db->index, end + 1U);
+
+	if (lo == hi)
+		return;
+
+	for (i = lo; i < hi; i++) {
+		uint16_t handle = db->index.attrs[i]->handle;
+
+		db->handle_map[handle >> HANDLE_PAGE_SHIFT]
+				[handle & (HANDLE_PAGE_SIZE - 1)] = NULL;
+	}
+
+	list_remove_range(&db->index, start, end);
+
+	for (i = 0; i < NUM_BUCKETS; i++)
+		list_remove_range(&db->buckets[i], start, end);
+
+	db->hash_valid = false;
+}
+
+/*
+ * Picks the handle-sorted list to scan for attributes of the given type. If
+ * the returned list is a bucket every entry already matches the type.
+ */
+static const struct attr_list *type_list(struct gatt_db *db,
+						const bt_uuid_t *type,
+						bool *filter)
+{
+	unsigned int bucket = uuid_bucket(type);
+
+	*filter = bucket == BUCKET_NONE;
+
+	if (*filter)
+		return &db->index;
+
+	return &db->buckets[bucket];
+}
+
 struct gatt_db *gatt_db_ref(struct gatt_db *db)
 {
 	if (!db)
@@ -285,6 +552,18 @@ static void notify_service_changed(struct gatt_db *db,
 	gatt_db_unref(db);
 }
 
+static void gatt_db_service_get_handles(const struct gatt_db_service *service,
+							uint16_t *start_handle,
+							uint16_t *end_handle)
+{
+	if (start_handle)
+		*start_handle = service->attributes[0]->handle;
+
+	if (end_handle)
+		*end_handle = service->attributes[0]->handle +
+						service->num_handles - 1;
+}
+
 static void gatt_db_service_destroy(void *data)
 {
 	struct gatt_db_service *service = data;
@@ -293,15 +572,26 @@ static void gatt_db_service_destroy(void *data)
 	if (service->active)
 		notify_service_changed(service->db, service, false);
 
+	/* Attributes never leave the service range, see service_in_range() */
+	if (service->db) {
+		uint16_t start, end;
+
+		gatt_db_service_get_handles(service, &start, &end);
+		index_remove_range(service->db, start, end);
+	}
+
 	for (i = 0; i < service->num_handles; i++)
 		attribute_destroy(service->attributes[i]);
 
 	free(service->attributes);
+	free(service->hash_data);
 	free(service);
 }
 
 static void gatt_db_destroy(struct gatt_db *db)
 {
+	int i;
+
 	if (!db)
 		return;
 
@@ -313,6 +603,15 @@ static void gatt_db_destroy(struct gatt_db *db)
 	db->notify_list = NULL;
 
 	queue_destroy(db->services, gatt_db_service_destroy);
+
+	for (i = 0; i < HANDLE_PAGE_COUNT; i++)
+		free(db->handle_map[i]);
+
+	for (i = 0; i < NUM_BUCKETS; i++)
+		free(db->buckets[i].attrs);
+
+	free(db->index.attrs);
+	bt_crypto_unref(db->crypto);
 	free(db);
 }
 
@@ -395,6 +694,8 @@ static struct gatt_db_service *gatt_db_service_create(const bt_uuid_t *uuid,
 		return NULL;
 	}
 
+	uuid_to_uuid128(uuid, &service->uuid128);
+
 	if (primary)
 		type = &primary_service_uuid;
 	else
@@ -442,18 +743,6 @@ bool gatt_db_clear(struct gatt_db *db)
 	return true;
 }
 
-static void gatt_db_service_get_handles(const struct gatt_db_service *service,
-							uint16_t *start_handle,
-							uint16_t *end_handle)
-{
-	if (start_handle)
-		*start_handle = service->attributes[0]->handle;
-
-	if (end_handle)
-		*end_handle = service->attributes[0]->handle +
-						service->num_handles - 1;
-}
-
 struct clear_range {
 	uint16_t start, end;
 };
@@ -537,20 +826,19 @@ struct gatt_db_attribute *gatt_db_insert_service(struct gatt_db *db,
 
 	service = find_insert_loc(db, handle, handle + num_handles - 1, &after);
 	if (service) {
-		const bt_uuid_t *type;
-		bt_uuid_t value;
+		unsigned int bucket;
+		uint128_t value;
 
 		if (primary)
-			type = &primary_service_uuid;
+			bucket = BUCKET_PRIMARY;
 		else
-			type = &secondary_service_uuid;
+			bucket = BUCKET_SECONDARY;
 
-		gatt_db_attribute_get_service_uuid(service->attributes[0],
-									&value);
+		uuid_to_uuid128(uuid, &value);
 
 		/* Check if service match */
-		if (!bt_uuid_cmp(&service->attributes[0]->uuid, type) &&
-				!bt_uuid_cmp(&value, uuid) &&
+		if (service->attributes[0]->bucket == bucket &&
+				uuid128_eq(&service->uuid128, &value) &&
 				service->num_handles == num_handles &&
 				service->attributes[0]->handle == handle)
 			return service->attributes[0];
@@ -574,6 +862,11 @@ struct gatt_db_attribute *gatt_db_insert_service(struct gatt_db *db,
 	service->attributes[0]->handle = handle;
 	service->num_handles = num_handles;
 
+	if (!index_add(db, service->attributes[0])) {
+		queue_remove(db->services, service);
+		goto fail;
+	}
+
 	/* Fast-forward next_handle if the new service was added to the end */
 	db->next_handle = MAX(handle + num_handles, db->next_handle);
 
@@ -676,6 +969,49 @@ attribute_update(struct gatt_db_service *service, int index)
 	return service->attributes[index];
 }
 
+static bool service_in_range(struct gatt_db_service *service, uint16_t handle)
+{
+	uint16_t start, end;
+
+	gatt_db_service_get_handles(service, &start, &end);
+
+	return handle > start && handle <= end;
+}
+
+/*
+ * Returns an attribute already present at handle if it belongs to the same
+ * service and has the same type, so rediscovery into a populated db does not
+ * fail.
+ */
+static struct gatt_db_attribute *
+service_find_existing(struct gatt_db_service *service, uint16_t handle,
+						const bt_uuid_t *uuid,
+						bool *busy)
+{
+	struct gatt_db_attribute *attr;
+	uint128_t u128;
+
+	attr = index_lookup(service->db, handle);
+
+	*busy = attr != NULL;
+
+	if (!attr || attr->service != service)
+		return NULL;
+
+	uuid_to_uuid128(uuid, &u128);
+
+	if (!uuid128_eq(&attr->uuid128, &u128))
+		return NULL;
+
+	return attr;
+}
+
+static void service_drop_attribute(struct gatt_db_service *service, int index)
+{
+	attribute_destroy(service->attributes[index]);
+	service->attributes[index] = NULL;
+}
+
 static void set_attribute_data(struct gatt_db_attribute *attribute,
 						gatt_db_read_t read_func,
 						gatt_db_write_t write_func,
@@ -698,12 +1034,14 @@ service_insert_characteristic(struct gatt_db_service *service,
 					gatt_db_write_t write_func,
 					void *user_data)
 {
+	struct gatt_db_attribute *attr;
 	uint8_t value[MAX_CHAR_DECL_VALUE_LEN];
 	uint16_t len = 0;
+	bool busy;
 	int i;
 
 	/* Check if handle is in within service range */
-	if (handle && handle <= service->attributes[0]->handle)
+	if (handle && !service_in_range(service, handle - 1))
 		return NULL;
 
 	/*
@@ -725,6 +1063,16 @@ service_insert_characteristic(struct gatt_db_service *service,
 	if (!handle)
 		handle = get_handle_at_index(service, i - 1) + 2;
 
+	if (!service_in_range(service, handle))
+		return NULL;
+
+	attr = service_find_existing(service, handle, uuid, &busy);
+	if (busy)
+		return attr;
+
+	if (index_lookup(service->db, handle - 1))
+		return NULL;
+
 	value[0] = properties;
 	len += sizeof(properties);
 
@@ -743,14 +1091,27 @@ service_insert_characteristic(struct gatt_db_service *service,
 
 	service->attributes[i] = new_attribute(service, handle, uuid, NULL, 0);
 	if (!service->attributes[i]) {
-		free(service->attributes[i - 1]);
+		service_drop_attribute(service, i - 1);
 		return NULL;
 	}
 
+	if (!index_add(service->db, service->attributes[i - 1]))
+		goto fail;
+
+	if (!index_add(service->db, service->attributes[i])) {
+		index_remove_range(service->db, handle - 1, handle - 1);
+		goto fail;
+	}
+
 	set_attribute_data(service->attributes[i], read_func, write_func,
 							permissions, user_data);
 
 	return service->attributes[i];
+
+fail:
+	service_drop_attribute(service, i);
+	service_drop_attribute(service, i - 1);
+	return NULL;
 }
 
 struct gatt_db_attribute *
@@ -799,23 +1160,39 @@ service_insert_descriptor(struct gatt_db_service *service,
 					gatt_db_write_t write_func,
 					void *user_data)
 {
+	struct gatt_db_attribute *attr;
+	bool busy;
 	int i;
 
-	i = get_attribute_index(service, 0);
-	if (!i)
+	/* Check if handle is in within service range */
+	if (handle && !service_in_range(service, handle))
 		return NULL;
 
-	/* Check if handle is in within service range */
-	if (handle && handle <= service->attributes[0]->handle)
+	if (handle) {
+		attr = service_find_existing(service, handle, uuid, &busy);
+		if (busy)
+			return attr;
+	}
+
+	i = get_attribute_index(service, 0);
+	if (!i)
 		return NULL;
 
 	if (!handle)
 		handle = get_handle_at_index(service, i - 1) + 1;
 
+	if (!service_in_range(service, handle))
+		return NULL;
+
 	service->attributes[i] = new_attribute(service, handle, uuid, NULL, 0);
 	if (!service->attributes[i])
 		return NULL;
 
+	if (!index_add(service->db, service->attributes[i])) {
+		service_drop_attribute(service, i);
+		return NULL;
+	}
+
 	set_attribute_data(service->attributes[i], read_func, write_func,
 							permissions, user_data);
 
@@ -907,7 +1284,15 @@ gatt_db_service_add_included(struct gatt_db_attribute *attrib,
 	 */
 	set_attribute_data(service->attributes[index], NULL, NULL, 0, NULL);
 
-	return attribute_update(service, index);
+	attribute_update(service, index);
+
+	if (!service_in_range(service, service->attributes[index]->handle) ||
+			!index_add(service->db, service->attributes[index])) {
+		service_drop_attribute(service, index);
+		return NULL;
+	}
+
+	return service->attributes[index];
 }
 
 bool gatt_db_service_set_active(struct gatt_db_attribute *attrib, bool active)
@@ -924,6 +1309,9 @@ bool gatt_db_service_set_active(struct gatt_db_attribute *attrib, bool active)
 
 	service->active = active;
 
+	if (service->db)
+		service->db->hash_valid = false;
+
 	notify_service_changed(service->db, service, active);
 
 	return true;
@@ -961,46 +1349,38 @@ void gatt_db_read_by_group_type(struct gatt_db *db, uint16_t start_handle,
 							const bt_uuid_t type,
 							struct queue *queue)
 {
-	const struct queue_entry *services_entry;
-	struct gatt_db_service *service;
-	uint16_t grp_start, grp_end, uuid_size;
-
-	uuid_size = 0;
-
-	services_entry = queue_get_entries(db->services);
-
-	while (services_entry) {
-		service = services_entry->data;
+	const struct attr_list *list;
+	struct gatt_db_attribute *attribute;
+	unsigned int bucket, i;
+	uint16_t uuid_size;
 
-		if (!service->active)
-			goto next_service;
+	bucket = uuid_bucket(&type);
+	if (bucket != BUCKET_PRIMARY && bucket != BUCKET_SECONDARY)
+		return;
 
-		if (bt_uuid_cmp(&type, &service->attributes[0]->uuid))
-			goto next_service;
+	uuid_size = 0;
+	list = &db->buckets[bucket];
 
-		grp_start = service->attributes[0]->handle;
-		grp_end = grp_start + service->num_handles - 1;
+	for (i = list_lower_bound(list, start_handle); i < list->len; i++) {
+		attribute = list->attrs[i];
 
-		if (grp_end < start_handle || grp_start > end_handle)
-			goto next_service;
+		if (attribute->handle > end_handle)
+			return;
 
-		if (grp_start < start_handle || grp_start > end_handle)
-			goto next_service;
+		if (!attribute->service->active)
+			continue;
 
 		if (!uuid_size)
-			uuid_size = service->attributes[0]->value_len;
-		else if (uuid_size != service->attributes[0]->value_len)
+			uuid_size = attribute->value_len;
+		else if (uuid_size != attribute->value_len)
 			return;
 
-		queue_push_tail(queue, service->attributes[0]);
-
-next_service:
-		services_entry = services_entry->next;
+		queue_push_tail(queue, attribute);
 	}
 }
 
 struct find_by_type_value_data {
-	bt_uuid_t uuid;
+	const bt_uuid_t *uuid;
 	uint16_t start_handle;
 	uint16_t end_handle;
 	gatt_db_attribute_cb_t func;
@@ -1010,27 +1390,31 @@ struct find_by_type_value_data {
 	unsigned int num_of_res;
 };
 
-static void find_by_type(void *data, void *user_data)
+static void find_by_type(struct gatt_db *db,
+				struct find_by_type_value_data *search_data)
 {
-	struct find_by_type_value_data *search_data = user_data;
-	struct gatt_db_service *service = data;
+	const struct attr_list *list;
 	struct gatt_db_attribute *attribute;
-	int i;
+	uint128_t uuid128;
+	unsigned int i;
+	uint16_t handle;
+	bool filter;
 
-	if (!service->active)
-		return;
+	list = type_list(db, search_data->uuid, &filter);
+	uuid_to_uuid128(search_data->uuid, &uuid128);
 
-	for (i = 0; i < service->num_handles; i++) {
-		attribute = service->attributes[i];
+	i = list_lower_bound(list, search_data->start_handle);
 
-		if (!attribute)
-			continue;
+	for (; i < list->len; i++) {
+		attribute = list->attrs[i];
+
+		if (attribute->handle > search_data->end_handle)
+			return;
 
-		if ((attribute->handle < search_data->start_handle) ||
-				(attribute->handle > search_data->end_handle))
+		if (!attribute->service->active)
 			continue;
 
-		if (bt_uuid_cmp(&search_data->uuid, &attribute->uuid))
+		if (filter && !uuid128_eq(&uuid128, &attribute->uuid128))
 			continue;
 
 		/* TODO: fix for read-callback based attributes */
@@ -1040,7 +1424,11 @@ static void find_by_type(void *data, void *user_data)
 			continue;
 
 		search_data->num_of_res++;
+
+		/* The callback may modify the db, so resume by handle */
+		handle = attribute->handle;
 		search_data->func(attribute, search_data->user_data);
+		i = list_lower_bound(list, handle + 1U) - 1;
 	}
 }
 
@@ -1054,13 +1442,13 @@ unsigned int gatt_db_find_by_type(struct gatt_db *db, uint16_t start_handle,
 
 	memset(&data, 0, sizeof(data));
 
-	data.uuid = *type;
+	data.uuid = type;
 	data.start_handle = start_handle;
 	data.end_handle = end_handle;
 	data.func = func;
 	data.user_data = user_data;
 
-	queue_foreach(db->services, find_by_type, &data);
+	find_by_type(db, &data);
 
 	return data.num_of_res;
 }
@@ -1076,102 +1464,47 @@ unsigned int gatt_db_find_by_type_value(struct gatt_db *db,
 {
 	struct find_by_type_value_data data;
 
-	data.uuid = *type;
+	data.uuid = type;
 	data.start_handle = start_handle;
 	data.end_handle = end_handle;
 	data.func = func;
 	data.user_data = user_data;
 	data.value = value;
 	data.value_len = value_len;
+	data.num_of_res = 0;
 
-	queue_foreach(db->services, find_by_type, &data);
+	find_by_type(db, &data);
 
 	return data.num_of_res;
 }
 
-struct read_by_type_data {
-	struct queue *queue;
-	bt_uuid_t uuid;
-	uint16_t start_handle;
-	uint16_t end_handle;
-};
-
-static void read_by_type(void *data, void *user_data)
-{
-	struct read_by_type_data *search_data = user_data;
-	struct gatt_db_service *service = data;
-	struct gatt_db_attribute *attribute;
-	int i;
-
-	if (!service->active)
-		return;
-
-	for (i = 0; i < service->num_handles; i++) {
-		attribute = service->attributes[i];
-		if (!attribute)
-			continue;
-
-		if (attribute->handle < search_data->start_handle)
-			continue;
-
-		if (attribute->handle > search_data->end_handle)
-			return;
-
-		if (bt_uuid_cmp(&search_data->uuid, &attribute->uuid))
-			continue;
-
-		queue_push_tail(search_data->queue, attribute);
-	}
-}
-
 void gatt_db_read_by_type(struct gatt_db *db, uint16_t start_handle,
 						uint16_t end_handle,
 						const bt_uuid_t type,
 						struct queue *queue)
 {
-	struct read_by_type_data data;
-	data.uuid = type;
-	data.start_handle = start_handle;
-	data.end_handle = end_handle;
-	data.queue = queue;
-
-	queue_foreach(db->services, read_by_type, &data);
-}
-
-
-struct find_information_data {
-	struct queue *queue;
-	uint16_t start_handle;
-	uint16_t end_handle;
-};
-
-static void find_information(void *data, void *user_data)
-{
-	struct find_information_data *search_data = user_data;
-	struct gatt_db_service *service = data;
+	const struct attr_list *list;
 	struct gatt_db_attribute *attribute;
-	int i;
+	uint128_t uuid128;
+	unsigned int i;
+	bool filter;
 
-	if (!service->active)
-		return;
+	list = type_list(db, &type, &filter);
+	uuid_to_uuid128(&type, &uuid128);
 
-	/* Check if service is in range */
-	if ((service->attributes[0]->handle + service->num_handles - 1) <
-						search_data->start_handle)
-		return;
+	for (i = list_lower_bound(list, start_handle); i < list->len; i++) {
+		attribute = list->attrs[i];
 
-	for (i = 0; i < service->num_handles; i++) {
-		attribute = service->attributes[i];
-		if (!attribute)
-			continue;
+		if (attribute->handle > end_handle)
+			return;
 
-		if (attribute->handle < search_data->start_handle)
+		if (!attribute->service->active)
 			continue;
 
-		if (attribute->handle > search_data->end_handle)
-			return;
+		if (filter && !uuid128_eq(&uuid128, &attribute->uuid128))
+			continue;
 
-		queue_push_tail(search_data->queue, attribute);
+		queue_push_tail(queue, attribute);
 	}
 }
 
@@ -1179,13 +1512,21 @@ void gatt_db_find_information(struct gatt_db *db, uint16_t start_handle,
 							uint16_t end_handle,
 							struct queue *queue)
 {
-	struct find_information_data data;
+	struct gatt_db_attribute *attribute;
+	unsigned int i;
 
-	data.start_handle = start_handle;
-	data.end_handle = end_handle;
-	data.queue = queue;
+	for (i = list_lower_bound(&db->index, start_handle);
+					i < db->index.len; i++) {
+		attribute = db->index.attrs[i];
 
-	queue_foreach(db->services, find_information, &data);
+		if (attribute->handle > end_handle)
+			return;
+
+		if (!attribute->service->active)
+			continue;
+
+		queue_push_tail(queue, attribute);
+	}
 }
 
 void gatt_db_foreach_service(struct gatt_db *db, const bt_uuid_t *uuid,
@@ -1199,6 +1540,7 @@ void gatt_db_foreach_service(struct gatt_db *db, const bt_uuid_t *uuid,
 struct foreach_data {
 	gatt_db_attribute_cb_t func;
 	const bt_uuid_t *uuid;
+	uint128_t uuid128;
 	void *user_data;
 	uint16_t start, end;
 };
@@ -1208,19 +1550,15 @@ static void foreach_service_in_range(void *data, void *user_data)
 	struct gatt_db_service *service = data;
 	struct foreach_data *foreach_data = user_data;
 	uint16_t svc_start;
-	bt_uuid_t uuid;
 
 	svc_start = get_handle_at_index(service, 0);
 
 	if (svc_start > foreach_data->end || svc_start < foreach_data->start)
 		return;
 
-	if (foreach_data->uuid) {
-		gatt_db_attribute_get_service_uuid(service->attributes[0],
-									&uuid);
-		if (bt_uuid_cmp(&uuid, foreach_data->uuid))
-			return;
-	}
+	if (foreach_data->uuid &&
+			!uuid128_eq(&service->uuid128, &foreach_data->uuid128))
+		return;
 
 	foreach_data->func(service->attributes[0], foreach_data->user_data);
 }
@@ -1243,6 +1581,9 @@ void gatt_db_foreach_service_in_range(struct gatt_db *db,
 	data.start = start_handle;
 	data.end = end_handle;
 
+	if (uuid)
+		uuid_to_uuid128(uuid, &data.uuid128);
+
 	queue_foreach(db->services, foreach_service_in_range, &data);
 }
 
@@ -1253,6 +1594,7 @@ void gatt_db_service_foreach(struct gatt_db_attribute *attrib,
 {
 	struct gatt_db_service *service;
 	struct gatt_db_attribute *attr;
+	uint128_t uuid128;
 	uint16_t i;
 
 	if (!attrib || !func)
@@ -1260,12 +1602,15 @@ void gatt_db_service_foreach(struct gatt_db_attribute *attrib,
 
 	service = attrib->service;
 
+	if (uuid)
+		uuid_to_uuid128(uuid, &uuid128);
+
 	for (i = 0; i < service->num_handles; i++) {
 		attr = service->attributes[i];
 		if (!attr)
 			continue;
 
-		if (uuid && bt_uuid_cmp(uuid, &attr->uuid))
+		if (uuid && !uuid128_eq(&uuid128, &attr->uuid128))
 			continue;
 
 		func(attr, user_data);
@@ -1291,7 +1636,7 @@ void gatt_db_service_foreach_desc(struct gatt_db_attribute *attrib,
 		return;
 
 	/* Return if this attribute is not a characteristic declaration */
-	if (bt_uuid_cmp(&characteristic_uuid, &attrib->uuid))
+	if (attrib->bucket != BUCKET_CHARAC)
 		return;
 
 	service = attrib->service;
@@ -1310,8 +1655,8 @@ void gatt_db_service_foreach_desc(struct gatt_db_attribute *attrib,
 			continue;
 
 		/* Return if we reached the end of this characteristic */
-		if (!bt_uuid_cmp(&characteristic_uuid, &attr->uuid) ||
-			!bt_uuid_cmp(&included_service_uuid, &attr->uuid))
+		if (attr->bucket == BUCKET_CHARAC ||
+					attr->bucket == BUCKET_INCLUDE)
 			return;
 
 		func(attr, user_data);
@@ -1326,62 +1671,35 @@ void gatt_db_service_foreach_incl(struct gatt_db_attribute *attrib,
 								user_data);
 }
 
-static bool find_service_for_handle(const void *data, const void *user_data)
-{
-	const struct gatt_db_service *service = data;
-	uint16_t handle = PTR_TO_UINT(user_data);
-	uint16_t start, end;
-
-	gatt_db_service_get_handles(service, &start, &end);
-
-	return (start <= handle) && (handle <= end);
-}
-
 struct gatt_db_attribute *gatt_db_get_attribute(struct gatt_db *db,
 							uint16_t handle)
 {
-	struct gatt_db_service *service;
-	int i;
-
 	if (!db || !handle)
 		return NULL;
 
-	service = queue_find(db->services, find_service_for_handle,
-							UINT_TO_PTR(handle));
-	if (!service)
-		return NULL;
-
-	for (i = 0; i < service->num_handles; i++) {
-		if (!service->attributes[i])
-			continue;
-
-		if (service->attributes[i]->handle == handle)
-			return service->attributes[i];
-	}
-
-	return NULL;
+	return index_lookup(db, handle);
 }
 
 static bool find_service_with_uuid(const void *data, const void *user_data)
 {
 	const struct gatt_db_service *service = data;
-	const bt_uuid_t *uuid = user_data;
-	bt_uuid_t svc_uuid;
+	const uint128_t *uuid128 = user_data;
 
-	gatt_db_attribute_get_service_uuid(service->attributes[0], &svc_uuid);
-
-	return bt_uuid_cmp(uuid, &svc_uuid) == 0;
+	return uuid128_eq(&service->uuid128, uuid128);
 }
 
 struct gatt_db_attribute *gatt_db_get_service_with_uuid(struct gatt_db *db,
 							const bt_uuid_t *uuid)
 {
 	struct gatt_db_service *service;
+	uint128_t uuid128;
 
 	if (!db || !uuid)
 		return NULL;
 
-	service = queue_find(db->services, find_service_with_uuid, uuid);
+	uuid_to_uuid128(uuid, &uuid128);
+
+	service = queue_find(db->services, find_service_with_uuid, &uuid128);
 	if (!service)
 		return NULL;
 
@@ -1471,7 +1789,7 @@ bool gatt_db_attribute_get_service_data(const struct gatt_db_attribute *attrib,
 	gatt_db_service_get_handles(service, start_handle, end_handle);
 
 	if (primary)
-		*primary = bt_uuid_cmp(&decl->uuid, &secondary_service_uuid);
+		*primary = decl->bucket != BUCKET_SECONDARY;
 
 	if (!uuid)
 		return true;
@@ -1492,7 +1810,7 @@ bool gatt_db_attribute_get_char_data(const struct gatt_db_attribute *attrib,
 	if (!attrib)
 		return false;
 
-	if (bt_uuid_cmp(&characteristic_uuid, &attrib->uuid))
+	if (attrib->bucket != BUCKET_CHARAC)
 		return false;
 
 	/*
@@ -1528,7 +1846,7 @@ bool gatt_db_attribute_get_incl_data(const struct gatt_db_attribute *attrib,
 	if (!attrib)
 		return false;
 
-	if (bt_uuid_cmp(&included_service_uuid, &attrib->uuid))
+	if (attrib->bucket != BUCKET_INCLUDE)
 		return false;
 
 	/*
@@ -1716,6 +2034,9 @@ bool gatt_db_attribute_write(struct gatt_db_attribute *attrib, uint16_t offset,
 
 	memcpy(&attrib->value[offset], value, len);
 
+	if (attrib->bucket == BUCKET_EXT_PROPER)
+		service_hash_invalidate(attrib->service);
+
 done:
 	func(attrib, 0, user_data);
 
@@ -1752,5 +2073,159 @@ bool gatt_db_attribute_reset(struct gatt_db_attribute *attrib)
 	attrib->value = NULL;
 	attrib->value_len = 0;
 
+	if (attrib->bucket == BUCKET_EXT_PROPER)
+		service_hash_invalidate(attrib->service);
+
+	return true;
+}
+
+/*
+ * Returns the 16-bit type if attr contributes to the Database Hash (Core 5.1,
+ * Vol 3, Part G, 7.3.1). Declarations and Extended Properties also add their
+ * value, the other descriptors just their handle and type.
+ */
+static uint16_t hash_attribute_type(const struct gatt_db_attribute *attr,
+							bool *with_value)
+{
+	uint16_t type;
+
+	if (attr->bucket != BUCKET_NONE)
+		type = bucket_types[attr->bucket];
+	else
+		type = uuid_to_uuid16(&attr->uuid);
+
+	switch (type) {
+	case GATT_PRIM_SVC_UUID:
+	case GATT_SND_SVC_UUID:
+	case GATT_INCLUDE_UUID:
+	case GATT_CHARAC_UUID:
+	case GATT_CHARAC_EXT_PROPER_UUID:
+		*with_value = true;
+		return type;
+	case GATT_CHARAC_USER_DESC_UUID:
+	case GATT_CLIENT_CHARAC_CFG_UUID:
+	case GATT_SERVER_CHARAC_CFG_UUID:
+	case GATT_CHARAC_FMT_UUID:
+	case GATT_CHARAC_AGREG_FMT_UUID:
+		*with_value = false;
+		return type;
+	default:
+		return 0;
+	}
+}
+
+static bool service_hash_update(struct gatt_db_service *service)
+{
+	const struct attr_list *list = &service->db->index;
+	struct gatt_db_attribute *attr;
+	unsigned int lo, hi, i;
+	uint16_t start, end, type;
+	bool with_value;
+	size_t len = 0;
+	uint8_t *ptr;
+
+	if (service->hash_data)
+		return true;
+
+	/* The index is sorted by handle, the attributes array may not be */
+	gatt_db_service_get_handles(service, &start, &end);
+	lo = list_lower_bound(list, start);
+	hi = list_lower_bound(list, end + 1U);
+
+	for (i = lo; i < hi; i++) {
+		attr = list->attrs[i];
+
+		if (!hash_attribute_type(attr, &with_value))
+			continue;
+
+		len += 4 + (with_value ? attr->value_len : 0);
+	}
+
+	service->hash_data = malloc(len);
+	if (!service->hash_data)
+		return false;
+
+	ptr = service->hash_data;
+
+	for (i = lo; i < hi; i++) {
+		attr = list->attrs[i];
+
+		type = hash_attribute_type(attr, &with_value);
+		if (!type)
+			continue;
+
+		put_le16(attr->handle, ptr);
+		put_le16(type, ptr + 2);
+		ptr += 4;
+
+		if (!with_value || !attr->value_len)
+			continue;
+
+		memcpy(ptr, attr->value, attr->value_len);
+		ptr += attr->value_len;
+	}
+
+	service->hash_len = len;
+
+	return true;
+}
+
+bool gatt_db_get_hash(struct gatt_db *db, uint8_t hash[16])
+{
+	const struct queue_entry *entry;
+	struct gatt_db_service *service;
+	struct iovec *iov;
+	size_t iov_cnt = 0;
+	bool ret;
+
+	if (!db || !hash)
+		return false;
+
+	if (db->hash_valid)
+		goto done;
+
+	if (!db->crypto) {
+		db->crypto = bt_crypto_new();
+		if (!db->crypto)
+			return false;
+	}
+
+	iov = new0(struct iovec, queue_length(db->services) + 1);
+	if (!iov)
+		return false;
+
+	/*
+	 * Only services whose data changed since the last call are serialized
+	 * again, the others reuse their cached share of the input.
+	 */
+	for (entry = queue_get_entries(db->services); entry;
+							entry = entry->next) {
+		service = entry->data;
+
+		if (!service->active)
+			continue;
+
+		if (!service_hash_update(service)) {
+			free(iov);
+			return false;
+		}
+
+		iov[iov_cnt].iov_base = service->hash_data;
+		iov[iov_cnt].iov_len = service->hash_len;
+		iov_cnt++;
+	}
+
+	ret = bt_crypto_gatt_hash(db->crypto, iov, iov_cnt, db->hash);
+
+	free(iov);
+
+	if (!ret)
+		return false;
+
+	db->hash_valid = true;
+
+done:
+	memcpy(hash, db->hash, 16);
+
 	return true;
 }
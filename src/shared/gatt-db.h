@@ -31,6 +31,8 @@ void gatt_db_unref(struct gatt_db *db);
 
 bool gatt_db_isempty(struct gatt_db *db);
 
+bool gatt_db_get_hash(struct gatt_db *db, uint8_t hash[16]);
+
 struct gatt_db_attribute *gatt_db_add_service(struct gatt_db *db,
 						const bt_uuid_t *uuid,
 						bool primary,
@@ -47,6 +47,16 @@
  */
 #define DEFAULT_MAX_PREP_QUEUE_LEN 30
 
+#define GATT_SVC_UUID	0x1801
+#define GATT_SVC_NUM_HANDLES 5
+
+#define ATT_OP_CMD_MASK	0x40
+
+/* Client Supported Features bits this server implements */
+#define CLI_FEAT_SUPPORTED (BT_GATT_CHRC_CLI_FEAT_ROBUST_CACHING | \
+				BT_GATT_CHRC_CLI_FEAT_EATT | \
+				BT_GATT_CHRC_CLI_FEAT_NFY_MULTI)
+
 struct async_read_op {
 	struct bt_gatt_server *server;
 	uint8_t opcode;
@@ -94,6 +104,7 @@ struct bt_gatt_server {
 	unsigned int read_id;
 	unsigned int read_blob_id;
 	unsigned int read_multiple_id;
+	unsigned int read_multiple_vl_id;
 	unsigned int prep_write_id;
 	unsigned int exec_write_id;
 
@@ -103,11 +114,23 @@ struct bt_gatt_server {
 	struct async_read_op *pending_read_op;
 	struct async_write_op *pending_write_op;
 
+	/* Robust caching state, see check_change_aware() */
+	unsigned int db_id;
+	uint8_t cli_feat;
+	bool change_aware;
+	bool aware_pending;
+
 	bt_gatt_server_debug_func_t debug_callback;
 	bt_gatt_server_destroy_func_t debug_destroy;
 	void *debug_data;
 };
 
+/*
+ * All servers, so that the Client Supported Features attribute shared through
+ * the database can find the per-connection state of the bearer accessing it.
+ */
+static struct queue *server_list;
+
 static void bt_gatt_server_free(struct bt_gatt_server *server)
 {
 	if (server->debug_destroy)
@@ -123,9 +146,17 @@ static void bt_gatt_server_free(struct bt_gatt_server *server)
 	bt_att_unregister(server->att, server->read_id);
 	bt_att_unregister(server->att, server->read_blob_id);
 	bt_att_unregister(server->att, server->read_multiple_id);
+	bt_att_unregister(server->att, server->read_multiple_vl_id);
 	bt_att_unregister(server->att, server->prep_write_id);
 	bt_att_unregister(server->att, server->exec_write_id);
 
+	gatt_db_unregister(server->db, server->db_id);
+	queue_remove(server_list, server);
+	if (queue_isempty(server_list)) {
+		queue_destroy(server_list, NULL);
+		server_list = NULL;
+	}
+
 	if (server->pending_read_op)
 		server->pending_read_op->server = NULL;
 
@@ -139,6 +170,18 @@ static void bt_gatt_server_free(struct bt_gatt_server *server)
 	free(server);
 }
 
+static bool match_server_att(const void *a, const void *b)
+{
+	const struct bt_gatt_server *server = a;
+
+	return server->att == b;
+}
+
+static struct bt_gatt_server *find_server(struct bt_att *att)
+{
+	return queue_find(server_list, match_server_att, att);
+}
+
 static bool get_uuid_le(const uint8_t *uuid, size_t len, bt_uuid_t *out_uuid)
 {
 	uint128_t u128;
@@ -158,6 +201,86 @@ static bool get_uuid_le(const uint8_t *uuid, size_t len, bt_uuid_t *out_uuid)
 	return false;
 }
 
+/* Reads of the Database Hash, by type or by handle */
+static bool is_hash_read(struct bt_gatt_server *server, uint8_t opcode,
+					const uint8_t *pdu, uint16_t length)
+{
+	struct gatt_db_attribute *attr;
+	bt_uuid_t uuid, hash;
+
+	bt_uuid16_create(&hash, GATT_CHARAC_DB_HASH);
+
+	switch (opcode) {
+	case BT_ATT_OP_READ_BY_TYPE_REQ:
+		if (length != 6 && length != 20)
+			return false;
+
+		if (!get_uuid_le(pdu + 4, length - 4, &uuid))
+			return false;
+
+		return !bt_uuid_cmp(&uuid, &hash);
+	case BT_ATT_OP_READ_REQ:
+		if (length != 2)
+			return false;
+
+		attr = gatt_db_get_attribute(server->db, get_le16(pdu));
+		if (!attr)
+			return false;
+
+		return !bt_uuid_cmp(gatt_db_attribute_get_type(attr), &hash);
+	default:
+		return false;
+	}
+}
+
+/*
+ * Robust caching, Core 5.1, Vol 3, Part G, 2.5.2.1: once the database changed
+ * a client that enabled it gets Database Out Of Sync for its next request and
+ * its commands are dropped. It becomes change-aware again with the request
+ * following that error or following a read of the Database Hash.
+ */
+static bool check_change_aware(struct bt_gatt_server *server, uint8_t opcode,
+					const void *pdu, uint16_t length)
+{
+	if (server->change_aware)
+		return true;
+
+	if (server->aware_pending) {
+		server->change_aware = true;
+		server->aware_pending = false;
+		return true;
+	}
+
+	/* Commands never get a response, not even an error */
+	if (opcode & ATT_OP_CMD_MASK)
+		return false;
+
+	server->aware_pending = true;
+
+	if (is_hash_read(server, opcode, pdu, length))
+		return true;
+
+	util_debug(server->debug_callback, server->debug_data,
+				"Client change-unaware, opcode 0x%02x rejected",
+				opcode);
+
+	bt_att_send_error_rsp(server->att, opcode, 0,
+						BT_ATT_ERROR_DB_OUT_OF_SYNC);
+
+	return false;
+}
+
+static void db_changed_cb(struct gatt_db_attribute *attrib, void *user_data)
+{
+	struct bt_gatt_server *server = user_data;
+
+	if (!(server->cli_feat & BT_GATT_CHRC_CLI_FEAT_ROBUST_CACHING))
+		return;
+
+	server->change_aware = false;
+	server->aware_pending = false;
+}
+
 static void attribute_read_cb(struct gatt_db_attribute *attrib, int err,
 					const uint8_t *value, size_t length,
 					void *user_data)
@@ -242,6 +365,9 @@ static void read_by_grp_type_cb(uint8_t opcode, const void *pdu,
 	uint16_t ehandle = 0;
 	struct queue *q = NULL;
 
+	if (!check_change_aware(server, opcode, pdu, length))
+		return;
+
 	if (length != 6 && length != 20) {
 		ecode = BT_ATT_ERROR_INVALID_PDU;
 		goto error;
@@ -451,6 +577,9 @@ static void read_by_type_cb(uint8_t opcode, const void *pdu,
 	struct queue *q = NULL;
 	struct async_read_op *op;
 
+	if (!check_change_aware(server, opcode, pdu, length))
+		return;
+
 	if (length != 6 && length != 20) {
 		ecode = BT_ATT_ERROR_INVALID_PDU;
 		goto error;
@@ -587,6 +716,9 @@ static void find_info_cb(uint8_t opcode, const void *pdu,
 	uint16_t ehandle = 0;
 	struct queue *q = NULL;
 
+	if (!check_change_aware(server, opcode, pdu, length))
+		return;
+
 	if (length != 4) {
 		ecode = BT_ATT_ERROR_INVALID_PDU;
 		goto error;
@@ -689,6 +821,9 @@ static void find_by_type_val_cb(uint8_t opcode, const void *pdu,
 	uint16_t ehandle = 0;
 	bt_uuid_t uuid;
 
+	if (!check_change_aware(server, opcode, pdu, length))
+		return;
+
 	if (length < 6) {
 		data.ecode = BT_ATT_ERROR_INVALID_PDU;
 		goto error;
@@ -773,6 +908,9 @@ static void write_cb(uint8_t opcode, const void *pdu,
 	struct async_write_op *op = NULL;
 	uint8_t ecode;
 
+	if (!check_change_aware(server, opcode, pdu, length))
+		return;
+
 	if (length < 2) {
 		ecode = BT_ATT_ERROR_INVALID_PDU;
 		goto error;
@@ -942,6 +1080,9 @@ static void read_cb(uint8_t opcode, const void *pdu,
 	struct bt_gatt_server *server = user_data;
 	uint16_t handle;
 
+	if (!check_change_aware(server, opcode, pdu, length))
+		return;
+
 	if (length != 2) {
 		bt_att_send_error_rsp(server->att, opcode, 0,
 						BT_ATT_ERROR_INVALID_PDU);
@@ -959,6 +1100,9 @@ static void read_blob_cb(uint8_t opcode, const void *pdu,
 	struct bt_gatt_server *server = user_data;
 	uint16_t handle, offset;
 
+	if (!check_change_aware(server, opcode, pdu, length))
+		return;
+
 	if (length != 4) {
 		bt_att_send_error_rsp(server->att, opcode, 0,
 						BT_ATT_ERROR_INVALID_PDU);
@@ -973,6 +1117,7 @@ static void read_blob_cb(uint8_t opcode, const void *pdu,
 
 struct read_multiple_resp_data {
 	struct bt_gatt_server *server;
+	uint8_t opcode;
 	uint16_t *handles;
 	size_t cur_handle;
 	size_t num_handles;
@@ -990,6 +1135,14 @@ static void read_multiple_resp_data_free(struct read_multiple_resp_data *data)
 	data->rsp_data = NULL;
 }
 
+static uint8_t get_read_multiple_rsp_opcode(uint8_t opcode)
+{
+	if (opcode == BT_ATT_OP_READ_MULT_VL_REQ)
+		return BT_ATT_OP_READ_MULT_VL_RSP;
+
+	return BT_ATT_OP_READ_MULT_RSP;
+}
+
 static void read_multiple_complete_cb(struct gatt_db_attribute *attr, int err,
 					const uint8_t *value, size_t len,
 					void *user_data)
@@ -1000,8 +1153,8 @@ static void read_multiple_complete_cb(struct gatt_db_attribute *attr, int err,
 	uint8_t ecode;
 
 	if (err != 0) {
-		bt_att_send_error_rsp(data->server->att,
-					BT_ATT_OP_READ_MULT_REQ, handle, err);
+		bt_att_send_error_rsp(data->server->att, data->opcode, handle,
+									err);
 		read_multiple_resp_data_free(data);
 		return;
 	}
@@ -1010,12 +1163,20 @@ static void read_multiple_complete_cb(struct gatt_db_attribute *attr, int err,
 						BT_ATT_PERM_READ_AUTHEN |
 						BT_ATT_PERM_READ_ENCRYPT);
 	if (ecode) {
-		bt_att_send_error_rsp(data->server->att,
-					BT_ATT_OP_READ_MULT_REQ, handle, ecode);
+		bt_att_send_error_rsp(data->server->att, data->opcode, handle,
+									ecode);
 		read_multiple_resp_data_free(data);
 		return;
 	}
 
+	/* Variable length values are sent as length/value tuples carrying the
+	 * full length, only the last value may be truncated.
+	 */
+	if (data->opcode == BT_ATT_OP_READ_MULT_VL_REQ) {
+		put_le16(len, data->rsp_data + data->length);
+		data->length += 2;
+	}
+
 	len = MIN(len, data->mtu - data->length - 1);
 
 	memcpy(data->rsp_data + data->length, value, len);
@@ -1024,8 +1185,11 @@ static void read_multiple_complete_cb(struct gatt_db_attribute *attr, int err,
 	data->cur_handle++;
 
 	if ((data->length >= data->mtu - 1) ||
-				(data->cur_handle == data->num_handles)) {
-		bt_att_send(data->server->att, BT_ATT_OP_READ_MULT_RSP,
+			(data->opcode == BT_ATT_OP_READ_MULT_VL_REQ &&
+				data->length + 2 > data->mtu - 1) ||
+			(data->cur_handle == data->num_handles)) {
+		bt_att_send(data->server->att, get_read_multiple_rsp_opcode(
+							data->opcode),
 				data->rsp_data, data->length, NULL, NULL, NULL);
 		read_multiple_resp_data_free(data);
 		return;
@@ -1040,19 +1204,17 @@ static void read_multiple_complete_cb(struct gatt_db_attribute *attr, int err,
 					data->handles[data->cur_handle]);
 
 	if (!next_attr) {
-		bt_att_send_error_rsp(data->server->att,
-					BT_ATT_OP_READ_MULT_REQ,
+		bt_att_send_error_rsp(data->server->att, data->opcode,
 					data->handles[data->cur_handle],
 					BT_ATT_ERROR_INVALID_HANDLE);
 		read_multiple_resp_data_free(data);
 		return;
 	}
 
-	if (!gatt_db_attribute_read(next_attr, 0, BT_ATT_OP_READ_MULT_REQ,
+	if (!gatt_db_attribute_read(next_attr, 0, data->opcode,
 					data->server->att,
 					read_multiple_complete_cb, data)) {
-		bt_att_send_error_rsp(data->server->att,
-						BT_ATT_OP_READ_MULT_REQ,
+		bt_att_send_error_rsp(data->server->att, data->opcode,
 						data->handles[data->cur_handle],
 						BT_ATT_ERROR_UNLIKELY);
 		read_multiple_resp_data_free(data);
@@ -1068,6 +1230,9 @@ static void read_multiple_cb(uint8_t opcode, const void *pdu,
 	uint8_t ecode = BT_ATT_ERROR_UNLIKELY;
 	size_t i = 0;
 
+	if (!check_change_aware(server, opcode, pdu, length))
+		return;
+
 	data.handles = NULL;
 	data.rsp_data = NULL;
 
@@ -1077,6 +1242,7 @@ static void read_multiple_cb(uint8_t opcode, const void *pdu,
 	}
 
 	data.server = server;
+	data.opcode = opcode;
 	data.num_handles = length / 2;
 	data.cur_handle = 0;
 	data.mtu = bt_att_get_mtu(server->att);
@@ -1124,6 +1290,9 @@ static void prep_write_cb(uint8_t opcode, const void *pdu,
 	struct gatt_db_attribute *attr;
 	uint8_t ecode;
 
+	if (!check_change_aware(server, opcode, pdu, length))
+		return;
+
 	if (length < 4) {
 		ecode = BT_ATT_ERROR_INVALID_PDU;
 		goto error;
@@ -1247,6 +1416,9 @@ static void exec_write_cb(uint8_t opcode, const void *pdu,
 	uint8_t ecode;
 	bool write;
 
+	if (!check_change_aware(server, opcode, pdu, length))
+		return;
+
 	if (length != 1) {
 		ecode = BT_ATT_ERROR_INVALID_PDU;
 		goto error;
@@ -1392,6 +1564,15 @@ static bool gatt_server_register_att_handlers(struct bt_gatt_server *server)
 	if (!server->read_multiple_id)
 		return false;
 
+	/* Read Multiple Variable Length Request */
+	server->read_multiple_vl_id = bt_att_register(server->att,
+						BT_ATT_OP_READ_MULT_VL_REQ,
+						read_multiple_cb,
+						server, NULL);
+
+	if (!server->read_multiple_vl_id)
+		return false;
+
 	/* Prepare Write Request */
 	server->prep_write_id = bt_att_register(server->att,
 						BT_ATT_OP_PREP_WRITE_REQ,
@@ -1437,6 +1618,18 @@ struct bt_gatt_server *bt_gatt_server_new(struct gatt_db *db,
 		return NULL;
 	}
 
+	server->change_aware = true;
+	server->db_id = gatt_db_register(db, db_changed_cb, db_changed_cb,
+								server, NULL);
+
+	if (!server_list)
+		server_list = queue_new();
+
+	if (!queue_push_tail(server_list, server)) {
+		bt_gatt_server_free(server);
+		return NULL;
+	}
+
 	return bt_gatt_server_ref(server);
 }
 
@@ -1479,6 +1672,147 @@ bool bt_gatt_server_set_debug(struct bt_gatt_server *server,
 	return true;
 }
 
+uint8_t bt_gatt_server_get_cli_feat(struct bt_gatt_server *server)
+{
+	if (!server)
+		return 0;
+
+	return server->cli_feat;
+}
+
+bool bt_gatt_server_is_change_aware(struct bt_gatt_server *server)
+{
+	if (!server)
+		return false;
+
+	return server->change_aware;
+}
+
+static void db_hash_read_cb(struct gatt_db_attribute *attrib,
+					unsigned int id, uint16_t offset,
+					uint8_t opcode, struct bt_att *att,
+					void *user_data)
+{
+	struct gatt_db *db = user_data;
+	uint8_t hash[16];
+
+	if (offset > sizeof(hash)) {
+		gatt_db_attribute_read_result(attrib, id,
+					BT_ATT_ERROR_INVALID_OFFSET, NULL, 0);
+		return;
+	}
+
+	if (!gatt_db_get_hash(db, hash)) {
+		gatt_db_attribute_read_result(attrib, id,
+					BT_ATT_ERROR_UNLIKELY, NULL, 0);
+		return;
+	}
+
+	gatt_db_attribute_read_result(attrib, id, 0, hash + offset,
+						sizeof(hash) - offset);
+}
+
+static void cli_feat_read_cb(struct gatt_db_attribute *attrib,
+					unsigned int id, uint16_t offset,
+					uint8_t opcode, struct bt_att *att,
+					void *user_data)
+{
+	struct bt_gatt_server *server = find_server(att);
+	uint8_t value;
+
+	if (!server) {
+		gatt_db_attribute_read_result(attrib, id,
+					BT_ATT_ERROR_UNLIKELY, NULL, 0);
+		return;
+	}
+
+	if (offset > sizeof(value)) {
+		gatt_db_attribute_read_result(attrib, id,
+					BT_ATT_ERROR_INVALID_OFFSET, NULL, 0);
+		return;
+	}
+
+	value = server->cli_feat;
+
+	gatt_db_attribute_read_result(attrib, id, 0, &value + offset,
+						sizeof(value) - offset);
+}
+
+static void cli_feat_write_cb(struct gatt_db_attribute *attrib,
+					unsigned int id, uint16_t offset,
+					const uint8_t *value, size_t len,
+					uint8_t opcode, struct bt_att *att,
+					void *user_data)
+{
+	struct bt_gatt_server *server = find_server(att);
+	uint8_t feat;
+
+	if (!server) {
+		gatt_db_attribute_write_result(attrib, id,
+						BT_ATT_ERROR_UNLIKELY);
+		return;
+	}
+
+	if (offset) {
+		gatt_db_attribute_write_result(attrib, id,
+					BT_ATT_ERROR_INVALID_OFFSET);
+		return;
+	}
+
+	if (!len) {
+		gatt_db_attribute_write_result(attrib, id,
+				BT_ATT_ERROR_INVALID_ATTRIBUTE_VALUE_LEN);
+		return;
+	}
+
+	/* A client may not clear a feature once it enabled it */
+	feat = value[0] & CLI_FEAT_SUPPORTED;
+	if (server->cli_feat & ~feat) {
+		gatt_db_attribute_write_result(attrib, id,
+					BT_ATT_ERROR_VALUE_NOT_ALLOWED);
+		return;
+	}
+
+	server->cli_feat = feat;
+
+	util_debug(server->debug_callback, server->debug_data,
+				"Client Supported Features: 0x%02x", feat);
+
+	gatt_db_attribute_write_result(attrib, id, 0);
+}
+
+struct gatt_db_attribute *bt_gatt_server_add_gatt_service(struct gatt_db *db)
+{
+	struct gatt_db_attribute *service;
+	bt_uuid_t uuid;
+
+	bt_uuid16_create(&uuid, GATT_SVC_UUID);
+	service = gatt_db_add_service(db, &uuid, true, GATT_SVC_NUM_HANDLES);
+	if (!service)
+		return NULL;
+
+	bt_uuid16_create(&uuid, GATT_CHARAC_CLI_FEAT);
+	if (!gatt_db_service_add_characteristic(service, &uuid,
+				BT_ATT_PERM_READ | BT_ATT_PERM_WRITE,
+				BT_GATT_CHRC_PROP_READ | BT_GATT_CHRC_PROP_WRITE,
+				cli_feat_read_cb, cli_feat_write_cb, NULL))
+		goto fail;
+
+	bt_uuid16_create(&uuid, GATT_CHARAC_DB_HASH);
+	if (!gatt_db_service_add_characteristic(service, &uuid,
+				BT_ATT_PERM_READ, BT_GATT_CHRC_PROP_READ,
+				db_hash_read_cb, NULL, db))
+		goto fail;
+
+	gatt_db_service_set_active(service, true);
+
+	return service;
+
+fail:
+	gatt_db_remove_service(db, service);
+	return NULL;
+}
+
 bool bt_gatt_server_send_notification(struct bt_gatt_server *server,
 					uint16_t handle, const uint8_t *value,
 					uint16_t length)
@@ -1505,6 +1839,88 @@ bool bt_gatt_server_send_notification(struct bt_gatt_server *server,
 	return result;
 }
 
+static bool flush_multiple_notifications(struct bt_gatt_server *server,
+						uint8_t *pdu, uint16_t len,
+						uint8_t tuples)
+{
+	/* A single tuple goes out as a regular notification */
+	if (tuples == 1) {
+		memmove(pdu + 2, pdu + 4, len - 4);
+		return !!bt_att_send(server->att, BT_ATT_OP_HANDLE_VAL_NOT,
+						pdu, len - 2, NULL, NULL, NULL);
+	}
+
+	return !!bt_att_send(server->att, BT_ATT_OP_HANDLE_NFY_MULT, pdu, len,
+							NULL, NULL, NULL);
+}
+
+bool bt_gatt_server_send_multiple_notifications(struct bt_gatt_server *server,
+					const uint16_t *handles,
+					const struct iovec *values,
+					uint8_t count)
+{
+	uint16_t mtu;
+	uint8_t *pdu;
+	uint16_t pdu_len = 0;
+	uint8_t tuples = 0;
+	bool result = true;
+	uint8_t i;
+
+	if (!server || (count && (!handles || !values)))
+		return false;
+
+	mtu = bt_att_get_mtu(server->att);
+
+	/* Only clients that enabled them get Multiple Handle Value PDUs */
+	if (!(server->cli_feat & BT_GATT_CHRC_CLI_FEAT_NFY_MULTI)) {
+		for (i = 0; i < count && result; i++)
+			result = bt_gatt_server_send_notification(server,
+					handles[i], values[i].iov_base,
+					MIN(values[i].iov_len, mtu - 3));
+
+		return result;
+	}
+
+	pdu = malloc(mtu - 1);
+	if (!pdu)
+		return false;
+
+	for (i = 0; i < count && result; i++) {
+		size_t len = values[i].iov_len;
+
+		/* Start a new PDU once the next tuple no longer fits */
+		if (tuples && pdu_len + 4 + len > (size_t) mtu - 1) {
+			result = flush_multiple_notifications(server, pdu,
+							pdu_len, tuples);
+			pdu_len = 0;
+			tuples = 0;
+		}
+
+		/* A value too long for any PDU is sent on its own, truncated */
+		if (len > (size_t) mtu - 5) {
+			result = result && bt_gatt_server_send_notification(
+						server, handles[i],
+						values[i].iov_base,
+						MIN(len, mtu - 3));
+			continue;
+		}
+
+		put_le16(handles[i], pdu + pdu_len);
+		put_le16(len, pdu + pdu_len + 2);
+		memcpy(pdu + pdu_len + 4, values[i].iov_base, len);
+		pdu_len += 4 + len;
+		tuples++;
+	}
+
+	if (result && tuples)
+		result = flush_multiple_notifications(server, pdu, pdu_len,
+									tuples);
+
+	free(pdu);
+
+	return result;
+}
+
 struct ind_data {
 	bt_gatt_server_conf_func_t callback;
 	bt_gatt_server_destroy_func_t destroy;
@@ -1573,3 +1989,423 @@ bool bt_gatt_server_send_indication(struct bt_gatt_server *server,
 
 	return result;
 }
+
+struct bt_gatt_server_group {
+	int ref_count;
+	unsigned int max_pending;
+	struct queue *members;
+	struct queue *chrcs;
+
+	bt_gatt_server_group_backpressure_func_t backpressure_callback;
+	bt_gatt_server_destroy_func_t backpressure_destroy;
+	void *backpressure_data;
+};
+
+struct group_member {
+	struct bt_gatt_server_group *group;
+	struct bt_gatt_server *server;
+	unsigned int disconn_id;
+	unsigned int sent;
+	unsigned int dropped;
+};
+
+struct group_chrc {
+	uint16_t value_handle;
+	struct queue *subs;
+};
+
+struct group_sub {
+	struct group_member *member;
+	uint16_t ccc;
+};
+
+static unsigned int group_chrc_key(const void *data)
+{
+	const struct group_chrc *chrc = data;
+
+	return chrc->value_handle;
+}
+
+static void group_chrc_free(void *data)
+{
+	struct group_chrc *chrc = data;
+
+	queue_destroy(chrc->subs, free);
+	free(chrc);
+}
+
+static bool match_member_server(const void *a, const void *b)
+{
+	const struct group_member *member = a;
+
+	return member->server == b;
+}
+
+static bool match_member_att(const void *a, const void *b)
+{
+	const struct group_member *member = a;
+
+	return member->server->att == b;
+}
+
+static bool match_sub_member(const void *a, const void *b)
+{
+	const struct group_sub *sub = a;
+
+	return sub->member == b;
+}
+
+static void group_chrc_drop_member(void *data, void *user_data)
+{
+	struct group_chrc *chrc = data;
+
+	queue_remove_all(chrc->subs, match_sub_member, user_data, free);
+}
+
+static void group_member_free(void *data)
+{
+	struct group_member *member = data;
+
+	if (member->disconn_id)
+		bt_att_unregister_disconnect(member->server->att,
+							member->disconn_id);
+
+	bt_gatt_server_unref(member->server);
+	free(member);
+}
+
+static void group_member_detach(struct bt_gatt_server_group *group,
+						struct group_member *member)
+{
+	queue_remove(group->members, member);
+	queue_foreach(group->chrcs, group_chrc_drop_member, member);
+	group_member_free(member);
+}
+
+struct bt_gatt_server_group *bt_gatt_server_group_new(unsigned int max_pending)
+{
+	struct bt_gatt_server_group *group;
+
+	group = new0(struct bt_gatt_server_group, 1);
+	if (!group)
+		return NULL;
+
+	group->members = queue_new();
+	group->chrcs = queue_new_keyed(group_chrc_key);
+	if (!group->members || !group->chrcs) {
+		queue_destroy(group->members, NULL);
+		queue_destroy(group->chrcs, NULL);
+		free(group);
+		return NULL;
+	}
+
+	group->max_pending = max_pending;
+
+	return bt_gatt_server_group_ref(group);
+}
+
+struct bt_gatt_server_group *bt_gatt_server_group_ref(
+					struct bt_gatt_server_group *group)
+{
+	if (!group)
+		return NULL;
+
+	__sync_fetch_and_add(&group->ref_count, 1);
+
+	return group;
+}
+
+void bt_gatt_server_group_unref(struct bt_gatt_server_group *group)
+{
+	if (!group)
+		return;
+
+	if (__sync_sub_and_fetch(&group->ref_count, 1))
+		return;
+
+	if (group->backpressure_destroy)
+		group->backpressure_destroy(group->backpressure_data);
+
+	queue_destroy(group->chrcs, group_chrc_free);
+	queue_destroy(group->members, group_member_free);
+	free(group);
+}
+
+static void group_disconnect_cb(int err, void *user_data)
+{
+	struct group_member *member = user_data;
+
+	/* bt_att drops the handler itself once disconnected */
+	member->disconn_id = 0;
+	group_member_detach(member->group, member);
+}
+
+bool bt_gatt_server_group_add(struct bt_gatt_server_group *group,
+					struct bt_gatt_server *server)
+{
+	struct group_member *member;
+
+	if (!group || !server)
+		return false;
+
+	if (queue_find(group->members, match_member_server, server))
+		return true;
+
+	member = new0(struct group_member, 1);
+	if (!member)
+		return false;
+
+	member->group = group;
+	member->server = bt_gatt_server_ref(server);
+	member->disconn_id = bt_att_register_disconnect(server->att,
+							group_disconnect_cb,
+							member, NULL);
+	if (!member->disconn_id || !queue_push_tail(group->members, member)) {
+		group_member_free(member);
+		return false;
+	}
+
+	return true;
+}
+
+bool bt_gatt_server_group_remove(struct bt_gatt_server_group *group,
+					struct bt_gatt_server *server)
+{
+	struct group_member *member;
+
+	if (!group || !server)
+		return false;
+
+	member = queue_find(group->members, match_member_server, server);
+	if (!member)
+		return false;
+
+	group_member_detach(group, member);
+
+	return true;
+}
+
+bool bt_gatt_server_group_set_ccc(struct bt_gatt_server_group *group,
+					struct bt_att *att,
+					uint16_t value_handle, uint16_t value)
+{
+	struct group_member *member;
+	struct group_chrc *chrc;
+	struct group_sub *sub;
+
+	if (!group || !att || !value_handle)
+		return false;
+
+	member = queue_find(group->members, match_member_att, att);
+	if (!member)
+		return false;
+
+	chrc = queue_find_by_key(group->chrcs, value_handle);
+	if (!chrc) {
+		if (!value)
+			return true;
+
+		chrc = new0(struct group_chrc, 1);
+		if (!chrc)
+			return false;
+
+		chrc->value_handle = value_handle;
+		chrc->subs = queue_new();
+		if (!chrc->subs || !queue_push_tail(group->chrcs, chrc)) {
+			group_chrc_free(chrc);
+			return false;
+		}
+	}
+
+	sub = queue_find(chrc->subs, match_sub_member, member);
+	if (!value) {
+		if (sub) {
+			queue_remove(chrc->subs, sub);
+			free(sub);
+		}
+
+		return true;
+	}
+
+	if (!sub) {
+		sub = new0(struct group_sub, 1);
+		if (!sub)
+			return false;
+
+		sub->member = member;
+		if (!queue_push_tail(chrc->subs, sub)) {
+			free(sub);
+			return false;
+		}
+	}
+
+	sub->ccc = value;
+
+	return true;
+}
+
+uint16_t bt_gatt_server_group_get_ccc(struct bt_gatt_server_group *group,
+					struct bt_att *att,
+					uint16_t value_handle)
+{
+	struct group_member *member;
+	struct group_chrc *chrc;
+	struct group_sub *sub;
+
+	if (!group || !att)
+		return 0;
+
+	chrc = queue_find_by_key(group->chrcs, value_handle);
+	if (!chrc)
+		return 0;
+
+	member = queue_find(group->members, match_member_att, att);
+	if (!member)
+		return 0;
+
+	sub = queue_find(chrc->subs, match_sub_member, member);
+
+	return sub ? sub->ccc : 0;
+}
+
+bool bt_gatt_server_group_set_backpressure_handler(
+			struct bt_gatt_server_group *group,
+			bt_gatt_server_group_backpressure_func_t callback,
+			void *user_data,
+			bt_gatt_server_destroy_func_t destroy)
+{
+	if (!group)
+		return false;
+
+	if (group->backpressure_destroy)
+		group->backpressure_destroy(group->backpressure_data);
+
+	group->backpressure_callback = callback;
+	group->backpressure_destroy = destroy;
+	group->backpressure_data = user_data;
+
+	return true;
+}
+
+static struct bt_att_buf *group_buf(struct bt_att_buf **buf, uint8_t opcode,
+					uint16_t handle, const uint8_t *value,
+					uint16_t length)
+{
+	uint8_t hdr[2];
+	struct iovec iov[2];
+
+	if (*buf)
+		return *buf;
+
+	put_le16(handle, hdr);
+	iov[0].iov_base = hdr;
+	iov[0].iov_len = sizeof(hdr);
+	iov[1].iov_base = (void *) value;
+	iov[1].iov_len = length;
+
+	*buf = bt_att_buf_new(opcode, iov, 2);
+
+	return *buf;
+}
+
+static void group_conf_cb(uint8_t opcode, const void *pdu, uint16_t length,
+							void *user_data)
+{
+}
+
+unsigned int bt_gatt_server_group_notify(struct bt_gatt_server_group *group,
+					uint16_t handle, const uint8_t *value,
+					uint16_t length)
+{
+	const struct queue_entry *entry;
+	struct bt_att_buf *not_buf = NULL;
+	struct bt_att_buf *ind_buf = NULL;
+	struct group_chrc *chrc;
+	unsigned int count = 0;
+
+	if (!group || (length && !value))
+		return 0;
+
+	chrc = queue_find_by_key(group->chrcs, handle);
+	if (!chrc)
+		return 0;
+
+	/*
+	 * Every subscriber shares the same PDU, bt_att only truncates its
+	 * length to the bearer MTU.
+	 */
+	for (entry = queue_get_entries(chrc->subs); entry;
+							entry = entry->next) {
+		struct group_sub *sub = entry->data;
+		struct group_member *member = sub->member;
+		struct bt_att *att = member->server->att;
+		struct bt_att_buf *buf;
+		bt_att_response_func_t callback = NULL;
+		unsigned int pending;
+
+		if (sub->ccc & 0x0001)
+			buf = group_buf(&not_buf, BT_ATT_OP_HANDLE_VAL_NOT,
+						handle, value, length);
+		else if (sub->ccc & 0x0002) {
+			/* bt_att wants a callback for anything awaiting a PDU */
+			buf = group_buf(&ind_buf, BT_ATT_OP_HANDLE_VAL_IND,
+						handle, value, length);
+			callback = group_conf_cb;
+		} else
+			continue;
+
+		if (!buf)
+			break;
+
+		pending = bt_att_get_pending_writes(att);
+		if (group->max_pending && pending >= group->max_pending) {
+			member->dropped++;
+
+			if (group->backpressure_callback)
+				group->backpressure_callback(member->server,
+						pending,
+						group->backpressure_data);
+			continue;
+		}
+
+		if (!bt_att_send_buf(att, buf, callback, NULL, NULL)) {
+			member->dropped++;
+			continue;
+		}
+
+		member->sent++;
+		count++;
+	}
+
+	bt_att_buf_unref(not_buf);
+	bt_att_buf_unref(ind_buf);
+
+	return count;
+}
+
+bool bt_gatt_server_group_get_stats(struct bt_gatt_server_group *group,
+					struct bt_gatt_server *server,
+					unsigned int *pending,
+					unsigned int *sent,
+					unsigned int *dropped)
+{
+	struct group_member *member;
+
+	if (!group || !server)
+		return false;
+
+	member = queue_find(group->members, match_member_server, server);
+	if (!member)
+		return false;
+
+	if (pending)
+		*pending = bt_att_get_pending_writes(server->att);
+
+	if (sent)
+		*sent = member->sent;
+
+	if (dropped)
+		*dropped = member->dropped;
+
+	return true;
+}
@@ -22,6 +22,7 @@
  */
 
 #include <stdint.h>
+#include <sys/uio.h>
 
 struct bt_gatt_server;
 
@@ -40,13 +41,82 @@ bool bt_gatt_server_set_debug(struct bt_gatt_server *server,
 					void *user_data,
 					bt_gatt_server_destroy_func_t destroy);
 
+/*
+ * Adds the GATT Service with the Client Supported Features and Database Hash
+ * characteristics, enabling robust caching for the servers sharing db.
+ */
+struct gatt_db_attribute *bt_gatt_server_add_gatt_service(struct gatt_db *db);
+
+uint8_t bt_gatt_server_get_cli_feat(struct bt_gatt_server *server);
+bool bt_gatt_server_is_change_aware(struct bt_gatt_server *server);
+
 bool bt_gatt_server_send_notification(struct bt_gatt_server *server,
 					uint16_t handle, const uint8_t *value,
 					uint16_t length);
 
+/*
+ * Packs the values into Multiple Handle Value Notifications if the client
+ * enabled them in its Client Supported Features, otherwise sends one Handle
+ * Value Notification per value.
+ */
+bool bt_gatt_server_send_multiple_notifications(struct bt_gatt_server *server,
+					const uint16_t *handles,
+					const struct iovec *values,
+					uint8_t count);
+
 bool bt_gatt_server_send_indication(struct bt_gatt_server *server,
 					uint16_t handle, const uint8_t *value,
 					uint16_t length,
 					bt_gatt_server_conf_func_t callback,
 					void *user_data,
 					bt_gatt_server_destroy_func_t destroy);
+
+/*
+ * A group tracks CCC state for many servers sharing a database and sends one
+ * value to every subscriber with a single shared PDU. Members are dropped
+ * automatically when their bearer disconnects.
+ */
+struct bt_gatt_server_group;
+
+typedef void (*bt_gatt_server_group_backpressure_func_t)(
+					struct bt_gatt_server *server,
+					unsigned int pending,
+					void *user_data);
+
+struct bt_gatt_server_group *bt_gatt_server_group_new(unsigned int max_pending);
+
+struct bt_gatt_server_group *bt_gatt_server_group_ref(
+					struct bt_gatt_server_group *group);
+void bt_gatt_server_group_unref(struct bt_gatt_server_group *group);
+
+bool bt_gatt_server_group_add(struct bt_gatt_server_group *group,
+					struct bt_gatt_server *server);
+bool bt_gatt_server_group_remove(struct bt_gatt_server_group *group,
+					struct bt_gatt_server *server);
+
+bool bt_gatt_server_group_set_ccc(struct bt_gatt_server_group *group,
+					struct bt_att *att,
+					uint16_t value_handle, uint16_t value);
+uint16_t bt_gatt_server_group_get_ccc(struct bt_gatt_server_group *group,
+					struct bt_att *att,
+					uint16_t value_handle);
+
+/*
+ * Called instead of queueing when a member already has max_pending PDUs
+ * waiting to be written. The group must not be modified from the callback.
+ */
+bool bt_gatt_server_group_set_backpressure_handler(
+			struct bt_gatt_server_group *group,
+			bt_gatt_server_group_backpressure_func_t callback,
+			void *user_data,
+			bt_gatt_server_destroy_func_t destroy);
+
+unsigned int bt_gatt_server_group_notify(struct bt_gatt_server_group *group,
+					uint16_t handle, const uint8_t *value,
+					uint16_t length);
+
+bool bt_gatt_server_group_get_stats(struct bt_gatt_server_group *group,
+					struct bt_gatt_server *server,
+					unsigned int *pending,
+					unsigned int *sent,
+					unsigned int *dropped);
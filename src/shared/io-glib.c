@@ -280,6 +280,26 @@ ssize_t io_send(struct io *io, const struct iovec *iov, int iovcnt)
 	return ret;
 }
 
+int io_send_batch(struct io *io, const struct iovec *iov, int count)
+{
+	int i;
+
+	if (!io || !io->channel)
+		return -ENOTCONN;
+
+	if (count <= 0)
+		return -EINVAL;
+
+	for (i = 0; i < count; i++) {
+		ssize_t ret = io_send(io, &iov[i], 1);
+
+		if (ret < 0)
+			return i ? i : ret;
+	}
+
+	return count;
+}
+
 bool io_shutdown(struct io *io)
 {
 	if (!io || !io->channel)
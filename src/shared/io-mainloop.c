@@ -27,6 +27,7 @@
 
 #include <unistd.h>
 #include <errno.h>
+#include <string.h>
 #include <sys/socket.h>
 
 #include "src/shared/mainloop.h"
@@ -318,6 +319,45 @@ ssize_t io_send(struct io *io, const struct iovec *iov, int iovcnt)
 	return ret;
 }
 
+int io_send_batch(struct io *io, const struct iovec *iov, int count)
+{
+	struct mmsghdr *msgs;
+	int i, ret;
+
+	if (!io || io->fd < 0)
+		return -ENOTCONN;
+
+	if (count <= 0)
+		return -EINVAL;
+
+	msgs = newa(struct mmsghdr, count);
+	memset(msgs, 0, sizeof(*msgs) * count);
+
+	for (i = 0; i < count; i++) {
+		msgs[i].msg_hdr.msg_iov = (struct iovec *) &iov[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	do {
+		ret = sendmmsg(io->fd, msgs, count, MSG_DONTWAIT);
+	} while (ret < 0 && errno == EINTR);
+
+	if (ret >= 0)
+		return ret;
+
+	if (errno != ENOTSOCK)
+		return -errno;
+
+	/* Not a socket, fall back to one write per message */
+	for (i = 0; i < count; i++) {
+		ret = io_send(io, &iov[i], 1);
+		if (ret < 0)
+			return i ? i : ret;
+	}
+
+	return count;
+}
+
 bool io_shutdown(struct io *io)
 {
 	if (!io || io->fd < 0)
@@ -37,6 +37,8 @@
 #include <sys/epoll.h>
 #include <pthread.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
 
 #include "mainloop.h"
 
@@ -56,8 +58,19 @@ struct mainloop_data {
 	struct mainloop_data* previous;
 };
 
+struct timeout_list {
+	struct timeout_list *next;
+	struct timeout_list *prev;
+};
+
 struct timeout_data {
-	int fd;
+	struct timeout_list link;
+	int id;
+	int level;
+	unsigned int slot;
+	uint64_t expires;
+	bool running;
+	bool removed;
 	mainloop_timeout_func callback;
 	mainloop_destroy_func destroy;
 	void *user_data;
@@ -73,6 +86,25 @@ struct signal_data {
 
 static struct signal_data *signal_data;
 
+#define TIMER_WHEEL_BITS	6
+#define TIMER_WHEEL_SIZE	(1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK	(TIMER_WHEEL_SIZE - 1)
+#define TIMER_WHEEL_LEVELS	4
+#define TIMER_WHEEL_RANGE	(1ULL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS))
+
+#define TIMEOUT_TABLE_MIN	16
+
+static pthread_mutex_t timeout_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int wheel_fd = -1;
+static uint64_t wheel_now;
+static uint64_t wheel_armed;
+static uint64_t wheel_occupied[TIMER_WHEEL_LEVELS];
+static struct timeout_list wheel_slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SIZE];
+static struct timeout_data **timeout_table;
+static unsigned int *timeout_free_ids;
+static unsigned int timeout_table_size;
+static unsigned int timeout_free_count;
+
 /* I don't have the initial insight into the original implementation. However, it
  * seemed limited before. Before these changes to make it a linked list, it was
  * just an array with the file descriptor as the index, but since the file
@@ -337,107 +369,492 @@ int mainloop_remove_fd(int fd)
 	return err;
 }
 
-static void timeout_destroy(void *user_data)
+/* Timeouts are kept on a hierarchical timer wheel driven by a single timerfd
+ * instead of one timerfd (and epoll registration) per timeout. The wheel
+ * has TIMER_WHEEL_LEVELS levels of TIMER_WHEEL_SIZE slots each, with a tick
+ * of one millisecond at the lowest level. A timeout is placed on the lowest
+ * level whose range covers its expiry, and is moved ("cascaded") to a lower
+ * level when the wheel reaches the slot it sits in. Adding and removing a
+ * timeout is O(1) and, unless the new timeout expires before the one the
+ * timerfd is currently armed for, does not require any syscall.
+ *
+ * Timeout ids index a table of pending timeouts and are reused the same way
+ * file descriptors used to be. The wheel may be modified from any thread;
+ * callbacks are always invoked from the mainloop thread without holding the
+ * wheel lock, so they are free to add, modify or remove timeouts. */
+static void timeout_wheel_callback(int fd, uint32_t events, void *user_data);
+static void timeout_wheel_destroy(void *user_data);
+
+static inline uint64_t timeout_clock(void)
 {
-	struct timeout_data *data = user_data;
+	struct timespec ts;
 
-	close(data->fd);
-	data->fd = -1;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
 
-	if (data->destroy)
-		data->destroy(data->user_data);
+	return (uint64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
 
-	free(data);
+static struct timeout_data *timeout_lookup(int id)
+{
+	if (id <= 0 || (unsigned int) id > timeout_table_size)
+		return NULL;
+
+	return timeout_table[id - 1];
 }
 
-static void timeout_callback(int fd, uint32_t events, void *user_data)
+static int timeout_alloc_id(struct timeout_data *data)
 {
-	struct timeout_data *data = user_data;
-	uint64_t expired;
-	ssize_t result;
+	unsigned int index;
 
-	if (events & (EPOLLERR | EPOLLHUP))
+	if (!timeout_free_count) {
+		unsigned int size = timeout_table_size ? timeout_table_size * 2 :
+								TIMEOUT_TABLE_MIN;
+		struct timeout_data **table;
+		unsigned int *free_ids;
+		unsigned int i;
+
+		table = realloc(timeout_table, size * sizeof(*table));
+		if (!table)
+			return -ENOMEM;
+
+		timeout_table = table;
+
+		free_ids = realloc(timeout_free_ids, size * sizeof(*free_ids));
+		if (!free_ids)
+			return -ENOMEM;
+
+		timeout_free_ids = free_ids;
+
+		/* Push in reverse so that the lowest ids are handed out first */
+		for (i = size; i > timeout_table_size; i--) {
+			timeout_table[i - 1] = NULL;
+			timeout_free_ids[timeout_free_count++] = i - 1;
+		}
+
+		timeout_table_size = size;
+	}
+
+	index = timeout_free_ids[--timeout_free_count];
+	timeout_table[index] = data;
+	data->id = index + 1;
+
+	return data->id;
+}
+
+static void timeout_release_id(struct timeout_data *data)
+{
+	timeout_table[data->id - 1] = NULL;
+	timeout_free_ids[timeout_free_count++] = data->id - 1;
+}
+
+static inline void timeout_list_init(struct timeout_list *list)
+{
+	list->next = list;
+	list->prev = list;
+}
+
+static inline bool timeout_list_empty(struct timeout_list *list)
+{
+	return list->next == list;
+}
+
+static inline void timeout_list_append(struct timeout_list *list,
+						struct timeout_list *entry)
+{
+	entry->next = list;
+	entry->prev = list->prev;
+	list->prev->next = entry;
+	list->prev = entry;
+}
+
+static inline void timeout_list_splice(struct timeout_list *from,
+						struct timeout_list *to)
+{
+	timeout_list_init(to);
+
+	if (timeout_list_empty(from))
 		return;
 
-	result = read(data->fd, &expired, sizeof(expired));
-	if (result != sizeof(expired))
+	to->next = from->next;
+	to->prev = from->prev;
+	to->next->prev = to;
+	to->prev->next = to;
+
+	timeout_list_init(from);
+}
+
+static void timeout_unlink(struct timeout_data *data)
+{
+	if (!data->link.next)
 		return;
 
-	if (data->callback)
-		data->callback(data->fd, data->user_data);
+	data->link.prev->next = data->link.next;
+	data->link.next->prev = data->link.prev;
+	data->link.next = NULL;
+	data->link.prev = NULL;
+
+	if (data->level >= 0 &&
+			timeout_list_empty(&wheel_slots[data->level][data->slot]))
+		wheel_occupied[data->level] &= ~(1ULL << data->slot);
+
+	data->level = -1;
+}
+
+static void timeout_link(struct timeout_data *data)
+{
+	uint64_t expires = data->expires;
+	uint64_t delta;
+	int level = 0;
+
+	if (expires < wheel_now)
+		expires = wheel_now;
+
+	delta = expires - wheel_now;
+
+	/* Timeouts beyond the range of the wheel are parked in the last slot
+	 * of the top level and placed again once that slot is cascaded. */
+	if (delta >= TIMER_WHEEL_RANGE)
+		expires = wheel_now + TIMER_WHEEL_RANGE - 1;
+
+	while (level < TIMER_WHEEL_LEVELS - 1 &&
+			delta >= 1ULL << ((level + 1) * TIMER_WHEEL_BITS))
+		level++;
+
+	data->level = level;
+	data->slot = (expires >> (level * TIMER_WHEEL_BITS)) & TIMER_WHEEL_MASK;
+
+	timeout_list_append(&wheel_slots[level][data->slot], &data->link);
+	wheel_occupied[level] |= 1ULL << data->slot;
+}
+
+static bool timeout_wheel_idle(void)
+{
+	int level;
+
+	for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+		if (wheel_occupied[level])
+			return false;
+	}
+
+	return true;
+}
+
+/* Returns the next tick at which the wheel has work to do, either firing a
+ * timeout on the lowest level or cascading a slot of a higher level. */
+static uint64_t timeout_wheel_next(void)
+{
+	uint64_t next = UINT64_MAX;
+	int level;
+
+	for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+		unsigned int shift = level * TIMER_WHEEL_BITS;
+		uint64_t base = wheel_now >> shift;
+		uint64_t mask = wheel_occupied[level];
+		unsigned int rot;
+		uint64_t tick;
+
+		if (!mask)
+			continue;
+
+		/* Rotate so that bit 0 is the slot following the current one */
+		rot = (base + 1) & TIMER_WHEEL_MASK;
+		if (rot)
+			mask = (mask >> rot) | (mask << (TIMER_WHEEL_SIZE - rot));
+
+		tick = (base + __builtin_ctzll(mask) + 1) << shift;
+		if (tick < next)
+			next = tick;
+	}
+
+	return next;
 }
 
-static inline int timeout_set(int fd, unsigned int msec)
+static void timeout_wheel_cascade(uint64_t tick)
+{
+	int level;
+
+	for (level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+		unsigned int shift = level * TIMER_WHEEL_BITS;
+		unsigned int slot = (tick >> shift) & TIMER_WHEEL_MASK;
+		struct timeout_list list;
+
+		if (tick & ((1ULL << shift) - 1))
+			break;
+
+		timeout_list_splice(&wheel_slots[level][slot], &list);
+		wheel_occupied[level] &= ~(1ULL << slot);
+
+		while (!timeout_list_empty(&list)) {
+			struct timeout_data *data = (void *) list.next;
+
+			list.next = data->link.next;
+			list.next->prev = &list;
+			timeout_link(data);
+		}
+	}
+}
+
+static void timeout_wheel_arm(void)
 {
 	struct itimerspec itimer;
-	unsigned int sec = msec / 1000;
+	uint64_t next;
+
+	next = timeout_wheel_next();
+	if (next == UINT64_MAX || next >= wheel_armed)
+		return;
 
 	memset(&itimer, 0, sizeof(itimer));
-	itimer.it_interval.tv_sec = 0;
-	itimer.it_interval.tv_nsec = 0;
-	itimer.it_value.tv_sec = sec;
-	itimer.it_value.tv_nsec = (msec - (sec * 1000)) * 1000;
+	itimer.it_value.tv_sec = next / 1000;
+	itimer.it_value.tv_nsec = (next % 1000) * 1000000;
+
+	if (timerfd_settime(wheel_fd, TFD_TIMER_ABSTIME, &itimer, NULL) < 0)
+		return;
+
+	wheel_armed = next;
+}
+
+static int timeout_wheel_setup(void)
+{
+	unsigned int level, slot;
+	int fd;
+
+	pthread_mutex_lock(&timeout_mutex);
 
-	return timerfd_settime(fd, 0, &itimer, NULL);
+	if (wheel_fd >= 0) {
+		pthread_mutex_unlock(&timeout_mutex);
+		return 0;
+	}
+
+	fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	if (fd < 0) {
+		pthread_mutex_unlock(&timeout_mutex);
+		return -EIO;
+	}
+
+	for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+		for (slot = 0; slot < TIMER_WHEEL_SIZE; slot++)
+			timeout_list_init(&wheel_slots[level][slot]);
+
+		wheel_occupied[level] = 0;
+	}
+
+	wheel_now = timeout_clock();
+	wheel_armed = UINT64_MAX;
+	wheel_fd = fd;
+
+	pthread_mutex_unlock(&timeout_mutex);
+
+	if (mainloop_add_fd(fd, EPOLLIN, timeout_wheel_callback, NULL,
+						timeout_wheel_destroy) < 0) {
+		pthread_mutex_lock(&timeout_mutex);
+		wheel_fd = -1;
+		pthread_mutex_unlock(&timeout_mutex);
+		close(fd);
+		return -EIO;
+	}
+
+	return 0;
+}
+
+static void timeout_wheel_destroy(void *user_data)
+{
+	struct timeout_list list;
+	unsigned int i;
+
+	timeout_list_init(&list);
+
+	pthread_mutex_lock(&timeout_mutex);
+
+	for (i = 0; i < timeout_table_size; i++) {
+		struct timeout_data *data = timeout_table[i];
+
+		if (!data)
+			continue;
+
+		timeout_unlink(data);
+		timeout_release_id(data);
+		timeout_list_append(&list, &data->link);
+	}
+
+	close(wheel_fd);
+	wheel_fd = -1;
+
+	pthread_mutex_unlock(&timeout_mutex);
+
+	while (!timeout_list_empty(&list)) {
+		struct timeout_data *data = (void *) list.next;
+
+		list.next = data->link.next;
+		list.next->prev = &list;
+
+		if (data->destroy)
+			data->destroy(data->user_data);
+
+		free(data);
+	}
+}
+
+static void timeout_wheel_callback(int fd, uint32_t events, void *user_data)
+{
+	uint64_t expired, target, tick;
+
+	if (events & (EPOLLERR | EPOLLHUP))
+		return;
+
+	if (read(fd, &expired, sizeof(expired)) < 0 && errno != EAGAIN)
+		return;
+
+	pthread_mutex_lock(&timeout_mutex);
+
+	wheel_armed = UINT64_MAX;
+	target = timeout_clock();
+
+	while ((tick = timeout_wheel_next()) <= target) {
+		unsigned int slot = tick & TIMER_WHEEL_MASK;
+		struct timeout_list list;
+
+		wheel_now = tick;
+		timeout_wheel_cascade(tick);
+
+		timeout_list_splice(&wheel_slots[0][slot], &list);
+		wheel_occupied[0] &= ~(1ULL << slot);
+
+		/* Entries are popped one at a time under the lock since a
+		 * callback may remove any other expired timeout. */
+		while (!timeout_list_empty(&list)) {
+			struct timeout_data *data = (void *) list.next;
+
+			list.next = data->link.next;
+			list.next->prev = &list;
+			data->link.next = NULL;
+			data->link.prev = NULL;
+			data->level = -1;
+			data->running = true;
+
+			pthread_mutex_unlock(&timeout_mutex);
+
+			data->callback(data->id, data->user_data);
+
+			pthread_mutex_lock(&timeout_mutex);
+
+			data->running = false;
+			if (data->removed)
+				free(data);
+		}
+	}
+
+	if (wheel_now < target)
+		wheel_now = target;
+
+	timeout_wheel_arm();
+
+	pthread_mutex_unlock(&timeout_mutex);
 }
 
 int mainloop_add_timeout(unsigned int msec, mainloop_timeout_func callback,
 				void *user_data, mainloop_destroy_func destroy)
 {
 	struct timeout_data *data;
+	int id;
 
 	if (!callback)
 		return -EINVAL;
 
+	if (timeout_wheel_setup() < 0)
+		return -EIO;
+
 	data = malloc(sizeof(*data));
 	if (!data)
 		return -ENOMEM;
 
 	memset(data, 0, sizeof(*data));
+	data->level = -1;
 	data->callback = callback;
 	data->destroy = destroy;
 	data->user_data = user_data;
 
-	data->fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
-	if (data->fd < 0) {
+	pthread_mutex_lock(&timeout_mutex);
+
+	id = timeout_alloc_id(data);
+	if (id < 0) {
+		pthread_mutex_unlock(&timeout_mutex);
 		free(data);
-		return -EIO;
+		return id;
 	}
 
 	if (msec > 0) {
-		if (timeout_set(data->fd, msec) < 0) {
-			close(data->fd);
-			free(data);
-			return -EIO;
-		}
-	}
+		if (timeout_wheel_idle())
+			wheel_now = timeout_clock();
 
-	if (mainloop_add_fd(data->fd, EPOLLIN | EPOLLONESHOT,
-				timeout_callback, data, timeout_destroy) < 0) {
-		close(data->fd);
-		free(data);
-		return -EIO;
+		data->expires = timeout_clock() + msec;
+		timeout_link(data);
+		timeout_wheel_arm();
 	}
 
-	return data->fd;
+	pthread_mutex_unlock(&timeout_mutex);
+
+	return id;
 }
 
 int mainloop_modify_timeout(int id, unsigned int msec)
 {
+	struct timeout_data *data;
+
+	pthread_mutex_lock(&timeout_mutex);
+
+	data = timeout_lookup(id);
+	if (!data) {
+		pthread_mutex_unlock(&timeout_mutex);
+		return -EIO;
+	}
+
 	if (msec > 0) {
-		if (timeout_set(id, msec) < 0)
-			return -EIO;
+		timeout_unlink(data);
+		data->expires = timeout_clock() + msec;
+		timeout_link(data);
+		timeout_wheel_arm();
 	}
 
-	if (mainloop_modify_fd(id, EPOLLIN | EPOLLONESHOT) < 0)
-		return -EIO;
+	pthread_mutex_unlock(&timeout_mutex);
 
 	return 0;
 }
 
 int mainloop_remove_timeout(int id)
 {
-	return mainloop_remove_fd(id);
+	struct timeout_data *data;
+	mainloop_destroy_func destroy;
+	void *user_data;
+	bool running;
+
+	pthread_mutex_lock(&timeout_mutex);
+
+	data = timeout_lookup(id);
+	if (!data) {
+		pthread_mutex_unlock(&timeout_mutex);
+		return -ENXIO;
+	}
+
+	timeout_unlink(data);
+	timeout_release_id(data);
+
+	destroy = data->destroy;
+	user_data = data->user_data;
+
+	/* A timeout removed from within its own callback is freed by the
+	 * dispatcher once the callback returns. */
+	running = data->running;
+	data->removed = true;
+
+	pthread_mutex_unlock(&timeout_mutex);
+
+	if (destroy)
+		destroy(user_data);
+
+	if (!running)
+		free(data);
+
+	return 0;
 }
 
 int mainloop_set_signal(sigset_t *mask, mainloop_signal_func callback,
@@ -115,12 +115,11 @@ static void destroy_notify(void *data)
 	free(notify);
 }
 
-static bool match_notify_id(const void *a, const void *b)
+static unsigned int notify_key(const void *data)
 {
-	const struct mgmt_notify *notify = a;
-	unsigned int id = PTR_TO_UINT(b);
+	const struct mgmt_notify *notify = data;
 
-	return notify->id == id;
+	return notify->id;
 }
 
 static bool match_notify_index(const void *a, const void *b)
@@ -373,7 +372,7 @@ struct mgmt *mgmt_new(int fd)
 		return NULL;
 	}
 
-	mgmt->request_queue = queue_new();
+	mgmt->request_queue = queue_new_ring(0);
 	if (!mgmt->request_queue) {
 		io_destroy(mgmt->io);
 		free(mgmt->buf);
@@ -381,7 +380,7 @@ struct mgmt *mgmt_new(int fd)
 		return NULL;
 	}
 
-	mgmt->reply_queue = queue_new();
+	mgmt->reply_queue = queue_new_ring(0);
 	if (!mgmt->reply_queue) {
 		queue_destroy(mgmt->request_queue, NULL);
 		io_destroy(mgmt->io);
@@ -400,7 +399,7 @@ struct mgmt *mgmt_new(int fd)
 		return NULL;
 	}
 
-	mgmt->notify_list = queue_new();
+	mgmt->notify_list = queue_new_keyed(notify_key);
 	if (!mgmt->notify_list) {
 		queue_destroy(mgmt->pending_list, NULL);
 		queue_destroy(mgmt->reply_queue, NULL);
@@ -762,8 +761,7 @@ bool mgmt_unregister(struct mgmt *mgmt, unsigned int id)
 	if (!mgmt || !id)
 		return false;
 
-	notify = queue_remove_if(mgmt->notify_list, match_notify_id,
-							UINT_TO_PTR(id));
+	notify = queue_remove_by_key(mgmt->notify_list, id);
 	if (!notify)
 		return false;
 
@@ -28,6 +28,9 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "src/shared/util.h"
 #include "src/shared/pcap.h"
@@ -64,8 +67,66 @@ struct pcap {
 	int fd;
 	uint32_t type;
 	uint32_t snaplen;
+	const uint8_t *map;
+	size_t map_size;
+	size_t map_offset;
+	uint8_t *buf;
 };
 
+static void map_file(struct pcap *pcap, size_t offset)
+{
+	struct stat st;
+	void *map;
+
+	if (fstat(pcap->fd, &st) < 0 || !S_ISREG(st.st_mode))
+		return;
+
+	if (st.st_size <= 0 || (uint64_t) st.st_size > SIZE_MAX)
+		return;
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, pcap->fd, 0);
+	if (map == MAP_FAILED)
+		return;
+
+	madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+	pcap->map = map;
+	pcap->map_size = st.st_size;
+	pcap->map_offset = offset;
+}
+
+static const void *map_pull(struct pcap *pcap, size_t len)
+{
+	const uint8_t *ptr;
+
+	if (pcap->map_size - pcap->map_offset < len)
+		return NULL;
+
+	ptr = pcap->map + pcap->map_offset;
+	pcap->map_offset += len;
+
+	return ptr;
+}
+
+/* Returns the next record of the mapped file including its full payload */
+static const struct pcap_pkt *map_pkt(struct pcap *pcap, const uint8_t **data)
+{
+	const struct pcap_pkt *pkt;
+	size_t offset = pcap->map_offset;
+
+	pkt = map_pull(pcap, PCAP_PKT_SIZE);
+	if (!pkt)
+		return NULL;
+
+	*data = map_pull(pcap, pkt->incl_len);
+	if (!*data) {
+		pcap->map_offset = offset;
+		return NULL;
+	}
+
+	return pkt;
+}
+
 struct pcap *pcap_open(const char *path)
 {
 	struct pcap *pcap;
@@ -95,6 +156,9 @@ struct pcap *pcap_open(const char *path)
 	pcap->snaplen = hdr.snaplen;
 	pcap->type = hdr.network;
 
+	/* Regular files are read through a mapping of their size at open */
+	map_file(pcap, PCAP_HDR_SIZE);
+
 	return pcap_ref(pcap);
 
 failed:
@@ -122,9 +186,13 @@ void pcap_unref(struct pcap *pcap)
 	if (__sync_sub_and_fetch(&pcap->ref_count, 1))
 		return;
 
+	if (pcap->map)
+		munmap((void *) pcap->map, pcap->map_size);
+
 	if (pcap->fd >= 0)
 		close(pcap->fd);
 
+	free(pcap->buf);
 	free(pcap);
 }
 
@@ -154,6 +222,23 @@ bool pcap_read(struct pcap *pcap, struct timeval *tv,
 	if (!pcap)
 		return false;
 
+	if (pcap->map) {
+		const void *ptr;
+
+		if (!pcap_next(pcap, tv, &ptr, &toread))
+			return false;
+
+		if (toread > size)
+			toread = size;
+
+		memcpy(data, ptr, toread);
+
+		if (len)
+			*len = toread;
+
+		return true;
+	}
+
 	bytes_read = read(pcap->fd, &pkt, PCAP_PKT_SIZE);
 	if (bytes_read != PCAP_PKT_SIZE)
 		return false;
@@ -191,6 +276,46 @@ bool pcap_read_ppi(struct pcap *pcap, struct timeval *tv, uint32_t *type,
 	if (!pcap)
 		return false;
 
+	if (pcap->map) {
+		const struct pcap_pkt *map;
+		const struct pcap_ppi *hdr;
+		const uint8_t *ptr;
+
+		map = map_pkt(pcap, &ptr);
+		if (!map)
+			return false;
+
+		toread = map->incl_len > size ? size : map->incl_len;
+		if (toread < PCAP_PPI_SIZE)
+			return false;
+
+		hdr = (const void *) ptr;
+		if (hdr->flags)
+			return false;
+
+		pph_len = le16_to_cpu(hdr->len);
+		if (pph_len < PCAP_PPI_SIZE || pph_len > toread)
+			return false;
+
+		memcpy(data, ptr + PCAP_PPI_SIZE, toread - PCAP_PPI_SIZE);
+
+		if (tv) {
+			tv->tv_sec = map->ts_sec;
+			tv->tv_usec = map->ts_usec;
+		}
+
+		if (type)
+			*type = le32_to_cpu(hdr->dlt);
+
+		if (offset)
+			*offset = pph_len - PCAP_PPI_SIZE;
+
+		if (len)
+			*len = toread - pph_len;
+
+		return true;
+	}
+
 	bytes_read = read(pcap->fd, &pkt, PCAP_PKT_SIZE);
 	if (bytes_read != PCAP_PKT_SIZE)
 		return false;
@@ -231,3 +356,102 @@ bool pcap_read_ppi(struct pcap *pcap, struct timeval *tv, uint32_t *type,
 
 	return true;
 }
+
+static uint8_t *get_buf(struct pcap *pcap)
+{
+	if (!pcap->buf && pcap->snaplen)
+		pcap->buf = malloc(pcap->snaplen);
+
+	return pcap->buf;
+}
+
+/*
+ * Zero-copy variants of pcap_read and pcap_read_ppi. For mapped files the
+ * data points into the mapping and stays valid until the last reference is
+ * dropped, otherwise it points to a buffer reused by the next call.
+ */
+bool pcap_next(struct pcap *pcap, struct timeval *tv,
+					const void **data, uint32_t *len)
+{
+	const struct pcap_pkt *pkt;
+	const uint8_t *ptr;
+
+	if (!pcap)
+		return false;
+
+	if (!pcap->map) {
+		if (!get_buf(pcap))
+			return false;
+
+		*data = pcap->buf;
+		return pcap_read(pcap, tv, pcap->buf, pcap->snaplen, len);
+	}
+
+	pkt = map_pkt(pcap, &ptr);
+	if (!pkt)
+		return false;
+
+	if (tv) {
+		tv->tv_sec = pkt->ts_sec;
+		tv->tv_usec = pkt->ts_usec;
+	}
+
+	*data = ptr;
+
+	if (len)
+		*len = pkt->incl_len;
+
+	return true;
+}
+
+bool pcap_next_ppi(struct pcap *pcap, struct timeval *tv, uint32_t *type,
+					const void **data, uint32_t *len)
+{
+	const struct pcap_pkt *pkt;
+	const struct pcap_ppi *ppi;
+	const uint8_t *ptr;
+	uint32_t offset;
+	uint16_t pph_len;
+
+	if (!pcap)
+		return false;
+
+	if (!pcap->map) {
+		if (!get_buf(pcap))
+			return false;
+
+		if (!pcap_read_ppi(pcap, tv, type, pcap->buf, pcap->snaplen,
+							&offset, len))
+			return false;
+
+		*data = pcap->buf + offset;
+		return true;
+	}
+
+	pkt = map_pkt(pcap, &ptr);
+	if (!pkt || pkt->incl_len < PCAP_PPI_SIZE)
+		return false;
+
+	ppi = (const void *) ptr;
+	if (ppi->flags)
+		return false;
+
+	pph_len = le16_to_cpu(ppi->len);
+	if (pph_len < PCAP_PPI_SIZE || pph_len > pkt->incl_len)
+		return false;
+
+	if (tv) {
+		tv->tv_sec = pkt->ts_sec;
+		tv->tv_usec = pkt->ts_usec;
+	}
+
+	if (type)
+		*type = le32_to_cpu(ppi->dlt);
+
+	*data = ptr + pph_len;
+
+	if (len)
+		*len = pkt->incl_len - pph_len;
+
+	return true;
+}
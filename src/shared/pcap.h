@@ -45,3 +45,8 @@ bool pcap_read(struct pcap *pcap, struct timeval *tv,
 bool pcap_read_ppi(struct pcap *pcap, struct timeval *tv, uint32_t *type,
 					void *data, uint32_t size,
 					uint32_t *offset, uint32_t *len);
+
+bool pcap_next(struct pcap *pcap, struct timeval *tv,
+					const void **data, uint32_t *len);
+bool pcap_next_ppi(struct pcap *pcap, struct timeval *tv, uint32_t *type,
+					const void **data, uint32_t *len);
@@ -25,14 +25,41 @@
 #include <config.h>
 #endif
 
+#include <string.h>
+
 #include "src/shared/util.h"
 #include "src/shared/queue.h"
 
+/* Released entries are kept on a per-thread free list and handed out again
+ * by later insertions instead of going back to malloc. The list is per
+ * thread since queues are used from both the mainloop thread and the
+ * threads calling into it, and is capped so that a burst does not pin
+ * memory forever.
+ */
+#define QUEUE_ENTRY_POOL_MAX	256
+
+#define QUEUE_RING_MIN		8
+#define QUEUE_BUCKETS_MIN	16
+
+static __thread struct queue_entry *entry_pool;
+static __thread unsigned int entry_pool_size;
+
 struct queue {
 	int ref_count;
 	struct queue_entry *head;
 	struct queue_entry *tail;
 	unsigned int entries;
+
+	/* Ring mode: entries are stored in a power of two sized array */
+	void **ring;
+	unsigned int ring_size;
+	unsigned int ring_head;
+	bool is_ring;
+
+	/* Keyed mode: entries are additionally hashed by key_func */
+	queue_key_func_t key_func;
+	struct queue_entry **buckets;
+	unsigned int num_buckets;
 };
 
 static struct queue *queue_ref(struct queue *queue)
@@ -50,6 +77,8 @@ static void queue_unref(struct queue *queue)
 	if (__sync_sub_and_fetch(&queue->ref_count, 1))
 		return;
 
+	free(queue->ring);
+	free(queue->buckets);
 	free(queue);
 }
 
@@ -68,6 +97,53 @@ struct queue *queue_new(void)
 	return queue_ref(queue);
 }
 
+struct queue *queue_new_ring(unsigned int size)
+{
+	struct queue *queue;
+	unsigned int ring_size = QUEUE_RING_MIN;
+
+	while (ring_size < size)
+		ring_size <<= 1;
+
+	queue = queue_new();
+	if (!queue)
+		return NULL;
+
+	queue->ring = new0(void *, ring_size);
+	if (!queue->ring) {
+		queue_unref(queue);
+		return NULL;
+	}
+
+	queue->ring_size = ring_size;
+	queue->is_ring = true;
+
+	return queue;
+}
+
+struct queue *queue_new_keyed(queue_key_func_t key_func)
+{
+	struct queue *queue;
+
+	if (!key_func)
+		return NULL;
+
+	queue = queue_new();
+	if (!queue)
+		return NULL;
+
+	queue->buckets = new0(struct queue_entry *, QUEUE_BUCKETS_MIN);
+	if (!queue->buckets) {
+		queue_unref(queue);
+		return NULL;
+	}
+
+	queue->num_buckets = QUEUE_BUCKETS_MIN;
+	queue->key_func = key_func;
+
+	return queue;
+}
+
 void queue_destroy(struct queue *queue, queue_destroy_func_t destroy)
 {
 	if (!queue)
@@ -93,22 +169,217 @@ static void queue_entry_unref(struct queue_entry *entry)
 	if (__sync_sub_and_fetch(&entry->ref_count, 1))
 		return;
 
-	free(entry);
+	if (entry_pool_size >= QUEUE_ENTRY_POOL_MAX) {
+		free(entry);
+		return;
+	}
+
+	entry->next = entry_pool;
+	entry_pool = entry;
+	entry_pool_size++;
 }
 
 static struct queue_entry *queue_entry_new(void *data)
 {
 	struct queue_entry *entry;
 
-	entry = new0(struct queue_entry, 1);
-	if (!entry)
-		return NULL;
+	if (entry_pool) {
+		entry = entry_pool;
+		entry_pool = entry->next;
+		entry_pool_size--;
+
+		memset(entry, 0, sizeof(*entry));
+	} else {
+		entry = new0(struct queue_entry, 1);
+		if (!entry)
+			return NULL;
+	}
 
 	entry->data = data;
 
 	return queue_entry_ref(entry);
 }
 
+static inline unsigned int queue_bucket(struct queue *queue, unsigned int key)
+{
+	key ^= key >> 16;
+	key *= 0x45d9f3b;
+	key ^= key >> 16;
+
+	return key & (queue->num_buckets - 1);
+}
+
+static bool queue_hash_grow(struct queue *queue)
+{
+	struct queue_entry **buckets;
+	struct queue_entry *entry;
+	unsigned int num_buckets = queue->num_buckets * 2;
+
+	buckets = new0(struct queue_entry *, num_buckets);
+	if (!buckets)
+		return false;
+
+	free(queue->buckets);
+	queue->buckets = buckets;
+	queue->num_buckets = num_buckets;
+
+	for (entry = queue->head; entry; entry = entry->next) {
+		unsigned int bucket;
+
+		bucket = queue_bucket(queue, queue->key_func(entry->data));
+		entry->hash_next = buckets[bucket];
+		buckets[bucket] = entry;
+	}
+
+	return true;
+}
+
+static void queue_hash_add(struct queue *queue, struct queue_entry *entry)
+{
+	unsigned int bucket;
+
+	if (!queue->key_func)
+		return;
+
+	/* The entry is already linked in, so growing rehashes it as well */
+	if (queue->entries > queue->num_buckets && queue_hash_grow(queue))
+		return;
+
+	bucket = queue_bucket(queue, queue->key_func(entry->data));
+	entry->hash_next = queue->buckets[bucket];
+	queue->buckets[bucket] = entry;
+}
+
+static void queue_hash_remove(struct queue *queue, struct queue_entry *entry)
+{
+	struct queue_entry **pos;
+
+	if (!queue->key_func)
+		return;
+
+	pos = &queue->buckets[queue_bucket(queue,
+					queue->key_func(entry->data))];
+
+	for (; *pos; pos = &(*pos)->hash_next) {
+		if (*pos == entry) {
+			*pos = entry->hash_next;
+			entry->hash_next = NULL;
+			return;
+		}
+	}
+}
+
+/* Unlinks entry from the list; entry->next is left untouched so that an
+ * iteration holding a reference on it can carry on.
+ */
+static void queue_unlink(struct queue *queue, struct queue_entry *entry)
+{
+	if (entry->prev)
+		entry->prev->next = entry->next;
+	else
+		queue->head = entry->next;
+
+	if (entry->next)
+		entry->next->prev = entry->prev;
+	else
+		queue->tail = entry->prev;
+
+	queue_hash_remove(queue, entry);
+
+	queue->entries--;
+}
+
+static inline void **ring_slot(struct queue *queue, unsigned int index)
+{
+	return &queue->ring[(queue->ring_head + index) &
+						(queue->ring_size - 1)];
+}
+
+static bool ring_reserve(struct queue *queue)
+{
+	unsigned int size;
+	void **ring;
+	unsigned int i;
+
+	if (queue->entries < queue->ring_size)
+		return true;
+
+	size = queue->ring_size ? queue->ring_size * 2 : QUEUE_RING_MIN;
+
+	ring = new0(void *, size);
+	if (!ring)
+		return false;
+
+	for (i = 0; i < queue->entries; i++)
+		ring[i] = *ring_slot(queue, i);
+
+	free(queue->ring);
+	queue->ring = ring;
+	queue->ring_size = size;
+	queue->ring_head = 0;
+
+	return true;
+}
+
+static bool ring_insert(struct queue *queue, unsigned int index, void *data)
+{
+	unsigned int i;
+
+	if (!ring_reserve(queue))
+		return false;
+
+	if (!index) {
+		queue->ring_head = (queue->ring_head - 1) &
+						(queue->ring_size - 1);
+		*ring_slot(queue, 0) = data;
+		queue->entries++;
+		return true;
+	}
+
+	for (i = queue->entries; i > index; i--)
+		*ring_slot(queue, i) = *ring_slot(queue, i - 1);
+
+	*ring_slot(queue, index) = data;
+	queue->entries++;
+
+	return true;
+}
+
+static void *ring_remove(struct queue *queue, unsigned int index)
+{
+	void *data = *ring_slot(queue, index);
+	unsigned int i;
+
+	if (!index) {
+		queue->ring_head = (queue->ring_head + 1) &
+						(queue->ring_size - 1);
+		queue->entries--;
+		return data;
+	}
+
+	for (i = index; i + 1 < queue->entries; i++)
+		*ring_slot(queue, i) = *ring_slot(queue, i + 1);
+
+	queue->entries--;
+
+	return data;
+}
+
+static bool ring_lookup(struct queue *queue, queue_match_func_t function,
+				const void *match_data, unsigned int *index)
+{
+	unsigned int i;
+
+	for (i = 0; i < queue->entries; i++) {
+		if (function(*ring_slot(queue, i), match_data)) {
+			*index = i;
+			return true;
+		}
+	}
+
+	return false;
+}
+
 bool queue_push_tail(struct queue *queue, void *data)
 {
 	struct queue_entry *entry;
@@ -116,6 +387,9 @@ bool queue_push_tail(struct queue *queue, void *data)
 	if (!queue)
 		return false;
 
+	if (queue->is_ring)
+		return ring_insert(queue, queue->entries, data);
+
 	entry = queue_entry_new(data);
 	if (!entry)
 		return false;
@@ -123,6 +397,7 @@ bool queue_push_tail(struct queue *queue, void *data)
 	if (queue->tail)
 		queue->tail->next = entry;
 
+	entry->prev = queue->tail;
 	queue->tail = entry;
 
 	if (!queue->head)
@@ -130,6 +405,8 @@ bool queue_push_tail(struct queue *queue, void *data)
 
 	queue->entries++;
 
+	queue_hash_add(queue, entry);
+
 	return true;
 }
 
@@ -140,12 +417,18 @@ bool queue_push_head(struct queue *queue, void *data)
 	if (!queue)
 		return false;
 
+	if (queue->is_ring)
+		return ring_insert(queue, 0, data);
+
 	entry = queue_entry_new(data);
 	if (!entry)
 		return false;
 
 	entry->next = queue->head;
 
+	if (queue->head)
+		queue->head->prev = entry;
+
 	queue->head = entry;
 
 	if (!queue->tail)
@@ -153,18 +436,33 @@ bool queue_push_head(struct queue *queue, void *data)
 
 	queue->entries++;
 
+	queue_hash_add(queue, entry);
+
 	return true;
 }
 
+static bool direct_match(const void *a, const void *b)
+{
+	return a == b;
+}
+
 bool queue_push_after(struct queue *queue, void *entry, void *data)
 {
 	struct queue_entry *qentry, *tmp, *new_entry;
+	unsigned int index;
 
 	qentry = NULL;
 
 	if (!queue)
 		return false;
 
+	if (queue->is_ring) {
+		if (!ring_lookup(queue, direct_match, entry, &index))
+			return false;
+
+		return ring_insert(queue, index + 1, data);
+	}
+
 	for (tmp = queue->head; tmp; tmp = tmp->next) {
 		if (tmp->data == entry) {
 			qentry = tmp;
@@ -180,13 +478,18 @@ bool queue_push_after(struct queue *queue, void *entry, void *data)
 		return false;
 
 	new_entry->next = qentry->next;
+	new_entry->prev = qentry;
 
 	if (!qentry->next)
 		queue->tail = new_entry;
+	else
+		qentry->next->prev = new_entry;
 
 	qentry->next = new_entry;
 	queue->entries++;
 
+	queue_hash_add(queue, new_entry);
+
 	return true;
 }
 
@@ -195,41 +498,65 @@ void *queue_pop_head(struct queue *queue)
 	struct queue_entry *entry;
 	void *data;
 
-	if (!queue || !queue->head)
+	if (!queue || !queue->entries)
 		return NULL;
 
+	if (queue->is_ring)
+		return ring_remove(queue, 0);
+
 	entry = queue->head;
 
-	if (!queue->head->next) {
-		queue->head = NULL;
-		queue->tail = NULL;
-	} else
-		queue->head = queue->head->next;
+	queue_unlink(queue, entry);
 
 	data = entry->data;
 
 	queue_entry_unref(entry);
-	queue->entries--;
 
 	return data;
 }
 
 void *queue_peek_head(struct queue *queue)
 {
-	if (!queue || !queue->head)
+	if (!queue || !queue->entries)
 		return NULL;
 
+	if (queue->is_ring)
+		return *ring_slot(queue, 0);
+
 	return queue->head->data;
 }
 
 void *queue_peek_tail(struct queue *queue)
 {
-	if (!queue || !queue->tail)
+	if (!queue || !queue->entries)
 		return NULL;
 
+	if (queue->is_ring)
+		return *ring_slot(queue, queue->entries - 1);
+
 	return queue->tail->data;
 }
 
+static void ring_foreach(struct queue *queue, queue_foreach_func_t function,
+							void *user_data)
+{
+	unsigned int i = 0;
+
+	queue_ref(queue);
+
+	while (i < queue->entries && queue->ref_count > 1) {
+		void *data = *ring_slot(queue, i);
+
+		function(data, user_data);
+
+		/* Only move on if the callback did not remove the entry */
+		if (i < queue->entries && *ring_slot(queue, i) == data)
+			i++;
+	}
+
+	queue_unref(queue);
+}
+
 void queue_foreach(struct queue *queue, queue_foreach_func_t function,
 							void *user_data)
 {
@@ -238,6 +565,11 @@ void queue_foreach(struct queue *queue, queue_foreach_func_t function,
 	if (!queue || !function)
 		return;
 
+	if (queue->is_ring) {
+		ring_foreach(queue, function, user_data);
+		return;
+	}
+
 	entry = queue->head;
 	if (!entry)
 		return;
@@ -259,15 +591,11 @@ void queue_foreach(struct queue *queue, queue_foreach_func_t function,
 	queue_unref(queue);
 }
 
-static bool direct_match(const void *a, const void *b)
-{
-	return a == b;
-}
-
 void *queue_find(struct queue *queue, queue_match_func_t function,
 							const void *match_data)
 {
 	struct queue_entry *entry;
+	unsigned int index;
 
 	if (!queue)
 		return NULL;
@@ -275,6 +603,13 @@ void *queue_find(struct queue *queue, queue_match_func_t function,
 	if (!function)
 		function = direct_match;
 
+	if (queue->is_ring) {
+		if (!ring_lookup(queue, function, match_data, &index))
+			return NULL;
+
+		return *ring_slot(queue, index);
+	}
+
 	for (entry = queue->head; entry; entry = entry->next)
 		if (function(entry->data, match_data))
 			return entry->data;
@@ -282,28 +617,75 @@ void *queue_find(struct queue *queue, queue_match_func_t function,
 	return NULL;
 }
 
+static struct queue_entry *queue_lookup_key(struct queue *queue,
+							unsigned int key)
+{
+	struct queue_entry *entry;
+
+	if (!queue || !queue->key_func)
+		return NULL;
+
+	entry = queue->buckets[queue_bucket(queue, key)];
+
+	for (; entry; entry = entry->hash_next) {
+		if (queue->key_func(entry->data) == key)
+			return entry;
+	}
+
+	return NULL;
+}
+
+void *queue_find_by_key(struct queue *queue, unsigned int key)
+{
+	struct queue_entry *entry;
+
+	entry = queue_lookup_key(queue, key);
+	if (!entry)
+		return NULL;
+
+	return entry->data;
+}
+
+void *queue_remove_by_key(struct queue *queue, unsigned int key)
+{
+	struct queue_entry *entry;
+	void *data;
+
+	entry = queue_lookup_key(queue, key);
+	if (!entry)
+		return NULL;
+
+	queue_unlink(queue, entry);
+
+	data = entry->data;
+
+	queue_entry_unref(entry);
+
+	return data;
+}
+
 bool queue_remove(struct queue *queue, void *data)
 {
-	struct queue_entry *entry, *prev;
+	struct queue_entry *entry;
+	unsigned int index;
 
 	if (!queue)
 		return false;
 
-	for (entry = queue->head, prev = NULL; entry;
-					prev = entry, entry = entry->next) {
-		if (entry->data != data)
-			continue;
+	if (queue->is_ring) {
+		if (!ring_lookup(queue, direct_match, data, &index))
+			return false;
 
-		if (prev)
-			prev->next = entry->next;
-		else
-			queue->head = entry->next;
+		ring_remove(queue, index);
+		return true;
+	}
 
-		if (!entry->next)
-			queue->tail = prev;
+	for (entry = queue->head; entry; entry = entry->next) {
+		if (entry->data != data)
+			continue;
 
+		queue_unlink(queue, entry);
 		queue_entry_unref(entry);
-		queue->entries--;
 
 		return true;
 	}
@@ -314,40 +696,63 @@ bool queue_remove(struct queue *queue, void *data)
 void *queue_remove_if(struct queue *queue, queue_match_func_t function,
 							void *user_data)
 {
-	struct queue_entry *entry, *prev = NULL;
+	struct queue_entry *entry;
+	unsigned int index;
 
 	if (!queue || !function)
 		return NULL;
 
-	entry = queue->head;
+	if (queue->is_ring) {
+		if (!ring_lookup(queue, function, user_data, &index))
+			return NULL;
 
-	while (entry) {
-		if (function(entry->data, user_data)) {
-			void *data;
+		return ring_remove(queue, index);
+	}
 
-			if (prev)
-				prev->next = entry->next;
-			else
-				queue->head = entry->next;
+	for (entry = queue->head; entry; entry = entry->next) {
+		void *data;
 
-			if (!entry->next)
-				queue->tail = prev;
+		if (!function(entry->data, user_data))
+			continue;
 
-			data = entry->data;
+		queue_unlink(queue, entry);
 
-			queue_entry_unref(entry);
-			queue->entries--;
+		data = entry->data;
 
-			return data;
-		} else {
-			prev = entry;
-			entry = entry->next;
-		}
+		queue_entry_unref(entry);
+
+		return data;
 	}
 
 	return NULL;
 }
 
+static unsigned int ring_remove_all(struct queue *queue,
+						queue_destroy_func_t destroy)
+{
+	void **ring = queue->ring;
+	unsigned int size = queue->ring_size;
+	unsigned int head = queue->ring_head;
+	unsigned int count = queue->entries;
+	unsigned int i;
+
+	if (!count)
+		return 0;
+
+	/* Detach the storage first since destroy may modify the queue */
+	queue->ring = NULL;
+	queue->ring_size = 0;
+	queue->ring_head = 0;
+	queue->entries = 0;
+
+	for (i = 0; i < count && destroy; i++)
+		destroy(ring[(head + i) & (size - 1)]);
+
+	free(ring);
+
+	return count;
+}
+
 unsigned int queue_remove_all(struct queue *queue, queue_match_func_t function,
 				void *user_data, queue_destroy_func_t destroy)
 {
@@ -360,7 +765,7 @@ unsigned int queue_remove_all(struct queue *queue, queue_match_func_t function,
 	entry = queue->head;
 
 	if (function) {
-		while (entry) {
+		while (queue->entries) {
 			void *data;
 			unsigned int entries = queue->entries;
 
@@ -373,11 +778,17 @@ unsigned int queue_remove_all(struct queue *queue, queue_match_func_t function,
 
 			count++;
 		}
+	} else if (queue->is_ring) {
+		count = ring_remove_all(queue, destroy);
 	} else {
 		queue->head = NULL;
 		queue->tail = NULL;
 		queue->entries = 0;
 
+		if (queue->key_func)
+			memset(queue->buckets, 0, queue->num_buckets *
+						sizeof(*queue->buckets));
+
 		while (entry) {
 			struct queue_entry *tmp = entry;
 
@@ -399,6 +810,10 @@ const struct queue_entry *queue_get_entries(struct queue *queue)
 	if (!queue)
 		return NULL;
 
+	/* Ring queues keep no entries to walk, use queue_foreach instead */
+	if (queue->is_ring)
+		return NULL;
+
 	return queue->head;
 }
 
@@ -417,3 +832,16 @@ bool queue_isempty(struct queue *queue)
 
 	return queue->entries == 0;
 }
+
+/* Frees the entries pooled by the calling thread, for threads about to exit */
+void queue_release_pool(void)
+{
+	while (entry_pool) {
+		struct queue_entry *entry = entry_pool;
+
+		entry_pool = entry->next;
+		free(entry);
+	}
+
+	entry_pool_size = 0;
+}
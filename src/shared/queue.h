@@ -31,9 +31,15 @@ struct queue_entry {
 	int ref_count;
 	void *data;
 	struct queue_entry *next;
+	struct queue_entry *prev;
+	struct queue_entry *hash_next;
 };
 
+typedef unsigned int (*queue_key_func_t)(const void *data);
+
 struct queue *queue_new(void);
+struct queue *queue_new_ring(unsigned int size);
+struct queue *queue_new_keyed(queue_key_func_t key_func);
 void queue_destroy(struct queue *queue, queue_destroy_func_t destroy);
 
 bool queue_push_tail(struct queue *queue, void *data);
@@ -53,6 +59,9 @@ typedef bool (*queue_match_func_t)(const void *data, const void *match_data);
 void *queue_find(struct queue *queue, queue_match_func_t function,
 							const void *match_data);
 
+void *queue_find_by_key(struct queue *queue, unsigned int key);
+void *queue_remove_by_key(struct queue *queue, unsigned int key);
+
 bool queue_remove(struct queue *queue, void *data);
 void *queue_remove_if(struct queue *queue, queue_match_func_t function,
 							void *user_data);
@@ -63,3 +72,5 @@ const struct queue_entry *queue_get_entries(struct queue *queue);
 
 unsigned int queue_length(struct queue *queue);
 bool queue_isempty(struct queue *queue);
+
+void queue_release_pool(void);
@@ -0,0 +1,441 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+#include "src/shared/util.h"
+#include "src/shared/aes.h"
+#include "src/shared/rpa.h"
+
+/* Number of IRKs evaluated per bt_aes_encrypt_batch() call */
+#define RPA_BATCH	32
+
+struct rpa_identity {
+	uint8_t addr[6];
+	uint8_t addr_type;
+};
+
+/*
+ * Results are cached by the full address, misses included, so adverts from
+ * unknown devices don't cost a pass over the table each time.
+ */
+struct rpa_cache_entry {
+	uint8_t rpa[6];
+	int index;			/* IRK table index, -1 if no match */
+	struct rpa_cache_entry *hash_next;
+	struct rpa_cache_entry *prev;	/* LRU list, most recent first */
+	struct rpa_cache_entry *next;
+};
+
+struct bt_rpa_resolver {
+	int ref_count;
+
+	/* IRK table, keys are kept apart for bt_aes_encrypt_batch() */
+	struct bt_aes_key *keys;
+	struct rpa_identity *ids;
+	size_t count;
+	size_t alloc;
+
+	struct rpa_cache_entry *cache;
+	size_t cache_size;
+	size_t cache_used;
+	struct rpa_cache_entry **buckets;
+	size_t bucket_mask;
+	struct rpa_cache_entry *lru_head;
+	struct rpa_cache_entry *lru_tail;
+	size_t cache_hits;
+	size_t cache_misses;
+};
+
+static inline void swap_buf(const uint8_t *src, uint8_t *dst, uint16_t len)
+{
+	int i;
+
+	for (i = 0; i < len; i++)
+		dst[len - 1 - i] = src[i];
+}
+
+static void cache_flush(struct bt_rpa_resolver *resolver)
+{
+	if (!resolver->cache_size)
+		return;
+
+	memset(resolver->buckets, 0, (resolver->bucket_mask + 1) *
+					sizeof(*resolver->buckets));
+	resolver->cache_used = 0;
+	resolver->lru_head = NULL;
+	resolver->lru_tail = NULL;
+}
+
+static size_t cache_bucket(struct bt_rpa_resolver *resolver,
+						const uint8_t rpa[6])
+{
+	/* The hash and prand are random, any of their bits will do */
+	return (get_le32(rpa) ^ get_le16(rpa + 4)) & resolver->bucket_mask;
+}
+
+static void lru_unlink(struct bt_rpa_resolver *resolver,
+					struct rpa_cache_entry *entry)
+{
+	if (entry->prev)
+		entry->prev->next = entry->next;
+	else
+		resolver->lru_head = entry->next;
+
+	if (entry->next)
+		entry->next->prev = entry->prev;
+	else
+		resolver->lru_tail = entry->prev;
+}
+
+static void lru_push(struct bt_rpa_resolver *resolver,
+					struct rpa_cache_entry *entry)
+{
+	entry->prev = NULL;
+	entry->next = resolver->lru_head;
+
+	if (resolver->lru_head)
+		resolver->lru_head->prev = entry;
+	else
+		resolver->lru_tail = entry;
+
+	resolver->lru_head = entry;
+}
+
+static struct rpa_cache_entry *cache_lookup(struct bt_rpa_resolver *resolver,
+							const uint8_t rpa[6])
+{
+	struct rpa_cache_entry *entry;
+
+	if (!resolver->cache_size)
+		return NULL;
+
+	entry = resolver->buckets[cache_bucket(resolver, rpa)];
+
+	for (; entry; entry = entry->hash_next) {
+		if (memcmp(entry->rpa, rpa, 6))
+			continue;
+
+		if (entry != resolver->lru_head) {
+			lru_unlink(resolver, entry);
+			lru_push(resolver, entry);
+		}
+
+		return entry;
+	}
+
+	return NULL;
+}
+
+static void cache_insert(struct bt_rpa_resolver *resolver,
+					const uint8_t rpa[6], int index)
+{
+	struct rpa_cache_entry *entry, **p;
+
+	if (!resolver->cache_size)
+		return;
+
+	if (resolver->cache_used < resolver->cache_size) {
+		entry = &resolver->cache[resolver->cache_used++];
+	} else {
+		/* Evict the least recently used entry */
+		entry = resolver->lru_tail;
+		lru_unlink(resolver, entry);
+
+		p = &resolver->buckets[cache_bucket(resolver, entry->rpa)];
+		while (*p != entry)
+			p = &(*p)->hash_next;
+
+		*p = entry->hash_next;
+	}
+
+	memcpy(entry->rpa, rpa, 6);
+	entry->index = index;
+
+	p = &resolver->buckets[cache_bucket(resolver, rpa)];
+	entry->hash_next = *p;
+	*p = entry;
+
+	lru_push(resolver, entry);
+}
+
+struct bt_rpa_resolver *bt_rpa_resolver_new(size_t cache_size)
+{
+	struct bt_rpa_resolver *resolver;
+	size_t buckets = 1;
+
+	resolver = new0(struct bt_rpa_resolver, 1);
+	if (!resolver)
+		return NULL;
+
+	if (cache_size) {
+		while (buckets < cache_size)
+			buckets <<= 1;
+
+		resolver->cache = new0(struct rpa_cache_entry, cache_size);
+		resolver->buckets = new0(struct rpa_cache_entry *, buckets);
+		if (!resolver->cache || !resolver->buckets) {
+			free(resolver->cache);
+			free(resolver->buckets);
+			free(resolver);
+			return NULL;
+		}
+
+		resolver->cache_size = cache_size;
+		resolver->bucket_mask = buckets - 1;
+	}
+
+	return bt_rpa_resolver_ref(resolver);
+}
+
+struct bt_rpa_resolver *bt_rpa_resolver_ref(struct bt_rpa_resolver *resolver)
+{
+	if (!resolver)
+		return NULL;
+
+	__sync_fetch_and_add(&resolver->ref_count, 1);
+
+	return resolver;
+}
+
+void bt_rpa_resolver_unref(struct bt_rpa_resolver *resolver)
+{
+	if (!resolver)
+		return;
+
+	if (__sync_sub_and_fetch(&resolver->ref_count, 1))
+		return;
+
+	if (resolver->keys)
+		memset(resolver->keys, 0, resolver->alloc *
+						sizeof(*resolver->keys));
+
+	free(resolver->keys);
+	free(resolver->ids);
+	free(resolver->cache);
+	free(resolver->buckets);
+	free(resolver);
+}
+
+static int find_identity(struct bt_rpa_resolver *resolver,
+				const uint8_t addr[6], uint8_t addr_type)
+{
+	size_t i;
+
+	for (i = 0; i < resolver->count; i++) {
+		if (resolver->ids[i].addr_type == addr_type &&
+				!memcmp(resolver->ids[i].addr, addr, 6))
+			return i;
+	}
+
+	return -1;
+}
+
+static bool table_grow(struct bt_rpa_resolver *resolver)
+{
+	struct bt_aes_key *keys;
+	struct rpa_identity *ids;
+	size_t alloc = resolver->alloc ? resolver->alloc * 2 : 8;
+
+	keys = new0(struct bt_aes_key, alloc);
+	ids = new0(struct rpa_identity, alloc);
+	if (!keys || !ids) {
+		free(keys);
+		free(ids);
+		return false;
+	}
+
+	if (resolver->count) {
+		memcpy(keys, resolver->keys, resolver->count * sizeof(*keys));
+		memcpy(ids, resolver->ids, resolver->count * sizeof(*ids));
+		memset(resolver->keys, 0, resolver->alloc * sizeof(*keys));
+	}
+
+	free(resolver->keys);
+	free(resolver->ids);
+
+	resolver->keys = keys;
+	resolver->ids = ids;
+	resolver->alloc = alloc;
+
+	return true;
+}
+
+bool bt_rpa_resolver_add_irk(struct bt_rpa_resolver *resolver,
+				const uint8_t irk[16], const uint8_t addr[6],
+				uint8_t addr_type)
+{
+	uint8_t key[16];
+	int index;
+
+	if (!resolver || !irk || !addr)
+		return false;
+
+	index = find_identity(resolver, addr, addr_type);
+	if (index < 0) {
+		if (resolver->count == resolver->alloc &&
+						!table_grow(resolver))
+			return false;
+
+		index = resolver->count++;
+		memcpy(resolver->ids[index].addr, addr, 6);
+		resolver->ids[index].addr_type = addr_type;
+	}
+
+	/* The most significant octet of the key comes first for AES */
+	swap_buf(irk, key, 16);
+	bt_aes_set_key(&resolver->keys[index], key);
+	memset(key, 0, sizeof(key));
+
+	/* Cached misses may now resolve */
+	cache_flush(resolver);
+
+	return true;
+}
+
+bool bt_rpa_resolver_remove_irk(struct bt_rpa_resolver *resolver,
+				const uint8_t addr[6], uint8_t addr_type)
+{
+	size_t last;
+	int index;
+
+	if (!resolver || !addr)
+		return false;
+
+	index = find_identity(resolver, addr, addr_type);
+	if (index < 0)
+		return false;
+
+	last = --resolver->count;
+	if ((size_t) index != last) {
+		resolver->keys[index] = resolver->keys[last];
+		resolver->ids[index] = resolver->ids[last];
+	}
+
+	memset(&resolver->keys[last], 0, sizeof(resolver->keys[last]));
+
+	/* Cached hits refer to table indexes */
+	cache_flush(resolver);
+
+	return true;
+}
+
+void bt_rpa_resolver_clear(struct bt_rpa_resolver *resolver)
+{
+	if (!resolver)
+		return;
+
+	if (resolver->keys)
+		memset(resolver->keys, 0, resolver->alloc *
+						sizeof(*resolver->keys));
+
+	resolver->count = 0;
+	cache_flush(resolver);
+}
+
+size_t bt_rpa_resolver_get_irk_count(struct bt_rpa_resolver *resolver)
+{
+	if (!resolver)
+		return 0;
+
+	return resolver->count;
+}
+
+void bt_rpa_resolver_get_cache_stats(struct bt_rpa_resolver *resolver,
+					size_t *hits, size_t *misses)
+{
+	if (hits)
+		*hits = resolver ? resolver->cache_hits : 0;
+
+	if (misses)
+		*misses = resolver ? resolver->cache_misses : 0;
+}
+
+bool bt_rpa_is_resolvable(const uint8_t addr[6])
+{
+	/* The two most significant bits of a random address are 0b01 */
+	return (addr[5] & 0xc0) == 0x40;
+}
+
+/*
+ * ah(k, r) = e(k, padding || r) mod 2^24, for every IRK. The prand r is the
+ * upper half of the address and the hash the lower half.
+ */
+static int match(struct bt_rpa_resolver *resolver, const uint8_t rpa[6])
+{
+	uint8_t in[16], out[RPA_BATCH][16];
+	size_t i, j, n;
+
+	memset(in, 0, 13);
+	swap_buf(rpa + 3, in + 13, 3);
+
+	for (i = 0; i < resolver->count; i += n) {
+		n = resolver->count - i;
+		if (n > RPA_BATCH)
+			n = RPA_BATCH;
+
+		bt_aes_encrypt_batch(resolver->keys + i, n, in, out);
+
+		for (j = 0; j < n; j++) {
+			if (out[j][15] == rpa[0] && out[j][14] == rpa[1] &&
+							out[j][13] == rpa[2])
+				return i + j;
+		}
+	}
+
+	return -1;
+}
+
+bool bt_rpa_resolver_resolve(struct bt_rpa_resolver *resolver,
+				const uint8_t rpa[6], uint8_t addr[6],
+				uint8_t *addr_type)
+{
+	struct rpa_cache_entry *entry;
+	int index;
+
+	if (!resolver || !rpa || !bt_rpa_is_resolvable(rpa))
+		return false;
+
+	entry = cache_lookup(resolver, rpa);
+	if (entry) {
+		index = entry->index;
+		resolver->cache_hits++;
+	} else {
+		index = match(resolver, rpa);
+		cache_insert(resolver, rpa, index);
+		resolver->cache_misses++;
+	}
+
+	if (index < 0)
+		return false;
+
+	if (addr)
+		memcpy(addr, resolver->ids[index].addr, 6);
+
+	if (addr_type)
+		*addr_type = resolver->ids[index].addr_type;
+
+	return true;
+}
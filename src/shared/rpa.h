@@ -0,0 +1,55 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Resolves LE random private addresses against a table of IRKs. Addresses
+ * and IRKs use the little endian byte order of HCI and mgmt, like bdaddr_t
+ * and bt_crypto_ah().
+ */
+struct bt_rpa_resolver;
+
+struct bt_rpa_resolver *bt_rpa_resolver_new(size_t cache_size);
+
+struct bt_rpa_resolver *bt_rpa_resolver_ref(struct bt_rpa_resolver *resolver);
+void bt_rpa_resolver_unref(struct bt_rpa_resolver *resolver);
+
+bool bt_rpa_resolver_add_irk(struct bt_rpa_resolver *resolver,
+				const uint8_t irk[16], const uint8_t addr[6],
+				uint8_t addr_type);
+bool bt_rpa_resolver_remove_irk(struct bt_rpa_resolver *resolver,
+				const uint8_t addr[6], uint8_t addr_type);
+void bt_rpa_resolver_clear(struct bt_rpa_resolver *resolver);
+size_t bt_rpa_resolver_get_irk_count(struct bt_rpa_resolver *resolver);
+
+/* Resolutions answered by the cache and those that went over the IRKs */
+void bt_rpa_resolver_get_cache_stats(struct bt_rpa_resolver *resolver,
+					size_t *hits, size_t *misses);
+
+bool bt_rpa_is_resolvable(const uint8_t addr[6]);
+
+/* On success addr and addr_type are the identity of the matching IRK */
+bool bt_rpa_resolver_resolve(struct bt_rpa_resolver *resolver,
+				const uint8_t rpa[6], uint8_t addr[6],
+				uint8_t *addr_type);
@@ -114,6 +114,10 @@ static const char *ecode_to_string(uint8_t ecode)
 		return "Group type Not Supported";
 	case BT_ATT_ERROR_INSUFFICIENT_RESOURCES:
 		return "Insufficient Resources";
+	case BT_ATT_ERROR_DB_OUT_OF_SYNC:
+		return "Database Out of Sync";
+	case BT_ATT_ERROR_VALUE_NOT_ALLOWED:
+		return "Value Not Allowed";
 	case BT_ERROR_CCC_IMPROPERLY_CONFIGURED:
 		return "CCC Improperly Configured";
 	case BT_ERROR_ALREADY_IN_PROGRESS:
@@ -38,8 +38,12 @@
 #include <endian.h>
 #include <arpa/inet.h>
 #include <sys/stat.h>
+#include <sys/param.h>
 
+#include "src/shared/util.h"
+#include "src/shared/queue.h"
 #include "src/shared/btsnoop.h"
+#include "monitor/filter.h"
 
 struct btsnoop_hdr {
 	uint8_t		id[8];		/* Identification Pattern */
@@ -63,33 +67,6 @@ static const uint8_t btsnoop_id[] = { 0x62, 0x74, 0x73, 0x6e,
 
 static const uint32_t btsnoop_version = 1;
 
-static int create_btsnoop(const char *path)
-{
-	struct btsnoop_hdr hdr;
-	ssize_t written;
-	int fd;
-
-	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
-				S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
-	if (fd < 0) {
-		perror("failed to output file");
-		return -1;
-	}
-
-	memcpy(hdr.id, btsnoop_id, sizeof(btsnoop_id));
-	hdr.version = htobe32(btsnoop_version);
-	hdr.type = htobe32(2001);
-
-	written = write(fd, &hdr, BTSNOOP_HDR_SIZE);
-	if (written < 0) {
-		perror("failed to write output header");
-		close(fd);
-		return -1;
-	}
-
-	return fd;
-}
-
 static int open_btsnoop(const char *path, uint32_t *type)
 {
 	struct btsnoop_hdr hdr;
@@ -127,149 +104,450 @@ static int open_btsnoop(const char *path, uint32_t *type)
 	return fd;
 }
 
-#define MAX_MERGE 8
+#define OUTPUT_BUFFER_SIZE	(4 * 1024 * 1024)
 
-static void command_merge(const char *output, int argc, char *argv[])
+static struct btsnoop *open_input(const char *path)
 {
-	struct btsnoop_pkt input_pkt[MAX_MERGE];
-	unsigned char buf[2048];
-	int output_fd, input_fd[MAX_MERGE], num_input = 0;
-	int i, select_input;
-	ssize_t len, written;
-	uint32_t toread, flags;
-	uint16_t index, opcode;
-
-	if (argc > MAX_MERGE) {
-		fprintf(stderr, "only up to %d files allowed\n", MAX_MERGE);
-		return;
+	struct btsnoop *btsnoop;
+
+	btsnoop = btsnoop_open(path, BTSNOOP_FLAG_MMAP);
+	if (!btsnoop) {
+		fprintf(stderr, "failed to open input file %s\n", path);
+		return NULL;
 	}
 
-	for (i = 0; i < argc; i++) {
-		uint32_t type;
-		int fd;
+	switch (btsnoop_get_type(btsnoop)) {
+	case BTSNOOP_TYPE_HCI:
+	case BTSNOOP_TYPE_UART:
+	case BTSNOOP_TYPE_MONITOR:
+		return btsnoop;
+	}
 
-		fd = open_btsnoop(argv[i], &type);
-		if (fd < 0)
-			break;
+	fprintf(stderr, "unsupported link data type %u\n",
+					btsnoop_get_type(btsnoop));
+	btsnoop_unref(btsnoop);
+
+	return NULL;
+}
 
-		if (type != 1002) {
-			fprintf(stderr, "unsupported link data type %u\n",
-									type);
-			close(fd);
+static struct btsnoop *create_output(const char *path)
+{
+	struct btsnoop *btsnoop;
+
+	btsnoop = btsnoop_create(path, BTSNOOP_TYPE_MONITOR);
+	if (!btsnoop) {
+		fprintf(stderr, "failed to create output file %s\n", path);
+		return NULL;
+	}
+
+	btsnoop_enable_index(btsnoop);
+	btsnoop_set_buffer(btsnoop, OUTPUT_BUFFER_SIZE, true);
+
+	return btsnoop;
+}
+
+struct merge_input {
+	struct btsnoop *btsnoop;
+	unsigned int num;
+	bool monitor;
+	struct timeval tv;
+	uint16_t index;
+	uint16_t opcode;
+	const void *data;
+	uint16_t size;
+	uint32_t drops;
+	uint32_t written_drops;
+};
+
+static bool input_next(struct merge_input *input)
+{
+	if (!btsnoop_next_hci(input->btsnoop, &input->tv, &input->index,
+					&input->opcode, &input->data,
+					&input->size))
+		return false;
+
+	input->drops = btsnoop_get_drops(input->btsnoop);
+
+	/* Controller traces are numbered by their position */
+	if (!input->monitor)
+		input->index = input->num;
+
+	return true;
+}
+
+static bool input_before(const struct merge_input *a,
+					const struct merge_input *b)
+{
+	if (timercmp(&a->tv, &b->tv, !=))
+		return timercmp(&a->tv, &b->tv, <);
+
+	return a->num < b->num;
+}
+
+static void heap_down(struct merge_input **heap, unsigned int count,
+							unsigned int pos)
+{
+	while (1) {
+		unsigned int child = pos * 2 + 1;
+		unsigned int min = pos;
+		struct merge_input *tmp;
+
+		if (child < count && input_before(heap[child], heap[min]))
+			min = child;
+
+		if (child + 1 < count &&
+				input_before(heap[child + 1], heap[min]))
+			min = child + 1;
+
+		if (min == pos)
 			break;
-		}
 
-		input_fd[num_input++] = fd;
+		tmp = heap[pos];
+		heap[pos] = heap[min];
+		heap[min] = tmp;
+		pos = min;
 	}
+}
 
-	if (num_input != argc) {
-		fprintf(stderr, "failed to open all input files\n");
-		goto close_input;
+static bool command_merge(const char *output, int argc, char *argv[])
+{
+	struct merge_input *inputs, **heap;
+	struct btsnoop *btsnoop;
+	unsigned int count = 0, i;
+	uint32_t drops = 0;
+	bool result = false;
+
+	inputs = calloc(argc, sizeof(*inputs));
+	heap = calloc(argc, sizeof(*heap));
+	if (!inputs || !heap)
+		goto free;
+
+	for (i = 0; i < (unsigned int) argc; i++) {
+		inputs[i].btsnoop = open_input(argv[i]);
+		if (!inputs[i].btsnoop) {
+			fprintf(stderr, "failed to open all input files\n");
+			goto close_input;
+		}
+
+		inputs[i].num = i;
+		inputs[i].monitor = btsnoop_get_type(inputs[i].btsnoop) ==
+							BTSNOOP_TYPE_MONITOR;
 	}
 
-	output_fd = create_btsnoop(output);
-	if (output_fd < 0)
+	btsnoop = create_output(output);
+	if (!btsnoop)
 		goto close_input;
 
-	for (i = 0; i < num_input; i++) {
-		len = read(input_fd[i], &input_pkt[i], BTSNOOP_PKT_SIZE);
-		if (len < 0 || len != BTSNOOP_PKT_SIZE) {
-			close(input_fd[i]);
-			input_fd[i] = -1;
-		}
+	for (i = 0; i < (unsigned int) argc; i++) {
+		if (input_next(&inputs[i]))
+			heap[count++] = &inputs[i];
 	}
 
-next_packet:
-	select_input = -1;
+	for (i = count / 2; i > 0; i--)
+		heap_down(heap, count, i - 1);
 
-	for (i = 0; i < num_input; i++) {
-		uint64_t ts;
+	result = true;
 
-		if (input_fd[i] < 0)
-			continue;
+	/* The earliest packet of all inputs is always on top */
+	while (count > 0) {
+		struct merge_input *input = heap[0];
 
-		if (select_input < 0) {
-			select_input = i;
-			continue;
+		/* Drops are cumulative, the output has the sum of all inputs */
+		drops += input->drops - input->written_drops;
+		input->written_drops = input->drops;
+		btsnoop_set_drops(btsnoop, drops);
+
+		if (input->opcode != 0xffff &&
+				!btsnoop_write_hci(btsnoop, &input->tv,
+						input->index, input->opcode,
+						input->data, input->size)) {
+			fprintf(stderr, "write of packet failed\n");
+			result = false;
+			break;
 		}
 
-		ts = be64toh(input_pkt[i].ts);
+		if (!input_next(input))
+			heap[0] = heap[--count];
 
-		if (ts < be64toh(input_pkt[select_input].ts))
-			select_input = i;
+		heap_down(heap, count, 0);
 	}
 
-	if (select_input < 0)
-		goto close_output;
+	btsnoop_unref(btsnoop);
 
-	toread = be32toh(input_pkt[select_input].size);
-	flags = be32toh(input_pkt[select_input].flags);
+close_input:
+	for (i = 0; i < (unsigned int) argc; i++)
+		btsnoop_unref(inputs[i].btsnoop);
 
-	len = read(input_fd[select_input], buf, toread);
-	if (len < 0 || len != (ssize_t) toread) {
-		close(input_fd[select_input]);
-		input_fd[select_input] = -1;
-		goto next_packet;
-	}
+free:
+	free(heap);
+	free(inputs);
 
-	written = htobe32(toread - 1);
-	input_pkt[select_input].size = written;
-	input_pkt[select_input].len = written;
+	return result;
+}
 
-	switch (buf[0]) {
-	case 0x01:
-		opcode = BTSNOOP_OPCODE_COMMAND_PKT;
-		break;
-	case 0x02:
-		if (flags & 0x01)
-			opcode = BTSNOOP_OPCODE_ACL_RX_PKT;
-		else
-			opcode = BTSNOOP_OPCODE_ACL_TX_PKT;
+enum { SPLIT_INDEX, SPLIT_TIME, SPLIT_SIZE };
+
+static struct btsnoop *split_output(const char *prefix, unsigned int num)
+{
+	struct btsnoop *btsnoop;
+	char *path;
+
+	if (asprintf(&path, "%s.%u", prefix, num) < 0)
+		return NULL;
+
+	btsnoop = create_output(path);
+	free(path);
+
+	return btsnoop;
+}
+
+/* Last index records of a controller, repeated in every split file */
+struct split_index {
+	uint16_t index;
+	uint16_t new_index_size;
+	uint16_t info_size;
+	uint8_t new_index[sizeof(struct btsnoop_opcode_new_index)];
+	uint8_t info[16];
+};
+
+static bool match_index(const void *data, const void *match_data)
+{
+	const struct split_index *entry = data;
+
+	return entry->index == PTR_TO_UINT(match_data);
+}
+
+static void track_index(struct queue *indexes, uint16_t index,
+				uint16_t opcode, const void *data, uint16_t size)
+{
+	struct split_index *entry;
+
+	switch (opcode) {
+	case BTSNOOP_OPCODE_NEW_INDEX:
+		entry = queue_find(indexes, match_index, UINT_TO_PTR(index));
+		if (!entry) {
+			entry = calloc(1, sizeof(*entry));
+			if (!entry)
+				return;
+
+			entry->index = index;
+			queue_push_tail(indexes, entry);
+		}
+
+		entry->new_index_size = MIN(size, sizeof(entry->new_index));
+		memcpy(entry->new_index, data, entry->new_index_size);
+		entry->info_size = 0;
 		break;
-	case 0x03:
-		if (flags & 0x01)
-			opcode = BTSNOOP_OPCODE_SCO_RX_PKT;
-		else
-			opcode = BTSNOOP_OPCODE_SCO_TX_PKT;
+	case BTSNOOP_OPCODE_INDEX_INFO:
+		entry = queue_find(indexes, match_index, UINT_TO_PTR(index));
+		if (!entry)
+			return;
+
+		entry->info_size = MIN(size, sizeof(entry->info));
+		memcpy(entry->info, data, entry->info_size);
 		break;
-	case 0x04:
-		opcode = BTSNOOP_OPCODE_EVENT_PKT;
+	case BTSNOOP_OPCODE_DEL_INDEX:
+		free(queue_remove_if(indexes, match_index,
+						UINT_TO_PTR(index)));
 		break;
-	default:
-		goto skip_write;
 	}
+}
+
+static bool write_indexes(struct btsnoop *output, struct queue *indexes,
+						struct timeval *tv)
+{
+	const struct queue_entry *entry;
 
-	index = select_input;
-	input_pkt[select_input].flags = htobe32((index << 16) | opcode);
+	for (entry = queue_get_entries(indexes); entry; entry = entry->next) {
+		const struct split_index *idx = entry->data;
 
-	written = write(output_fd, &input_pkt[select_input], BTSNOOP_PKT_SIZE);
-	if (written != BTSNOOP_PKT_SIZE) {
-		fprintf(stderr, "write of packet header failed\n");
-		goto close_output;
+		if (!btsnoop_write_hci(output, tv, idx->index,
+					BTSNOOP_OPCODE_NEW_INDEX,
+					idx->new_index, idx->new_index_size))
+			return false;
+
+		if (idx->info_size && !btsnoop_write_hci(output, tv, idx->index,
+					BTSNOOP_OPCODE_INDEX_INFO,
+					idx->info, idx->info_size))
+			return false;
 	}
 
-	written = write(output_fd, buf + 1, toread - 1);
-	if (written != (ssize_t) toread - 1) {
-		fprintf(stderr, "write of packet data failed\n");
-		goto close_output;
+	return true;
+}
+
+static bool command_split(const char *input, const char *prefix, int type,
+							unsigned long limit)
+{
+	struct btsnoop *btsnoop, *output = NULL;
+	struct btsnoop **outputs = NULL;
+	struct queue *indexes = NULL;
+	struct timeval tv, start;
+	uint16_t index, opcode, size;
+	const void *data;
+	uint64_t written = 0;
+	unsigned int num = 0;
+	bool result = false;
+
+	btsnoop = open_input(input);
+	if (!btsnoop)
+		return false;
+
+	if (type == SPLIT_INDEX) {
+		outputs = calloc(UINT16_MAX + 1, sizeof(*outputs));
+		if (!outputs)
+			goto close_input;
+	} else {
+		indexes = queue_new();
+		if (!indexes)
+			goto close_input;
 	}
 
-skip_write:
-	len = read(input_fd[select_input],
-				&input_pkt[select_input], BTSNOOP_PKT_SIZE);
-	if (len < 0 || len != BTSNOOP_PKT_SIZE) {
-		close(input_fd[select_input]);
-		input_fd[select_input] = -1;
+	result = true;
+
+	while (btsnoop_next_hci(btsnoop, &tv, &index, &opcode, &data, &size)) {
+		struct timeval diff;
+
+		if (opcode == 0xffff)
+			continue;
+
+		switch (type) {
+		case SPLIT_INDEX:
+			if (!outputs[index])
+				outputs[index] = split_output(prefix, index);
+			output = outputs[index];
+			break;
+		case SPLIT_TIME:
+			if (!output)
+				break;
+
+			timersub(&tv, &start, &diff);
+			if (diff.tv_sec >= (time_t) limit) {
+				btsnoop_unref(output);
+				output = NULL;
+			}
+			break;
+		case SPLIT_SIZE:
+			if (output && written + BTSNOOP_PKT_SIZE + size > limit) {
+				btsnoop_unref(output);
+				output = NULL;
+			}
+			break;
+		}
+
+		if (!output && type != SPLIT_INDEX) {
+			output = split_output(prefix, num++);
+			start = tv;
+			written = BTSNOOP_HDR_SIZE;
+
+			/* Each file has to describe its controllers */
+			if (output && !write_indexes(output, indexes, &tv)) {
+				fprintf(stderr, "write of index failed\n");
+				result = false;
+				break;
+			}
+		}
+
+		if (!output) {
+			result = false;
+			break;
+		}
+
+		btsnoop_set_drops(output, btsnoop_get_drops(btsnoop));
+
+		if (!btsnoop_write_hci(output, &tv, index, opcode, data, size)) {
+			fprintf(stderr, "write of packet failed\n");
+			result = false;
+			break;
+		}
+
+		written += BTSNOOP_PKT_SIZE + size;
+
+		if (indexes)
+			track_index(indexes, index, opcode, data, size);
 	}
 
-	goto next_packet;
+	if (outputs) {
+		unsigned int i;
+
+		for (i = 0; i <= UINT16_MAX; i++)
+			btsnoop_unref(outputs[i]);
 
-close_output:
-	close(output_fd);
+		free(outputs);
+	} else
+		btsnoop_unref(output);
 
 close_input:
-	for (i = 0; i < num_input; i++)
-		close(input_fd[i]);
+	queue_destroy(indexes, free);
+	btsnoop_unref(btsnoop);
+
+	return result;
+}
+
+static bool command_filter(const char *input, const char *output,
+							const char *expr)
+{
+	struct btsnoop *btsnoop, *out;
+	struct timeval tv;
+	uint16_t index, opcode, size;
+	const void *data;
+	bool result = false;
+
+	if (!filter_compile(expr))
+		return false;
+
+	btsnoop = open_input(input);
+	if (!btsnoop)
+		goto done;
+
+	out = create_output(output);
+	if (!out)
+		goto close_input;
+
+	result = true;
+
+	while (btsnoop_next_hci(btsnoop, &tv, &index, &opcode, &data, &size)) {
+		if (opcode == 0xffff)
+			continue;
+
+		if (!filter_packet(index, opcode, data, size))
+			continue;
+
+		btsnoop_set_drops(out, btsnoop_get_drops(btsnoop));
+
+		if (!btsnoop_write_hci(out, &tv, index, opcode, data, size)) {
+			fprintf(stderr, "write of packet failed\n");
+			result = false;
+			break;
+		}
+	}
+
+	btsnoop_unref(out);
+
+close_input:
+	btsnoop_unref(btsnoop);
+
+done:
+	filter_cleanup();
+
+	return result;
+}
+
+static bool command_index(const char *input)
+{
+	struct btsnoop *btsnoop;
+	bool result;
+
+	btsnoop = open_input(input);
+	if (!btsnoop)
+		return false;
+
+	result = btsnoop_save_index(btsnoop);
+	if (!result)
+		fprintf(stderr, "failed to write index for %s\n", input);
+
+	btsnoop_unref(btsnoop);
+
+	return result;
 }
 
 static void command_extract_eir(const char *input)
@@ -517,32 +795,73 @@ static void usage(void)
 	printf("\tbtsnoop <command> [files]\n");
 	printf("commands:\n"
 		"\t-m, --merge <output>   Merge multiple btsnoop files\n"
+		"\t-s, --split <input>    Split btsnoop file into several\n"
+		"\t-f, --filter <input>   Select packets from btsnoop file\n"
 		"\t-e, --extract <input>  Extract data from btsnoop file\n"
+		"\t-i, --index <input>    Write seek index for btsnoop file\n"
 		"\t-h, --help             Show help options\n");
+	printf("options:\n"
+		"\t-t, --type <type>      Type of split or extract\n"
+		"\t-l, --limit <num>      Seconds or megabytes per split file\n"
+		"\t-o, --output <file>    Output file or prefix for split\n");
+	printf("split types:\n"
+		"\tindex, time, size\n");
+	printf("extract types:\n"
+		"\teir, ad, sdp\n");
 }
 
 static const struct option main_options[] = {
 	{ "merge",   required_argument, NULL, 'm' },
+	{ "split",   required_argument, NULL, 's' },
+	{ "filter",  required_argument, NULL, 'f' },
 	{ "extract", required_argument, NULL, 'e' },
+	{ "index",   required_argument, NULL, 'i' },
 	{ "type",    required_argument, NULL, 't' },
+	{ "limit",   required_argument, NULL, 'l' },
+	{ "output",  required_argument, NULL, 'o' },
 	{ "version", no_argument,       NULL, 'v' },
 	{ "help",    no_argument,       NULL, 'h' },
 	{ }
 };
 
-enum { INVALID, MERGE, EXTRACT };
+enum { INVALID, MERGE, SPLIT, FILTER, EXTRACT, INDEX };
+
+static char *join_args(int argc, char *argv[])
+{
+	size_t len = 1;
+	char *str;
+	int i;
+
+	for (i = 0; i < argc; i++)
+		len += strlen(argv[i]) + 1;
+
+	str = calloc(len, 1);
+	if (!str)
+		return NULL;
+
+	for (i = 0; i < argc; i++) {
+		if (i)
+			strcat(str, " ");
+		strcat(str, argv[i]);
+	}
+
+	return str;
+}
 
 int main(int argc, char *argv[])
 {
 	const char *output_path = NULL;
 	const char *input_path = NULL;
 	const char *type = NULL;
+	unsigned long limit = 0;
 	unsigned short command = INVALID;
+	char *expr;
+	int split;
 
 	for (;;) {
 		int opt;
 
-		opt = getopt_long(argc, argv, "m:e:t:vh", main_options, NULL);
+		opt = getopt_long(argc, argv, "m:s:f:e:i:t:l:o:vh", main_options, NULL);
 		if (opt < 0)
 			break;
 
@@ -551,13 +870,31 @@ int main(int argc, char *argv[])
 			command = MERGE;
 			output_path = optarg;
 			break;
+		case 's':
+			command = SPLIT;
+			input_path = optarg;
+			break;
+		case 'f':
+			command = FILTER;
+			input_path = optarg;
+			break;
 		case 'e':
 			command = EXTRACT;
 			input_path = optarg;
 			break;
+		case 'i':
+			command = INDEX;
+			input_path = optarg;
+			break;
 		case 't':
 			type = optarg;
 			break;
+		case 'l':
+			limit = strtoul(optarg, NULL, 10);
+			break;
+		case 'o':
+			output_path = optarg;
+			break;
 		case 'v':
 			printf("%s\n", VERSION);
 			return EXIT_SUCCESS;
@@ -576,7 +913,66 @@ int main(int argc, char *argv[])
 			return EXIT_FAILURE;
 		}
 
-		command_merge(output_path, argc - optind, argv + optind);
+		if (!command_merge(output_path, argc - optind, argv + optind))
+			return EXIT_FAILURE;
+		break;
+
+	case SPLIT:
+		if (argc - optind > 0) {
+			fprintf(stderr, "extra arguments not allowed\n");
+			return EXIT_FAILURE;
+		}
+
+		if (!type) {
+			fprintf(stderr, "no split type specified\n");
+			return EXIT_FAILURE;
+		}
+
+		if (!strcasecmp(type, "index"))
+			split = SPLIT_INDEX;
+		else if (!strcasecmp(type, "time"))
+			split = SPLIT_TIME;
+		else if (!strcasecmp(type, "size"))
+			split = SPLIT_SIZE;
+		else {
+			fprintf(stderr, "split type not supported\n");
+			return EXIT_FAILURE;
+		}
+
+		if (split != SPLIT_INDEX && !limit) {
+			fprintf(stderr, "no split limit specified\n");
+			return EXIT_FAILURE;
+		}
+
+		if (split == SPLIT_SIZE)
+			limit *= 1024 * 1024;
+
+		if (!command_split(input_path, output_path ? : input_path,
+								split, limit))
+			return EXIT_FAILURE;
+		break;
+
+	case FILTER:
+		if (argc - optind < 1) {
+			fprintf(stderr, "filter expression required\n");
+			return EXIT_FAILURE;
+		}
+
+		if (!output_path) {
+			fprintf(stderr, "no output file specified\n");
+			return EXIT_FAILURE;
+		}
+
+		expr = join_args(argc - optind, argv + optind);
+		if (!expr)
+			return EXIT_FAILURE;
+
+		if (!command_filter(input_path, output_path, expr)) {
+			free(expr);
+			return EXIT_FAILURE;
+		}
+
+		free(expr);
 		break;
 
 	case EXTRACT:
@@ -600,6 +996,16 @@ int main(int argc, char *argv[])
 			fprintf(stderr, "extract type not supported\n");
 		break;
 
+	case INDEX:
+		if (argc - optind > 0) {
+			fprintf(stderr, "extra arguments not allowed\n");
+			return EXIT_FAILURE;
+		}
+
+		if (!command_index(input_path))
+			return EXIT_FAILURE;
+		break;
+
 	default:
 		usage();
 		return EXIT_FAILURE;
@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+#
+# Generate the fixed-base comb table for the P-256 code in src/shared/ecc.c.
+# Usage:
+#
+# ./tools/gen_ecc_table.py > src/shared/ecc-table.h
+#
+# Entry [i][j - 1] is j * 2^(16 * i) * G in affine coordinates, with each
+# coordinate as four 64 bit limbs, least significant first.
+
+p = 2**256 - 2**224 + 2**192 + 2**96 - 1
+gx = 0x6B17D1F2E12C4247F8BCE6E563A440F277037D812DEB33A0F4A13945D898C296
+gy = 0x4FE342E2FE1A7F9B8EE7EB4A7C0F9E162BCE33576B315ECECBB6406837BF51F5
+
+LICENSE = """\
+/*
+ * Copyright (c) 2013, Kenneth MacKay
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *  * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+"""
+
+
+def add(a, b):
+    if a is None:
+        return b
+    if b is None:
+        return a
+
+    (x1, y1), (x2, y2) = a, b
+
+    if x1 == x2:
+        if (y1 + y2) % p == 0:
+            return None
+        l = (3 * x1 * x1 - 3) * pow(2 * y1, p - 2, p) % p
+    else:
+        l = (y2 - y1) * pow(x2 - x1, p - 2, p) % p
+
+    x3 = (l * l - x1 - x2) % p
+
+    return (x3, (l * (x1 - x3) - y1) % p)
+
+
+def mul(k, point):
+    result = None
+
+    while k:
+        if k & 1:
+            result = add(result, point)
+        point = add(point, point)
+        k >>= 1
+
+    return result
+
+
+def limbs(value, first, last):
+    return ", ".join("0x%016Xull" % ((value >> (64 * k)) & (2**64 - 1))
+                     for k in range(first, last))
+
+
+print(LICENSE)
+print("/* Only to be included from ecc.c, after struct ecc_point is defined. */")
+print()
+print("/* Table of j * 2^(16 * i) * G, i = 0..15, j = 1..15, "
+      "in affine coordinates.")
+print(" * Used for fixed-base multiplication in ecc_make_key(). "
+      "Generated with")
+print(" * ./tools/gen_ecc_table.py > src/shared/ecc-table.h")
+print(" */")
+print("static const struct ecc_point curve_g_table[16][15] = {")
+
+for i in range(16):
+    base = mul(2**(16 * i), (gx, gy))
+    point = None
+
+    print("\t{")
+
+    for j in range(1, 16):
+        point = add(point, base)
+        x, y = point
+
+        print("\t\t{ { %s," % limbs(x, 0, 2))
+        print("\t\t    %s }," % limbs(x, 2, 4))
+        print("\t\t  { %s," % limbs(y, 0, 2))
+        print("\t\t    %s } }," % limbs(y, 2, 4))
+
+    print("\t},")
+
+print("};")
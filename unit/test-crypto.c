@@ -26,6 +26,7 @@
 #endif
 
 #include "src/shared/crypto.h"
+#include "src/shared/aes.h"
 #include "src/shared/util.h"
 #include "src/shared/tester.h"
 
@@ -109,6 +110,32 @@ static const struct test_data test_data_4 = {
 	.t = t_msg_4
 };
 
+/* FIPS-197 appendix C.1, in the byte order used by e() */
+static const uint8_t e_key[] = {
+	0x0f, 0x0e, 0x0d, 0x0c, 0x0b, 0x0a, 0x09, 0x08, 0x07, 0x06, 0x05, 0x04,
+	0x03, 0x02, 0x01, 0x00
+};
+
+static const uint8_t e_plaintext[] = {
+	0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44,
+	0x33, 0x22, 0x11, 0x00
+};
+
+static const uint8_t e_encrypted[] = {
+	0x5a, 0xc5, 0xb4, 0x70, 0x80, 0xb7, 0xcd, 0xd8, 0x30, 0x04, 0x7b, 0x6a,
+	0xd8, 0xe0, 0xc4, 0x69
+};
+
+/* Core specification sample data for the random address hash */
+static const uint8_t ah_irk[] = {
+	0x9b, 0x7d, 0x39, 0x0a, 0xa6, 0x10, 0x10, 0x34, 0x05, 0xad, 0xc8, 0x57,
+	0xa3, 0x34, 0x02, 0xec
+};
+
+static const uint8_t ah_prand[] = { 0x94, 0x81, 0x70 };
+
+static const uint8_t ah_hash[] = { 0xaa, 0xfb, 0x0d };
+
 static void print_debug(const char *str, void *user_data)
 {
 	tester_debug("%s", str);
@@ -143,6 +170,129 @@ static void test_sign(gconstpointer data)
 	tester_test_passed();
 }
 
+/*
+ * The same vectors run through every AES implementation. Backends that are
+ * not available here leave their tests not run.
+ */
+enum backend {
+	BACKEND_AESNI,
+	BACKEND_SOFT,
+	BACKEND_AF_ALG,
+};
+
+struct backend_test {
+	enum backend backend;
+	const struct test_data *sign;
+};
+
+static struct bt_crypto *backend_crypto;
+
+static void setup_backend(const void *data)
+{
+	const struct backend_test *test = data;
+
+	switch (test->backend) {
+	case BACKEND_AESNI:
+		if (bt_aes_set_hw(true))
+			backend_crypto = bt_crypto_new();
+		break;
+	case BACKEND_SOFT:
+		bt_aes_set_hw(false);
+		backend_crypto = bt_crypto_new();
+		break;
+	case BACKEND_AF_ALG:
+		backend_crypto = bt_crypto_new_backend(BT_CRYPTO_BACKEND_AF_ALG);
+		break;
+	}
+
+	tester_setup_complete();
+}
+
+static void teardown_backend(const void *data)
+{
+	bt_crypto_unref(backend_crypto);
+	backend_crypto = NULL;
+
+	bt_aes_set_hw(true);
+
+	tester_teardown_complete();
+}
+
+static void test_backend_e(const void *data)
+{
+	uint8_t res[16];
+
+	if (!backend_crypto) {
+		tester_test_abort();
+		return;
+	}
+
+	g_assert(bt_crypto_e(backend_crypto, e_key, e_plaintext, res));
+	g_assert(memcmp(res, e_encrypted, sizeof(res)) == 0);
+
+	tester_test_passed();
+}
+
+static void test_backend_ah(const void *data)
+{
+	uint8_t res[3];
+
+	if (!backend_crypto) {
+		tester_test_abort();
+		return;
+	}
+
+	g_assert(bt_crypto_ah(backend_crypto, ah_irk, ah_prand, res));
+	g_assert(memcmp(res, ah_hash, sizeof(res)) == 0);
+
+	tester_test_passed();
+}
+
+static void test_backend_sign(const void *data)
+{
+	const struct backend_test *test = data;
+	uint8_t t[12];
+
+	if (!backend_crypto) {
+		tester_test_abort();
+		return;
+	}
+
+	memset(t, 0, sizeof(t));
+
+	g_assert(bt_crypto_sign_att(backend_crypto, key, test->sign->msg,
+					test->sign->msg_len, 0, t));
+	g_assert(result_compare(test->sign->t, t));
+
+	tester_test_passed();
+}
+
+#define define_backend_test(name, _backend, _sign, func)		\
+	do {								\
+		static const struct backend_test data = {		\
+			.backend = _backend,				\
+			.sign = _sign,					\
+		};							\
+		tester_add(name, &data, setup_backend, func,		\
+							teardown_backend);	\
+	} while (0)
+
+#define define_backend(prefix, backend)					\
+	do {								\
+		define_backend_test(prefix "/e", backend, NULL,		\
+							test_backend_e);	\
+		define_backend_test(prefix "/ah", backend, NULL,	\
+							test_backend_ah);	\
+		define_backend_test(prefix "/sign_att_1", backend,	\
+					&test_data_1, test_backend_sign);	\
+		define_backend_test(prefix "/sign_att_2", backend,	\
+					&test_data_2, test_backend_sign);	\
+		define_backend_test(prefix "/sign_att_3", backend,	\
+					&test_data_3, test_backend_sign);	\
+		define_backend_test(prefix "/sign_att_4", backend,	\
+					&test_data_4, test_backend_sign);	\
+	} while (0)
+
 int main(int argc, char *argv[])
 {
 	int exit_status;
@@ -158,6 +308,10 @@ int main(int argc, char *argv[])
 	tester_add("/crypto/sign_att_3", &test_data_3, NULL, test_sign, NULL);
 	tester_add("/crypto/sign_att_4", &test_data_4, NULL, test_sign, NULL);
 
+	define_backend("/crypto/aes-ni", BACKEND_AESNI);
+	define_backend("/crypto/soft", BACKEND_SOFT);
+	define_backend("/crypto/af_alg", BACKEND_AF_ALG);
+
 	exit_status = tester_run();
 
 	bt_crypto_unref(crypto);
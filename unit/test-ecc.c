@@ -243,6 +243,82 @@ static void test_sample_3(const void *data)
 	tester_test_passed();
 }
 
+/* P-256 generator G, little endian like all keys passed to ecc.h */
+static const uint8_t generator[64] = {
+				0x96, 0xc2, 0x98, 0xd8, 0x45, 0x39, 0xa1, 0xf4,
+				0xa0, 0x33, 0xeb, 0x2d, 0x81, 0x7d, 0x03, 0x77,
+				0xf2, 0x40, 0xa4, 0x63, 0xe5, 0xe6, 0xbc, 0xf8,
+				0x47, 0x42, 0x2c, 0xe1, 0xf2, 0xd1, 0x17, 0x6b,
+
+				0xf5, 0x51, 0xbf, 0x37, 0x68, 0x40, 0xb6, 0xcb,
+				0xce, 0x5e, 0x31, 0x6b, 0x57, 0x33, 0xce, 0x2b,
+				0x16, 0x9e, 0x0f, 0x7c, 0x4a, 0xeb, 0xe7, 0x8e,
+				0x9b, 0x7f, 0x1a, 0xfe, 0xe2, 0x42, 0xe3, 0x4f,
+};
+
+/* Field prime p, little endian */
+static const uint8_t prime[32] = {
+				0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+				0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00,
+				0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+				0x01, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff,
+};
+
+/* ecc_make_key uses the fixed-base comb table while ecdh_shared_secret
+ * runs the generic ladder, so priv * G must come out the same from both.
+ */
+static void test_base(const void *data)
+{
+	uint8_t public_key[64], private_key[32], x[32];
+	int i;
+
+	for (i = 0; i < PAIR_COUNT; i++) {
+		g_assert(ecc_make_key(public_key, private_key));
+		g_assert(ecdh_shared_secret(generator, private_key, x));
+
+		if (memcmp(x, public_key, 32)) {
+			print_buf("Private", private_key, 32);
+			print_buf("Public ", public_key, 64);
+			print_buf("Ladder ", x, 32);
+		}
+
+		g_assert(memcmp(x, public_key, 32) == 0);
+	}
+
+	tester_test_passed();
+}
+
+static void test_invalid(const void *data)
+{
+	uint8_t public_key[64], private_key[32], key[64], secret[32];
+
+	g_assert(ecc_make_key(public_key, private_key));
+
+	/* Off the curve */
+	memcpy(key, public_key, 64);
+	key[32] ^= 0x01;
+	g_assert(!ecdh_shared_secret(key, private_key, secret));
+
+	/* Point at infinity */
+	memset(key, 0, 64);
+	g_assert(!ecdh_shared_secret(key, private_key, secret));
+
+	/* Coordinates not reduced modulo p */
+	memcpy(key, prime, 32);
+	memcpy(&key[32], &generator[32], 32);
+	g_assert(!ecdh_shared_secret(key, private_key, secret));
+
+	memcpy(key, generator, 32);
+	memcpy(&key[32], prime, 32);
+	g_assert(!ecdh_shared_secret(key, private_key, secret));
+
+	/* Zero private key */
+	memset(private_key, 0, 32);
+	g_assert(!ecdh_shared_secret(public_key, private_key, secret));
+
+	tester_test_passed();
+}
+
 int main(int argc, char *argv[])
 {
 	tester_init(&argc, &argv);
@@ -253,5 +329,8 @@ int main(int argc, char *argv[])
 	tester_add("/ecdh/sample/2", NULL, NULL, test_sample_2, NULL);
 	tester_add("/ecdh/sample/3", NULL, NULL, test_sample_3, NULL);
 
+	tester_add("/ecdh/base", NULL, NULL, test_base, NULL);
+	tester_add("/ecdh/invalid", NULL, NULL, test_invalid, NULL);
+
 	return tester_run();
 }
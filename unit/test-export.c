@@ -0,0 +1,290 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "src/shared/util.h"
+#include "src/shared/btsnoop.h"
+#include "src/shared/tester.h"
+#include "monitor/packet.h"
+#include "monitor/l2cap.h"
+#include "monitor/export.h"
+
+#include <glib.h>
+
+struct capture_pkt {
+	struct timeval tv;
+	uint16_t index;
+	uint16_t opcode;
+	const void *data;
+	uint16_t size;
+};
+
+struct export_data {
+	const char *format;
+	const struct capture_pkt *pkts;
+	size_t num_pkts;
+	const void *expect;
+	size_t expect_len;
+};
+
+/* Names come from the decoders in btmon, only what the capture needs */
+const char *packet_opcode_str(uint16_t opcode)
+{
+	return opcode == 0x0c03 ? "Reset" : NULL;
+}
+
+const char *packet_event_str(uint8_t event)
+{
+	switch (event) {
+	case 0x0e:
+		return "Command Complete";
+	case 0x3e:
+		return "LE Meta Event";
+	}
+
+	return NULL;
+}
+
+const char *packet_subevent_str(uint8_t subevent)
+{
+	return subevent == 0x02 ? "LE Advertising Report" : NULL;
+}
+
+const char *l2cap_att_opcode_str(uint8_t opcode)
+{
+	return opcode == 0x12 ? "Write Request" : NULL;
+}
+
+static const uint8_t new_index_0[] = {
+	0x00, 0x00,				/* Primary, virtual */
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05,	/* 05:04:03:02:01:00 */
+	'h', 'c', 'i', '0', 0x00, 0x00, 0x00, 0x00,
+};
+
+static const uint8_t reset_cmd[] = { 0x03, 0x0c, 0x00 };
+
+static const uint8_t reset_rsp[] = { 0x0e, 0x04, 0x01, 0x03, 0x0c, 0x00 };
+
+static const uint8_t adv_report[] = {
+	0x3e, 0x0f, 0x02, 0x01,			/* One report */
+	0x00, 0x01,				/* ADV_IND, random */
+	0xc0, 0xde, 0x00, 0x11, 0x22, 0xc3,	/* C3:22:11:00:DE:C0 */
+	0x03, 0x02, 0x01, 0x06,			/* Flags */
+	0xc4,					/* -60 dBm */
+};
+
+static const uint8_t write_req[] = {
+	0x40, 0x20, 0x08, 0x00,			/* Handle 0x0040, start */
+	0x04, 0x00, 0x04, 0x00,			/* ATT */
+	0x12, 0x03, 0x00, 0x01,			/* Write 0x01 to 0x0003 */
+};
+
+static const struct capture_pkt capture[] = {
+	{ { 1, 0 }, 0, BTSNOOP_OPCODE_NEW_INDEX,
+				new_index_0, sizeof(new_index_0) },
+	{ { 1, 100 }, 0, BTSNOOP_OPCODE_COMMAND_PKT,
+				reset_cmd, sizeof(reset_cmd) },
+	{ { 1, 200 }, 0, BTSNOOP_OPCODE_EVENT_PKT,
+				reset_rsp, sizeof(reset_rsp) },
+	{ { 2, 0 }, 0, BTSNOOP_OPCODE_EVENT_PKT,
+				adv_report, sizeof(adv_report) },
+	{ { 2, 999999 }, 0, BTSNOOP_OPCODE_ACL_TX_PKT,
+				write_req, sizeof(write_req) },
+	{ { 3, 0 }, 0, BTSNOOP_OPCODE_DEL_INDEX, NULL, 0 },
+};
+
+static const char capture_json[] =
+	"{\"ts\":1.000000,\"index\":0,\"type\":\"new_index\","
+		"\"controller_type\":0,\"bus\":0,"
+		"\"addr\":\"05:04:03:02:01:00\",\"addr_type\":0,"
+		"\"name\":\"hci0\"}\n"
+	"{\"ts\":1.000100,\"index\":0,\"type\":\"cmd\",\"dir\":\"tx\","
+		"\"opcode\":3075,\"name\":\"Reset\",\"length\":0}\n"
+	"{\"ts\":1.000200,\"index\":0,\"type\":\"evt\",\"dir\":\"rx\","
+		"\"event\":14,\"name\":\"Command Complete\","
+		"\"opcode\":3075,\"command\":\"Reset\",\"status\":0}\n"
+	"{\"ts\":2.000000,\"index\":0,\"type\":\"evt\",\"dir\":\"rx\","
+		"\"event\":62,\"name\":\"LE Meta Event\",\"subevent\":2,"
+		"\"subevent_name\":\"LE Advertising Report\",\"reports\":"
+		"[{\"addr\":\"C3:22:11:00:DE:C0\",\"addr_type\":1,"
+		"\"adv_type\":0,\"rssi\":-60,"
+		"\"ad\":[{\"type\":1,\"data\":\"06\"}]}]}\n"
+	"{\"ts\":2.999999,\"index\":0,\"type\":\"acl\",\"dir\":\"tx\","
+		"\"handle\":64,\"length\":8,\"cid\":4,\"att_opcode\":18,"
+		"\"att_name\":\"Write Request\",\"att_handle\":3}\n"
+	"{\"ts\":3.000000,\"index\":0,\"type\":\"del_index\"}\n";
+
+static const uint8_t capture_binary[] = {
+	/* New Index */
+	0x1b, 0x00,
+	0x01, 0x08, 0x40, 0x42, 0x0f, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x02, 0x02, 0x00, 0x00,
+	0x03, 0x02, 0x00, 0x00,
+	0x0e, 0x07, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x00,
+	/* Reset */
+	0x1c, 0x00,
+	0x01, 0x08, 0xa4, 0x42, 0x0f, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x02, 0x02, 0x00, 0x00,
+	0x03, 0x02, 0x02, 0x00,
+	0x04, 0x01, 0x00,
+	0x05, 0x02, 0x03, 0x0c,
+	0x0a, 0x01, 0x00,
+	/* Command Complete */
+	0x1f, 0x00,
+	0x01, 0x08, 0x08, 0x43, 0x0f, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x02, 0x02, 0x00, 0x00,
+	0x03, 0x02, 0x03, 0x00,
+	0x04, 0x01, 0x01,
+	0x06, 0x01, 0x0e,
+	0x05, 0x02, 0x03, 0x0c,
+	0x08, 0x01, 0x00,
+	/* LE Advertising Report */
+	0x2e, 0x00,
+	0x01, 0x08, 0x80, 0x84, 0x1e, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x02, 0x02, 0x00, 0x00,
+	0x03, 0x02, 0x03, 0x00,
+	0x04, 0x01, 0x01,
+	0x06, 0x01, 0x3e,
+	0x07, 0x01, 0x02,
+	0x0e, 0x07, 0xc0, 0xde, 0x00, 0x11, 0x22, 0xc3, 0x01,
+	0x0f, 0x01, 0x00,
+	0x10, 0x01, 0xc4,
+	0x11, 0x02, 0x01, 0x06,
+	/* Write Request */
+	0x28, 0x00,
+	0x01, 0x08, 0xbf, 0xc6, 0x2d, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x02, 0x02, 0x00, 0x00,
+	0x03, 0x02, 0x04, 0x00,
+	0x04, 0x01, 0x00,
+	0x09, 0x02, 0x40, 0x00,
+	0x0a, 0x02, 0x08, 0x00,
+	0x0b, 0x02, 0x04, 0x00,
+	0x0c, 0x01, 0x12,
+	0x0d, 0x02, 0x03, 0x00,
+	/* Delete Index */
+	0x12, 0x00,
+	0x01, 0x08, 0xc0, 0xc6, 0x2d, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x02, 0x02, 0x00, 0x00,
+	0x03, 0x02, 0x01, 0x00,
+};
+
+static const struct export_data export_json = {
+	.format = "json",
+	.pkts = capture,
+	.num_pkts = G_N_ELEMENTS(capture),
+	.expect = capture_json,
+	.expect_len = sizeof(capture_json) - 1,
+};
+
+static const struct export_data export_binary = {
+	.format = "binary",
+	.pkts = capture,
+	.num_pkts = G_N_ELEMENTS(capture),
+	.expect = capture_binary,
+	.expect_len = sizeof(capture_binary),
+};
+
+static const uint8_t new_index_utf8[] = {
+	0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	'h', 0xc3, 0xa9, '"', 0x01, 0xff, 0xe2, 0x82,	/* Cut before end */
+};
+
+static const struct capture_pkt capture_utf8[] = {
+	{ { 0, 0 }, 1, BTSNOOP_OPCODE_NEW_INDEX,
+				new_index_utf8, sizeof(new_index_utf8) },
+};
+
+static const char utf8_json[] =
+	"{\"ts\":0.000000,\"index\":1,\"type\":\"new_index\","
+		"\"controller_type\":0,\"bus\":0,"
+		"\"addr\":\"00:00:00:00:00:00\",\"addr_type\":0,"
+		"\"name\":\"h\xc3\xa9\\\"\\u0001\\u00ff\\u00e2\\u0082\"}\n";
+
+static const struct export_data export_utf8 = {
+	.format = "json",
+	.pkts = capture_utf8,
+	.num_pkts = G_N_ELEMENTS(capture_utf8),
+	.expect = utf8_json,
+	.expect_len = sizeof(utf8_json) - 1,
+};
+
+static void test_export(gconstpointer data)
+{
+	const struct export_data *test_data = data;
+	struct capture_pkt pkt;
+	uint8_t buf[1024];
+	size_t i, len;
+	FILE *fp;
+	int fd;
+
+	g_assert(export_set_format(test_data->format));
+
+	/* Records are written to stdout */
+	fp = tmpfile();
+	g_assert(fp);
+
+	fflush(stdout);
+	fd = dup(STDOUT_FILENO);
+	g_assert(fd >= 0);
+	g_assert(dup2(fileno(fp), STDOUT_FILENO) >= 0);
+
+	for (i = 0; i < test_data->num_pkts; i++) {
+		pkt = test_data->pkts[i];
+
+		g_assert(export_packet(&pkt.tv, pkt.index, pkt.opcode,
+							pkt.data, pkt.size));
+	}
+
+	fflush(stdout);
+	dup2(fd, STDOUT_FILENO);
+	close(fd);
+
+	rewind(fp);
+	len = fread(buf, 1, sizeof(buf), fp);
+	fclose(fp);
+
+	tester_debug("Exported %zu bytes, expected %zu", len,
+						test_data->expect_len);
+
+	g_assert(len == test_data->expect_len);
+	g_assert(!memcmp(buf, test_data->expect, len));
+
+	tester_test_passed();
+}
+
+int main(int argc, char *argv[])
+{
+	tester_init(&argc, &argv);
+
+	tester_add("/export/json", &export_json, NULL, test_export, NULL);
+	tester_add("/export/binary", &export_binary, NULL, test_export, NULL);
+	tester_add("/export/utf8", &export_utf8, NULL, test_export, NULL);
+
+	return tester_run();
+}
@@ -26,6 +26,7 @@
 #endif
 
 #include <unistd.h>
+#include <errno.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <inttypes.h>
@@ -2055,6 +2056,49 @@ static const struct test_step test_multiple_read_6 = {
 	.expected_att_ecode = 0x0c
 };
 
+static void test_multiple_read_variable(struct context *context)
+{
+	const struct test_step *step = context->data->step;
+	uint16_t handles[2];
+
+	handles[0] = step->handle;
+	handles[1] = step->end_handle;
+
+	g_assert(bt_gatt_client_read_multiple_variable(context->client,
+						handles, 2, multiple_read_cb,
+						context, NULL));
+}
+
+static const uint8_t read_mult_vl_data_1[] = { 0x03, 0x00, 0x01, 0x02, 0x03,
+						0x02, 0x00, 0x04, 0x05 };
+
+/* The last value is longer than what fits the response */
+static const uint8_t read_mult_vl_data_2[] = { 0x03, 0x00, 0x01, 0x02, 0x03,
+						0x20, 0x00, 0x04, 0x05 };
+
+static const struct test_step test_multiple_read_variable_1 = {
+	.handle = 0x0003,
+	.end_handle = 0x0007,
+	.func = test_multiple_read_variable,
+	.value = read_mult_vl_data_1,
+	.length = sizeof(read_mult_vl_data_1)
+};
+
+static const struct test_step test_multiple_read_variable_2 = {
+	.handle = 0x0003,
+	.end_handle = 0x0007,
+	.func = test_multiple_read_variable,
+	.value = read_mult_vl_data_2,
+	.length = sizeof(read_mult_vl_data_2)
+};
+
+static const struct test_step test_multiple_read_variable_3 = {
+	.handle = 0x0003,
+	.end_handle = 0x0007,
+	.func = test_multiple_read_variable,
+	.expected_att_ecode = 0x02
+};
+
 static void read_by_type_cb(bool success, uint8_t att_ecode,
 						struct bt_gatt_result *result,
 						void *user_data)
@@ -2254,6 +2298,76 @@ static const struct test_step test_notification_server_1 = {
 	.length = 0x03,
 };
 
+static const uint8_t nfy_mult_data_1[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06 };
+static const uint8_t nfy_mult_data_2[] = { 0x11, 0x12, 0x13, 0x14 };
+static const uint8_t nfy_mult_data_3[] = { 0x21, 0x22, 0x23, 0x24, 0x25, 0x26,
+						0x27, 0x28 };
+static const uint8_t nfy_mult_data_4[] = { 0x31, 0x32 };
+
+/* Longer than any notification at the default MTU */
+static const uint8_t nfy_mult_data_5[] = {
+	0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a,
+	0x4b, 0x4c, 0x4d, 0x4e, 0x4f, 0x50, 0x51, 0x52, 0x53, 0x54,
+	0x55, 0x56, 0x57, 0x58, 0x59 };
+
+static const uint16_t nfy_mult_handles[] = { 0x0003, 0x0005, 0x0007,
+								0x0009 };
+
+static void test_server_multiple_notification(struct context *context)
+{
+	const struct test_step *step = context->data->step;
+	const struct test_pdu *pdu;
+	struct iovec values[4];
+
+	/* Later empty PDUs only wait for the next notification */
+	pdu = &context->data->pdu_list[context->pdu_offset - 2];
+	if (pdu->data[0] != BT_ATT_OP_WRITE_RSP)
+		return;
+
+	values[0].iov_base = (void *) nfy_mult_data_1;
+	values[0].iov_len = sizeof(nfy_mult_data_1);
+	values[1].iov_base = (void *) nfy_mult_data_2;
+	values[1].iov_len = sizeof(nfy_mult_data_2);
+	values[2].iov_base = (void *) nfy_mult_data_3;
+	values[2].iov_len = sizeof(nfy_mult_data_3);
+	values[3].iov_base = (void *) nfy_mult_data_4;
+	values[3].iov_len = sizeof(nfy_mult_data_4);
+
+	/* The step sends the first handle values, its value replaces the second
+	 * one if set.
+	 */
+	if (step->value) {
+		values[1].iov_base = (void *) step->value;
+		values[1].iov_len = step->length;
+	}
+
+	g_assert(bt_gatt_server_send_multiple_notifications(context->server,
+						nfy_mult_handles, values,
+						step->handle));
+}
+
+static const struct test_step test_multiple_notification_server_1 = {
+	.handle = 4,
+	.func = test_server_multiple_notification,
+};
+
+static const struct test_step test_multiple_notification_server_2 = {
+	.handle = 1,
+	.func = test_server_multiple_notification,
+};
+
+static const struct test_step test_multiple_notification_server_3 = {
+	.handle = 2,
+	.func = test_server_multiple_notification,
+	.value = nfy_mult_data_5,
+	.length = sizeof(nfy_mult_data_5),
+};
+
+static const struct test_step test_multiple_notification_server_4 = {
+	.handle = 2,
+	.func = test_server_multiple_notification,
+};
+
 static uint8_t indication_received;
 
 static void test_indication_cb(void *user_data)
@@ -2318,6 +2432,288 @@ static const struct test_step test_indication_server_1 = {
 	.length = 0x03,
 };
 
+#define BURST_COUNT 64
+
+struct burst_context {
+	struct bt_att *att;
+	uint16_t received;
+};
+
+static gboolean burst_fill(GIOChannel *channel, GIOCondition cond,
+							gpointer user_data)
+{
+	int fd = g_io_channel_unix_get_fd(channel);
+	uint8_t junk = 0x00;
+
+	/* Runs right before the ATT writer in the same main loop iteration
+	 * and leaves the socket full, so the writer is woken up with nothing
+	 * but EAGAIN to show for it.
+	 */
+	while (write(fd, &junk, 1) == 1);
+
+	g_assert(errno == EAGAIN);
+
+	return FALSE;
+}
+
+static gboolean burst_handler(GIOChannel *channel, GIOCondition cond,
+							gpointer user_data)
+{
+	struct burst_context *burst = user_data;
+	unsigned int wakeups, pdus;
+	uint8_t buf[16];
+	ssize_t len;
+
+	g_assert(!(cond & (G_IO_NVAL | G_IO_ERR | G_IO_HUP)));
+
+	len = read(g_io_channel_unix_get_fd(channel), buf, sizeof(buf));
+
+	/* Filler written by burst_fill */
+	if (len == 1)
+		return TRUE;
+
+	/* Every notification arrives once and in the order it was queued */
+	g_assert_cmpint(len, ==, 5);
+	g_assert_cmpint(buf[0], ==, BT_ATT_OP_HANDLE_VAL_NOT);
+	g_assert_cmpint(get_le16(buf + 1), ==, 0x0003);
+	g_assert_cmpint(get_le16(buf + 3), ==, burst->received);
+
+	if (++burst->received < BURST_COUNT)
+		return TRUE;
+
+	g_assert(bt_att_get_write_stats(burst->att, &wakeups, &pdus));
+	g_assert_cmpint(pdus, ==, BURST_COUNT);
+
+	bt_att_unref(burst->att);
+	g_free(burst);
+
+	tester_test_passed();
+
+	return FALSE;
+}
+
+static void test_notification_burst(gconstpointer data)
+{
+	struct burst_context *burst = g_new0(struct burst_context, 1);
+	GIOChannel *channel;
+	guint source;
+	int err, sv[2], size = 1;
+	uint16_t i;
+
+	err = socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv);
+	g_assert(err == 0);
+
+	/* Keep the send buffer tiny and non-blocking so that the burst does
+	 * not fit in one go.
+	 */
+	err = setsockopt(sv[0], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+	g_assert(err == 0);
+
+	err = fcntl(sv[0], F_SETFL, fcntl(sv[0], F_GETFL) | O_NONBLOCK);
+	g_assert(err == 0);
+
+	channel = g_io_channel_unix_new(sv[0]);
+
+	g_io_channel_set_encoding(channel, NULL, NULL);
+	g_io_channel_set_buffered(channel, FALSE);
+
+	source = g_io_add_watch(channel, G_IO_OUT, burst_fill, NULL);
+	g_assert(source > 0);
+
+	g_io_channel_unref(channel);
+
+	burst->att = bt_att_new(sv[0], false);
+	g_assert(burst->att);
+
+	bt_att_set_close_on_unref(burst->att, true);
+	bt_att_set_debug(burst->att, print_debug, "bt_att:", NULL);
+
+	for (i = 0; i < BURST_COUNT; i++) {
+		uint8_t pdu[4];
+
+		put_le16(0x0003, pdu);
+		put_le16(i, pdu + 2);
+
+		g_assert(bt_att_send(burst->att, BT_ATT_OP_HANDLE_VAL_NOT,
+						pdu, sizeof(pdu), NULL, NULL,
+						NULL));
+	}
+
+	channel = g_io_channel_unix_new(sv[1]);
+
+	g_io_channel_set_close_on_unref(channel, TRUE);
+	g_io_channel_set_encoding(channel, NULL, NULL);
+	g_io_channel_set_buffered(channel, FALSE);
+
+	source = g_io_add_watch(channel,
+				G_IO_IN | G_IO_HUP | G_IO_ERR | G_IO_NVAL,
+				burst_handler, burst);
+	g_assert(source > 0);
+
+	g_io_channel_unref(channel);
+}
+
+struct conf_context {
+	struct bt_att *att;
+	int fixed_fd;
+	int eatt_fd;
+	guint eatt_source;
+	bool eatt_confirmed;
+};
+
+static void conf_ind_cb(uint8_t opcode, const void *pdu, uint16_t length,
+							void *user_data)
+{
+	struct conf_context *conf = user_data;
+	const uint8_t ind[] = { BT_ATT_OP_HANDLE_VAL_IND, 0x02, 0x00 };
+
+	g_assert_cmpint(length, ==, 2);
+
+	/* Leave the one from the fixed bearer unconfirmed and have the
+	 * enhanced bearer indicate meanwhile.
+	 */
+	if (get_le16(pdu) == 0x0001) {
+		g_assert_cmpint(write(conf->eatt_fd, ind, sizeof(ind)), ==,
+								sizeof(ind));
+		return;
+	}
+
+	g_assert(bt_att_send(conf->att, BT_ATT_OP_HANDLE_VAL_CONF, NULL, 0,
+							NULL, NULL, NULL));
+}
+
+static gboolean conf_handler(GIOChannel *channel, GIOCondition cond,
+							gpointer user_data)
+{
+	struct conf_context *conf = user_data;
+	int fd = g_io_channel_unix_get_fd(channel);
+	uint8_t buf[16];
+	ssize_t len;
+
+	g_assert(!(cond & (G_IO_NVAL | G_IO_ERR | G_IO_HUP)));
+
+	len = read(fd, buf, sizeof(buf));
+
+	g_assert_cmpint(len, ==, 1);
+	g_assert_cmpint(buf[0], ==, BT_ATT_OP_HANDLE_VAL_CONF);
+
+	/* The enhanced bearer is confirmed first, then the fixed one once
+	 * its deferred confirmation is sent.
+	 */
+	if (fd == conf->eatt_fd) {
+		g_assert(!conf->eatt_confirmed);
+		conf->eatt_confirmed = true;
+
+		g_assert(bt_att_send(conf->att, BT_ATT_OP_HANDLE_VAL_CONF,
+						NULL, 0, NULL, NULL, NULL));
+		return TRUE;
+	}
+
+	g_assert(fd == conf->fixed_fd);
+	g_assert(conf->eatt_confirmed);
+
+	g_source_remove(conf->eatt_source);
+	bt_att_unref(conf->att);
+	g_free(conf);
+
+	tester_test_passed();
+
+	return FALSE;
+}
+
+static guint conf_watch(struct conf_context *conf, int fd)
+{
+	GIOChannel *channel;
+	guint source;
+
+	channel = g_io_channel_unix_new(fd);
+
+	g_io_channel_set_close_on_unref(channel, TRUE);
+	g_io_channel_set_encoding(channel, NULL, NULL);
+	g_io_channel_set_buffered(channel, FALSE);
+
+	source = g_io_add_watch(channel,
+				G_IO_IN | G_IO_HUP | G_IO_ERR | G_IO_NVAL,
+				conf_handler, conf);
+	g_assert(source > 0);
+
+	g_io_channel_unref(channel);
+
+	return source;
+}
+
+static void test_eatt_confirmation(gconstpointer data)
+{
+	struct conf_context *conf = g_new0(struct conf_context, 1);
+	const uint8_t ind[] = { BT_ATT_OP_HANDLE_VAL_IND, 0x01, 0x00 };
+	int err, sv[2], ev[2];
+
+	err = socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv);
+	g_assert(err == 0);
+
+	err = socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, ev);
+	g_assert(err == 0);
+
+	conf->att = bt_att_new(sv[0], false);
+	g_assert(conf->att);
+
+	bt_att_set_close_on_unref(conf->att, true);
+	bt_att_set_debug(conf->att, print_debug, "bt_att:", NULL);
+
+	g_assert(bt_att_attach_fd(conf->att, ev[0]) == 0);
+
+	g_assert(bt_att_register(conf->att, BT_ATT_OP_HANDLE_VAL_IND,
+						conf_ind_cb, conf, NULL));
+
+	conf->fixed_fd = sv[1];
+	conf->eatt_fd = ev[1];
+
+	conf_watch(conf, sv[1]);
+	conf->eatt_source = conf_watch(conf, ev[1]);
+
+	g_assert_cmpint(write(sv[1], ind, sizeof(ind)), ==, sizeof(ind));
+}
+
+static struct gatt_db *make_gatt_service_db(void)
+{
+	struct gatt_db *db = gatt_db_new();
+
+	g_assert(bt_gatt_server_add_gatt_service(db));
+
+	return db;
+}
+
+static void test_robust_caching_change(struct context *context)
+{
+	static const uint8_t key[16] = { 0 };
+	struct gatt_db_attribute *service;
+	bt_uuid_t uuid;
+
+	/* Let Signed Write Commands reach the server */
+	bt_att_set_remote_key(context->att, (uint8_t *) key, local_counter,
+									NULL);
+
+	bt_uuid16_create(&uuid, 0x180f);
+	service = gatt_db_add_service(context->server_db, &uuid, true, 1);
+	g_assert(service);
+	gatt_db_service_set_active(service, true);
+
+	context_process(context);
+}
+
+static const struct test_step test_robust_caching_change_1 = {
+	.func = test_robust_caching_change,
+};
+
+static void test_robust_caching_client(struct context *context)
+{
+	/* Features are written once ready, wait for the Write Request */
+}
+
+static const struct test_step test_robust_caching_client_1 = {
+	.func = test_robust_caching_client,
+};
+
 int main(int argc, char *argv[])
 {
 	struct gatt_db *service_db_1, *service_db_2, *service_db_3;
@@ -3093,6 +3489,27 @@ int main(int argc, char *argv[])
 			raw_pdu(0x0e, 0x03, 0x00, 0x07, 0x00),
 			raw_pdu(0x01, 0x0e, 0x03, 0x00, 0x0c));
 
+	define_test_client("/read-multiple-variable/client", test_client,
+			service_db_1, &test_multiple_read_variable_1,
+			SERVICE_DATA_1_PDUS,
+			raw_pdu(0x20, 0x03, 0x00, 0x07, 0x00),
+			raw_pdu(0x21, 0x03, 0x00, 0x01, 0x02, 0x03, 0x02, 0x00,
+				0x04, 0x05));
+
+	define_test_client("/read-multiple-variable/client/truncated",
+			test_client, service_db_1,
+			&test_multiple_read_variable_2,
+			SERVICE_DATA_1_PDUS,
+			raw_pdu(0x20, 0x03, 0x00, 0x07, 0x00),
+			raw_pdu(0x21, 0x03, 0x00, 0x01, 0x02, 0x03, 0x20, 0x00,
+				0x04, 0x05));
+
+	define_test_client("/read-multiple-variable/client/error", test_client,
+			service_db_1, &test_multiple_read_variable_3,
+			SERVICE_DATA_1_PDUS,
+			raw_pdu(0x20, 0x03, 0x00, 0x07, 0x00),
+			raw_pdu(0x01, 0x20, 0x03, 0x00, 0x02));
+
 	define_test_server("/TP/GAR/SR/BV-05-C/small", test_server,
 			ts_small_db, NULL,
 			raw_pdu(0x03, 0x00, 0x02),
@@ -3125,6 +3542,27 @@ int main(int argc, char *argv[])
 			raw_pdu(0x0e, 0x44, 0x00, 0xF0, 0x0F),
 			raw_pdu(0x01, 0x0e, 0xF0, 0x0F, 0x01));
 
+	define_test_server("/read-multiple-variable/server", test_server,
+			ts_small_db, NULL,
+			raw_pdu(0x03, 0x00, 0x02),
+			raw_pdu(0x20, 0x15, 0xF0, 0x03, 0x00),
+			raw_pdu(0x21, 0x01, 0x00, 0x09, 0x05, 0x00, 'B', 'l',
+				'u', 'e', 'Z'));
+
+	define_test_server("/read-multiple-variable/server/truncated",
+			test_server, ts_small_db, NULL,
+			raw_pdu(0x03, 0x00, 0x02),
+			raw_pdu(0x20, 0x03, 0x00, 0x13, 0xF0),
+			raw_pdu(0x21, 0x05, 0x00, 'B', 'l', 'u', 'e', 'Z', 0x11,
+				0x00, 'B', 'l', 'u', 'e', 'Z', ' ', 'U', 'n',
+				'i', 't', ' ', 'T', 'e'));
+
+	define_test_server("/read-multiple-variable/server/error",
+			test_server, ts_small_db, NULL,
+			raw_pdu(0x03, 0x00, 0x02),
+			raw_pdu(0x20, 0x03, 0x00, 0xF0, 0x0F),
+			raw_pdu(0x01, 0x20, 0xF0, 0x0F, 0x01));
+
 	define_test_server("/TP/GAR/SR/BV-06-C/small", test_server,
 			ts_small_db, NULL,
 			raw_pdu(0x03, 0x00, 0x02),
@@ -3233,6 +3671,78 @@ int main(int argc, char *argv[])
 			raw_pdu(),
 			raw_pdu(0x1B, 0x03, 0x00, 0x01, 0x02, 0x03));
 
+	define_test_client("/multiple-notification/client", test_client,
+			ts_small_db, &test_notification_1,
+			MTU_EXCHANGE_CLIENT_PDUS,
+			SMALL_DB_DISCOVERY_PDUS,
+			raw_pdu(0x12, 0x04, 0x00, 0x03, 0x00),
+			raw_pdu(0x13),
+			raw_pdu(),
+			raw_pdu(0x23, 0x05, 0x00, 0x02, 0x00, 0xaa, 0xbb, 0x03,
+				0x00, 0x03, 0x00, 0x01, 0x02, 0x03));
+
+	define_test_client("/multiple-notification/client/truncated",
+			test_client, ts_small_db, &test_notification_1,
+			MTU_EXCHANGE_CLIENT_PDUS,
+			SMALL_DB_DISCOVERY_PDUS,
+			raw_pdu(0x12, 0x04, 0x00, 0x03, 0x00),
+			raw_pdu(0x13),
+			raw_pdu(),
+			raw_pdu(0x23, 0x03, 0x00, 0x05, 0x00, 0x01, 0x02, 0x03),
+			raw_pdu(),
+			raw_pdu(0x1B, 0x03, 0x00, 0x01, 0x02, 0x03));
+
+	define_test_server("/multiple-notification/server", test_server,
+			make_gatt_service_db(),
+			&test_multiple_notification_server_1,
+			raw_pdu(0x03, 0x00, 0x02),
+			raw_pdu(0x12, 0x03, 0x00, 0x04),
+			raw_pdu(0x13),
+			raw_pdu(),
+			raw_pdu(0x23, 0x03, 0x00, 0x06, 0x00, 0x01, 0x02, 0x03,
+				0x04, 0x05, 0x06, 0x05, 0x00, 0x04, 0x00, 0x11,
+				0x12, 0x13, 0x14),
+			raw_pdu(),
+			raw_pdu(0x23, 0x07, 0x00, 0x08, 0x00, 0x21, 0x22, 0x23,
+				0x24, 0x25, 0x26, 0x27, 0x28, 0x09, 0x00, 0x02,
+				0x00, 0x31, 0x32));
+
+	define_test_server("/multiple-notification/server/single",
+			test_server, make_gatt_service_db(),
+			&test_multiple_notification_server_2,
+			raw_pdu(0x03, 0x00, 0x02),
+			raw_pdu(0x12, 0x03, 0x00, 0x04),
+			raw_pdu(0x13),
+			raw_pdu(),
+			raw_pdu(0x1B, 0x03, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05,
+				0x06));
+
+	define_test_server("/multiple-notification/server/long",
+			test_server, make_gatt_service_db(),
+			&test_multiple_notification_server_3,
+			raw_pdu(0x03, 0x00, 0x02),
+			raw_pdu(0x12, 0x03, 0x00, 0x04),
+			raw_pdu(0x13),
+			raw_pdu(),
+			raw_pdu(0x1B, 0x03, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05,
+				0x06),
+			raw_pdu(),
+			raw_pdu(0x1B, 0x05, 0x00, 0x41, 0x42, 0x43, 0x44, 0x45,
+				0x46, 0x47, 0x48, 0x49, 0x4a, 0x4b, 0x4c, 0x4d,
+				0x4e, 0x4f, 0x50, 0x51, 0x52, 0x53, 0x54));
+
+	define_test_server("/multiple-notification/server/disabled",
+			test_server, make_gatt_service_db(),
+			&test_multiple_notification_server_4,
+			raw_pdu(0x03, 0x00, 0x02),
+			raw_pdu(0x12, 0x03, 0x00, 0x01),
+			raw_pdu(0x13),
+			raw_pdu(),
+			raw_pdu(0x1B, 0x03, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05,
+				0x06),
+			raw_pdu(),
+			raw_pdu(0x1B, 0x05, 0x00, 0x11, 0x12, 0x13, 0x14));
+
 	define_test_server("/TP/GAI/SR/BV-01-C", test_server, ts_small_db,
 			&test_indication_server_1,
 			raw_pdu(0x03, 0x00, 0x02),
@@ -4425,5 +4935,81 @@ int main(int argc, char *argv[])
 				0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff),
 			raw_pdu(0x01, 0x16, 0x04, 0x00, 0x03));
 
+	/*
+	 * Robust Caching
+	 *
+	 * The Database Hash covers the GATT service and reading it is the
+	 * only request a change-unaware client gets an answer to.
+	 */
+	define_test_server("/robust-caching/hash", test_server,
+			make_gatt_service_db(), NULL,
+			raw_pdu(0x03, 0x00, 0x02),
+			raw_pdu(0x08, 0x01, 0x00, 0xff, 0xff, 0x2a, 0x2b),
+			raw_pdu(0x09, 0x12, 0x05, 0x00, 0x2c, 0x98, 0xe0, 0x8b, 0x76, 0x55, 0x99, 0xbe,
+				0x05, 0xf4, 0xc4, 0x42, 0x28, 0x4a, 0xfb, 0xde),
+			raw_pdu(0x08, 0x01, 0x00, 0xff, 0xff, 0xfb, 0x34,
+				0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10,
+				0x00, 0x00, 0x2a, 0x2b, 0x00, 0x00),
+			raw_pdu(0x09, 0x12, 0x05, 0x00, 0x2c, 0x98, 0xe0, 0x8b, 0x76, 0x55, 0x99, 0xbe,
+				0x05, 0xf4, 0xc4, 0x42, 0x28, 0x4a, 0xfb, 0xde),
+			raw_pdu(0x0a, 0x05, 0x00),
+			raw_pdu(0x0b, 0x2c, 0x98, 0xe0, 0x8b, 0x76, 0x55, 0x99, 0xbe,
+				0x05, 0xf4, 0xc4, 0x42, 0x28, 0x4a, 0xfb, 0xde));
+
+	define_test_server("/robust-caching/out-of-sync", test_server,
+			make_gatt_service_db(), &test_robust_caching_change_1,
+			raw_pdu(0x03, 0x00, 0x02),
+			raw_pdu(0x12, 0x03, 0x00, 0x01),
+			raw_pdu(0x13),
+			raw_pdu(),
+			raw_pdu(0x52, 0x03, 0x00, 0x01),
+			raw_pdu(),
+			raw_pdu(0xd2, 0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+				0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00),
+			raw_pdu(),
+			raw_pdu(0x0a, 0x01, 0x00),
+			raw_pdu(0x01, 0x0a, 0x00, 0x00, 0x12),
+			raw_pdu(0x0a, 0x01, 0x00),
+			raw_pdu(0x0b, 0x01, 0x18));
+
+	define_test_server("/robust-caching/hash-read", test_server,
+			make_gatt_service_db(), &test_robust_caching_change_1,
+			raw_pdu(0x03, 0x00, 0x02),
+			raw_pdu(0x12, 0x03, 0x00, 0x01),
+			raw_pdu(0x13),
+			raw_pdu(),
+			raw_pdu(0x0a, 0x05, 0x00),
+			raw_pdu(0x0b, 0xaf, 0x20, 0xf0, 0xe1, 0x3c, 0xd6, 0x9b, 0xec,
+				0xce, 0xf8, 0x4d, 0xa2, 0x9b, 0xdf, 0x99, 0x5a),
+			raw_pdu(0x0a, 0x01, 0x00),
+			raw_pdu(0x0b, 0x01, 0x18));
+
+	define_test_client("/robust-caching/client", test_client,
+			make_gatt_service_db(), &test_robust_caching_client_1,
+			MTU_EXCHANGE_CLIENT_PDUS,
+			raw_pdu(0x10, 0x01, 0x00, 0xff, 0xff, 0x00, 0x28),
+			raw_pdu(0x11, 0x06, 0x01, 0x00, 0x05, 0x00, 0x01, 0x18),
+			raw_pdu(0x10, 0x06, 0x00, 0xff, 0xff, 0x00, 0x28),
+			raw_pdu(0x01, 0x10, 0x06, 0x00, 0x0a),
+			raw_pdu(0x10, 0x01, 0x00, 0xff, 0xff, 0x01, 0x28),
+			raw_pdu(0x01, 0x10, 0x01, 0x00, 0x0a),
+			raw_pdu(0x08, 0x01, 0x00, 0x05, 0x00, 0x02, 0x28),
+			raw_pdu(0x01, 0x08, 0x01, 0x00, 0x0a),
+			raw_pdu(0x08, 0x01, 0x00, 0x05, 0x00, 0x03, 0x28),
+			raw_pdu(0x09, 0x07, 0x02, 0x00, 0x0a, 0x03, 0x00, 0x29,
+				0x2b, 0x04, 0x00, 0x02, 0x05, 0x00, 0x2a, 0x2b),
+			raw_pdu(0x08, 0x05, 0x00, 0x05, 0x00, 0x03, 0x28),
+			raw_pdu(0x01, 0x08, 0x05, 0x00, 0x0a),
+			raw_pdu(0x08, 0x01, 0x00, 0xff, 0xff, 0x2a, 0x2b),
+			raw_pdu(0x09, 0x12, 0x05, 0x00, 0x2c, 0x98, 0xe0, 0x8b,
+				0x76, 0x55, 0x99, 0xbe, 0x05, 0xf4, 0xc4, 0x42,
+				0x28, 0x4a, 0xfb, 0xde),
+			raw_pdu(0x12, 0x03, 0x00, 0x05));
+
+	tester_add("/robustness/notification-burst", NULL, NULL,
+					test_notification_burst, NULL);
+	tester_add("/robustness/eatt-confirmation", NULL, NULL,
+					test_eatt_confirmation, NULL);
+
 	return tester_run();
 }
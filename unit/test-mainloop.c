@@ -0,0 +1,341 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *  Copyright (C) 2014  Intel Corporation. All rights reserved.
+ *
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <glib.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <time.h>
+
+#include "src/shared/util.h"
+#include "src/shared/mainloop.h"
+#include "src/shared/tester.h"
+
+/* Allowed lateness in ms, a timeout must never fire early */
+#define SLACK 50
+
+/* Fails the test instead of hanging if the wheel loses a timeout */
+#define GUARD 10000
+
+struct timer {
+	unsigned int msec;
+	int id;
+	uint64_t added;
+	uint64_t fired;
+	unsigned int count;
+	unsigned int destroyed;
+};
+
+static bool guard_hit;
+
+static uint64_t now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void timer_destroy(void *user_data)
+{
+	struct timer *timer = user_data;
+
+	timer->destroyed++;
+}
+
+static void guard_expired(int id, void *user_data)
+{
+	guard_hit = true;
+	mainloop_quit();
+}
+
+static void start(void)
+{
+	mainloop_init();
+
+	guard_hit = false;
+	g_assert(mainloop_add_timeout(GUARD, guard_expired, NULL, NULL) > 0);
+}
+
+static void timer_add(struct timer *timer, mainloop_timeout_func func)
+{
+	timer->added = now();
+	timer->id = mainloop_add_timeout(timer->msec, func, timer,
+								timer_destroy);
+	g_assert(timer->id > 0);
+}
+
+static void timer_check(struct timer *timer)
+{
+	uint64_t elapsed = timer->fired - timer->added;
+
+	tester_debug("%u ms fired after %llu ms", timer->msec,
+						(unsigned long long) elapsed);
+
+	/* Both clocks are truncated to ms so allow one ms of rounding */
+	g_assert(elapsed + 1 >= timer->msec);
+	g_assert(elapsed <= timer->msec + SLACK);
+}
+
+/* Each delay lands on a different level of the wheel or right at a level
+ * boundary, so everything past 63 ms is cascaded down one or two levels
+ * before it fires.
+ */
+static struct timer cascade_timers[] = {
+	{ .msec = 1 },
+	{ .msec = 63 },
+	{ .msec = 64 },
+	{ .msec = 65 },
+	{ .msec = 127 },
+	{ .msec = 128 },
+	{ .msec = 300 },
+	{ .msec = 1000 },
+	{ .msec = 4095 },
+	{ .msec = 4096 },
+	{ .msec = 4200 },
+};
+
+static unsigned int cascade_fired;
+static uint64_t cascade_last;
+
+static void cascade_expired(int id, void *user_data)
+{
+	struct timer *timer = user_data;
+
+	timer->fired = now();
+	timer->count++;
+
+	/* Timeouts fire in the order they are due */
+	g_assert(timer->added + timer->msec >= cascade_last);
+	cascade_last = timer->added + timer->msec;
+
+	mainloop_remove_timeout(id);
+
+	if (++cascade_fired == G_N_ELEMENTS(cascade_timers))
+		mainloop_quit();
+}
+
+static void test_cascade(const void *data)
+{
+	unsigned int i;
+
+	start();
+
+	/* Added in reverse so that the order does not come from the ids */
+	for (i = G_N_ELEMENTS(cascade_timers); i > 0; i--)
+		timer_add(&cascade_timers[i - 1], cascade_expired);
+
+	mainloop_run();
+
+	g_assert(!guard_hit);
+
+	for (i = 0; i < G_N_ELEMENTS(cascade_timers); i++) {
+		g_assert(cascade_timers[i].count == 1);
+		g_assert(cascade_timers[i].destroyed == 1);
+		timer_check(&cascade_timers[i]);
+	}
+
+	tester_test_passed();
+}
+
+/* Delays on the top level or past the range of the wheel must neither
+ * fire early nor be lost when removed or left pending at exit.
+ */
+static struct timer long_timers[] = {
+	{ .msec = 60 * 60 * 1000 },
+	{ .msec = 5 * 60 * 60 * 1000 },
+	{ .msec = UINT_MAX },
+};
+
+static struct timer long_check = { .msec = 200 };
+
+static void long_expired(int id, void *user_data)
+{
+	struct timer *timer = user_data;
+
+	timer->count++;
+}
+
+static void long_check_expired(int id, void *user_data)
+{
+	struct timer *timer = user_data;
+
+	timer->fired = now();
+	timer->count++;
+
+	/* Leave the last one pending to be destroyed with the mainloop */
+	g_assert(mainloop_remove_timeout(long_timers[0].id) == 0);
+	g_assert(mainloop_remove_timeout(long_timers[1].id) == 0);
+	g_assert(mainloop_remove_timeout(id) == 0);
+
+	mainloop_quit();
+}
+
+static void test_long(const void *data)
+{
+	unsigned int i;
+
+	start();
+
+	for (i = 0; i < G_N_ELEMENTS(long_timers); i++)
+		timer_add(&long_timers[i], long_expired);
+
+	timer_add(&long_check, long_check_expired);
+
+	mainloop_run();
+
+	g_assert(!guard_hit);
+
+	timer_check(&long_check);
+	g_assert(long_check.count == 1);
+	g_assert(long_check.destroyed == 1);
+
+	for (i = 0; i < G_N_ELEMENTS(long_timers); i++) {
+		g_assert(long_timers[i].count == 0);
+		g_assert(long_timers[i].destroyed == 1);
+	}
+
+	tester_test_passed();
+}
+
+/* The first timeout to fire removes, moves and adds others that are all
+ * due in the same or a nearby tick, and a periodic one re-arms itself
+ * before removing itself from within its own callback.
+ */
+static struct timer dispatch_first = { .msec = 30 };
+static struct timer dispatch_removed = { .msec = 30 };
+static struct timer dispatch_later = { .msec = 30 };
+static struct timer dispatch_sooner = { .msec = 5000 };
+static struct timer dispatch_added = { .msec = 10 };
+static struct timer dispatch_periodic = { .msec = 20 };
+
+static unsigned int dispatch_pending;
+
+static void dispatch_done(struct timer *timer)
+{
+	timer->fired = now();
+	timer->count++;
+
+	g_assert(mainloop_remove_timeout(timer->id) == 0);
+
+	if (!--dispatch_pending)
+		mainloop_quit();
+}
+
+static void dispatch_expired(int id, void *user_data)
+{
+	dispatch_done(user_data);
+}
+
+static void dispatch_first_expired(int id, void *user_data)
+{
+	struct timer *timer = user_data;
+
+	g_assert(mainloop_remove_timeout(dispatch_removed.id) == 0);
+	g_assert(mainloop_remove_timeout(dispatch_removed.id) < 0);
+
+	dispatch_later.msec = 100;
+	dispatch_later.added = now();
+	g_assert(mainloop_modify_timeout(dispatch_later.id, 100) == 0);
+
+	dispatch_sooner.msec = 50;
+	dispatch_sooner.added = now();
+	g_assert(mainloop_modify_timeout(dispatch_sooner.id, 50) == 0);
+
+	timer_add(&dispatch_added, dispatch_expired);
+
+	dispatch_done(timer);
+}
+
+static void dispatch_periodic_expired(int id, void *user_data)
+{
+	struct timer *timer = user_data;
+
+	if (timer->count < 2) {
+		timer->count++;
+		timer->added = now();
+		g_assert(mainloop_modify_timeout(id, timer->msec) == 0);
+		return;
+	}
+
+	dispatch_done(timer);
+}
+
+static void test_dispatch(const void *data)
+{
+	start();
+
+	timer_add(&dispatch_first, dispatch_first_expired);
+	timer_add(&dispatch_removed, dispatch_expired);
+	timer_add(&dispatch_later, dispatch_expired);
+	timer_add(&dispatch_sooner, dispatch_expired);
+	timer_add(&dispatch_periodic, dispatch_periodic_expired);
+
+	/* The removed timeout is not counted since it must never fire */
+	dispatch_pending = 5;
+
+	mainloop_run();
+
+	g_assert(!guard_hit);
+
+	g_assert(dispatch_removed.count == 0);
+	g_assert(dispatch_removed.destroyed == 1);
+
+	timer_check(&dispatch_first);
+	timer_check(&dispatch_later);
+	timer_check(&dispatch_sooner);
+	timer_check(&dispatch_added);
+	timer_check(&dispatch_periodic);
+
+	g_assert(dispatch_first.count == 1);
+	g_assert(dispatch_later.count == 1);
+	g_assert(dispatch_sooner.count == 1);
+	g_assert(dispatch_added.count == 1);
+	g_assert(dispatch_periodic.count == 3);
+
+	g_assert(dispatch_first.destroyed == 1);
+	g_assert(dispatch_later.destroyed == 1);
+	g_assert(dispatch_sooner.destroyed == 1);
+	g_assert(dispatch_added.destroyed == 1);
+	g_assert(dispatch_periodic.destroyed == 1);
+
+	tester_test_passed();
+}
+
+int main(int argc, char *argv[])
+{
+	tester_init(&argc, &argv);
+
+	tester_add("/mainloop/timeout/cascade", NULL, NULL, test_cascade, NULL);
+	tester_add("/mainloop/timeout/long", NULL, NULL, test_long, NULL);
+	tester_add("/mainloop/timeout/dispatch", NULL, NULL, test_dispatch,
+									NULL);
+
+	return tester_run();
+}
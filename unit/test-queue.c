@@ -259,6 +259,191 @@ static void test_remove_all(const void *data)
 	tester_test_passed();
 }
 
+static void test_ring_basic(const void *data)
+{
+	struct queue *queue;
+	unsigned int n, i;
+
+	queue = queue_new_ring(4);
+	g_assert(queue != NULL);
+
+	for (n = 0; n < 1024; n++) {
+		for (i = 1; i < n + 2; i++)
+			queue_push_tail(queue, UINT_TO_PTR(i));
+
+		g_assert(queue_length(queue) == n + 1);
+		g_assert(queue_peek_tail(queue) == UINT_TO_PTR(n + 1));
+
+		/* Force the ring to wrap around */
+		g_assert(queue_pop_head(queue) == UINT_TO_PTR(1));
+		g_assert(queue_push_head(queue, UINT_TO_PTR(1)));
+
+		for (i = 1; i < n + 2; i++) {
+			void *ptr;
+
+			ptr = queue_pop_head(queue);
+			g_assert(ptr != NULL);
+			g_assert(i == PTR_TO_UINT(ptr));
+		}
+
+		g_assert(queue_isempty(queue) == true);
+		g_assert(queue_pop_head(queue) == NULL);
+	}
+
+	queue_destroy(queue, NULL);
+	tester_test_passed();
+}
+
+static void test_ring_push_after(const void *data)
+{
+	struct queue *queue;
+	unsigned int i;
+
+	queue = queue_new_ring(0);
+	g_assert(queue != NULL);
+
+	g_assert(queue_push_tail(queue, UINT_TO_PTR(2)));
+	g_assert(queue_push_tail(queue, UINT_TO_PTR(5)));
+	g_assert(queue_push_head(queue, NULL));
+
+	g_assert(!queue_push_after(queue, UINT_TO_PTR(6), UINT_TO_PTR(1)));
+
+	g_assert(queue_push_after(queue, NULL, UINT_TO_PTR(1)));
+	g_assert(queue_push_after(queue, UINT_TO_PTR(2), UINT_TO_PTR(3)));
+	g_assert(queue_push_after(queue, UINT_TO_PTR(3), UINT_TO_PTR(4)));
+	g_assert(queue_push_after(queue, UINT_TO_PTR(5), UINT_TO_PTR(6)));
+
+	g_assert(queue_peek_head(queue) == NULL);
+	g_assert(queue_peek_tail(queue) == UINT_TO_PTR(6));
+	g_assert(queue_length(queue) == 7);
+
+	g_assert(queue_remove(queue, UINT_TO_PTR(3)));
+	g_assert(!queue_remove(queue, UINT_TO_PTR(3)));
+	g_assert(queue_remove_if(queue, match_int, UINT_TO_PTR(5)) ==
+							UINT_TO_PTR(5));
+	g_assert(queue_find(queue, match_int, UINT_TO_PTR(4)) ==
+							UINT_TO_PTR(4));
+
+	for (i = 0; i < 7; i++) {
+		if (i == 3 || i == 5)
+			continue;
+
+		g_assert(queue_pop_head(queue) == UINT_TO_PTR(i));
+	}
+
+	queue_destroy(queue, NULL);
+	tester_test_passed();
+}
+
+static void test_ring_foreach_remove(const void *data)
+{
+	struct queue *queue;
+
+	queue = queue_new_ring(0);
+	g_assert(queue != NULL);
+
+	queue_push_tail(queue, UINT_TO_PTR(1));
+	queue_push_tail(queue, UINT_TO_PTR(2));
+
+	queue_foreach(queue, foreach_remove, queue);
+	g_assert(queue_isempty(queue));
+
+	queue_push_tail(queue, UINT_TO_PTR(1));
+	queue_push_tail(queue, UINT_TO_PTR(2));
+
+	queue_foreach(queue, foreach_remove_backward, queue);
+	g_assert(queue_isempty(queue));
+
+	queue_push_tail(queue, UINT_TO_PTR(1));
+	queue_push_tail(queue, UINT_TO_PTR(2));
+
+	queue_foreach(queue, foreach_destroy, queue);
+	tester_test_passed();
+}
+
+static void test_ring_destroy_remove(const void *data)
+{
+	static_queue = queue_new_ring(0);
+
+	g_assert(static_queue != NULL);
+
+	queue_push_tail(static_queue, UINT_TO_PTR(1));
+	queue_push_tail(static_queue, UINT_TO_PTR(2));
+
+	queue_destroy(static_queue, destroy_remove);
+	tester_test_passed();
+}
+
+static void test_ring_entries(const void *data)
+{
+	struct queue *queue;
+	unsigned int i;
+
+	queue = queue_new_ring(0);
+	g_assert(queue != NULL);
+
+	for (i = 1; i <= 4; i++)
+		g_assert(queue_push_tail(queue, UINT_TO_PTR(i)));
+
+	/* Ring entries are only visited by queue_foreach */
+	g_assert(queue_get_entries(queue) == NULL);
+	g_assert(queue_length(queue) == 4);
+	g_assert(queue_peek_head(queue) == UINT_TO_PTR(1));
+
+	queue_destroy(queue, NULL);
+	tester_test_passed();
+}
+
+static unsigned int key_int(const void *data)
+{
+	return PTR_TO_UINT(data);
+}
+
+static void test_keyed(const void *data)
+{
+	struct queue *queue;
+	unsigned int i;
+
+	queue = queue_new_keyed(key_int);
+	g_assert(queue != NULL);
+
+	for (i = 1; i <= 1000; i++)
+		g_assert(queue_push_tail(queue, UINT_TO_PTR(i)));
+
+	g_assert(queue_push_head(queue, UINT_TO_PTR(2000)));
+	g_assert(queue_push_after(queue, UINT_TO_PTR(500),
+							UINT_TO_PTR(3000)));
+
+	for (i = 1; i <= 1000; i++)
+		g_assert(queue_find_by_key(queue, i) == UINT_TO_PTR(i));
+
+	g_assert(queue_find_by_key(queue, 2000) == UINT_TO_PTR(2000));
+	g_assert(queue_find_by_key(queue, 3000) == UINT_TO_PTR(3000));
+	g_assert(queue_find_by_key(queue, 4000) == NULL);
+
+	/* Lookups keep working whichever way entries are removed */
+	g_assert(queue_remove_by_key(queue, 3000) == UINT_TO_PTR(3000));
+	g_assert(queue_find_by_key(queue, 3000) == NULL);
+	g_assert(queue_remove(queue, UINT_TO_PTR(10)));
+	g_assert(queue_find_by_key(queue, 10) == NULL);
+	g_assert(queue_pop_head(queue) == UINT_TO_PTR(2000));
+	g_assert(queue_find_by_key(queue, 2000) == NULL);
+	g_assert(queue_remove_if(queue, match_int, UINT_TO_PTR(20)) ==
+							UINT_TO_PTR(20));
+	g_assert(queue_find_by_key(queue, 20) == NULL);
+	g_assert(queue_peek_tail(queue) == UINT_TO_PTR(1000));
+	g_assert(queue_length(queue) == 998);
+
+	g_assert(queue_remove_all(queue, NULL, NULL, NULL) == 998);
+	g_assert(queue_find_by_key(queue, 1) == NULL);
+
+	g_assert(queue_push_tail(queue, UINT_TO_PTR(1)));
+	g_assert(queue_find_by_key(queue, 1) == UINT_TO_PTR(1));
+
+	queue_destroy(queue, NULL);
+	tester_test_passed();
+}
+
 int main(int argc, char *argv[])
 {
 	tester_init(&argc, &argv);
@@ -276,6 +461,16 @@ int main(int argc, char *argv[])
 						test_destroy_remove, NULL);
 	tester_add("/queue/push_after",  NULL, NULL, test_push_after, NULL);
 	tester_add("/queue/remove_all",  NULL, NULL, test_remove_all, NULL);
+	tester_add("/queue/ring/basic", NULL, NULL, test_ring_basic, NULL);
+	tester_add("/queue/ring/push_after", NULL, NULL,
+						test_ring_push_after, NULL);
+	tester_add("/queue/ring/foreach_remove", NULL, NULL,
+					test_ring_foreach_remove, NULL);
+	tester_add("/queue/ring/entries", NULL, NULL,
+					test_ring_entries, NULL);
+	tester_add("/queue/ring/destroy_remove", NULL, NULL,
+					test_ring_destroy_remove, NULL);
+	tester_add("/queue/keyed", NULL, NULL, test_keyed, NULL);
 
 	return tester_run();
 }
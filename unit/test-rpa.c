@@ -0,0 +1,288 @@
+/*
+ *
+ *  BlueZ - Bluetooth protocol stack for Linux
+ *
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+#include <glib.h>
+
+#include "src/shared/crypto.h"
+#include "src/shared/rpa.h"
+#include "src/shared/util.h"
+#include "src/shared/tester.h"
+
+/* Crosses several bt_aes_encrypt_batch() calls */
+#define IRK_COUNT	100
+
+static struct bt_crypto *crypto;
+
+/* Core Spec 4.1, Vol 3, Part H, D.7 */
+static const uint8_t ah_irk[] = {
+	0x9b, 0x7d, 0x39, 0x0a, 0xa6, 0x10, 0x10, 0x34, 0x05, 0xad, 0xc8, 0x57,
+	0xa3, 0x34, 0x02, 0xec
+};
+
+static const uint8_t ah_rpa[] = { 0xaa, 0xfb, 0x0d, 0x94, 0x81, 0x70 };
+
+static const uint8_t ah_addr[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0xc0 };
+
+static void make_irk(unsigned int index, uint8_t irk[16])
+{
+	uint32_t seed = 0x9e3779b9 * (index + 1);
+	int i;
+
+	for (i = 0; i < 16; i++) {
+		seed = seed * 1103515245 + 12345;
+		irk[i] = seed >> 16;
+	}
+}
+
+static void make_addr(unsigned int index, uint8_t addr[6])
+{
+	memset(addr, 0, 6);
+	put_le16(index, addr);
+	addr[5] = 0xc0;
+}
+
+/* The RPA of IRK index, built with bt_crypto_ah() */
+static void make_rpa(unsigned int index, uint8_t rpa[6])
+{
+	uint8_t irk[16];
+
+	make_irk(index, irk);
+
+	rpa[3] = index;
+	rpa[4] = index >> 8;
+	rpa[5] = 0x40 | (index & 0x3f);
+
+	g_assert(bt_crypto_ah(crypto, irk, rpa + 3, rpa));
+}
+
+static struct bt_rpa_resolver *make_resolver(size_t cache_size,
+							unsigned int count)
+{
+	struct bt_rpa_resolver *resolver;
+	uint8_t irk[16], addr[6];
+	unsigned int i;
+
+	resolver = bt_rpa_resolver_new(cache_size);
+	g_assert(resolver);
+
+	for (i = 0; i < count; i++) {
+		make_irk(i, irk);
+		make_addr(i, addr);
+		g_assert(bt_rpa_resolver_add_irk(resolver, irk, addr, 0x01));
+	}
+
+	g_assert_cmpint(bt_rpa_resolver_get_irk_count(resolver), ==, count);
+
+	return resolver;
+}
+
+static void assert_resolves(struct bt_rpa_resolver *resolver,
+					const uint8_t rpa[6], unsigned int index)
+{
+	uint8_t addr[6], expected[6], type = 0;
+
+	make_addr(index, expected);
+
+	g_assert(bt_rpa_resolver_resolve(resolver, rpa, addr, &type));
+	g_assert(memcmp(addr, expected, 6) == 0);
+	g_assert_cmpint(type, ==, 0x01);
+}
+
+static void assert_stats(struct bt_rpa_resolver *resolver, size_t hits,
+								size_t misses)
+{
+	size_t cache_hits, cache_misses;
+
+	bt_rpa_resolver_get_cache_stats(resolver, &cache_hits, &cache_misses);
+
+	g_assert_cmpint(cache_hits, ==, hits);
+	g_assert_cmpint(cache_misses, ==, misses);
+}
+
+static void test_ah(const void *test_data)
+{
+	struct bt_rpa_resolver *resolver;
+	uint8_t hash[3], addr[6], type = 0;
+
+	g_assert(bt_crypto_ah(crypto, ah_irk, ah_rpa + 3, hash));
+	g_assert(memcmp(hash, ah_rpa, 3) == 0);
+
+	resolver = bt_rpa_resolver_new(0);
+	g_assert(resolver);
+
+	g_assert(bt_rpa_resolver_add_irk(resolver, ah_irk, ah_addr, 0x01));
+
+	g_assert(bt_rpa_resolver_resolve(resolver, ah_rpa, addr, &type));
+	g_assert(memcmp(addr, ah_addr, 6) == 0);
+	g_assert_cmpint(type, ==, 0x01);
+
+	bt_rpa_resolver_unref(resolver);
+
+	tester_test_passed();
+}
+
+static void test_many(const void *test_data)
+{
+	struct bt_rpa_resolver *resolver;
+	uint8_t rpa[6];
+
+	resolver = make_resolver(0, IRK_COUNT);
+
+	make_rpa(73, rpa);
+	assert_resolves(resolver, rpa, 73);
+
+	/* Wrong hash */
+	rpa[0] ^= 0x01;
+	g_assert(!bt_rpa_resolver_resolve(resolver, rpa, NULL, NULL));
+
+	/* Only random resolvable addresses are looked up */
+	make_rpa(73, rpa);
+	rpa[5] |= 0xc0;
+	g_assert(!bt_rpa_is_resolvable(rpa));
+	g_assert(!bt_rpa_resolver_resolve(resolver, rpa, NULL, NULL));
+
+	bt_rpa_resolver_unref(resolver);
+
+	tester_test_passed();
+}
+
+static void test_batch(const void *test_data)
+{
+	struct bt_rpa_resolver *resolver;
+	uint8_t rpa[6];
+	unsigned int i;
+
+	resolver = make_resolver(0, IRK_COUNT);
+
+	for (i = 0; i < IRK_COUNT; i++) {
+		make_rpa(i, rpa);
+		assert_resolves(resolver, rpa, i);
+	}
+
+	bt_rpa_resolver_unref(resolver);
+
+	tester_test_passed();
+}
+
+static void test_cache(const void *test_data)
+{
+	struct bt_rpa_resolver *resolver;
+	uint8_t rpa_a[6], rpa_b[6], rpa_u[6];
+
+	resolver = make_resolver(2, IRK_COUNT);
+
+	make_rpa(1, rpa_a);
+	make_rpa(2, rpa_b);
+	make_rpa(IRK_COUNT, rpa_u);
+
+	assert_resolves(resolver, rpa_a, 1);
+	assert_stats(resolver, 0, 1);
+
+	assert_resolves(resolver, rpa_a, 1);
+	assert_stats(resolver, 1, 1);
+
+	/* Misses are cached too */
+	g_assert(!bt_rpa_resolver_resolve(resolver, rpa_u, NULL, NULL));
+	assert_stats(resolver, 1, 2);
+
+	g_assert(!bt_rpa_resolver_resolve(resolver, rpa_u, NULL, NULL));
+	assert_stats(resolver, 2, 2);
+
+	/* A is the least recently used entry now */
+	assert_resolves(resolver, rpa_b, 2);
+	assert_stats(resolver, 2, 3);
+
+	g_assert(!bt_rpa_resolver_resolve(resolver, rpa_u, NULL, NULL));
+	assert_stats(resolver, 3, 3);
+
+	assert_resolves(resolver, rpa_a, 1);
+	assert_stats(resolver, 3, 4);
+
+	bt_rpa_resolver_unref(resolver);
+
+	tester_test_passed();
+}
+
+static void test_irk_change(const void *test_data)
+{
+	struct bt_rpa_resolver *resolver;
+	uint8_t rpa_0[6], rpa_2[6], rpa_3[6], irk[16], addr[6];
+
+	resolver = make_resolver(16, 3);
+
+	make_rpa(0, rpa_0);
+	make_rpa(2, rpa_2);
+	make_rpa(3, rpa_3);
+
+	assert_resolves(resolver, rpa_0, 0);
+	assert_resolves(resolver, rpa_2, 2);
+	g_assert(!bt_rpa_resolver_resolve(resolver, rpa_3, NULL, NULL));
+
+	/* The last IRK takes the place of the removed one */
+	make_addr(0, addr);
+	g_assert(bt_rpa_resolver_remove_irk(resolver, addr, 0x01));
+	g_assert(!bt_rpa_resolver_remove_irk(resolver, addr, 0x01));
+
+	g_assert(!bt_rpa_resolver_resolve(resolver, rpa_0, NULL, NULL));
+	assert_resolves(resolver, rpa_2, 2);
+
+	/* A cached miss resolves once its IRK is added */
+	make_irk(3, irk);
+	make_addr(3, addr);
+	g_assert(bt_rpa_resolver_add_irk(resolver, irk, addr, 0x01));
+	assert_resolves(resolver, rpa_3, 3);
+
+	bt_rpa_resolver_clear(resolver);
+	g_assert_cmpint(bt_rpa_resolver_get_irk_count(resolver), ==, 0);
+	g_assert(!bt_rpa_resolver_resolve(resolver, rpa_2, NULL, NULL));
+
+	bt_rpa_resolver_unref(resolver);
+
+	tester_test_passed();
+}
+
+int main(int argc, char *argv[])
+{
+	int exit_status;
+
+	crypto = bt_crypto_new();
+	if (!crypto)
+		return 0;
+
+	tester_init(&argc, &argv);
+
+	tester_add("/rpa/ah", NULL, NULL, test_ah, NULL);
+	tester_add("/rpa/many", NULL, NULL, test_many, NULL);
+	tester_add("/rpa/batch", NULL, NULL, test_batch, NULL);
+	tester_add("/rpa/cache", NULL, NULL, test_cache, NULL);
+	tester_add("/rpa/irk-change", NULL, NULL, test_irk_change, NULL);
+
+	exit_status = tester_run();
+
+	bt_crypto_unref(crypto);
+
+	return exit_status;
+}